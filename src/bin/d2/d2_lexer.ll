@@ -215,6 +215,51 @@ ControlCharacterFill            [^"\\]|\\["\\/bfnrtu]
     }
 }
 
+\"dns-update-threads\" {
+    switch(driver.ctx_) {
+    case isc::d2::D2ParserContext::DHCPDDNS:
+        return isc::d2::D2Parser::make_DNS_UPDATE_THREADS(driver.loc_);
+    default:
+        return isc::d2::D2Parser::make_STRING("dns-update-threads", driver.loc_);
+    }
+}
+
+\"dns-update-batch-size\" {
+    switch(driver.ctx_) {
+    case isc::d2::D2ParserContext::DHCPDDNS:
+        return isc::d2::D2Parser::make_DNS_UPDATE_BATCH_SIZE(driver.loc_);
+    default:
+        return isc::d2::D2Parser::make_STRING("dns-update-batch-size", driver.loc_);
+    }
+}
+
+\"dns-server-protocol\" {
+    switch(driver.ctx_) {
+    case isc::d2::D2ParserContext::DHCPDDNS:
+        return isc::d2::D2Parser::make_DNS_SERVER_PROTOCOL(driver.loc_);
+    default:
+        return isc::d2::D2Parser::make_STRING("dns-server-protocol", driver.loc_);
+    }
+}
+
+\"dns-server-connections\" {
+    switch(driver.ctx_) {
+    case isc::d2::D2ParserContext::DHCPDDNS:
+        return isc::d2::D2Parser::make_DNS_SERVER_CONNECTIONS(driver.loc_);
+    default:
+        return isc::d2::D2Parser::make_STRING("dns-server-connections", driver.loc_);
+    }
+}
+
+\"dns-server-idle-timeout\" {
+    switch(driver.ctx_) {
+    case isc::d2::D2ParserContext::DHCPDDNS:
+        return isc::d2::D2Parser::make_DNS_SERVER_IDLE_TIMEOUT(driver.loc_);
+    default:
+        return isc::d2::D2Parser::make_STRING("dns-server-idle-timeout", driver.loc_);
+    }
+}
+
 \"ncr-protocol\" {
     switch(driver.ctx_) {
     case isc::d2::D2ParserContext::DHCPDDNS:
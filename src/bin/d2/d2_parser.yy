@@ -53,6 +53,11 @@ using namespace std;
   IP_ADDRESS "ip-address"
   PORT "port"
   DNS_SERVER_TIMEOUT "dns-server-timeout"
+  DNS_UPDATE_THREADS "dns-update-threads"
+  DNS_UPDATE_BATCH_SIZE "dns-update-batch-size"
+  DNS_SERVER_PROTOCOL "dns-server-protocol"
+  DNS_SERVER_CONNECTIONS "dns-server-connections"
+  DNS_SERVER_IDLE_TIMEOUT "dns-server-idle-timeout"
   NCR_PROTOCOL "ncr-protocol"
   UDP "UDP"
   TCP "TCP"
@@ -274,6 +279,11 @@ dhcpddns_params: dhcpddns_param
 dhcpddns_param: ip_address
               | port
               | dns_server_timeout
+              | dns_update_threads
+              | dns_update_batch_size
+              | dns_server_protocol
+              | dns_server_connections
+              | dns_server_idle_timeout
               | ncr_protocol
               | ncr_format
               | forward_ddns
@@ -315,6 +325,54 @@ dns_server_timeout: DNS_SERVER_TIMEOUT COLON INTEGER {
     }
 };
 
+dns_update_threads: DNS_UPDATE_THREADS COLON INTEGER {
+    ctx.unique("dns-update-threads", ctx.loc2pos(@1));
+    if ($3 < 0) {
+        error(@3, "dns-update-threads must not be negative");
+    } else {
+        ElementPtr i(new IntElement($3, ctx.loc2pos(@3)));
+        ctx.stack_.back()->set("dns-update-threads", i);
+    }
+};
+
+dns_update_batch_size: DNS_UPDATE_BATCH_SIZE COLON INTEGER {
+    ctx.unique("dns-update-batch-size", ctx.loc2pos(@1));
+    if ($3 < 0) {
+        error(@3, "dns-update-batch-size must not be negative");
+    } else {
+        ElementPtr i(new IntElement($3, ctx.loc2pos(@3)));
+        ctx.stack_.back()->set("dns-update-batch-size", i);
+    }
+};
+
+dns_server_protocol: DNS_SERVER_PROTOCOL {
+    ctx.unique("dns-server-protocol", ctx.loc2pos(@1));
+    ctx.enter(ctx.NCR_PROTOCOL);
+} COLON ncr_protocol_value {
+    ctx.stack_.back()->set("dns-server-protocol", $4);
+    ctx.leave();
+};
+
+dns_server_connections: DNS_SERVER_CONNECTIONS COLON INTEGER {
+    ctx.unique("dns-server-connections", ctx.loc2pos(@1));
+    if ($3 <= 0) {
+        error(@3, "dns-server-connections must be greater than zero");
+    } else {
+        ElementPtr i(new IntElement($3, ctx.loc2pos(@3)));
+        ctx.stack_.back()->set("dns-server-connections", i);
+    }
+};
+
+dns_server_idle_timeout: DNS_SERVER_IDLE_TIMEOUT COLON INTEGER {
+    ctx.unique("dns-server-idle-timeout", ctx.loc2pos(@1));
+    if ($3 < 0) {
+        error(@3, "dns-server-idle-timeout must not be negative");
+    } else {
+        ElementPtr i(new IntElement($3, ctx.loc2pos(@3)));
+        ctx.stack_.back()->set("dns-server-idle-timeout", i);
+    }
+};
+
 ncr_protocol: NCR_PROTOCOL {
     ctx.unique("ncr-protocol", ctx.loc2pos(@1));
     ctx.enter(ctx.NCR_PROTOCOL);
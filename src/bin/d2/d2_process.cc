@@ -14,6 +14,7 @@
 #include <d2srv/d2_log.h>
 #include <d2srv/d2_stats.h>
 #include <d2srv/d2_tsig_key.h>
+#include <d2srv/dns_client.h>
 #include <hooks/hooks.h>
 #include <hooks/hooks_manager.h>
 
@@ -239,9 +240,13 @@ D2Process::configure(isc::data::ConstElementPtr config_set, bool check_only) {
         .arg(check_only ? "check" : "update")
         .arg(getD2CfgMgr()->redactConfig(config_set)->str());
 
+    // The transactions running on the update threads read the current
+    // configuration: suspend the threads while it is replaced.
+    update_mgr_->pauseThreads();
     isc::data::ConstElementPtr answer;
     answer = getCfgMgr()->simpleParseConfig(config_set, check_only,
                 std::bind(&D2Process::reconfigureCommandChannel, this));
+    update_mgr_->resumeThreads();
     if (check_only) {
         return (answer);
     }
@@ -300,6 +305,17 @@ D2Process::configure(isc::data::ConstElementPtr config_set, bool check_only) {
         }
     }
 
+    // Apply the number of DNS update threads. If transactions are in
+    // progress the change is deferred until they are done.
+    D2ParamsPtr params = getD2CfgMgr()->getD2Params();
+    update_mgr_->setThreadCount(params->getDnsUpdateThreads());
+    update_mgr_->setBatchSize(params->getDnsUpdateBatchSize());
+
+    // Apply the limits of the pool of TCP connections to the DNS servers.
+    // The connections already open keep their idle timeout.
+    DNSClient::setTcpConnectionLimits(params->getDnsServerConnections(),
+                                      params->getDnsServerIdleTimeout());
+
     // If we are here, configuration was valid, at least it parsed correctly
     // and therefore contained no invalid values.
     // Return the success answer from above.
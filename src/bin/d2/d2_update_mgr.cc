@@ -8,14 +8,23 @@
 
 #include <d2/d2_update_mgr.h>
 #include <d2/nc_add.h>
+#include <d2/nc_batch.h>
 #include <d2/nc_remove.h>
 #include <d2/simple_add.h>
 #include <d2/simple_remove.h>
+#include <util/multi_threading_mgr.h>
 
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/make_shared.hpp>
+
+#include <algorithm>
+#include <functional>
 #include <sstream>
 #include <iostream>
 #include <vector>
 
+using namespace isc::util;
+
 namespace isc {
 namespace d2 {
 
@@ -24,7 +33,9 @@ const size_t D2UpdateMgr::MAX_TRANSACTIONS_DEFAULT;
 D2UpdateMgr::D2UpdateMgr(D2QueueMgrPtr& queue_mgr, D2CfgMgrPtr& cfg_mgr,
                          asiolink::IOServicePtr& io_service,
                          const size_t max_transactions)
-    :queue_mgr_(queue_mgr), cfg_mgr_(cfg_mgr), io_service_(io_service) {
+    :queue_mgr_(queue_mgr), cfg_mgr_(cfg_mgr), io_service_(io_service),
+     thread_count_pending_(false), pending_thread_count_(0),
+     batch_size_(0) {
     if (!queue_mgr_) {
         isc_throw(D2UpdateMgrError, "D2UpdateMgr queue manager cannot be null");
     }
@@ -43,6 +54,9 @@ D2UpdateMgr::D2UpdateMgr(D2QueueMgrPtr& queue_mgr, D2CfgMgrPtr& cfg_mgr,
 }
 
 D2UpdateMgr::~D2UpdateMgr() {
+    // The threads must be gone before the transactions they run.
+    pauseThreads();
+    batch_list_.clear();
     transaction_list_.clear();
 }
 
@@ -50,6 +64,40 @@ void D2UpdateMgr::sweep() {
     // cleanup finished transactions;
     checkFinishedTransactions();
 
+    // A new thread count is applied once the transactions running on the
+    // current threads are done. Do not start new ones in the meantime.
+    if (thread_count_pending_) {
+        if (getTransactionCount() > 0) {
+            return;
+        }
+
+        setThreadCount(pending_thread_count_);
+    }
+
+    // In multi-threaded mode start as many transactions as possible: the
+    // requests are spread across the threads. Same when the forward changes
+    // are batched: the more requests, the fewer updates.
+    if (!threads_.empty() || (batch_size_ > 1)) {
+        size_t max_transactions = max_transactions_ *
+                                  std::max(threads_.size(), size_t(1));
+        while (getQueueCount() > 0) {
+            if (getTransactionCount() >= max_transactions) {
+                LOG_DEBUG(dhcp_to_d2_logger, isc::log::DBGLVL_TRACE_DETAIL_DATA,
+                          DHCP_DDNS_AT_MAX_TRANSACTIONS).arg(getQueueCount())
+                          .arg(max_transactions);
+                break;
+            }
+
+            if (!pickNextJob()) {
+                break;
+            }
+        }
+
+        // Send the batches which are not full.
+        startBatches();
+        return;
+    }
+
     // if the queue isn't empty, find the next suitable job and
     // start a transaction for it.
     // @todo - Do we want to queue max transactions? The logic here will only
@@ -86,14 +134,40 @@ D2UpdateMgr::checkFinishedTransactions() {
         if (trans->isModelDone()) {
             // @todo  Additional actions based on NCR status could be
             // performed here.
+            if (!threads_.empty()) {
+                const std::string& fqdn = trans->getNcr()->getFqdn();
+                fqdns_in_progress_.erase(boost::algorithm::to_lower_copy(fqdn));
+
+                // The transaction may still be unwinding from the handler
+                // which completed it: let its own thread drop the last
+                // reference.
+                selectIOService(fqdn)->post([trans]() {});
+            }
+
             transaction_list_.erase(it++);
         } else {
             ++it;
         }
     }
+
+    // Remove the batches which have started their transactions.
+    auto batch = batch_list_.begin();
+    while (batch != batch_list_.end()) {
+        if ((*batch)->isDone()) {
+            if (!threads_.empty()) {
+                // Same as above: let its own thread drop the last reference.
+                NameChangeBatchPtr done_batch = *batch;
+                done_batch->getIOService()->post([done_batch]() {});
+            }
+
+            batch_list_.erase(batch++);
+        } else {
+            ++batch;
+        }
+    }
 }
 
-void D2UpdateMgr::pickNextJob() {
+bool D2UpdateMgr::pickNextJob() {
     // Start at the front of the queue, looking for the first entry for
     // which no transaction is in progress.  If we find an eligible entry
     // remove it from the queue and  make a transaction for it.
@@ -103,10 +177,13 @@ void D2UpdateMgr::pickNextJob() {
     size_t queue_count = getQueueCount();
     for (size_t index = 0; index < queue_count; ++index) {
         dhcp_ddns::NameChangeRequestPtr found_ncr = queue_mgr_->peekAt(index);
-        if (!hasTransaction(found_ncr->getDhcid())) {
+        if (!hasTransaction(found_ncr->getDhcid()) &&
+            (threads_.empty() ||
+             !fqdns_in_progress_.count(boost::algorithm::to_lower_copy(
+                 found_ncr->getFqdn())))) {
             queue_mgr_->dequeueAt(index);
             makeTransaction(found_ncr);
-            return;
+            return (true);
         }
     }
 
@@ -115,6 +192,7 @@ void D2UpdateMgr::pickNextJob() {
     LOG_DEBUG(dhcp_to_d2_logger, isc::log::DBGLVL_TRACE_DETAIL_DATA,
               DHCP_DDNS_NO_ELIGIBLE_JOBS)
         .arg(getQueueCount()).arg(getTransactionCount());
+    return (false);
 }
 
 void
@@ -193,28 +271,27 @@ D2UpdateMgr::makeTransaction(dhcp_ddns::NameChangeRequestPtr& next_ncr) {
     }
 
     // We matched to the required servers, so construct the transaction.
-    // @todo If multi-threading is implemented, one would pass in an
-    // empty IOServicePtr, rather than our instance value.  This would cause
-    // the transaction to instantiate its own, separate IOService to handle
-    // the transaction's IO.
+    // In multi-threaded mode, it runs on the IOService of the thread
+    // selected by its FQDN.
+    asiolink::IOServicePtr& io_service = selectIOService(next_ncr->getFqdn());
     NameChangeTransactionPtr trans;
     if (next_ncr->getChangeType() == dhcp_ddns::CHG_ADD) {
         if (next_ncr->useConflictResolution()) {
-            trans.reset(new NameAddTransaction(io_service_, next_ncr,
+            trans.reset(new NameAddTransaction(io_service, next_ncr,
                                                forward_domain, reverse_domain,
                                                cfg_mgr_));
         } else {
-            trans.reset(new SimpleAddTransaction(io_service_, next_ncr,
+            trans.reset(new SimpleAddTransaction(io_service, next_ncr,
                                                  forward_domain, reverse_domain,
                                                  cfg_mgr_));
         }
     } else {
         if (next_ncr->useConflictResolution()) {
-            trans.reset(new NameRemoveTransaction(io_service_, next_ncr,
+            trans.reset(new NameRemoveTransaction(io_service, next_ncr,
                                                   forward_domain, reverse_domain,
                                                   cfg_mgr_));
         } else {
-            trans.reset(new SimpleRemoveTransaction(io_service_, next_ncr,
+            trans.reset(new SimpleRemoveTransaction(io_service, next_ncr,
                                                     forward_domain, reverse_domain,
                                                     cfg_mgr_));
         }
@@ -223,8 +300,169 @@ D2UpdateMgr::makeTransaction(dhcp_ddns::NameChangeRequestPtr& next_ncr) {
     // Add the new transaction to the list.
     transaction_list_[key] = trans;
 
-    // Start it.
-    trans->startTransaction();
+    if (!threads_.empty()) {
+        fqdns_in_progress_.insert(boost::algorithm::to_lower_copy(
+            next_ncr->getFqdn()));
+
+        // Wake up the primary IOService when the transaction is done so
+        // that sweep() removes it and starts the next one.
+        asiolink::IOServicePtr main_io_service = io_service_;
+        trans->setCompletionHandler([main_io_service]() {
+            main_io_service->post([]() {});
+        });
+    }
+
+    // When batching is enabled, the batch of the forward domain starts the
+    // transaction once the batched update is done.
+    if ((batch_size_ > 1) && forward_domain &&
+        batchTransaction(trans, forward_domain, io_service)) {
+        return;
+    }
+
+    if (threads_.empty()) {
+        // Start it.
+        trans->startTransaction();
+    } else {
+        // Start it on its own thread.
+        io_service->post([trans]() { trans->startTransaction(); });
+    }
+}
+
+bool
+D2UpdateMgr::batchTransaction(const NameChangeTransactionPtr& trans,
+                              const DdnsDomainPtr& domain,
+                              const asiolink::IOServicePtr& io_service) {
+    const std::string& name = domain->getName();
+    NameChangeBatchPtr batch = pending_batches_[name];
+    if (!batch) {
+        batch.reset(new NameChangeBatch(selectIOService(name), domain,
+                                        cfg_mgr_));
+        pending_batches_[name] = batch;
+    }
+
+    if (!batch->addTransaction(trans, io_service)) {
+        if (!batch->getTransactionCount()) {
+            pending_batches_.erase(name);
+        }
+
+        return (false);
+    }
+
+    if (batch->getTransactionCount() >= batch_size_) {
+        pending_batches_.erase(name);
+        startBatch(batch);
+    }
+
+    return (true);
+}
+
+void
+D2UpdateMgr::startBatches() {
+    for (auto const& entry : pending_batches_) {
+        startBatch(entry.second);
+    }
+
+    pending_batches_.clear();
+}
+
+void
+D2UpdateMgr::startBatch(const NameChangeBatchPtr& batch) {
+    batch_list_.push_back(batch);
+    if (threads_.empty()) {
+        batch->start();
+    } else {
+        batch->getIOService()->post([batch]() { batch->start(); });
+    }
+}
+
+asiolink::IOServicePtr&
+D2UpdateMgr::selectIOService(const std::string& fqdn) {
+    if (thread_io_services_.empty()) {
+        return (io_service_);
+    }
+
+    // Names are case insensitive so the thread must not depend on the case.
+    std::string name = boost::algorithm::to_lower_copy(fqdn);
+    size_t hash = std::hash<std::string>()(name);
+    return (thread_io_services_[hash % thread_io_services_.size()]);
+}
+
+void
+D2UpdateMgr::setThreadCount(const size_t thread_count) {
+    if (getTransactionCount() > 0) {
+        thread_count_pending_ = true;
+        pending_thread_count_ = thread_count;
+        return;
+    }
+
+    thread_count_pending_ = false;
+    if (thread_count == threads_.size()) {
+        return;
+    }
+
+    stopThreads();
+    fqdns_in_progress_.clear();
+    MultiThreadingMgr::instance().setMode(thread_count > 0);
+    startThreads(thread_count);
+    if (thread_count) {
+        LOG_INFO(dhcp_to_d2_logger, DHCP_DDNS_UPDATE_THREADS_STARTED)
+            .arg(thread_count);
+    } else {
+        LOG_INFO(dhcp_to_d2_logger, DHCP_DDNS_UPDATE_THREADS_STOPPED);
+    }
+}
+
+void
+D2UpdateMgr::startThreads(const size_t thread_count) {
+    for (size_t i = 0; i < thread_count; ++i) {
+        asiolink::IOServicePtr io_service(new asiolink::IOService());
+        thread_io_services_.push_back(io_service);
+        threads_.push_back(boost::make_shared<std::thread>([io_service]() {
+            io_service->run();
+        }));
+    }
+}
+
+void
+D2UpdateMgr::stopThreads() {
+    pauseThreads();
+
+    // Run what is left, i.e. the release of the last finished transactions.
+    for (auto const& io_service : thread_io_services_) {
+        io_service->restart();
+        io_service->poll();
+    }
+
+    threads_.clear();
+    thread_io_services_.clear();
+}
+
+void
+D2UpdateMgr::pauseThreads() {
+    for (auto const& io_service : thread_io_services_) {
+        io_service->stop();
+    }
+
+    for (auto const& thread : threads_) {
+        if (thread->joinable()) {
+            thread->join();
+        }
+    }
+}
+
+void
+D2UpdateMgr::resumeThreads() {
+    for (size_t i = 0; i < threads_.size(); ++i) {
+        if (threads_[i]->joinable()) {
+            continue;
+        }
+
+        asiolink::IOServicePtr io_service = thread_io_services_[i];
+        io_service->restart();
+        threads_[i] = boost::make_shared<std::thread>([io_service]() {
+            io_service->run();
+        });
+    }
 }
 
 TransactionList::iterator
@@ -11,6 +11,7 @@
 
 #include <asiolink/io_service.h>
 #include <d2/d2_queue_mgr.h>
+#include <d2/nc_batch.h>
 #include <d2srv/nc_trans.h>
 #include <d2srv/d2_cfg_mgr.h>
 #include <d2srv/d2_log.h>
@@ -18,7 +19,11 @@
 
 #include <boost/noncopyable.hpp>
 #include <boost/shared_ptr.hpp>
+#include <list>
 #include <map>
+#include <set>
+#include <thread>
+#include <vector>
 
 namespace isc {
 namespace d2 {
@@ -62,6 +67,21 @@ typedef std::map<TransactionKey, NameChangeTransactionPtr> TransactionList;
 /// The upper layer(s) are responsible for calling sweep in a timely and cyclic
 /// manner.
 ///
+/// By default the transactions run on the IOService of the upper layer(s).
+/// When a non-zero thread count is set, D2UpdateMgr starts that many threads,
+/// each running its own IOService, and runs each transaction on the thread
+/// selected by the hash of the request FQDN.  Requests for a given FQDN are
+/// never processed concurrently, so the updates of a given name are still
+/// carried out in the order in which they were received.  The request queue
+/// and the transaction list are only ever accessed by the upper layer's
+/// thread: the threads notify it of the completion of a transaction by
+/// posting to its IOService.
+///
+/// When a batch size greater than one is set, the forward changes of the
+/// transactions for the same forward domain are carried out by a single
+/// DNS update, see NameChangeBatch.  The transactions are then started
+/// by the batch once the batched update is done.
+///
 class D2UpdateMgr : public boost::noncopyable {
 public:
     /// @brief Maximum number of concurrent transactions
@@ -84,6 +104,8 @@ public:
                 const size_t max_transactions = MAX_TRANSACTIONS_DEFAULT);
 
     /// @brief Destructor
+    ///
+    /// Stops the update threads, if any.
     virtual ~D2UpdateMgr();
 
     /// @brief Check current transactions; start transactions for new requests.
@@ -100,8 +122,58 @@ public:
     ///
     /// - If a request was selected, start a new transaction for it and
     /// add the transaction to the list of transactions.
+    ///
+    /// In multi-threaded mode, or when batching is enabled, it starts
+    /// transactions until either the maximum is reached or there are no
+    /// eligible requests, then sends the batched updates.  If a new
+    /// thread count is pending, no transactions are started until all of
+    /// the transactions in progress are done and the new thread count has
+    /// been applied.
     void sweep();
 
+    /// @brief Sets the number of threads carrying out the DNS updates.
+    ///
+    /// If there are no transactions in progress the new thread count is
+    /// applied immediately, otherwise it is applied by sweep() once all
+    /// of the transactions in progress are done.
+    ///
+    /// @param thread_count number of threads, 0 to run the transactions
+    /// on the upper layer's IOService.
+    void setThreadCount(const size_t thread_count);
+
+    /// @brief Sets the maximum number of forward changes per DNS update.
+    ///
+    /// @param batch_size the batch size, 0 or 1 to disable batching.
+    void setBatchSize(const size_t batch_size) {
+        batch_size_ = batch_size;
+    }
+
+    /// @brief Returns the maximum number of forward changes per DNS update.
+    size_t getBatchSize() const {
+        return (batch_size_);
+    }
+
+    /// @brief Returns the number of batched updates in progress.
+    size_t getBatchCount() const {
+        return (batch_list_.size());
+    }
+
+    /// @brief Returns the number of running update threads.
+    size_t getThreadCount() const {
+        return (threads_.size());
+    }
+
+    /// @brief Suspends the update threads.
+    ///
+    /// Stops the IOServices of the update threads and waits for the
+    /// threads to exit.  The handlers which are pending are kept and
+    /// run once the threads are resumed.  It is used to make sure that
+    /// no transaction is running while the configuration is replaced.
+    void pauseThreads();
+
+    /// @brief Resumes the update threads suspended by pauseThreads().
+    void resumeThreads();
+
 protected:
     /// @brief Performs post-completion cleanup on completed transactions.
     ///
@@ -123,7 +195,12 @@ protected:
     /// It is possible that no such request exists, though this is likely to be
     /// rather rare unless a system is frequently seeing requests for the same
     /// clients in quick succession.
-    void pickNextJob();
+    ///
+    /// In multi-threaded mode, requests for an FQDN which has a transaction
+    /// in progress are not eligible either.
+    ///
+    /// @return true if a request was dequeued, false otherwise.
+    bool pickNextJob();
 
     /// @brief Create a new transaction for the given request.
     ///
@@ -162,6 +239,8 @@ public:
     }
 
     /// @brief Returns the maximum number of concurrent transactions.
+    ///
+    /// In multi-threaded mode the limit applies to each thread.
     size_t getMaxTransactions() const {
         return (max_transactions_);
     }
@@ -227,11 +306,73 @@ private:
     /// @brief Primary IOService instance.
     /// This is the IOService that the upper layer(s) use for IO events, such
     /// as shutdown and configuration commands.  It is the IOService that is
-    /// passed into transactions to manager their IO events.
-    /// (For future reference, multi-threaded transactions would each use their
-    /// own IOService instance.)
+    /// passed into transactions to manager their IO events when no update
+    /// threads are running.
     asiolink::IOServicePtr io_service_;
 
+    /// @brief Starts the given number of update threads.
+    ///
+    /// @param thread_count number of threads to start.
+    void startThreads(const size_t thread_count);
+
+    /// @brief Stops the update threads, runs the handlers they left and
+    /// discards their IOServices.
+    void stopThreads();
+
+    /// @brief Returns the IOService on which to run a transaction.
+    ///
+    /// @param fqdn the FQDN of the request.
+    ///
+    /// @return the IOService of the update thread selected by the FQDN,
+    /// or the primary IOService if there are no update threads.
+    asiolink::IOServicePtr& selectIOService(const std::string& fqdn);
+
+    /// @brief Adds a transaction to the batch of its forward domain.
+    ///
+    /// The batch is sent as soon as it is full.
+    ///
+    /// @param trans the transaction, which must not have been started.
+    /// @param domain the forward domain of the transaction.
+    /// @param io_service the IOService on which to start the transaction.
+    ///
+    /// @return true if the transaction was added to a batch, false if it
+    /// must be started on its own.
+    bool batchTransaction(const NameChangeTransactionPtr& trans,
+                          const DdnsDomainPtr& domain,
+                          const asiolink::IOServicePtr& io_service);
+
+    /// @brief Sends the batches which are not full.
+    void startBatches();
+
+    /// @brief Sends a batch and adds it to the list of batches in progress.
+    ///
+    /// @param batch the batch to send.
+    void startBatch(const NameChangeBatchPtr& batch);
+
+    /// @brief IOServices of the update threads.
+    std::vector<asiolink::IOServicePtr> thread_io_services_;
+
+    /// @brief Update threads.
+    std::vector<boost::shared_ptr<std::thread> > threads_;
+
+    /// @brief Indicates that a new thread count is waiting to be applied.
+    bool thread_count_pending_;
+
+    /// @brief Thread count to apply once the transactions are done.
+    size_t pending_thread_count_;
+
+    /// @brief FQDNs of the transactions in progress in multi-threaded mode.
+    std::set<std::string> fqdns_in_progress_;
+
+    /// @brief Maximum number of forward changes per DNS update.
+    size_t batch_size_;
+
+    /// @brief Batches being filled, by forward domain name.
+    std::map<std::string, NameChangeBatchPtr> pending_batches_;
+
+    /// @brief Batches in progress.
+    std::list<NameChangeBatchPtr> batch_list_;
+
     /// @brief Maximum number of concurrent transactions.
     size_t max_transactions_;
 
@@ -92,6 +92,12 @@ public:
     /// @brief Destructor
     virtual ~NameAddTransaction();
 
+    /// @brief Builds the forward update request for inclusion in a batch.
+    ///
+    /// @return the request which adds the forward mapping when the FQDN is not in use, or an empty pointer if the request has no forward
+    /// change.
+    virtual D2UpdateMessagePtr buildBatchedFwdRequest();
+
 protected:
     /// @brief Adds events defined by NameAddTransaction to the event set.
     ///
@@ -0,0 +1,200 @@
+// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <d2/nc_batch.h>
+#include <d2srv/d2_log.h>
+#include <dns/qid_gen.h>
+
+#include <boost/algorithm/string/case_conv.hpp>
+
+#include <sstream>
+
+namespace {
+
+using namespace isc::d2;
+
+/// @brief Appends the RRsets of a section of a request to another request.
+///
+/// @param from the request to copy the RRsets from.
+/// @param to the request to append the RRsets to.
+/// @param section the section to copy.
+void
+copySection(const D2UpdateMessage& from, D2UpdateMessage& to,
+            const D2UpdateMessage::UpdateMsgSection section) {
+    for (auto rrset = from.beginSection(section);
+         rrset != from.endSection(section); ++rrset) {
+        to.addRRset(section, *rrset);
+    }
+}
+
+} // end of anonymous namespace
+
+namespace isc {
+namespace d2 {
+
+NameChangeBatch::NameChangeBatch(const asiolink::IOServicePtr& io_service,
+                                 const DdnsDomainPtr& domain,
+                                 const D2CfgMgrPtr& cfg_mgr)
+    : io_service_(io_service), domain_(domain), cfg_mgr_(cfg_mgr),
+      transactions_(), fqdns_(), requests_(), request_(), response_(),
+      server_(), dns_client_(), done_(false) {
+    if (!io_service_) {
+        isc_throw(NameChangeBatchError, "IOServicePtr cannot be null");
+    }
+
+    if (!domain_) {
+        isc_throw(NameChangeBatchError, "Forward domain cannot be null");
+    }
+
+    if (!cfg_mgr_) {
+        isc_throw(NameChangeBatchError,
+                  "Configuration manager cannot be null");
+    }
+}
+
+NameChangeBatch::~NameChangeBatch() {
+}
+
+bool
+NameChangeBatch::addTransaction(const NameChangeTransactionPtr& trans,
+                                const asiolink::IOServicePtr& io_service) {
+    const std::string& ncr_fqdn = trans->getNcr()->getFqdn();
+    std::string fqdn = boost::algorithm::to_lower_copy(ncr_fqdn);
+    if (fqdns_.count(fqdn)) {
+        return (false);
+    }
+
+    D2UpdateMessagePtr request;
+    try {
+        request = trans->buildBatchedFwdRequest();
+    } catch (const std::exception&) {
+        // Let the transaction build it again and report the error.
+    }
+
+    if (!request) {
+        return (false);
+    }
+
+    fqdns_.insert(fqdn);
+    transactions_.push_back(std::make_pair(trans, io_service));
+    requests_.push_back(request);
+    return (true);
+}
+
+void
+NameChangeBatch::start() {
+    if (transactions_.size() == 1) {
+        startTransactions(false);
+        return;
+    }
+
+    try {
+        // Merge the requests of the transactions: each name keeps its own
+        // prerequisites and updates.
+        request_.reset(new D2UpdateMessage(D2UpdateMessage::OUTBOUND));
+        request_->setId(dns::QidGenerator::getInstance().generateQid());
+        request_->setZone(dns::Name(domain_->getName()), dns::RRClass::IN());
+        for (auto const& request : requests_) {
+            copySection(*request, *request_,
+                        D2UpdateMessage::SECTION_PREREQUISITE);
+            copySection(*request, *request_, D2UpdateMessage::SECTION_UPDATE);
+        }
+
+        // The servers of the domain are tried by the transactions when the
+        // batch fails, so the batch only uses the first enabled one.
+        const DnsServerInfoStoragePtr& servers = domain_->getServers();
+        for (auto const& server : *servers) {
+            if (server->isEnabled()) {
+                server_ = server;
+                break;
+            }
+        }
+
+        if (!server_) {
+            isc_throw(NameChangeBatchError, "no enabled server in domain: "
+                      << domain_->getName());
+        }
+
+        D2TsigKeyPtr tsig_key;
+        TSIGKeyInfoPtr tsig_key_info = server_->getTSIGKeyInfo();
+        if (tsig_key_info) {
+            tsig_key = tsig_key_info->getTSIGKey();
+        }
+
+        D2ParamsPtr d2_params = cfg_mgr_->getD2Params();
+        DNSClient::Protocol proto = DNSClient::UDP;
+        if (d2_params->getDnsServerProtocol() == dhcp_ddns::NCR_TCP) {
+            proto = DNSClient::TCP;
+        }
+
+        dns_client_.reset(new DNSClient(response_, this, proto));
+        dns_client_->doUpdate(*io_service_, server_->getIpAddress(),
+                              server_->getPort(), *request_,
+                              d2_params->getDnsServerTimeout(), tsig_key);
+
+        LOG_DEBUG(d2_to_dns_logger, isc::log::DBGLVL_TRACE_DETAIL,
+                  DHCP_DDNS_BATCH_UPDATE_SENT)
+            .arg(transactions_.size())
+            .arg(domain_->getName())
+            .arg(server_->toText());
+    } catch (const std::exception& ex) {
+        LOG_ERROR(d2_to_dns_logger, DHCP_DDNS_BATCH_UPDATE_SEND_ERROR)
+            .arg(transactions_.size())
+            .arg(domain_->getName())
+            .arg(ex.what());
+        startTransactions(false);
+    }
+}
+
+void
+NameChangeBatch::operator()(DNSClient::Status status) {
+    if ((status == DNSClient::SUCCESS) &&
+        (response_->getRcode() == dns::Rcode::NOERROR())) {
+        LOG_DEBUG(d2_to_dns_logger, isc::log::DBGLVL_TRACE_DETAIL,
+                  DHCP_DDNS_BATCH_UPDATE_COMPLETED)
+            .arg(transactions_.size())
+            .arg(domain_->getName())
+            .arg(server_->toText());
+        startTransactions(true);
+        return;
+    }
+
+    std::ostringstream reason;
+    if (status == DNSClient::SUCCESS) {
+        reason << "rcode " << response_->getRcode().toText();
+    } else {
+        reason << "DNS client status " << status;
+    }
+
+    // This is expected when one of the names is in use: the transactions
+    // will sort it out one by one.
+    LOG_DEBUG(d2_to_dns_logger, isc::log::DBGLVL_TRACE_DETAIL,
+              DHCP_DDNS_BATCH_UPDATE_FAILED)
+        .arg(transactions_.size())
+        .arg(domain_->getName())
+        .arg(server_->toText())
+        .arg(reason.str());
+    startTransactions(false);
+}
+
+void
+NameChangeBatch::startTransactions(const bool forward_done) {
+    for (auto const& entry : transactions_) {
+        NameChangeTransactionPtr trans = entry.first;
+        if (forward_done) {
+            trans->setForwardChangeBatched();
+        }
+
+        entry.second->post([trans]() { trans->startTransaction(); });
+    }
+
+    done_ = true;
+}
+
+} // namespace isc::d2
+} // namespace isc
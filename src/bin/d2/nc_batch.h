@@ -0,0 +1,169 @@
+// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef NC_BATCH_H
+#define NC_BATCH_H
+
+/// @file nc_batch.h This file defines the class NameChangeBatch.
+
+#include <asiolink/io_service.h>
+#include <d2srv/d2_cfg_mgr.h>
+#include <d2srv/dns_client.h>
+#include <d2srv/nc_trans.h>
+#include <exceptions/exceptions.h>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <atomic>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace isc {
+namespace d2 {
+
+/// @brief Thrown if the NameChangeBatch encounters a general error.
+class NameChangeBatchError : public isc::Exception {
+public:
+    NameChangeBatchError(const char* file, size_t line, const char* what) :
+        isc::Exception(file, line, what) { };
+};
+
+/// @brief Carries out the forward changes of several transactions in a
+/// single DNS update.
+///
+/// RFC 2136 allows a single DNS update message to carry the prerequisites
+/// and updates of many names within the same zone.  NameChangeBatch
+/// collects the transactions whose forward changes target the same
+/// domain, and therefore the same DNS servers, and merges their forward
+/// update requests into one message.  The prerequisites of each name are
+/// kept as they are, so the server still checks them name by name.
+///
+/// The batched update is sent to the first enabled server of the domain,
+/// using the configured transport protocol.
+/// If it succeeds, the transactions are started with their forward change
+/// completed and only carry out their reverse change.  Otherwise, e.g. when
+/// the prerequisites of one of the names are not met or the server cannot
+/// be reached, the transactions are started as if there had been no batch:
+/// each of them carries out its own forward change, with its own conflict
+/// resolution and server selection.
+///
+/// The transactions of a batch must not be started by anyone else.  They
+/// are started by posting to the IOService given with each of them.
+class NameChangeBatch : public DNSClient::Callback,
+                        public boost::noncopyable {
+public:
+    /// @brief Constructor
+    ///
+    /// @param io_service IO service used for the batched update
+    /// @param domain the forward domain of the transactions
+    /// @param cfg_mgr pointer to the configuration manager
+    ///
+    /// @throw NameChangeBatchError if any of the arguments is null.
+    NameChangeBatch(const asiolink::IOServicePtr& io_service,
+                    const DdnsDomainPtr& domain,
+                    const D2CfgMgrPtr& cfg_mgr);
+
+    /// @brief Destructor
+    virtual ~NameChangeBatch();
+
+    /// @brief Adds a transaction to the batch.
+    ///
+    /// @param trans the transaction, which must not have been started.
+    /// @param io_service the IO service on which to start the transaction.
+    ///
+    /// @return true if the transaction was added, false if its forward
+    /// change cannot be batched or if the batch already holds a change for
+    /// the same FQDN: the prerequisites of both would be checked before
+    /// either of them is applied.
+    bool addTransaction(const NameChangeTransactionPtr& trans,
+                        const asiolink::IOServicePtr& io_service);
+
+    /// @brief Returns the number of transactions in the batch.
+    size_t getTransactionCount() const {
+        return (transactions_.size());
+    }
+
+    /// @brief Sends the batched update.
+    ///
+    /// If the batch holds a single transaction, the transaction is started
+    /// right away.  This method must be invoked by the thread running the
+    /// IO service of the batch.
+    void start();
+
+    /// @brief Serves as the DNSClient IO completion event handler.
+    ///
+    /// Starts the transactions of the batch, with their forward change
+    /// completed if the batched update succeeded.
+    ///
+    /// @param status is the outcome of the DNS update packet exchange.
+    virtual void operator()(DNSClient::Status status);
+
+    /// @brief Indicates if the transactions of the batch were started.
+    bool isDone() const {
+        return (done_);
+    }
+
+    /// @brief Returns the IO service used for the batched update.
+    const asiolink::IOServicePtr& getIOService() const {
+        return (io_service_);
+    }
+
+    /// @brief Returns the batched update request.
+    const D2UpdateMessagePtr& getDnsUpdateRequest() const {
+        return (request_);
+    }
+
+private:
+    /// @brief Starts the transactions of the batch.
+    ///
+    /// @param forward_done true if the batched update succeeded.
+    void startTransactions(const bool forward_done);
+
+    /// @brief IO service used for the batched update.
+    asiolink::IOServicePtr io_service_;
+
+    /// @brief The forward domain of the transactions.
+    DdnsDomainPtr domain_;
+
+    /// @brief Pointer to the configuration manager.
+    D2CfgMgrPtr cfg_mgr_;
+
+    /// @brief The transactions with the IO service to start them on.
+    std::vector<std::pair<NameChangeTransactionPtr,
+                          asiolink::IOServicePtr> > transactions_;
+
+    /// @brief The FQDNs of the transactions, in lower case.
+    std::set<std::string> fqdns_;
+
+    /// @brief The forward update requests of the transactions.
+    std::vector<D2UpdateMessagePtr> requests_;
+
+    /// @brief The batched update request.
+    D2UpdateMessagePtr request_;
+
+    /// @brief The response to the batched update.
+    D2UpdateMessagePtr response_;
+
+    /// @brief The server to which the batched update is sent.
+    DnsServerInfoPtr server_;
+
+    /// @brief The DNS client used to send the batched update.
+    DNSClientPtr dns_client_;
+
+    /// @brief Indicates that the transactions were started.
+    std::atomic<bool> done_;
+};
+
+/// @brief Defines a pointer to a NameChangeBatch.
+typedef boost::shared_ptr<NameChangeBatch> NameChangeBatchPtr;
+
+} // namespace isc::d2
+} // namespace isc
+
+#endif
@@ -115,16 +115,31 @@ SimpleAddTransaction::verifyStates() {
     getStateInternal(REPLACING_REV_PTRS_ST);
 }
 
+D2UpdateMessagePtr
+SimpleAddTransaction::buildBatchedFwdRequest() {
+    if (!getForwardDomain()) {
+        return (D2UpdateMessagePtr());
+    }
+
+    buildReplaceFwdAddressRequest();
+    D2UpdateMessagePtr request = getDnsUpdateRequest();
+    clearDnsUpdateRequest();
+    return (request);
+}
+
 void
 SimpleAddTransaction::readyHandler() {
     switch(getNextEvent()) {
     case START_EVT:
-        if (getForwardDomain()) {
+        if (getForwardDomain() && !getForwardChangeCompleted()) {
             // Request includes a forward change, do that first.
             transition(SELECTING_FWD_SERVER_ST, SELECT_SERVER_EVT);
-        } else {
+        } else if (getReverseDomain()) {
             // Reverse change only, transition accordingly.
             transition(SELECTING_REV_SERVER_ST, SELECT_SERVER_EVT);
+        } else {
+            // The forward change was done by a batched update.
+            transition(PROCESS_TRANS_OK_ST, UPDATE_OK_EVT);
         }
 
         break;
@@ -84,6 +84,12 @@ public:
     /// @brief Destructor
     virtual ~SimpleAddTransaction();
 
+    /// @brief Builds the forward update request for inclusion in a batch.
+    ///
+    /// @return the request which replaces the forward mapping, or an empty pointer if the request has no forward
+    /// change.
+    virtual D2UpdateMessagePtr buildBatchedFwdRequest();
+
 protected:
     /// @brief Adds events defined by SimpleAddTransaction to the event set.
     ///
@@ -83,6 +83,12 @@ public:
     /// @brief Destructor
     virtual ~SimpleRemoveTransaction();
 
+    /// @brief Builds the forward update request for inclusion in a batch.
+    ///
+    /// @return the request which removes the forward mapping, or an empty pointer if the request has no forward
+    /// change.
+    virtual D2UpdateMessagePtr buildBatchedFwdRequest();
+
 protected:
     /// @brief Adds events defined by SimpleRemoveTransaction to the event set.
     ///
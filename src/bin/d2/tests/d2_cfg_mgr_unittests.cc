@@ -243,6 +243,13 @@ TEST_F(D2CfgMgrTest, validParamsEntry) {
     EXPECT_EQ(333, d2_params_->getDnsServerTimeout());
     EXPECT_EQ(dhcp_ddns::NCR_UDP, d2_params_->getNcrProtocol());
     EXPECT_EQ(dhcp_ddns::FMT_JSON, d2_params_->getNcrFormat());
+    EXPECT_EQ(0, d2_params_->getDnsUpdateThreads());
+    EXPECT_EQ(0, d2_params_->getDnsUpdateBatchSize());
+    EXPECT_EQ(dhcp_ddns::NCR_UDP, d2_params_->getDnsServerProtocol());
+    EXPECT_EQ(D2Params::DFT_DNS_SERVER_CONNECTIONS,
+              d2_params_->getDnsServerConnections());
+    EXPECT_EQ(D2Params::DFT_DNS_SERVER_IDLE_TIMEOUT,
+              d2_params_->getDnsServerIdleTimeout());
 
     // Verify that ip_address can be valid v6 address.
     config = makeParamsConfigString ("3001::5", 777, 333, "UDP", "JSON");
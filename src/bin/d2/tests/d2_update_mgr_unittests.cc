@@ -14,6 +14,7 @@
 #include <d2/simple_add.h>
 #include <d2/simple_remove.h>
 #include <process/testutils/d_test_stubs.h>
+#include <util/multi_threading_mgr.h>
 #include <util/time_utilities.h>
 
 #include <gtest/gtest.h>
@@ -82,6 +83,8 @@ public:
     }
 
     ~D2UpdateMgrTest() {
+        update_mgr_.reset();
+        MultiThreadingMgr::instance().setMode(false);
     }
 
     /// @brief Creates a list of valid NameChangeRequest.
@@ -847,6 +850,136 @@ TEST_F(D2UpdateMgrTest, multiTransaction) {
     }
 }
 
+/// @brief Tests processing of multiple transactions by update threads.
+/// This test verifies that update manager runs the transactions on its
+/// update threads when a thread count is set, and that requests for the
+/// same FQDN are never processed concurrently while requests for distinct
+/// FQDNs are.
+TEST_F(D2UpdateMgrTest, multiThreadedTransaction) {
+    ASSERT_NO_THROW(update_mgr_->setThreadCount(2));
+    EXPECT_EQ(2, update_mgr_->getThreadCount());
+    EXPECT_TRUE(MultiThreadingMgr::instance().getMode());
+
+    // Queue up all the requests: the first two share the same FQDN.
+    const char* fqdns[] = { "my.example.com.", "MY.example.com.",
+                            "two.example.com.", "three.example.com." };
+    int test_count = canned_count_;
+    for (int i = 0; i < test_count; i++) {
+        canned_ncrs_[i]->setFqdn(fqdns[i]);
+        canned_ncrs_[i]->setReverseChange(true);
+        ASSERT_NO_THROW(queue_mgr_->enqueue(canned_ncrs_[i]));
+    }
+
+    asiolink::IOAddress server_ip("127.0.0.1");
+    FauxServer server(*io_service_, server_ip, 5301);
+    server.receive(FauxServer::USE_RCODE, dns::Rcode::NOERROR());
+
+    // The first sweep starts a transaction for each distinct FQDN.
+    update_mgr_->sweep();
+    EXPECT_EQ(3, update_mgr_->getTransactionCount());
+    EXPECT_EQ(1, update_mgr_->getQueueCount());
+    EXPECT_TRUE(update_mgr_->hasTransaction(canned_ncrs_[0]->getDhcid()));
+    EXPECT_FALSE(update_mgr_->hasTransaction(canned_ncrs_[1]->getDhcid()));
+
+    // Run sweep and IO until everything is done. The threads post to the
+    // primary IOService when their transactions complete.
+    size_t timeout = cfg_mgr_->getD2Params()->getDnsServerTimeout() + 100;
+    size_t passes = 0;
+    while (update_mgr_->getQueueCount() ||
+           update_mgr_->getTransactionCount()) {
+        ASSERT_LT(++passes, 100);
+        update_mgr_->sweep();
+        ASSERT_GT(runTimedIO(timeout), 0);
+    }
+
+    for (int i = 0; i < test_count; i++) {
+        EXPECT_EQ(dhcp_ddns::ST_COMPLETED, canned_ncrs_[i]->getStatus());
+    }
+
+    // Going back to zero threads returns to single-threaded mode.
+    ASSERT_NO_THROW(update_mgr_->setThreadCount(0));
+    EXPECT_EQ(0, update_mgr_->getThreadCount());
+    EXPECT_FALSE(MultiThreadingMgr::instance().getMode());
+}
+
+/// @brief Tests batching of the forward changes.
+/// This test verifies that update manager carries out the forward changes
+/// of the requests for the same domain in a single DNS update when a batch
+/// size is set, and that the transactions then complete normally.
+TEST_F(D2UpdateMgrTest, batchedTransactions) {
+    update_mgr_->setBatchSize(3);
+    EXPECT_EQ(3, update_mgr_->getBatchSize());
+
+    const char* fqdns[] = { "one.example.com.", "two.example.com.",
+                            "three.example.com.", "four.example.com." };
+    int test_count = canned_count_;
+    for (int i = 0; i < test_count; i++) {
+        canned_ncrs_[i]->setFqdn(fqdns[i]);
+        canned_ncrs_[i]->setChangeType(dhcp_ddns::CHG_ADD);
+        ASSERT_NO_THROW(queue_mgr_->enqueue(canned_ncrs_[i]));
+    }
+
+    asiolink::IOAddress server_ip("127.0.0.1");
+    FauxServer server(*io_service_, server_ip, 5301);
+    server.receive(FauxServer::USE_RCODE, dns::Rcode::NOERROR());
+
+    // A single sweep starts all of the transactions: the first three go
+    // in a full batch, the last one in a batch of its own which starts it
+    // right away.
+    update_mgr_->sweep();
+    EXPECT_EQ(0, update_mgr_->getQueueCount());
+    EXPECT_EQ(test_count, update_mgr_->getTransactionCount());
+    EXPECT_EQ(2, update_mgr_->getBatchCount());
+
+    size_t timeout = cfg_mgr_->getD2Params()->getDnsServerTimeout() + 100;
+    size_t passes = 0;
+    while (update_mgr_->getTransactionCount()) {
+        ASSERT_LT(++passes, 100);
+        update_mgr_->sweep();
+        if (update_mgr_->getTransactionCount()) {
+            ASSERT_GT(runTimedIO(timeout), 0);
+        }
+    }
+
+    EXPECT_EQ(0, update_mgr_->getBatchCount());
+    for (int i = 0; i < test_count; i++) {
+        EXPECT_EQ(dhcp_ddns::ST_COMPLETED, canned_ncrs_[i]->getStatus());
+    }
+}
+
+/// @brief Tests that a new thread count waits for the transactions.
+/// This test verifies that a thread count set while transactions are in
+/// progress is applied by sweep() only once they are all done, and that no
+/// new transaction is started in the meantime.
+TEST_F(D2UpdateMgrTest, deferredThreadCount) {
+    ASSERT_NO_THROW(queue_mgr_->enqueue(canned_ncrs_[0]));
+    ASSERT_NO_THROW(queue_mgr_->enqueue(canned_ncrs_[1]));
+
+    // Start a transaction on the primary IOService.
+    ASSERT_TRUE(update_mgr_->pickNextJob());
+    ASSERT_EQ(1, update_mgr_->getTransactionCount());
+
+    // The thread count cannot be applied yet.
+    ASSERT_NO_THROW(update_mgr_->setThreadCount(2));
+    EXPECT_EQ(0, update_mgr_->getThreadCount());
+
+    // Sweeping does not start new transactions.
+    update_mgr_->sweep();
+    EXPECT_EQ(1, update_mgr_->getTransactionCount());
+    EXPECT_EQ(1, update_mgr_->getQueueCount());
+
+    // Once the transaction is done, the threads are started.
+    completeTransaction(0, dhcp_ddns::ST_COMPLETED);
+    queue_mgr_->clearQueue();
+    update_mgr_->sweep();
+    EXPECT_EQ(0, update_mgr_->getTransactionCount());
+    EXPECT_EQ(2, update_mgr_->getThreadCount());
+    EXPECT_TRUE(MultiThreadingMgr::instance().getMode());
+
+    ASSERT_NO_THROW(update_mgr_->setThreadCount(0));
+    EXPECT_EQ(0, update_mgr_->getThreadCount());
+}
+
 /// @brief Tests processing of multiple transactions.
 /// This test verifies that update manager can create and manage a multiple
 /// transactions, concurrently.  It uses a fake server that responds to all
@@ -0,0 +1,217 @@
+// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <asiolink/io_service.h>
+#include <d2/nc_add.h>
+#include <d2/nc_batch.h>
+#include <d2/nc_remove.h>
+#include <d2/simple_add.h>
+#include <d2srv/d2_cfg_mgr.h>
+#include <d2srv/testutils/nc_test_utils.h>
+
+#include <gtest/gtest.h>
+
+using namespace std;
+using namespace isc;
+using namespace isc::d2;
+
+namespace {
+
+/// @brief Test fixture for testing NameChangeBatch.
+class NameChangeBatchTest : public TransactionTest {
+public:
+    NameChangeBatchTest() {
+    }
+
+    virtual ~NameChangeBatchTest() {
+    }
+
+    /// @brief Creates a transaction for the given FQDN.
+    ///
+    /// @param fqdn the FQDN of the request.
+    /// @param change_type CHG_ADD or CHG_REMOVE.
+    /// @param change_mask determines which change directions are requested.
+    /// @param conflict_resolution whether conflict resolution is used.
+    NameChangeTransactionPtr
+    makeTransaction(const std::string& fqdn,
+                    dhcp_ddns::NameChangeType change_type = dhcp_ddns::CHG_ADD,
+                    int change_mask = FORWARD_CHG,
+                    bool conflict_resolution = true) {
+        setupForIPv4Transaction(change_type, change_mask);
+        ncr_->setFqdn(fqdn);
+        NameChangeTransactionPtr trans;
+        if (change_type == dhcp_ddns::CHG_ADD) {
+            if (conflict_resolution) {
+                trans.reset(new NameAddTransaction(io_service_, ncr_,
+                                                   forward_domain_,
+                                                   reverse_domain_,
+                                                   cfg_mgr_));
+            } else {
+                trans.reset(new SimpleAddTransaction(io_service_, ncr_,
+                                                     forward_domain_,
+                                                     reverse_domain_,
+                                                     cfg_mgr_));
+            }
+        } else {
+            trans.reset(new NameRemoveTransaction(io_service_, ncr_,
+                                                  forward_domain_,
+                                                  reverse_domain_,
+                                                  cfg_mgr_));
+        }
+
+        return (trans);
+    }
+
+    /// @brief Creates a batch for the forward domain of the last transaction.
+    NameChangeBatchPtr makeBatch() {
+        return (NameChangeBatchPtr(new NameChangeBatch(io_service_,
+                                                       forward_domain_,
+                                                       cfg_mgr_)));
+    }
+
+    /// @brief Runs IO until the given transactions are done.
+    ///
+    /// @param transactions the transactions to wait for.
+    void
+    runUntilDone(const std::vector<NameChangeTransactionPtr>& transactions) {
+        size_t timeout = cfg_mgr_->getD2Params()->getDnsServerTimeout() + 100;
+        for (int passes = 0; passes < 100; ++passes) {
+            bool done = true;
+            for (auto const& trans : transactions) {
+                if (!trans->isModelDone()) {
+                    done = false;
+                }
+            }
+
+            if (done) {
+                return;
+            }
+
+            ASSERT_GT(runTimedIO(timeout), 0);
+        }
+
+        FAIL() << "transactions are not done";
+    }
+};
+
+/// @brief Tests NameChangeBatch construction.
+TEST_F(NameChangeBatchTest, construction) {
+    makeTransaction("my.example.com.");
+    asiolink::IOServicePtr empty_io;
+    DdnsDomainPtr empty_domain;
+    D2CfgMgrPtr empty_cfg;
+
+    EXPECT_THROW(NameChangeBatch(empty_io, forward_domain_, cfg_mgr_),
+                 NameChangeBatchError);
+    EXPECT_THROW(NameChangeBatch(io_service_, empty_domain, cfg_mgr_),
+                 NameChangeBatchError);
+    EXPECT_THROW(NameChangeBatch(io_service_, forward_domain_, empty_cfg),
+                 NameChangeBatchError);
+    EXPECT_NO_THROW(NameChangeBatch(io_service_, forward_domain_, cfg_mgr_));
+}
+
+/// @brief Tests which transactions can be added to a batch.
+TEST_F(NameChangeBatchTest, addTransaction) {
+    NameChangeBatchPtr batch;
+    makeTransaction("one.example.com.");
+    ASSERT_NO_THROW(batch = makeBatch());
+
+    EXPECT_TRUE(batch->addTransaction(makeTransaction("one.example.com."),
+                                      io_service_));
+    EXPECT_TRUE(batch->addTransaction(makeTransaction("two.example.com.",
+                                                      dhcp_ddns::CHG_ADD,
+                                                      FWD_AND_REV_CHG, false),
+                                      io_service_));
+
+    // A second change for the same name is not allowed.
+    EXPECT_FALSE(batch->addTransaction(makeTransaction("ONE.example.com."),
+                                       io_service_));
+
+    // Nor are reverse only changes.
+    EXPECT_FALSE(batch->addTransaction(makeTransaction("three.example.com.",
+                                                       dhcp_ddns::CHG_ADD,
+                                                       REVERSE_CHG),
+                                       io_service_));
+
+    // Nor removals with conflict resolution, which take two updates.
+    EXPECT_FALSE(batch->addTransaction(makeTransaction("four.example.com.",
+                                                       dhcp_ddns::CHG_REMOVE),
+                                       io_service_));
+
+    EXPECT_EQ(2, batch->getTransactionCount());
+}
+
+/// @brief Tests that a batch merges the requests of its transactions and
+/// that its transactions only do their reverse change when the batched
+/// update succeeds.
+TEST_F(NameChangeBatchTest, batchedUpdate) {
+    std::vector<NameChangeTransactionPtr> transactions;
+    transactions.push_back(makeTransaction("one.example.com.",
+                                           dhcp_ddns::CHG_ADD,
+                                           FWD_AND_REV_CHG));
+    transactions.push_back(makeTransaction("two.example.com."));
+    transactions.push_back(makeTransaction("three.example.com."));
+    NameChangeBatchPtr batch = makeBatch();
+    for (auto const& trans : transactions) {
+        ASSERT_TRUE(batch->addTransaction(trans, io_service_));
+    }
+
+    asiolink::IOAddress server_ip("127.0.0.1");
+    FauxServer server(*io_service_, server_ip, 5301);
+    server.receive(FauxServer::USE_RCODE, dns::Rcode::NOERROR());
+
+    ASSERT_NO_THROW(batch->start());
+    EXPECT_FALSE(batch->isDone());
+
+    // Each name keeps its own prerequisite and updates.
+    D2UpdateMessagePtr request = batch->getDnsUpdateRequest();
+    ASSERT_TRUE(request);
+    checkZone(request, "example.com.");
+    checkRRCount(request, D2UpdateMessage::SECTION_PREREQUISITE, 3);
+    checkRRCount(request, D2UpdateMessage::SECTION_UPDATE, 6);
+
+    ASSERT_NO_FATAL_FAILURE(runUntilDone(transactions));
+    EXPECT_TRUE(batch->isDone());
+    for (auto const& trans : transactions) {
+        EXPECT_TRUE(trans->getForwardChangeCompleted());
+        EXPECT_EQ(dhcp_ddns::ST_COMPLETED, trans->getNcrStatus());
+    }
+
+    // Only the first transaction had a reverse change to do.
+    EXPECT_TRUE(transactions[0]->getReverseChangeCompleted());
+}
+
+/// @brief Tests that the transactions of a failed batch carry out their
+/// forward change on their own.
+TEST_F(NameChangeBatchTest, batchedUpdateFailed) {
+    std::vector<NameChangeTransactionPtr> transactions;
+    transactions.push_back(makeTransaction("one.example.com."));
+    transactions.push_back(makeTransaction("two.example.com."));
+    NameChangeBatchPtr batch = makeBatch();
+    for (auto const& trans : transactions) {
+        ASSERT_TRUE(batch->addTransaction(trans, io_service_));
+    }
+
+    // The server refuses everything: the batch fails, then so do the
+    // transactions, after trying on their own.
+    asiolink::IOAddress server_ip("127.0.0.1");
+    FauxServer server(*io_service_, server_ip, 5301);
+    server.receive(FauxServer::USE_RCODE, dns::Rcode::REFUSED());
+
+    ASSERT_NO_THROW(batch->start());
+    ASSERT_NO_FATAL_FAILURE(runUntilDone(transactions));
+    EXPECT_TRUE(batch->isDone());
+    for (auto const& trans : transactions) {
+        EXPECT_FALSE(trans->getForwardChangeCompleted());
+        EXPECT_EQ(dhcp_ddns::ST_FAILED, trans->getNcrStatus());
+        // The transaction sent its own forward update.
+        EXPECT_EQ(1, trans->getUpdateAttempts());
+    }
+}
+
+}
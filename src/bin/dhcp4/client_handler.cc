@@ -1,4 +1,4 @@
-// Copyright (C) 2020-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2020-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -11,6 +11,7 @@
 #include <exceptions/exceptions.h>
 #include <stats/stats_mgr.h>
 #include <util/multi_threading_mgr.h>
+#include <boost/functional/hash.hpp>
 
 using namespace std;
 using namespace isc::util;
@@ -40,28 +41,50 @@ ClientHandler::Client::Client(Pkt4Ptr query, DuidPtr client_id,
     }
 }
 
-mutex ClientHandler::mutex_;
+const size_t ClientHandler::SHARD_COUNT;
 
-ClientHandler::ClientByIdContainer ClientHandler::clients_client_id_;
+array<ClientHandler::Shard, ClientHandler::SHARD_COUNT> ClientHandler::shards_;
 
-ClientHandler::ClientByHWAddrContainer ClientHandler::clients_hwaddr_;
+ClientHandler::Shard&
+ClientHandler::getShard(const DuidPtr& duid) {
+    // Sanity check.
+    if (!duid) {
+        isc_throw(InvalidParameter, "null duid in ClientHandler::getShard");
+    }
+
+    const vector<uint8_t>& key = duid->getDuid();
+    size_t hash = boost::hash_range(key.begin(), key.end());
+    return (shards_[hash % SHARD_COUNT]);
+}
+
+ClientHandler::Shard&
+ClientHandler::getShard(const HWAddrPtr& hwaddr) {
+    // Sanity check.
+    if (!hwaddr) {
+        isc_throw(InvalidParameter, "null hwaddr in ClientHandler::getShard");
+    }
+
+    size_t hash = boost::hash_value(hwaddr->htype_);
+    boost::hash_range(hash, hwaddr->hwaddr_.begin(), hwaddr->hwaddr_.end());
+    return (shards_[hash % SHARD_COUNT]);
+}
 
 ClientHandler::ClientPtr
-ClientHandler::lookup(const DuidPtr& duid) {
+ClientHandler::lookup(Shard& shard, const DuidPtr& duid) {
     // Sanity check.
     if (!duid) {
         isc_throw(InvalidParameter, "null duid in ClientHandler::lookup");
     }
 
-    auto it = clients_client_id_.find(duid->getDuid());
-    if (it == clients_client_id_.end()) {
+    auto it = shard.clients_client_id_.find(duid->getDuid());
+    if (it == shard.clients_client_id_.end()) {
         return (ClientPtr());
     }
     return (*it);
 }
 
 ClientHandler::ClientPtr
-ClientHandler::lookup(const HWAddrPtr& hwaddr) {
+ClientHandler::lookup(Shard& shard, const HWAddrPtr& hwaddr) {
     // Sanity checks.
     if (!hwaddr) {
         isc_throw(InvalidParameter, "null hwaddr in ClientHandler::lookup");
@@ -71,26 +94,26 @@ ClientHandler::lookup(const HWAddrPtr& hwaddr) {
     }
 
     auto key = boost::make_tuple(hwaddr->htype_, hwaddr->hwaddr_);
-    auto it = clients_hwaddr_.find(key);
-    if (it == clients_hwaddr_.end()) {
+    auto it = shard.clients_hwaddr_.find(key);
+    if (it == shard.clients_hwaddr_.end()) {
         return (ClientPtr());
     }
     return (*it);
 }
 
 void
-ClientHandler::addById(const ClientPtr& client) {
+ClientHandler::addById(Shard& shard, const ClientPtr& client) {
     // Sanity check.
     if (!client) {
         isc_throw(InvalidParameter, "null client in ClientHandler::addById");
     }
 
     // Assume insert will never fail so not checking its result.
-    clients_client_id_.insert(client);
+    shard.clients_client_id_.insert(client);
 }
 
 void
-ClientHandler::addByHWAddr(const ClientPtr& client) {
+ClientHandler::addByHWAddr(Shard& shard, const ClientPtr& client) {
     // Sanity check.
     if (!client) {
         isc_throw(InvalidParameter,
@@ -98,22 +121,22 @@ ClientHandler::addByHWAddr(const ClientPtr& client) {
     }
 
     // Assume insert will never fail so not checking its result.
-    clients_hwaddr_.insert(client);
+    shard.clients_hwaddr_.insert(client);
 }
 
 void
-ClientHandler::del(const DuidPtr& duid) {
+ClientHandler::del(Shard& shard, const DuidPtr& duid) {
     // Sanity check.
     if (!duid) {
         isc_throw(InvalidParameter, "null duid in ClientHandler::del");
     }
 
     // Assume erase will never fail so not checking its result.
-    clients_client_id_.erase(duid->getDuid());
+    shard.clients_client_id_.erase(duid->getDuid());
 }
 
 void
-ClientHandler::del(const HWAddrPtr& hwaddr) {
+ClientHandler::del(Shard& shard, const HWAddrPtr& hwaddr) {
     // Sanity checks.
     if (!hwaddr) {
         isc_throw(InvalidParameter, "null hwaddr in ClientHandler::del");
@@ -124,12 +147,12 @@ ClientHandler::del(const HWAddrPtr& hwaddr) {
 
     auto key = boost::make_tuple(hwaddr->htype_, hwaddr->hwaddr_);
     // Assume erase will never fail so not checking its result.
-    auto it = clients_hwaddr_.find(key);
-    if (it == clients_hwaddr_.end()) {
+    auto it = shard.clients_hwaddr_.find(key);
+    if (it == shard.clients_hwaddr_.end()) {
         // Should not happen.
         return;
     }
-    clients_hwaddr_.erase(it);
+    shard.clients_hwaddr_.erase(it);
 }
 
 ClientHandler::ClientHandler()
@@ -138,23 +161,35 @@ ClientHandler::ClientHandler()
 
 ClientHandler::~ClientHandler() {
     bool unlocked = false;
-    lock_guard<mutex> lk(mutex_);
     if (locked_client_id_) {
         unlocked = true;
-        unLockById();
+        Shard& shard = getShard(locked_client_id_);
+        lock_guard<mutex> lk(shard.mutex_);
+        unLockById(shard);
     }
     if (locked_hwaddr_) {
         unlocked = true;
-        unLockByHWAddr();
+        Shard& shard = getShard(locked_hwaddr_);
+        lock_guard<mutex> lk(shard.mutex_);
+        unLockByHWAddr(shard);
     }
-    if (!unlocked || !client_ || !client_->cont_) {
+    if (!unlocked || !client_) {
         return;
     }
-    // Try to process next query. As the caller holds the mutex of
-    // the handler class the continuation will be resumed after.
+    // The client is no longer in the shards so no other handler can
+    // put a continuation now.
+    ContinuationPtr cont;
+    {
+        lock_guard<mutex> lk(client_->mutex_);
+        cont = client_->cont_;
+    }
+    if (!cont) {
+        return;
+    }
+    // Try to process next query.
     MultiThreadingMgr& mt_mgr = MultiThreadingMgr::instance();
     if (mt_mgr.getMode()) {
-        if (!mt_mgr.getThreadPool().addFront(client_->cont_)) {
+        if (!mt_mgr.getThreadPool().addFront(cont)) {
             LOG_DEBUG(dhcp4_logger, DBG_DHCP4_BASIC, DHCP4_PACKET_QUEUE_FULL);
         }
     }
@@ -196,38 +231,41 @@ ClientHandler::tryLock(Pkt4Ptr query, ContinuationPtr cont) {
     Pkt4Ptr next_query_hw;
     client_.reset(new Client(query, duid, hwaddr));
 
-    {
-        lock_guard<mutex> lk(mutex_);
-        // Try first duid.
-        if (duid) {
-            // Try to acquire the by-client-id lock and return the holder
-            // when it failed.
-            holder_id = lookup(duid);
-            if (!holder_id) {
-                locked_client_id_ = duid;
-                lockById();
-            } else if (cont) {
-                next_query_id = holder_id->next_query_;
-                holder_id->next_query_ = query;
-                holder_id->cont_ = cont;
-            }
-        }
+    // Try first duid.
+    if (duid) {
+        // Try to acquire the by-client-id lock and return the holder
+        // when it failed.
+        Shard& shard = getShard(duid);
+        lock_guard<mutex> lk(shard.mutex_);
+        holder_id = lookup(shard, duid);
         if (!holder_id) {
-            if (!hwaddr) {
-                return (true);
-            }
-            // Try to acquire the by-hw-addr lock and return the holder
-            // when it failed.
-            holder_hw = lookup(hwaddr);
-            if (!holder_hw) {
-                locked_hwaddr_ = hwaddr;
-                lockByHWAddr();
-                return (true);
-            } else if (cont) {
-                next_query_hw = holder_hw->next_query_;
-                holder_hw->next_query_ = query;
-                holder_hw->cont_ = cont;
-            }
+            locked_client_id_ = duid;
+            lockById(shard);
+        } else if (cont) {
+            lock_guard<mutex> lk_holder(holder_id->mutex_);
+            next_query_id = holder_id->next_query_;
+            holder_id->next_query_ = query;
+            holder_id->cont_ = cont;
+        }
+    }
+    if (!holder_id) {
+        if (!hwaddr) {
+            return (true);
+        }
+        // Try to acquire the by-hw-addr lock and return the holder
+        // when it failed.
+        Shard& shard = getShard(hwaddr);
+        lock_guard<mutex> lk(shard.mutex_);
+        holder_hw = lookup(shard, hwaddr);
+        if (!holder_hw) {
+            locked_hwaddr_ = hwaddr;
+            lockByHWAddr(shard);
+            return (true);
+        } else if (cont) {
+            lock_guard<mutex> lk_holder(holder_hw->mutex_);
+            next_query_hw = holder_hw->next_query_;
+            holder_hw->next_query_ = query;
+            holder_hw->cont_ = cont;
         }
     }
 
@@ -286,47 +324,47 @@ ClientHandler::tryLock(Pkt4Ptr query, ContinuationPtr cont) {
 }
 
 void
-ClientHandler::lockById() {
+ClientHandler::lockById(Shard& shard) {
     // Sanity check.
     if (!locked_client_id_) {
         isc_throw(Unexpected, "nothing to lock in ClientHandler::lockById");
     }
 
-    addById(client_);
+    addById(shard, client_);
 }
 
 void
-ClientHandler::lockByHWAddr() {
+ClientHandler::lockByHWAddr(Shard& shard) {
     // Sanity check.
     if (!locked_hwaddr_) {
         isc_throw(Unexpected,
                   "nothing to lock in ClientHandler::lockByHWAddr");
     }
 
-    addByHWAddr(client_);
+    addByHWAddr(shard, client_);
 }
 
 void
-ClientHandler::unLockById() {
+ClientHandler::unLockById(Shard& shard) {
     // Sanity check.
     if (!locked_client_id_) {
         isc_throw(Unexpected,
                   "nothing to unlock in ClientHandler::unLockById");
     }
 
-    del(locked_client_id_);
+    del(shard, locked_client_id_);
     locked_client_id_.reset();
 }
 
 void
-ClientHandler::unLockByHWAddr() {
+ClientHandler::unLockByHWAddr(Shard& shard) {
     // Sanity check.
     if (!locked_hwaddr_) {
         isc_throw(Unexpected,
                   "nothing to unlock in ClientHandler::unLockByHWAddr");
     }
 
-    del(locked_hwaddr_);
+    del(shard, locked_hwaddr_);
     locked_hwaddr_.reset();
 }
 
@@ -1,4 +1,4 @@
-// Copyright (C) 2020 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2020-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -14,6 +14,7 @@
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/member.hpp>
 #include <boost/shared_ptr.hpp>
+#include <array>
 #include <functional>
 #include <mutex>
 #include <thread>
@@ -66,16 +67,22 @@ private:
         /// @brief The ID of the thread processing the query.
         std::thread::id thread_;
 
+        /// @brief Mutex to protect the next query and continuation.
+        ///
+        /// A client can be stored in two shards (by client ID and by
+        /// hardware address) so the mutex of a shard is not enough.
+        std::mutex mutex_;
+
         /// @brief The next query.
         ///
         /// @note This field can be modified from another handler
-        /// holding the mutex.
+        /// holding the mutex of the client.
         Pkt4Ptr next_query_;
 
         /// @brief The continuation to process next query for the client.
         ///
         /// @note This field can be modified from another handler
-        /// holding the mutex.
+        /// holding the mutex of the client.
         ContinuationPtr cont_;
     };
 
@@ -128,60 +135,92 @@ private:
         >
     > ClientByHWAddrContainer;
 
+    /// @brief A shard of the client tables.
+    ///
+    /// Clients are spread over shards by the hash of their client ID
+    /// and by the hash of their hardware address so handlers of
+    /// different clients seldom wait for each other.
+    struct Shard {
+        /// @brief Mutex to protect the client containers of the shard.
+        std::mutex mutex_;
+
+        /// @brief The client-by-id container.
+        ClientByIdContainer clients_client_id_;
+
+        /// @brief The client-by-hwaddr container.
+        ClientByHWAddrContainer clients_hwaddr_;
+    };
+
+    /// @brief The number of shards.
+    static const size_t SHARD_COUNT = 64;
+
+    /// @brief Returns the shard of a client ID.
+    ///
+    /// @param duid The duid of the query from the client.
+    /// @return The shard where the client is or will be stored by id.
+    static Shard& getShard(const DuidPtr& duid);
+
+    /// @brief Returns the shard of a hardware address.
+    ///
+    /// @param hwaddr The hardware address of the query from the client.
+    /// @return The shard where the client is or will be stored by hwaddr.
+    static Shard& getShard(const HWAddrPtr& hwaddr);
+
     /// @brief Lookup a client by id.
     ///
-    /// The mutex must be held by the caller.
+    /// The mutex of the shard must be held by the caller.
     ///
+    /// @param shard The shard of the client ID.
     /// @param duid The duid of the query from the client.
     /// @return The client found in the by client id container or null.
-    static ClientPtr lookup(const DuidPtr& duid);
+    static ClientPtr lookup(Shard& shard, const DuidPtr& duid);
 
     /// @brief Lookup a client by hwaddr.
     ///
-    /// The mutex must be held by the caller.
+    /// The mutex of the shard must be held by the caller.
     ///
+    /// @param shard The shard of the hardware address.
     /// @param hwaddr The hardware address of the query from the client.
     /// @return The client found in the by hardware address container or null.
-    static ClientPtr lookup(const HWAddrPtr& hwaddr);
+    static ClientPtr lookup(Shard& shard, const HWAddrPtr& hwaddr);
 
     /// @brief Add a client by id.
     ///
-    /// The mutex must be held by the caller.
+    /// The mutex of the shard must be held by the caller.
     ///
+    /// @param shard The shard of the client ID.
     /// @param client The client to insert into the by id client container.
-    static void addById(const ClientPtr& client);
+    static void addById(Shard& shard, const ClientPtr& client);
 
     /// @brief Add a client by hwaddr.
     ///
-    /// The mutex must be held by the caller.
+    /// The mutex of the shard must be held by the caller.
     ///
+    /// @param shard The shard of the hardware address.
     /// @param client The client to insert into the by hwaddr client container.
-    static void addByHWAddr(const ClientPtr& client);
+    static void addByHWAddr(Shard& shard, const ClientPtr& client);
 
     /// @brief Delete a client by id.
     ///
-    /// The mutex must be held by the caller.
+    /// The mutex of the shard must be held by the caller.
     ///
+    /// @param shard The shard of the client ID.
     /// @param duid The duid to delete from the by id client container.
-    static void del(const DuidPtr& duid);
+    static void del(Shard& shard, const DuidPtr& duid);
 
     /// @brief Delete a client by hwaddr.
     ///
-    /// The mutex must be held by the caller.
+    /// The mutex of the shard must be held by the caller.
     ///
+    /// @param shard The shard of the hardware address.
     /// @param hwaddr The hwaddr to delete from the by hwaddr client container.
-    static void del(const HWAddrPtr& hwaddr);
+    static void del(Shard& shard, const HWAddrPtr& hwaddr);
 
-    /// @brief Mutex to protect client containers.
+    /// @brief The client table shards.
     ///
-    /// The mutex is used only by public methods for guards.
-    static std::mutex mutex_;
-
-    /// @brief The client-by-id container.
-    static ClientByIdContainer clients_client_id_;
-
-    /// @brief The client-by-hwaddr container.
-    static ClientByHWAddrContainer clients_hwaddr_;
+    /// The mutexes are used only by public methods for guards. At most
+    /// one shard mutex is held at a time.
+    static std::array<Shard, SHARD_COUNT> shards_;
 
 public:
 
@@ -214,23 +253,31 @@ private:
 
     /// @brief Acquire a client by client ID option.
     ///
-    /// The mutex must be held by the caller.
-    void lockById();
+    /// The mutex of the shard must be held by the caller.
+    ///
+    /// @param shard The shard of the client ID.
+    void lockById(Shard& shard);
 
     /// @brief Acquire a client by hardware address.
     ///
-    /// The mutex must be held by the caller.
-    void lockByHWAddr();
+    /// The mutex of the shard must be held by the caller.
+    ///
+    /// @param shard The shard of the hardware address.
+    void lockByHWAddr(Shard& shard);
 
     /// @brief Release a client by client ID option.
     ///
-    /// The mutex must be held by the caller.
-    void unLockById();
+    /// The mutex of the shard must be held by the caller.
+    ///
+    /// @param shard The shard of the client ID.
+    void unLockById(Shard& shard);
 
     /// @brief Release a client by hardware address.
     ///
-    /// The mutex must be held by the caller.
-    void unLockByHWAddr();
+    /// The mutex of the shard must be held by the caller.
+    ///
+    /// @param shard The shard of the hardware address.
+    void unLockByHWAddr(Shard& shard);
 
     /// @brief Local client.
     ClientPtr client_;
@@ -1,4 +1,4 @@
-// Copyright (C) 2014-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2014-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -25,11 +25,16 @@
 #include <hooks/hooks.h>
 #include <hooks/hooks_manager.h>
 #include <stats/stats_mgr.h>
+#include <util/cpu_affinity.h>
 #include <util/multi_threading_mgr.h>
 
 #include <signal.h>
 
+#include <atomic>
+#include <chrono>
+#include <future>
 #include <sstream>
+#include <thread>
 
 using namespace isc::asiolink;
 using namespace isc::config;
@@ -378,6 +383,43 @@ ControlledDhcpv4Srv::commandConfigSetHandler(const string&,
         return (result);
     }
 
+    // When multi-threading is enabled and remains enabled the new
+    // configuration is parsed in the background while the thread pool
+    // keeps processing packets with the current configuration. The
+    // thread pool is stopped only to apply the parsed configuration.
+    bool background = false;
+    if (MultiThreadingMgr::instance().getMode() && getInstance()) {
+        try {
+            bool enabled = false;
+            uint32_t thread_count = 0;
+            uint32_t queue_size = 0;
+            CfgMultiThreading::extract(dhcp4->get("multi-threading"), enabled,
+                                       thread_count, queue_size);
+            background = enabled;
+        } catch (const std::exception&) {
+            // The error will be reported by the configuration parser.
+        }
+    }
+
+    if (background) {
+        // We are starting the configuration process so we should remove any
+        // staging configuration that has been created during previous
+        // configuration attempts.
+        CfgMgr::instance().rollback();
+
+        // Parse the logger configuration explicitly into the staging config.
+        // The new logging is applied only with the new configuration.
+        Daemon::configureLogger(dhcp4, CfgMgr::instance().getStagingCfg());
+
+        ConstElementPtr result = getInstance()->parseConfigInBackground(dhcp4);
+        if (result) {
+            // Nothing was applied: the server keeps running with the
+            // current configuration.
+            CfgMgr::instance().rollback();
+            return (result);
+        }
+    }
+
     // stop thread pool (if running)
     MultiThreadingCriticalSection cs;
 
@@ -386,23 +428,25 @@ ControlledDhcpv4Srv::commandConfigSetHandler(const string&,
     // when 'multi-threading' structure is missing from new config
     MultiThreadingMgr::instance().apply(false, 0, 0);
 
-    // We are starting the configuration process so we should remove any
-    // staging configuration that has been created during previous
-    // configuration attempts.
-    CfgMgr::instance().rollback();
+    if (!background) {
+        // We are starting the configuration process so we should remove any
+        // staging configuration that has been created during previous
+        // configuration attempts.
+        CfgMgr::instance().rollback();
 
-    // Parse the logger configuration explicitly into the staging config.
-    // Note this does not alter the current loggers, they remain in
-    // effect until we apply the logging config below.  If no logging
-    // is supplied logging will revert to default logging.
-    Daemon::configureLogger(dhcp4, CfgMgr::instance().getStagingCfg());
+        // Parse the logger configuration explicitly into the staging config.
+        // Note this does not alter the current loggers, they remain in
+        // effect until we apply the logging config below.  If no logging
+        // is supplied logging will revert to default logging.
+        Daemon::configureLogger(dhcp4, CfgMgr::instance().getStagingCfg());
+    }
 
     // Let's apply the new logging. We do it early, so we'll be able to print
     // out what exactly is wrong with the new config in case of problems.
     CfgMgr::instance().getStagingCfg()->applyLoggingCfg();
 
     // Now we configure the server proper.
-    ConstElementPtr result = processConfig(dhcp4);
+    ConstElementPtr result = processConfig(dhcp4, background);
 
     // If the configuration parsed successfully, apply the new logger
     // configuration and the commit the new configuration.  We apply
@@ -677,6 +721,38 @@ ControlledDhcpv4Srv::commandServerTagGetHandler(const std::string&,
     return (createAnswer(CONTROL_RESULT_SUCCESS, response));
 }
 
+ConstElementPtr
+ControlledDhcpv4Srv::commandClassStatsGetHandler(const std::string&,
+                                                 ConstElementPtr) {
+    ClientClassDictionaryPtr dict =
+        CfgMgr::instance().getCurrentCfg()->getClientClassDictionary();
+    ElementPtr response = Element::createMap();
+    response->set("classes", dict->getEvalStats());
+    response->set("enabled",
+                  Element::create(ClientClassDef::getEvalStatsEnabled()));
+
+    return (createAnswer(CONTROL_RESULT_SUCCESS, response));
+}
+
+ConstElementPtr
+ControlledDhcpv4Srv::commandClassStatsSetHandler(const std::string&,
+                                                 ConstElementPtr args) {
+    if (!args || (args->getType() != Element::map)) {
+        return (createAnswer(CONTROL_RESULT_ERROR, "arguments for the"
+                             " 'class-stats-set' command must be a map"));
+    }
+    ConstElementPtr enabled = args->get("enabled");
+    if (!enabled || (enabled->getType() != Element::boolean)) {
+        return (createAnswer(CONTROL_RESULT_ERROR,
+                             "'enabled' argument must be a boolean"));
+    }
+
+    ClientClassDef::setEvalStatsEnabled(enabled->boolValue());
+    return (createAnswer(CONTROL_RESULT_SUCCESS,
+                         std::string("class statistics collection ") +
+                         (enabled->boolValue() ? "enabled" : "disabled")));
+}
+
 ConstElementPtr
 ControlledDhcpv4Srv::commandConfigBackendPullHandler(const std::string&,
                                                      ConstElementPtr) {
@@ -748,6 +824,36 @@ ControlledDhcpv4Srv::commandStatusGetHandler(const string&,
         status->set("multi-threading-enabled", Element::create(false));
     }
 
+    // Report the CPU each thread last ran on and the CPUs it is pinned on.
+    ElementPtr threads = Element::createList();
+    if (IfaceMgr::instance().isDHCPReceiverRunning()) {
+        ElementPtr thread = Element::createMap();
+        thread->set("name", Element::create(std::string("receiver")));
+        thread->set("cpu", Element::create(IfaceMgr::instance().getReceiverCpu()));
+        auto const& cpus = IfaceMgr::instance().getReceiverCpuSet();
+        if (!cpus.empty()) {
+            thread->set("cpu-set", Element::create(cpuSetToText(cpus)));
+        }
+        threads->add(thread);
+    }
+    if (mt_mgr.getMode()) {
+        auto const& cpus = mt_mgr.getThreadPool().getCpuSet();
+        auto thread_cpus = mt_mgr.getThreadPool().getThreadCpus();
+        for (size_t i = 0; i < thread_cpus.size(); ++i) {
+            ElementPtr thread = Element::createMap();
+            thread->set("name", Element::create("worker-" + std::to_string(i)));
+            thread->set("cpu", Element::create(thread_cpus[i]));
+            if (!cpus.empty()) {
+                thread->set("cpu-set",
+                            Element::create(std::to_string(cpus[i % cpus.size()])));
+            }
+            threads->add(thread);
+        }
+    }
+    if (!threads->empty()) {
+        status->set("threads", threads);
+    }
+
     return (createAnswer(0, status));
 }
 
@@ -833,6 +939,12 @@ ControlledDhcpv4Srv::processCommand(const string& command,
         } else if (command == "server-tag-get") {
             return (srv->commandServerTagGetHandler(command, args));
 
+        } else if (command == "class-stats-get") {
+            return (srv->commandClassStatsGetHandler(command, args));
+
+        } else if (command == "class-stats-set") {
+            return (srv->commandClassStatsSetHandler(command, args));
+
         } else if (command == "config-backend-pull") {
             return (srv->commandConfigBackendPullHandler(command, args));
 
@@ -851,7 +963,40 @@ ControlledDhcpv4Srv::processCommand(const string& command,
 }
 
 isc::data::ConstElementPtr
-ControlledDhcpv4Srv::processConfig(isc::data::ConstElementPtr config) {
+ControlledDhcpv4Srv::parseConfigInBackground(isc::data::ConstElementPtr config) {
+    ConstElementPtr answer;
+    std::atomic<bool> done(false);
+    std::promise<void> start;
+    std::shared_future<void> started(start.get_future());
+    std::thread parser([this, config, started, &answer, &done]() {
+        started.wait();
+        answer = parseDhcp4Config(*this, config, false, true);
+        done = true;
+    });
+
+    // The packet processing threads must not see the runtime option
+    // definitions staged by the parser thread.
+    LibDHCP::setRuntimeOptionDefsStagingThread(parser.get_id());
+    start.set_value();
+
+    // Keep dispatching the received packets to the thread pool.
+    while (!done) {
+        if (!dispatchQueuedPackets()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    parser.join();
+
+    // The runtime option definitions staged by the parser thread are now
+    // used to apply the configuration.
+    LibDHCP::setRuntimeOptionDefsStagingThread(std::thread::id());
+
+    return (answer);
+}
+
+isc::data::ConstElementPtr
+ControlledDhcpv4Srv::processConfig(isc::data::ConstElementPtr config,
+                                   bool parsed) {
     ControlledDhcpv4Srv* srv = ControlledDhcpv4Srv::getInstance();
 
     // Single stream instance used in all error clauses
@@ -865,7 +1010,13 @@ ControlledDhcpv4Srv::processConfig(isc::data::ConstElementPtr config) {
     LOG_DEBUG(dhcp4_logger, DBG_DHCP4_COMMAND, DHCP4_CONFIG_RECEIVED)
         .arg(srv->redactConfig(config)->str());
 
-    ConstElementPtr answer = configureDhcp4Server(*srv, config);
+    ConstElementPtr answer;
+    if (parsed) {
+        // The staging configuration was parsed in the background.
+        answer = applyDhcp4Config(*srv, config, true);
+    } else {
+        answer = configureDhcp4Server(*srv, config);
+    }
 
     // Check that configuration was successful. If not, do not reopen sockets
     // and don't bother with DDNS stuff.
@@ -922,6 +1073,11 @@ ControlledDhcpv4Srv::processConfig(isc::data::ConstElementPtr config) {
 
     // Configure DHCP packet queueing
     try {
+        // Pin the packet receiver thread which is started with the sockets.
+        IfaceMgr::instance().setReceiverCpuSet(CfgMultiThreading::extractCpuSet(
+            CfgMgr::instance().getStagingCfg()->getDHCPMultiThreading(),
+            "receiver-cpu-set"));
+
         data::ConstElementPtr qc;
         qc = CfgMgr::instance().getStagingCfg()->getDHCPQueueControl();
         if (IfaceMgr::instance().configureDHCPPacketQueue(AF_INET, qc)) {
@@ -1067,11 +1223,20 @@ ControlledDhcpv4Srv::ControlledDhcpv4Srv(uint16_t server_port /*= DHCP4_SERVER_P
     // HostMgr uses IO service to run asynchronous timers.
     HostMgr::setIOService(getIOService());
 
+    // Threads which can't be pinned on their CPU set log it.
+    setThreadAffinityErrorHandler(&CfgMultiThreading::threadAffinityErrorHandler);
+
     // These are the commands always supported by the DHCPv4 server.
     // Please keep the list in alphabetic order.
     CommandMgr::instance().registerCommand("build-report",
         std::bind(&ControlledDhcpv4Srv::commandBuildReportHandler, this, ph::_1, ph::_2));
 
+    CommandMgr::instance().registerCommand("class-stats-get",
+        std::bind(&ControlledDhcpv4Srv::commandClassStatsGetHandler, this, ph::_1, ph::_2));
+
+    CommandMgr::instance().registerCommand("class-stats-set",
+        std::bind(&ControlledDhcpv4Srv::commandClassStatsSetHandler, this, ph::_1, ph::_2));
+
     CommandMgr::instance().registerCommand("config-backend-pull",
         std::bind(&ControlledDhcpv4Srv::commandConfigBackendPullHandler, this, ph::_1, ph::_2));
 
@@ -1171,6 +1336,8 @@ ControlledDhcpv4Srv::~ControlledDhcpv4Srv() {
 
         // Deregister any registered commands (please keep in alphabetic order)
         CommandMgr::instance().deregisterCommand("build-report");
+        CommandMgr::instance().deregisterCommand("class-stats-get");
+        CommandMgr::instance().deregisterCommand("class-stats-set");
         CommandMgr::instance().deregisterCommand("config-backend-pull");
         CommandMgr::instance().deregisterCommand("config-get");
         CommandMgr::instance().deregisterCommand("config-reload");
@@ -1201,6 +1368,8 @@ ControlledDhcpv4Srv::~ControlledDhcpv4Srv() {
 
         // HostMgr uses IO service to run asynchronous timers.
         HostMgr::setIOService(IOServicePtr());
+
+        setThreadAffinityErrorHandler(ThreadAffinityErrorHandler());
     } catch (...) {
         // Don't want to throw exceptions from the destructor. The server
         // is shutting down anyway.
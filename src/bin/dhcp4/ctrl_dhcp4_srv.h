@@ -1,4 +1,4 @@
-// Copyright (C) 2012-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2012-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -106,10 +106,25 @@ public:
     /// ModuleCCSession, it has to be static.
     ///
     /// @param new_config textual representation of the new configuration
+    /// @param parsed whether the configuration was already parsed by
+    /// @ref parseConfigInBackground
     ///
     /// @return status of the config update
     static isc::data::ConstElementPtr
-    processConfig(isc::data::ConstElementPtr new_config);
+    processConfig(isc::data::ConstElementPtr new_config, bool parsed = false);
+
+    /// @brief Parses a new configuration in the background.
+    ///
+    /// The new configuration is parsed into the staging configuration by
+    /// another thread while this thread keeps dispatching the received
+    /// packets to the thread pool which uses the current configuration.
+    /// The parsed configuration is applied by @ref processConfig.
+    ///
+    /// @param new_config JSON representation of the new configuration
+    ///
+    /// @return null on success or an answer with the parsing error
+    isc::data::ConstElementPtr
+    parseConfigInBackground(isc::data::ConstElementPtr new_config);
 
     /// @brief Configuration checker
     ///
@@ -306,6 +321,31 @@ private:
     commandServerTagGetHandler(const std::string& command,
                                isc::data::ConstElementPtr args);
 
+    /// @brief handler for class-stats-get command
+    ///
+    /// This method handles the class-stats-get command, which returns
+    /// the match expression evaluation statistics of the client classes.
+    ///
+    /// @param command (ignored)
+    /// @param args (ignored)
+    /// @return the statistics of the client classes wrapped in a response
+    isc::data::ConstElementPtr
+    commandClassStatsGetHandler(const std::string& command,
+                                isc::data::ConstElementPtr args);
+
+    /// @brief handler for class-stats-set command
+    ///
+    /// This method handles the class-stats-set command, which enables or
+    /// disables the collection of the match expression evaluation
+    /// statistics of the client classes.
+    ///
+    /// @param command (ignored)
+    /// @param args a map with the 'enabled' boolean
+    /// @return status of the command
+    isc::data::ConstElementPtr
+    commandClassStatsSetHandler(const std::string& command,
+                                isc::data::ConstElementPtr args);
+
     /// @brief handler for config-backend-pull command
     ///
     /// This method handles the config-backend-pull command, which updates
@@ -1618,6 +1618,33 @@ ControlCharacterFill            [^"\\]|\\["\\/bfnrtu]
     }
 }
 
+\"work-stealing\" {
+    switch(driver.ctx_) {
+    case isc::dhcp::Parser4Context::DHCP_MULTI_THREADING:
+        return isc::dhcp::Dhcp4Parser::make_WORK_STEALING(driver.loc_);
+    default:
+        return isc::dhcp::Dhcp4Parser::make_STRING("work-stealing", driver.loc_);
+    }
+}
+
+\"worker-cpu-set\" {
+    switch(driver.ctx_) {
+    case isc::dhcp::Parser4Context::DHCP_MULTI_THREADING:
+        return isc::dhcp::Dhcp4Parser::make_WORKER_CPU_SET(driver.loc_);
+    default:
+        return isc::dhcp::Dhcp4Parser::make_STRING("worker-cpu-set", driver.loc_);
+    }
+}
+
+\"receiver-cpu-set\" {
+    switch(driver.ctx_) {
+    case isc::dhcp::Parser4Context::DHCP_MULTI_THREADING:
+        return isc::dhcp::Dhcp4Parser::make_RECEIVER_CPU_SET(driver.loc_);
+    default:
+        return isc::dhcp::Dhcp4Parser::make_STRING("receiver-cpu-set", driver.loc_);
+    }
+}
+
 \"control-socket\" {
     switch(driver.ctx_) {
     case isc::dhcp::Parser4Context::DHCP4:
@@ -138,6 +138,17 @@ std::set<std::string> dhcp4_statistics = {
     "v4-allocation-fail-classes"
 };
 
+/// List of latency statistics, indexed by packet processing stage
+/// (see @ref isc::dhcp::Pkt::ProcessingStage).
+const char* dhcp4_latency_statistics[Pkt::STAGE_COUNT] = {
+    "pkt4-latency-queue-wait",
+    "pkt4-latency-classification",
+    "pkt4-latency-host-lookup",
+    "pkt4-latency-lease-allocation",
+    "pkt4-latency-hooks",
+    "pkt4-latency-pack-send"
+};
+
 } // end of anonymous namespace
 
 // Declare a Hooks object. As this is outside any function or method, it
@@ -192,6 +203,7 @@ Dhcpv4Exchange::Dhcpv4Exchange(const AllocEnginePtr& alloc_engine,
             setHostIdentifiers();
 
             // Check for static reservations.
+            ScopedPktStageTimer host_timer(query, Pkt::STAGE_HOST_LOOKUP);
             alloc_engine->findReservation(*context_);
 
             // Get shared network to see if it is set for a subnet.
@@ -224,7 +236,7 @@ Dhcpv4Exchange::Dhcpv4Exchange(const AllocEnginePtr& alloc_engine,
         // replace the second_class because the second_class will this
         // time evaluate to false as desired.
         const ClientClassDictionaryPtr& dict =
-            CfgMgr::instance().getCurrentCfg()->getClientClassDictionary();
+            CfgMgr::instance().getCurrentCfgSnapshot()->getClientClassDictionary();
         const ClientClassDefListPtr& defs_ptr = dict->getClasses();
         for (auto def : *defs_ptr) {
             // Only remove evaluated classes. Other classes can be
@@ -364,7 +376,7 @@ void
 Dhcpv4Exchange::copyDefaultOptions() {
     // Let's copy client-id to response. See RFC6842.
     // It is possible to disable RFC6842 to keep backward compatibility
-    bool echo = CfgMgr::instance().getCurrentCfg()->getEchoClientId();
+    bool echo = CfgMgr::instance().getCurrentCfgSnapshot()->getEchoClientId();
     OptionPtr client_id = query_->getOption(DHO_DHCP_CLIENT_IDENTIFIER);
     if (client_id && echo) {
         resp_->addOption(client_id);
@@ -394,7 +406,7 @@ Dhcpv4Exchange::copyDefaultOptions() {
 void
 Dhcpv4Exchange::setHostIdentifiers() {
     const ConstCfgHostOperationsPtr cfg =
-        CfgMgr::instance().getCurrentCfg()->getCfgHostOperations4();
+        CfgMgr::instance().getCurrentCfgSnapshot()->getCfgHostOperations4();
 
     // Collect host identifiers. The identifiers are stored in order of preference.
     // The server will use them in that order to search for host reservations.
@@ -470,6 +482,7 @@ Dhcpv4Exchange::setHostIdentifiers() {
                 callout_handle->setArgument("id_value", id);
 
                 // Call callouts
+                ScopedPktStageTimer hooks_timer(context_->query_, Pkt::STAGE_HOOKS);
                 HooksManager::callCallouts(Hooks.hook_index_host4_identifier_,
                                            *callout_handle);
 
@@ -564,9 +577,11 @@ void Dhcpv4Exchange::classifyPacket(const Pkt4Ptr& pkt) {
 }
 
 void Dhcpv4Exchange::evaluateClasses(const Pkt4Ptr& pkt, bool depend_on_known) {
+    ScopedPktStageTimer timer(pkt, Pkt::STAGE_CLASSIFICATION);
+
     // Note getClientClassDictionary() cannot be null
     const ClientClassDictionaryPtr& dict =
-        CfgMgr::instance().getCurrentCfg()->getClientClassDictionary();
+        CfgMgr::instance().getCurrentCfgSnapshot()->getClientClassDictionary();
     const ClientClassDefListPtr& defs_ptr = dict->getClasses();
     for (ClientClassDefList::const_iterator it = defs_ptr->cbegin();
          it != defs_ptr->cend(); ++it) {
@@ -587,7 +602,7 @@ void Dhcpv4Exchange::evaluateClasses(const Pkt4Ptr& pkt, bool depend_on_known) {
         // Evaluate the expression which can return false (no match),
         // true (match) or raise an exception (error)
         try {
-            bool status = evaluateBool(*expr_ptr, *pkt);
+            bool status = (*it)->evaluateMatchExpr(*pkt);
             if (status) {
                 LOG_INFO(options4_logger, EVAL_RESULT)
                     .arg((*it)->getName())
@@ -734,7 +749,7 @@ Dhcpv4Srv::selectSubnet(const Pkt4Ptr& query, bool& drop,
     const SubnetSelector& selector = CfgSubnets4::initSelector(query);
 
     CfgMgr& cfgmgr = CfgMgr::instance();
-    subnet = cfgmgr.getCurrentCfg()->getCfgSubnets4()->selectSubnet(selector);
+    subnet = cfgmgr.getCurrentCfgSnapshot()->getCfgSubnets4()->selectSubnet(selector);
 
     // Let's execute all callouts registered for subnet4_select
     // (skip callouts if the selectSubnet was called to do sanity checks only)
@@ -755,10 +770,11 @@ Dhcpv4Srv::selectSubnet(const Pkt4Ptr& query, bool& drop,
         callout_handle->setArgument("query4", query);
         callout_handle->setArgument("subnet4", subnet);
         callout_handle->setArgument("subnet4collection",
-                                    cfgmgr.getCurrentCfg()->
+                                    cfgmgr.getCurrentCfgSnapshot()->
                                     getCfgSubnets4()->getAll());
 
         // Call user (and server-side) callouts
+        ScopedPktStageTimer hooks_timer(query, Pkt::STAGE_HOOKS);
         HooksManager::callCallouts(Hooks.hook_index_subnet4_select_,
                                    *callout_handle);
 
@@ -855,7 +871,7 @@ Dhcpv4Srv::selectSubnet4o6(const Pkt4Ptr& query, bool& drop,
     }
 
     CfgMgr& cfgmgr = CfgMgr::instance();
-    subnet = cfgmgr.getCurrentCfg()->getCfgSubnets4()->selectSubnet4o6(selector);
+    subnet = cfgmgr.getCurrentCfgSnapshot()->getCfgSubnets4()->selectSubnet4o6(selector);
 
     // Let's execute all callouts registered for subnet4_select.
     // (skip callouts if the selectSubnet was called to do sanity checks only)
@@ -873,10 +889,11 @@ Dhcpv4Srv::selectSubnet4o6(const Pkt4Ptr& query, bool& drop,
         callout_handle->setArgument("query4", query);
         callout_handle->setArgument("subnet4", subnet);
         callout_handle->setArgument("subnet4collection",
-                                    cfgmgr.getCurrentCfg()->
+                                    cfgmgr.getCurrentCfgSnapshot()->
                                     getCfgSubnets4()->getAll());
 
         // Call user (and server-side) callouts
+        ScopedPktStageTimer hooks_timer(query, Pkt::STAGE_HOOKS);
         HooksManager::callCallouts(Hooks.hook_index_subnet4_select_,
                                    *callout_handle);
 
@@ -1026,6 +1043,11 @@ Dhcpv4Srv::run_one() {
         return;
     }
 
+    dispatchPacket(query);
+}
+
+void
+Dhcpv4Srv::dispatchPacket(Pkt4Ptr& query) {
     // If the DHCP service has been globally disabled, drop the packet.
     if (!network_state_->isServiceEnabled()) {
         LOG_DEBUG(bad_packet4_logger, DBGLVL_PKT_HANDLING, DHCP4_PACKET_DROP_0008)
@@ -1046,6 +1068,22 @@ Dhcpv4Srv::run_one() {
     }
 }
 
+size_t
+Dhcpv4Srv::dispatchQueuedPackets() {
+    IfaceMgr& iface_mgr = IfaceMgr::instance();
+    if (!iface_mgr.isDHCPReceiverRunning()) {
+        return (0);
+    }
+
+    size_t count = 0;
+    for (Pkt4Ptr query = iface_mgr.getPacketQueue4()->dequeuePacket(); query;
+         query = iface_mgr.getPacketQueue4()->dequeuePacket()) {
+        dispatchPacket(query);
+        ++count;
+    }
+    return (count);
+}
+
 void
 Dhcpv4Srv::processPacketAndSendResponseNoThrow(Pkt4Ptr& query) {
     try {
@@ -1072,6 +1110,9 @@ Dhcpv4Srv::processPacketAndSendResponse(Pkt4Ptr& query) {
 
 void
 Dhcpv4Srv::processPacket(Pkt4Ptr& query, Pkt4Ptr& rsp, bool allow_packet_park) {
+    // The whole processing of the packet uses the same configuration.
+    CfgSnapshotPin cfg_pin;
+
     // Log reception of the packet. We need to increase it early, as any
     // failures in unpacking will cause the packet to be dropped. We
     // will increase type specific statistic further down the road.
@@ -1079,6 +1120,13 @@ Dhcpv4Srv::processPacket(Pkt4Ptr& query, Pkt4Ptr& rsp, bool allow_packet_park) {
     isc::stats::StatsMgr::instance().addValue("pkt4-received",
                                               static_cast<int64_t>(1));
 
+    // Time spent by the packet in the queues since its reception.
+    if (!query->getTimestamp().is_not_a_date_time()) {
+        query->addStageDuration(Pkt::STAGE_QUEUE_WAIT,
+                                boost::posix_time::microsec_clock::universal_time() -
+                                query->getTimestamp());
+    }
+
     bool skip_unpack = false;
 
     // The packet has just been received so contains the uninterpreted wire
@@ -1099,6 +1147,7 @@ Dhcpv4Srv::processPacket(Pkt4Ptr& query, Pkt4Ptr& rsp, bool allow_packet_park) {
         callout_handle->setArgument("query4", query);
 
         // Call callouts
+        ScopedPktStageTimer hooks_timer(query, Pkt::STAGE_HOOKS);
         HooksManager::callCallouts(Hooks.hook_index_buffer4_receive_,
                                    *callout_handle);
 
@@ -1213,6 +1262,7 @@ Dhcpv4Srv::processPacket(Pkt4Ptr& query, Pkt4Ptr& rsp, bool allow_packet_park) {
         callout_handle->setArgument("query4", query);
 
         // Call callouts
+        ScopedPktStageTimer hooks_timer(query, Pkt::STAGE_HOOKS);
         HooksManager::callCallouts(Hooks.hook_index_pkt4_receive_,
                                    *callout_handle);
 
@@ -1264,6 +1314,10 @@ Dhcpv4Srv::processDhcp4QueryAndSendResponse(Pkt4Ptr& query, Pkt4Ptr& rsp,
 void
 Dhcpv4Srv::processDhcp4Query(Pkt4Ptr& query, Pkt4Ptr& rsp,
                              bool allow_packet_park) {
+    // The processing is resumed here for parked packets: use the same
+    // configuration until it completes.
+    CfgSnapshotPin cfg_pin;
+
     // Create a client race avoidance RAII handler.
     ClientHandler client_handler;
 
@@ -1364,7 +1418,7 @@ Dhcpv4Srv::processDhcp4Query(Pkt4Ptr& query, Pkt4Ptr& rsp,
             // Get the parking limit. Parsing should ensure the value is present.
             uint32_t parked_packet_limit = 0;
             data::ConstElementPtr ppl = CfgMgr::instance().
-                getCurrentCfg()->getConfiguredGlobal("parked-packet-limit");
+                getCurrentCfgSnapshot()->getConfiguredGlobal("parked-packet-limit");
             if (ppl) {
                 parked_packet_limit = ppl->intValue();
             }
@@ -1407,6 +1461,7 @@ Dhcpv4Srv::processDhcp4Query(Pkt4Ptr& query, Pkt4Ptr& rsp,
 
         try {
             // Call all installed callouts
+            ScopedPktStageTimer hooks_timer(query, Pkt::STAGE_HOOKS);
             HooksManager::callCallouts(Hooks.hook_index_leases4_committed_,
                                        *callout_handle);
         } catch (...) {
@@ -1465,6 +1520,9 @@ Dhcpv4Srv::processPacketPktSend(hooks::CalloutHandlePtr& callout_handle,
         return;
     }
 
+    // The response takes over the timing of the query.
+    rsp->copyStageDurations(*query);
+
     // Specifies if server should do the packing
     bool skip_pack = false;
 
@@ -1488,6 +1546,7 @@ Dhcpv4Srv::processPacketPktSend(hooks::CalloutHandlePtr& callout_handle,
         callout_handle->setArgument("response4", rsp);
 
         // Call all installed callouts
+        ScopedPktStageTimer hooks_timer(rsp, Pkt::STAGE_HOOKS);
         HooksManager::callCallouts(Hooks.hook_index_pkt4_send_,
                                    *callout_handle);
 
@@ -1515,6 +1574,7 @@ Dhcpv4Srv::processPacketPktSend(hooks::CalloutHandlePtr& callout_handle,
         try {
             LOG_DEBUG(options4_logger, DBG_DHCP4_DETAIL, DHCP4_PACKET_PACK)
                 .arg(rsp->getLabel());
+            ScopedPktStageTimer timer(rsp, Pkt::STAGE_PACK_SEND);
             rsp->pack();
         } catch (const std::exception& e) {
             LOG_ERROR(options4_logger, DHCP4_PACKET_PACK_FAIL)
@@ -1551,6 +1611,7 @@ Dhcpv4Srv::processPacketBufferSend(CalloutHandlePtr& callout_handle,
             callout_handle->setArgument("response4", rsp);
 
             // Call callouts
+            ScopedPktStageTimer hooks_timer(rsp, Pkt::STAGE_HOOKS);
             HooksManager::callCallouts(Hooks.hook_index_buffer4_send_,
                                        *callout_handle);
 
@@ -1585,10 +1646,14 @@ Dhcpv4Srv::processPacketBufferSend(CalloutHandlePtr& callout_handle,
             .arg(rsp->getName())
             .arg(static_cast<int>(rsp->getType()))
             .arg(rsp->toText());
-        sendPacket(rsp);
+        {
+            ScopedPktStageTimer timer(rsp, Pkt::STAGE_PACK_SEND);
+            sendPacket(rsp);
+        }
 
         // Update statistics accordingly for sent packet.
         processStatsSent(rsp);
+        processStatsLatency(rsp);
 
     } catch (const std::exception& e) {
         LOG_ERROR(packet4_logger, DHCP4_PACKET_SEND_FAIL)
@@ -1689,7 +1754,7 @@ Dhcpv4Srv::buildCfgOptionList(Dhcpv4Exchange& ex) {
     for (ClientClasses::const_iterator cclass = classes.cbegin();
          cclass != classes.cend(); ++cclass) {
         // Find the client class definition for this class
-        const ClientClassDefPtr& ccdef = CfgMgr::instance().getCurrentCfg()->
+        const ClientClassDefPtr& ccdef = CfgMgr::instance().getCurrentCfgSnapshot()->
             getClientClassDictionary()->findClass(*cclass);
         if (!ccdef) {
             // Not found: the class is built-in or not configured
@@ -1711,8 +1776,8 @@ Dhcpv4Srv::buildCfgOptionList(Dhcpv4Exchange& ex) {
     }
 
     // Last global options
-    if (!CfgMgr::instance().getCurrentCfg()->getCfgOption()->empty()) {
-        co_list.push_back(CfgMgr::instance().getCurrentCfg()->getCfgOption());
+    if (!CfgMgr::instance().getCurrentCfgSnapshot()->getCfgOption()->empty()) {
+        co_list.push_back(CfgMgr::instance().getCurrentCfgSnapshot()->getCfgOption());
     }
 }
 
@@ -2271,6 +2336,7 @@ Dhcpv4Srv::assignLease(Dhcpv4Exchange& ex) {
     // Get the pointers to the query and the response messages.
     Pkt4Ptr query = ex.getQuery();
     Pkt4Ptr resp = ex.getResponse();
+    ScopedPktStageTimer timer(query, Pkt::STAGE_LEASE_ALLOCATION);
 
     // Get the context.
     AllocEngine::ClientContext4Ptr ctx = ex.getContext();
@@ -2776,7 +2842,7 @@ Dhcpv4Srv::adjustIfaceData(Dhcpv4Exchange& ex) {
         response->setRemotePort(relay_port ? relay_port : DHCP4_SERVER_PORT);
     }
 
-    CfgIfacePtr cfg_iface = CfgMgr::instance().getCurrentCfg()->getCfgIface();
+    CfgIfacePtr cfg_iface = CfgMgr::instance().getCurrentCfgSnapshot()->getCfgIface();
     if (query->isRelayed() &&
         (cfg_iface->getSocketType() == CfgIface::SOCKET_UDP) &&
         (cfg_iface->getOutboundIface() == CfgIface::USE_ROUTING)) {
@@ -2973,7 +3039,7 @@ Dhcpv4Srv::setFixedFields(Dhcpv4Exchange& ex) {
 
         // Let's get class definitions
         const ClientClassDictionaryPtr& dict =
-            CfgMgr::instance().getCurrentCfg()->getClientClassDictionary();
+            CfgMgr::instance().getCurrentCfgSnapshot()->getClientClassDictionary();
 
         // Now we need to iterate over the classes assigned to the
         // query packet and find corresponding class definitions for it.
@@ -3430,7 +3496,7 @@ Dhcpv4Srv::declineLease(const Lease4Ptr& lease, const Pkt4Ptr& decline,
     // We need to disassociate the lease from the client. Once we move a lease
     // to declined state, it is no longer associated with the client in any
     // way.
-    lease->decline(CfgMgr::instance().getCurrentCfg()->getDeclinePeriod());
+    lease->decline(CfgMgr::instance().getCurrentCfgSnapshot()->getDeclinePeriod());
 
     try {
         LeaseMgrFactory::instance().updateLease4(lease);
@@ -3736,7 +3802,7 @@ Dhcpv4Srv::acceptServerId(const Pkt4Ptr& query) const {
     /// know the reservations for the client communicating with the server.
     /// We may revise some of these choices in the future.
 
-    SrvConfigPtr cfg = CfgMgr::instance().getCurrentCfg();
+    const SrvConfigPtr& cfg = CfgMgr::instance().getCurrentCfgSnapshot();
 
     // Check if there is at least one subnet configured with this server
     // identifier.
@@ -3757,7 +3823,7 @@ Dhcpv4Srv::acceptServerId(const Pkt4Ptr& query) const {
     for (ClientClasses::const_iterator cclass = classes.cbegin();
          cclass != classes.cend(); ++cclass) {
         // Find the client class definition for this class
-        const ClientClassDefPtr& ccdef = CfgMgr::instance().getCurrentCfg()->
+        const ClientClassDefPtr& ccdef = CfgMgr::instance().getCurrentCfgSnapshot()->
             getClientClassDictionary()->findClass(*cclass);
         if (!ccdef) {
             continue;
@@ -3833,6 +3899,7 @@ void Dhcpv4Srv::classifyPacket(const Pkt4Ptr& pkt) {
 void Dhcpv4Srv::requiredClassify(Dhcpv4Exchange& ex) {
     // First collect required classes
     Pkt4Ptr query = ex.getQuery();
+    ScopedPktStageTimer timer(query, Pkt::STAGE_CLASSIFICATION);
     ClientClasses classes = query->getClasses(true);
     Subnet4Ptr subnet = ex.getContext()->subnet_;
 
@@ -3878,7 +3945,7 @@ void Dhcpv4Srv::requiredClassify(Dhcpv4Exchange& ex) {
     // Run match expressions
     // Note getClientClassDictionary() cannot be null
     const ClientClassDictionaryPtr& dict =
-        CfgMgr::instance().getCurrentCfg()->getClientClassDictionary();
+        CfgMgr::instance().getCurrentCfgSnapshot()->getClientClassDictionary();
     for (ClientClasses::const_iterator cclass = classes.cbegin();
          cclass != classes.cend(); ++cclass) {
         const ClientClassDefPtr class_def = dict->findClass(*cclass);
@@ -3897,7 +3964,7 @@ void Dhcpv4Srv::requiredClassify(Dhcpv4Exchange& ex) {
         // Evaluate the expression which can return false (no match),
         // true (match) or raise an exception (error)
         try {
-            bool status = evaluateBool(*expr_ptr, *query);
+            bool status = class_def->evaluateMatchExpr(*query);
             if (status) {
                 LOG_INFO(options4_logger, EVAL_RESULT)
                     .arg(*cclass)
@@ -3932,7 +3999,7 @@ Dhcpv4Srv::deferredUnpack(Pkt4Ptr& query) {
              cclass != classes.cend(); ++cclass) {
             // Get the client class definition for this class
             const ClientClassDefPtr& ccdef =
-                CfgMgr::instance().getCurrentCfg()->
+                CfgMgr::instance().getCurrentCfgSnapshot()->
                 getClientClassDictionary()->findClass(*cclass);
             // If not found skip it
             if (!ccdef) {
@@ -4131,6 +4198,25 @@ void Dhcpv4Srv::processStatsSent(const Pkt4Ptr& response) {
                                               static_cast<int64_t>(1));
 }
 
+void Dhcpv4Srv::processStatsLatency(const Pkt4Ptr& response) {
+    StatsMgr& stats_mgr = StatsMgr::instance();
+    for (size_t i = 0; i < Pkt::STAGE_COUNT; ++i) {
+        const boost::posix_time::time_duration& duration =
+            response->getStageDuration(static_cast<Pkt::ProcessingStage>(i));
+        stats_mgr.recordThreadValue(dhcp4_latency_statistics[i],
+                                    std::chrono::microseconds(duration.total_microseconds()));
+    }
+
+    // The total latency is known only when the query timestamp is.
+    if (!response->getQueryTimestamp().is_not_a_date_time()) {
+        boost::posix_time::time_duration total =
+            boost::posix_time::microsec_clock::universal_time() -
+            response->getQueryTimestamp();
+        stats_mgr.recordThreadValue("pkt4-latency-total",
+                                    std::chrono::microseconds(total.total_microseconds()));
+    }
+}
+
 int Dhcpv4Srv::getHookIndexBuffer4Receive() {
     return (Hooks.hook_index_buffer4_receive_);
 }
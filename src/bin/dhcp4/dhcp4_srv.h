@@ -1,4 +1,4 @@
-// Copyright (C) 2011-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2011-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -326,6 +326,24 @@ public:
     /// a response.
     void run_one();
 
+    /// @brief Dispatches a received DHCPv4 packet.
+    ///
+    /// The packet is dropped when the DHCP service is disabled, given to
+    /// the thread pool when multi-threading is enabled or else processed
+    /// and answered.
+    ///
+    /// @param query A pointer to the received packet.
+    void dispatchPacket(Pkt4Ptr& query);
+
+    /// @brief Dispatches the packets queued by the receiver thread.
+    ///
+    /// Unlike @ref run_one this neither waits for packets nor handles
+    /// external sockets, e.g. the control channel, so it can be called
+    /// by a command handler waiting for a long task.
+    ///
+    /// @return The number of dispatched packets.
+    size_t dispatchQueuedPackets();
+
     /// @brief Process a single incoming DHCPv4 packet and sends the response.
     ///
     /// It verifies correctness of the passed packet, calls per-type processXXX
@@ -1134,6 +1152,16 @@ public:
     /// @param response packet transmitted
     static void processStatsSent(const Pkt4Ptr& response);
 
+    /// @brief Updates latency statistics for transmitted packets
+    ///
+    /// Records the time spent in each processing stage and the total
+    /// time since the query reception in histogram statistics. Values
+    /// are recorded in per-thread histograms so the packet processing
+    /// threads do not contend on the statistics manager mutex.
+    ///
+    /// @param response packet transmitted
+    static void processStatsLatency(const Pkt4Ptr& response);
+
     /// @brief Returns the index for "buffer4_receive" hook point
     /// @return the index for "buffer4_receive" hook point
     static int getHookIndexBuffer4Receive();
@@ -274,6 +274,36 @@ public:
     }
 };
 
+/// @brief Returns the parsed current configuration when its unchanged
+/// objects can be reused by the new configuration.
+///
+/// The objects are reused only when the option definitions and the
+/// compatibility flags, which change how options are parsed, are
+/// unchanged and when no configuration backend, which merges other
+/// objects into the current configuration, is used.
+///
+/// @param current_cfg the current configuration.
+/// @param config the new configuration with default and derived values.
+/// @return the parsed current configuration or null.
+ConstElementPtr
+getReusableConfig(const SrvConfigPtr& current_cfg, const ConstElementPtr& config) {
+    ConstElementPtr previous = current_cfg->getParsedConfig();
+    if (!previous || previous->contains("config-control") ||
+        config->contains("config-control")) {
+        return (ConstElementPtr());
+    }
+
+    for (auto const& name : { "option-def", "compatibility" }) {
+        ConstElementPtr value = config->get(name);
+        ConstElementPtr previous_value = previous->get(name);
+        if (static_cast<bool>(value) != static_cast<bool>(previous_value) ||
+            (value && !value->equals(*previous_value))) {
+            return (ConstElementPtr());
+        }
+    }
+    return (previous);
+}
+
 } // anonymous namespace
 
 namespace isc {
@@ -320,6 +350,61 @@ void configureCommandChannel() {
     }
 }
 
+/// @brief Stops the services which are reconfigured.
+///
+/// Closes DHCP sockets, removes existing timers, discards parked packets
+/// and resets the config backend control.
+///
+/// @param server DHCPv4 server.
+void stopDhcp4Services(Dhcpv4Srv& server) {
+    IfaceMgr::instance().closeSockets();
+    TimerMgr::instance()->unregisterTimers();
+    server.discardPackets();
+    server.getCBControl()->reset();
+}
+
+/// @brief Configures the interfaces after a background parsing.
+///
+/// Parses the interfaces configuration, which may re-detect interfaces,
+/// and checks that the interfaces of subnets and shared networks exist.
+/// It must be called when the sockets are closed.
+///
+/// @param config_set the new configuration with default values.
+/// @param parameter_name the name of the parameter being processed.
+/// @throw DhcpConfigError when an interface does not exist.
+void configureDhcp4Interfaces(ConstElementPtr config_set,
+                              std::string& parameter_name) {
+    SrvConfigPtr srv_config = CfgMgr::instance().getStagingCfg();
+
+    ConstElementPtr ifaces_config = config_set->get("interfaces-config");
+    if (ifaces_config) {
+        parameter_name = "interfaces-config";
+        IfacesConfigParser parser(AF_INET, false);
+        CfgIfacePtr cfg_iface = srv_config->getCfgIface();
+        parser.parse(cfg_iface, ifaces_config);
+    }
+
+    parameter_name = "shared-networks";
+    for (auto network : *srv_config->getCfgSharedNetworks4()->getAll()) {
+        std::string iface = network->getIface(Network::Inheritance::NONE);
+        if (!iface.empty() && !IfaceMgr::instance().getIface(iface)) {
+            isc_throw(DhcpConfigError, "Specified network interface name "
+                      << iface << " for shared network " << network->getName()
+                      << " is not present in the system");
+        }
+    }
+
+    parameter_name = "subnet4";
+    for (auto subnet : *srv_config->getCfgSubnets4()->getAll()) {
+        std::string iface = subnet->getIface(Network::Inheritance::NONE);
+        if (!iface.empty() && !IfaceMgr::instance().getIface(iface)) {
+            isc_throw(DhcpConfigError, "Specified network interface name "
+                      << iface << " for subnet " << subnet->toText()
+                      << " is not present in the system");
+        }
+    }
+}
+
 isc::data::ConstElementPtr
 configureDhcp4Server(Dhcpv4Srv& server, isc::data::ConstElementPtr config_set,
                      bool check_only) {
@@ -329,6 +414,39 @@ configureDhcp4Server(Dhcpv4Srv& server, isc::data::ConstElementPtr config_set,
         return (answer);
     }
 
+    // Close DHCP sockets and remove any existing timers.
+    if (!check_only) {
+        stopDhcp4Services(server);
+    }
+
+    ConstElementPtr answer = parseDhcp4Config(server, config_set, check_only);
+
+    if (check_only) {
+        if (!answer) {
+            LibDHCP::revertRuntimeOptionDefs();
+            answer = isc::config::createAnswer(CONTROL_RESULT_SUCCESS,
+            "Configuration seems sane. Control-socket, hook-libraries, and D2 "
+            "configuration were sanity checked, but not applied.");
+        }
+        return (answer);
+    }
+
+    if (answer) {
+        return (answer);
+    }
+
+    return (applyDhcp4Config(server, config_set));
+}
+
+isc::data::ConstElementPtr
+parseDhcp4Config(Dhcpv4Srv& server, isc::data::ConstElementPtr config_set,
+                 bool check_only, bool background) {
+    if (!config_set) {
+        ConstElementPtr answer = isc::config::createAnswer(CONTROL_RESULT_ERROR,
+                                 string("Can't parse NULL config"));
+        return (answer);
+    }
+
     LOG_DEBUG(dhcp4_logger, DBG_DHCP4_COMMAND, DHCP4_CONFIG_START)
         .arg(server.redactConfig(config_set)->str());
 
@@ -336,14 +454,6 @@ configureDhcp4Server(Dhcpv4Srv& server, isc::data::ConstElementPtr config_set,
     // so newly recreated configuration starts with first subnet-id equal 1.
     Subnet::resetSubnetID();
 
-    // Close DHCP sockets and remove any existing timers.
-    if (!check_only) {
-        IfaceMgr::instance().closeSockets();
-        TimerMgr::instance()->unregisterTimers();
-        server.discardPackets();
-        server.getCBControl()->reset();
-    }
-
     // Revert any runtime option definitions configured so far and not committed.
     LibDHCP::revertRuntimeOptionDefs();
     // Let's set empty container in case a user hasn't specified any configuration
@@ -355,9 +465,6 @@ configureDhcp4Server(Dhcpv4Srv& server, isc::data::ConstElementPtr config_set,
 
     // Answer will hold the result.
     ConstElementPtr answer;
-    // Rollback informs whether error occurred and original data
-    // have to be restored to global storages.
-    bool rollback = false;
     // Global parameter name in case of an error.
     string parameter_name;
     ElementPtr mutable_cfg;
@@ -399,6 +506,14 @@ configureDhcp4Server(Dhcpv4Srv& server, isc::data::ConstElementPtr config_set,
         // Apply global options in the staging config, e.g. ip-reservations-unique
         global_parser.parseEarly(srv_config, mutable_cfg);
 
+        // Unchanged client classes, shared networks and subnets of the
+        // current configuration are reused instead of being parsed again.
+        SrvConfigPtr current_cfg = CfgMgr::instance().getCurrentCfg();
+        ConstElementPtr reusable_cfg;
+        if (!check_only) {
+            reusable_cfg = getReusableConfig(current_cfg, mutable_cfg);
+        }
+
         // We need definitions first
         ConstElementPtr option_defs = mutable_cfg->get("option-def");
         if (option_defs) {
@@ -456,8 +571,10 @@ configureDhcp4Server(Dhcpv4Srv& server, isc::data::ConstElementPtr config_set,
             parser.parse(hr_identifiers);
         }
 
+        // The interfaces configuration depends on the detected interfaces
+        // which can't be changed while packets are received.
         ConstElementPtr ifaces_config = mutable_cfg->get("interfaces-config");
-        if (ifaces_config) {
+        if (ifaces_config && !background) {
             parameter_name = "interfaces-config";
             IfacesConfigParser parser(AF_INET, check_only);
             CfgIfacePtr cfg_iface = srv_config->getCfgIface();
@@ -507,10 +624,18 @@ configureDhcp4Server(Dhcpv4Srv& server, isc::data::ConstElementPtr config_set,
         ConstElementPtr client_classes = mutable_cfg->get("client-classes");
         if (client_classes) {
             parameter_name = "client-classes";
-            ClientClassDefListParser parser;
-            ClientClassDictionaryPtr dictionary =
-                parser.parse(client_classes, AF_INET);
-            srv_config->setClientClassDictionary(dictionary);
+            ConstElementPtr previous_classes;
+            if (reusable_cfg) {
+                previous_classes = reusable_cfg->get("client-classes");
+            }
+            if (previous_classes && client_classes->equals(*previous_classes)) {
+                srv_config->setClientClassDictionary(current_cfg->getClientClassDictionary());
+            } else {
+                ClientClassDefListParser parser;
+                ClientClassDictionaryPtr dictionary =
+                    parser.parse(client_classes, AF_INET);
+                srv_config->setClientClassDictionary(dictionary);
+            }
         }
 
         // Please move at the end when migration will be finished.
@@ -555,9 +680,15 @@ configureDhcp4Server(Dhcpv4Srv& server, isc::data::ConstElementPtr config_set,
             /// CfgSharedNetworks4 object. One additional step is then to
             /// add subnets from the CfgSharedNetworks4 into CfgSubnets4
             /// as well.
-            SharedNetworks4ListParser parser;
+            SharedNetworks4ListParser parser(!background);
             CfgSharedNetworks4Ptr cfg = srv_config->getCfgSharedNetworks4();
-            parser.parse(cfg, shared_networks);
+            if (reusable_cfg) {
+                parser.parse(cfg, shared_networks,
+                             reusable_cfg->get("shared-networks"),
+                             current_cfg->getCfgSharedNetworks4());
+            } else {
+                parser.parse(cfg, shared_networks);
+            }
 
             // We also need to put the subnets it contains into normal
             // subnets list.
@@ -567,9 +698,15 @@ configureDhcp4Server(Dhcpv4Srv& server, isc::data::ConstElementPtr config_set,
         ConstElementPtr subnet4 = mutable_cfg->get("subnet4");
         if (subnet4) {
             parameter_name = "subnet4";
-            Subnets4ListConfigParser subnets_parser;
+            Subnets4ListConfigParser subnets_parser(!background);
             // parse() returns number of subnets parsed. We may log it one day.
-            subnets_parser.parse(srv_config, subnet4);
+            if (reusable_cfg) {
+                subnets_parser.parse(srv_config, subnet4,
+                                     reusable_cfg->get("subnet4"),
+                                     current_cfg->getCfgSubnets4());
+            } else {
+                subnets_parser.parse(srv_config, subnet4);
+            }
         }
 
         ConstElementPtr reservations = mutable_cfg->get("reservations");
@@ -717,29 +854,52 @@ configureDhcp4Server(Dhcpv4Srv& server, isc::data::ConstElementPtr config_set,
         }
         d2_client_cfg->validateContents();
         srv_config->setD2ClientConfig(d2_client_cfg);
+
+        // Keep the parsed configuration for the next reconfiguration.
+        srv_config->setParsedConfig(mutable_cfg);
     } catch (const isc::Exception& ex) {
         LOG_ERROR(dhcp4_logger, DHCP4_PARSER_FAIL)
                   .arg(parameter_name).arg(ex.what());
         answer = isc::config::createAnswer(CONTROL_RESULT_ERROR, ex.what());
-
-        // An error occurred, so make sure that we restore original data.
-        rollback = true;
     } catch (...) {
         // For things like bad_cast in boost::lexical_cast
         LOG_ERROR(dhcp4_logger, DHCP4_PARSER_EXCEPTION).arg(parameter_name);
         answer = isc::config::createAnswer(CONTROL_RESULT_ERROR, "undefined configuration"
                                            " processing error");
+    }
 
-        // An error occurred, so make sure that we restore original data.
-        rollback = true;
+    // Revert to original configuration of runtime option definitions
+    // in the libdhcp++ when the parsing failed.
+    if (answer) {
+        LibDHCP::revertRuntimeOptionDefs();
     }
 
-    if (check_only) {
-        rollback = true;
-        if (!answer) {
-            answer = isc::config::createAnswer(CONTROL_RESULT_SUCCESS,
-            "Configuration seems sane. Control-socket, hook-libraries, and D2 "
-            "configuration were sanity checked, but not applied.");
+    return (answer);
+}
+
+isc::data::ConstElementPtr
+applyDhcp4Config(Dhcpv4Srv& server, isc::data::ConstElementPtr config_set,
+                 bool background) {
+    // Answer will hold the result.
+    ConstElementPtr answer;
+    // Rollback informs whether error occurred and original data
+    // have to be restored to global storages.
+    bool rollback = false;
+
+    // The services were not stopped before a background parsing.
+    if (background) {
+        stopDhcp4Services(server);
+
+        string parameter_name;
+        try {
+            configureDhcp4Interfaces(config_set, parameter_name);
+        } catch (const isc::Exception& ex) {
+            LOG_ERROR(dhcp4_logger, DHCP4_PARSER_FAIL)
+                      .arg(parameter_name).arg(ex.what());
+            answer = isc::config::createAnswer(CONTROL_RESULT_ERROR, ex.what());
+
+            // An error occurred, so make sure that we restore original data.
+            rollback = true;
         }
     }
 
@@ -791,7 +951,7 @@ configureDhcp4Server(Dhcpv4Srv& server, isc::data::ConstElementPtr config_set,
         try {
 
             // If there are config backends, fetch and merge into staging config
-            server.getCBControl()->databaseConfigFetch(srv_config,
+            server.getCBControl()->databaseConfigFetch(CfgMgr::instance().getStagingCfg(),
                                                        CBControlDHCPv4::FetchMode::FETCH_ALL);
         } catch (const isc::Exception& ex) {
             std::ostringstream err;
@@ -1,4 +1,4 @@
-// Copyright (C) 2020-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2020-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -343,6 +343,43 @@ TEST_F(ClientHandleTest, notSharedQueries) {
     checkStat(false);
 }
 
+// Verifies that many clients spread over the shards are handled
+// independently.
+TEST_F(ClientHandleTest, manyClients) {
+    const size_t count = 200;
+    std::vector<boost::shared_ptr<ClientHandler> > handlers;
+    for (size_t i = 0; i < count; ++i) {
+        Pkt4Ptr dis(new Pkt4(DHCPDISCOVER, 1234 + i));
+        dis->addOption(generateClientId(static_cast<uint8_t>(i)));
+        dis->setHWAddr(generateHWAddr(static_cast<uint8_t>(i)));
+        boost::shared_ptr<ClientHandler> handler(new ClientHandler());
+        bool locked = false;
+        EXPECT_NO_THROW(locked = handler->tryLock(dis));
+        EXPECT_TRUE(locked) << "client " << i;
+        handlers.push_back(handler);
+    }
+    checkStat(false);
+
+    // A query from one of these clients by hardware address only is
+    // a duplicate.
+    Pkt4Ptr req(new Pkt4(DHCPREQUEST, 4321));
+    req->setHWAddr(generateHWAddr(static_cast<uint8_t>(count / 2)));
+    {
+        ClientHandler client_handler;
+        bool locked = true;
+        EXPECT_NO_THROW(locked = client_handler.tryLock(req));
+        EXPECT_FALSE(locked);
+    }
+    checkStat(true);
+
+    // Release all clients: the query is no longer a duplicate.
+    handlers.clear();
+    ClientHandler client_handler;
+    bool locked = false;
+    EXPECT_NO_THROW(locked = client_handler.tryLock(req));
+    EXPECT_TRUE(locked);
+}
+
 // Verifies behavior without client ID nor hardware address.
 TEST_F(ClientHandleTest, noClientIdHWAddr) {
     // Get two queries.
@@ -1256,6 +1256,76 @@ TEST_F(Dhcp4ParserTest, multipleSubnetsExplicitIDs) {
     } while (++cnt < 3);
 }
 
+// Check that a reconfiguration reuses the unchanged subnets, shared
+// networks and client classes.
+TEST_F(Dhcp4ParserTest, reuseUnchanged) {
+    string config_head = "{ " + genIfaceConfig() + ",";
+    string config_tail =
+        "\"client-classes\": [ { \"name\": \"foo\" } ],"
+        "\"shared-networks\": [ {"
+        "    \"name\": \"net\","
+        "    \"subnet4\": [ {"
+        "        \"pools\": [ { \"pool\": \"192.0.3.1 - 192.0.3.100\" } ],"
+        "        \"subnet\": \"192.0.3.0/24\", "
+        "        \"id\": 2 } ] } ],"
+        "\"subnet4\": [ {"
+        "    \"pools\": [ { \"pool\": \"192.0.2.1 - 192.0.2.100\" } ],"
+        "    \"subnet\": \"192.0.2.0/24\", "
+        "    \"id\": 1 } ] }";
+
+    // Configure the server and returns the objects of the new configuration.
+    auto reconfigure = [this] (const string& config, Subnet4Ptr& subnet,
+                               SharedNetwork4Ptr& network,
+                               ClientClassDictionaryPtr& dictionary) {
+        ConstElementPtr json;
+        ASSERT_NO_THROW(json = parseDHCP4(config));
+        ConstElementPtr status;
+        EXPECT_NO_THROW(status = configureDhcp4Server(*srv_, json));
+        checkResult(status, 0);
+        CfgMgr::instance().commit();
+        SrvConfigPtr cfg = CfgMgr::instance().getCurrentCfg();
+        subnet = cfg->getCfgSubnets4()->getSubnet(1);
+        network = cfg->getCfgSharedNetworks4()->getByName("net");
+        dictionary = cfg->getClientClassDictionary();
+        ASSERT_TRUE(subnet);
+        ASSERT_TRUE(network);
+        ASSERT_TRUE(dictionary);
+    };
+
+    Subnet4Ptr subnet;
+    SharedNetwork4Ptr network;
+    ClientClassDictionaryPtr dictionary;
+    reconfigure(config_head + config_tail, subnet, network, dictionary);
+
+    // The same configuration reuses all objects.
+    Subnet4Ptr subnet2;
+    SharedNetwork4Ptr network2;
+    ClientClassDictionaryPtr dictionary2;
+    reconfigure(config_head + config_tail, subnet2, network2, dictionary2);
+    EXPECT_EQ(subnet, subnet2);
+    EXPECT_EQ(network, network2);
+    EXPECT_EQ(dictionary, dictionary2);
+
+    // A changed global parameter is derived into the subnets and the
+    // shared networks, but not into client classes.
+    reconfigure(config_head + "\"valid-lifetime\": 1234," + config_tail,
+                subnet2, network2, dictionary2);
+    EXPECT_NE(subnet, subnet2);
+    EXPECT_EQ(1234, subnet2->getValid().get());
+    EXPECT_NE(network, network2);
+    EXPECT_EQ(dictionary, dictionary2);
+
+    // Changed option definitions prevent any reuse.
+    subnet = subnet2;
+    network = network2;
+    reconfigure(config_head + "\"valid-lifetime\": 1234," +
+                "\"option-def\": [ { \"name\": \"foo\", \"code\": 222, \"type\": \"uint32\" } ]," + config_tail,
+                subnet2, network2, dictionary2);
+    EXPECT_NE(subnet, subnet2);
+    EXPECT_NE(network, network2);
+    EXPECT_NE(dictionary, dictionary2);
+}
+
 // Check that the configuration with two subnets having the same id is rejected.
 TEST_F(Dhcp4ParserTest, multipleSubnetsOverlappingIDs) {
     ConstElementPtr x;
@@ -2332,6 +2332,19 @@ DORATest::statisticsDORA() {
     EXPECT_EQ(1, pkt4_ack_sent->getInteger().first);
     EXPECT_EQ(2, pkt4_sent->getInteger().first);
 
+    // Latency of each processing stage was recorded for both responses.
+    for (auto name : { "pkt4-latency-queue-wait",
+                       "pkt4-latency-classification",
+                       "pkt4-latency-host-lookup",
+                       "pkt4-latency-lease-allocation",
+                       "pkt4-latency-hooks",
+                       "pkt4-latency-pack-send" }) {
+        ObservationPtr latency = mgr.getObservation(name);
+        ASSERT_TRUE(latency) << name;
+        ASSERT_EQ(Observation::STAT_HISTOGRAM, latency->getType());
+        EXPECT_EQ(2, latency->getHistogram().first.getCount()) << name;
+    }
+
     // Let the client send request 3 times, which should make the server
     // to send 3 acks.
     client.setState(Dhcp4Client::RENEWING);
@@ -1,4 +1,4 @@
-// Copyright (C) 2020 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2020-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -13,6 +13,7 @@
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/member.hpp>
 #include <boost/shared_ptr.hpp>
+#include <array>
 #include <functional>
 #include <mutex>
 #include <thread>
@@ -61,13 +62,13 @@ private:
         /// @brief The next query.
         ///
         /// @note This field can be modified from another handler
-        /// holding the mutex.
+        /// holding the mutex of the shard.
         Pkt6Ptr next_query_;
 
         /// @brief The continuation to process next query for the client.
         ///
         /// @note This field can be modified from another handler
-        /// holding the mutex.
+        /// holding the mutex of the shard.
         ContinuationPtr cont_;
     };
 
@@ -94,35 +95,58 @@ private:
         >
     > ClientContainer;
 
+    /// @brief A shard of the client table.
+    ///
+    /// Clients are spread over shards by the hash of their client ID
+    /// so handlers of different clients seldom wait for each other.
+    struct Shard {
+        /// @brief Mutex to protect the client container of the shard
+        /// and the fields of its clients which can be modified by
+        /// other handlers.
+        std::mutex mutex_;
+
+        /// @brief The client container.
+        ClientContainer clients_;
+    };
+
+    /// @brief The number of shards.
+    static const size_t SHARD_COUNT = 64;
+
+    /// @brief Returns the shard of a client.
+    ///
+    /// @param duid The duid of the query from the client.
+    /// @return The shard where the client is or will be stored.
+    static Shard& getShard(const DuidPtr& duid);
+
     /// @brief Lookup a client.
     ///
-    /// The mutex must be held by the caller.
+    /// The mutex of the shard must be held by the caller.
     ///
+    /// @param shard The shard of the client.
     /// @param duid The duid of the query from the client.
     /// @return The client found in the container or null.
-    static ClientPtr lookup(const DuidPtr& duid);
+    static ClientPtr lookup(Shard& shard, const DuidPtr& duid);
 
     /// @brief Add a client.
     ///
-    /// The mutex must be held by the caller.
+    /// The mutex of the shard must be held by the caller.
     ///
+    /// @param shard The shard of the client.
     /// @param client The client to insert into the client container.
-    static void add(const ClientPtr& client);
+    static void add(Shard& shard, const ClientPtr& client);
 
     /// @brief Delete a client.
     ///
-    /// The mutex must be held by the caller.
+    /// The mutex of the shard must be held by the caller.
     ///
+    /// @param shard The shard of the client.
     /// @param duid The duid to delete from the client container.
-    static void del(const DuidPtr& duid);
+    static void del(Shard& shard, const DuidPtr& duid);
 
-    /// @brief Mutex to protect the client container.
+    /// @brief The client table shards.
     ///
-    /// The mutex is used only by public methods for guards.
-    static std::mutex mutex_;
-
-    /// @brief The client container.
-    static ClientContainer clients_;
+    /// The mutexes are used only by public methods for guards.
+    static std::array<Shard, SHARD_COUNT> shards_;
 
 public:
 
@@ -155,16 +179,21 @@ private:
 
     /// @brief Acquire a client.
     ///
-    /// The mutex must be held by the caller.
-    void lock();
+    /// The mutex of the shard must be held by the caller.
+    ///
+    /// @param shard The shard of the client.
+    void lock(Shard& shard);
 
     /// @brief Release a client.
     ///
     /// If the client has a continuation, push it at front of the thread
     /// packet queue.
     ///
-    /// The mutex must be held by the only caller: the destructor.
-    void unLock();
+    /// The mutex of the shard must be held by the only caller: the
+    /// destructor.
+    ///
+    /// @param shard The shard of the client.
+    void unLock(Shard& shard);
 
     /// @brief Local client.
     ClientPtr client_;
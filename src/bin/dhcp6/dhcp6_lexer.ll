@@ -2011,6 +2011,33 @@ ControlCharacterFill            [^"\\]|\\["\\/bfnrtu]
     }
 }
 
+\"work-stealing\" {
+    switch(driver.ctx_) {
+    case isc::dhcp::Parser6Context::DHCP_MULTI_THREADING:
+        return isc::dhcp::Dhcp6Parser::make_WORK_STEALING(driver.loc_);
+    default:
+        return isc::dhcp::Dhcp6Parser::make_STRING("work-stealing", driver.loc_);
+    }
+}
+
+\"worker-cpu-set\" {
+    switch(driver.ctx_) {
+    case isc::dhcp::Parser6Context::DHCP_MULTI_THREADING:
+        return isc::dhcp::Dhcp6Parser::make_WORKER_CPU_SET(driver.loc_);
+    default:
+        return isc::dhcp::Dhcp6Parser::make_STRING("worker-cpu-set", driver.loc_);
+    }
+}
+
+\"receiver-cpu-set\" {
+    switch(driver.ctx_) {
+    case isc::dhcp::Parser6Context::DHCP_MULTI_THREADING:
+        return isc::dhcp::Dhcp6Parser::make_RECEIVER_CPU_SET(driver.loc_);
+    default:
+        return isc::dhcp::Dhcp6Parser::make_STRING("receiver-cpu-set", driver.loc_);
+    }
+}
+
 \"control-socket\" {
     switch(driver.ctx_) {
     case isc::dhcp::Parser6Context::DHCP6:
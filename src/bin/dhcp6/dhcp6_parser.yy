@@ -213,6 +213,9 @@ using namespace std;
   ENABLE_MULTI_THREADING "enable-multi-threading"
   THREAD_POOL_SIZE "thread-pool-size"
   PACKET_QUEUE_SIZE "packet-queue-size"
+  WORK_STEALING "work-stealing"
+  WORKER_CPU_SET "worker-cpu-set"
+  RECEIVER_CPU_SET "receiver-cpu-set"
 
   CONTROL_SOCKET "control-socket"
   SOCKET_TYPE "socket-type"
@@ -1276,6 +1279,9 @@ multi_threading_params: multi_threading_param
 multi_threading_param: enable_multi_threading
                      | thread_pool_size
                      | packet_queue_size
+                     | work_stealing
+                     | worker_cpu_set
+                     | receiver_cpu_set
                      | user_context
                      | comment
                      | unknown_map_entry
@@ -1299,6 +1305,30 @@ packet_queue_size: PACKET_QUEUE_SIZE COLON INTEGER {
     ctx.stack_.back()->set("packet-queue-size", prf);
 };
 
+work_stealing: WORK_STEALING COLON BOOLEAN {
+    ctx.unique("work-stealing", ctx.loc2pos(@1));
+    ElementPtr b(new BoolElement($3, ctx.loc2pos(@3)));
+    ctx.stack_.back()->set("work-stealing", b);
+};
+
+worker_cpu_set: WORKER_CPU_SET {
+    ctx.unique("worker-cpu-set", ctx.loc2pos(@1));
+    ctx.enter(ctx.NO_KEYWORD);
+} COLON STRING {
+    ElementPtr s(new StringElement($4, ctx.loc2pos(@4)));
+    ctx.stack_.back()->set("worker-cpu-set", s);
+    ctx.leave();
+};
+
+receiver_cpu_set: RECEIVER_CPU_SET {
+    ctx.unique("receiver-cpu-set", ctx.loc2pos(@1));
+    ctx.enter(ctx.NO_KEYWORD);
+} COLON STRING {
+    ElementPtr s(new StringElement($4, ctx.loc2pos(@4)));
+    ctx.stack_.back()->set("receiver-cpu-set", s);
+    ctx.leave();
+};
+
 hooks_libraries: HOOKS_LIBRARIES {
     ctx.unique("hooks-libraries", ctx.loc2pos(@1));
     ElementPtr l(new ListElement(ctx.loc2pos(@1)));
@@ -204,6 +204,17 @@ std::set<std::string> dhcp6_statistics = {
     "v6-allocation-fail-classes"
 };
 
+/// List of latency statistics, indexed by packet processing stage
+/// (see @ref isc::dhcp::Pkt::ProcessingStage).
+const char* dhcp6_latency_statistics[Pkt::STAGE_COUNT] = {
+    "pkt6-latency-queue-wait",
+    "pkt6-latency-classification",
+    "pkt6-latency-host-lookup",
+    "pkt6-latency-lease-allocation",
+    "pkt6-latency-hooks",
+    "pkt6-latency-pack-send"
+};
+
 }  // namespace
 
 namespace isc {
@@ -382,7 +393,7 @@ Dhcpv6Srv::initContext(const Pkt6Ptr& pkt,
     SharedNetwork6Ptr sn;
     if (ctx.subnet_) {
         const ConstCfgHostOperationsPtr cfg =
-            CfgMgr::instance().getCurrentCfg()->getCfgHostOperations6();
+            CfgMgr::instance().getCurrentCfgSnapshot()->getCfgHostOperations6();
         BOOST_FOREACH(const Host::IdentifierType& id_type,
                       cfg->getIdentifierTypes()) {
             switch (id_type) {
@@ -419,6 +430,7 @@ Dhcpv6Srv::initContext(const Pkt6Ptr& pkt,
                     callout_handle->setArgument("id_value", id);
 
                     // Call callouts
+                    ScopedPktStageTimer hooks_timer(pkt, Pkt::STAGE_HOOKS);
                     HooksManager::callCallouts(Hooks.hook_index_host6_identifier_,
                                                *callout_handle);
 
@@ -441,7 +453,10 @@ Dhcpv6Srv::initContext(const Pkt6Ptr& pkt,
         }
 
         // Find host reservations using specified identifiers.
-        alloc_engine_->findReservation(ctx);
+        {
+            ScopedPktStageTimer host_timer(pkt, Pkt::STAGE_HOST_LOOKUP);
+            alloc_engine_->findReservation(ctx);
+        }
 
         // Get shared network to see if it is set for a subnet.
         ctx.subnet_->getSharedNetwork(sn);
@@ -472,7 +487,7 @@ Dhcpv6Srv::initContext(const Pkt6Ptr& pkt,
         // replace the second_class because the second_class will this
         // time evaluate to false as desired.
         const ClientClassDictionaryPtr& dict =
-            CfgMgr::instance().getCurrentCfg()->getClientClassDictionary();
+            CfgMgr::instance().getCurrentCfgSnapshot()->getClientClassDictionary();
         const ClientClassDefListPtr& defs_ptr = dict->getClasses();
         for (auto def : *defs_ptr) {
             // Only remove evaluated classes. Other classes can be
@@ -606,6 +621,11 @@ void Dhcpv6Srv::run_one() {
         return;
     }
 
+    dispatchPacket(query);
+}
+
+void
+Dhcpv6Srv::dispatchPacket(Pkt6Ptr& query) {
     // If the DHCP service has been globally disabled, drop the packet.
     if (!network_state_->isServiceEnabled()) {
         LOG_DEBUG(bad_packet6_logger, DBGLVL_PKT_HANDLING, DHCP6_PACKET_DROP_DHCP_DISABLED)
@@ -626,6 +646,22 @@ void Dhcpv6Srv::run_one() {
     }
 }
 
+size_t
+Dhcpv6Srv::dispatchQueuedPackets() {
+    IfaceMgr& iface_mgr = IfaceMgr::instance();
+    if (!iface_mgr.isDHCPReceiverRunning()) {
+        return (0);
+    }
+
+    size_t count = 0;
+    for (Pkt6Ptr query = iface_mgr.getPacketQueue6()->dequeuePacket(); query;
+         query = iface_mgr.getPacketQueue6()->dequeuePacket()) {
+        dispatchPacket(query);
+        ++count;
+    }
+    return (count);
+}
+
 void
 Dhcpv6Srv::processPacketAndSendResponseNoThrow(Pkt6Ptr& query) {
     try {
@@ -652,6 +688,16 @@ Dhcpv6Srv::processPacketAndSendResponse(Pkt6Ptr& query) {
 
 void
 Dhcpv6Srv::processPacket(Pkt6Ptr& query, Pkt6Ptr& rsp) {
+    // The whole processing of the packet uses the same configuration.
+    CfgSnapshotPin cfg_pin;
+
+    // Time spent by the packet in the queues since its reception.
+    if (!query->getTimestamp().is_not_a_date_time()) {
+        query->addStageDuration(Pkt::STAGE_QUEUE_WAIT,
+                                boost::posix_time::microsec_clock::universal_time() -
+                                query->getTimestamp());
+    }
+
     bool skip_unpack = false;
 
     // The packet has just been received so contains the uninterpreted wire
@@ -672,6 +718,7 @@ Dhcpv6Srv::processPacket(Pkt6Ptr& query, Pkt6Ptr& rsp) {
         callout_handle->setArgument("query6", query);
 
         // Call callouts
+        ScopedPktStageTimer hooks_timer(query, Pkt::STAGE_HOOKS);
         HooksManager::callCallouts(Hooks.hook_index_buffer6_receive_, *callout_handle);
 
         // Callouts decided to skip the next processing step. The next
@@ -791,6 +838,7 @@ Dhcpv6Srv::processPacket(Pkt6Ptr& query, Pkt6Ptr& rsp) {
         callout_handle->setArgument("query6", query);
 
         // Call callouts
+        ScopedPktStageTimer hooks_timer(query, Pkt::STAGE_HOOKS);
         HooksManager::callCallouts(Hooks.hook_index_pkt6_receive_, *callout_handle);
 
         // Callouts decided to skip the next processing step. The next
@@ -853,6 +901,10 @@ Dhcpv6Srv::processDhcp6QueryAndSendResponse(Pkt6Ptr& query, Pkt6Ptr& rsp) {
 
 void
 Dhcpv6Srv::processDhcp6Query(Pkt6Ptr& query, Pkt6Ptr& rsp) {
+    // The processing is resumed here for parked packets: use the same
+    // configuration until it completes.
+    CfgSnapshotPin cfg_pin;
+
     // Create a client race avoidance RAII handler.
     ClientHandler client_handler;
 
@@ -1035,7 +1087,7 @@ Dhcpv6Srv::processDhcp6Query(Pkt6Ptr& query, Pkt6Ptr& rsp) {
         // Get the parking limit. Parsing should ensure the value is present.
         uint32_t parked_packet_limit = 0;
         data::ConstElementPtr ppl = CfgMgr::instance().
-            getCurrentCfg()->getConfiguredGlobal("parked-packet-limit");
+            getCurrentCfgSnapshot()->getConfiguredGlobal("parked-packet-limit");
         if (ppl) {
             parked_packet_limit = ppl->intValue();
         }
@@ -1076,6 +1128,7 @@ Dhcpv6Srv::processDhcp6Query(Pkt6Ptr& query, Pkt6Ptr& rsp) {
 
         try {
             // Call all installed callouts
+            ScopedPktStageTimer hooks_timer(query, Pkt::STAGE_HOOKS);
             HooksManager::callCallouts(Hooks.hook_index_leases6_committed_,
                                        *callout_handle);
         } catch (...) {
@@ -1130,6 +1183,9 @@ Dhcpv6Srv::processPacketPktSend(hooks::CalloutHandlePtr& callout_handle,
         return;
     }
 
+    // The response takes over the timing of the query.
+    rsp->copyStageDurations(*query);
+
     // Specifies if server should do the packing
     bool skip_pack = false;
 
@@ -1155,6 +1211,7 @@ Dhcpv6Srv::processPacketPktSend(hooks::CalloutHandlePtr& callout_handle,
         callout_handle->setArgument("response6", rsp);
 
         // Call all installed callouts
+        ScopedPktStageTimer hooks_timer(rsp, Pkt::STAGE_HOOKS);
         HooksManager::callCallouts(Hooks.hook_index_pkt6_send_, *callout_handle);
 
         // Callouts decided to skip the next processing step. The next
@@ -1179,6 +1236,7 @@ Dhcpv6Srv::processPacketPktSend(hooks::CalloutHandlePtr& callout_handle,
 
     if (!skip_pack) {
         try {
+            ScopedPktStageTimer timer(rsp, Pkt::STAGE_PACK_SEND);
             rsp->pack();
         } catch (const std::exception& e) {
             LOG_ERROR(options6_logger, DHCP6_PACK_FAIL).arg(e.what());
@@ -1215,6 +1273,7 @@ Dhcpv6Srv::processPacketBufferSend(CalloutHandlePtr& callout_handle,
             callout_handle->setArgument("response6", rsp);
 
             // Call callouts
+            ScopedPktStageTimer hooks_timer(rsp, Pkt::STAGE_HOOKS);
             HooksManager::callCallouts(Hooks.hook_index_buffer6_send_,
                                        *callout_handle);
 
@@ -1245,10 +1304,14 @@ Dhcpv6Srv::processPacketBufferSend(CalloutHandlePtr& callout_handle,
         LOG_DEBUG(packet6_logger, DBG_DHCP6_DETAIL_DATA, DHCP6_RESPONSE_DATA)
             .arg(static_cast<int>(rsp->getType())).arg(rsp->toText());
 
-        sendPacket(rsp);
+        {
+            ScopedPktStageTimer timer(rsp, Pkt::STAGE_PACK_SEND);
+            sendPacket(rsp);
+        }
 
         // Update statistics accordingly for sent packet.
         processStatsSent(rsp);
+        processStatsLatency(rsp);
 
     } catch (const std::exception& e) {
         LOG_ERROR(packet6_logger, DHCP6_PACKET_SEND_FAIL).arg(e.what());
@@ -1341,7 +1404,7 @@ Dhcpv6Srv::buildCfgOptionList(const Pkt6Ptr& question,
     for (ClientClasses::const_iterator cclass = classes.cbegin();
          cclass != classes.cend(); ++cclass) {
         // Find the client class definition for this class
-        const ClientClassDefPtr& ccdef = CfgMgr::instance().getCurrentCfg()->
+        const ClientClassDefPtr& ccdef = CfgMgr::instance().getCurrentCfgSnapshot()->
             getClientClassDictionary()->findClass(*cclass);
         if (!ccdef) {
             // Not found: the class is built-in or not configured
@@ -1363,8 +1426,8 @@ Dhcpv6Srv::buildCfgOptionList(const Pkt6Ptr& question,
     }
 
     // Last global options
-    if (!CfgMgr::instance().getCurrentCfg()->getCfgOption()->empty()) {
-        co_list.push_back(CfgMgr::instance().getCurrentCfg()->getCfgOption());
+    if (!CfgMgr::instance().getCurrentCfgSnapshot()->getCfgOption()->empty()) {
+        co_list.push_back(CfgMgr::instance().getCurrentCfgSnapshot()->getCfgOption());
     }
 }
 
@@ -1673,7 +1736,7 @@ Subnet6Ptr
 Dhcpv6Srv::selectSubnet(const Pkt6Ptr& question, bool& drop) {
     const SubnetSelector& selector = CfgSubnets6::initSelector(question);
 
-    Subnet6Ptr subnet = CfgMgr::instance().getCurrentCfg()->
+    Subnet6Ptr subnet = CfgMgr::instance().getCurrentCfgSnapshot()->
         getCfgSubnets6()->selectSubnet(selector);
 
     // Let's execute all callouts registered for subnet6_receive
@@ -1697,10 +1760,11 @@ Dhcpv6Srv::selectSubnet(const Pkt6Ptr& question, bool& drop) {
         // Otherwise we would get a non-trivial performance penalty each
         // time subnet6_select is called.
         callout_handle->setArgument("subnet6collection",
-                                    CfgMgr::instance().getCurrentCfg()->
+                                    CfgMgr::instance().getCurrentCfgSnapshot()->
                                     getCfgSubnets6()->getAll());
 
         // Call user (and server-side) callouts
+        ScopedPktStageTimer hooks_timer(question, Pkt::STAGE_HOOKS);
         HooksManager::callCallouts(Hooks.hook_index_subnet6_select_, *callout_handle);
 
         // Callouts decided to skip this step. This means that no
@@ -1748,6 +1812,8 @@ Dhcpv6Srv::selectSubnet(const Pkt6Ptr& question, bool& drop) {
 void
 Dhcpv6Srv::assignLeases(const Pkt6Ptr& question, Pkt6Ptr& answer,
                         AllocEngine::ClientContext6& ctx) {
+    ScopedPktStageTimer timer(question, Pkt::STAGE_LEASE_ALLOCATION);
+
     // Save the originally selected subnet.
     Subnet6Ptr orig_subnet = ctx.subnet_;
 
@@ -2000,7 +2066,7 @@ Dhcpv6Srv::createNameChangeRequests(const Pkt6Ptr& answer,
 
 HWAddrPtr
 Dhcpv6Srv::getMAC(const Pkt6Ptr& pkt) {
-    CfgMACSources mac_sources = CfgMgr::instance().getCurrentCfg()->
+    CfgMACSources mac_sources = CfgMgr::instance().getCurrentCfgSnapshot()->
         getMACSources().get();
     HWAddrPtr hwaddr;
     for (CfgMACSources::const_iterator it = mac_sources.begin();
@@ -2645,6 +2711,7 @@ Dhcpv6Srv::extendIA_PD(const Pkt6Ptr& query,
 void
 Dhcpv6Srv::extendLeases(const Pkt6Ptr& query, Pkt6Ptr& reply,
                        AllocEngine::ClientContext6& ctx) {
+    ScopedPktStageTimer timer(query, Pkt::STAGE_LEASE_ALLOCATION);
 
     // We will try to extend lease lifetime for all IA options in the client's
     // Renew or Rebind message.
@@ -3636,7 +3703,7 @@ Dhcpv6Srv::declineLease(const Pkt6Ptr& decline, const Lease6Ptr lease,
     // We need to disassociate the lease from the client. Once we move a lease
     // to declined state, it is no longer associated with the client in any
     // way.
-    lease->decline(CfgMgr::instance().getCurrentCfg()->getDeclinePeriod());
+    lease->decline(CfgMgr::instance().getCurrentCfgSnapshot()->getDeclinePeriod());
 
     try {
         LeaseMgrFactory::instance().updateLease6(lease);
@@ -3760,9 +3827,11 @@ void Dhcpv6Srv::classifyPacket(const Pkt6Ptr& pkt) {
 }
 
 void Dhcpv6Srv::evaluateClasses(const Pkt6Ptr& pkt, bool depend_on_known) {
+    ScopedPktStageTimer timer(pkt, Pkt::STAGE_CLASSIFICATION);
+
     // Note getClientClassDictionary() cannot be null
     const ClientClassDictionaryPtr& dict =
-        CfgMgr::instance().getCurrentCfg()->getClientClassDictionary();
+        CfgMgr::instance().getCurrentCfgSnapshot()->getClientClassDictionary();
     const ClientClassDefListPtr& defs_ptr = dict->getClasses();
     for (ClientClassDefList::const_iterator it = defs_ptr->cbegin();
          it != defs_ptr->cend(); ++it) {
@@ -3783,7 +3852,7 @@ void Dhcpv6Srv::evaluateClasses(const Pkt6Ptr& pkt, bool depend_on_known) {
         // Evaluate the expression which can return false (no match),
         // true (match) or raise an exception (error)
         try {
-            bool status = evaluateBool(*expr_ptr, *pkt);
+            bool status = (*it)->evaluateMatchExpr(*pkt);
             if (status) {
                 LOG_INFO(dhcp6_logger, EVAL_RESULT)
                     .arg((*it)->getName())
@@ -3843,6 +3912,8 @@ Dhcpv6Srv::conditionallySetReservedClientClasses(const Pkt6Ptr& pkt,
 
 void
 Dhcpv6Srv::requiredClassify(const Pkt6Ptr& pkt, AllocEngine::ClientContext6& ctx) {
+    ScopedPktStageTimer timer(pkt, Pkt::STAGE_CLASSIFICATION);
+
     // First collect required classes
     ClientClasses classes = pkt->getClasses(true);
     Subnet6Ptr subnet = ctx.subnet_;
@@ -3888,7 +3959,7 @@ Dhcpv6Srv::requiredClassify(const Pkt6Ptr& pkt, AllocEngine::ClientContext6& ctx
     // Run match expressions
     // Note getClientClassDictionary() cannot be null
     const ClientClassDictionaryPtr& dict =
-        CfgMgr::instance().getCurrentCfg()->getClientClassDictionary();
+        CfgMgr::instance().getCurrentCfgSnapshot()->getClientClassDictionary();
     for (ClientClasses::const_iterator cclass = classes.cbegin();
          cclass != classes.cend(); ++cclass) {
         const ClientClassDefPtr class_def = dict->findClass(*cclass);
@@ -3907,7 +3978,7 @@ Dhcpv6Srv::requiredClassify(const Pkt6Ptr& pkt, AllocEngine::ClientContext6& ctx
         // Evaluate the expression which can return false (no match),
         // true (match) or raise an exception (error)
         try {
-            bool status = evaluateBool(*expr_ptr, *pkt);
+            bool status = class_def->evaluateMatchExpr(*pkt);
             if (status) {
                 LOG_INFO(dhcp6_logger, EVAL_RESULT)
                     .arg(*cclass)
@@ -4124,7 +4195,7 @@ void Dhcpv6Srv::processRSOO(const Pkt6Ptr& query, const Pkt6Ptr& rsp) {
     }
 
     // Get RSOO configuration.
-    ConstCfgRSOOPtr cfg_rsoo  = CfgMgr::instance().getCurrentCfg()->getCfgRSOO();
+    ConstCfgRSOOPtr cfg_rsoo  = CfgMgr::instance().getCurrentCfgSnapshot()->getCfgRSOO();
 
     // Let's get over all relays (encapsulation levels). We need to do
     // it in the same order as the client packet traversed the relays.
@@ -4248,6 +4319,25 @@ int Dhcpv6Srv::getHookIndexBuffer6Send() {
     return (Hooks.hook_index_buffer6_send_);
 }
 
+void Dhcpv6Srv::processStatsLatency(const Pkt6Ptr& response) {
+    StatsMgr& stats_mgr = StatsMgr::instance();
+    for (size_t i = 0; i < Pkt::STAGE_COUNT; ++i) {
+        const boost::posix_time::time_duration& duration =
+            response->getStageDuration(static_cast<Pkt::ProcessingStage>(i));
+        stats_mgr.recordThreadValue(dhcp6_latency_statistics[i],
+                                    std::chrono::microseconds(duration.total_microseconds()));
+    }
+
+    // The total latency is known only when the query timestamp is.
+    if (!response->getQueryTimestamp().is_not_a_date_time()) {
+        boost::posix_time::time_duration total =
+            boost::posix_time::microsec_clock::universal_time() -
+            response->getQueryTimestamp();
+        stats_mgr.recordThreadValue("pkt6-latency-total",
+                                    std::chrono::microseconds(total.total_microseconds()));
+    }
+}
+
 bool
 Dhcpv6Srv::requestedInORO(const Pkt6Ptr& query, const uint16_t code) const {
     OptionUint16ArrayPtr oro =
@@ -1,4 +1,4 @@
-// Copyright (C) 2012-2020 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2012-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -44,6 +44,49 @@ isc::data::ConstElementPtr
 configureDhcp6Server(Dhcpv6Srv& server, isc::data::ConstElementPtr config_set,
                      bool check_only = false);
 
+/// @brief Parses the DHCPv6 configuration into the staging configuration.
+///
+/// This is the first step of @ref configureDhcp6Server. It fills the
+/// staging configuration and stages the runtime option definitions but
+/// does not apply anything to the running server. In background mode
+/// it is called by a thread parsing the new configuration while the
+/// packet processing threads keep using the current configuration: the
+/// interfaces configuration and the checks of interface names, which
+/// depend on the detected interfaces, are then left to
+/// @ref applyDhcp6Config.
+///
+/// This function does not throw. On error the staged runtime option
+/// definitions are reverted.
+///
+/// @param server DHCPv6 server
+/// @param config_set a new configuration (JSON) for DHCPv6 server
+/// @param check_only whether this configuration is for testing only
+/// @param background whether the configuration is parsed in the background
+/// @return null on success or an answer with the error
+isc::data::ConstElementPtr
+parseDhcp6Config(Dhcpv6Srv& server, isc::data::ConstElementPtr config_set,
+                 bool check_only = false, bool background = false);
+
+/// @brief Applies the DHCPv6 configuration parsed into the staging
+/// configuration.
+///
+/// This is the second step of @ref configureDhcp6Server: it sets up the
+/// command channel, the DHCP-DDNS client and the hooks libraries and
+/// fetches the configuration from config backends. It must be called
+/// when packet processing is stopped. When the configuration was parsed
+/// in the background it also stops the services which are reconfigured
+/// and configures the interfaces.
+///
+/// This function does not throw.
+///
+/// @param server DHCPv6 server
+/// @param config_set the new configuration (JSON) with default values
+/// @param background whether the configuration was parsed in the background
+/// @return answer that contains result of reconfiguration
+isc::data::ConstElementPtr
+applyDhcp6Config(Dhcpv6Srv& server, isc::data::ConstElementPtr config_set,
+                 bool background = false);
+
 }  // namespace dhcp
 }  // namespace isc
 
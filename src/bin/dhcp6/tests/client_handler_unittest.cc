@@ -1,4 +1,4 @@
-// Copyright (C) 2020-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2020-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -244,6 +244,41 @@ TEST_F(ClientHandleTest, notSharedQueries) {
     checkStat(false);
 }
 
+// Verifies that many clients spread over the shards are handled
+// independently.
+TEST_F(ClientHandleTest, manyClients) {
+    const size_t count = 200;
+    std::vector<boost::shared_ptr<ClientHandler> > handlers;
+    for (size_t i = 0; i < count; ++i) {
+        Pkt6Ptr sol(new Pkt6(DHCPV6_SOLICIT, 1234 + i));
+        sol->addOption(generateClientId(static_cast<uint8_t>(i)));
+        boost::shared_ptr<ClientHandler> handler(new ClientHandler());
+        bool locked = false;
+        EXPECT_NO_THROW(locked = handler->tryLock(sol));
+        EXPECT_TRUE(locked) << "client " << i;
+        handlers.push_back(handler);
+    }
+    checkStat(false);
+
+    // A query from one of these clients is a duplicate.
+    Pkt6Ptr req(new Pkt6(DHCPV6_REQUEST, 4321));
+    req->addOption(generateClientId(static_cast<uint8_t>(count / 2)));
+    {
+        ClientHandler client_handler;
+        bool locked = true;
+        EXPECT_NO_THROW(locked = client_handler.tryLock(req));
+        EXPECT_FALSE(locked);
+    }
+    checkStat(true);
+
+    // Release all clients: the query is no longer a duplicate.
+    handlers.clear();
+    ClientHandler client_handler;
+    bool locked = false;
+    EXPECT_NO_THROW(locked = client_handler.tryLock(req));
+    EXPECT_TRUE(locked);
+}
+
 // Verifies behavior without client ID.
 TEST_F(ClientHandleTest, noClientId) {
     // Get two queries.
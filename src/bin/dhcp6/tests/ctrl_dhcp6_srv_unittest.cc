@@ -569,6 +569,8 @@ TEST_F(CtrlDhcpv6SrvTest, commandsRegistration) {
 
     EXPECT_TRUE(command_list.find("\"list-commands\"") != string::npos);
     EXPECT_TRUE(command_list.find("\"build-report\"") != string::npos);
+    EXPECT_TRUE(command_list.find("\"class-stats-get\"") != string::npos);
+    EXPECT_TRUE(command_list.find("\"class-stats-set\"") != string::npos);
     EXPECT_TRUE(command_list.find("\"config-backend-pull\"") != string::npos);
     EXPECT_TRUE(command_list.find("\"config-get\"") != string::npos);
     EXPECT_TRUE(command_list.find("\"config-set\"") != string::npos);
@@ -799,6 +801,91 @@ TEST_F(CtrlChannelDhcpv6SrvTest, configSet) {
     CfgMgr::instance().clear();
 }
 
+// Tests that config-set parses the new configuration in the background
+// when multi-threading is enabled and remains enabled.
+TEST_F(CtrlChannelDhcpv6SrvTest, configSetBackground) {
+    createUnixChannelServer();
+
+    // Packets are processed by the thread pool.
+    MultiThreadingMgr::instance().apply(true, 2, 16);
+
+    string config_header =
+        "{ \"command\": \"config-set\", \n"
+        "  \"arguments\": { \n"
+        "    \"Dhcp6\": { \n"
+        "        \"interfaces-config\": { \n"
+        "            \"interfaces\": [\"*\"] \n"
+        "        }, \n"
+        "        \"multi-threading\": { \n"
+        "            \"enable-multi-threading\": true, \n"
+        "            \"thread-pool-size\": 2, \n"
+        "            \"packet-queue-size\": 16 \n"
+        "        }, \n"
+        "        \"lease-database\": { \n"
+        "           \"type\": \"memfile\", \n"
+        "           \"persist\":false, \n"
+        "           \"lfc-interval\": 0  \n"
+        "        }, \n"
+        "        \"option-def\": [ { \n"
+        "            \"name\": \"foo\", \n"
+        "            \"code\": 163, \n"
+        "            \"type\": \"uint32\", \n"
+        "            \"space\": \"dhcp6\" \n"
+        "        } ], \n"
+        "        \"control-socket\": { \n"
+        "            \"socket-type\": \"unix\", \n"
+        "            \"socket-name\": \"" + socket_path_ + "\" \n"
+        "        }, \n";
+    string subnets =
+        "        \"subnet6\": [ \n"
+        "            { \"subnet\": \"3002::/64\", \n"
+        "              \"pools\": [ { \"pool\": \"3002::100-3002::200\" } ] }, \n"
+        "            { \"subnet\": \"3003::/64\", \n"
+        "              \"pools\": [ { \"pool\": \"3003::100-3003::200\" } ] } \n"
+        "        ] \n";
+    string bad_subnets =
+        "        \"subnet6\": [ \n"
+        "            { \"comment\": \"3002::/64\" } \n"
+        "        ] \n";
+    string config_footer = "} } }";
+
+    // Send a valid configuration.
+    std::string response;
+    sendUnixCommand(config_header + subnets + config_footer, response);
+    EXPECT_EQ("{ \"result\": 0, \"text\": \"Configuration successful.\" }",
+              response);
+
+    // Check that the configuration was applied.
+    const Subnet6Collection* subnets_cfg =
+        CfgMgr::instance().getCurrentCfg()->getCfgSubnets6()->getAll();
+    EXPECT_EQ(2, subnets_cfg->size());
+    EXPECT_TRUE(LibDHCP::getRuntimeOptionDef(DHCP6_OPTION_SPACE, 163));
+    EXPECT_TRUE(MultiThreadingMgr::instance().getMode());
+    EXPECT_EQ(2, MultiThreadingMgr::instance().getThreadPoolSize());
+    uint32_t sequence = CfgMgr::instance().getCurrentCfg()->getSequence();
+
+    // Send a configuration which fails to parse.
+    sendUnixCommand(config_header + bad_subnets + config_footer, response);
+    ConstElementPtr answer;
+    ASSERT_NO_THROW(answer = Element::fromJSON(response));
+    int rcode = -1;
+    ASSERT_NO_THROW(parseAnswer(rcode, answer));
+    EXPECT_EQ(1, rcode);
+
+    // Nothing was applied: the current configuration is still in use
+    // and the thread pool was not stopped.
+    EXPECT_EQ(sequence, CfgMgr::instance().getCurrentCfg()->getSequence());
+    subnets_cfg = CfgMgr::instance().getCurrentCfg()->getCfgSubnets6()->getAll();
+    EXPECT_EQ(2, subnets_cfg->size());
+    EXPECT_TRUE(LibDHCP::getRuntimeOptionDef(DHCP6_OPTION_SPACE, 163));
+    EXPECT_EQ(2, MultiThreadingMgr::instance().getThreadPool().size());
+    EXPECT_TRUE(fileExists(socket_path_));
+
+    // Clean up after the test.
+    MultiThreadingMgr::instance().apply(false, 0, 0);
+    CfgMgr::instance().clear();
+}
+
 // Tests if the server returns its configuration using config-get.
 // Note there are separate tests that verify if toElement() called by the
 // config-get handler are actually converting the configuration correctly.
@@ -1040,6 +1127,9 @@ TEST_F(CtrlChannelDhcpv6SrvTest, statusGet) {
     auto found_queue_stats = arguments->get("packet-queue-statistics");
     ASSERT_FALSE(found_queue_stats);
 
+    // No receiver or worker thread is running.
+    EXPECT_FALSE(arguments->get("threads"));
+
     MultiThreadingMgr::instance().setMode(true);
     MultiThreadingMgr::instance().setThreadPoolSize(4);
     MultiThreadingMgr::instance().setPacketQueueSize(64);
@@ -1091,6 +1181,109 @@ TEST_F(CtrlChannelDhcpv6SrvTest, statusGet) {
     EXPECT_EQ(3, found_queue_stats->size());
 }
 
+// This test verifies that the status-get command returns the CPU of
+// the worker threads.
+TEST_F(CtrlChannelDhcpv6SrvTest, statusGetThreads) {
+    createUnixChannelServer();
+
+    // Start two worker threads pinned on CPU 0.
+    MultiThreadingMgr::instance().setCpuSet(CpuSet(1, 0));
+    MultiThreadingMgr::instance().apply(true, 2, 16);
+
+    std::string response_txt;
+    sendUnixCommand("{ \"command\": \"status-get\" }", response_txt);
+    ConstElementPtr response;
+    ASSERT_NO_THROW(response = Element::fromJSON(response_txt));
+    ASSERT_TRUE(response);
+    ConstElementPtr result = response->get("result");
+    ASSERT_TRUE(result);
+    EXPECT_EQ(0, result->intValue());
+    ConstElementPtr arguments = response->get("arguments");
+    ASSERT_TRUE(arguments);
+
+    ConstElementPtr threads = arguments->get("threads");
+    ASSERT_TRUE(threads);
+    ASSERT_EQ(Element::list, threads->getType());
+    ASSERT_EQ(2, threads->size());
+    for (size_t i = 0; i < threads->size(); ++i) {
+        ConstElementPtr thread = threads->get(i);
+        ASSERT_TRUE(thread);
+        ASSERT_TRUE(thread->get("name"));
+        EXPECT_EQ("worker-" + std::to_string(i), thread->get("name")->stringValue());
+        ASSERT_TRUE(thread->get("cpu"));
+        EXPECT_EQ(Element::integer, thread->get("cpu")->getType());
+        ASSERT_TRUE(thread->get("cpu-set"));
+        EXPECT_EQ("0", thread->get("cpu-set")->stringValue());
+    }
+
+    MultiThreadingMgr::instance().setCpuSet(CpuSet());
+    MultiThreadingMgr::instance().apply(false, 0, 0);
+}
+
+// This test verifies that the DHCP server handles class-stats-get command
+TEST_F(CtrlChannelDhcpv6SrvTest, classStatsGet) {
+    createUnixChannelServer();
+
+    std::string response;
+
+    // No class.
+    sendUnixCommand("{ \"command\": \"class-stats-get\" }", response);
+    EXPECT_EQ("{ \"arguments\": { \"classes\": [  ], \"enabled\": false },"
+              " \"result\": 0 }", response);
+
+    // Enable the collection of the statistics.
+    sendUnixCommand("{ \"command\": \"class-stats-set\", "
+                    "\"arguments\": { \"enabled\": true } }", response);
+    EXPECT_EQ("{ \"result\": 0, \"text\": \"class statistics collection"
+              " enabled\" }", response);
+
+    // Add a class and evaluate it.
+    ClientClassDictionaryPtr dict =
+        CfgMgr::instance().getCurrentCfg()->getClientClassDictionary();
+    ExpressionPtr expr(new Expression());
+    expr->push_back(TokenPtr(new TokenString("true")));
+    ASSERT_NO_THROW(dict->addClass("foo", expr, "'true'", false, false,
+                                   CfgOptionPtr()));
+    Pkt6 pkt(DHCPV6_SOLICIT, 1234);
+    EXPECT_TRUE(dict->findClass("foo")->evaluateMatchExpr(pkt));
+
+    sendUnixCommand("{ \"command\": \"class-stats-get\" }", response);
+    ConstElementPtr rsp;
+    ASSERT_NO_THROW(rsp = Element::fromJSON(response));
+    int status;
+    ConstElementPtr args = parseAnswer(status, rsp);
+    EXPECT_EQ(CONTROL_RESULT_SUCCESS, status);
+    ASSERT_TRUE(args);
+    ConstElementPtr classes = args->get("classes");
+    ASSERT_TRUE(classes);
+    ASSERT_EQ(1, classes->size());
+    ConstElementPtr stats = classes->get(0);
+    EXPECT_EQ("foo", stats->get("name")->stringValue());
+    EXPECT_EQ(1, stats->get("evaluations")->intValue());
+    EXPECT_EQ(1, stats->get("matches")->intValue());
+    EXPECT_EQ(0, stats->get("skipped")->intValue());
+    EXPECT_EQ(0, stats->get("errors")->intValue());
+    EXPECT_TRUE(stats->get("evaluation-time"));
+    ASSERT_TRUE(args->get("enabled"));
+    EXPECT_TRUE(args->get("enabled")->boolValue());
+
+    // Disable it again.
+    sendUnixCommand("{ \"command\": \"class-stats-set\", "
+                    "\"arguments\": { \"enabled\": false } }", response);
+    EXPECT_EQ("{ \"result\": 0, \"text\": \"class statistics collection"
+              " disabled\" }", response);
+    EXPECT_FALSE(ClientClassDef::getEvalStatsEnabled());
+
+    // The argument is mandatory.
+    sendUnixCommand("{ \"command\": \"class-stats-set\" }", response);
+    EXPECT_EQ("{ \"result\": 1, \"text\": \"arguments for the"
+              " 'class-stats-set' command must be a map\" }", response);
+    sendUnixCommand("{ \"command\": \"class-stats-set\", "
+                    "\"arguments\": { \"enabled\": 1 } }", response);
+    EXPECT_EQ("{ \"result\": 1, \"text\": \"'enabled' argument must be"
+              " a boolean\" }", response);
+}
+
 // This test verifies that the DHCP server handles server-tag-get command
 TEST_F(CtrlChannelDhcpv6SrvTest, serverTagGet) {
     createUnixChannelServer();
@@ -1354,6 +1547,8 @@ TEST_F(CtrlChannelDhcpv6SrvTest, listCommands) {
 
     // We expect the server to report at least the following commands:
     checkListCommands(rsp, "build-report");
+    checkListCommands(rsp, "class-stats-get");
+    checkListCommands(rsp, "class-stats-set");
     checkListCommands(rsp, "config-backend-pull");
     checkListCommands(rsp, "config-get");
     checkListCommands(rsp, "config-reload");
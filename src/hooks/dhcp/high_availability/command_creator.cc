@@ -1,4 +1,4 @@
-// Copyright (C) 2018-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2018-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -8,6 +8,7 @@
 
 #include <command_creator.h>
 #include <cc/command_interpreter.h>
+#include <dhcpsrv/lease_codec.h>
 #include <exceptions/exceptions.h>
 #include <boost/pointer_cast.hpp>
 
@@ -56,6 +57,78 @@ CommandCreator::createHeartbeat(const HAServerType& server_type) {
     return (command);
 }
 
+ConstElementPtr
+CommandCreator::createLease4BulkApply(const Lease4CollectionPtr& leases,
+                                      const Lease4CollectionPtr& deleted_leases,
+                                      const bool binary) {
+    ElementPtr deleted_leases_list = Element::createList();
+    for (auto lease = deleted_leases->begin(); lease != deleted_leases->end();
+         ++lease) {
+        ElementPtr lease_as_json = (*lease)->toElement();
+        insertLeaseExpireTime(lease_as_json);
+        deleted_leases_list->add(lease_as_json);
+    }
+
+    ElementPtr args = Element::createMap();
+    args->set("deleted-leases", deleted_leases_list);
+    if (binary) {
+        args->set("leases-binary", Element::create(LeaseCodec::encodeText(*leases)));
+
+    } else {
+        ElementPtr leases_list = Element::createList();
+        for (auto lease = leases->begin(); lease != leases->end();
+             ++lease) {
+            ElementPtr lease_as_json = (*lease)->toElement();
+            insertLeaseExpireTime(lease_as_json);
+            leases_list->add(lease_as_json);
+        }
+        args->set("leases", leases_list);
+    }
+
+    ConstElementPtr command = config::createCommand("lease4-bulk-apply", args);
+    insertService(command, HAServerType::DHCPv4);
+    return (command);
+}
+
+ConstElementPtr
+CommandCreator::createLease4BulkApply(LeaseUpdateBacklog& leases,
+                                      const bool binary,
+                                      const size_t limit) {
+    ElementPtr deleted_leases_list = Element::createList();
+    ElementPtr leases_list = Element::createList();
+    Lease4Collection updated_leases;
+
+    LeaseUpdateBacklog::OpType op_type;
+    Lease4Ptr lease;
+    size_t count = 0;
+    while (((limit == 0) || (count++ < limit)) &&
+           (lease = boost::dynamic_pointer_cast<Lease4>(leases.pop(op_type)))) {
+        if (op_type == LeaseUpdateBacklog::DELETE) {
+            ElementPtr lease_as_json = lease->toElement();
+            insertLeaseExpireTime(lease_as_json);
+            deleted_leases_list->add(lease_as_json);
+        } else if (binary) {
+            updated_leases.push_back(lease);
+        } else {
+            ElementPtr lease_as_json = lease->toElement();
+            insertLeaseExpireTime(lease_as_json);
+            leases_list->add(lease_as_json);
+        }
+    }
+
+    ElementPtr args = Element::createMap();
+    args->set("deleted-leases", deleted_leases_list);
+    if (binary) {
+        args->set("leases-binary", Element::create(LeaseCodec::encodeText(updated_leases)));
+    } else {
+        args->set("leases", leases_list);
+    }
+
+    ConstElementPtr command = config::createCommand("lease4-bulk-apply", args);
+    insertService(command, HAServerType::DHCPv4);
+    return (command);
+}
+
 ConstElementPtr
 CommandCreator::createLease4Update(const Lease4& lease4) {
     ElementPtr lease_as_json = lease4.toElement();
@@ -84,7 +157,8 @@ CommandCreator::createLease4GetAll() {
 
 ConstElementPtr
 CommandCreator::createLease4GetPage(const Lease4Ptr& last_lease4,
-                                    const uint32_t limit) {
+                                    const uint32_t limit,
+                                    const bool binary) {
     // Zero value is not allowed.
     if (limit == 0) {
         isc_throw(BadValue, "limit value for lease4-get-page command must not be 0");
@@ -100,6 +174,11 @@ CommandCreator::createLease4GetPage(const Lease4Ptr& last_lease4,
     ElementPtr args = Element::createMap();
     args->set("from", from_element);
     args->set("limit", limit_element);
+    // Request the leases in the compact binary encoding. The partner
+    // returns them in JSON when it does not support this encoding.
+    if (binary) {
+        args->set("encoding", Element::create(LeaseCodec::NAME));
+    }
 
     // Create the command.
     ConstElementPtr command = config::createCommand("lease4-get-page", args);
@@ -109,7 +188,8 @@ CommandCreator::createLease4GetPage(const Lease4Ptr& last_lease4,
 
 ConstElementPtr
 CommandCreator::createLease6BulkApply(const Lease6CollectionPtr& leases,
-                                      const Lease6CollectionPtr& deleted_leases) {
+                                      const Lease6CollectionPtr& deleted_leases,
+                                      const bool binary) {
     ElementPtr deleted_leases_list = Element::createList();
     for (auto lease = deleted_leases->begin(); lease != deleted_leases->end();
          ++lease) {
@@ -118,17 +198,21 @@ CommandCreator::createLease6BulkApply(const Lease6CollectionPtr& leases,
         deleted_leases_list->add(lease_as_json);
     }
 
-    ElementPtr leases_list = Element::createList();
-    for (auto lease = leases->begin(); lease != leases->end();
-         ++lease) {
-        ElementPtr lease_as_json = (*lease)->toElement();
-        insertLeaseExpireTime(lease_as_json);
-        leases_list->add(lease_as_json);
-    }
-
     ElementPtr args = Element::createMap();
     args->set("deleted-leases", deleted_leases_list);
-    args->set("leases", leases_list);
+    if (binary) {
+        args->set("leases-binary", Element::create(LeaseCodec::encodeText(*leases)));
+
+    } else {
+        ElementPtr leases_list = Element::createList();
+        for (auto lease = leases->begin(); lease != leases->end();
+             ++lease) {
+            ElementPtr lease_as_json = (*lease)->toElement();
+            insertLeaseExpireTime(lease_as_json);
+            leases_list->add(lease_as_json);
+        }
+        args->set("leases", leases_list);
+    }
 
     ConstElementPtr command = config::createCommand("lease6-bulk-apply", args);
     insertService(command, HAServerType::DHCPv6);
@@ -136,25 +220,35 @@ CommandCreator::createLease6BulkApply(const Lease6CollectionPtr& leases,
 }
 
 ConstElementPtr
-CommandCreator::createLease6BulkApply(LeaseUpdateBacklog& leases) {
+CommandCreator::createLease6BulkApply(LeaseUpdateBacklog& leases,
+                                      const bool binary) {
     ElementPtr deleted_leases_list = Element::createList();
     ElementPtr leases_list = Element::createList();
+    Lease6Collection updated_leases;
 
     LeaseUpdateBacklog::OpType op_type;
     Lease6Ptr lease;
     while ((lease = boost::dynamic_pointer_cast<Lease6>(leases.pop(op_type)))) {
-        ElementPtr lease_as_json = lease->toElement();
-        insertLeaseExpireTime(lease_as_json);
         if (op_type == LeaseUpdateBacklog::DELETE) {
+            ElementPtr lease_as_json = lease->toElement();
+            insertLeaseExpireTime(lease_as_json);
             deleted_leases_list->add(lease_as_json);
+        } else if (binary) {
+            updated_leases.push_back(lease);
         } else {
+            ElementPtr lease_as_json = lease->toElement();
+            insertLeaseExpireTime(lease_as_json);
             leases_list->add(lease_as_json);
         }
     }
 
     ElementPtr args = Element::createMap();
     args->set("deleted-leases", deleted_leases_list);
-    args->set("leases", leases_list);
+    if (binary) {
+        args->set("leases-binary", Element::create(LeaseCodec::encodeText(updated_leases)));
+    } else {
+        args->set("leases", leases_list);
+    }
 
     ConstElementPtr command = config::createCommand("lease6-bulk-apply", args);
     insertService(command, HAServerType::DHCPv6);
@@ -189,7 +283,8 @@ CommandCreator::createLease6GetAll() {
 
 ConstElementPtr
 CommandCreator::createLease6GetPage(const Lease6Ptr& last_lease6,
-                                    const uint32_t limit) {
+                                    const uint32_t limit,
+                                    const bool binary) {
     // Zero value is not allowed.
     if (limit == 0) {
         isc_throw(BadValue, "limit value for lease6-get-page command must not be 0");
@@ -205,6 +300,11 @@ CommandCreator::createLease6GetPage(const Lease6Ptr& last_lease6,
     ElementPtr args = Element::createMap();
     args->set("from", from_element);
     args->set("limit", limit_element);
+    // Request the leases in the compact binary encoding. The partner
+    // returns them in JSON when it does not support this encoding.
+    if (binary) {
+        args->set("encoding", Element::create(LeaseCodec::NAME));
+    }
 
     // Create the command.
     ConstElementPtr command = config::createCommand("lease6-get-page", args);
@@ -1,4 +1,4 @@
-// Copyright (C) 2018-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2018-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -53,6 +53,37 @@ public:
     static data::ConstElementPtr
     createHeartbeat(const HAServerType& server_type);
 
+    /// @brief Creates lease4-bulk-apply command.
+    ///
+    /// @param leases Pointer to the collection of leases to be created
+    /// or/and updated.
+    /// @param deleted_leases Pointer to the collection of leases to be
+    /// deleted.
+    /// @param binary Boolean flag indicating if the created or updated
+    /// leases are sent in the compact binary encoding.
+    /// @return Pointer to the JSON representation of the command.
+    static data::ConstElementPtr
+    createLease4BulkApply(const dhcp::Lease4CollectionPtr& leases,
+                          const dhcp::Lease4CollectionPtr& deleted_leases,
+                          const bool binary = false);
+
+    /// @brief Creates lease4-bulk-apply command.
+    ///
+    /// This command pops the leases from the backlog. As a result, the
+    /// backlog is empty after calling this function unless the number
+    /// of leases is limited.
+    ///
+    /// @param leases Reference to the collection of DHCPv4 leases backlog.
+    /// @param binary Boolean flag indicating if the created or updated
+    /// leases are sent in the compact binary encoding.
+    /// @param limit Maximum number of leases popped from the backlog,
+    /// 0 for no limit.
+    /// @return Pointer to the JSON representation of the command.
+    static data::ConstElementPtr
+    createLease4BulkApply(LeaseUpdateBacklog& leases,
+                          const bool binary = false,
+                          const size_t limit = 0);
+
     /// @brief Creates lease4-update command.
     ///
     /// It adds "force-create" parameter to the lease information to force
@@ -89,10 +120,13 @@ public:
     /// to fetch the first page, the @c lease4 parameter should be set to
     /// null.
     /// @param limit Limit of leases on the page.
+    /// @param binary Boolean flag indicating if the leases should be
+    /// returned in the compact binary encoding.
     /// @return Pointer to the JSON representation of the command.
     static data::ConstElementPtr
     createLease4GetPage(const dhcp::Lease4Ptr& lease4,
-                        const uint32_t limit);
+                        const uint32_t limit,
+                        const bool binary = false);
 
     /// @brief Creates lease6-bulk-apply command.
     ///
@@ -100,10 +134,13 @@ public:
     /// or/and updated.
     /// @param deleted_leases Pointer to the collection of leases to be
     /// deleted.
+    /// @param binary Boolean flag indicating if the created or updated
+    /// leases are sent in the compact binary encoding.
     /// @return Pointer to the JSON representation of the command.
     static data::ConstElementPtr
     createLease6BulkApply(const dhcp::Lease6CollectionPtr& leases,
-                          const dhcp::Lease6CollectionPtr& deleted_leases);
+                          const dhcp::Lease6CollectionPtr& deleted_leases,
+                          const bool binary = false);
 
     /// @brief Creates lease6-bulk-apply command.
     ///
@@ -111,9 +148,12 @@ public:
     /// backlog is empty after calling this function.
     ///
     /// @param leases Reference to the collection of DHCPv6 leases backlog.
+    /// @param binary Boolean flag indicating if the created or updated
+    /// leases are sent in the compact binary encoding.
     /// @return Pointer to the JSON representation of the command.
     static data::ConstElementPtr
-    createLease6BulkApply(LeaseUpdateBacklog& leases);
+    createLease6BulkApply(LeaseUpdateBacklog& leases,
+                          const bool binary = false);
 
     /// @brief Creates lease6-update command.
     ///
@@ -151,10 +191,13 @@ public:
     /// to fetch the first page, the @c lease6 parameter should be set to
     /// null.
     /// @param limit Limit of leases on the page.
+    /// @param binary Boolean flag indicating if the leases should be
+    /// returned in the compact binary encoding.
     /// @return Pointer to the JSON representation of the command.
     static data::ConstElementPtr
     createLease6GetPage(const dhcp::Lease6Ptr& lease6,
-                        const uint32_t limit);
+                        const uint32_t limit,
+                        const bool binary = false);
 
     /// @brief Creates ha-maintenance-notify command.
     ///
@@ -61,7 +61,8 @@ CommunicationState::CommunicationState(const IOServicePtr& io_service,
       clock_skew_(0, 0, 0, 0), last_clock_skew_warn_(),
       my_time_at_skew_(), partner_time_at_skew_(),
       analyzed_messages_count_(0), unsent_update_count_(0),
-      partner_unsent_update_count_{0, 0}, mutex_(new mutex()) {
+      partner_unsent_update_count_{0, 0}, partner_binary_leases_(false),
+      mutex_(new mutex()) {
 }
 
 CommunicationState::~CommunicationState() {
@@ -536,6 +537,26 @@ CommunicationState::setPartnerUnsentUpdateCountInternal(uint64_t unsent_update_c
     partner_unsent_update_count_.second = unsent_update_count;
 }
 
+bool
+CommunicationState::isPartnerBinaryLeasesSupported() const {
+    if (MultiThreadingMgr::instance().getMode()) {
+        std::lock_guard<std::mutex> lk(*mutex_);
+        return (partner_binary_leases_);
+    } else {
+        return (partner_binary_leases_);
+    }
+}
+
+void
+CommunicationState::setPartnerBinaryLeasesSupported(const bool supported) {
+    if (MultiThreadingMgr::instance().getMode()) {
+        std::lock_guard<std::mutex> lk(*mutex_);
+        partner_binary_leases_ = supported;
+    } else {
+        partner_binary_leases_ = supported;
+    }
+}
+
 CommunicationState4::CommunicationState4(const IOServicePtr& io_service,
                                          const HAConfigPtr& config)
     : CommunicationState(io_service, config), connecting_clients_() {
@@ -520,6 +520,22 @@ private:
     /// the partner.
     void setPartnerUnsentUpdateCountInternal(uint64_t unsent_update_count);
 
+public:
+
+    /// @brief Checks if the partner accepts leases in the compact binary
+    /// encoding.
+    ///
+    /// @return true if the partner advertised the binary encoding in its
+    /// last response to a heartbeat, false otherwise.
+    bool isPartnerBinaryLeasesSupported() const;
+
+    /// @brief Records if the partner accepts leases in the compact binary
+    /// encoding.
+    ///
+    /// @param supported true if the partner advertised the binary encoding
+    /// in the response to a heartbeat.
+    void setPartnerBinaryLeasesSupported(const bool supported);
+
 protected:
     /// @brief Pointer to the common IO service instance.
     asiolink::IOServicePtr io_service_;
@@ -581,6 +597,13 @@ protected:
     /// preserved so the values can be compared in the state handlers.
     std::pair<uint64_t, uint64_t> partner_unsent_update_count_;
 
+    /// @brief Boolean flag indicating if the partner accepts leases in the
+    /// compact binary encoding.
+    ///
+    /// The partner lists the encodings it supports in the responses to the
+    /// heartbeats. The earlier HA versions do not list them.
+    bool partner_binary_leases_;
+
     /// @brief The mutex used to protect internal state.
     const boost::scoped_ptr<std::mutex> mutex_;
 };
@@ -162,10 +162,12 @@ HAConfig::StateMachineConfig::getStateConfig(const int state) {
 HAConfig::HAConfig()
     : this_server_name_(), ha_mode_(HOT_STANDBY), send_lease_updates_(true),
       sync_leases_(true), sync_timeout_(60000), sync_page_limit_(10000),
-      delayed_updates_limit_(0), heartbeat_delay_(10000), max_response_delay_(60000),
+      sync_streams_(1), delayed_updates_limit_(0), lease_update_batch_size_(0),
+      lease_update_batch_delay_(5), heartbeat_delay_(10000), max_response_delay_(60000),
       max_ack_delay_(10000), max_unacked_clients_(10), wait_backup_ack_(false),
       enable_multi_threading_(false), http_dedicated_listener_(false),
       http_listener_threads_(0), http_client_threads_(0),
+      http_max_connections_(0), http_max_pipelined_requests_(1),
       trust_anchor_(), cert_file_(), key_file_(),
       peers_(), state_machine_(new StateMachineConfig()) {
 }
@@ -278,6 +280,23 @@ HAConfig::validate() {
                   << getThisServerName() << "'");
     }
 
+    // The leases must be fetched in at least one stream.
+    if (sync_streams_ == 0) {
+        isc_throw(HAConfigValidationError, "'sync-streams' must be greater than 0");
+    }
+
+    // At least one request must be sent over a connection.
+    if (http_max_pipelined_requests_ == 0) {
+        isc_throw(HAConfigValidationError, "'http-max-pipelined-requests'"
+                  " must be greater than 0");
+    }
+
+    // Incomplete batches of lease updates must be sent after some delay.
+    if (amBatchingLeaseUpdates() && (lease_update_batch_delay_ == 0)) {
+        isc_throw(HAConfigValidationError, "'lease-update-batch-delay' must be"
+                  " greater than 0 when 'lease-update-batch-size' is set");
+    }
+
     // Gather all the roles and see how many occurrences of each role we get.
     std::map<PeerConfig::Role, unsigned> peers_cnt;
     for (auto p = peers_.begin(); p != peers_.end(); ++p) {
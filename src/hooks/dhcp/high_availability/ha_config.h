@@ -1,4 +1,4 @@
-// Copyright (C) 2018-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2018-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -433,6 +433,26 @@ public:
         sync_page_limit_ = sync_page_limit;
     }
 
+    /// @brief Returns the maximum number of streams fetching the leases
+    /// in parallel during database synchronization.
+    ///
+    /// The address space is split in ranges fetched in parallel over
+    /// several connections of the multi-threaded HTTP client. The leases
+    /// are fetched in a single stream when the multi-threading is disabled.
+    ///
+    /// @return Maximum number of synchronization streams.
+    uint32_t getSyncStreams() const {
+        return (sync_streams_);
+    }
+
+    /// @brief Sets the maximum number of streams fetching the leases in
+    /// parallel during database synchronization.
+    ///
+    /// @param sync_streams New number of synchronization streams.
+    void setSyncStreams(const uint32_t sync_streams) {
+        sync_streams_ = sync_streams;
+    }
+
     /// @brief Returns the maximum number of lease updates which can be held
     /// unsent in the communication-recovery state.
     ///
@@ -476,6 +496,50 @@ public:
         return (delayed_updates_limit_ > 0);
     }
 
+    /// @brief Returns the maximum number of DHCPv4 lease updates sent to
+    /// a peer in one lease4-bulk-apply command.
+    ///
+    /// The DHCPv4 lease updates of several queries are collected and sent
+    /// together when this value is greater than 0. Otherwise, a
+    /// lease4-update or lease4-del command is sent for each lease.
+    ///
+    /// @return Maximum number of lease updates in a batch.
+    uint32_t getLeaseUpdateBatchSize() const {
+        return (lease_update_batch_size_);
+    }
+
+    /// @brief Sets the maximum number of DHCPv4 lease updates sent to a
+    /// peer in one lease4-bulk-apply command.
+    ///
+    /// @param lease_update_batch_size new batch size, 0 disables batching.
+    void setLeaseUpdateBatchSize(const uint32_t lease_update_batch_size) {
+        lease_update_batch_size_ = lease_update_batch_size;
+    }
+
+    /// @brief Returns the maximum delay in milliseconds before an
+    /// incomplete batch of DHCPv4 lease updates is sent.
+    ///
+    /// @return Batch delay in milliseconds.
+    uint32_t getLeaseUpdateBatchDelay() const {
+        return (lease_update_batch_delay_);
+    }
+
+    /// @brief Sets the maximum delay in milliseconds before an incomplete
+    /// batch of DHCPv4 lease updates is sent.
+    ///
+    /// @param lease_update_batch_delay new batch delay in milliseconds.
+    void setLeaseUpdateBatchDelay(const uint32_t lease_update_batch_delay) {
+        lease_update_batch_delay_ = lease_update_batch_delay;
+    }
+
+    /// @brief Convenience function checking if the DHCPv4 lease updates
+    /// are sent in batches.
+    ///
+    /// @return true if the lease update batch size is greater than 0.
+    bool amBatchingLeaseUpdates() const {
+        return (lease_update_batch_size_ > 0);
+    }
+
     /// @brief Returns heartbeat delay in milliseconds.
     ///
     /// This value indicates the delay in sending a heartbeat command after
@@ -632,6 +696,42 @@ public:
         http_client_threads_ = http_client_threads;
     }
 
+    /// @brief Returns the maximum number of connections the HTTP client
+    /// opens to a partner.
+    ///
+    /// @return Maximum number of connections per partner. The value of 0
+    /// means one connection in single-threaded mode or one connection per
+    /// HTTP client thread in multi-threaded mode.
+    uint32_t getHttpMaxConnections() const {
+        return (http_max_connections_);
+    }
+
+    /// @brief Sets the maximum number of connections the HTTP client opens
+    /// to a partner.
+    ///
+    /// @param http_max_connections New maximum number of connections.
+    void setHttpMaxConnections(const uint32_t http_max_connections) {
+        http_max_connections_ = http_max_connections;
+    }
+
+    /// @brief Returns the maximum number of requests the HTTP client sends
+    /// over a connection without waiting for the responses.
+    ///
+    /// @return Maximum number of pipelined requests. The value of 1 disables
+    /// HTTP pipelining.
+    uint32_t getHttpMaxPipelinedRequests() const {
+        return (http_max_pipelined_requests_);
+    }
+
+    /// @brief Sets the maximum number of requests the HTTP client sends over
+    /// a connection without waiting for the responses.
+    ///
+    /// @param http_max_pipelined_requests New maximum number of pipelined
+    /// requests.
+    void setHttpMaxPipelinedRequests(const uint32_t http_max_pipelined_requests) {
+        http_max_pipelined_requests_ = http_max_pipelined_requests;
+    }
+
     /// @brief Returns global trust-anchor.
     util::Optional<std::string> getTrustAnchor() const {
         return (trust_anchor_);
@@ -738,8 +838,13 @@ public:
     uint32_t sync_timeout_;                   ///< Timeout for syncing lease database (ms)
     uint32_t sync_page_limit_;                ///< Page size limit while
                                               ///< synchronizing leases.
+    uint32_t sync_streams_;                   ///< Maximum number of streams
+                                              ///< synchronizing leases.
     uint32_t delayed_updates_limit_;          ///< Maximum number of lease updates held
                                               ///< for later send in communication-recovery.
+    uint32_t lease_update_batch_size_;        ///< Maximum number of DHCPv4 lease updates
+                                              ///< in a lease4-bulk-apply command.
+    uint32_t lease_update_batch_delay_;       ///< Maximum delay before sending a batch (ms).
     uint32_t heartbeat_delay_;                ///< Heartbeat delay in milliseconds.
     uint32_t max_response_delay_;             ///< Max delay in response to heartbeats.
     uint32_t max_ack_delay_;                  ///< Maximum DHCP message ack delay.
@@ -749,6 +854,10 @@ public:
     bool http_dedicated_listener_;            ///< Enable use of own HTTP listener.
     uint32_t http_listener_threads_;          ///< Number of HTTP listener threads.
     uint32_t http_client_threads_;            ///< Number of HTTP client threads.
+    uint32_t http_max_connections_;           ///< Maximum number of connections
+                                              ///< to a partner.
+    uint32_t http_max_pipelined_requests_;    ///< Maximum number of pipelined
+                                              ///< HTTP requests.
     util::Optional<std::string> trust_anchor_; ///< Trust anchor.
     util::Optional<std::string> cert_file_;    ///< Certificate file.
     util::Optional<std::string> key_file_;     ///< Private key file.
@@ -28,6 +28,10 @@ const SimpleDefaults HA_CONFIG_LB_DEFAULTS = {
 const SimpleDefaults HA_CONFIG_DEFAULTS = {
     { "delayed-updates-limit",   Element::integer, "0" },
     { "heartbeat-delay",         Element::integer, "10000" },
+    { "http-max-connections",    Element::integer, "0" },
+    { "http-max-pipelined-requests", Element::integer, "1" },
+    { "lease-update-batch-delay", Element::integer, "5" },
+    { "lease-update-batch-size", Element::integer, "0" },
     { "max-ack-delay",           Element::integer, "10000" },
     { "max-response-delay",      Element::integer, "60000" },
     { "max-unacked-clients",     Element::integer, "10" },
@@ -35,6 +39,7 @@ const SimpleDefaults HA_CONFIG_DEFAULTS = {
     { "sync-leases",             Element::boolean, "true" },
     { "sync-timeout",            Element::integer, "60000" },
     { "sync-page-limit",         Element::integer, "10000" },
+    { "sync-streams",            Element::integer, "1" },
     { "wait-backup-ack",         Element::boolean, "false" }
 };
 
@@ -161,10 +166,22 @@ HAConfigParser::parseInternal(const HAConfigPtr& config_storage,
     uint32_t sync_page_limit = getAndValidateInteger<uint32_t>(c, "sync-page-limit");
     config_storage->setSyncPageLimit(sync_page_limit);
 
+    // Get 'sync-streams'.
+    uint32_t sync_streams = getAndValidateInteger<uint32_t>(c, "sync-streams");
+    config_storage->setSyncStreams(sync_streams);
+
     // Get 'delayed-updates-limit'.
     uint32_t delayed_updates_limit = getAndValidateInteger<uint32_t>(c, "delayed-updates-limit");
     config_storage->setDelayedUpdatesLimit(delayed_updates_limit);
 
+    // Get 'lease-update-batch-size'.
+    uint32_t lease_update_batch_size = getAndValidateInteger<uint32_t>(c, "lease-update-batch-size");
+    config_storage->setLeaseUpdateBatchSize(lease_update_batch_size);
+
+    // Get 'lease-update-batch-delay'.
+    uint32_t lease_update_batch_delay = getAndValidateInteger<uint32_t>(c, "lease-update-batch-delay");
+    config_storage->setLeaseUpdateBatchDelay(lease_update_batch_delay);
+
     // Get 'heartbeat-delay'.
     uint16_t heartbeat_delay = getAndValidateInteger<uint16_t>(c, "heartbeat-delay");
     config_storage->setHeartbeatDelay(heartbeat_delay);
@@ -184,6 +201,15 @@ HAConfigParser::parseInternal(const HAConfigPtr& config_storage,
     // Get 'wait-backup-ack'.
     config_storage->setWaitBackupAck(getBoolean(c, "wait-backup-ack"));
 
+    // Get 'http-max-connections'.
+    uint32_t http_max_connections = getAndValidateInteger<uint32_t>(c, "http-max-connections");
+    config_storage->setHttpMaxConnections(http_max_connections);
+
+    // Get 'http-max-pipelined-requests'.
+    uint32_t http_max_pipelined_requests =
+        getAndValidateInteger<uint32_t>(c, "http-max-pipelined-requests");
+    config_storage->setHttpMaxPipelinedRequests(http_max_pipelined_requests);
+
     // Get multi-threading map.
     ElementPtr mt_config = boost::const_pointer_cast<Element>(c->get("multi-threading"));
     if (!mt_config) {
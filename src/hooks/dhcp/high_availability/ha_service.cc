@@ -15,18 +15,22 @@
 #include <config/timeouts.h>
 #include <dhcp/iface_mgr.h>
 #include <dhcpsrv/cfgmgr.h>
+#include <dhcpsrv/lease_codec.h>
 #include <dhcpsrv/lease_mgr.h>
 #include <dhcpsrv/lease_mgr_factory.h>
 #include <exceptions/exceptions.h>
 #include <http/date_time.h>
 #include <http/response_json.h>
 #include <http/post_request_json.h>
+#include <stats/stats_mgr.h>
 #include <util/multi_threading_mgr.h>
 #include <util/stopwatch.h>
 #include <boost/pointer_cast.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/weak_ptr.hpp>
+#include <algorithm>
 #include <functional>
+#include <map>
 #include <sstream>
 
 using namespace isc::asiolink;
@@ -36,6 +40,7 @@ using namespace isc::dhcp;
 using namespace isc::hooks;
 using namespace isc::http;
 using namespace isc::log;
+using namespace isc::stats;
 using namespace isc::util;
 namespace ph = std::placeholders;
 
@@ -69,7 +74,9 @@ HAService::HAService(const IOServicePtr& io_service, const NetworkStatePtr& netw
       server_type_(server_type), client_(), listener_(), communication_state_(),
       query_filter_(config), mutex_(), pending_requests_(),
       lease_update_backlog_(config->getDelayedUpdatesLimit()),
-      sync_complete_notified_(false) {
+      sync_complete_notified_(false), lease_update_batches_(),
+      lease_update_batch_timer_(), lease_update_batch_timer_armed_(false),
+      lease_update_batches_in_flight_(), lease_update_batch_mutex_() {
 
     if (server_type == HAServerType::DHCPv4) {
         communication_state_.reset(new CommunicationState4(io_service_, config));
@@ -80,6 +87,11 @@ HAService::HAService(const IOServicePtr& io_service, const NetworkStatePtr& netw
 
     network_state_->reset(NetworkState::Origin::HA_COMMAND);
 
+    // The DHCPv4 lease updates can be collected and sent in batches.
+    if ((server_type == HAServerType::DHCPv4) && config_->amBatchingLeaseUpdates()) {
+        lease_update_batch_timer_.reset(new IntervalTimer(*io_service_));
+    }
+
     startModel(HA_WAITING_ST);
 
     // Create the client and(or) listener as appropriate.
@@ -114,12 +126,29 @@ HAService::HAService(const IOServicePtr& io_service, const NetworkStatePtr& netw
         }
     }
 
+    // Apply the connection limits of the client.
+    if (config_->getHttpMaxConnections() > 0) {
+        client_->setMaxUrlConnections(config_->getHttpMaxConnections());
+    }
+    client_->setMaxPipelinedRequests(config_->getHttpMaxPipelinedRequests());
+
+    // Gather the statistics of the TLS handshakes with the partners.
+    client_->setHandshakeStatsHandler(&HAService::clientHandshakeStatsHandler);
+
     LOG_INFO(ha_logger, HA_SERVICE_STARTED)
         .arg(HAConfig::HAModeToString(config->getHAMode()))
         .arg(HAConfig::PeerConfig::roleToString(config->getThisServerConfig()->getRole()));
 }
 
 HAService::~HAService() {
+    // Stop sending the lease update batches. The incomplete batches can't
+    // be sent anymore so the queries waiting for them are dropped rather
+    // than left parked.
+    if (lease_update_batch_timer_) {
+        lease_update_batch_timer_->cancel();
+    }
+    dropLeaseUpdateBatches();
+
     // Stop client and/or listener.
     stopClientAndListener();
 
@@ -1173,16 +1202,23 @@ HAService::asyncSendLeaseUpdates(const dhcp::Pkt4Ptr& query,
             continue;
         }
 
-        // Lease updates for deleted leases.
-        for (auto l = deleted_leases->begin(); l != deleted_leases->end(); ++l) {
-            asyncSendLeaseUpdate(query, conf, CommandCreator::createLease4Delete(**l),
-                                 parking_lot);
-        }
+        if (config_->amBatchingLeaseUpdates()) {
+            // Collect the lease updates of this and other queries and send
+            // them together in a lease4-bulk-apply command.
+            batchLeaseUpdates(query, conf, leases, deleted_leases, parking_lot);
 
-        // Lease updates for new allocations and updated leases.
-        for (auto l = leases->begin(); l != leases->end(); ++l) {
-            asyncSendLeaseUpdate(query, conf, CommandCreator::createLease4Update(**l),
-                                 parking_lot);
+        } else {
+            // Lease updates for deleted leases.
+            for (auto l = deleted_leases->begin(); l != deleted_leases->end(); ++l) {
+                asyncSendLeaseUpdate(query, conf, CommandCreator::createLease4Delete(**l),
+                                     parking_lot);
+            }
+
+            // Lease updates for new allocations and updated leases.
+            for (auto l = leases->begin(); l != leases->end(); ++l) {
+                asyncSendLeaseUpdate(query, conf, CommandCreator::createLease4Update(**l),
+                                     parking_lot);
+            }
         }
 
         // If we're contacting a backup server from which we don't expect a
@@ -1249,7 +1285,9 @@ HAService::asyncSendLeaseUpdates(const dhcp::Pkt6Ptr& query,
         }
 
         // Send new/updated leases and deleted leases in one command.
-        asyncSendLeaseUpdate(query, conf, CommandCreator::createLease6BulkApply(leases, deleted_leases),
+        asyncSendLeaseUpdate(query, conf,
+                             CommandCreator::createLease6BulkApply(leases, deleted_leases,
+                                                                   shouldSendBinaryLeases(conf)),
                              parking_lot);
     }
 
@@ -1397,30 +1435,7 @@ HAService::asyncSendLeaseUpdate(const QueryPtrType& query,
                 communication_state_->setPartnerState("unavailable");
             }
 
-            // It is possible to configure the server to not wait for a response from
-            // the backup server before we unpark the packet and respond to the client.
-            // Here we check if we're dealing with such situation.
-            if (config_->amWaitingBackupAck() || (config->getRole() != HAConfig::PeerConfig::BACKUP)) {
-                // We're expecting a response from the backup server or it is not
-                // a backup server and the lease update was unsuccessful. In such
-                // case the DHCP exchange fails.
-                if (!lease_update_success) {
-                    parking_lot->drop(query);
-                }
-            } else {
-                // This was a response from the backup server and we're configured to
-                // not wait for their acknowledgments, so there is nothing more to do.
-                return;
-            }
-
-            if (leaseUpdateComplete(query, parking_lot)) {
-                // If we have finished sending the lease updates we need to run the
-                // state machine until the state machine finds that additional events
-                // are required, such as next heartbeat or a lease update. The runModel()
-                // may transition to another state, schedule asynchronous tasks etc.
-                // Then it returns control to the DHCP server.
-                runModel(HA_LEASE_UPDATES_COMPLETE_EVT);
-            }
+            leaseUpdateDone(query, config, lease_update_success, parking_lot);
         },
         HttpClient::RequestTimeout(TIMEOUT_DEFAULT_HTTP_CLIENT_REQUEST),
         std::bind(&HAService::clientConnectHandler, this, ph::_1, ph::_2),
@@ -1438,6 +1453,249 @@ HAService::asyncSendLeaseUpdate(const QueryPtrType& query,
     }
 }
 
+template<typename QueryPtrType>
+void
+HAService::leaseUpdateDone(QueryPtrType& query,
+                           const HAConfig::PeerConfigPtr& config,
+                           const bool lease_update_success,
+                           const ParkingLotHandlePtr& parking_lot) {
+    // It is possible to configure the server to not wait for a response from
+    // the backup server before we unpark the packet and respond to the client.
+    // Here we check if we're dealing with such situation.
+    if (config_->amWaitingBackupAck() || (config->getRole() != HAConfig::PeerConfig::BACKUP)) {
+        // We're expecting a response from the backup server or it is not
+        // a backup server and the lease update was unsuccessful. In such
+        // case the DHCP exchange fails.
+        if (!lease_update_success) {
+            parking_lot->drop(query);
+        }
+    } else {
+        // This was a response from the backup server and we're configured to
+        // not wait for their acknowledgments, so there is nothing more to do.
+        return;
+    }
+
+    if (leaseUpdateComplete(query, parking_lot)) {
+        // If we have finished sending the lease updates we need to run the
+        // state machine until the state machine finds that additional events
+        // are required, such as next heartbeat or a lease update. The runModel()
+        // may transition to another state, schedule asynchronous tasks etc.
+        // Then it returns control to the DHCP server.
+        runModel(HA_LEASE_UPDATES_COMPLETE_EVT);
+    }
+}
+
+void
+HAService::batchLeaseUpdates(const Pkt4Ptr& query,
+                             const HAConfig::PeerConfigPtr& config,
+                             const Lease4CollectionPtr& leases,
+                             const Lease4CollectionPtr& deleted_leases,
+                             const ParkingLotHandlePtr& parking_lot) {
+    // The query waits for the response unless the peer is a backup server
+    // from which we don't expect acknowledgments.
+    bool wait_ack = (config_->amWaitingBackupAck() ||
+                     (config->getRole() != HAConfig::PeerConfig::BACKUP));
+    size_t limit = config_->getLeaseUpdateBatchSize();
+
+    // Complete batches are sent after releasing the lock.
+    std::vector<LeaseUpdateBatchPtr> complete;
+    {
+        std::lock_guard<std::mutex> lock(lease_update_batch_mutex_);
+        LeaseUpdateBatchPtr& batch = lease_update_batches_[config->getName()];
+
+        // Remembers if the query waits for the current batch.
+        bool queued = false;
+        auto push = [&](const LeaseUpdateBacklog::OpType op_type, const Lease4Ptr& lease) {
+            if (!batch) {
+                batch.reset(new LeaseUpdateBatch(limit));
+            }
+            if (!batch->updates_.push(op_type, lease)) {
+                // The batch is full: the lease goes to the next one.
+                complete.push_back(batch);
+                batch.reset(new LeaseUpdateBatch(limit));
+                batch->updates_.push(op_type, lease);
+                queued = false;
+            }
+            if (wait_ack && !queued) {
+                batch->queries_.push_back(std::make_pair(query, parking_lot));
+                updatePendingRequest(query);
+                queued = true;
+            }
+        };
+
+        // Lease updates for deleted leases.
+        for (auto l = deleted_leases->begin(); l != deleted_leases->end(); ++l) {
+            push(LeaseUpdateBacklog::DELETE, *l);
+        }
+
+        // Lease updates for new allocations and updated leases.
+        for (auto l = leases->begin(); l != leases->end(); ++l) {
+            push(LeaseUpdateBacklog::ADD, *l);
+        }
+
+        // Without a batch waiting for the response of the peer there are
+        // no other queries whose lease updates could join the batch soon,
+        // so it is sent right away rather than after the delay.
+        size_t& in_flight = lease_update_batches_in_flight_[config->getName()];
+        if (batch && ((batch->updates_.size() >= limit) ||
+                      ((in_flight == 0) && complete.empty()))) {
+            complete.push_back(batch);
+            batch.reset();
+
+        } else if (batch && !lease_update_batch_timer_armed_) {
+            // Make sure the incomplete batches are sent after the delay.
+            lease_update_batch_timer_->setup(std::bind(&HAService::sendLeaseUpdateBatches,
+                                                       this),
+                                             config_->getLeaseUpdateBatchDelay(),
+                                             IntervalTimer::ONE_SHOT);
+            lease_update_batch_timer_armed_ = true;
+        }
+        in_flight += complete.size();
+    }
+
+    for (auto const& batch : complete) {
+        asyncSendLeaseUpdateBatch(config, batch);
+    }
+}
+
+void
+HAService::sendLeaseUpdateBatches() {
+    std::map<std::string, LeaseUpdateBatchPtr> batches;
+    {
+        std::lock_guard<std::mutex> lock(lease_update_batch_mutex_);
+        lease_update_batch_timer_armed_ = false;
+        batches.swap(lease_update_batches_);
+        for (auto const& batch : batches) {
+            if (batch.second && (batch.second->updates_.size() > 0)) {
+                ++lease_update_batches_in_flight_[batch.first];
+            }
+        }
+    }
+
+    for (auto const& batch : batches) {
+        if (batch.second && (batch.second->updates_.size() > 0)) {
+            asyncSendLeaseUpdateBatch(config_->getPeerConfig(batch.first),
+                                      batch.second);
+        }
+    }
+}
+
+void
+HAService::dropLeaseUpdateBatches() {
+    std::map<std::string, LeaseUpdateBatchPtr> batches;
+    {
+        std::lock_guard<std::mutex> lock(lease_update_batch_mutex_);
+        lease_update_batch_timer_armed_ = false;
+        batches.swap(lease_update_batches_);
+    }
+
+    for (auto const& batch : batches) {
+        if (!batch.second) {
+            continue;
+        }
+        for (auto query : batch.second->queries_) {
+            query.second->drop(query.first);
+            leaseUpdateComplete(query.first, query.second);
+        }
+    }
+}
+
+void
+HAService::asyncSendLeaseUpdateBatch(const HAConfig::PeerConfigPtr& config,
+                                     const LeaseUpdateBatchPtr& batch) {
+    // Create HTTP/1.1 request including the lease4-bulk-apply command.
+    // This empties the lease updates of the batch.
+    PostHttpRequestJsonPtr request = boost::make_shared<PostHttpRequestJson>
+        (HttpRequest::Method::HTTP_POST, "/", HttpVersion::HTTP_11(),
+         HostHttpHeader(config->getUrl().getStrippedHostname()));
+    config->addBasicAuthHttpHeader(request);
+    request->setBodyAsJson(CommandCreator::createLease4BulkApply(batch->updates_,
+                                                                shouldSendBinaryLeases(config)));
+    request->finalize();
+
+    // Response object should also be created because the HTTP client needs
+    // to know the type of the expected response.
+    HttpResponseJsonPtr response = boost::make_shared<HttpResponseJson>();
+
+    // The queries are held by the batch until the response is received.
+    std::ostringstream stream;
+    stream << "batch of " << batch->queries_.size() << " queries";
+    std::string label = stream.str();
+
+    // Schedule asynchronous HTTP request.
+    client_->asyncSendRequest(config->getUrl(), config->getTlsContext(),
+                              request, response,
+        [this, batch, config, label]
+            (const boost::system::error_code& ec,
+             const HttpResponsePtr& response,
+             const std::string& error_str) {
+            // The errors are handled as for the lease updates of a single
+            // query but apply to all the queries of the batch.
+            bool lease_update_success = true;
+
+            if (ec || !error_str.empty()) {
+                LOG_WARN(ha_logger, HA_LEASE_UPDATE_COMMUNICATIONS_FAILED)
+                    .arg(label)
+                    .arg(config->getLogLabel())
+                    .arg(ec ? ec.message() : error_str);
+
+                lease_update_success = false;
+
+            } else {
+                try {
+                    int rcode = 0;
+                    auto args = verifyAsyncResponse(response, rcode);
+                    logFailedLeaseUpdates(label, args);
+
+                } catch (const std::exception& ex) {
+                    LOG_WARN(ha_logger, HA_LEASE_UPDATE_FAILED)
+                        .arg(label)
+                        .arg(config->getLogLabel())
+                        .arg(ex.what());
+
+                    lease_update_success = false;
+                }
+            }
+
+            if ((config->getRole() != HAConfig::PeerConfig::BACKUP) && !lease_update_success) {
+                // If we were unable to communicate with the partner we set partner's
+                // state as unavailable.
+                communication_state_->setPartnerState("unavailable");
+            }
+
+            // The lease updates collected while this batch was waiting for
+            // the response are sent now rather than after the delay.
+            LeaseUpdateBatchPtr next;
+            {
+                std::lock_guard<std::mutex> lock(lease_update_batch_mutex_);
+                size_t& in_flight = lease_update_batches_in_flight_[config->getName()];
+                if (in_flight > 0) {
+                    --in_flight;
+                }
+                auto it = lease_update_batches_.find(config->getName());
+                if ((in_flight == 0) && (it != lease_update_batches_.end()) &&
+                    it->second && (it->second->updates_.size() > 0)) {
+                    next = it->second;
+                    it->second.reset();
+                    ++in_flight;
+                }
+            }
+            if (next) {
+                asyncSendLeaseUpdateBatch(config, next);
+            }
+
+            for (auto query : batch->queries_) {
+                leaseUpdateDone(query.first, config, lease_update_success,
+                                query.second);
+            }
+        },
+        HttpClient::RequestTimeout(TIMEOUT_DEFAULT_HTTP_CLIENT_REQUEST),
+        std::bind(&HAService::clientConnectHandler, this, ph::_1, ph::_2),
+        std::bind(&HAService::clientHandshakeHandler, this, ph::_1),
+        std::bind(&HAService::clientCloseHandler, this, ph::_1)
+    );
+}
+
 bool
 HAService::shouldSendLeaseUpdates(const HAConfig::PeerConfigPtr& peer_config) const {
     // Never send lease updates if they are administratively disabled.
@@ -1483,9 +1741,21 @@ HAService::shouldQueueLeaseUpdates(const HAConfig::PeerConfigPtr& peer_config) c
     return (getCurrState() == HA_COMMUNICATION_RECOVERY_ST);
 }
 
+bool
+HAService::shouldSendBinaryLeases(const HAConfig::PeerConfigPtr& peer_config) const {
+    return ((peer_config->getRole() != HAConfig::PeerConfig::BACKUP) &&
+            communication_state_->isPartnerBinaryLeasesSupported());
+}
+
 void
 HAService::logFailedLeaseUpdates(const PktPtr& query,
                                  const ConstElementPtr& args) const {
+    logFailedLeaseUpdates(query->getLabel(), args);
+}
+
+void
+HAService::logFailedLeaseUpdates(const std::string& label,
+                                 const ConstElementPtr& args) const {
     // If there are no arguments, it means that the update was successful.
     if (!args || (args->getType() != Element::map)) {
         return;
@@ -1493,7 +1763,7 @@ HAService::logFailedLeaseUpdates(const PktPtr& query,
 
     // Instead of duplicating the code between the failed-deleted-leases and
     // failed-leases, let's just have one function that does it for both.
-    auto log_proc = [](const PktPtr query, const ConstElementPtr& args,
+    auto log_proc = [](const std::string& label, const ConstElementPtr& args,
                        const std::string& param_name, const log::MessageID& mesid) {
 
         // Check if there are any failed leases.
@@ -1516,7 +1786,7 @@ HAService::logFailedLeaseUpdates(const PktPtr& query,
                     auto error_message = lease->get("error-message");
 
                     LOG_INFO(ha_logger, mesid)
-                        .arg(query->getLabel())
+                        .arg(label)
                         .arg(lease_type && (lease_type->getType() == Element::string) ?
                              lease_type->stringValue() : "(unknown)")
                         .arg(ip_address && (ip_address->getType() == Element::string) ?
@@ -1529,10 +1799,10 @@ HAService::logFailedLeaseUpdates(const PktPtr& query,
     };
 
     // Process "failed-deleted-leases"
-    log_proc(query, args, "failed-deleted-leases", HA_LEASE_UPDATE_DELETE_FAILED_ON_PEER);
+    log_proc(label, args, "failed-deleted-leases", HA_LEASE_UPDATE_DELETE_FAILED_ON_PEER);
 
     // Process "failed-leases".
-    log_proc(query, args, "failed-leases", HA_LEASE_UPDATE_CREATE_UPDATE_FAILED_ON_PEER);
+    log_proc(label, args, "failed-leases", HA_LEASE_UPDATE_CREATE_UPDATE_FAILED_ON_PEER);
 }
 
 ConstElementPtr
@@ -1559,6 +1829,9 @@ HAService::processStatusGet() const {
         list->add(Element::create(scope));
     }
     local->set("scopes", list);
+    if (sync_progress_.isStarted()) {
+        local->set("sync-progress", sync_progress_.toElement());
+    }
     ha_servers->set("local", local);
 
     // Do not include remote server information if this is a backup server or
@@ -1603,6 +1876,11 @@ HAService::processHeartbeat() {
     arguments->set("unsent-update-count",
                    Element::create(static_cast<int64_t>(communication_state_->getUnsentUpdateCount())));
 
+    // Advertise the compact binary encoding of the leases to the partner.
+    ElementPtr encodings = Element::createList();
+    encodings->add(Element::create(LeaseCodec::NAME));
+    arguments->set("lease-encodings", encodings);
+
     return (createAnswer(CONTROL_RESULT_SUCCESS, "HA peer status returned.",
                          arguments));
 }
@@ -1725,6 +2003,20 @@ HAService::asyncSendHeartbeat() {
                                                                           (unsent_update_count->intValue()));
                     }
 
+                    // lease-encodings is not present in earlier HA versions. The
+                    // partner accepts the leases in JSON only in this case.
+                    bool binary_leases = false;
+                    auto encodings = args->get("lease-encodings");
+                    if (encodings && (encodings->getType() == Element::list)) {
+                        for (auto const& encoding : encodings->listValue()) {
+                            if ((encoding->getType() == Element::string) &&
+                                (encoding->stringValue() == LeaseCodec::NAME)) {
+                                binary_leases = true;
+                            }
+                        }
+                    }
+                    communication_state_->setPartnerBinaryLeasesSupported(binary_leases);
+
                 } catch (const std::exception& ex) {
                     LOG_WARN(ha_logger, HA_HEARTBEAT_FAILED)
                         .arg(partner_config->getLogLabel())
@@ -1966,24 +2258,68 @@ HAService::asyncSyncLeases() {
     }
 
     asyncSyncLeases(*client_, config_->getFailoverPeerConfig()->getName(),
-                    dhcp_disable_timeout, LeasePtr(), null_action);
+                    dhcp_disable_timeout, null_action);
 }
 
 void
 HAService::asyncSyncLeases(http::HttpClient& http_client,
                            const std::string& server_name,
                            const unsigned int max_period,
-                           const dhcp::LeasePtr& last_lease,
-                           PostSyncCallback post_sync_action,
-                           const bool dhcp_disabled) {
+                           PostSyncCallback post_sync_action) {
+    LeaseSyncRanges ranges = createSyncRanges(http_client);
+    if (ranges.size() > 1) {
+        LOG_INFO(ha_logger, HA_SYNC_STREAMS)
+            .arg(server_name)
+            .arg(ranges.size());
+    }
+    sync_progress_.start(ranges.size());
+
+    // Each range is fetched by its own stream of commands. The post
+    // synchronization action is invoked when the last stream completes.
+    for (auto const& range : ranges) {
+        asyncSyncLeasesRange(http_client, server_name, max_period, range, LeasePtr(),
+                             [this, post_sync_action]
+                             (const bool success, const std::string& error_message,
+                              const bool dhcp_disabled) {
+            if (sync_progress_.streamCompleted(success, error_message, dhcp_disabled) &&
+                post_sync_action) {
+                post_sync_action(!sync_progress_.hasFailed(),
+                                 sync_progress_.getErrorMessage(),
+                                 sync_progress_.isDHCPDisabled());
+            }
+        });
+    }
+}
+
+LeaseSyncRanges
+HAService::createSyncRanges(const HttpClient& http_client) const {
+    // Only the multi-threaded client sends the requests in parallel.
+    size_t streams = std::min(static_cast<size_t>(config_->getSyncStreams()),
+                              static_cast<size_t>(http_client.getThreadPoolSize()));
+    if (server_type_ == HAServerType::DHCPv4) {
+        return (createLeaseSyncRanges4(CfgMgr::instance().getCurrentCfg()->
+                                       getCfgSubnets4(), streams));
+    }
+    return (createLeaseSyncRanges6(CfgMgr::instance().getCurrentCfg()->
+                                   getCfgSubnets6(), streams));
+}
+
+void
+HAService::asyncSyncLeasesRange(http::HttpClient& http_client,
+                                const std::string& server_name,
+                                const unsigned int max_period,
+                                const LeaseSyncRange& range,
+                                const dhcp::LeasePtr& last_lease,
+                                PostSyncCallback post_sync_action,
+                                const bool dhcp_disabled) {
     // Synchronization starts with a command to disable DHCP service of the
     // peer from which we're fetching leases. We don't want the other server
     // to allocate new leases while we fetch from it. The DHCP service will
     // be disabled for a certain amount of time and will be automatically
     // re-enabled if we die during the synchronization.
     asyncDisableDHCPService(http_client, server_name, max_period,
-                            [this, &http_client, server_name, max_period, last_lease,
-                             post_sync_action, dhcp_disabled]
+                            [this, &http_client, server_name, max_period, range,
+                             last_lease, post_sync_action, dhcp_disabled]
                             (const bool success, const std::string& error_message, const int) {
 
         // If we have successfully disabled the DHCP service on the peer,
@@ -1992,7 +2328,7 @@ HAService::asyncSyncLeases(http::HttpClient& http_client,
             // The last argument indicates that disabling the DHCP
             // service on the partner server was successful.
             asyncSyncLeasesInternal(http_client, server_name, max_period,
-                                    last_lease, post_sync_action, true);
+                                    range, last_lease, post_sync_action, true);
 
         } else {
             post_sync_action(success, error_message, dhcp_disabled);
@@ -2000,28 +2336,255 @@ HAService::asyncSyncLeases(http::HttpClient& http_client,
     });
 }
 
+namespace {
+
+/// @brief Updates IPv4 leases in the lease database.
+///
+/// @param leases The leases to be updated.
+/// @return The leases which do not exist.
+Lease4Collection
+updateLeases(const Lease4Collection& leases) {
+    return (LeaseMgrFactory::instance().updateLeases4(leases));
+}
+
+/// @brief Updates IPv6 leases in the lease database.
+///
+/// @param leases The leases to be updated.
+/// @return The leases which do not exist.
+Lease6Collection
+updateLeases(const Lease6Collection& leases) {
+    return (LeaseMgrFactory::instance().updateLeases6(leases));
+}
+
+/// @brief Updates an IPv4 lease in the lease database.
+///
+/// @param lease The lease to be updated.
+void
+updateLease(const Lease4Ptr& lease) {
+    LeaseMgrFactory::instance().updateLease4(lease);
+}
+
+/// @brief Updates an IPv6 lease in the lease database.
+///
+/// @param lease The lease to be updated.
+void
+updateLease(const Lease6Ptr& lease) {
+    LeaseMgrFactory::instance().updateLease6(lease);
+}
+
+/// @brief Returns the IPv4 lease in the lease database for a fetched lease.
+///
+/// @param lease The fetched lease.
+/// @return The lease in the database or null.
+Lease4Ptr
+getExistingLease(const Lease4Ptr& lease) {
+    return (LeaseMgrFactory::instance().getLease4(lease->addr_));
+}
+
+/// @brief Returns the IPv6 lease in the lease database for a fetched lease.
+///
+/// @param lease The fetched lease.
+/// @return The lease in the database or null.
+Lease6Ptr
+getExistingLease(const Lease6Ptr& lease) {
+    return (LeaseMgrFactory::instance().getLease6(lease->type_, lease->addr_));
+}
+
+/// @brief Writes the leases of a page fetched from the partner.
+///
+/// The fetched leases which do not exist in the lease database are added
+/// and the leases which are older in the database are updated. The leases
+/// are added and updated in batches. When a batch fails the leases it did
+/// not handle are written one at a time so a failing lease does not prevent
+/// the others from being written.
+///
+/// @param leases The leases of the page.
+/// @param stale_skip_msg The message logged for a skipped stale lease.
+/// @tparam LeaseCollectionType One of the @c Lease4Collection or
+/// @c Lease6Collection.
+template<typename LeaseCollectionType>
+void
+writeSyncedLeases(const LeaseCollectionType& leases,
+                  const MessageID& stale_skip_msg) {
+    typedef typename LeaseCollectionType::value_type LeasePtrType;
+
+    auto log_failure = [](const LeasePtrType& lease, const std::string& error) {
+        LOG_WARN(ha_logger, HA_LEASE_SYNC_FAILED)
+            .arg(lease->toElement()->str())
+            .arg(error);
+    };
+
+    LeaseCollectionType added;
+    LeaseCollectionType updated;
+    for (auto const& lease : leases) {
+        try {
+            // Check if there is such lease in the database already.
+            LeasePtrType existing_lease = getExistingLease(lease);
+            if (!existing_lease) {
+                // There is no such lease, so let's add it.
+                added.push_back(lease);
+
+            } else if (existing_lease->cltt_ < lease->cltt_) {
+                // If the existing lease is older than the fetched lease, update
+                // the lease in our local database.
+                // Update lease current expiration time with value received from the
+                // database. Some database backends reject operations on the lease if
+                // the current expiration time value does not match what is stored.
+                Lease::syncCurrentExpirationTime(*existing_lease, *lease);
+                updated.push_back(lease);
+
+            } else {
+                LOG_DEBUG(ha_logger, DBGLVL_TRACE_BASIC, stale_skip_msg)
+                    .arg(lease->addr_.toText())
+                    .arg(lease->subnet_id_);
+            }
+
+        } catch (const std::exception& ex) {
+            log_failure(lease, ex.what());
+        }
+    }
+
+    // When a batch fails the leases which were not handled are written
+    // one by one, so each of them gets its own error.
+    LeaseMgr& lease_mgr = LeaseMgrFactory::instance();
+    size_t processed = added.size();
+    try {
+        // The leases which already exist were added after the page was
+        // received: they are left unchanged.
+        static_cast<void>(lease_mgr.addLeases(added));
+
+    } catch (const LeaseBatchError& ex) {
+        processed = ex.getProcessed();
+
+    } catch (const std::exception&) {
+        processed = 0;
+    }
+    for (auto lease = added.begin() + processed; lease != added.end(); ++lease) {
+        try {
+            lease_mgr.addLease(*lease);
+        } catch (const std::exception& ex) {
+            log_failure(*lease, ex.what());
+        }
+    }
+
+    processed = updated.size();
+    LeaseCollectionType missing;
+    try {
+        missing = updateLeases(updated);
+
+    } catch (const LeaseBatchError& ex) {
+        processed = ex.getProcessed();
+        for (auto const& lease : ex.getRejected()) {
+            missing.push_back(boost::dynamic_pointer_cast<
+                              typename LeasePtrType::element_type>(lease));
+        }
+
+    } catch (const std::exception&) {
+        processed = 0;
+    }
+    for (auto const& lease : missing) {
+        log_failure(lease, "unable to update lease for address " +
+                    lease->addr_.toText() + " as it does not exist");
+    }
+    for (auto lease = updated.begin() + processed; lease != updated.end();
+         ++lease) {
+        try {
+            updateLease(*lease);
+        } catch (const std::exception& ex) {
+            log_failure(*lease, ex.what());
+        }
+    }
+}
+
+/// @brief Converts the JSON leases of a page fetched from the partner.
+///
+/// The malformed leases are logged and skipped.
+///
+/// @param leases The list of leases in JSON.
+/// @param [out] parsed The parsed leases.
+/// @tparam LeaseType One of the @c Lease4 or @c Lease6.
+template<typename LeaseType>
+void
+parseSyncedLeases(const ConstElementPtr& leases,
+                  std::vector<boost::shared_ptr<LeaseType> >& parsed) {
+    for (auto const& l : leases->listValue()) {
+        try {
+            parsed.push_back(LeaseType::fromElement(l));
+
+        } catch (const std::exception& ex) {
+            LOG_WARN(ha_logger, HA_LEASE_SYNC_FAILED)
+                .arg(l->str())
+                .arg(ex.what());
+        }
+    }
+}
+
+/// @brief Removes the leases beyond the end of a synchronization range.
+///
+/// These leases are fetched by the stream of the next range.
+///
+/// @param range The synchronization range.
+/// @param [out] leases The leases of a page sorted by address.
+/// @tparam LeaseCollectionType One of the @c Lease4Collection or
+/// @c Lease6Collection.
+/// @return true if any lease was removed.
+template<typename LeaseCollectionType>
+bool
+trimSyncedLeases(const LeaseSyncRange& range, LeaseCollectionType& leases) {
+    auto beyond = std::find_if(leases.begin(), leases.end(),
+                               [&range](const typename LeaseCollectionType::value_type& lease) {
+        return (range.to_ < lease->addr_);
+    });
+    if (beyond == leases.end()) {
+        return (false);
+    }
+    leases.erase(beyond, leases.end());
+    return (true);
+}
+
+} // end of anonymous namespace
+
 void
 HAService::asyncSyncLeasesInternal(http::HttpClient& http_client,
                                    const std::string& server_name,
                                    const unsigned int max_period,
+                                   const LeaseSyncRange& range,
                                    const dhcp::LeasePtr& last_lease,
                                    PostSyncCallback post_sync_action,
                                    const bool dhcp_disabled) {
 
     HAConfig::PeerConfigPtr partner_config = config_->getFailoverPeerConfig();
 
+    // The first page of a range other than the first one starts after the
+    // beginning of the range.
+    LeasePtr from_lease = last_lease;
+    if (!from_lease && !range.from_.isV4Zero() && !range.from_.isV6Zero()) {
+        if (server_type_ == HAServerType::DHCPv4) {
+            from_lease.reset(new Lease4());
+        } else {
+            from_lease.reset(new Lease6());
+        }
+        from_lease->addr_ = range.from_;
+    }
+
     // Create HTTP/1.1 request including our command.
     PostHttpRequestJsonPtr request = boost::make_shared<PostHttpRequestJson>
         (HttpRequest::Method::HTTP_POST, "/", HttpVersion::HTTP_11(),
          HostHttpHeader(partner_config->getUrl().getStrippedHostname()));
     partner_config->addBasicAuthHttpHeader(request);
+
+    // Ask for the leases in the compact binary encoding only when the
+    // partner advertised it: earlier versions reject the parameter.
+    bool binary = communication_state_->isPartnerBinaryLeasesSupported();
     if (server_type_ == HAServerType::DHCPv4) {
         request->setBodyAsJson(CommandCreator::createLease4GetPage(
-            boost::dynamic_pointer_cast<Lease4>(last_lease), config_->getSyncPageLimit()));
+            boost::dynamic_pointer_cast<Lease4>(from_lease), config_->getSyncPageLimit(),
+            binary));
 
     } else {
         request->setBodyAsJson(CommandCreator::createLease6GetPage(
-            boost::dynamic_pointer_cast<Lease6>(last_lease), config_->getSyncPageLimit()));
+            boost::dynamic_pointer_cast<Lease6>(from_lease), config_->getSyncPageLimit(),
+            binary));
     }
     request->finalize();
 
@@ -2034,7 +2597,7 @@ HAService::asyncSyncLeasesInternal(http::HttpClient& http_client,
                                  partner_config->getTlsContext(),
                                  request, response,
         [this, partner_config, post_sync_action, &http_client, server_name,
-         max_period, dhcp_disabled]
+         max_period, range, dhcp_disabled]
             (const boost::system::error_code& ec,
              const HttpResponsePtr& response,
              const std::string& error_str) {
@@ -2070,96 +2633,70 @@ HAService::asyncSyncLeasesInternal(http::HttpClient& http_client,
                                   "arguments in the received response must be a map");
                     }
 
+                    // The partner returns the leases in the compact binary
+                    // encoding when it supports it, in JSON otherwise.
+                    ConstElementPtr leases_binary = args->get("leases-binary");
                     ConstElementPtr leases = args->get("leases");
-                    if (!leases || (leases->getType() != Element::list)) {
+                    if (leases_binary) {
+                        if (leases_binary->getType() != Element::string) {
+                            isc_throw(CtrlChannelError, "leases-binary argument in the"
+                                      " server response is not a string");
+                        }
+
+                    } else if (!leases || (leases->getType() != Element::list)) {
                         isc_throw(CtrlChannelError,
                                   "server response does not contain leases argument or this"
                                   " argument is not a list");
                     }
 
-                    // Iterate over the leases and update the database as appropriate.
-                    const auto& leases_element = leases->listValue();
+                    Lease4Collection leases4;
+                    Lease6Collection leases6;
+                    size_t received = 0;
+                    if (server_type_ == HAServerType::DHCPv4) {
+                        if (leases_binary) {
+                            leases4 = LeaseCodec::decodeText4(leases_binary->stringValue());
+                            received = leases4.size();
+                        } else {
+                            parseSyncedLeases(leases, leases4);
+                            received = leases->size();
+                        }
+
+                    } else {
+                        if (leases_binary) {
+                            leases6 = LeaseCodec::decodeText6(leases_binary->stringValue());
+                            received = leases6.size();
+                        } else {
+                            parseSyncedLeases(leases, leases6);
+                            received = leases->size();
+                        }
+                    }
 
                     LOG_INFO(ha_logger, HA_LEASES_SYNC_LEASE_PAGE_RECEIVED)
-                        .arg(leases_element.size())
+                        .arg(received)
                         .arg(server_name);
 
-                    for (auto l = leases_element.begin(); l != leases_element.end(); ++l) {
-                        try {
-
-                            if (server_type_ == HAServerType::DHCPv4) {
-                                Lease4Ptr lease = Lease4::fromElement(*l);
-
-                                // Check if there is such lease in the database already.
-                                Lease4Ptr existing_lease = LeaseMgrFactory::instance().getLease4(lease->addr_);
-                                if (!existing_lease) {
-                                    // There is no such lease, so let's add it.
-                                    LeaseMgrFactory::instance().addLease(lease);
-
-                                } else if (existing_lease->cltt_ < lease->cltt_) {
-                                    // If the existing lease is older than the fetched lease, update
-                                    // the lease in our local database.
-                                    // Update lease current expiration time with value received from the
-                                    // database. Some database backends reject operations on the lease if
-                                    // the current expiration time value does not match what is stored.
-                                    Lease::syncCurrentExpirationTime(*existing_lease, *lease);
-                                    LeaseMgrFactory::instance().updateLease4(lease);
-
-                                } else {
-                                    LOG_DEBUG(ha_logger, DBGLVL_TRACE_BASIC, HA_LEASE_SYNC_STALE_LEASE4_SKIP)
-                                        .arg(lease->addr_.toText())
-                                        .arg(lease->subnet_id_);
-                                }
-
-                                // If we're not on the last page and we're processing final lease on
-                                // this page, let's record the lease as input to the next
-                                // lease4-get-page command.
-                                if ((leases_element.size() >= config_->getSyncPageLimit()) &&
-                                    (l + 1 == leases_element.end())) {
-                                    last_lease = boost::dynamic_pointer_cast<Lease>(lease);
-                                }
-
-                            } else {
-                                Lease6Ptr lease = Lease6::fromElement(*l);
-
-                                // Check if there is such lease in the database already.
-                                Lease6Ptr existing_lease = LeaseMgrFactory::instance().getLease6(lease->type_,
-                                                                                                 lease->addr_);
-                                if (!existing_lease) {
-                                    // There is no such lease, so let's add it.
-                                    LeaseMgrFactory::instance().addLease(lease);
-
-                                } else if (existing_lease->cltt_ < lease->cltt_) {
-                                    // If the existing lease is older than the fetched lease, update
-                                    // the lease in our local database.
-                                    // Update lease current expiration time with value received from the
-                                    // database. Some database backends reject operations on the lease if
-                                    // the current expiration time value does not match what is stored.
-                                    Lease::syncCurrentExpirationTime(*existing_lease, *lease);
-                                    LeaseMgrFactory::instance().updateLease6(lease);
-
-                                } else {
-                                    LOG_DEBUG(ha_logger, DBGLVL_TRACE_BASIC, HA_LEASE_SYNC_STALE_LEASE6_SKIP)
-                                        .arg(lease->addr_.toText())
-                                        .arg(lease->subnet_id_);
-                                }
-
-                                // If we're not on the last page and we're processing final lease on
-                                // this page, let's record the lease as input to the next
-                                // lease6-get-page command.
-                                if ((leases_element.size() >= config_->getSyncPageLimit()) &&
-                                    (l + 1 == leases_element.end())) {
-                                    last_lease = boost::dynamic_pointer_cast<Lease>(lease);
-                                }
-                            }
-
-                        } catch (const std::exception& ex) {
-                            LOG_WARN(ha_logger, HA_LEASE_SYNC_FAILED)
-                                .arg((*l)->str())
-                                .arg(ex.what());
+                    // The leases beyond the range belong to the next stream.
+                    bool range_end = (trimSyncedLeases(range, leases4) ||
+                                      trimSyncedLeases(range, leases6));
+                    sync_progress_.pageReceived(leases4.size() + leases6.size());
+
+                    // If we're not on the last page of the range, let's record
+                    // the final lease of this page as input to the next
+                    // leaseX-get-page command.
+                    if (!range_end && (received >= config_->getSyncPageLimit())) {
+                        if (!leases4.empty()) {
+                            last_lease = leases4.back();
+                        } else if (!leases6.empty()) {
+                            last_lease = leases6.back();
+                        }
+                        if (last_lease && !(last_lease->addr_ < range.to_)) {
+                            last_lease.reset();
                         }
                     }
 
+                    writeSyncedLeases(leases4, HA_LEASE_SYNC_STALE_LEASE4_SKIP);
+                    writeSyncedLeases(leases6, HA_LEASE_SYNC_STALE_LEASE6_SKIP);
+
                 } catch (const std::exception& ex) {
                     error_message = ex.what();
                     LOG_ERROR(ha_logger, HA_LEASES_SYNC_FAILED)
@@ -2173,11 +2710,12 @@ HAService::asyncSyncLeasesInternal(http::HttpClient& http_client,
              if (!error_message.empty()) {
                  communication_state_->setPartnerState("unavailable");
 
-             } else if (last_lease) {
+             } else if (last_lease && !sync_progress_.hasFailed()) {
                  // This indicates that there are more leases to be fetched.
                  // Therefore, we have to send another leaseX-get-page command.
-                 asyncSyncLeases(http_client, server_name, max_period, last_lease,
-                                 post_sync_action, dhcp_disabled);
+                 // The stream stops when another stream has failed.
+                 asyncSyncLeasesRange(http_client, server_name, max_period, range,
+                                      last_lease, post_sync_action, dhcp_disabled);
                  return;
              }
 
@@ -2201,16 +2739,23 @@ HAService::processSynchronize(const std::string& server_name,
                               const unsigned int max_period) {
     std::string answer_message;
     int sync_status = synchronize(answer_message, server_name, max_period);
-    return (createAnswer(sync_status, answer_message));
+    return (createAnswer(sync_status, answer_message, sync_progress_.toElement()));
 }
 
 int
 HAService::synchronize(std::string& status_message, const std::string& server_name,
                        const unsigned int max_period) {
     IOService io_service;
-    HttpClient client(io_service);
 
-    asyncSyncLeases(client, server_name, max_period, Lease4Ptr(),
+    // The leases are fetched in parallel streams by a multi-threaded
+    // client with a connection per stream.
+    size_t threads = 0;
+    if (config_->getEnableMultiThreading() && (config_->getSyncStreams() > 1)) {
+        threads = config_->getSyncStreams();
+    }
+    HttpClient client(io_service, threads);
+
+    asyncSyncLeases(client, server_name, max_period,
                     [&](const bool success, const std::string& error_message,
                         const bool dhcp_disabled) {
         // If there was a fatal error while fetching the leases, let's
@@ -2304,6 +2849,11 @@ HAService::synchronize(std::string& status_message, const std::string& server_na
     // End measuring duration.
     stopwatch.stop();
 
+    // Stop the threads of the multi-threaded client.
+    if (threads > 0) {
+        client.stop();
+    }
+
     // If an error message has been recorded, return an error to the controlling
     // client.
     if (!status_message.empty()) {
@@ -2338,9 +2888,21 @@ HAService::asyncSendLeaseUpdatesFromBacklog(HttpClient& http_client,
     }
 
     ConstElementPtr command;
-    if (server_type_ == HAServerType::DHCPv4) {
+    if ((server_type_ == HAServerType::DHCPv4) && config_->amBatchingLeaseUpdates()) {
+        // The partner is expected to support lease4-bulk-apply. The backlog
+        // is sent in chunks of the batch size.
+        command = CommandCreator::createLease4BulkApply(lease_update_backlog_,
+                                                        shouldSendBinaryLeases(config),
+                                                        config_->getLeaseUpdateBatchSize());
+
+    } else if (server_type_ == HAServerType::DHCPv4) {
         LeaseUpdateBacklog::OpType op_type;
         Lease4Ptr lease = boost::dynamic_pointer_cast<Lease4>(lease_update_backlog_.pop(op_type));
+        // The remaining updates may have been skipped as invalid.
+        if (!lease) {
+            post_request_action(true, "", CONTROL_RESULT_SUCCESS);
+            return;
+        }
         if (op_type == LeaseUpdateBacklog::ADD) {
             command = CommandCreator::createLease4Update(*lease);
         } else {
@@ -2348,7 +2910,8 @@ HAService::asyncSendLeaseUpdatesFromBacklog(HttpClient& http_client,
         }
 
     } else {
-        command = CommandCreator::createLease6BulkApply(lease_update_backlog_);
+        command = CommandCreator::createLease6BulkApply(lease_update_backlog_,
+                                                        shouldSendBinaryLeases(config));
     }
 
     // Create HTTP/1.1 request including our command.
@@ -2395,7 +2958,8 @@ HAService::asyncSendLeaseUpdatesFromBacklog(HttpClient& http_client,
              // error occurs. In DHCPv6, this is a single iteration because we use
              // lease6-bulk-apply, which combines many lease updates in a single
              // transaction. In the case of DHCPv4, each update is sent in its own
-             // transaction.
+             // transaction, or each chunk of the batch size when the lease
+             // updates are batched.
              if (error_message.empty()) {
                  asyncSendLeaseUpdatesFromBacklog(http_client, config, post_request_action);
              } else {
@@ -2983,6 +3547,24 @@ HAService::clientConnectHandler(const boost::system::error_code& ec, int tcp_nat
     return (true);
 }
 
+void
+HAService::clientHandshakeStatsHandler(const Url&,
+                                       const boost::system::error_code& ec,
+                                       const bool resumed,
+                                       const std::chrono::steady_clock::duration& duration) {
+    StatsMgr& stats_mgr = StatsMgr::instance();
+    if (ec) {
+        stats_mgr.addValue("ha-tls-handshake-failures", static_cast<int64_t>(1));
+        return;
+    }
+    stats_mgr.addValue("ha-tls-handshakes", static_cast<int64_t>(1));
+    if (resumed) {
+        stats_mgr.addValue("ha-tls-handshakes-resumed", static_cast<int64_t>(1));
+    }
+    stats_mgr.recordValue("ha-tls-handshake-latency",
+                          std::chrono::duration_cast<StatsDuration>(duration));
+}
+
 void
 HAService::socketReadyHandler(int tcp_native_fd) {
     // If the socket is ready but does not belong to one of our client's
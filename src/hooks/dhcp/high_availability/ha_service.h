@@ -1,4 +1,4 @@
-// Copyright (C) 2018-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2018-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -10,9 +10,11 @@
 #include <communication_state.h>
 #include <ha_config.h>
 #include <ha_server_type.h>
+#include <lease_sync.h>
 #include <lease_update_backlog.h>
 #include <query_filter.h>
 #include <asiolink/asio_wrapper.h>
+#include <asiolink/interval_timer.h>
 #include <asiolink/io_service.h>
 #include <asiolink/tls_socket.h>
 #include <cc/data.h>
@@ -110,7 +112,8 @@ public:
 
     /// @brief Destructor.
     ///
-    /// Stops the client and listener (if one). It clears the DHCP
+    /// Drops the queries waiting for the incomplete batches of lease
+    /// updates. Stops the client and listener (if one). It clears the DHCP
     /// state using origin HA internal command.
     virtual ~HAService();
 
@@ -588,6 +591,90 @@ protected:
                               const data::ConstElementPtr& command,
                               const hooks::ParkingLotHandlePtr& parking_lot);
 
+    /// @brief DHCPv4 lease updates collected for a peer.
+    ///
+    /// The lease updates of several queries are sent together in a
+    /// lease4-bulk-apply command. The queries waiting for the response
+    /// are unparked or dropped when the response is received.
+    struct LeaseUpdateBatch {
+        /// @brief Constructor.
+        ///
+        /// @param limit maximum number of lease updates in the batch.
+        explicit LeaseUpdateBatch(const size_t limit)
+            : updates_(limit), queries_() {
+        }
+
+        /// @brief Lease updates, coalesced by lease.
+        LeaseUpdateBacklog updates_;
+
+        /// @brief Queries waiting for the response and their parking lots.
+        std::vector<std::pair<dhcp::Pkt4Ptr, hooks::ParkingLotHandlePtr> > queries_;
+    };
+
+    /// @brief Pointer to a batch of DHCPv4 lease updates.
+    typedef boost::shared_ptr<LeaseUpdateBatch> LeaseUpdateBatchPtr;
+
+    /// @brief Adds DHCPv4 lease updates to the batch of the peer.
+    ///
+    /// The batch is sent when it reaches the configured size, or right away
+    /// when no batch sent to the peer is waiting for its response, so a
+    /// query is not delayed when the server is idle. Otherwise the batch
+    /// collects the lease updates of the following queries and is sent
+    /// when the pending batch is answered or, at the latest, by
+    /// @c sendLeaseUpdateBatches after the configured delay. The query is
+    /// added to the batch (or batches) holding its lease updates and waits
+    /// for the response unless the peer is a backup server which is not
+    /// expected to acknowledge the updates.
+    ///
+    /// @param query Pointer to the DHCP client's query.
+    /// @param config Pointer to the configuration of the peer.
+    /// @param leases Pointer to a collection of the newly allocated or
+    /// updated leases.
+    /// @param deleted_leases Pointer to a collection of the released leases.
+    /// @param [out] parking_lot Parking lot where the query is parked.
+    void batchLeaseUpdates(const dhcp::Pkt4Ptr& query,
+                           const HAConfig::PeerConfigPtr& config,
+                           const dhcp::Lease4CollectionPtr& leases,
+                           const dhcp::Lease4CollectionPtr& deleted_leases,
+                           const hooks::ParkingLotHandlePtr& parking_lot);
+
+    /// @brief Sends all incomplete batches of DHCPv4 lease updates.
+    ///
+    /// This is the callback of the batch timer.
+    void sendLeaseUpdateBatches();
+
+    /// @brief Drops the queries waiting for the incomplete batches of
+    /// DHCPv4 lease updates and discards the batches.
+    ///
+    /// This is called when the service is destroyed, so the queries are
+    /// not left parked.
+    void dropLeaseUpdateBatches();
+
+    /// @brief Asynchronously sends a batch of DHCPv4 lease updates to
+    /// the peer in a lease4-bulk-apply command.
+    ///
+    /// @param config Pointer to the configuration of the peer.
+    /// @param batch Pointer to the batch. Its lease updates are removed.
+    void asyncSendLeaseUpdateBatch(const HAConfig::PeerConfigPtr& config,
+                                   const LeaseUpdateBatchPtr& batch);
+
+    /// @brief Handles the result of the lease updates sent for a query.
+    ///
+    /// Drops the query when the update failed and the response was
+    /// expected, then unparks it when all lease updates are complete.
+    ///
+    /// @tparam QueryPtrType Type of the pointer to the DHCP client's message,
+    /// i.e. Pkt4Ptr or Pkt6Ptr.
+    /// @param query Pointer to the DHCP client's query.
+    /// @param config Pointer to the configuration of the peer.
+    /// @param lease_update_success true if the lease updates succeeded.
+    /// @param [out] parking_lot Parking lot where the query is parked.
+    template<typename QueryPtrType>
+    void leaseUpdateDone(QueryPtrType& query,
+                         const HAConfig::PeerConfigPtr& config,
+                         const bool lease_update_success,
+                         const hooks::ParkingLotHandlePtr& parking_lot);
+
     /// @brief Log failed lease updates.
     ///
     /// Logs failed lease updates included in the "failed-deleted-leases"
@@ -600,6 +687,18 @@ protected:
     void logFailedLeaseUpdates(const dhcp::PktPtr& query,
                                const data::ConstElementPtr& args) const;
 
+    /// @brief Log failed lease updates.
+    ///
+    /// Logs failed lease updates included in the "failed-deleted-leases"
+    /// and/or "failed-leases" carried in the response to the
+    /// @c lease4-bulk-apply or @c lease6-bulk-apply command.
+    ///
+    /// @param label Label of the query or batch of queries.
+    /// @param args Arguments of the response. It may be null, in which
+    /// case the function simply returns.
+    void logFailedLeaseUpdates(const std::string& label,
+                               const data::ConstElementPtr& args) const;
+
     /// @brief Checks if the lease updates should be sent as result of leases
     /// allocation or release.
     ///
@@ -625,6 +724,20 @@ protected:
     /// @return true if the server should queue lease updates, false otherwise.
     bool shouldQueueLeaseUpdates(const HAConfig::PeerConfigPtr& peer_config) const;
 
+    /// @brief Checks if the leases should be sent in the compact binary
+    /// encoding.
+    ///
+    /// The backup servers do not send heartbeats, so the leases are sent
+    /// to them in JSON. The partner receives the leases in the binary
+    /// encoding when it advertised this encoding in the response to the
+    /// last heartbeat.
+    ///
+    /// @param peer_config pointer to the configuration of the peer to which
+    /// the leases are to be sent.
+    /// @return true if the leases should be sent in the binary encoding,
+    /// false otherwise.
+    bool shouldSendBinaryLeases(const HAConfig::PeerConfigPtr& peer_config) const;
+
 public:
 
     /// @brief Processes ha-heartbeat command and returns a response.
@@ -656,7 +769,9 @@ public:
     /// @brief Processes status-get command and returns a response.
     ///
     /// @c HAImpl::commandProcessed calls this to add information about the
-    /// HA servers status into the status-get response.
+    /// HA servers status into the status-get response. The local server
+    /// part includes the progress of the last lease database
+    /// synchronization under the "sync-progress" key, if any.
     data::ConstElementPtr processStatusGet() const;
 
     /// @brief Processes ha-reset command and returns a response.
@@ -743,14 +858,59 @@ protected:
     /// @brief Asynchronously reads leases from a peer and updates local
     /// lease database using a provided client instance.
     ///
+    /// The address space is split in ranges (see @c createSyncRanges)
+    /// which are fetched in parallel, each by a stream of lease4-get-page
+    /// or lease6-get-page commands sent by @c asyncSyncLeasesRange. The
+    /// leases are fetched in a single stream unless the HTTP client runs
+    /// in the multi-threaded mode and more than one stream is configured
+    /// with the "sync-streams" parameter.
+    ///
+    /// The @c post_sync_action callback is invoked when all streams have
+    /// completed. It is called with the error message of the first failed
+    /// stream, if any. The last parameter passed to this callback indicates
+    /// whether any stream has successfully disabled DHCP service on the
+    /// partner server. If that's the case, the DHCP service must be
+    /// re-enabled by sending dhcp-enable command. This is done in the
+    /// @c HAService::synchronize method.
+    ///
+    /// The progress of the synchronization is recorded in the
+    /// @c sync_progress_ and reported by the ha-sync and status-get
+    /// commands.
+    ///
+    /// @param http_client reference to the client to be used to communicate
+    /// with the other server.
+    /// @param server_name name of the server to fetch leases from.
+    /// @param max_period maximum number of seconds to disable DHCP service
+    /// @param post_sync_action pointer to the function to be executed when
+    /// lease database synchronization is complete. If this is null, no
+    /// post synchronization action is invoked.
+    void asyncSyncLeases(http::HttpClient& http_client,
+                         const std::string& server_name,
+                         const unsigned int max_period,
+                         PostSyncCallback post_sync_action);
+
+    /// @brief Splits the address space in ranges synchronized in parallel.
+    ///
+    /// The number of ranges is limited by the "sync-streams" parameter and
+    /// by the number of threads of the HTTP client. The ranges are computed
+    /// from the pools of the current configuration, which is expected to
+    /// be the same on both servers.
+    ///
+    /// @param http_client reference to the client used to fetch the leases.
+    /// @return The ranges sorted by address.
+    LeaseSyncRanges createSyncRanges(const http::HttpClient& http_client) const;
+
+    /// @brief Asynchronously reads leases of an address range from a peer
+    /// and updates local lease database.
+    ///
     /// This method first sends dhcp-disable command to the server from which
     /// it will be fetching leases to disable its DHCP function while database
     /// synchronization is in progress. If the command is successful, it then
     /// sends lease4-get-page command to fetch a page of leases from the
     /// partner's database. Depending on the configured page size, it may
     /// be required to send multiple lease4-get-page or lease6-get-page
-    /// commands to fetch all leases. If the lease database is large,
-    /// the database synchronization may even take several minutes.
+    /// commands to fetch all leases of the range. If the lease database is
+    /// large, the database synchronization may even take several minutes.
     /// Therefore, dhcp-disable command is sent prior to fetching each page,
     /// in order to reset the timeout for automatic re-enabling of the
     /// DHCP service on the remote server. Such timeout must only occur
@@ -758,18 +918,13 @@ protected:
     /// longer period of time. If the synchronization is progressing the
     /// timeout must be deferred.
     ///
-    /// The @c asyncSyncLeases method calls itself (recurses) when the previous
-    /// @c lease4-get-page or @c lease6-get-page command has completed
-    /// successfully. If the last page of leases was fetched or if any
-    /// error occurred, the synchronization is terminated and the
+    /// The @c asyncSyncLeasesRange method calls itself (recurses) when the
+    /// previous @c lease4-get-page or @c lease6-get-page command has
+    /// completed successfully. If the last page of leases of the range was
+    /// fetched, if any error occurred or if another stream has failed, the
+    /// synchronization of the range is terminated and the
     /// @c post_sync_action callback is invoked.
     ///
-    /// The last parameter passed to the @c post_sync_action callback indicates
-    /// whether this server has successfully disabled DHCP service on
-    /// the partner server at least once. If that's the case, the DHCP
-    /// service must be re-enabled by sending dhcp-enable command. This
-    /// is done in the @c HAService::synchronize method.
-    ///
     /// If there is an error while inserting or updating any of the leases
     /// a warning message is logged and the process continues for the
     /// remaining leases.
@@ -778,46 +933,51 @@ protected:
     /// with the other server.
     /// @param server_name name of the server to fetch leases from.
     /// @param max_period maximum number of seconds to disable DHCP service
+    /// @param range Range of addresses of the fetched leases.
     /// @param last_lease Pointer to the last lease returned on the previous
     /// page of leases. This lease is used to set the value of the "from"
     /// parameter in the @c lease4-get-page and @c lease6-get-page commands. If this
-    /// command is sent to fetch the first page, the @c last_lease parameter
-    /// should be set to null.
+    /// command is sent to fetch the first page of the range, the @c last_lease
+    /// parameter should be set to null.
     /// @param post_sync_action pointer to the function to be executed when
-    /// lease database synchronization is complete. If this is null, no
+    /// the synchronization of the range is complete. If this is null, no
     /// post synchronization action is invoked.
     /// @param dhcp_disabled Boolean flag indicating if the remote DHCP
     /// server is disabled. This flag propagates down to the
     /// @c post_sync_action to indicate whether the DHCP service has to
     /// be enabled after the leases synchronization.
-    void asyncSyncLeases(http::HttpClient& http_client,
-                         const std::string& server_name,
-                         const unsigned int max_period,
-                         const dhcp::LeasePtr& last_lease,
-                         PostSyncCallback post_sync_action,
-                         const bool dhcp_disabled = false);
+    void asyncSyncLeasesRange(http::HttpClient& http_client,
+                              const std::string& server_name,
+                              const unsigned int max_period,
+                              const LeaseSyncRange& range,
+                              const dhcp::LeasePtr& last_lease,
+                              PostSyncCallback post_sync_action,
+                              const bool dhcp_disabled = false);
 
     /// @brief Implements fetching one page of leases during synchronization.
     ///
     /// This method implements the actual lease fetching from the partner
     /// and synchronization of the database. It excludes sending @c dhcp-disable
-    /// command. This command is sent by @c HAService::asyncSyncLeases.
+    /// command. This command is sent by @c HAService::asyncSyncLeasesRange.
     ///
-    /// When the page of leases is successfully synchronized, this method
-    /// will call @c HAService::asyncSyncLeases to schedule synchronization of
+    /// The leases beyond the end of the range are discarded: they are
+    /// fetched by the stream of the next range. When the page of leases is
+    /// successfully synchronized, this method will call
+    /// @c HAService::asyncSyncLeasesRange to schedule synchronization of
     /// the next page of leases.
     ///
     /// @param http_client reference to the client to be used to communicate
     /// with the other server.
     /// @param server_name name of the server to fetch leases from.
     /// @param max_period maximum number of seconds to disable DHCP service
+    /// @param range Range of addresses of the fetched leases.
     /// @param last_lease Pointer to the last lease returned on the previous
     /// page of leases. This lease is used to set the value of the "from"
     /// parameter in the lease4-get-page and lease6-get-page commands. If this
-    /// command is sent to fetch the first page, the @c last_lease parameter
-    /// should be set to null.
+    /// command is sent to fetch the first page of the range, the @c last_lease
+    /// parameter should be set to null.
     /// @param post_sync_action pointer to the function to be executed when
-    /// lease database synchronization is complete. If this is null, no
+    /// the synchronization of the range is complete. If this is null, no
     /// post synchronization action is invoked.
     /// @param dhcp_disabled Boolean flag indicating if the remote DHCP
     /// server is disabled. This flag propagates down to the
@@ -826,6 +986,7 @@ protected:
     void asyncSyncLeasesInternal(http::HttpClient& http_client,
                                  const std::string& server_name,
                                  const unsigned int max_period,
+                                 const LeaseSyncRange& range,
                                  const dhcp::LeasePtr& last_lease,
                                  PostSyncCallback post_sync_action,
                                  const bool dhcp_disabled);
@@ -850,7 +1011,8 @@ public:
     /// of the peer. This value is used in dhcp-disable command issued to
     /// the peer before the lease4-get-page command.
     ///
-    /// @return Pointer to the response to the ha-sync command.
+    /// @return Pointer to the response to the ha-sync command. The
+    /// arguments hold the progress of the synchronization.
     data::ConstElementPtr processSynchronize(const std::string& server_name,
                                              const unsigned int max_period);
 
@@ -886,7 +1048,9 @@ protected:
     /// DHCPv6 case it sends a single lease6-bulk-apply command with all
     /// outstanding leases. In DHCPv4 case, it sends lease4-update or lease4-delete
     /// commands recursively (when one lease update completes successfully it
-    /// schedules sending next lease update).
+    /// schedules sending next lease update), or lease4-bulk-apply commands
+    /// carrying at most the batch size of lease updates each when the lease
+    /// updates are batched.
     ///
     /// If there are no lease updates in the backlog it calls @c post_request_action
     /// callback.
@@ -1115,6 +1279,22 @@ protected:
         return (true);
     }
 
+    /// @brief HttpClient TLS handshake statistics handler
+    ///
+    /// Updates the ha-tls-handshakes, ha-tls-handshakes-resumed and
+    /// ha-tls-handshake-failures statistics, and records the duration
+    /// of the successful handshakes in the ha-tls-handshake-latency
+    /// histogram.
+    ///
+    /// @param url URL of the partner (unused).
+    /// @param ec Error status of the handshake.
+    /// @param resumed true if a previous TLS session was resumed.
+    /// @param duration Duration of the handshake.
+    static void clientHandshakeStatsHandler(const http::Url& url,
+                                            const boost::system::error_code& ec,
+                                            const bool resumed,
+                                            const std::chrono::steady_clock::duration& duration);
+
     /// @brief IfaceMgr external socket ready callback handler
     ///
     /// IfaceMgr invokes this call back when a registered socket has been
@@ -1282,6 +1462,9 @@ protected:
     /// lease updates to the partner.
     LeaseUpdateBacklog lease_update_backlog_;
 
+    /// @brief Progress of the last lease database synchronization.
+    LeaseSyncProgress sync_progress_;
+
     /// @brief An indicator that a partner sent ha-sync-complete-notify command.
     ///
     /// This indicator is set when the partner finished synchronization. It blocks
@@ -1290,6 +1473,21 @@ protected:
     /// re-established. If the communication remains broken, the server clears
     /// this flag and enables DHCP service to continue the service.
     bool sync_complete_notified_;
+
+    /// @brief Batches of DHCPv4 lease updates by peer name.
+    std::map<std::string, LeaseUpdateBatchPtr> lease_update_batches_;
+
+    /// @brief Timer sending the incomplete batches of lease updates.
+    asiolink::IntervalTimerPtr lease_update_batch_timer_;
+
+    /// @brief Indicates that the batch timer is running.
+    bool lease_update_batch_timer_armed_;
+
+    /// @brief Number of batches sent and not answered yet by peer name.
+    std::map<std::string, size_t> lease_update_batches_in_flight_;
+
+    /// @brief Mutex protecting the batches of lease updates.
+    std::mutex lease_update_batch_mutex_;
 };
 
 /// @brief Pointer to the @c HAService class.
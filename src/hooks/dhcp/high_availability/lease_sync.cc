@@ -0,0 +1,226 @@
+// Copyright (C) 2022 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <lease_sync.h>
+#include <util/multi_threading_mgr.h>
+#include <algorithm>
+#include <utility>
+
+using namespace isc::asiolink;
+using namespace isc::data;
+using namespace isc::dhcp;
+using namespace isc::util;
+using namespace boost::posix_time;
+
+namespace isc {
+namespace ha {
+
+LeaseSyncRanges
+createLeaseSyncRanges4(const ConstCfgSubnets4Ptr& subnets, const size_t streams) {
+    // Gather the pools sorted by address with their total capacity.
+    std::vector<std::pair<uint32_t, uint32_t> > pools;
+    uint64_t capacity = 0;
+    for (auto const& subnet : *subnets->getAll()) {
+        for (auto const& pool : subnet->getPools(Lease::TYPE_V4)) {
+            uint32_t first = pool->getFirstAddress().toUint32();
+            uint32_t last = pool->getLastAddress().toUint32();
+            pools.push_back(std::make_pair(first, last));
+            capacity += static_cast<uint64_t>(last - first) + 1;
+        }
+    }
+    std::sort(pools.begin(), pools.end());
+
+    uint64_t count = std::min(static_cast<uint64_t>(streams), capacity);
+
+    // Each range but the last ends before the address holding the next
+    // share of the pool capacity.
+    LeaseSyncRanges ranges;
+    uint32_t from = 0;
+    size_t pool = 0;
+    uint64_t before = 0;
+    for (uint64_t i = 1; i < count; ++i) {
+        uint64_t share = capacity * i / count;
+        while (before + pools[pool].second - pools[pool].first + 1 <= share) {
+            before += pools[pool].second - pools[pool].first + 1;
+            ++pool;
+        }
+        uint32_t to = pools[pool].first + static_cast<uint32_t>(share - before) - 1;
+        if (to > from) {
+            ranges.push_back(LeaseSyncRange(IOAddress(from), IOAddress(to)));
+            from = to;
+        }
+    }
+    ranges.push_back(LeaseSyncRange(IOAddress(from), IOAddress::IPV4_BCAST_ADDRESS()));
+    return (ranges);
+}
+
+LeaseSyncRanges
+createLeaseSyncRanges6(const ConstCfgSubnets6Ptr& subnets, const size_t streams) {
+    // Gather the beginnings of the address and prefix pools.
+    std::vector<IOAddress> pools;
+    for (auto const& subnet : *subnets->getAll()) {
+        for (auto type : { Lease::TYPE_NA, Lease::TYPE_TA, Lease::TYPE_PD }) {
+            for (auto const& pool : subnet->getPools(type)) {
+                pools.push_back(pool->getFirstAddress());
+            }
+        }
+    }
+    std::sort(pools.begin(), pools.end());
+
+    size_t count = std::min(streams, pools.size());
+
+    // Each range but the last ends at the beginning of the pool opening
+    // the next range. The lease at this address is fetched with the
+    // previous range, which is harmless.
+    LeaseSyncRanges ranges;
+    IOAddress from = IOAddress::IPV6_ZERO_ADDRESS();
+    for (size_t i = 1; i < count; ++i) {
+        const IOAddress& to = pools[pools.size() * i / count];
+        if (from < to) {
+            ranges.push_back(LeaseSyncRange(from, to));
+            from = to;
+        }
+    }
+    ranges.push_back(LeaseSyncRange(from, IOAddress("ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff")));
+    return (ranges);
+}
+
+LeaseSyncProgress::LeaseSyncProgress()
+    : streams_(0), completed_streams_(0), pages_(0), leases_(0), failed_(false),
+      error_message_(), dhcp_disabled_(false), start_time_(), end_time_(),
+      mutex_() {
+}
+
+void
+LeaseSyncProgress::start(const size_t streams) {
+    if (MultiThreadingMgr::instance().getMode()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        startInternal(streams);
+        return;
+    }
+    startInternal(streams);
+}
+
+void
+LeaseSyncProgress::startInternal(const size_t streams) {
+    streams_ = streams;
+    completed_streams_ = 0;
+    pages_ = 0;
+    leases_ = 0;
+    failed_ = false;
+    error_message_.clear();
+    dhcp_disabled_ = false;
+    start_time_ = microsec_clock::universal_time();
+    end_time_ = ptime();
+}
+
+void
+LeaseSyncProgress::pageReceived(const size_t leases) {
+    if (MultiThreadingMgr::instance().getMode()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++pages_;
+        leases_ += leases;
+        return;
+    }
+    ++pages_;
+    leases_ += leases;
+}
+
+bool
+LeaseSyncProgress::streamCompleted(const bool success, const std::string& error_message,
+                                   const bool dhcp_disabled) {
+    if (MultiThreadingMgr::instance().getMode()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return (streamCompletedInternal(success, error_message, dhcp_disabled));
+    }
+    return (streamCompletedInternal(success, error_message, dhcp_disabled));
+}
+
+bool
+LeaseSyncProgress::streamCompletedInternal(const bool success,
+                                           const std::string& error_message,
+                                           const bool dhcp_disabled) {
+    if (!success && !failed_) {
+        failed_ = true;
+        error_message_ = error_message;
+    }
+    dhcp_disabled_ = dhcp_disabled_ || dhcp_disabled;
+    if (++completed_streams_ < streams_) {
+        return (false);
+    }
+    end_time_ = microsec_clock::universal_time();
+    return (true);
+}
+
+bool
+LeaseSyncProgress::hasFailed() const {
+    if (MultiThreadingMgr::instance().getMode()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return (failed_);
+    }
+    return (failed_);
+}
+
+std::string
+LeaseSyncProgress::getErrorMessage() const {
+    if (MultiThreadingMgr::instance().getMode()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return (error_message_);
+    }
+    return (error_message_);
+}
+
+bool
+LeaseSyncProgress::isDHCPDisabled() const {
+    if (MultiThreadingMgr::instance().getMode()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return (dhcp_disabled_);
+    }
+    return (dhcp_disabled_);
+}
+
+bool
+LeaseSyncProgress::isStarted() const {
+    if (MultiThreadingMgr::instance().getMode()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return (!start_time_.is_not_a_date_time());
+    }
+    return (!start_time_.is_not_a_date_time());
+}
+
+ElementPtr
+LeaseSyncProgress::toElement() const {
+    if (MultiThreadingMgr::instance().getMode()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return (toElementInternal());
+    }
+    return (toElementInternal());
+}
+
+ElementPtr
+LeaseSyncProgress::toElementInternal() const {
+    ElementPtr progress = Element::createMap();
+    bool in_progress = (!start_time_.is_not_a_date_time() &&
+                        end_time_.is_not_a_date_time());
+    progress->set("in-progress", Element::create(in_progress));
+    progress->set("streams", Element::create(static_cast<long long>(streams_)));
+    progress->set("completed-streams",
+                  Element::create(static_cast<long long>(completed_streams_)));
+    progress->set("pages", Element::create(static_cast<long long>(pages_)));
+    progress->set("leases", Element::create(static_cast<long long>(leases_)));
+    long long duration = 0;
+    if (!start_time_.is_not_a_date_time()) {
+        ptime end_time = (in_progress ? microsec_clock::universal_time() : end_time_);
+        duration = (end_time - start_time_).total_seconds();
+    }
+    progress->set("duration", Element::create(duration));
+    return (progress);
+}
+
+} // end of namespace isc::ha
+} // end of namespace isc
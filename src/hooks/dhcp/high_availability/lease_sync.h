@@ -0,0 +1,214 @@
+// Copyright (C) 2022 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef HA_LEASE_SYNC_H
+#define HA_LEASE_SYNC_H
+
+#include <asiolink/io_address.h>
+#include <cc/data.h>
+#include <dhcpsrv/cfg_subnets4.h>
+#include <dhcpsrv/cfg_subnets6.h>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace isc {
+namespace ha {
+
+/// @brief Range of addresses synchronized by one stream of the lease
+/// database synchronization.
+///
+/// The range holds the leases with addresses greater than @c from_ and
+/// lower than or equal to @c to_. As for the "from" parameter of the
+/// lease4-get-page and lease6-get-page commands, the zero address stands
+/// for the beginning of the address space.
+struct LeaseSyncRange {
+
+    /// @brief Constructor.
+    ///
+    /// @param from Address after which the leases of the range begin.
+    /// @param to Highest address of the range.
+    LeaseSyncRange(const asiolink::IOAddress& from, const asiolink::IOAddress& to)
+        : from_(from), to_(to) {
+    }
+
+    /// @brief Checks if an address belongs to the range.
+    ///
+    /// @param address Address to be checked.
+    /// @return true if the address is greater than @c from_ (or @c from_
+    /// is the zero address) and lower than or equal to @c to_.
+    bool inRange(const asiolink::IOAddress& address) const {
+        return ((from_.isV4Zero() || from_.isV6Zero() || (from_ < address)) &&
+                (address <= to_));
+    }
+
+    /// @brief Address after which the leases of the range begin.
+    asiolink::IOAddress from_;
+
+    /// @brief Highest address of the range.
+    asiolink::IOAddress to_;
+};
+
+/// @brief Collection of lease synchronization ranges.
+typedef std::vector<LeaseSyncRange> LeaseSyncRanges;
+
+/// @brief Splits the IPv4 address space in ranges synchronized in parallel.
+///
+/// The ranges cover the entire address space. Their boundaries are placed
+/// so as each range holds the same share of the addresses of the
+/// configured pools.
+///
+/// @param subnets Configured IPv4 subnets.
+/// @param streams Maximum number of ranges.
+/// @return The ranges sorted by address. A single range is returned when
+/// the number of streams is lower than 2 or when there are no pools.
+LeaseSyncRanges
+createLeaseSyncRanges4(const dhcp::ConstCfgSubnets4Ptr& subnets, const size_t streams);
+
+/// @brief Splits the IPv6 address space in ranges synchronized in parallel.
+///
+/// The ranges cover the entire address space. IPv6 pools are too large
+/// to be split by capacity, so the boundaries are placed at the beginning
+/// of the address and prefix pools, with the same number of pools in each
+/// range.
+///
+/// @param subnets Configured IPv6 subnets.
+/// @param streams Maximum number of ranges.
+/// @return The ranges sorted by address. A single range is returned when
+/// the number of streams is lower than 2 or when there are no pools.
+LeaseSyncRanges
+createLeaseSyncRanges6(const dhcp::ConstCfgSubnets6Ptr& subnets, const size_t streams);
+
+/// @brief Progress of the lease database synchronization.
+///
+/// The lease database synchronization fetches the leases from the partner
+/// in one or more streams, each stream fetching the pages of leases of one
+/// @c LeaseSyncRange. This class counts the pages and the leases fetched
+/// by the streams, reported in the responses to the ha-sync and
+/// status-get commands, and tracks the completion of the streams. The
+/// streams may complete in different threads of the HTTP client.
+class LeaseSyncProgress {
+public:
+
+    /// @brief Constructor.
+    LeaseSyncProgress();
+
+    /// @brief Records the beginning of a synchronization.
+    ///
+    /// @param streams Number of streams fetching the leases.
+    void start(const size_t streams);
+
+    /// @brief Records a page of leases fetched by a stream.
+    ///
+    /// @param leases Number of leases of the page.
+    void pageReceived(const size_t leases);
+
+    /// @brief Records the completion of a stream.
+    ///
+    /// @param success Boolean flag indicating if the stream completed
+    /// successfully.
+    /// @param error_message Error message of a failed stream.
+    /// @param dhcp_disabled Boolean flag indicating if the stream has
+    /// disabled the DHCP service of the partner.
+    /// @return true if this was the last running stream.
+    bool streamCompleted(const bool success, const std::string& error_message,
+                         const bool dhcp_disabled);
+
+    /// @brief Checks if a stream has failed.
+    ///
+    /// The running streams stop fetching leases when another stream fails.
+    ///
+    /// @return true if a stream of the current synchronization has failed.
+    bool hasFailed() const;
+
+    /// @brief Returns the error message of the first failed stream.
+    ///
+    /// @return Error message or an empty string.
+    std::string getErrorMessage() const;
+
+    /// @brief Checks if any stream has disabled the DHCP service of the
+    /// partner.
+    ///
+    /// @return true if the DHCP service of the partner must be enabled.
+    bool isDHCPDisabled() const;
+
+    /// @brief Checks if a synchronization has been started.
+    ///
+    /// @return true if @c start has been called.
+    bool isStarted() const;
+
+    /// @brief Returns the progress of the last synchronization in JSON.
+    ///
+    /// @return Map holding the "in-progress" flag, the numbers of streams,
+    /// completed streams, pages and leases, and the duration in seconds.
+    data::ElementPtr toElement() const;
+
+private:
+
+    /// @brief Records the beginning of a synchronization.
+    ///
+    /// Should be called in a thread safe context.
+    ///
+    /// @param streams Number of streams fetching the leases.
+    void startInternal(const size_t streams);
+
+    /// @brief Records the completion of a stream.
+    ///
+    /// Should be called in a thread safe context.
+    ///
+    /// @param success Boolean flag indicating if the stream completed
+    /// successfully.
+    /// @param error_message Error message of a failed stream.
+    /// @param dhcp_disabled Boolean flag indicating if the stream has
+    /// disabled the DHCP service of the partner.
+    /// @return true if this was the last running stream.
+    bool streamCompletedInternal(const bool success, const std::string& error_message,
+                                 const bool dhcp_disabled);
+
+    /// @brief Returns the progress of the last synchronization in JSON.
+    ///
+    /// Should be called in a thread safe context.
+    ///
+    /// @return Map holding the progress.
+    data::ElementPtr toElementInternal() const;
+
+    /// @brief Number of streams.
+    size_t streams_;
+
+    /// @brief Number of completed streams.
+    size_t completed_streams_;
+
+    /// @brief Number of fetched pages.
+    size_t pages_;
+
+    /// @brief Number of fetched leases.
+    size_t leases_;
+
+    /// @brief Boolean flag indicating if a stream has failed.
+    bool failed_;
+
+    /// @brief Error message of the first failed stream.
+    std::string error_message_;
+
+    /// @brief Boolean flag indicating if a stream has disabled the DHCP
+    /// service of the partner.
+    bool dhcp_disabled_;
+
+    /// @brief Time when the synchronization started.
+    boost::posix_time::ptime start_time_;
+
+    /// @brief Time when the last stream completed.
+    boost::posix_time::ptime end_time_;
+
+    /// @brief Mutex to protect the internal state.
+    mutable std::mutex mutex_;
+};
+
+} // end of namespace isc::ha
+} // end of namespace isc
+
+#endif // HA_LEASE_SYNC_H
@@ -1,4 +1,4 @@
-// Copyright (C) 2020-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2020-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -6,6 +6,7 @@
 
 #include <config.h>
 
+#include <ha_log.h>
 #include <lease_update_backlog.h>
 #include <util/multi_threading_mgr.h>
 
@@ -14,6 +15,19 @@ using namespace isc::dhcp;
 namespace isc {
 namespace ha {
 
+LeaseUpdateBacklog::LeaseUpdate::LeaseUpdate(const OpType op_type,
+                                             const LeasePtr& lease)
+    : key_(Lease::TYPE_V4, lease->addr_), op_type_(op_type), lease_() {
+    Lease6Ptr lease6 = boost::dynamic_pointer_cast<Lease6>(lease);
+    if (lease6) {
+        key_.first = lease6->type_;
+        lease_ = LeaseCodec::encode(Lease6Collection(1, lease6));
+    } else {
+        Lease4Ptr lease4 = boost::dynamic_pointer_cast<Lease4>(lease);
+        lease_ = LeaseCodec::encode(Lease4Collection(1, lease4));
+    }
+}
+
 LeaseUpdateBacklog::LeaseUpdateBacklog(const size_t limit)
     : limit_(limit), overflown_(false), outstanding_updates_() {
 }
@@ -67,23 +81,46 @@ LeaseUpdateBacklog::size() {
 
 bool
 LeaseUpdateBacklog::pushInternal(const LeaseUpdateBacklog::OpType op_type, const LeasePtr& lease) {
+    LeaseUpdate update(op_type, lease);
+
+    // Replace the queued update of the same lease, if any.
+    auto& index = outstanding_updates_.get<1>();
+    auto existing = index.find(update.key_);
+    if (existing != index.end()) {
+        index.replace(existing, update);
+        return (true);
+    }
+
     if (outstanding_updates_.size() >= limit_) {
         overflown_ = true;
         return (false);
     }
-    outstanding_updates_.push_back(std::make_pair(op_type, lease));
+    outstanding_updates_.push_back(update);
     return (true);
 }
 
 LeasePtr
 LeaseUpdateBacklog::popInternal(LeaseUpdateBacklog::OpType& op_type) {
-    if (outstanding_updates_.empty()) {
-        return (LeasePtr());
+    while (!outstanding_updates_.empty()) {
+        auto item = outstanding_updates_.front();
+        outstanding_updates_.pop_front();
+        try {
+            LeasePtr lease;
+            if (item.key_.first == Lease::TYPE_V4) {
+                lease = LeaseCodec::decode4(item.lease_).front();
+            } else {
+                lease = LeaseCodec::decode6(item.lease_).front();
+            }
+            op_type = item.op_type_;
+            return (lease);
+
+        } catch (const std::exception& ex) {
+            LOG_WARN(ha_logger, HA_LEASES_BACKLOG_INVALID_LEASE)
+                .arg(item.key_.second)
+                .arg(ex.what());
+        }
     }
-    auto item = outstanding_updates_.front();
-    outstanding_updates_.pop_front();
-    op_type = item.first;
-    return (item.second);
+    return (LeasePtr());
 }
 
 } // end of namespace isc::ha
@@ -1,4 +1,4 @@
-// Copyright (C) 2020-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2020-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -7,10 +7,16 @@
 #ifndef HA_LEASE_BACKLOG_H
 #define HA_LEASE_BACKLOG_H
 
+#include <asiolink/io_address.h>
 #include <dhcpsrv/lease.h>
-#include <deque>
+#include <dhcpsrv/lease_codec.h>
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
 #include <mutex>
 #include <utility>
+#include <vector>
 
 namespace isc {
 namespace ha {
@@ -33,15 +39,19 @@ namespace ha {
 /// is specified when the lease is appended to the queue.
 ///
 /// The backlog queue holds both "Add" and "Delete" lease updates in a
-/// single std::deque container, which allows for ordering them
-/// chronologically and using this ordering for queue optimizations in
-/// the future. For example, if the queue contains consecutive "Delete"
-/// updates for a particular IP address, the server could only delete
-/// the lease once. If the queue contains multiple "Delete" lease updates
-/// followed by an "Add" update, the server could skip sending "Delete"
-/// updates.
+/// single container ordered chronologically. The updates are coalesced
+/// by lease: when an update is appended for a lease (address and type)
+/// which already has an update in the queue, the queued update is
+/// replaced in place with the new one. Only the latest state of a lease
+/// is sent to the partner and a client renewing its lease many times
+/// does not fill the queue.
 ///
-/// Queue optimizations will be subject to future work!
+/// The queue does not hold the pointers to the leases, which would keep
+/// the lease objects (and their hardware addresses, client identifiers
+/// and user contexts) in memory, but compact snapshots of the leases
+/// encoded with the @c dhcp::LeaseCodec. The leases are restored from
+/// their snapshots when the updates are popped from the queue. This makes
+/// large queue size limits affordable.
 class LeaseUpdateBacklog {
 public:
 
@@ -59,6 +69,9 @@ public:
 
     /// @brief Appends lease update to the queue.
     ///
+    /// If the queue already holds an update for the lease this update is
+    /// replaced and the queue size is not changed.
+    ///
     /// @param op_type type of the lease update (operation type).
     /// @param lease pointer to the lease being added, or deleted.
     /// @return boolean value indicating whether the lease was successfully
@@ -67,6 +80,11 @@ public:
 
     /// @brief Returns the next lease update and removes it from the queue.
     ///
+    /// The returned lease is a new object restored from the snapshot held
+    /// in the queue. The updates which snapshots can't be restored, i.e.
+    /// the updates of the leases the partner would reject, are logged and
+    /// skipped.
+    ///
     /// @param [out] op_type reference to the value receiving lease update type.
     /// @return pointer to the next lease update in the queue or null pointer
     /// when the queue is empty.
@@ -112,6 +130,42 @@ private:
     /// when the queue is empty.
     dhcp::LeasePtr popInternal(OpType& op_type);
 
+    /// @brief Key identifying a lease in the queue: lease type and address.
+    typedef std::pair<dhcp::Lease::Type, asiolink::IOAddress> LeaseKey;
+
+    /// @brief Lease update held in the queue.
+    struct LeaseUpdate {
+        /// @brief Constructor.
+        ///
+        /// @param op_type type of the lease update (operation type).
+        /// @param lease pointer to the lease being added, or deleted.
+        LeaseUpdate(const OpType op_type, const dhcp::LeasePtr& lease);
+
+        /// @brief Lease key (type and address).
+        LeaseKey key_;
+
+        /// @brief Type of the lease update.
+        OpType op_type_;
+
+        /// @brief Snapshot of the lease being added, or deleted.
+        std::vector<uint8_t> lease_;
+    };
+
+    /// @brief Container of lease updates.
+    ///
+    /// The first index keeps the chronological order, the second one
+    /// finds the update of a lease.
+    typedef boost::multi_index_container<
+        LeaseUpdate,
+        boost::multi_index::indexed_by<
+            boost::multi_index::sequenced<>,
+            boost::multi_index::ordered_unique<
+                boost::multi_index::member<LeaseUpdate, LeaseKey,
+                                           &LeaseUpdate::key_>
+            >
+        >
+    > LeaseUpdateContainer;
+
     /// @brief Holds the queue size limit.
     size_t limit_;
 
@@ -119,7 +173,7 @@ private:
     bool overflown_;
 
     /// @brief Actual queue of lease updates and their types.
-    std::deque<std::pair<OpType, dhcp::LeasePtr> > outstanding_updates_;
+    LeaseUpdateContainer outstanding_updates_;
 
     /// @brief Mutex to protect internal state.
     std::mutex mutex_;
@@ -1,4 +1,4 @@
-// Copyright (C) 2018-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2018-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -14,6 +14,7 @@
 #include <exceptions/exceptions.h>
 #include <dhcp/hwaddr.h>
 #include <dhcpsrv/lease.h>
+#include <dhcpsrv/lease_codec.h>
 #include <boost/pointer_cast.hpp>
 #include <gtest/gtest.h>
 #include <vector>
@@ -197,6 +198,147 @@ TEST(CommandCreatorTest, createHeartbeat4) {
     ASSERT_NO_FATAL_FAILURE(testCommandBasics(command, "ha-heartbeat", "dhcp4"));
 }
 
+// This test verifies that the lease4-bulk-apply command is correct.
+TEST(CommandCreatorTest, createLease4BulkApply) {
+    Lease4Ptr lease = createLease4();
+    Lease4Ptr deleted_lease = createLease4();
+
+    Lease4CollectionPtr leases(new Lease4Collection());
+    Lease4CollectionPtr deleted_leases(new Lease4Collection());
+
+    leases->push_back(lease);
+    deleted_leases->push_back(deleted_lease);
+
+    ConstElementPtr command = CommandCreator::createLease4BulkApply(leases, deleted_leases);
+    ConstElementPtr arguments;
+    ASSERT_NO_FATAL_FAILURE(testCommandBasics(command, "lease4-bulk-apply",
+                                              "dhcp4", arguments));
+
+    // Verify deleted-leases.
+    auto deleted_leases_json = arguments->get("deleted-leases");
+    ASSERT_TRUE(deleted_leases_json);
+    ASSERT_EQ(Element::list, deleted_leases_json->getType());
+    ASSERT_EQ(1, deleted_leases_json->size());
+    auto lease_as_json = deleted_leases_json->get(0);
+    EXPECT_EQ(leaseAsJson(createLease4())->str(), lease_as_json->str());
+
+    // Verify leases.
+    auto leases_json = arguments->get("leases");
+    ASSERT_TRUE(leases_json);
+    ASSERT_EQ(Element::list, leases_json->getType());
+    ASSERT_EQ(1, leases_json->size());
+    lease_as_json = leases_json->get(0);
+    EXPECT_EQ(leaseAsJson(createLease4())->str(), lease_as_json->str());
+}
+
+// This test verifies that the lease4-bulk-apply command can be created
+// from DHCPv4 leases backlog and that only the latest update of a lease
+// is sent.
+TEST(CommandCreatorTest, createLease4BulkApplyFromBacklog) {
+    // The backlog holds snapshots of valid leases only.
+    Lease4Ptr lease = createLease4();
+    lease->cltt_ = 1000;
+    Lease4Ptr renewed_lease = createLease4();
+    renewed_lease->cltt_ = 1010;
+    Lease4Ptr deleted_lease = createLease4();
+    deleted_lease->cltt_ = 1000;
+    deleted_lease->addr_ = IOAddress("192.1.2.4");
+
+    LeaseUpdateBacklog backlog(100);
+    backlog.push(LeaseUpdateBacklog::ADD, lease);
+    backlog.push(LeaseUpdateBacklog::DELETE, deleted_lease);
+    backlog.push(LeaseUpdateBacklog::ADD, renewed_lease);
+
+    ConstElementPtr command = CommandCreator::createLease4BulkApply(backlog);
+    ConstElementPtr arguments;
+    ASSERT_NO_FATAL_FAILURE(testCommandBasics(command, "lease4-bulk-apply",
+                                              "dhcp4", arguments));
+
+    // Verify deleted-leases.
+    auto deleted_leases_json = arguments->get("deleted-leases");
+    ASSERT_TRUE(deleted_leases_json);
+    ASSERT_EQ(Element::list, deleted_leases_json->getType());
+    ASSERT_EQ(1, deleted_leases_json->size());
+    auto lease_as_json = deleted_leases_json->get(0);
+    EXPECT_EQ(leaseAsJson(deleted_lease)->str(), lease_as_json->str());
+
+    // Verify leases.
+    auto leases_json = arguments->get("leases");
+    ASSERT_TRUE(leases_json);
+    ASSERT_EQ(Element::list, leases_json->getType());
+    ASSERT_EQ(1, leases_json->size());
+    lease_as_json = leases_json->get(0);
+    EXPECT_EQ(leaseAsJson(renewed_lease)->str(), lease_as_json->str());
+
+    // Make sure the backlog is now empty.
+    EXPECT_EQ(0, backlog.size());
+}
+
+// This test verifies that the number of leases popped from the DHCPv4
+// leases backlog by the lease4-bulk-apply command can be limited.
+TEST(CommandCreatorTest, createLease4BulkApplyFromBacklogLimit) {
+    LeaseUpdateBacklog backlog(100);
+    for (auto address : { "192.1.2.3", "192.1.2.4", "192.1.2.5" }) {
+        Lease4Ptr lease = createLease4();
+        lease->cltt_ = 1000;
+        lease->addr_ = IOAddress(address);
+        backlog.push(LeaseUpdateBacklog::ADD, lease);
+    }
+
+    // The first command carries two leases.
+    ConstElementPtr command = CommandCreator::createLease4BulkApply(backlog, false, 2);
+    ConstElementPtr arguments;
+    ASSERT_NO_FATAL_FAILURE(testCommandBasics(command, "lease4-bulk-apply",
+                                              "dhcp4", arguments));
+    auto leases_json = arguments->get("leases");
+    ASSERT_TRUE(leases_json);
+    EXPECT_EQ(2, leases_json->size());
+    EXPECT_EQ(1, backlog.size());
+
+    // The second command carries the remaining lease.
+    command = CommandCreator::createLease4BulkApply(backlog, false, 2);
+    ASSERT_NO_FATAL_FAILURE(testCommandBasics(command, "lease4-bulk-apply",
+                                              "dhcp4", arguments));
+    leases_json = arguments->get("leases");
+    ASSERT_TRUE(leases_json);
+    EXPECT_EQ(1, leases_json->size());
+    EXPECT_EQ(0, backlog.size());
+}
+
+// This test verifies that the lease4-bulk-apply command carries the
+// created or updated leases in the compact binary encoding when requested.
+TEST(CommandCreatorTest, createLease4BulkApplyBinary) {
+    // The encoded leases must have a valid client last transmission time.
+    Lease4Ptr lease = createLease4();
+    lease->cltt_ = 1000;
+
+    Lease4CollectionPtr leases(new Lease4Collection());
+    Lease4CollectionPtr deleted_leases(new Lease4Collection());
+    leases->push_back(lease);
+    deleted_leases->push_back(createLease4());
+
+    ConstElementPtr command = CommandCreator::createLease4BulkApply(leases, deleted_leases,
+                                                                    true);
+    ConstElementPtr arguments;
+    ASSERT_NO_FATAL_FAILURE(testCommandBasics(command, "lease4-bulk-apply",
+                                              "dhcp4", arguments));
+
+    // Deleted leases are still sent in JSON.
+    auto deleted_leases_json = arguments->get("deleted-leases");
+    ASSERT_TRUE(deleted_leases_json);
+    ASSERT_EQ(1, deleted_leases_json->size());
+    EXPECT_EQ(leaseAsJson(createLease4())->str(), deleted_leases_json->get(0)->str());
+
+    // Verify the encoded leases.
+    EXPECT_FALSE(arguments->get("leases"));
+    auto leases_binary = arguments->get("leases-binary");
+    ASSERT_TRUE(leases_binary);
+    ASSERT_EQ(Element::string, leases_binary->getType());
+    Lease4Collection decoded = LeaseCodec::decodeText4(leases_binary->stringValue());
+    ASSERT_EQ(1, decoded.size());
+    EXPECT_TRUE(isEquivalent(lease->toElement(), decoded[0]->toElement()));
+}
+
 // This test verifies that the command generated for the lease update
 // is correct.
 TEST(CommandCreatorTest, createLease4Update) {
@@ -277,6 +419,27 @@ TEST(CommandCreatorTest, createLease4GetPageZeroLimit) {
     EXPECT_THROW(CommandCreator::createLease4GetPage(lease4, 0), BadValue);
 }
 
+// This test verifies that the lease4-get-page command requests the leases
+// in the compact binary encoding when asked to.
+TEST(CommandCreatorTest, createLease4GetPageBinary) {
+    Lease4Ptr lease4;
+    ConstElementPtr command = CommandCreator::createLease4GetPage(lease4, 10, true);
+    ConstElementPtr arguments;
+    ASSERT_NO_FATAL_FAILURE(testCommandBasics(command, "lease4-get-page", "dhcp4",
+                                              arguments));
+
+    ConstElementPtr encoding = arguments->get("encoding");
+    ASSERT_TRUE(encoding);
+    ASSERT_EQ(Element::string, encoding->getType());
+    EXPECT_EQ("binary", encoding->stringValue());
+
+    // The encoding is not requested by default.
+    command = CommandCreator::createLease4GetPage(lease4, 10);
+    ASSERT_NO_FATAL_FAILURE(testCommandBasics(command, "lease4-get-page", "dhcp4",
+                                              arguments));
+    EXPECT_FALSE(arguments->get("encoding"));
+}
+
 // This test verifies that the dhcp-disable command (DHCPv6 case) is
 // correct.
 TEST(CommandCreatorTest, createDHCPDisable6) {
@@ -386,6 +549,7 @@ TEST(CommandCreatorTest, createLease6BulkApply) {
 TEST(CommandCreatorTest, createLease6BulkApplyFromBacklog) {
     Lease6Ptr lease = createLease6();
     Lease6Ptr deleted_lease = createLease6();
+    deleted_lease->addr_ = IOAddress("2001:db8:1::beef");
 
     LeaseUpdateBacklog backlog(100);
     backlog.push(LeaseUpdateBacklog::ADD, lease);
@@ -402,7 +566,7 @@ TEST(CommandCreatorTest, createLease6BulkApplyFromBacklog) {
     ASSERT_EQ(Element::list, deleted_leases_json->getType());
     ASSERT_EQ(1, deleted_leases_json->size());
     auto lease_as_json = deleted_leases_json->get(0);
-    EXPECT_EQ(leaseAsJson(createLease6())->str(), lease_as_json->str());
+    EXPECT_EQ(leaseAsJson(deleted_lease)->str(), lease_as_json->str());
 
     // Verify leases.
     auto leases_json = arguments->get("leases");
@@ -416,6 +580,43 @@ TEST(CommandCreatorTest, createLease6BulkApplyFromBacklog) {
     EXPECT_EQ(0, backlog.size());
 }
 
+// This test verifies that the lease6-bulk-apply command created from the
+// backlog carries the updated leases in the compact binary encoding when
+// requested.
+TEST(CommandCreatorTest, createLease6BulkApplyFromBacklogBinary) {
+    Lease6Ptr lease = createLease6();
+    lease->cltt_ = 1000;
+    Lease6Ptr deleted_lease = createLease6();
+    deleted_lease->addr_ = IOAddress("2001:db8:1::beef");
+
+    LeaseUpdateBacklog backlog(100);
+    backlog.push(LeaseUpdateBacklog::ADD, lease);
+    backlog.push(LeaseUpdateBacklog::DELETE, deleted_lease);
+
+    ConstElementPtr command = CommandCreator::createLease6BulkApply(backlog, true);
+    ConstElementPtr arguments;
+    ASSERT_NO_FATAL_FAILURE(testCommandBasics(command, "lease6-bulk-apply",
+                                              "dhcp6", arguments));
+
+    // Deleted leases are still sent in JSON.
+    auto deleted_leases_json = arguments->get("deleted-leases");
+    ASSERT_TRUE(deleted_leases_json);
+    ASSERT_EQ(1, deleted_leases_json->size());
+    EXPECT_EQ(leaseAsJson(deleted_lease)->str(), deleted_leases_json->get(0)->str());
+
+    // Verify the encoded leases.
+    EXPECT_FALSE(arguments->get("leases"));
+    auto leases_binary = arguments->get("leases-binary");
+    ASSERT_TRUE(leases_binary);
+    ASSERT_EQ(Element::string, leases_binary->getType());
+    Lease6Collection decoded = LeaseCodec::decodeText6(leases_binary->stringValue());
+    ASSERT_EQ(1, decoded.size());
+    EXPECT_TRUE(isEquivalent(lease->toElement(), decoded[0]->toElement()));
+
+    // Make sure the backlog is now empty.
+    EXPECT_EQ(0, backlog.size());
+}
+
 // This test verifies that the lease6-get-all command is correct.
 TEST(CommandCreatorTest, createLease6GetAll) {
     ConstElementPtr command = CommandCreator::createLease6GetAll();
@@ -96,12 +96,17 @@ TEST_F(HAConfigTest, configureLoadBalancing) {
         "        \"sync-leases\": false,"
         "        \"sync-timeout\": 20000,"
         "        \"sync-page-limit\": 3,"
+        "        \"sync-streams\": 4,"
         "        \"delayed-updates-limit\": 111,"
+        "        \"lease-update-batch-size\": 50,"
+        "        \"lease-update-batch-delay\": 2,"
         "        \"heartbeat-delay\": 8,"
         "        \"max-response-delay\": 11,"
         "        \"max-ack-delay\": 5,"
         "        \"max-unacked-clients\": 20,"
         "        \"wait-backup-ack\": false,"
+        "        \"http-max-connections\": 3,"
+        "        \"http-max-pipelined-requests\": 8,"
         "        \"peers\": ["
         "            {"
         "                \"name\": \"server1\","
@@ -152,8 +157,14 @@ TEST_F(HAConfigTest, configureLoadBalancing) {
     EXPECT_FALSE(impl->getConfig()->amSyncingLeases());
     EXPECT_EQ(20000, impl->getConfig()->getSyncTimeout());
     EXPECT_EQ(3, impl->getConfig()->getSyncPageLimit());
+    EXPECT_EQ(4, impl->getConfig()->getSyncStreams());
+    EXPECT_EQ(3, impl->getConfig()->getHttpMaxConnections());
+    EXPECT_EQ(8, impl->getConfig()->getHttpMaxPipelinedRequests());
     EXPECT_EQ(111, impl->getConfig()->getDelayedUpdatesLimit());
     EXPECT_TRUE(impl->getConfig()->amAllowingCommRecovery());
+    EXPECT_EQ(50, impl->getConfig()->getLeaseUpdateBatchSize());
+    EXPECT_EQ(2, impl->getConfig()->getLeaseUpdateBatchDelay());
+    EXPECT_TRUE(impl->getConfig()->amBatchingLeaseUpdates());
     EXPECT_EQ(8, impl->getConfig()->getHeartbeatDelay());
     EXPECT_EQ(11, impl->getConfig()->getMaxResponseDelay());
     EXPECT_EQ(5, impl->getConfig()->getMaxAckDelay());
@@ -277,8 +288,14 @@ TEST_F(HAConfigTest, configureHotStandby) {
     EXPECT_TRUE(impl->getConfig()->amSyncingLeases());
     EXPECT_EQ(60000, impl->getConfig()->getSyncTimeout());
     EXPECT_EQ(10000, impl->getConfig()->getSyncPageLimit());
+    EXPECT_EQ(1, impl->getConfig()->getSyncStreams());
+    EXPECT_EQ(0, impl->getConfig()->getHttpMaxConnections());
+    EXPECT_EQ(1, impl->getConfig()->getHttpMaxPipelinedRequests());
     EXPECT_EQ(0, impl->getConfig()->getDelayedUpdatesLimit());
     EXPECT_FALSE(impl->getConfig()->amAllowingCommRecovery());
+    EXPECT_EQ(0, impl->getConfig()->getLeaseUpdateBatchSize());
+    EXPECT_EQ(5, impl->getConfig()->getLeaseUpdateBatchDelay());
+    EXPECT_FALSE(impl->getConfig()->amBatchingLeaseUpdates());
     EXPECT_EQ(10000, impl->getConfig()->getHeartbeatDelay());
     EXPECT_EQ(10000, impl->getConfig()->getMaxAckDelay());
     EXPECT_EQ(10, impl->getConfig()->getMaxUnackedClients());
@@ -551,6 +568,89 @@ TEST_F(HAConfigTest, largeHeartbeatDelay) {
         "'heartbeat-delay' must not be greater than 65535");
 }
 
+// Error should be returned when lease updates are batched without delay.
+TEST_F(HAConfigTest, zeroLeaseUpdateBatchDelay) {
+    testInvalidConfig(
+        "["
+        "    {"
+        "        \"this-server-name\": \"server1\","
+        "        \"mode\": \"load-balancing\","
+        "        \"lease-update-batch-size\": 10,"
+        "        \"lease-update-batch-delay\": 0,"
+        "        \"peers\": ["
+        "            {"
+        "                \"name\": \"server1\","
+        "                \"url\": \"http://127.0.0.1:8080/\","
+        "                \"role\": \"primary\","
+        "                \"auto-failover\": false"
+        "            },"
+        "            {"
+        "                \"name\": \"server2\","
+        "                \"url\": \"http://127.0.0.1:8080/\","
+        "                \"role\": \"secondary\","
+        "                \"auto-failover\": true"
+        "            }"
+        "        ]"
+        "    }"
+        "]",
+        "'lease-update-batch-delay' must be greater than 0 when"
+        " 'lease-update-batch-size' is set");
+}
+
+// Error should be returned when the leases are synchronized in no stream.
+TEST_F(HAConfigTest, zeroSyncStreams) {
+    testInvalidConfig(
+        "["
+        "    {"
+        "        \"this-server-name\": \"server1\","
+        "        \"mode\": \"load-balancing\","
+        "        \"sync-streams\": 0,"
+        "        \"peers\": ["
+        "            {"
+        "                \"name\": \"server1\","
+        "                \"url\": \"http://127.0.0.1:8080/\","
+        "                \"role\": \"primary\","
+        "                \"auto-failover\": false"
+        "            },"
+        "            {"
+        "                \"name\": \"server2\","
+        "                \"url\": \"http://127.0.0.1:8080/\","
+        "                \"role\": \"secondary\","
+        "                \"auto-failover\": true"
+        "            }"
+        "        ]"
+        "    }"
+        "]",
+        "'sync-streams' must be greater than 0");
+}
+
+// Error should be returned when no request can be sent over a connection.
+TEST_F(HAConfigTest, zeroHttpMaxPipelinedRequests) {
+    testInvalidConfig(
+        "["
+        "    {"
+        "        \"this-server-name\": \"server1\","
+        "        \"mode\": \"load-balancing\","
+        "        \"http-max-pipelined-requests\": 0,"
+        "        \"peers\": ["
+        "            {"
+        "                \"name\": \"server1\","
+        "                \"url\": \"http://127.0.0.1:8080/\","
+        "                \"role\": \"primary\","
+        "                \"auto-failover\": false"
+        "            },"
+        "            {"
+        "                \"name\": \"server2\","
+        "                \"url\": \"http://127.0.0.1:8080/\","
+        "                \"role\": \"secondary\","
+        "                \"auto-failover\": true"
+        "            }"
+        "        ]"
+        "    }"
+        "]",
+        "'http-max-pipelined-requests' must be greater than 0");
+}
+
 // There must be at least two servers provided.
 TEST_F(HAConfigTest, singlePeer) {
     testInvalidConfig(
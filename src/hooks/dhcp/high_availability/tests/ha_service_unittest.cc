@@ -25,8 +25,10 @@
 #include <dhcpsrv/cfgmgr.h>
 #include <dhcpsrv/lease.h>
 #include <dhcpsrv/lease_mgr.h>
+#include <dhcpsrv/lease_codec.h>
 #include <dhcpsrv/lease_mgr_factory.h>
 #include <dhcpsrv/network_state.h>
+#include <dhcpsrv/subnet.h>
 #include <dhcpsrv/subnet_id.h>
 #include <hooks/parking_lots.h>
 #include <http/basic_auth_config.h>
@@ -197,6 +199,8 @@ public:
 
     using HAService::asyncSendHeartbeat;
     using HAService::asyncSyncLeases;
+    using HAService::asyncSyncLeasesRange;
+    using HAService::createSyncRanges;
     using HAService::postNextEvent;
     using HAService::transition;
     using HAService::verboseTransition;
@@ -209,6 +213,7 @@ public:
     using HAService::communication_state_;
     using HAService::query_filter_;
     using HAService::lease_update_backlog_;
+    using HAService::sync_progress_;
     using HAService::client_;
     using HAService::listener_;
 };
@@ -694,7 +699,24 @@ public:
     /// sent multiple times. The server is configured to return leases
     /// in 3-element chunks. Note that the HA configis set to ask for 3
     /// leases.
-    void createPagedSyncResponses4() {
+    ///
+    /// @param binary Boolean flag indicating if the leases are returned
+    /// in the compact binary encoding.
+    void createPagedSyncResponses4(const bool binary = false) {
+        if (binary) {
+            for (auto const& range : { std::make_pair(0, 3), std::make_pair(3, 6),
+                                       std::make_pair(6, 9), std::make_pair(9, 10) }) {
+                ElementPtr response_arguments = Element::createMap();
+                Lease4Collection leases(leases4_.begin() + range.first,
+                                        leases4_.begin() + range.second);
+                response_arguments->set("leases-binary",
+                                        Element::create(LeaseCodec::encodeText(leases)));
+                factory2_->getResponseCreator()->setArguments("lease4-get-page", response_arguments);
+                factory3_->getResponseCreator()->setArguments("lease4-get-page", response_arguments);
+            }
+            return;
+        }
+
         ElementPtr response_arguments = Element::createMap();
 
         // First, return leases with indexes from 0 to 2.
@@ -728,7 +750,24 @@ public:
     /// sent multiple times. The server is configured to return leases
     /// in 3-element chunks. Note that the HA configis set to ask for 3
     /// leases.
-    void createPagedSyncResponses6() {
+    ///
+    /// @param binary Boolean flag indicating if the leases are returned
+    /// in the compact binary encoding.
+    void createPagedSyncResponses6(const bool binary = false) {
+        if (binary) {
+            for (auto const& range : { std::make_pair(0, 3), std::make_pair(3, 6),
+                                       std::make_pair(6, 9), std::make_pair(9, 10) }) {
+                ElementPtr response_arguments = Element::createMap();
+                Lease6Collection leases(leases6_.begin() + range.first,
+                                        leases6_.begin() + range.second);
+                response_arguments->set("leases-binary",
+                                        Element::create(LeaseCodec::encodeText(leases)));
+                factory2_->getResponseCreator()->setArguments("lease6-get-page", response_arguments);
+                factory3_->getResponseCreator()->setArguments("lease6-get-page", response_arguments);
+            }
+            return;
+        }
+
         ElementPtr response_arguments = Element::createMap();
 
         // First, return leases with indexes from 0 to 2.
@@ -830,14 +869,14 @@ public:
         HWAddrPtr hwaddr(new HWAddr(std::vector<uint8_t>(6, 1), HTYPE_ETHER));
         Lease4Ptr lease4(new Lease4(IOAddress("192.1.2.3"), hwaddr,
                                     static_cast<const uint8_t*>(0), 0,
-                                    60, 0, 1));
+                                    60, 1000, 1));
         leases4->push_back(lease4);
 
         // Create deleted leases collection and put the lease there too.
         Lease4CollectionPtr deleted_leases4(new Lease4Collection());
         Lease4Ptr deleted_lease4(new Lease4(IOAddress("192.2.3.4"), hwaddr,
                                             static_cast<const uint8_t*>(0), 0,
-                                            60, 0, 1));
+                                            60, 1000, 1));
         deleted_leases4->push_back(deleted_lease4);
 
         // The communication state is the member of the HAServce object. We have to
@@ -906,11 +945,14 @@ public:
     /// @param my_state state of the server while lease updates are sent.
     /// @param wait_backup_ack indicates if the server should wait for the acknowledgment
     /// from the backup servers.
+    /// @param binary_leases indicates if the partner accepts the leases in the
+    /// compact binary encoding.
     void testSendLeaseUpdates6(std::function<void()> unpark_handler,
                                const bool should_fail,
                                const size_t num_updates,
                                const MyState& my_state = MyState(HA_LOAD_BALANCING_ST),
-                               const bool wait_backup_ack = false) {
+                               const bool wait_backup_ack = false,
+                               const bool binary_leases = false) {
         // Create HA configuration for 3 servers. This server is
         // server 1.
         HAConfigPtr config_storage = createValidConfiguration();
@@ -951,6 +993,7 @@ public:
         // Create HA service and schedule lease updates.
         createSTService(network_state_, config_storage, HAServerType::DHCPv6);
         service_->communication_state_ = state;
+        state->setPartnerBinaryLeasesSupported(binary_leases);
 
         service_->transition(my_state.state_, HAService::NOP_EVT);
 
@@ -1009,9 +1052,11 @@ public:
         config_storage->setHeartbeatDelay(1000);
         setBasicAuth(config_storage);
 
-        // Create a valid static response to the heartbeat command.
+        // Create a valid static response to the heartbeat command. The partner
+        // accepts the leases in the compact binary encoding.
         ElementPtr response_arguments = Element::createMap();
         response_arguments->set("state", Element::create(std::string("load-balancing")));
+        response_arguments->set("lease-encodings", Element::fromJSON("[ \"binary\" ]"));
 
         // Both server 2 and server 3 are configured to send this response.
         factory2_->getResponseCreator()->setArguments(response_arguments);
@@ -1050,11 +1095,14 @@ public:
         EXPECT_TRUE(factory_->getResponseCreator()->getReceivedRequests().empty());
         EXPECT_TRUE(factory3_->getResponseCreator()->getReceivedRequests().empty());
 
-        // If should pass, the communication state should be poked.
+        // If should pass, the communication state should be poked and
+        // should record that the partner accepts the binary encoding.
         if (should_pass) {
             EXPECT_TRUE(state->isPoked());
+            EXPECT_TRUE(state->isPartnerBinaryLeasesSupported());
         } else {
             EXPECT_FALSE(state->isPoked());
+            EXPECT_FALSE(state->isPartnerBinaryLeasesSupported());
         }
     }
 
@@ -1110,6 +1158,152 @@ public:
         EXPECT_TRUE(delete_request3);
     }
 
+    /// @brief Tests that DHCPv4 lease updates of several queries are sent
+    /// in lease4-bulk-apply commands when batching is enabled.
+    void testSendBatchedUpdates() {
+        // Start HTTP servers.
+        ASSERT_NO_THROW({
+                listener_->start();
+                listener2_->start();
+                listener3_->start();
+        });
+
+        // Batches of 2 lease updates, incomplete batches are sent after 10ms.
+        HAConfigPtr config_storage = createValidConfiguration();
+        config_storage->setLeaseUpdateBatchSize(2);
+        config_storage->setLeaseUpdateBatchDelay(10);
+        setBasicAuth(config_storage);
+
+        ParkingLotPtr parking_lot(new ParkingLot());
+        ParkingLotHandlePtr parking_lot_handle(new ParkingLotHandle(parking_lot));
+
+        // The first query allocates a lease and releases another one. This
+        // fills the first batch.
+        Pkt4Ptr query(new Pkt4(DHCPREQUEST, 1234));
+        HWAddrPtr hwaddr(new HWAddr(std::vector<uint8_t>(6, 1), HTYPE_ETHER));
+        Lease4CollectionPtr leases4(new Lease4Collection());
+        leases4->push_back(Lease4Ptr(new Lease4(IOAddress("192.1.2.3"), hwaddr,
+                                                static_cast<const uint8_t*>(0), 0,
+                                                60, 1000, 1)));
+        Lease4CollectionPtr deleted_leases4(new Lease4Collection());
+        deleted_leases4->push_back(Lease4Ptr(new Lease4(IOAddress("192.2.3.4"), hwaddr,
+                                                        static_cast<const uint8_t*>(0), 0,
+                                                        60, 1000, 1)));
+
+        // The second query allocates a lease which waits for the response
+        // to the first batch.
+        Pkt4Ptr query2(new Pkt4(DHCPREQUEST, 2345));
+        Lease4CollectionPtr leases4_2(new Lease4Collection());
+        leases4_2->push_back(Lease4Ptr(new Lease4(IOAddress("192.1.2.5"), hwaddr,
+                                                  static_cast<const uint8_t*>(0), 0,
+                                                  60, 1000, 1)));
+
+        createSTService(network_state_, config_storage);
+        service_->transition(HA_LOAD_BALANCING_ST, HAService::NOP_EVT);
+
+        // The lease updates are sent to the secondary server and the backup
+        // server but only the secondary server is expected to acknowledge them.
+        EXPECT_EQ(1, service_->asyncSendLeaseUpdates(query, leases4, deleted_leases4,
+                                                     parking_lot_handle));
+        EXPECT_EQ(1, service_->asyncSendLeaseUpdates(query2, leases4_2,
+                                                     Lease4CollectionPtr(new Lease4Collection()),
+                                                     parking_lot_handle));
+        EXPECT_EQ(1, service_->getPendingRequest(query));
+        EXPECT_EQ(1, service_->getPendingRequest(query2));
+
+        bool unpark_called = false;
+        bool unpark_called2 = false;
+        ASSERT_NO_THROW(parking_lot->park(query, [&unpark_called] { unpark_called = true; }));
+        ASSERT_NO_THROW(parking_lot->reference(query));
+        ASSERT_NO_THROW(parking_lot->park(query2, [&unpark_called2] { unpark_called2 = true; }));
+        ASSERT_NO_THROW(parking_lot->reference(query2));
+
+        ASSERT_NO_THROW(runIOService(TEST_TIMEOUT, [this]() {
+            return (service_->pendingRequestSize() == 0);
+        }));
+
+        // Both queries should have been unparked.
+        EXPECT_TRUE(unpark_called);
+        EXPECT_TRUE(unpark_called2);
+
+        // The server 2 should have received two lease4-bulk-apply commands.
+        EXPECT_EQ(2, factory2_->getResponseCreator()->getReceivedRequests().size());
+        EXPECT_TRUE(factory2_->getResponseCreator()->findRequest("lease4-bulk-apply",
+                                                                 "192.1.2.3",
+                                                                 "192.2.3.4"));
+        EXPECT_TRUE(factory2_->getResponseCreator()->findRequest("lease4-bulk-apply",
+                                                                 "192.1.2.5"));
+        EXPECT_FALSE(factory2_->getResponseCreator()->findRequest("lease4-update",
+                                                                  "192.1.2.3"));
+    }
+
+    /// @brief Tests that batched DHCPv4 lease updates do not wait for the
+    /// delay when no batch is waiting for the response of the partner.
+    void testSendBatchedUpdatesWithoutDelay() {
+        // Start HTTP servers.
+        ASSERT_NO_THROW({
+                listener_->start();
+                listener2_->start();
+                listener3_->start();
+        });
+
+        // Incomplete batches would be sent after a minute: longer than
+        // the test timeout.
+        HAConfigPtr config_storage = createValidConfiguration();
+        config_storage->setLeaseUpdateBatchSize(10);
+        config_storage->setLeaseUpdateBatchDelay(60000);
+        setBasicAuth(config_storage);
+
+        ParkingLotPtr parking_lot(new ParkingLot());
+        ParkingLotHandlePtr parking_lot_handle(new ParkingLotHandle(parking_lot));
+
+        HWAddrPtr hwaddr(new HWAddr(std::vector<uint8_t>(6, 1), HTYPE_ETHER));
+        Pkt4Ptr query(new Pkt4(DHCPREQUEST, 1234));
+        Lease4CollectionPtr leases4(new Lease4Collection());
+        leases4->push_back(Lease4Ptr(new Lease4(IOAddress("192.1.2.3"), hwaddr,
+                                                static_cast<const uint8_t*>(0), 0,
+                                                60, 1000, 1)));
+        Pkt4Ptr query2(new Pkt4(DHCPREQUEST, 2345));
+        Lease4CollectionPtr leases4_2(new Lease4Collection());
+        leases4_2->push_back(Lease4Ptr(new Lease4(IOAddress("192.1.2.5"), hwaddr,
+                                                  static_cast<const uint8_t*>(0), 0,
+                                                  60, 1000, 1)));
+
+        createSTService(network_state_, config_storage);
+        service_->transition(HA_LOAD_BALANCING_ST, HAService::NOP_EVT);
+
+        // The first query is alone: its batch is sent right away. The
+        // second query waits for the response to the first batch.
+        EXPECT_EQ(1, service_->asyncSendLeaseUpdates(query, leases4,
+                                                     Lease4CollectionPtr(new Lease4Collection()),
+                                                     parking_lot_handle));
+        EXPECT_EQ(1, service_->asyncSendLeaseUpdates(query2, leases4_2,
+                                                     Lease4CollectionPtr(new Lease4Collection()),
+                                                     parking_lot_handle));
+
+        bool unpark_called = false;
+        bool unpark_called2 = false;
+        ASSERT_NO_THROW(parking_lot->park(query, [&unpark_called] { unpark_called = true; }));
+        ASSERT_NO_THROW(parking_lot->reference(query));
+        ASSERT_NO_THROW(parking_lot->park(query2, [&unpark_called2] { unpark_called2 = true; }));
+        ASSERT_NO_THROW(parking_lot->reference(query2));
+
+        ASSERT_NO_THROW(runIOService(TEST_TIMEOUT, [this]() {
+            return (service_->pendingRequestSize() == 0);
+        }));
+
+        // Both queries should have been unparked before the delay.
+        EXPECT_TRUE(unpark_called);
+        EXPECT_TRUE(unpark_called2);
+
+        // The server 2 should have received two lease4-bulk-apply commands.
+        EXPECT_EQ(2, factory2_->getResponseCreator()->getReceivedRequests().size());
+        EXPECT_TRUE(factory2_->getResponseCreator()->findRequest("lease4-bulk-apply",
+                                                                 "192.1.2.3"));
+        EXPECT_TRUE(factory2_->getResponseCreator()->findRequest("lease4-bulk-apply",
+                                                                 "192.1.2.5"));
+    }
+
     /// @brief Tests that DHCPv4 lease updates are queued when the server is in the
     /// communication-recovery state and later sent before transitioning back to
     /// the load-balancing state.
@@ -1491,6 +1685,45 @@ public:
         EXPECT_TRUE(update_request3);
     }
 
+    /// @brief Tests that the DHCPv6 lease updates are sent in the compact
+    /// binary encoding to the partner advertising it.
+    void testSendBinaryUpdates6() {
+        // Start HTTP servers.
+        ASSERT_NO_THROW({
+                listener_->start();
+                listener2_->start();
+                listener3_->start();
+        });
+
+        // This flag will be set to true if unpark is called.
+        bool unpark_called = false;
+        testSendLeaseUpdates6([&unpark_called] { unpark_called = true; },
+                              false, 1, MyState(HA_LOAD_BALANCING_ST), false, true);
+        EXPECT_TRUE(unpark_called);
+
+        // The partner should have received the updated lease in the binary
+        // encoding. The deleted lease is still sent in JSON.
+        EXPECT_EQ(1, factory2_->getResponseCreator()->getReceivedRequests().size());
+        auto update_request2 =
+            factory2_->getResponseCreator()->findRequest("lease6-bulk-apply",
+                                                         "leases-binary",
+                                                         "2001:db8:1::efac");
+        ASSERT_TRUE(update_request2);
+        EXPECT_EQ(std::string::npos,
+                  update_request2->toString().find("2001:db8:1::cafe"));
+
+        // The backup server does not send heartbeats so it should have
+        // received the leases in JSON.
+        EXPECT_EQ(1, factory3_->getResponseCreator()->getReceivedRequests().size());
+        auto update_request3 =
+            factory3_->getResponseCreator()->findRequest("lease6-bulk-apply",
+                                                         "2001:db8:1::cafe",
+                                                         "2001:db8:1::efac");
+        ASSERT_TRUE(update_request3);
+        EXPECT_EQ(std::string::npos,
+                  update_request3->toString().find("leases-binary"));
+    }
+
     /// @brief Tests that DHCPv6 lease updates are queued when the server is in the
     /// communication-recovery state and later sent before transitioning back to
     /// the load-balancing state.
@@ -2138,6 +2371,79 @@ TEST_F(HAServiceTest, sendSuccessfulUpdatesMultiThreading) {
     testSendSuccessfulUpdates();
 }
 
+// Test scenario when the lease updates of several queries are batched.
+TEST_F(HAServiceTest, sendBatchedUpdates) {
+    testSendBatchedUpdates();
+}
+
+// Test scenario when the lease updates of several queries are batched.
+TEST_F(HAServiceTest, sendBatchedUpdatesMultiThreading) {
+    MultiThreadingMgr::instance().setMode(true);
+    testSendBatchedUpdates();
+}
+
+// Test scenario when the batched lease updates of a query are sent without
+// waiting for the delay.
+TEST_F(HAServiceTest, sendBatchedUpdatesWithoutDelay) {
+    testSendBatchedUpdatesWithoutDelay();
+}
+
+// Test scenario when the batched lease updates of a query are sent without
+// waiting for the delay.
+TEST_F(HAServiceTest, sendBatchedUpdatesWithoutDelayMultiThreading) {
+    MultiThreadingMgr::instance().setMode(true);
+    testSendBatchedUpdatesWithoutDelay();
+}
+
+// Test that the queries waiting for an incomplete batch of lease updates
+// are dropped when the service is destroyed.
+TEST_F(HAServiceTest, dropBatchedUpdatesOnDestroy) {
+    // The incomplete batches would be sent after 10s.
+    HAConfigPtr config_storage = createValidConfiguration();
+    config_storage->setLeaseUpdateBatchSize(10);
+    config_storage->setLeaseUpdateBatchDelay(10000);
+
+    ParkingLotPtr parking_lot(new ParkingLot());
+    ParkingLotHandlePtr parking_lot_handle(new ParkingLotHandle(parking_lot));
+
+    HWAddrPtr hwaddr(new HWAddr(std::vector<uint8_t>(6, 1), HTYPE_ETHER));
+    Pkt4Ptr query(new Pkt4(DHCPREQUEST, 1234));
+    Lease4CollectionPtr leases4(new Lease4Collection());
+    leases4->push_back(Lease4Ptr(new Lease4(IOAddress("192.1.2.3"), hwaddr,
+                                            static_cast<const uint8_t*>(0), 0,
+                                            60, 1000, 1)));
+    Pkt4Ptr query2(new Pkt4(DHCPREQUEST, 2345));
+    Lease4CollectionPtr leases4_2(new Lease4Collection());
+    leases4_2->push_back(Lease4Ptr(new Lease4(IOAddress("192.1.2.5"), hwaddr,
+                                              static_cast<const uint8_t*>(0), 0,
+                                              60, 1000, 1)));
+
+    createSTService(network_state_, config_storage);
+    service_->transition(HA_LOAD_BALANCING_ST, HAService::NOP_EVT);
+
+    // The batch of the first query is sent right away. The second query
+    // waits in an incomplete batch for the response to the first one.
+    EXPECT_EQ(1, service_->asyncSendLeaseUpdates(query, leases4,
+                                                 Lease4CollectionPtr(new Lease4Collection()),
+                                                 parking_lot_handle));
+    EXPECT_EQ(1, service_->asyncSendLeaseUpdates(query2, leases4_2,
+                                                 Lease4CollectionPtr(new Lease4Collection()),
+                                                 parking_lot_handle));
+    EXPECT_EQ(1, service_->getPendingRequest(query2));
+
+    bool unpark_called2 = false;
+    ASSERT_NO_THROW(parking_lot->park(query, [] { }));
+    ASSERT_NO_THROW(parking_lot->reference(query));
+    ASSERT_NO_THROW(parking_lot->park(query2, [&unpark_called2] { unpark_called2 = true; }));
+    ASSERT_NO_THROW(parking_lot->reference(query2));
+    ASSERT_EQ(2, parking_lot->size());
+
+    // Destroying the service drops the second query.
+    service_.reset();
+    EXPECT_FALSE(unpark_called2);
+    EXPECT_EQ(1, parking_lot->size());
+}
+
 // Test scenario when lease updates are queued in the communication-recovery
 // state for later send.
 TEST_F(HAServiceTest, sendUpdatesCommunicationRecovery) {
@@ -2307,6 +2613,17 @@ TEST_F(HAServiceTest, sendSuccessfulUpdates6MultiThreading) {
     testSendSuccessfulUpdates6();
 }
 
+// Test scenario when the lease updates are sent in the binary encoding.
+TEST_F(HAServiceTest, sendBinaryUpdates6) {
+    testSendBinaryUpdates6();
+}
+
+// Test scenario when the lease updates are sent in the binary encoding.
+TEST_F(HAServiceTest, sendBinaryUpdates6MultiThreading) {
+    MultiThreadingMgr::instance().setMode(true);
+    testSendBinaryUpdates6();
+}
+
 // Test scenario when lease updates are queued in the communication-recovery
 // state for later send. Then, the partner refuses lease updates causing the
 // server to transition to the waiting state.
@@ -2576,6 +2893,11 @@ TEST_F(HAServiceTest, processHeartbeat) {
     ASSERT_TRUE(unsent_update_count);
     EXPECT_EQ(Element::integer, unsent_update_count->getType());
     EXPECT_EQ(unsent_updates, static_cast<uint64_t>(unsent_update_count->intValue()));
+
+    // The response should advertise the compact binary encoding of the leases.
+    ConstElementPtr encodings = args->get("lease-encodings");
+    ASSERT_TRUE(encodings);
+    EXPECT_EQ("[ \"binary\" ]", encodings->str());
 }
 
 // This test verifies that the correct value of the heartbeat-delay is used.
@@ -2780,6 +3102,12 @@ TEST_F(HAServiceTest, asyncSyncLeases) {
         return (!LeaseMgrFactory::instance().getLeases4(SubnetID(10)).empty());
     }));
 
+    // The partner did not advertise the binary encoding so the leases
+    // were requested in JSON.
+    EXPECT_TRUE(factory2_->getResponseCreator()->findRequest("lease4-get-page", ""));
+    EXPECT_FALSE(factory2_->getResponseCreator()->findRequest("lease4-get-page",
+                                                              "\"encoding\""));
+
     // Check if all leases have been stored in the local database.
     for (size_t i = 0; i < leases4_.size(); ++i) {
         if (i == 1) {
@@ -2823,6 +3151,180 @@ TEST_F(HAServiceTest, asyncSyncLeases) {
     }
 }
 
+// This test verifies that IPv4 leases returned by the peer in the compact
+// binary encoding are inserted or updated in the local lease database.
+TEST_F(HAServiceTest, asyncSyncLeasesBinary) {
+    // Create lease manager.
+    ASSERT_NO_THROW(LeaseMgrFactory::create("universe=4 type=memfile persist=false"));
+
+    // Create IPv4 leases which will be fetched from the other server.
+    ASSERT_NO_THROW(generateTestLeases4());
+
+    // Add a lease to the database with a shorter valid lifetime and make
+    // the partner's lease more recent so it is updated.
+    Lease4Ptr lease_to_add(new Lease4(*leases4_[0]));
+    --lease_to_add->valid_lft_;
+    LeaseMgrFactory::instance().addLease(lease_to_add);
+    ++leases4_[0]->cltt_;
+
+    // Create HA configuration.
+    HAConfigPtr config_storage = createValidConfiguration();
+    setBasicAuth(config_storage);
+
+    // Return the leases in the binary encoding.
+    createPagedSyncResponses4(true);
+
+    // Start the servers.
+    ASSERT_NO_THROW({
+        listener_->start();
+        listener2_->start();
+        listener3_->start();
+    });
+
+    TestHAService service(io_service_, network_state_, config_storage);
+    config_storage->setHeartbeatDelay(0);
+
+    // The partner advertised the binary encoding.
+    service.communication_state_->setPartnerBinaryLeasesSupported(true);
+
+    // Start fetching leases asynchronously.
+    ASSERT_NO_THROW(service.asyncSyncLeases());
+
+    // Run IO service to actually perform the transaction.
+    ASSERT_NO_THROW(runIOService(TEST_TIMEOUT, [this]() {
+        return (LeaseMgrFactory::instance().getLease4(leases4_.back()->addr_) != 0);
+    }));
+
+    // The leases were requested in the binary encoding.
+    EXPECT_TRUE(factory2_->getResponseCreator()->findRequest("lease4-get-page",
+                                                             "\"encoding\": \"binary\""));
+
+    // Check if all leases have been stored in the local database.
+    for (auto const& lease : leases4_) {
+        Lease4Ptr existing_lease = LeaseMgrFactory::instance().getLease4(lease->addr_);
+        ASSERT_TRUE(existing_lease) << "lease " << lease->addr_.toText()
+                                    << " not in the lease database";
+        EXPECT_EQ(lease->cltt_, existing_lease->cltt_);
+        EXPECT_EQ(lease->valid_lft_, existing_lease->valid_lft_);
+    }
+}
+
+// This test verifies that a stream of the lease database synchronization
+// fetches the leases of its address range only.
+TEST_F(HAServiceTest, asyncSyncLeasesRange) {
+    // Create lease manager.
+    ASSERT_NO_THROW(LeaseMgrFactory::create("universe=4 type=memfile persist=false"));
+
+    // Create IPv4 leases which will be fetched from the other server.
+    ASSERT_NO_THROW(generateTestLeases4());
+
+    // Create HA configuration.
+    HAConfigPtr config_storage = createValidConfiguration();
+    setBasicAuth(config_storage);
+
+    // The range begins after the lease #2 and ends with the lease #6. The
+    // second page holds the leases #6 to #8: the synchronization of the
+    // range ends with this page.
+    ElementPtr response_arguments = Element::createMap();
+    response_arguments->set("leases", getTestLeases4AsJson(3, 6));
+    factory2_->getResponseCreator()->setArguments("lease4-get-page", response_arguments);
+    response_arguments = Element::createMap();
+    response_arguments->set("leases", getTestLeases4AsJson(6, 9));
+    factory2_->getResponseCreator()->setArguments("lease4-get-page", response_arguments);
+
+    // Start the servers.
+    ASSERT_NO_THROW({
+        listener_->start();
+        listener2_->start();
+        listener3_->start();
+    });
+
+    TestHAService service(io_service_, network_state_, config_storage);
+    config_storage->setHeartbeatDelay(0);
+
+    // Fetch the leases of the range.
+    LeaseSyncRange range(leases4_[2]->addr_, leases4_[6]->addr_);
+    service.sync_progress_.start(1);
+    bool done = false;
+    bool sync_success = false;
+    ASSERT_NO_THROW(service.asyncSyncLeasesRange(*service.client_, "server2", 20, range,
+                                                 LeasePtr(),
+                                                 [&](const bool success,
+                                                     const std::string&,
+                                                     const bool) {
+        done = true;
+        sync_success = success;
+    }));
+
+    ASSERT_NO_THROW(runIOService(TEST_TIMEOUT, [&done]() {
+        return (done);
+    }));
+    EXPECT_TRUE(sync_success);
+
+    // The first page was fetched from the beginning of the range.
+    EXPECT_TRUE(factory2_->getResponseCreator()->findRequest("lease4-get-page",
+                                                             "\"from\": \"192.0.5.1\""));
+
+    // Only the leases of the range were stored in the local database.
+    for (size_t i = 0; i < leases4_.size(); ++i) {
+        Lease4Ptr existing_lease = LeaseMgrFactory::instance().getLease4(leases4_[i]->addr_);
+        if ((i >= 3) && (i <= 6)) {
+            EXPECT_TRUE(existing_lease) << "lease " << leases4_[i]->addr_.toText()
+                                        << " not in the lease database";
+        } else {
+            EXPECT_FALSE(existing_lease) << "lease " << leases4_[i]->addr_.toText()
+                                         << " was inserted into the database";
+        }
+    }
+
+    // The progress of the synchronization is reported by status-get.
+    service.sync_progress_.streamCompleted(true, "", true);
+    ConstElementPtr status = service.processStatusGet();
+    ASSERT_TRUE(status);
+    ConstElementPtr local = status->get("local");
+    ASSERT_TRUE(local);
+    ConstElementPtr progress = local->get("sync-progress");
+    ASSERT_TRUE(progress);
+    EXPECT_FALSE(progress->get("in-progress")->boolValue());
+    EXPECT_EQ(1, progress->get("streams")->intValue());
+    EXPECT_EQ(1, progress->get("completed-streams")->intValue());
+    EXPECT_EQ(2, progress->get("pages")->intValue());
+    EXPECT_EQ(4, progress->get("leases")->intValue());
+}
+
+// This test verifies that the address space is split in several ranges
+// only when the HTTP client runs in the multi-threaded mode.
+TEST_F(HAServiceTest, createSyncRanges) {
+    // Configure a subnet with a pool.
+    Subnet4Ptr subnet(new Subnet4(IOAddress("192.0.2.0"), 24, 30, 40, 60, 1));
+    subnet->addPool(Pool4Ptr(new Pool4(IOAddress("192.0.2.0"), IOAddress("192.0.2.255"))));
+    CfgMgr::instance().getCurrentCfg()->getCfgSubnets4()->add(subnet);
+
+    HAConfigPtr config_storage = createValidConfiguration();
+    config_storage->setSyncStreams(4);
+    TestHAService service(io_service_, network_state_, config_storage);
+
+    // The single-threaded client fetches all leases in one stream.
+    HttpClient st_client(*io_service_);
+    LeaseSyncRanges ranges = service.createSyncRanges(st_client);
+    ASSERT_EQ(1, ranges.size());
+    EXPECT_EQ("0.0.0.0", ranges[0].from_.toText());
+    EXPECT_EQ("255.255.255.255", ranges[0].to_.toText());
+
+    // The multi-threaded client fetches the leases in parallel, in no more
+    // streams than it has threads.
+    MultiThreadingMgr::instance().setMode(true);
+    HttpClient mt_client(*io_service_, 2, true);
+    ranges = service.createSyncRanges(mt_client);
+    ASSERT_EQ(2, ranges.size());
+    EXPECT_EQ("0.0.0.0", ranges[0].from_.toText());
+    EXPECT_EQ("192.0.2.127", ranges[0].to_.toText());
+    EXPECT_EQ("192.0.2.127", ranges[1].from_.toText());
+    EXPECT_EQ("255.255.255.255", ranges[1].to_.toText());
+
+    CfgMgr::instance().clear();
+}
+
 // This test verifies that IPv4 leases can be fetched from the peer and inserted
 // or updated in the local lease database.
 TEST_F(HAServiceTest, asyncSyncLeasesAuthorized) {
@@ -3045,6 +3547,53 @@ TEST_F(HAServiceTest, asyncSyncLeasesServerUnauthorized) {
     ASSERT_NO_THROW(runIOService(1000));
 }
 
+// This test verifies that IPv6 leases returned by the peer in the compact
+// binary encoding are inserted in the local lease database.
+TEST_F(HAServiceTest, asyncSyncLeases6Binary) {
+    // Create lease manager.
+    ASSERT_NO_THROW(LeaseMgrFactory::create("universe=6 type=memfile persist=false"));
+
+    // Create IPv6 leases which will be fetched from the other server.
+    ASSERT_NO_THROW(generateTestLeases6());
+
+    // Create HA configuration.
+    HAConfigPtr config_storage = createValidConfiguration();
+    setBasicAuth(config_storage);
+
+    // Return the leases in the binary encoding.
+    createPagedSyncResponses6(true);
+
+    // Start the servers.
+    ASSERT_NO_THROW({
+        listener_->start();
+        listener2_->start();
+        listener3_->start();
+    });
+
+    TestHAService service(io_service_, network_state_, config_storage,
+                          HAServerType::DHCPv6);
+    config_storage->setHeartbeatDelay(0);
+
+    // Start fetching leases asynchronously.
+    ASSERT_NO_THROW(service.asyncSyncLeases());
+
+    // Run IO service to actually perform the transaction.
+    ASSERT_NO_THROW(runIOService(TEST_TIMEOUT, [this]() {
+        return (LeaseMgrFactory::instance().getLease6(Lease::TYPE_NA,
+                                                      leases6_.back()->addr_) != 0);
+    }));
+
+    // Check if all leases have been stored in the local database.
+    for (auto const& lease : leases6_) {
+        Lease6Ptr existing_lease = LeaseMgrFactory::instance().getLease6(Lease::TYPE_NA,
+                                                                         lease->addr_);
+        ASSERT_TRUE(existing_lease) << "lease " << lease->addr_.toText()
+                                    << " not in the lease database";
+        EXPECT_EQ(lease->cltt_, existing_lease->cltt_);
+        EXPECT_EQ(lease->iaid_, existing_lease->iaid_);
+    }
+}
+
 // This test verifies that IPv6 leases can be fetched from the peer and inserted
 // or updated in the local lease database.
 TEST_F(HAServiceTest, asyncSyncLeases6) {
@@ -0,0 +1,168 @@
+// Copyright (C) 2022 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <lease_sync.h>
+#include <asiolink/io_address.h>
+#include <dhcpsrv/pool.h>
+#include <dhcpsrv/subnet.h>
+
+#include <gtest/gtest.h>
+
+using namespace isc::asiolink;
+using namespace isc::data;
+using namespace isc::dhcp;
+using namespace isc::ha;
+
+namespace {
+
+/// @brief Checks a range.
+///
+/// @param range The range.
+/// @param from Expected address after which the range begins.
+/// @param to Expected highest address of the range.
+void checkRange(const LeaseSyncRange& range, const std::string& from,
+                const std::string& to) {
+    EXPECT_EQ(from, range.from_.toText());
+    EXPECT_EQ(to, range.to_.toText());
+}
+
+// This test verifies that the range checks if an address belongs to it.
+TEST(LeaseSyncRangeTest, inRange) {
+    LeaseSyncRange first(IOAddress("0.0.0.0"), IOAddress("192.0.2.10"));
+    EXPECT_TRUE(first.inRange(IOAddress("0.0.0.0")));
+    EXPECT_TRUE(first.inRange(IOAddress("192.0.2.10")));
+    EXPECT_FALSE(first.inRange(IOAddress("192.0.2.11")));
+
+    LeaseSyncRange second(IOAddress("192.0.2.10"), IOAddress("255.255.255.255"));
+    EXPECT_FALSE(second.inRange(IOAddress("192.0.2.10")));
+    EXPECT_TRUE(second.inRange(IOAddress("192.0.2.11")));
+    EXPECT_TRUE(second.inRange(IOAddress("255.255.255.255")));
+
+    LeaseSyncRange range6(IOAddress("2001:db8:1::"), IOAddress("2001:db8:2::"));
+    EXPECT_FALSE(range6.inRange(IOAddress("2001:db8:1::")));
+    EXPECT_TRUE(range6.inRange(IOAddress("2001:db8:1::1")));
+    EXPECT_TRUE(range6.inRange(IOAddress("2001:db8:2::")));
+    EXPECT_FALSE(range6.inRange(IOAddress("2001:db8:2::1")));
+}
+
+// This test verifies that the IPv4 address space is split in ranges
+// holding the same share of the pools.
+TEST(LeaseSyncRangeTest, createRanges4) {
+    CfgSubnets4Ptr subnets(new CfgSubnets4());
+
+    // Without pools there is a single range.
+    LeaseSyncRanges ranges = createLeaseSyncRanges4(subnets, 4);
+    ASSERT_EQ(1, ranges.size());
+    checkRange(ranges[0], "0.0.0.0", "255.255.255.255");
+
+    // Two subnets with pools of 100 addresses.
+    Subnet4Ptr subnet(new Subnet4(IOAddress("192.0.2.0"), 24, 30, 40, 60, 1));
+    subnet->addPool(Pool4Ptr(new Pool4(IOAddress("192.0.2.0"), IOAddress("192.0.2.99"))));
+    subnets->add(subnet);
+    subnet.reset(new Subnet4(IOAddress("10.0.0.0"), 8, 30, 40, 60, 2));
+    subnet->addPool(Pool4Ptr(new Pool4(IOAddress("10.0.0.0"), IOAddress("10.0.0.99"))));
+    subnets->add(subnet);
+
+    // A single stream fetches all leases.
+    ranges = createLeaseSyncRanges4(subnets, 1);
+    ASSERT_EQ(1, ranges.size());
+    checkRange(ranges[0], "0.0.0.0", "255.255.255.255");
+
+    // Each of the four ranges holds 50 addresses of the pools.
+    ranges = createLeaseSyncRanges4(subnets, 4);
+    ASSERT_EQ(4, ranges.size());
+    checkRange(ranges[0], "0.0.0.0", "10.0.0.49");
+    checkRange(ranges[1], "10.0.0.49", "192.0.1.255");
+    checkRange(ranges[2], "192.0.1.255", "192.0.2.49");
+    checkRange(ranges[3], "192.0.2.49", "255.255.255.255");
+
+    // There are no more ranges than addresses in the pools.
+    subnets.reset(new CfgSubnets4());
+    subnet.reset(new Subnet4(IOAddress("192.0.2.0"), 24, 30, 40, 60, 1));
+    subnet->addPool(Pool4Ptr(new Pool4(IOAddress("192.0.2.1"), IOAddress("192.0.2.2"))));
+    subnets->add(subnet);
+    ranges = createLeaseSyncRanges4(subnets, 8);
+    ASSERT_EQ(2, ranges.size());
+    checkRange(ranges[0], "0.0.0.0", "192.0.2.1");
+    checkRange(ranges[1], "192.0.2.1", "255.255.255.255");
+}
+
+// This test verifies that the IPv6 address space is split in ranges
+// at the beginning of the pools.
+TEST(LeaseSyncRangeTest, createRanges6) {
+    CfgSubnets6Ptr subnets(new CfgSubnets6());
+
+    // Without pools there is a single range.
+    LeaseSyncRanges ranges = createLeaseSyncRanges6(subnets, 2);
+    ASSERT_EQ(1, ranges.size());
+    checkRange(ranges[0], "::", "ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff");
+
+    // Two subnets with an address pool each and a prefix pool.
+    Subnet6Ptr subnet(new Subnet6(IOAddress("2001:db8:2::"), 64, 30, 40, 50, 60, 1));
+    subnet->addPool(Pool6Ptr(new Pool6(Lease::TYPE_NA, IOAddress("2001:db8:2::"), 64)));
+    subnet->addPool(Pool6Ptr(new Pool6(Lease::TYPE_PD, IOAddress("3000::"), 48, 56)));
+    subnets->add(subnet);
+    subnet.reset(new Subnet6(IOAddress("2001:db8:1::"), 64, 30, 40, 50, 60, 2));
+    subnet->addPool(Pool6Ptr(new Pool6(Lease::TYPE_NA, IOAddress("2001:db8:1::"), 64)));
+    subnets->add(subnet);
+
+    ranges = createLeaseSyncRanges6(subnets, 2);
+    ASSERT_EQ(2, ranges.size());
+    checkRange(ranges[0], "::", "2001:db8:2::");
+    checkRange(ranges[1], "2001:db8:2::", "ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff");
+
+    // There are no more ranges than pools.
+    ranges = createLeaseSyncRanges6(subnets, 8);
+    ASSERT_EQ(3, ranges.size());
+    checkRange(ranges[0], "::", "2001:db8:2::");
+    checkRange(ranges[1], "2001:db8:2::", "3000::");
+    checkRange(ranges[2], "3000::", "ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff");
+}
+
+// This test verifies that the progress of the synchronization is recorded.
+TEST(LeaseSyncProgressTest, progress) {
+    LeaseSyncProgress progress;
+    EXPECT_FALSE(progress.isStarted());
+
+    progress.start(2);
+    EXPECT_TRUE(progress.isStarted());
+    progress.pageReceived(3);
+    progress.pageReceived(1);
+
+    ElementPtr json = progress.toElement();
+    EXPECT_TRUE(json->get("in-progress")->boolValue());
+    EXPECT_EQ(2, json->get("streams")->intValue());
+    EXPECT_EQ(0, json->get("completed-streams")->intValue());
+    EXPECT_EQ(2, json->get("pages")->intValue());
+    EXPECT_EQ(4, json->get("leases")->intValue());
+    EXPECT_TRUE(json->get("duration"));
+
+    // The first stream completes successfully.
+    EXPECT_FALSE(progress.streamCompleted(true, "", true));
+    EXPECT_FALSE(progress.hasFailed());
+    EXPECT_TRUE(progress.isDHCPDisabled());
+
+    // The second and last stream fails.
+    EXPECT_TRUE(progress.streamCompleted(false, "boom", false));
+    EXPECT_TRUE(progress.hasFailed());
+    EXPECT_EQ("boom", progress.getErrorMessage());
+    EXPECT_TRUE(progress.isDHCPDisabled());
+
+    json = progress.toElement();
+    EXPECT_FALSE(json->get("in-progress")->boolValue());
+    EXPECT_EQ(2, json->get("completed-streams")->intValue());
+
+    // The next synchronization starts afresh.
+    progress.start(1);
+    EXPECT_FALSE(progress.hasFailed());
+    EXPECT_EQ("", progress.getErrorMessage());
+    EXPECT_FALSE(progress.isDHCPDisabled());
+    EXPECT_EQ(0, progress.toElement()->get("pages")->intValue());
+}
+
+} // end of anonymous namespace
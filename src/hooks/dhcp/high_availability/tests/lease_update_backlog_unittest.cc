@@ -1,4 +1,4 @@
-// Copyright (C) 2020-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2020-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -32,7 +32,7 @@ TEST(LeaseUpdateBacklogTest, pushAndPop) {
         IOAddress address(i + 1);
         HWAddrPtr hwaddr = boost::make_shared<HWAddr>(std::vector<uint8_t>(6, static_cast<uint8_t>(i)),
                                                       HTYPE_ETHER);
-        Lease4Ptr lease = boost::make_shared<Lease4>(address, hwaddr, ClientIdPtr(), 60, 0, 1);
+        Lease4Ptr lease = boost::make_shared<Lease4>(address, hwaddr, ClientIdPtr(), 60, 1000, 1);
         // Some lease updates have type "Add", some have type "Delete".
         ASSERT_TRUE(backlog.push(i % 2 ? LeaseUpdateBacklog::ADD : LeaseUpdateBacklog::DELETE, lease));
         EXPECT_FALSE(backlog.wasOverflown());
@@ -42,7 +42,7 @@ TEST(LeaseUpdateBacklogTest, pushAndPop) {
     IOAddress address("192.0.2.0");
     HWAddrPtr hwaddr = boost::make_shared<HWAddr>(std::vector<uint8_t>(6, static_cast<uint8_t>(0xA)),
                                                   HTYPE_ETHER);
-    Lease4Ptr lease = boost::make_shared<Lease4>(address, hwaddr, ClientIdPtr(), 60, 0, 1);
+    Lease4Ptr lease = boost::make_shared<Lease4>(address, hwaddr, ClientIdPtr(), 60, 1000, 1);
     ASSERT_FALSE(backlog.push(LeaseUpdateBacklog::ADD, lease));
     EXPECT_TRUE(backlog.wasOverflown());
 
@@ -74,7 +74,7 @@ TEST(LeaseUpdateBacklogTest, clear) {
         IOAddress address(i + 1);
         HWAddrPtr hwaddr = boost::make_shared<HWAddr>(std::vector<uint8_t>(6, static_cast<uint8_t>(i)),
                                                       HTYPE_ETHER);
-        Lease4Ptr lease = boost::make_shared<Lease4>(address, hwaddr, ClientIdPtr(), 60, 0, 1);
+        Lease4Ptr lease = boost::make_shared<Lease4>(address, hwaddr, ClientIdPtr(), 60, 1000, 1);
         ASSERT_TRUE(backlog.push(LeaseUpdateBacklog::ADD, lease));
     }
 
@@ -88,4 +88,123 @@ TEST(LeaseUpdateBacklogTest, clear) {
     EXPECT_EQ(0, backlog.size());
 }
 
+// This test verifies that the updates of the same lease are coalesced.
+TEST(LeaseUpdateBacklogTest, coalesce) {
+    // Create the queue with limit of 2 lease updates.
+    LeaseUpdateBacklog backlog(2);
+
+    HWAddrPtr hwaddr = boost::make_shared<HWAddr>(std::vector<uint8_t>(6, 1),
+                                                  HTYPE_ETHER);
+    Lease4Ptr lease1 = boost::make_shared<Lease4>(IOAddress("192.0.2.1"), hwaddr,
+                                                  ClientIdPtr(), 60, 1000, 1);
+    Lease4Ptr lease2 = boost::make_shared<Lease4>(IOAddress("192.0.2.2"), hwaddr,
+                                                  ClientIdPtr(), 60, 1000, 1);
+    ASSERT_TRUE(backlog.push(LeaseUpdateBacklog::ADD, lease1));
+    ASSERT_TRUE(backlog.push(LeaseUpdateBacklog::ADD, lease2));
+
+    // Renew the first lease many times and eventually delete it. The
+    // queue is full but the updates replace the queued one.
+    for (auto i = 0; i < 10; ++i) {
+        Lease4Ptr renewed = boost::make_shared<Lease4>(*lease1);
+        renewed->cltt_ += i;
+        ASSERT_TRUE(backlog.push(LeaseUpdateBacklog::ADD, renewed));
+    }
+    Lease4Ptr deleted = boost::make_shared<Lease4>(*lease1);
+    ASSERT_TRUE(backlog.push(LeaseUpdateBacklog::DELETE, deleted));
+    EXPECT_EQ(2, backlog.size());
+    EXPECT_FALSE(backlog.wasOverflown());
+
+    // A different lease still overflows the queue.
+    Lease4Ptr lease3 = boost::make_shared<Lease4>(IOAddress("192.0.2.3"), hwaddr,
+                                                  ClientIdPtr(), 60, 1000, 1);
+    ASSERT_FALSE(backlog.push(LeaseUpdateBacklog::ADD, lease3));
+    EXPECT_TRUE(backlog.wasOverflown());
+
+    // The latest update of the first lease keeps its position.
+    LeaseUpdateBacklog::OpType op_type;
+    LeasePtr lease = backlog.pop(op_type);
+    ASSERT_TRUE(lease);
+    EXPECT_EQ("192.0.2.1", lease->addr_.toText());
+    EXPECT_EQ(LeaseUpdateBacklog::DELETE, op_type);
+    lease = backlog.pop(op_type);
+    ASSERT_TRUE(lease);
+    EXPECT_EQ("192.0.2.2", lease->addr_.toText());
+    EXPECT_EQ(LeaseUpdateBacklog::ADD, op_type);
+    EXPECT_FALSE(backlog.pop(op_type));
+}
+
+// This test verifies that IPv6 updates are coalesced by lease type and
+// address.
+TEST(LeaseUpdateBacklogTest, coalesce6) {
+    LeaseUpdateBacklog backlog(5);
+
+    DuidPtr duid = boost::make_shared<DUID>(std::vector<uint8_t>(8, 2));
+    Lease6Ptr na = boost::make_shared<Lease6>(Lease::TYPE_NA, IOAddress("2001:db8:1::"),
+                                              duid, 1, 50, 60, 1);
+    Lease6Ptr pd = boost::make_shared<Lease6>(Lease::TYPE_PD, IOAddress("2001:db8:1::"),
+                                              duid, 1, 50, 60, 1, HWAddrPtr(), 64);
+    ASSERT_TRUE(backlog.push(LeaseUpdateBacklog::ADD, na));
+    ASSERT_TRUE(backlog.push(LeaseUpdateBacklog::ADD, pd));
+    ASSERT_TRUE(backlog.push(LeaseUpdateBacklog::DELETE, na));
+    EXPECT_EQ(2, backlog.size());
+}
+
+// This test verifies that the queue holds snapshots of the leases.
+TEST(LeaseUpdateBacklogTest, snapshot) {
+    LeaseUpdateBacklog backlog(5);
+
+    HWAddrPtr hwaddr = boost::make_shared<HWAddr>(std::vector<uint8_t>(6, 1),
+                                                  HTYPE_ETHER);
+    Lease4Ptr lease4 = boost::make_shared<Lease4>(IOAddress("192.0.2.1"), hwaddr,
+                                                  ClientIdPtr(), 60, 1000, 1);
+    lease4->hostname_ = "myhost.example.org.";
+    DuidPtr duid = boost::make_shared<DUID>(std::vector<uint8_t>(8, 2));
+    Lease6Ptr lease6 = boost::make_shared<Lease6>(Lease::TYPE_PD, IOAddress("3000::"),
+                                                  duid, 1, 50, 60, 1, HWAddrPtr(), 56);
+    ASSERT_TRUE(backlog.push(LeaseUpdateBacklog::ADD, lease4));
+    ASSERT_TRUE(backlog.push(LeaseUpdateBacklog::DELETE, lease6));
+
+    // Changing the leases after they were queued does not affect the
+    // queued updates.
+    Lease4 original4(*lease4);
+    Lease6 original6(*lease6);
+    lease4->hostname_ = "other.example.org.";
+    lease6->valid_lft_ = 0;
+
+    LeaseUpdateBacklog::OpType op_type;
+    Lease4Ptr popped4 = boost::dynamic_pointer_cast<Lease4>(backlog.pop(op_type));
+    ASSERT_TRUE(popped4);
+    EXPECT_EQ(LeaseUpdateBacklog::ADD, op_type);
+    EXPECT_TRUE(original4 == *popped4);
+
+    Lease6Ptr popped6 = boost::dynamic_pointer_cast<Lease6>(backlog.pop(op_type));
+    ASSERT_TRUE(popped6);
+    EXPECT_EQ(LeaseUpdateBacklog::DELETE, op_type);
+    EXPECT_TRUE(original6 == *popped6);
+}
+
+// This test verifies that the updates of the leases which can't be
+// restored from their snapshots are skipped.
+TEST(LeaseUpdateBacklogTest, skipInvalid) {
+    LeaseUpdateBacklog backlog(5);
+
+    HWAddrPtr hwaddr = boost::make_shared<HWAddr>(std::vector<uint8_t>(6, 1),
+                                                  HTYPE_ETHER);
+    // The lease without client last transmission time is invalid.
+    Lease4Ptr invalid = boost::make_shared<Lease4>(IOAddress("192.0.2.1"), hwaddr,
+                                                   ClientIdPtr(), 60, 0, 1);
+    Lease4Ptr valid = boost::make_shared<Lease4>(IOAddress("192.0.2.2"), hwaddr,
+                                                 ClientIdPtr(), 60, 1000, 1);
+    ASSERT_TRUE(backlog.push(LeaseUpdateBacklog::ADD, invalid));
+    ASSERT_TRUE(backlog.push(LeaseUpdateBacklog::ADD, valid));
+    EXPECT_EQ(2, backlog.size());
+
+    LeaseUpdateBacklog::OpType op_type;
+    LeasePtr lease = backlog.pop(op_type);
+    ASSERT_TRUE(lease);
+    EXPECT_EQ("192.0.2.2", lease->addr_.toText());
+    EXPECT_FALSE(backlog.pop(op_type));
+    EXPECT_EQ(0, backlog.size());
+}
+
 } // end of anonymous namespace
@@ -1,4 +1,4 @@
-// Copyright (C) 2017-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2017-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -13,6 +13,7 @@
 #include <database/db_exceptions.h>
 #include <dhcpsrv/cfgmgr.h>
 #include <dhcpsrv/dhcpsrv_exceptions.h>
+#include <dhcpsrv/lease_codec.h>
 #include <dhcpsrv/lease_mgr.h>
 #include <dhcpsrv/lease_mgr_factory.h>
 #include <dhcpsrv/ncr_generator.h>
@@ -32,8 +33,11 @@
 
 #include <boost/scoped_ptr.hpp>
 #include <boost/algorithm/string.hpp>
+#include <map>
+#include <set>
 #include <string>
 #include <sstream>
+#include <utility>
 
 using namespace isc::dhcp;
 using namespace isc::data;
@@ -45,6 +49,49 @@ using namespace isc::stats;
 using namespace isc::util;
 using namespace std;
 
+namespace {
+
+/// @brief Number of leases read at once by lease4-get-all and lease6-get-all
+/// when all leases are returned.
+const size_t LEASE_GET_ALL_PAGE_SIZE = 1000;
+
+/// @brief Returns a function reading all leases page by page.
+///
+/// The leases are ordered by address: the next page starts after the
+/// address of the last lease of the previous page.
+///
+/// @param v4 true for IPv4 leases, false for IPv6 leases.
+/// @return the function reading the leases converted to elements.
+StreamedListElement::PageReader
+getAllLeasesPageReader(const bool v4) {
+    return ([v4](const ConstElementPtr& last, std::vector<ElementPtr>& page) {
+        LeasePageSize page_size(LEASE_GET_ALL_PAGE_SIZE);
+        if (v4) {
+            IOAddress lower_bound = IOAddress::IPV4_ZERO_ADDRESS();
+            if (last) {
+                lower_bound = IOAddress(last->get("ip-address")->stringValue());
+            }
+            Lease4Collection leases =
+                LeaseMgrFactory::instance().getLeases4(lower_bound, page_size);
+            for (auto lease : leases) {
+                page.push_back(lease->toElement());
+            }
+        } else {
+            IOAddress lower_bound = IOAddress::IPV6_ZERO_ADDRESS();
+            if (last) {
+                lower_bound = IOAddress(last->get("ip-address")->stringValue());
+            }
+            Lease6Collection leases =
+                LeaseMgrFactory::instance().getLeases6(lower_bound, page_size);
+            for (auto lease : leases) {
+                page.push_back(lease->toElement());
+            }
+        }
+    });
+}
+
+}
+
 namespace isc {
 namespace lease_cmds {
 
@@ -136,6 +183,18 @@ public:
     int
     leaseAddHandler(CalloutHandle& handle);
 
+    /// @brief lease4-bulk-apply command handler
+    ///
+    /// Provides the implementation for the
+    /// @ref isc::lease_cmds::LeaseCmds::lease4BulkApplyHandler.
+    ///
+    /// @param handle Callout context - which is expected to contain the
+    /// add command JSON text in the "command" argument
+    ///
+    /// @return 0 upon success, non-zero otherwise
+    int
+    lease4BulkApplyHandler(CalloutHandle& handle);
+
     /// @brief lease6-bulk-apply command handler
     ///
     /// Provides the implementation for the
@@ -339,6 +398,23 @@ public:
     /// @throw BadValue if input arguments don't make sense.
     Parameters getParameters(bool v6, const ConstElementPtr& args);
 
+    /// @brief Convenience function fetching IPv4 lease to be deleted.
+    ///
+    /// If the query type is of the address type and the lease does not
+    /// exist, a lease holding only the address is returned. If the type
+    /// is set to HW address or client identifier, this function will try
+    /// to find the lease. The DUID is not allowed and this query type
+    /// results in an exception.
+    ///
+    /// @param parameters parameters extracted from the command.
+    ///
+    /// @return Lease to be deleted or null if it was not found.
+    ///
+    /// @throw InvalidParameter if the identifier is not specified or if
+    /// the query type is by DUID.
+    /// @throw InvalidOperation if the query type is unknown.
+    Lease4Ptr getIPv4LeaseForDelete(const Parameters& parameters) const;
+
     /// @brief Convenience function fetching IPv6 address to be used to
     /// delete a lease.
     ///
@@ -444,6 +520,34 @@ public:
     ///
     /// @return true if lease has been successfully added, false otherwise.
     static bool addOrUpdate6(Lease6Ptr lease, bool force_create);
+
+    /// @brief Add or update IPv4 leases.
+    ///
+    /// The leases are processed as in the IPv6 variant below.
+    ///
+    /// @param leases The leases to be added or updated (if exist).
+    /// @param [out] errors The error message of each lease which has not
+    /// been added or updated.
+    ///
+    /// @return The number of leases added or updated.
+    static size_t addOrUpdate4(const Lease4Collection& leases,
+                               std::map<Lease4Ptr, std::string>& errors);
+
+    /// @brief Add or update IPv6 leases.
+    ///
+    /// The leases which do not exist are added and the others are updated
+    /// using the batch methods of the lease manager. When a batch fails its
+    /// leases are added or updated one at a time to get the error of each
+    /// lease. The leases with an address already seen in the collection are
+    /// also processed one at a time, after the batches.
+    ///
+    /// @param leases The leases to be added or updated (if exist).
+    /// @param [out] errors The error message of each lease which has not
+    /// been added or updated.
+    ///
+    /// @return The number of leases added or updated.
+    static size_t addOrUpdate6(const Lease6Collection& leases,
+                               std::map<Lease6Ptr, std::string>& errors);
 };
 
 void
@@ -704,6 +808,242 @@ LeaseCmdsImpl::addOrUpdate6(Lease6Ptr lease, bool force_create) {
     return (false);
 }
 
+size_t
+LeaseCmdsImpl::addOrUpdate4(const Lease4Collection& leases,
+                            std::map<Lease4Ptr, std::string>& errors) {
+    LeaseMgr& lease_mgr = LeaseMgrFactory::instance();
+
+    // In multi-threading mode the addresses are locked until return.
+    ResourceHandler4 resource_handler;
+    std::set<IOAddress> seen;
+    std::map<Lease4Ptr, Lease4Ptr> existing_leases;
+    Lease4Collection added;
+    Lease4Collection updated;
+    Lease4Collection later;
+    for (auto const& lease : leases) {
+        try {
+            if (!seen.insert(lease->addr_).second) {
+                later.push_back(lease);
+                continue;
+            }
+            if (MultiThreadingMgr::instance().getMode() &&
+                !resource_handler.tryLock4(lease->addr_)) {
+                isc_throw(ResourceBusy,
+                          "ResourceBusy: IP address:" << lease->addr_
+                          << " could not be updated.");
+            }
+            Lease4Ptr existing = lease_mgr.getLease4(lease->addr_);
+            if (existing) {
+                // Update lease current expiration time with value received
+                // from the database.
+                Lease::syncCurrentExpirationTime(*existing, *lease);
+                existing_leases[lease] = existing;
+                updated.push_back(lease);
+            } else {
+                added.push_back(lease);
+            }
+
+        } catch (const std::exception& ex) {
+            errors[lease] = ex.what();
+        }
+    }
+
+    size_t success_count = 0;
+    auto apply_each = [&success_count, &errors](const Lease4Collection& batch) {
+        for (auto const& lease : batch) {
+            try {
+                addOrUpdate4(lease, true);
+                ++success_count;
+
+            } catch (const std::exception& ex) {
+                errors[lease] = ex.what();
+            }
+        }
+    };
+
+    // When a batch fails the leases it handled are accounted and the
+    // others are applied one by one.
+    size_t processed = added.size();
+    std::set<Lease4Ptr> lost;
+    try {
+        Lease4Collection duplicates = lease_mgr.addLeases(added);
+        lost.insert(duplicates.begin(), duplicates.end());
+
+    } catch (const LeaseBatchError& ex) {
+        processed = ex.getProcessed();
+        for (auto const& lease : ex.getRejected()) {
+            lost.insert(boost::dynamic_pointer_cast<Lease4>(lease));
+        }
+
+    } catch (const std::exception&) {
+        processed = 0;
+    }
+    for (size_t i = 0; i < processed; ++i) {
+        const Lease4Ptr& lease = added[i];
+        if (lost.count(lease)) {
+            errors[lease] = "lost race between calls to get and add";
+        } else {
+            LeaseCmdsImpl::updateStatsOnAdd(lease);
+            ++success_count;
+        }
+    }
+    apply_each(Lease4Collection(added.begin() + processed, added.end()));
+
+    processed = updated.size();
+    std::set<Lease4Ptr> missing;
+    try {
+        Lease4Collection not_updated = lease_mgr.updateLeases4(updated);
+        missing.insert(not_updated.begin(), not_updated.end());
+
+    } catch (const LeaseBatchError& ex) {
+        processed = ex.getProcessed();
+        for (auto const& lease : ex.getRejected()) {
+            missing.insert(boost::dynamic_pointer_cast<Lease4>(lease));
+        }
+
+    } catch (const std::exception&) {
+        processed = 0;
+    }
+    for (size_t i = 0; i < processed; ++i) {
+        const Lease4Ptr& lease = updated[i];
+        if (missing.count(lease)) {
+            std::ostringstream msg;
+            msg << "failed to update the lease with address "
+                << lease->addr_ << " either because the lease has been "
+                "deleted or it has changed in the database, in both cases a "
+                "retry might succeed";
+            errors[lease] = msg.str();
+        } else {
+            LeaseCmdsImpl::updateStatsOnUpdate(existing_leases[lease], lease);
+            ++success_count;
+        }
+    }
+    apply_each(Lease4Collection(updated.begin() + processed, updated.end()));
+
+    // The addresses of these leases are already locked.
+    apply_each(later);
+
+    return (success_count);
+}
+
+size_t
+LeaseCmdsImpl::addOrUpdate6(const Lease6Collection& leases,
+                            std::map<Lease6Ptr, std::string>& errors) {
+    LeaseMgr& lease_mgr = LeaseMgrFactory::instance();
+
+    // In multi-threading mode the addresses are locked until return.
+    ResourceHandler resource_handler;
+    std::set<std::pair<Lease::Type, IOAddress> > seen;
+    std::map<Lease6Ptr, Lease6Ptr> existing_leases;
+    Lease6Collection added;
+    Lease6Collection updated;
+    Lease6Collection later;
+    for (auto const& lease : leases) {
+        try {
+            if (!seen.insert(std::make_pair(lease->type_, lease->addr_)).second) {
+                later.push_back(lease);
+                continue;
+            }
+            if (MultiThreadingMgr::instance().getMode() &&
+                !resource_handler.tryLock(lease->type_, lease->addr_)) {
+                isc_throw(ResourceBusy,
+                          "ResourceBusy: IP address:" << lease->addr_
+                          << " could not be updated.");
+            }
+            Lease6Ptr existing = lease_mgr.getLease6(lease->type_, lease->addr_);
+            if (existing) {
+                // Update lease current expiration time with value received
+                // from the database.
+                Lease::syncCurrentExpirationTime(*existing, *lease);
+                existing_leases[lease] = existing;
+                updated.push_back(lease);
+            } else {
+                added.push_back(lease);
+            }
+
+        } catch (const std::exception& ex) {
+            errors[lease] = ex.what();
+        }
+    }
+
+    size_t success_count = 0;
+    auto apply_each = [&success_count, &errors](const Lease6Collection& batch) {
+        for (auto const& lease : batch) {
+            try {
+                addOrUpdate6(lease, true);
+                ++success_count;
+
+            } catch (const std::exception& ex) {
+                errors[lease] = ex.what();
+            }
+        }
+    };
+
+    // When a batch fails the leases it handled are accounted and the
+    // others are applied one by one.
+    size_t processed = added.size();
+    std::set<Lease6Ptr> lost;
+    try {
+        Lease6Collection duplicates = lease_mgr.addLeases(added);
+        lost.insert(duplicates.begin(), duplicates.end());
+
+    } catch (const LeaseBatchError& ex) {
+        processed = ex.getProcessed();
+        for (auto const& lease : ex.getRejected()) {
+            lost.insert(boost::dynamic_pointer_cast<Lease6>(lease));
+        }
+
+    } catch (const std::exception&) {
+        processed = 0;
+    }
+    for (size_t i = 0; i < processed; ++i) {
+        const Lease6Ptr& lease = added[i];
+        if (lost.count(lease)) {
+            errors[lease] = "lost race between calls to get and add";
+        } else {
+            LeaseCmdsImpl::updateStatsOnAdd(lease);
+            ++success_count;
+        }
+    }
+    apply_each(Lease6Collection(added.begin() + processed, added.end()));
+
+    processed = updated.size();
+    std::set<Lease6Ptr> missing;
+    try {
+        Lease6Collection not_updated = lease_mgr.updateLeases6(updated);
+        missing.insert(not_updated.begin(), not_updated.end());
+
+    } catch (const LeaseBatchError& ex) {
+        processed = ex.getProcessed();
+        for (auto const& lease : ex.getRejected()) {
+            missing.insert(boost::dynamic_pointer_cast<Lease6>(lease));
+        }
+
+    } catch (const std::exception&) {
+        processed = 0;
+    }
+    for (size_t i = 0; i < processed; ++i) {
+        const Lease6Ptr& lease = updated[i];
+        if (missing.count(lease)) {
+            std::ostringstream msg;
+            msg << "failed to update the lease with address "
+                << lease->addr_ << " either because the lease has been "
+                "deleted or it has changed in the database, in both cases a "
+                "retry might succeed";
+            errors[lease] = msg.str();
+        } else {
+            LeaseCmdsImpl::updateStatsOnUpdate(existing_leases[lease], lease);
+            ++success_count;
+        }
+    }
+    apply_each(Lease6Collection(updated.begin() + processed, updated.end()));
+
+    // The addresses of these leases are already locked.
+    apply_each(later);
+
+    return (success_count);
+}
+
 int
 LeaseCmdsImpl::leaseAddHandler(CalloutHandle& handle) {
     // Arbitrary defaulting to DHCPv4 or with other words extractCommand
@@ -1062,18 +1402,29 @@ LeaseCmdsImpl::leaseGetAllHandler(CalloutHandle& handle) {
 
         } else {
             // There is no 'subnets' argument so let's return all leases.
-            if (v4) {
-                Lease4Collection leases = LeaseMgrFactory::instance().getLeases4();
-                for (auto lease : leases) {
-                    ElementPtr lease_json = lease->toElement();
-                    leases_json->add(lease_json);
-                }
-            } else {
-                Lease6Collection leases = LeaseMgrFactory::instance().getLeases6();
-                for (auto lease : leases) {
-                    ElementPtr lease_json = lease->toElement();
-                    leases_json->add(lease_json);
-                }
+            // They are read by pages: when they don't fit in one page they
+            // are returned in a streamed list, i.e. they are read and
+            // converted to text while the response is sent, so they are
+            // never all held in memory. The number of leases is then not
+            // known so the response text does not give it. The reader is
+            // released when this library is unloaded.
+            StreamedListElement::PageReader reader = getAllLeasesPageReader(v4);
+            std::vector<ElementPtr> first_page;
+            reader(ConstElementPtr(), first_page);
+            if (first_page.size() >= LEASE_GET_ALL_PAGE_SIZE) {
+                std::ostringstream s;
+                s << "IPv" << (v4 ? "4" : "6") << " leases found.";
+                ElementPtr args = Element::createMap();
+                args->set("leases",
+                          ElementPtr(new StreamedListElement(reader,
+                                                             first_page)));
+                ConstElementPtr response =
+                    createAnswer(CONTROL_RESULT_SUCCESS, s.str(), args);
+                setResponse(handle, response);
+                return (0);
+            }
+            for (auto lease_json : first_page) {
+                leases_json->add(lease_json);
             }
         }
 
@@ -1164,18 +1515,42 @@ LeaseCmdsImpl::leaseGetPageHandler(CalloutHandle& handle) {
         // Retrieve the desired page size.
         size_t page_limit_value = static_cast<size_t>(page_limit->intValue());
 
+        // The optional 'encoding' selects the compact binary encoding of
+        // the leases instead of the JSON list.
+        bool binary = false;
+        ConstElementPtr encoding = cmd_args_->get("encoding");
+        if (encoding) {
+            if (encoding->getType() != Element::string) {
+                isc_throw(BadValue, "'encoding' parameter must be a string");
+            }
+            if (encoding->stringValue() == LeaseCodec::NAME) {
+                binary = true;
+            } else if (encoding->stringValue() != "json") {
+                isc_throw(BadValue, "unsupported '" << encoding->stringValue()
+                          << "' encoding");
+            }
+        }
+
         ElementPtr leases_json = Element::createList();
+        std::string leases_binary;
+        size_t count = 0;
 
         if (v4) {
             // Get page of IPv4 leases.
             Lease4Collection leases =
                 LeaseMgrFactory::instance().getLeases4(*from_address,
                                                        LeasePageSize(page_limit_value));
+            count = leases.size();
 
-            // Convert leases into JSON list.
-            for (auto lease : leases) {
-                ElementPtr lease_json = lease->toElement();
-                leases_json->add(lease_json);
+            if (binary) {
+                leases_binary = LeaseCodec::encodeText(leases);
+
+            } else {
+                // Convert leases into JSON list.
+                for (auto lease : leases) {
+                    ElementPtr lease_json = lease->toElement();
+                    leases_json->add(lease_json);
+                }
             }
 
         } else {
@@ -1183,27 +1558,38 @@ LeaseCmdsImpl::leaseGetPageHandler(CalloutHandle& handle) {
             Lease6Collection leases =
                 LeaseMgrFactory::instance().getLeases6(*from_address,
                                                        LeasePageSize(page_limit_value));
-            // Convert leases into JSON list.
-            for (auto lease : leases) {
-                ElementPtr lease_json = lease->toElement();
-                leases_json->add(lease_json);
+            count = leases.size();
+
+            if (binary) {
+                leases_binary = LeaseCodec::encodeText(leases);
+
+            } else {
+                // Convert leases into JSON list.
+                for (auto lease : leases) {
+                    ElementPtr lease_json = lease->toElement();
+                    leases_json->add(lease_json);
+                }
             }
         }
 
         // Prepare textual status.
         std::ostringstream s;
-        s << leases_json->size()
+        s << count
           << " IPv" << (v4 ? "4" : "6")
           << " lease(s) found.";
         ElementPtr args = Element::createMap();
 
         // Put gathered data into arguments map.
-        args->set("leases", leases_json);
-        args->set("count", Element::create(static_cast<int64_t>(leases_json->size())));
+        if (binary) {
+            args->set("leases-binary", Element::create(leases_binary));
+        } else {
+            args->set("leases", leases_json);
+        }
+        args->set("count", Element::create(static_cast<int64_t>(count)));
 
         // Create the response.
         ConstElementPtr response =
-            createAnswer(leases_json->size() > 0 ?
+            createAnswer(count > 0 ?
                          CONTROL_RESULT_SUCCESS :
                          CONTROL_RESULT_EMPTY,
                          s.str(), args);
@@ -1513,6 +1899,226 @@ LeaseCmdsImpl::lease4DelHandler(CalloutHandle& handle) {
     return (0);
 }
 
+int
+LeaseCmdsImpl::lease4BulkApplyHandler(CalloutHandle& handle) {
+    try {
+        extractCommand(handle);
+
+        // Arguments are mandatory.
+        if (!cmd_args_ || (cmd_args_->getType() != Element::map)) {
+            isc_throw(BadValue, "Command arguments missing or a not a map.");
+        }
+
+        // At least one of the 'deleted-leases', 'leases' or 'leases-binary'
+        // must be present.
+        auto deleted_leases = cmd_args_->get("deleted-leases");
+        auto leases = cmd_args_->get("leases");
+        auto leases_binary = cmd_args_->get("leases-binary");
+
+        if (!deleted_leases && !leases && !leases_binary) {
+            isc_throw(BadValue, "neither 'deleted-leases' nor 'leases' parameter"
+                      " specified");
+        }
+
+        // Make sure that 'deleted-leases' is a list, if present.
+        if (deleted_leases && (deleted_leases->getType() != Element::list)) {
+            isc_throw(BadValue, "the 'deleted-leases' parameter must be a list");
+        }
+
+        // Make sure that 'leases' is a list, if present.
+        if (leases && (leases->getType() != Element::list)) {
+            isc_throw(BadValue, "the 'leases' parameter must be a list");
+        }
+
+        // Parse deleted leases without deleting them from the database
+        // yet. If any of the deleted leases or new leases appears to be
+        // malformed we can easily rollback.
+        std::list<std::pair<Parameters, Lease4Ptr> > parsed_deleted_list;
+        if (deleted_leases) {
+            auto leases_list = deleted_leases->listValue();
+
+            // Iterate over leases to be deleted.
+            for (auto lease_params : leases_list) {
+                // Parsing the lease may throw and it means that the lease
+                // information is malformed.
+                Parameters p = getParameters(false, lease_params);
+                auto lease = getIPv4LeaseForDelete(p);
+                parsed_deleted_list.push_back(std::make_pair(p, lease));
+            }
+        }
+
+        // Parse new/updated leases without affecting the database to detect
+        // any errors that should cause an error response.
+        std::list<Lease4Ptr> parsed_leases_list;
+        if (leases) {
+            ConstSrvConfigPtr config = CfgMgr::instance().getCurrentCfg();
+
+            // Iterate over all leases.
+            auto leases_list = leases->listValue();
+            for (auto lease_params : leases_list) {
+
+                Lease4Parser parser;
+                bool force_update;
+
+                // If parsing the lease fails we throw, as it indicates that the
+                // command is malformed.
+                Lease4Ptr lease4 = parser.parse(config, lease_params, force_update);
+                parsed_leases_list.push_back(lease4);
+            }
+        }
+
+        // Leases in the compact binary encoding are applied after the
+        // leases in JSON.
+        if (leases_binary) {
+            ConstSrvConfigPtr config = CfgMgr::instance().getCurrentCfg();
+            Lease4Parser parser;
+            Lease4Collection decoded = parser.parseBinary(config, leases_binary);
+            parsed_leases_list.insert(parsed_leases_list.end(), decoded.begin(),
+                                      decoded.end());
+        }
+
+        // Count successful deletions and updates.
+        size_t success_count = 0;
+
+        ElementPtr failed_deleted_list;
+        if (!parsed_deleted_list.empty()) {
+
+            // Try to delete all leases at once. On failure the leases the
+            // batch did not handle are deleted one at a time to report the
+            // error of each lease.
+            Lease4Collection batch;
+            for (auto const& lease_params_pair : parsed_deleted_list) {
+                if (lease_params_pair.second) {
+                    batch.push_back(lease_params_pair.second);
+                }
+            }
+            std::set<Lease4Ptr> not_deleted;
+            size_t processed = 0;
+            try {
+                Lease4Collection missing =
+                    LeaseMgrFactory::instance().deleteLeases(batch);
+                not_deleted.insert(missing.begin(), missing.end());
+                processed = batch.size();
+
+            } catch (const LeaseBatchError& ex) {
+                processed = ex.getProcessed();
+                for (auto const& lease : ex.getRejected()) {
+                    not_deleted.insert(boost::dynamic_pointer_cast<Lease4>(lease));
+                }
+
+            } catch (const std::exception&) {
+                // Fall back to the lease by lease deletion.
+            }
+            std::set<Lease4Ptr> handled(batch.begin(), batch.begin() + processed);
+
+            // Iterate over leases to be deleted.
+            for (auto lease_params_pair : parsed_deleted_list) {
+
+                auto lease = lease_params_pair.second;
+
+                try {
+                    if (lease) {
+                        // This may throw if the lease couldn't be deleted for
+                        // any reason, but we still want to proceed with other
+                        // leases.
+                        bool deleted = (handled.count(lease) ? !not_deleted.count(lease) :
+                                        LeaseMgrFactory::instance().deleteLease(lease));
+                        if (deleted) {
+                            ++success_count;
+                            LeaseCmdsImpl::updateStatsOnDelete(lease);
+
+                        } else {
+                            // Lazy creation of the list of leases which failed to delete.
+                            if (!failed_deleted_list) {
+                                failed_deleted_list = Element::createList();
+                            }
+
+                            // If the lease doesn't exist we also want to put it
+                            // on the list of leases which failed to delete. That
+                            // corresponds to the lease4-del command which returns
+                            // an error when the lease doesn't exist.
+                            failed_deleted_list->add(createFailedLeaseMap(Lease::TYPE_V4,
+                                                                          lease->addr_,
+                                                                          DuidPtr(),
+                                                                          CONTROL_RESULT_EMPTY,
+                                                                          "lease not found"));
+                        }
+                    }
+
+                } catch (const std::exception& ex) {
+                    // Lazy creation of the list of leases which failed to delete.
+                    if (!failed_deleted_list) {
+                         failed_deleted_list = Element::createList();
+                    }
+                    failed_deleted_list->add(createFailedLeaseMap(Lease::TYPE_V4,
+                                                                  lease->addr_,
+                                                                  DuidPtr(),
+                                                                  CONTROL_RESULT_ERROR,
+                                                                  ex.what()));
+                }
+            }
+        }
+
+        // Process leases to be added or/and updated.
+        ElementPtr failed_leases_list;
+        if (!parsed_leases_list.empty()) {
+            std::map<Lease4Ptr, std::string> errors;
+            Lease4Collection batch(parsed_leases_list.begin(),
+                                   parsed_leases_list.end());
+            success_count += addOrUpdate4(batch, errors);
+
+            // Report the failed leases in the order of the command.
+            for (auto lease : parsed_leases_list) {
+                auto error = errors.find(lease);
+                if (error == errors.end()) {
+                    continue;
+                }
+                // Lazy creation of the list of leases which failed to add/update.
+                if (!failed_leases_list) {
+                     failed_leases_list = Element::createList();
+                }
+                failed_leases_list->add(createFailedLeaseMap(Lease::TYPE_V4,
+                                                             lease->addr_,
+                                                             DuidPtr(),
+                                                             CONTROL_RESULT_ERROR,
+                                                             error->second));
+            }
+        }
+
+        // Start preparing the response.
+        ElementPtr args;
+
+        if (failed_deleted_list || failed_leases_list) {
+            // If there are any failed leases, let's include them in the response.
+            args = Element::createMap();
+
+            // failed-deleted-leases
+            if (failed_deleted_list) {
+                args->set("failed-deleted-leases", failed_deleted_list);
+            }
+
+            // failed-leases
+            if (failed_leases_list) {
+                args->set("failed-leases", failed_leases_list);
+            }
+        }
+
+        // Send the success response and include failed leases.
+        std::ostringstream resp_text;
+        resp_text << "Bulk apply of " << success_count << " IPv4 leases completed.";
+        auto answer = createAnswer(success_count > 0 ? CONTROL_RESULT_SUCCESS :
+                                   CONTROL_RESULT_EMPTY, resp_text.str(), args);
+        setResponse(handle, answer);
+
+    } catch (const std::exception& ex) {
+        // Unable to parse the command and similar issues.
+        setErrorResponse(handle, ex.what());
+        return (CONTROL_RESULT_ERROR);
+    }
+
+    return (CONTROL_RESULT_SUCCESS);
+}
+
 int
 LeaseCmdsImpl::lease6BulkApplyHandler(CalloutHandle& handle) {
     try {
@@ -1523,11 +2129,13 @@ LeaseCmdsImpl::lease6BulkApplyHandler(CalloutHandle& handle) {
             isc_throw(BadValue, "Command arguments missing or a not a map.");
         }
 
-        // At least one of the 'deleted-leases' or 'leases' must be present.
+        // At least one of the 'deleted-leases', 'leases' or 'leases-binary'
+        // must be present.
         auto deleted_leases = cmd_args_->get("deleted-leases");
         auto leases = cmd_args_->get("leases");
+        auto leases_binary = cmd_args_->get("leases-binary");
 
-        if (!deleted_leases && !leases) {
+        if (!deleted_leases && !leases && !leases_binary) {
             isc_throw(BadValue, "neither 'deleted-leases' nor 'leases' parameter"
                       " specified");
         }
@@ -1579,12 +2187,50 @@ LeaseCmdsImpl::lease6BulkApplyHandler(CalloutHandle& handle) {
             }
         }
 
+        // Leases in the compact binary encoding are applied after the
+        // leases in JSON.
+        if (leases_binary) {
+            ConstSrvConfigPtr config = CfgMgr::instance().getCurrentCfg();
+            Lease6Parser parser;
+            Lease6Collection decoded = parser.parseBinary(config, leases_binary);
+            parsed_leases_list.insert(parsed_leases_list.end(), decoded.begin(),
+                                      decoded.end());
+        }
+
         // Count successful deletions and updates.
         size_t success_count = 0;
 
         ElementPtr failed_deleted_list;
         if (!parsed_deleted_list.empty()) {
 
+            // Try to delete all leases at once. On failure the leases the
+            // batch did not handle are deleted one at a time to report the
+            // error of each lease.
+            Lease6Collection batch;
+            for (auto const& lease_params_pair : parsed_deleted_list) {
+                if (lease_params_pair.second) {
+                    batch.push_back(lease_params_pair.second);
+                }
+            }
+            std::set<Lease6Ptr> not_deleted;
+            size_t processed = 0;
+            try {
+                Lease6Collection missing =
+                    LeaseMgrFactory::instance().deleteLeases(batch);
+                not_deleted.insert(missing.begin(), missing.end());
+                processed = batch.size();
+
+            } catch (const LeaseBatchError& ex) {
+                processed = ex.getProcessed();
+                for (auto const& lease : ex.getRejected()) {
+                    not_deleted.insert(boost::dynamic_pointer_cast<Lease6>(lease));
+                }
+
+            } catch (const std::exception&) {
+                // Fall back to the lease by lease deletion.
+            }
+            std::set<Lease6Ptr> handled(batch.begin(), batch.begin() + processed);
+
             // Iterate over leases to be deleted.
             for (auto lease_params_pair : parsed_deleted_list) {
 
@@ -1598,7 +2244,9 @@ LeaseCmdsImpl::lease6BulkApplyHandler(CalloutHandle& handle) {
                         // This may throw if the lease couldn't be deleted for
                         // any reason, but we still want to proceed with other
                         // leases.
-                        if (LeaseMgrFactory::instance().deleteLease(lease)) {
+                        bool deleted = (handled.count(lease) ? !not_deleted.count(lease) :
+                                        LeaseMgrFactory::instance().deleteLease(lease));
+                        if (deleted) {
                             ++success_count;
                             LeaseCmdsImpl::updateStatsOnDelete(lease);
 
@@ -1635,39 +2283,26 @@ LeaseCmdsImpl::lease6BulkApplyHandler(CalloutHandle& handle) {
         // Process leases to be added or/and updated.
         ElementPtr failed_leases_list;
         if (!parsed_leases_list.empty()) {
-            ConstSrvConfigPtr config = CfgMgr::instance().getCurrentCfg();
+            std::map<Lease6Ptr, std::string> errors;
+            Lease6Collection batch(parsed_leases_list.begin(),
+                                   parsed_leases_list.end());
+            success_count += addOrUpdate6(batch, errors);
 
-            // Iterate over all leases.
+            // Report the failed leases in the order of the command.
             for (auto lease : parsed_leases_list) {
-
-                try {
-                    if (!MultiThreadingMgr::instance().getMode()) {
-                        // Not multi-threading.
-                        addOrUpdate6(lease, true);
-                    } else {
-                        // Multi-threading, try to lock first to avoid a race.
-                        ResourceHandler resource_handler;
-                        if (resource_handler.tryLock(lease->type_, lease->addr_)) {
-                            addOrUpdate6(lease, true);
-                        } else {
-                            isc_throw(ResourceBusy,
-                                      "ResourceBusy: IP address:" << lease->addr_
-                                      << " could not be updated.");
-                        }
-                    }
-
-                    ++success_count;
-                } catch (const std::exception& ex) {
-                    // Lazy creation of the list of leases which failed to add/update.
-                    if (!failed_leases_list) {
-                         failed_leases_list = Element::createList();
-                    }
-                    failed_leases_list->add(createFailedLeaseMap(lease->type_,
-                                                                 lease->addr_,
-                                                                 lease->duid_,
-                                                                 CONTROL_RESULT_ERROR,
-                                                                 ex.what()));
+                auto error = errors.find(lease);
+                if (error == errors.end()) {
+                    continue;
+                }
+                // Lazy creation of the list of leases which failed to add/update.
+                if (!failed_leases_list) {
+                     failed_leases_list = Element::createList();
                 }
+                failed_leases_list->add(createFailedLeaseMap(lease->type_,
+                                                             lease->addr_,
+                                                             lease->duid_,
+                                                             CONTROL_RESULT_ERROR,
+                                                             error->second));
             }
         }
 
@@ -2071,6 +2706,56 @@ LeaseCmdsImpl::getIPv6LeaseForDelete(const Parameters& parameters) const {
     return (lease6);
 }
 
+Lease4Ptr
+LeaseCmdsImpl::getIPv4LeaseForDelete(const Parameters& parameters) const {
+    Lease4Ptr lease4;
+
+    switch (parameters.query_type) {
+    case Parameters::TYPE_ADDR: {
+        // If address was specified explicitly, let's use it as is.
+
+        // Let's see if there's such a lease at all.
+        lease4 = LeaseMgrFactory::instance().getLease4(parameters.addr);
+        if (!lease4) {
+            lease4.reset(new Lease4());
+            lease4->addr_ = parameters.addr;
+        }
+        break;
+    }
+    case Parameters::TYPE_HWADDR: {
+        if (!parameters.hwaddr) {
+            isc_throw(InvalidParameter, "Program error: Query by hw-address "
+                      "requires hwaddr to be specified");
+        }
+
+        // Let's see if there's such a lease at all.
+        lease4 = LeaseMgrFactory::instance().getLease4(*parameters.hwaddr,
+                                                       parameters.subnet_id);
+        break;
+    }
+    case Parameters::TYPE_CLIENT_ID: {
+        if (!parameters.client_id) {
+            isc_throw(InvalidParameter, "Program error: Query by client-id "
+                      "requires client-id to be specified");
+        }
+
+        // Let's see if there's such a lease at all.
+        lease4 = LeaseMgrFactory::instance().getLease4(*parameters.client_id,
+                                                       parameters.subnet_id);
+        break;
+    }
+    case Parameters::TYPE_DUID: {
+        isc_throw(InvalidParameter, "Delete by duid is not allowed in v4.");
+        break;
+    }
+    default:
+        isc_throw(InvalidOperation, "Unknown query type: "
+                  << static_cast<int>(parameters.query_type));
+    }
+
+    return (lease4);
+}
+
 IOAddress
 LeaseCmdsImpl::getAddressParam(ConstElementPtr params, const std::string name,
                                short family) const {
@@ -2199,7 +2884,7 @@ LeaseCmdsImpl::createFailedLeaseMap(const Lease::Type& lease_type,
     auto failed_lease_map = Element::createMap();
     failed_lease_map->set("type", Element::create(Lease::typeToText(lease_type)));
 
-    if (!lease_address.isV6Zero()) {
+    if (!lease_address.isV6Zero() && !lease_address.isV4Zero()) {
         failed_lease_map->set("ip-address", Element::create(lease_address.toText()));
 
     } else if (duid) {
@@ -2218,6 +2903,11 @@ LeaseCmds::leaseAddHandler(CalloutHandle& handle) {
     return (impl_->leaseAddHandler(handle));
 }
 
+int
+LeaseCmds::lease4BulkApplyHandler(CalloutHandle& handle) {
+    return (impl_->lease4BulkApplyHandler(handle));
+}
+
 int
 LeaseCmds::lease6BulkApplyHandler(CalloutHandle& handle) {
     return (impl_->lease6BulkApplyHandler(handle));
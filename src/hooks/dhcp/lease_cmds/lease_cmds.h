@@ -1,4 +1,4 @@
-// Copyright (C) 2017-2020 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2017-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -81,6 +81,42 @@ public:
     int
     leaseAddHandler(hooks::CalloutHandle& handle);
 
+    /// @brief lease4-bulk-apply command handler
+    ///
+    /// This command conveys information about multiple IPv4 leases to be
+    /// added, updated or deleted, in the same way as the lease6-bulk-apply
+    /// command below. It is used by High Availability to send the lease
+    /// updates of several DHCPv4 packets at once. The deleted leases are
+    /// identified as in the lease4-del command, e.g.:
+    ///
+    /// {
+    ///     "command": "lease4-bulk-apply",
+    ///     "arguments": {
+    ///         "deleted-leases": [
+    ///             {
+    ///                 "ip-address": "192.0.2.1"
+    ///             }
+    ///         ],
+    ///         "leases": [
+    ///             {
+    ///                 "subnet-id": 44,
+    ///                 "ip-address": "192.0.2.202",
+    ///                 "hw-address": "1a:1b:1c:1d:1e:1f",
+    ///                 ...
+    ///             }
+    ///         ]
+    ///     }
+    /// }
+    ///
+    /// The leases which failed to be applied are returned with the "V4"
+    /// type.
+    ///
+    /// @param handle Callout context - which is expected to contain the
+    /// add command JSON text in the "command" argument
+    /// @return result of the operation
+    int
+    lease4BulkApplyHandler(hooks::CalloutHandle& handle);
+
     /// @brief lease6-bulk-apply command handler
     ///
     /// This command conveys information about multiple leases to be added,
@@ -237,6 +273,11 @@ public:
     ///     "command": "lease6-get-all",
     /// }
     ///
+    /// When all leases are requested and they don't fit in one page,
+    /// they are read while the response is sent. The response text is
+    /// then "IPv4 leases found." or "IPv6 leases found." without the
+    /// number of leases, which is not known yet.
+    ///
     /// @param handle Callout context - which is expected to contain the
     /// get command JSON text in the "command" argument
     /// @return 0 if the handler has been invoked successfully, 1 if an
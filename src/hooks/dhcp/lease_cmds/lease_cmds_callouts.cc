@@ -1,4 +1,4 @@
-// Copyright (C) 2017-2020 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2017-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -44,6 +44,17 @@ int lease6_add(CalloutHandle& handle) {
     return(lease_cmds.leaseAddHandler(handle));
 }
 
+/// @brief This is a command callout for 'lease4-bulk-apply' command.
+///
+/// @param handle Callout handle used to retrieve a command and
+/// provide a response.
+/// @return 0 if this callout has been invoked successfully,
+/// 1 otherwise.
+int lease4_bulk_apply(CalloutHandle& handle) {
+    LeaseCmds lease_cmds;
+    return (lease_cmds.lease4BulkApplyHandler(handle));
+}
+
 /// @brief This is a command callout for 'lease6-bulk-apply' command.
 ///
 /// @param handle Callout handle used to retrieve a command and
@@ -271,6 +282,7 @@ int lease6_resend_ddns(CalloutHandle& handle) {
 int load(LibraryHandle& handle) {
     handle.registerCommandCallout("lease4-add", lease4_add);
     handle.registerCommandCallout("lease6-add", lease6_add);
+    handle.registerCommandCallout("lease4-bulk-apply", lease4_bulk_apply);
     handle.registerCommandCallout("lease6-bulk-apply", lease6_bulk_apply);
     handle.registerCommandCallout("lease4-get", lease4_get);
     handle.registerCommandCallout("lease6-get", lease6_get);
@@ -302,8 +314,13 @@ int load(LibraryHandle& handle) {
 
 /// @brief This function is called when the library is unloaded.
 ///
+/// The responses to lease4-get-all and lease6-get-all may still be sent:
+/// their leases are read by code of this library so the remaining leases
+/// can't be read anymore and the connections sending them are closed.
+///
 /// @return 0 if deregistration was successful, 1 otherwise
 int unload() {
+    StreamedListElement::releaseReaders();
     LOG_INFO(lease_cmds_logger, LEASE_CMDS_DEINIT_OK);
     return (0);
 }
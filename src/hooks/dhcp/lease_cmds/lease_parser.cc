@@ -8,6 +8,7 @@
 #include <dhcp/hwaddr.h>
 #include <asiolink/io_address.h>
 #include <dhcpsrv/lease.h>
+#include <dhcpsrv/lease_codec.h>
 #include <dhcpsrv/cfgmgr.h>
 #include <dhcpsrv/cfg_consistency.h>
 #include <lease_parser.h>
@@ -179,6 +180,36 @@ Lease4Parser::parse(ConstSrvConfigPtr& cfg,
     return (l);
 }
 
+Lease4Collection
+Lease4Parser::parseBinary(ConstSrvConfigPtr& cfg,
+                          const ConstElementPtr& leases_binary) {
+    if (!leases_binary || (leases_binary->getType() != Element::string)) {
+        isc_throw(BadValue, "the 'leases-binary' parameter must be a string");
+    }
+
+    Lease4Collection leases = LeaseCodec::decodeText4(leases_binary->stringValue());
+    for (auto const& lease : leases) {
+        ConstSubnet4Ptr subnet =
+            cfg->getCfgSubnets4()->getBySubnetId(lease->subnet_id_);
+        if (!subnet) {
+            isc_throw(BadValue, "Invalid subnet-id: No IPv4 subnet with subnet-id="
+                      << lease->subnet_id_ << " currently configured.");
+        }
+
+        if (!subnet->inRange(lease->addr_)) {
+            isc_throw(BadValue, "The address " << lease->addr_.toText()
+                      << " does not belong to subnet " << subnet->toText()
+                      << ", subnet-id=" << lease->subnet_id_);
+        }
+
+        if (lease->hostname_.empty() && (lease->fqdn_fwd_ || lease->fqdn_rev_)) {
+            isc_throw(BadValue, "No hostname specified and either forward or reverse"
+                      " fqdn was set to true.");
+        }
+    }
+    return (leases);
+}
+
 Lease6Ptr
 Lease6Parser::parse(ConstSrvConfigPtr& cfg,
                     const ConstElementPtr& lease_info,
@@ -379,5 +410,35 @@ Lease6Parser::parse(ConstSrvConfigPtr& cfg,
     return (l);
 }
 
+Lease6Collection
+Lease6Parser::parseBinary(ConstSrvConfigPtr& cfg,
+                          const ConstElementPtr& leases_binary) {
+    if (!leases_binary || (leases_binary->getType() != Element::string)) {
+        isc_throw(BadValue, "the 'leases-binary' parameter must be a string");
+    }
+
+    Lease6Collection leases = LeaseCodec::decodeText6(leases_binary->stringValue());
+    for (auto const& lease : leases) {
+        ConstSubnet6Ptr subnet =
+            cfg->getCfgSubnets6()->getBySubnetId(lease->subnet_id_);
+        if (!subnet) {
+            isc_throw(BadValue, "Invalid subnet-id: No IPv6 subnet with subnet-id="
+                      << lease->subnet_id_ << " currently configured.");
+        }
+
+        if ((lease->type_ == Lease::TYPE_NA) && !subnet->inRange(lease->addr_)) {
+            isc_throw(BadValue, "The address " << lease->addr_.toText()
+                      << " does not belong to subnet " << subnet->toText()
+                      << ", subnet-id=" << lease->subnet_id_);
+        }
+
+        if (lease->hostname_.empty() && (lease->fqdn_fwd_ || lease->fqdn_rev_)) {
+            isc_throw(BadValue, "No hostname specified and either forward or reverse"
+                      " fqdn was set to true.");
+        }
+    }
+    return (leases);
+}
+
 } // end of namespace lease_cmds
 } // end of namespace isc
@@ -1,4 +1,4 @@
-// Copyright (C) 2017-2018 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2017-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -50,6 +50,20 @@ public:
                                        const isc::data::ConstElementPtr& lease_info,
                                        bool& force_create);
 
+    /// @brief Decodes leases in the compact binary encoding.
+    ///
+    /// The leases are encoded by @c isc::dhcp::LeaseCodec, e.g. in the
+    /// "leases-binary" argument of the lease4-bulk-apply command. The
+    /// decoded leases must belong to the configured subnets.
+    ///
+    /// @param cfg Currently running config (used for sanity checks)
+    /// @param leases_binary base64 text holding the encoded leases
+    /// @return Collection of decoded leases
+    /// @throw BadValue if any of the leases is invalid
+    virtual isc::dhcp::Lease4Collection
+    parseBinary(isc::dhcp::ConstSrvConfigPtr& cfg,
+                const isc::data::ConstElementPtr& leases_binary);
+
     /// @brief virtual dtor (does nothing)
     virtual ~Lease4Parser() {}
 };
@@ -90,6 +104,20 @@ public:
                                        const isc::data::ConstElementPtr& lease_info,
                                        bool& force_create);
 
+    /// @brief Decodes leases in the compact binary encoding.
+    ///
+    /// The leases are encoded by @c isc::dhcp::LeaseCodec, e.g. in the
+    /// "leases-binary" argument of the lease6-bulk-apply command. The
+    /// decoded leases must belong to the configured subnets.
+    ///
+    /// @param cfg Currently running config (used for sanity checks)
+    /// @param leases_binary base64 text holding the encoded leases
+    /// @return Collection of decoded leases
+    /// @throw BadValue if any of the leases is invalid
+    virtual isc::dhcp::Lease6Collection
+    parseBinary(isc::dhcp::ConstSrvConfigPtr& cfg,
+                const isc::data::ConstElementPtr& leases_binary);
+
     /// @brief virtual dtor (does nothing)
     virtual ~Lease6Parser() {}
 };
@@ -1,4 +1,4 @@
-// Copyright (C) 2017-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2017-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -9,6 +9,7 @@
 #include <exceptions/exceptions.h>
 #include <hooks/hooks_manager.h>
 #include <config/command_mgr.h>
+#include <dhcpsrv/lease_codec.h>
 #include <dhcpsrv/lease_mgr.h>
 #include <dhcpsrv/lease_mgr_factory.h>
 #include <dhcpsrv/ncr_generator.h>
@@ -21,6 +22,7 @@
 #include <testutils/multi_threading_utils.h>
 
 #include <gtest/gtest.h>
+#include <boost/pointer_cast.hpp>
 
 #include <errno.h>
 #include <set>
@@ -880,6 +882,10 @@ public:
     /// found.
     void testLease4GetAllNoLeases();
 
+    /// @brief Check that lease4-get-all returns many leases in a streamed
+    /// list.
+    void testLease4GetAllStreamed();
+
     /// @brief Check that lease4-get-all returns all leases for a subnet.
     void testLease4GetAllBySubnetId();
 
@@ -916,6 +922,10 @@ public:
     /// @brief Verifies that the limit of 0 is rejected.
     void testLease4GetPagedLimitIsZero();
 
+    /// @brief Check that lease4-get-page returns the leases in the compact
+    /// binary encoding when requested.
+    void testLease4GetPagedBinary();
+
     /// @brief Check that lease6-get-all returns all leases.
     void testLease6GetAll();
 
@@ -959,6 +969,10 @@ public:
     /// @brief Verifies that the limit of 0 is rejected.
     void testLease6GetPagedLimitIsZero();
 
+    /// @brief Check that lease6-get-page returns the leases in the compact
+    /// binary encoding when requested.
+    void testLease6GetPagedBinary();
+
     /// @brief Check that lease4-get-by-hw-address can handle a situation when
     /// the query is broken (required parameter is missing).
     void testLeaseGetByHwAddressParams();
@@ -1227,6 +1241,22 @@ public:
     /// subnet-id) will fail.
     void testLease6BrokenUpdate();
 
+    /// @brief This test verifies that it is possible to add, update and
+    /// delete leases as a result of the single lease4-bulk-apply command.
+    void testLease4BulkApply();
+
+    /// @brief This test verifies that deleting non existing leases with the
+    /// lease4-bulk-apply returns an 'empty' result.
+    void testLease4BulkApplyDeleteNonExiting();
+
+    /// @brief Check that changes for other leases are not applied by the
+    /// lease4-bulk-apply if one of the leases is malformed.
+    void testLease4BulkApplyRollback();
+
+    /// @brief This test verifies that the lease4-bulk-apply accepts leases
+    /// in the compact binary encoding.
+    void testLease4BulkApplyBinary();
+
     /// @brief This test verifies that it is possible to add two leases and
     /// delete two leases as a result of the single lease6-bulk-apply command.
     void testLease6BulkApply();
@@ -1259,6 +1289,10 @@ public:
     /// leases is malformed.
     void testLease6BulkApplyRollback();
 
+    /// @brief This test verifies that the lease6-bulk-apply accepts leases
+    /// in the compact binary encoding.
+    void testLease6BulkApplyBinary();
+
     /// @brief Check that lease4-resend-ddns sanitizes its input.
     void testLease4ResendDdnsBadParam();
 
@@ -3431,6 +3465,70 @@ TEST_F(LeaseCmdsTest, lease4GetAllNoLeasesMultiThreading) {
     testLease4GetAllNoLeases();
 }
 
+void LeaseCmdsTest::testLease4GetAllStreamed() {
+
+    // Initialize lease manager (false = v4, false = don't add leases)
+    initLeaseMgr(false, false);
+
+    // Add more leases than read in one page.
+    const size_t lease_count = 2500;
+    for (size_t i = 0; i < lease_count; ++i) {
+        std::ostringstream address;
+        address << "10.0." << (i / 250) << "." << (i % 250 + 1);
+        lmptr_->addLease(createLease4(address.str(), 44, 0x08, 0x42));
+    }
+
+    // Query for all leases.
+    string cmd =
+        "{\n"
+        "    \"command\": \"lease4-get-all\"\n"
+        "}";
+    string exp_rsp = "IPv4 leases found.";
+    ConstElementPtr rsp = testCommand(cmd, CONTROL_RESULT_SUCCESS, exp_rsp);
+    ASSERT_TRUE(rsp);
+
+    ConstElementPtr args = rsp->get("arguments");
+    ASSERT_TRUE(args);
+    ASSERT_EQ(Element::map, args->getType());
+
+    // The leases are read while the response is converted to text.
+    ConstElementPtr leases = args->get("leases");
+    ASSERT_TRUE(leases);
+    ASSERT_EQ(Element::list, leases->getType());
+    auto streamed = boost::dynamic_pointer_cast<const StreamedListElement>(leases);
+    ASSERT_TRUE(streamed);
+    EXPECT_FALSE(streamed->isMaterialized());
+    EXPECT_TRUE(JSONStreamWriter::isStreamed(rsp));
+
+    std::string text;
+    JSONStreamWriter writer(rsp);
+    while (writer.next(text)) {
+    }
+    EXPECT_FALSE(streamed->isMaterialized());
+
+    ConstElementPtr parsed;
+    ASSERT_NO_THROW(parsed = Element::fromJSON(text));
+    ASSERT_TRUE(parsed->get("arguments"));
+    leases = parsed->get("arguments")->get("leases");
+    ASSERT_TRUE(leases);
+    ASSERT_EQ(lease_count, leases->size());
+    checkLease4(leases, "10.0.0.1", 44, "08:08:08:08:08:08", true);
+    checkLease4(leases, "10.0.9.250", 44, "08:08:08:08:08:08", true);
+
+    // The streamed list can be used as a regular list too.
+    EXPECT_EQ(lease_count, streamed->size());
+    EXPECT_TRUE(streamed->isMaterialized());
+}
+
+TEST_F(LeaseCmdsTest, lease4GetAllStreamed) {
+    testLease4GetAllStreamed();
+}
+
+TEST_F(LeaseCmdsTest, lease4GetAllStreamedMultiThreading) {
+    MultiThreadingTest mt(true);
+    testLease4GetAllStreamed();
+}
+
 void LeaseCmdsTest::testLease4GetAllBySubnetId() {
 
     // Initialize lease manager (false = v4, true = add leases)
@@ -3872,6 +3970,84 @@ TEST_F(LeaseCmdsTest, lease4GetPagedLimitIsZeroMultiThreading) {
     testLease4GetPagedLimitIsZero();
 }
 
+void LeaseCmdsTest::testLease4GetPagedBinary() {
+
+    // Initialize lease manager (false = v4, true = add leases)
+    initLeaseMgr(false, true);
+
+    // Query for all leases in the compact binary encoding.
+    string cmd =
+        "{\n"
+        "    \"command\": \"lease4-get-page\",\n"
+        "    \"arguments\": {"
+        "        \"from\": \"start\","
+        "        \"limit\": 10,"
+        "        \"encoding\": \"binary\""
+        "    }"
+        "}";
+    string exp_rsp = "4 IPv4 lease(s) found.";
+    ConstElementPtr rsp = testCommand(cmd, CONTROL_RESULT_SUCCESS, exp_rsp);
+    ASSERT_TRUE(rsp);
+    ConstElementPtr args = rsp->get("arguments");
+    ASSERT_TRUE(args);
+    EXPECT_FALSE(args->get("leases"));
+    ConstElementPtr page_count = args->get("count");
+    ASSERT_TRUE(page_count);
+    EXPECT_EQ(4, page_count->intValue());
+    ConstElementPtr leases_binary = args->get("leases-binary");
+    ASSERT_TRUE(leases_binary);
+    ASSERT_EQ(Element::string, leases_binary->getType());
+
+    // The decoded leases must be the leases in the database.
+    Lease4Collection leases;
+    ASSERT_NO_THROW(leases = LeaseCodec::decodeText4(leases_binary->stringValue()));
+    ASSERT_EQ(4, leases.size());
+    for (auto const& lease : leases) {
+        Lease4Ptr from_mgr = lmptr_->getLease4(lease->addr_);
+        ASSERT_TRUE(from_mgr);
+        EXPECT_TRUE(isEquivalent(from_mgr->toElement(), lease->toElement()));
+    }
+
+    // The JSON encoding can be explicitly requested.
+    cmd =
+        "{\n"
+        "    \"command\": \"lease4-get-page\",\n"
+        "    \"arguments\": {"
+        "        \"from\": \"start\","
+        "        \"limit\": 10,"
+        "        \"encoding\": \"json\""
+        "    }"
+        "}";
+    rsp = testCommand(cmd, CONTROL_RESULT_SUCCESS, exp_rsp);
+    ASSERT_TRUE(rsp);
+    args = rsp->get("arguments");
+    ASSERT_TRUE(args);
+    EXPECT_TRUE(args->get("leases"));
+    EXPECT_FALSE(args->get("leases-binary"));
+
+    // Other encodings are rejected.
+    cmd =
+        "{\n"
+        "    \"command\": \"lease4-get-page\",\n"
+        "    \"arguments\": {"
+        "        \"from\": \"start\","
+        "        \"limit\": 10,"
+        "        \"encoding\": \"xml\""
+        "    }"
+        "}";
+    exp_rsp = "unsupported 'xml' encoding";
+    testCommand(cmd, CONTROL_RESULT_ERROR, exp_rsp);
+}
+
+TEST_F(LeaseCmdsTest, lease4GetPagedBinary) {
+    testLease4GetPagedBinary();
+}
+
+TEST_F(LeaseCmdsTest, lease4GetPagedBinaryMultiThreading) {
+    MultiThreadingTest mt(true);
+    testLease4GetPagedBinary();
+}
+
 void LeaseCmdsTest::testLease6GetAll() {
 
     // Initialize lease manager (true = v6, true = add leases)
@@ -4390,6 +4566,64 @@ TEST_F(LeaseCmdsTest, lease6GetPagedLimitIsZeroMultiThreading) {
     testLease6GetPagedLimitIsZero();
 }
 
+void LeaseCmdsTest::testLease6GetPagedBinary() {
+
+    // Initialize lease manager (true = v6, true = add leases)
+    initLeaseMgr(true, true);
+
+    // Query for all leases in the compact binary encoding.
+    string cmd =
+        "{\n"
+        "    \"command\": \"lease6-get-page\",\n"
+        "    \"arguments\": {"
+        "        \"from\": \"start\","
+        "        \"limit\": 10,"
+        "        \"encoding\": \"binary\""
+        "    }"
+        "}";
+    string exp_rsp = "4 IPv6 lease(s) found.";
+    ConstElementPtr rsp = testCommand(cmd, CONTROL_RESULT_SUCCESS, exp_rsp);
+    ASSERT_TRUE(rsp);
+    ConstElementPtr args = rsp->get("arguments");
+    ASSERT_TRUE(args);
+    EXPECT_FALSE(args->get("leases"));
+    ConstElementPtr leases_binary = args->get("leases-binary");
+    ASSERT_TRUE(leases_binary);
+    ASSERT_EQ(Element::string, leases_binary->getType());
+
+    // The decoded leases must be the leases in the database.
+    Lease6Collection leases;
+    ASSERT_NO_THROW(leases = LeaseCodec::decodeText6(leases_binary->stringValue()));
+    ASSERT_EQ(4, leases.size());
+    for (auto const& lease : leases) {
+        Lease6Ptr from_mgr = lmptr_->getLease6(lease->type_, lease->addr_);
+        ASSERT_TRUE(from_mgr);
+        EXPECT_TRUE(isEquivalent(from_mgr->toElement(), lease->toElement()));
+    }
+
+    // The encoding must be a string.
+    cmd =
+        "{\n"
+        "    \"command\": \"lease6-get-page\",\n"
+        "    \"arguments\": {"
+        "        \"from\": \"start\","
+        "        \"limit\": 10,"
+        "        \"encoding\": 1"
+        "    }"
+        "}";
+    exp_rsp = "'encoding' parameter must be a string";
+    testCommand(cmd, CONTROL_RESULT_ERROR, exp_rsp);
+}
+
+TEST_F(LeaseCmdsTest, lease6GetPagedBinary) {
+    testLease6GetPagedBinary();
+}
+
+TEST_F(LeaseCmdsTest, lease6GetPagedBinaryMultiThreading) {
+    MultiThreadingTest mt(true);
+    testLease6GetPagedBinary();
+}
+
 void LeaseCmdsTest::testLeaseGetByHwAddressParams() {
 
     // No parameters whatsoever.
@@ -7412,6 +7646,278 @@ TEST_F(LeaseCmdsTest, lease6BrokenUpdateMultiThreading) {
     testLease6BrokenUpdate();
 }
 
+void LeaseCmdsTest::testLease4BulkApply() {
+
+    // Initialize lease manager (false = v4, true = add leases)
+    initLeaseMgr(false, true);
+
+    checkLease4Stats(44, 2, 0);
+
+    checkLease4Stats(88, 2, 0);
+
+    // Now send the command. The second deleted lease is identified by
+    // its hardware address and the last lease is an update.
+    string cmd =
+        "{\n"
+        "    \"command\": \"lease4-bulk-apply\",\n"
+        "    \"arguments\": {"
+        "        \"deleted-leases\": ["
+        "            {"
+        "                \"ip-address\": \"192.0.2.1\""
+        "            },"
+        "            {"
+        "                \"identifier-type\": \"hw-address\","
+        "                \"identifier\": \"08:08:08:08:08:08\","
+        "                \"subnet-id\": 88"
+        "            }"
+        "        ],"
+        "        \"leases\": ["
+        "            {"
+        "                \"subnet-id\": 44,\n"
+        "                \"ip-address\": \"192.0.2.123\",\n"
+        "                \"hw-address\": \"1a:1b:1c:1d:1e:1f\"\n"
+        "            },"
+        "            {"
+        "                \"subnet-id\": 88,\n"
+        "                \"ip-address\": \"192.0.3.123\",\n"
+        "                \"hw-address\": \"2a:2b:2c:2d:2e:2f\"\n"
+        "            },"
+        "            {"
+        "                \"subnet-id\": 44,\n"
+        "                \"ip-address\": \"192.0.2.2\",\n"
+        "                \"hw-address\": \"09:09:09:09:09:09\",\n"
+        "                \"hostname\": \"newhostname.example.org\"\n"
+        "            }"
+        "        ]"
+        "    }"
+        "}";
+    string exp_rsp = "Bulk apply of 5 IPv4 leases completed.";
+
+    // The status expected is success.
+    testCommand(cmd, CONTROL_RESULT_SUCCESS, exp_rsp);
+
+    checkLease4Stats(44, 2, 0);
+
+    checkLease4Stats(88, 2, 0);
+
+    //  Check that the leases we inserted are stored.
+    EXPECT_TRUE(lmptr_->getLease4(IOAddress("192.0.2.123")));
+    EXPECT_TRUE(lmptr_->getLease4(IOAddress("192.0.3.123")));
+
+    // Check that the lease we updated has been updated.
+    Lease4Ptr lease = lmptr_->getLease4(IOAddress("192.0.2.2"));
+    ASSERT_TRUE(lease);
+    EXPECT_EQ("newhostname.example.org", lease->hostname_);
+
+    // Check that the leases we deleted are gone,
+    EXPECT_FALSE(lmptr_->getLease4(IOAddress("192.0.2.1")));
+    EXPECT_FALSE(lmptr_->getLease4(IOAddress("192.0.3.1")));
+}
+
+TEST_F(LeaseCmdsTest, lease4BulkApply) {
+    testLease4BulkApply();
+}
+
+TEST_F(LeaseCmdsTest, lease4BulkApplyMultiThreading) {
+    MultiThreadingTest mt(true);
+    testLease4BulkApply();
+}
+
+void LeaseCmdsTest::testLease4BulkApplyDeleteNonExiting() {
+
+    // Initialize lease manager (false = v4, true = add leases)
+    initLeaseMgr(false, true);
+
+    checkLease4Stats(44, 2, 0);
+
+    // Now send the command.
+    string cmd =
+        "{\n"
+        "    \"command\": \"lease4-bulk-apply\",\n"
+        "    \"arguments\": {"
+        "        \"deleted-leases\": ["
+        "            {"
+        "                \"ip-address\": \"192.0.2.123\""
+        "            },"
+        "            {"
+        "                \"ip-address\": \"192.0.2.234\""
+        "            }"
+        "        ]"
+        "    }"
+        "}";
+    string exp_rsp = "Bulk apply of 0 IPv4 leases completed.";
+
+    // The status expected is empty.
+    auto resp = testCommand(cmd, CONTROL_RESULT_EMPTY, exp_rsp);
+    ASSERT_TRUE(resp);
+    ASSERT_EQ(Element::map, resp->getType());
+
+    checkLease4Stats(44, 2, 0);
+
+    auto args = resp->get("arguments");
+    ASSERT_TRUE(args);
+    ASSERT_EQ(Element::map, args->getType());
+
+    auto failed_deleted_leases = args->get("failed-deleted-leases");
+    ASSERT_TRUE(failed_deleted_leases);
+    ASSERT_EQ(Element::list, failed_deleted_leases->getType());
+    ASSERT_EQ(2, failed_deleted_leases->size());
+
+    {
+        SCOPED_TRACE("lease address 192.0.2.123");
+        checkFailedLease(failed_deleted_leases, "V4", "192.0.2.123",
+                         CONTROL_RESULT_EMPTY, "lease not found");
+    }
+
+    {
+        SCOPED_TRACE("lease address 192.0.2.234");
+        checkFailedLease(failed_deleted_leases, "V4", "192.0.2.234",
+                         CONTROL_RESULT_EMPTY, "lease not found");
+    }
+}
+
+TEST_F(LeaseCmdsTest, lease4BulkApplyDeleteNonExiting) {
+    testLease4BulkApplyDeleteNonExiting();
+}
+
+TEST_F(LeaseCmdsTest, lease4BulkApplyDeleteNonExitingMultiThreading) {
+    MultiThreadingTest mt(true);
+    testLease4BulkApplyDeleteNonExiting();
+}
+
+void LeaseCmdsTest::testLease4BulkApplyRollback() {
+
+    // Initialize lease manager (false = v4, true = add leases)
+    initLeaseMgr(false, true);
+
+    checkLease4Stats(44, 2, 0);
+
+    // Now send the command.
+    string cmd =
+        "{\n"
+        "    \"command\": \"lease4-bulk-apply\",\n"
+        "    \"arguments\": {"
+        "        \"deleted-leases\": ["
+        "            {"
+        "                \"ip-address\": \"192.0.2.1\""
+        "            }"
+        "        ],"
+        "        \"leases\": ["
+        "            {"
+        "                \"subnet-id\": 44,\n"
+        "                \"ip-address\": \"192.0.2.123\","
+        "                \"hw-address\": \"1a:1b:1c:1d:1e:1f\"\n"
+        "            },"
+        "            {"
+        "                \"subnet-id\": 44,"
+        "                \"ip-address\": \"192.0.2.124\""
+        "            }"
+        "        ]"
+        "    }"
+        "}";
+    string exp_rsp = "missing parameter 'hw-address' (<string>:5:28)";
+
+    // The status expected is error.
+    testCommand(cmd, CONTROL_RESULT_ERROR, exp_rsp);
+
+    checkLease4Stats(44, 2, 0);
+
+    EXPECT_FALSE(lmptr_->getLease4(IOAddress("192.0.2.123")));
+    EXPECT_FALSE(lmptr_->getLease4(IOAddress("192.0.2.124")));
+
+    EXPECT_TRUE(lmptr_->getLease4(IOAddress("192.0.2.1")));
+}
+
+TEST_F(LeaseCmdsTest, lease4BulkApplyRollback) {
+    testLease4BulkApplyRollback();
+}
+
+TEST_F(LeaseCmdsTest, lease4BulkApplyRollbackMultiThreading) {
+    MultiThreadingTest mt(true);
+    testLease4BulkApplyRollback();
+}
+
+void LeaseCmdsTest::testLease4BulkApplyBinary() {
+
+    // Initialize lease manager (false = v4, true = add leases)
+    initLeaseMgr(false, true);
+
+    // Add a new lease and update an existing one.
+    Lease4Collection leases;
+    HWAddrPtr hwaddr(new HWAddr(HWAddr::fromText("1a:1b:1c:1d:1e:1f")));
+    leases.push_back(Lease4Ptr(new Lease4(IOAddress("192.0.2.123"), hwaddr,
+                                          ClientIdPtr(), 3600, time(0), 44)));
+    Lease4Ptr updated(new Lease4(*lmptr_->getLease4(IOAddress("192.0.2.2"))));
+    updated->hostname_ = "newhostname.example.org";
+    leases.push_back(updated);
+
+    string cmd =
+        "{\n"
+        "    \"command\": \"lease4-bulk-apply\",\n"
+        "    \"arguments\": {"
+        "        \"deleted-leases\": ["
+        "            {"
+        "                \"ip-address\": \"192.0.2.1\""
+        "            }"
+        "        ],"
+        "        \"leases-binary\": \"" + LeaseCodec::encodeText(leases) + "\""
+        "    }"
+        "}";
+    string exp_rsp = "Bulk apply of 3 IPv4 leases completed.";
+    testCommand(cmd, CONTROL_RESULT_SUCCESS, exp_rsp);
+
+    checkLease4Stats(44, 2, 0);
+
+    //  Check that the lease we inserted is stored.
+    Lease4Ptr lease = lmptr_->getLease4(IOAddress("192.0.2.123"));
+    ASSERT_TRUE(lease);
+    EXPECT_EQ(44, lease->subnet_id_);
+    EXPECT_EQ("1a:1b:1c:1d:1e:1f", lease->hwaddr_->toText(false));
+
+    // Check that the lease we updated has been updated.
+    lease = lmptr_->getLease4(IOAddress("192.0.2.2"));
+    ASSERT_TRUE(lease);
+    EXPECT_EQ("newhostname.example.org", lease->hostname_);
+
+    // Check that the lease we deleted is gone.
+    EXPECT_FALSE(lmptr_->getLease4(IOAddress("192.0.2.1")));
+
+    // A lease out of its subnet is rejected and no change is applied.
+    leases[0]->addr_ = IOAddress("192.0.2.124");
+    leases[1]->addr_ = IOAddress("192.0.3.124");
+    cmd =
+        "{\n"
+        "    \"command\": \"lease4-bulk-apply\",\n"
+        "    \"arguments\": {"
+        "        \"leases-binary\": \"" + LeaseCodec::encodeText(leases) + "\""
+        "    }"
+        "}";
+    exp_rsp = "The address 192.0.3.124 does not belong to subnet 192.0.2.0/24,"
+        " subnet-id=44";
+    testCommand(cmd, CONTROL_RESULT_ERROR, exp_rsp);
+    EXPECT_FALSE(lmptr_->getLease4(IOAddress("192.0.2.124")));
+
+    // The encoded leases must be valid.
+    cmd =
+        "{\n"
+        "    \"command\": \"lease4-bulk-apply\",\n"
+        "    \"arguments\": {"
+        "        \"leases-binary\": \"AQQB\""
+        "    }"
+        "}";
+    exp_rsp = "truncated encoded leases";
+    testCommand(cmd, CONTROL_RESULT_ERROR, exp_rsp);
+}
+
+TEST_F(LeaseCmdsTest, lease4BulkApplyBinary) {
+    testLease4BulkApplyBinary();
+}
+
+TEST_F(LeaseCmdsTest, lease4BulkApplyBinaryMultiThreading) {
+    MultiThreadingTest mt(true);
+    testLease4BulkApplyBinary();
+}
+
 void LeaseCmdsTest::testLease6BulkApply() {
 
     // Initialize lease manager (true = v6, true = add leases)
@@ -7864,6 +8370,83 @@ TEST_F(LeaseCmdsTest, lease6BulkApplyRollbackMultiThreading) {
     testLease6BulkApplyRollback();
 }
 
+void LeaseCmdsTest::testLease6BulkApplyBinary() {
+
+    // Initialize lease manager (true = v6, true = add leases)
+    initLeaseMgr(true, true);
+
+    // Add two new leases.
+    Lease6Collection leases;
+    DuidPtr duid(new DUID(DUID::fromText("11:11:11:11:11:11")));
+    leases.push_back(Lease6Ptr(new Lease6(Lease::TYPE_NA, IOAddress("2001:db8:1::123"),
+                                          duid, 1234, 3000, 4000, 66)));
+    leases.push_back(Lease6Ptr(new Lease6(Lease::TYPE_NA, IOAddress("2001:db8:2::123"),
+                                          duid, 1234, 3000, 4000, 99)));
+
+    string cmd =
+        "{\n"
+        "    \"command\": \"lease6-bulk-apply\",\n"
+        "    \"arguments\": {"
+        "        \"deleted-leases\": ["
+        "            {"
+        "                \"ip-address\": \"2001:db8:1::1\","
+        "                \"type\": \"IA_NA\""
+        "            }"
+        "        ],"
+        "        \"leases-binary\": \"" + LeaseCodec::encodeText(leases) + "\""
+        "    }"
+        "}";
+    string exp_rsp = "Bulk apply of 3 IPv6 leases completed.";
+    testCommand(cmd, CONTROL_RESULT_SUCCESS, exp_rsp);
+
+    checkLease6Stats(66, 2, 0, 0);
+
+    checkLease6Stats(99, 3, 0, 0);
+
+    //  Check that the leases we inserted are stored.
+    Lease6Ptr lease = lmptr_->getLease6(Lease::TYPE_NA, IOAddress("2001:db8:1::123"));
+    ASSERT_TRUE(lease);
+    EXPECT_EQ(1234, lease->iaid_);
+    EXPECT_EQ(3000, lease->preferred_lft_);
+    EXPECT_TRUE(lmptr_->getLease6(Lease::TYPE_NA, IOAddress("2001:db8:2::123")));
+
+    // Check that the lease we deleted is gone.
+    EXPECT_FALSE(lmptr_->getLease6(Lease::TYPE_NA, IOAddress("2001:db8:1::1")));
+
+    // Leases in an unknown subnet are rejected.
+    leases[0]->subnet_id_ = 123;
+    cmd =
+        "{\n"
+        "    \"command\": \"lease6-bulk-apply\",\n"
+        "    \"arguments\": {"
+        "        \"leases-binary\": \"" + LeaseCodec::encodeText(leases) + "\""
+        "    }"
+        "}";
+    exp_rsp = "Invalid subnet-id: No IPv6 subnet with subnet-id=123 currently"
+        " configured.";
+    testCommand(cmd, CONTROL_RESULT_ERROR, exp_rsp);
+
+    // IPv4 leases are not accepted.
+    cmd =
+        "{\n"
+        "    \"command\": \"lease6-bulk-apply\",\n"
+        "    \"arguments\": {"
+        "        \"leases-binary\": \"" + LeaseCodec::encodeText(Lease4Collection()) + "\""
+        "    }"
+        "}";
+    exp_rsp = "the encoded leases are not IPv6 leases";
+    testCommand(cmd, CONTROL_RESULT_ERROR, exp_rsp);
+}
+
+TEST_F(LeaseCmdsTest, lease6BulkApplyBinary) {
+    testLease6BulkApplyBinary();
+}
+
+TEST_F(LeaseCmdsTest, lease6BulkApplyBinaryMultiThreading) {
+    MultiThreadingTest mt(true);
+    testLease6BulkApplyBinary();
+}
+
 void LeaseCmdsTest::testLease4ResendDdnsBadParam() {
 
     // Initialize lease manager (false = v4, true = add leases)
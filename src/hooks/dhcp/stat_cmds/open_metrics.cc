@@ -0,0 +1,170 @@
+// Copyright (C) 2022 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <open_metrics.h>
+#include <stat_cmds_log.h>
+#include <cc/dhcp_config_error.h>
+#include <cc/simple_parser.h>
+#include <config/timeouts.h>
+#include <http/response.h>
+#include <stats/stats_mgr.h>
+#include <sstream>
+
+using namespace isc::asiolink;
+using namespace isc::config;
+using namespace isc::data;
+using namespace isc::http;
+using namespace isc::stats;
+
+namespace {
+
+/// @brief Content type of the OpenMetrics text format.
+const char* OPEN_METRICS_CONTENT_TYPE =
+    "application/openmetrics-text; version=1.0.0; charset=utf-8";
+
+/// @brief Path of the scrape endpoint.
+const char* OPEN_METRICS_PATH = "/metrics";
+
+/// @brief Keywords of the "open-metrics" parameter.
+const SimpleKeywords OPEN_METRICS_KEYWORDS = {
+    { "http-host", Element::string },
+    { "http-port", Element::integer },
+    { "prefix",    Element::string }
+};
+
+/// @brief Default values of the "open-metrics" parameter.
+const SimpleDefaults OPEN_METRICS_DEFAULTS = {
+    { "http-host", Element::string,  "127.0.0.1" },
+    { "http-port", Element::integer, "9547" },
+    { "prefix",    Element::string,  "kea" }
+};
+
+} // end of anonymous namespace
+
+namespace isc {
+namespace stat_cmds {
+
+HttpRequestPtr
+OpenMetricsResponseCreator::createNewHttpRequest() const {
+    HttpRequestPtr request(new HttpRequest());
+    request->requireHttpMethod(HttpRequest::Method::HTTP_GET);
+    return (request);
+}
+
+HttpResponsePtr
+OpenMetricsResponseCreator::
+createStockHttpResponse(const HttpRequestPtr& request,
+                        const HttpStatusCode& status_code) const {
+    HttpResponsePtr response = createStockHttpResponseInternal(request, status_code);
+    response->finalize();
+    return (response);
+}
+
+HttpResponsePtr
+OpenMetricsResponseCreator::
+createStockHttpResponseInternal(const HttpRequestPtr& request,
+                                const HttpStatusCode& status_code) const {
+    // The request hasn't been finalized so the request object
+    // doesn't contain any information about the HTTP version number
+    // used. But, the context should have this data (assuming the
+    // HTTP version is parsed OK).
+    HttpVersion http_version(request->context()->http_version_major_,
+                             request->context()->http_version_minor_);
+    // We only accept HTTP version 1.0 or 1.1. If other version number is found
+    // we fall back to HTTP/1.0.
+    if ((http_version < HttpVersion(1, 0)) || (HttpVersion(1, 1) < http_version)) {
+        http_version.major_ = 1;
+        http_version.minor_ = 0;
+    }
+    HttpResponsePtr response(new HttpResponse(http_version, status_code));
+    return (response);
+}
+
+HttpResponsePtr
+OpenMetricsResponseCreator::createDynamicHttpResponse(HttpRequestPtr request) {
+    // Ignore the query string if any.
+    std::string path = request->getUri();
+    path = path.substr(0, path.find('?'));
+    if (path != OPEN_METRICS_PATH) {
+        return (createStockHttpResponse(request, HttpStatusCode::NOT_FOUND));
+    }
+
+    // Write the statistics straight in the response body.
+    std::ostringstream body;
+    StatsMgr::instance().writeOpenMetrics(body, prefix_);
+
+    HttpResponsePtr response =
+        createStockHttpResponseInternal(request, HttpStatusCode::OK);
+    response->context()->headers_.push_back(
+        HttpHeaderContext("Content-Type", OPEN_METRICS_CONTENT_TYPE));
+    response->context()->body_ = body.str();
+    response->finalize();
+    return (response);
+}
+
+OpenMetrics::OpenMetrics(const ConstElementPtr& config)
+    : address_("127.0.0.1"), port_(0), prefix_(), io_service_(), listener_() {
+    if (!config || (config->getType() != Element::map)) {
+        isc_throw(dhcp::DhcpConfigError, "'open-metrics' parameter must be a map");
+    }
+    SimpleParser::checkKeywords(OPEN_METRICS_KEYWORDS, config);
+    ElementPtr params = copy(config);
+    SimpleParser::setDefaults(params, OPEN_METRICS_DEFAULTS);
+
+    SimpleParser parser;
+    std::string host = parser.getString(params, "http-host");
+    try {
+        address_ = IOAddress(host);
+    } catch (const std::exception& ex) {
+        isc_throw(dhcp::DhcpConfigError, "invalid 'http-host' parameter '"
+                  << host << "': " << ex.what());
+    }
+    port_ = parser.getUint16(params, "http-port");
+    prefix_ = parser.getString(params, "prefix");
+}
+
+OpenMetrics::~OpenMetrics() {
+    stop();
+}
+
+void
+OpenMetrics::start(const IOServicePtr& io_service) {
+    stop();
+    if (!io_service) {
+        isc_throw(BadValue, "OpenMetrics endpoint requires an IO service");
+    }
+    io_service_ = io_service;
+    HttpResponseCreatorFactoryPtr rcf(new OpenMetricsResponseCreatorFactory(prefix_));
+    TlsContextPtr tls_context;
+    listener_.reset(new HttpListener(*io_service_, address_, port_, tls_context, rcf,
+                                     HttpListener::RequestTimeout(TIMEOUT_AGENT_RECEIVE_COMMAND),
+                                     HttpListener::IdleTimeout(TIMEOUT_AGENT_IDLE_CONNECTION_TIMEOUT)));
+    listener_->start();
+    LOG_INFO(stat_cmds_logger, STAT_CMDS_OPEN_METRICS_STARTED)
+        .arg(address_)
+        .arg(port_);
+}
+
+void
+OpenMetrics::stop() {
+    if (!listener_) {
+        return;
+    }
+    listener_->stop();
+    listener_.reset();
+    // Run the handlers of the closed connections now: they must not be
+    // invoked after the library is unloaded.
+    io_service_->poll();
+    io_service_.reset();
+    LOG_INFO(stat_cmds_logger, STAT_CMDS_OPEN_METRICS_STOPPED)
+        .arg(address_)
+        .arg(port_);
+}
+
+} // end of namespace isc::stat_cmds
+} // end of namespace isc
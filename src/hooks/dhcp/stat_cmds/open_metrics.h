@@ -0,0 +1,184 @@
+// Copyright (C) 2022 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPEN_METRICS_H
+#define OPEN_METRICS_H
+
+#include <asiolink/io_address.h>
+#include <asiolink/io_service.h>
+#include <cc/data.h>
+#include <http/listener.h>
+#include <http/response_creator.h>
+#include <http/response_creator_factory.h>
+#include <boost/shared_ptr.hpp>
+#include <string>
+
+namespace isc {
+namespace stat_cmds {
+
+/// @brief HTTP response creator serving statistics in the OpenMetrics
+/// text format.
+///
+/// The creator answers to GET requests on the "/metrics" path (the
+/// default path scraped by Prometheus) with all the statistics written
+/// by @ref isc::stats::StatsMgr::writeOpenMetrics. The statistics are
+/// written straight into the response body without building any
+/// intermediate JSON structure.
+class OpenMetricsResponseCreator : public http::HttpResponseCreator {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// @param prefix prefix of metric family names.
+    explicit OpenMetricsResponseCreator(const std::string& prefix)
+        : prefix_(prefix) {
+    }
+
+    /// @brief Create a new request.
+    ///
+    /// @return Pointer to a new instance of the @ref isc::http::HttpRequest
+    /// accepting only the GET method.
+    virtual http::HttpRequestPtr createNewHttpRequest() const;
+
+    /// @brief Creates stock HTTP response.
+    ///
+    /// @param request Pointer to an object representing HTTP request.
+    /// @param status_code Status code of the response.
+    /// @return Pointer to an @ref isc::http::HttpResponse object
+    /// representing stock HTTP response.
+    virtual http::HttpResponsePtr
+    createStockHttpResponse(const http::HttpRequestPtr& request,
+                            const http::HttpStatusCode& status_code) const;
+
+private:
+
+    /// @brief Creates un-finalized stock HTTP response.
+    ///
+    /// @param request Pointer to an object representing HTTP request.
+    /// @param status_code Status code of the response.
+    /// @return Pointer to an @ref isc::http::HttpResponse object
+    /// representing stock HTTP response.
+    http::HttpResponsePtr
+    createStockHttpResponseInternal(const http::HttpRequestPtr& request,
+                                    const http::HttpStatusCode& status_code) const;
+
+    /// @brief Creates the response with the statistics.
+    ///
+    /// @param request Pointer to an object representing HTTP request.
+    /// @return Pointer to an object representing HTTP response.
+    virtual http::HttpResponsePtr
+    createDynamicHttpResponse(http::HttpRequestPtr request);
+
+    /// @brief Prefix of metric family names.
+    std::string prefix_;
+};
+
+/// @brief HTTP response creator factory for the OpenMetrics endpoint.
+class OpenMetricsResponseCreatorFactory : public http::HttpResponseCreatorFactory {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// @param prefix prefix of metric family names.
+    explicit OpenMetricsResponseCreatorFactory(const std::string& prefix)
+        : creator_(new OpenMetricsResponseCreator(prefix)) {
+    }
+
+    /// @brief Returns an instance of the @ref OpenMetricsResponseCreator.
+    ///
+    /// The creator is stateless so the same instance is always returned.
+    ///
+    /// @return Pointer to the response creator.
+    virtual http::HttpResponseCreatorPtr create() const {
+        return (creator_);
+    }
+
+private:
+
+    /// @brief Instance of the response creator.
+    http::HttpResponseCreatorPtr creator_;
+};
+
+/// @brief OpenMetrics (Prometheus) scrape endpoint.
+///
+/// The endpoint is configured by the "open-metrics" map of the library
+/// parameters:
+/// @code
+/// "open-metrics": {
+///     "http-host": "127.0.0.1",
+///     "http-port": 9547,
+///     "prefix": "kea_dhcp4"
+/// }
+/// @endcode
+/// It runs a @ref isc::http::HttpListener on the IO service of the server
+/// so it does not require the Control Agent.
+class OpenMetrics {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// All parameters are optional: the endpoint listens by default
+    /// on 127.0.0.1 port 9547 and uses the "kea" prefix.
+    ///
+    /// @param config the "open-metrics" map of the library parameters.
+    /// @throw DhcpConfigError if the configuration is not valid.
+    explicit OpenMetrics(const data::ConstElementPtr& config);
+
+    /// @brief Destructor.
+    ///
+    /// Stops the listener.
+    ~OpenMetrics();
+
+    /// @brief Starts accepting scrape requests.
+    ///
+    /// Any previously started listener is stopped first.
+    ///
+    /// @param io_service IO service of the server.
+    void start(const asiolink::IOServicePtr& io_service);
+
+    /// @brief Stops accepting scrape requests.
+    void stop();
+
+    /// @brief Returns the address the endpoint listens on.
+    const asiolink::IOAddress& getAddress() const {
+        return (address_);
+    }
+
+    /// @brief Returns the port the endpoint listens on.
+    uint16_t getPort() const {
+        return (port_);
+    }
+
+    /// @brief Returns the prefix of metric family names.
+    const std::string& getPrefix() const {
+        return (prefix_);
+    }
+
+private:
+
+    /// @brief Address the endpoint listens on.
+    asiolink::IOAddress address_;
+
+    /// @brief Port the endpoint listens on.
+    uint16_t port_;
+
+    /// @brief Prefix of metric family names.
+    std::string prefix_;
+
+    /// @brief IO service of the server.
+    asiolink::IOServicePtr io_service_;
+
+    /// @brief The HTTP listener.
+    http::HttpListenerPtr listener_;
+};
+
+/// @brief Pointer to the @ref OpenMetrics endpoint.
+typedef boost::shared_ptr<OpenMetrics> OpenMetricsPtr;
+
+} // end of namespace isc::stat_cmds
+} // end of namespace isc
+
+#endif // OPEN_METRICS_H
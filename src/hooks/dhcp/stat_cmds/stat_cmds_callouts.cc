@@ -1,4 +1,4 @@
-// Copyright (C) 2018-2020 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2018-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -10,14 +10,45 @@
 
 #include <config.h>
 
+#include <open_metrics.h>
 #include <stat_cmds.h>
 #include <stat_cmds_log.h>
+#include <asiolink/io_service.h>
 #include <cc/command_interpreter.h>
 #include <hooks/hooks.h>
 
+using namespace isc::asiolink;
+using namespace isc::data;
 using namespace isc::hooks;
 using namespace isc::stat_cmds;
 
+namespace {
+
+/// @brief The OpenMetrics endpoint (null when not configured).
+OpenMetricsPtr open_metrics;
+
+/// @brief Starts the OpenMetrics endpoint when it is configured.
+///
+/// @param handle callout handle.
+/// @return 0 on success, 1 otherwise.
+int startOpenMetrics(CalloutHandle& handle) {
+    if (!open_metrics) {
+        return (0);
+    }
+    try {
+        IOServicePtr io_service;
+        handle.getArgument("io_context", io_service);
+        open_metrics->start(io_service);
+    } catch (const std::exception& ex) {
+        LOG_ERROR(stat_cmds_logger, STAT_CMDS_OPEN_METRICS_START_FAILED)
+            .arg(ex.what());
+        return (1);
+    }
+    return (0);
+}
+
+} // end of anonymous namespace
+
 extern "C" {
 
 /// @brief This is a command callout for 'stat-lease4-get' command.
@@ -42,11 +73,44 @@ int stat_lease6_get(CalloutHandle& handle) {
     return(stat_cmds.statLease6GetHandler(handle));
 }
 
+/// @brief dhcp4_srv_configured callout implementation.
+///
+/// Starts the OpenMetrics endpoint on the server IO service.
+///
+/// @param handle callout handle.
+/// @return 0 on success, 1 otherwise.
+int dhcp4_srv_configured(CalloutHandle& handle) {
+    return (startOpenMetrics(handle));
+}
+
+/// @brief dhcp6_srv_configured callout implementation.
+///
+/// Starts the OpenMetrics endpoint on the server IO service.
+///
+/// @param handle callout handle.
+/// @return 0 on success, 1 otherwise.
+int dhcp6_srv_configured(CalloutHandle& handle) {
+    return (startOpenMetrics(handle));
+}
+
 /// @brief This function is called when the library is loaded.
 ///
+/// The optional "open-metrics" parameter configures the OpenMetrics
+/// (Prometheus) scrape endpoint.
+///
 /// @param handle library handle
 /// @return 0 when initialization is successful, 1 otherwise
 int load(LibraryHandle& handle) {
+    try {
+        ConstElementPtr config = handle.getParameter("open-metrics");
+        if (config) {
+            open_metrics.reset(new OpenMetrics(config));
+        }
+    } catch (const std::exception& ex) {
+        LOG_ERROR(stat_cmds_logger, STAT_CMDS_INIT_FAILED)
+            .arg(ex.what());
+        return (1);
+    }
     handle.registerCommandCallout("stat-lease4-get", stat_lease4_get);
     handle.registerCommandCallout("stat-lease6-get", stat_lease6_get);
     LOG_INFO(stat_cmds_logger, STAT_CMDS_INIT_OK);
@@ -57,6 +121,7 @@ int load(LibraryHandle& handle) {
 ///
 /// @return 0 if deregistration was successful, 1 otherwise
 int unload() {
+    open_metrics.reset();
     LOG_INFO(stat_cmds_logger, STAT_CMDS_DEINIT_OK);
     return (0);
 }
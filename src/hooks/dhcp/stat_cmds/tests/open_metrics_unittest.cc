@@ -0,0 +1,135 @@
+// Copyright (C) 2022 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <open_metrics.h>
+#include <cc/data.h>
+#include <cc/dhcp_config_error.h>
+#include <http/request.h>
+#include <http/response.h>
+#include <stats/stats_mgr.h>
+#include <gtest/gtest.h>
+
+using namespace isc;
+using namespace isc::data;
+using namespace isc::dhcp;
+using namespace isc::http;
+using namespace isc::stat_cmds;
+using namespace isc::stats;
+
+namespace {
+
+/// @brief Test fixture for the OpenMetrics endpoint.
+class OpenMetricsTest : public ::testing::Test {
+public:
+
+    /// @brief Constructor.
+    OpenMetricsTest() {
+        StatsMgr::instance().removeAll();
+    }
+
+    /// @brief Destructor.
+    virtual ~OpenMetricsTest() {
+        StatsMgr::instance().removeAll();
+    }
+
+    /// @brief Creates a finalized request.
+    ///
+    /// @param creator response creator used to create the request.
+    /// @param method HTTP method.
+    /// @param uri URI.
+    /// @return the request.
+    HttpRequestPtr createRequest(OpenMetricsResponseCreator& creator,
+                                 const std::string& method,
+                                 const std::string& uri) {
+        HttpRequestPtr request = creator.createNewHttpRequest();
+        request->context()->method_ = method;
+        request->context()->uri_ = uri;
+        request->context()->http_version_major_ = 1;
+        request->context()->http_version_minor_ = 1;
+        try {
+            request->finalize();
+        } catch (const std::exception&) {
+            // Not finalized requests get a bad request response.
+        }
+        return (request);
+    }
+};
+
+// Checks the parsing of the "open-metrics" parameter.
+TEST_F(OpenMetricsTest, configure) {
+    // All parameters are optional.
+    OpenMetricsPtr open_metrics;
+    ASSERT_NO_THROW(open_metrics.reset(new OpenMetrics(Element::createMap())));
+    EXPECT_EQ("127.0.0.1", open_metrics->getAddress().toText());
+    EXPECT_EQ(9547, open_metrics->getPort());
+    EXPECT_EQ("kea", open_metrics->getPrefix());
+
+    ConstElementPtr config = Element::fromJSON("{ \"http-host\": \"::1\", "
+                                               "\"http-port\": 8000, "
+                                               "\"prefix\": \"kea_dhcp6\" }");
+    ASSERT_NO_THROW(open_metrics.reset(new OpenMetrics(config)));
+    EXPECT_EQ("::1", open_metrics->getAddress().toText());
+    EXPECT_EQ(8000, open_metrics->getPort());
+    EXPECT_EQ("kea_dhcp6", open_metrics->getPrefix());
+
+    // Invalid configurations.
+    EXPECT_THROW(OpenMetrics(Element::create(1)), DhcpConfigError);
+    EXPECT_THROW(OpenMetrics(Element::fromJSON("{ \"foo\": 1 }")),
+                 DhcpConfigError);
+    EXPECT_THROW(OpenMetrics(Element::fromJSON("{ \"http-host\": \"foo\" }")),
+                 DhcpConfigError);
+    EXPECT_THROW(OpenMetrics(Element::fromJSON("{ \"http-port\": 70000 }")),
+                 DhcpConfigError);
+    EXPECT_THROW(OpenMetrics(Element::fromJSON("{ \"prefix\": 1 }")),
+                 DhcpConfigError);
+}
+
+// Checks that a scrape returns the statistics.
+TEST_F(OpenMetricsTest, scrape) {
+    StatsMgr::instance().setValue("pkt4-received", static_cast<int64_t>(5));
+    StatsMgr::instance().setValue("subnet[1].assigned-addresses",
+                                  static_cast<int64_t>(2));
+
+    OpenMetricsResponseCreator creator("kea_dhcp4");
+    HttpRequestPtr request = createRequest(creator, "GET", "/metrics");
+    HttpResponsePtr response = creator.createHttpResponse(request);
+    ASSERT_TRUE(response);
+    EXPECT_EQ(HttpStatusCode::OK, response->getStatusCode());
+    EXPECT_EQ("application/openmetrics-text; version=1.0.0; charset=utf-8",
+              response->getHeaderValue("Content-Type"));
+    std::string expected =
+        "# TYPE kea_dhcp4_pkt4_received gauge\n"
+        "kea_dhcp4_pkt4_received 5\n"
+        "# TYPE kea_dhcp4_subnet_assigned_addresses gauge\n"
+        "kea_dhcp4_subnet_assigned_addresses{subnet=\"1\"} 2\n"
+        "# EOF\n";
+    EXPECT_EQ(expected, response->getBody());
+
+    // The query string is ignored.
+    request = createRequest(creator, "GET", "/metrics?foo=bar");
+    response = creator.createHttpResponse(request);
+    ASSERT_TRUE(response);
+    EXPECT_EQ(HttpStatusCode::OK, response->getStatusCode());
+    EXPECT_EQ(expected, response->getBody());
+}
+
+// Checks that other paths and methods are rejected.
+TEST_F(OpenMetricsTest, badRequests) {
+    OpenMetricsResponseCreator creator("kea");
+    HttpRequestPtr request = createRequest(creator, "GET", "/");
+    HttpResponsePtr response = creator.createHttpResponse(request);
+    ASSERT_TRUE(response);
+    EXPECT_EQ(HttpStatusCode::NOT_FOUND, response->getStatusCode());
+
+    request = createRequest(creator, "POST", "/metrics");
+    response = creator.createHttpResponse(request);
+    ASSERT_TRUE(response);
+    EXPECT_EQ(HttpStatusCode::BAD_REQUEST, response->getStatusCode());
+}
+
+}
@@ -1,4 +1,4 @@
-// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2021-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -149,6 +149,16 @@ public:
         Base::async_shutdown(callback);
     }
 
+    /// @brief Check if the handshake resumed a previous session.
+    ///
+    /// @note Botan doesn't report whether the session it established
+    /// was resumed from the session manager of the context.
+    ///
+    /// @return Always false.
+    virtual bool isSessionReused() {
+        return (false);
+    }
+
     /// @brief Clear the TLS object.
     ///
     /// @note The idea to reuse a TCP connection for a fresh TLS is at
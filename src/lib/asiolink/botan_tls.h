@@ -1,4 +1,4 @@
-// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2021-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -131,6 +131,11 @@ public:
         isc_throw(NotImplemented, "Botan TLS is not yet supported");
     }
 
+    /// @brief Check if the handshake resumed a previous session.
+    virtual bool isSessionReused() {
+        return (false);
+    }
+
     /// @brief Return the commonName part of the subjectName of
     /// the peer certificate.
     ///
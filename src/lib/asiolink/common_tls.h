@@ -1,4 +1,4 @@
-// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2021-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -151,6 +151,12 @@ public:
     /// @param callback Callback object.
     virtual void shutdown(Callback& callback) = 0;
 
+    /// @brief Check if the handshake resumed a previous session.
+    ///
+    /// @return True if the session was resumed, false if a full
+    /// handshake was performed.
+    virtual bool isSessionReused() = 0;
+
     /// @brief Return the commonName part of the subjectName of
     /// the peer certificate.
     ///
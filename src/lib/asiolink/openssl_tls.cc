@@ -1,4 +1,4 @@
-// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2021-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -22,13 +22,28 @@ using namespace boost::asio::ssl;
 using namespace boost::system;
 using namespace isc::cryptolink;
 
+namespace {
+
+/// @brief Index of the TlsContext pointer in the SSL_CTX extra data.
+int getContextIndex() {
+    static int index = ::SSL_CTX_get_ex_new_index(0, 0, 0, 0, 0);
+    return (index);
+}
+
+/// @brief Session id context of the servers.
+///
+/// Required to resume sessions when peer certificates are verified.
+const unsigned char SESSION_ID_CONTEXT[] = "kea";
+
+}
+
 namespace isc {
 namespace asiolink {
 
 // Enforce TLS 1.2 when the generic TLS method is not available (i.e.
 // the boost version is older than 1.64.0).
 TlsContext::TlsContext(TlsRole role)
-    : TlsContextBase(role), cert_required_(true),
+    : TlsContextBase(role), cert_required_(true), session_(0),
 #ifdef HAVE_GENERIC_TLS_METHOD
       context_(context::method::tls)
 #else
@@ -41,6 +56,25 @@ TlsContext::TlsContext(TlsRole role)
 {
     // Not leave the verify mode to OpenSSL default.
     setCertRequired(true);
+
+    ::SSL_CTX* ctx = context_.native_handle();
+    if (role == TlsRole::CLIENT) {
+        // Keep the sessions in this object rather than in the OpenSSL
+        // internal cache which is not used by clients.
+        ::SSL_CTX_set_ex_data(ctx, getContextIndex(), this);
+        ::SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT |
+                                         SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        ::SSL_CTX_sess_set_new_cb(ctx, &TlsContext::newSessionCallback);
+    } else {
+        ::SSL_CTX_set_session_id_context(ctx, SESSION_ID_CONTEXT,
+                                         sizeof(SESSION_ID_CONTEXT) - 1);
+    }
+}
+
+TlsContext::~TlsContext() {
+    if (session_) {
+        ::SSL_SESSION_free(session_);
+    }
 }
 
 boost::asio::ssl::context&
@@ -76,6 +110,37 @@ TlsContext::getCertRequired() const {
     return (cert_required_);
 }
 
+void
+TlsContext::resumeSession(::SSL* ssl) {
+    std::lock_guard<std::mutex> lk(session_mutex_);
+    if (session_) {
+        // The connection takes its own reference to the session.
+        static_cast<void>(::SSL_set_session(ssl, session_));
+    }
+}
+
+void
+TlsContext::saveSession(::SSL_SESSION* session) {
+    std::lock_guard<std::mutex> lk(session_mutex_);
+    if (session_) {
+        ::SSL_SESSION_free(session_);
+    }
+    session_ = session;
+}
+
+int
+TlsContext::newSessionCallback(::SSL* ssl, ::SSL_SESSION* session) {
+    ::SSL_CTX* ctx = ::SSL_get_SSL_CTX(ssl);
+    TlsContext* context =
+        static_cast<TlsContext*>(::SSL_CTX_get_ex_data(ctx, getContextIndex()));
+    if (!context) {
+        // Let OpenSSL free the session.
+        return (0);
+    }
+    context->saveSession(session);
+    return (1);
+}
+
 void
 TlsContext::loadCaFile(const std::string& ca_file) {
     error_code ec;
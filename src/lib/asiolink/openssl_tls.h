@@ -20,6 +20,8 @@
 
 #include <boost/asio/ssl.hpp>
 
+#include <mutex>
+
 namespace isc {
 namespace asiolink {
 
@@ -37,10 +39,15 @@ class TlsContext : public TlsContextBase {
 public:
 
     /// @brief Destructor.
-    virtual ~TlsContext() { }
+    virtual ~TlsContext();
 
     /// @brief Create a fresh context.
     ///
+    /// Client contexts cache the last TLS session established with the
+    /// server and server contexts accept session resumption, so the
+    /// connections opened with the same context after the first one
+    /// can skip the full handshake.
+    ///
     /// @param role The TLS role client or server.
     explicit TlsContext(TlsRole role);
 
@@ -59,6 +66,15 @@ public:
     /// are optional.
     virtual bool getCertRequired() const;
 
+    /// @brief Offer the cached session for resumption.
+    ///
+    /// Called by @c TlsStream::handshake on client connections. Does
+    /// nothing when no session was cached yet. If the server refuses
+    /// the session a full handshake is performed.
+    ///
+    /// @param ssl The TLS connection before the client handshake.
+    void resumeSession(::SSL* ssl);
+
 protected:
     /// @brief Set the peer certificate requirement mode.
     ///
@@ -92,6 +108,24 @@ protected:
     /// @brief Boost ASIO SSL object.
     boost::asio::ssl::context context_;
 
+    /// @brief Cache the session established by a client connection.
+    ///
+    /// @param session The new session.
+    void saveSession(::SSL_SESSION* session);
+
+    /// @brief OpenSSL callback invoked when a new session is established.
+    ///
+    /// @param ssl The TLS connection.
+    /// @param session The new session.
+    /// @return 1 as the reference to the session is kept.
+    static int newSessionCallback(::SSL* ssl, ::SSL_SESSION* session);
+
+    /// @brief Last session established by a client connection.
+    ::SSL_SESSION* session_;
+
+    /// @brief Mutex protecting the cached session.
+    std::mutex session_mutex_;
+
     /// @brief Allow access to protected methods by the base class.
     friend class TlsContextBase;
 };
@@ -129,7 +163,7 @@ public:
     /// @param context Pointer to the TLS context.
     /// @note The caller must not provide a null pointer to the TLS context.
     TlsStream(IOService& service, TlsContextPtr context)
-        : Base(service, context) {
+        : Base(service, context), context_(context) {
     }
 
     /// @brief Destructor.
@@ -137,11 +171,25 @@ public:
 
     /// @brief TLS Handshake.
     ///
+    /// A client offers the last session established with the context
+    /// for resumption.
+    ///
     /// @param callback Callback object.
     virtual void handshake(Callback& callback) {
+        if (Base::getRole() == TlsRole::CLIENT) {
+            context_->resumeSession(this->native_handle());
+        }
         Base::async_handshake(roleToImpl(Base::getRole()), callback);
     }
 
+    /// @brief Check if the handshake resumed a previous session.
+    ///
+    /// @return True if the session was resumed, false if a full
+    /// handshake was performed.
+    virtual bool isSessionReused() {
+        return (::SSL_session_reused(this->native_handle()) == 1);
+    }
+
     /// @brief TLS shutdown.
     ///
     /// @param callback Callback object.
@@ -216,6 +264,10 @@ public:
         ::X509_free(cert);
         return (ret);
     }
+
+private:
+    /// @brief The TLS context holding the session cache.
+    TlsContextPtr context_;
 };
 
 // Stream truncated error code.
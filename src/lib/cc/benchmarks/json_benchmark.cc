@@ -0,0 +1,128 @@
+// Copyright (C) 2022 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <benchmark/benchmark.h>
+#include <cc/data.h>
+
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+using namespace isc::data;
+
+namespace {
+
+/// @brief Builds a configuration with the given number of reservations.
+///
+/// @param reservations the number of host reservations.
+/// @return the configuration in JSON format.
+std::string
+makeConfig(size_t reservations) {
+    std::ostringstream config;
+    config << "{\n"
+           << "    \"Dhcp4\": {\n"
+           << "        \"valid-lifetime\": 4000,\n"
+           << "        \"subnet4\": [ {\n"
+           << "            \"id\": 1,\n"
+           << "            \"subnet\": \"10.0.0.0/8\",\n"
+           << "            \"pools\": [ { \"pool\": \"10.0.0.1 - 10.255.255.254\" } ],\n"
+           << "            \"reservations\": [\n";
+    for (size_t i = 0; i < reservations; ++i) {
+        if (i > 0) {
+            config << ",\n";
+        }
+        config << "                {\n"
+               << "                    \"hw-address\": \"00:00:00:"
+               << std::hex << std::setfill('0')
+               << std::setw(2) << ((i >> 16) & 0xff) << ":"
+               << std::setw(2) << ((i >> 8) & 0xff) << ":"
+               << std::setw(2) << (i & 0xff) << std::dec << "\",\n"
+               << "                    \"ip-address\": \"10."
+               << ((i >> 16) & 0xff) << "." << ((i >> 8) & 0xff) << "."
+               << (i & 0xff) << "\",\n"
+               << "                    \"hostname\": \"host-" << i
+               << ".example.org\",\n"
+               << "                    \"option-data\": [ {\n"
+               << "                        \"name\": \"domain-name-servers\",\n"
+               << "                        \"data\": \"10.0.0.1, 10.0.0.2\",\n"
+               << "                        \"always-send\": true\n"
+               << "                    } ]\n"
+               << "                }";
+    }
+    config << "\n            ]\n"
+           << "        } ]\n"
+           << "    }\n"
+           << "}\n";
+    return (config.str());
+}
+
+/// @brief Sets the number of reservations argument.
+///
+/// @param b the benchmark.
+void jsonArguments(benchmark::internal::Benchmark* b) {
+    b->Arg(1000)->Arg(10000)->Arg(100000);
+}
+
+/// @brief Benchmarks the stream parser.
+///
+/// @param state the benchmark state.
+void parseStream(benchmark::State& state) {
+    const std::string config = makeConfig(state.range(0));
+    for (auto _ : state) {
+        std::istringstream in(config);
+        benchmark::DoNotOptimize(Element::fromJSON(in, std::string("<istream>")));
+    }
+    state.SetBytesProcessed(state.iterations() * config.size());
+}
+
+/// @brief Benchmarks the buffer parser.
+///
+/// @param state the benchmark state.
+void parseBuffer(benchmark::State& state) {
+    const std::string config = makeConfig(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Element::fromJSON(config));
+    }
+    state.SetBytesProcessed(state.iterations() * config.size());
+}
+
+/// @brief Benchmarks the stream serializer.
+///
+/// @param state the benchmark state.
+void serializeStream(benchmark::State& state) {
+    ConstElementPtr config = Element::fromJSON(makeConfig(state.range(0)));
+    size_t size = 0;
+    for (auto _ : state) {
+        std::ostringstream out;
+        config->toJSON(out);
+        size = out.str().size();
+        benchmark::DoNotOptimize(size);
+    }
+    state.SetBytesProcessed(state.iterations() * size);
+}
+
+/// @brief Benchmarks the string serializer.
+///
+/// @param state the benchmark state.
+void serializeString(benchmark::State& state) {
+    ConstElementPtr config = Element::fromJSON(makeConfig(state.range(0)));
+    size_t size = 0;
+    for (auto _ : state) {
+        const std::string out = config->str();
+        size = out.size();
+        benchmark::DoNotOptimize(size);
+    }
+    state.SetBytesProcessed(state.iterations() * size);
+}
+
+}  // namespace
+
+BENCHMARK(parseStream)->Apply(jsonArguments)->Unit(benchmark::kMillisecond);
+BENCHMARK(parseBuffer)->Apply(jsonArguments)->Unit(benchmark::kMillisecond);
+BENCHMARK(serializeStream)->Apply(jsonArguments)->Unit(benchmark::kMillisecond);
+BENCHMARK(serializeString)->Apply(jsonArguments)->Unit(benchmark::kMillisecond);
@@ -1,4 +1,4 @@
-// Copyright (C) 2010-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2010-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -13,6 +13,8 @@
 #include <climits>
 #include <list>
 #include <map>
+#include <mutex>
+#include <set>
 #include <cstdio>
 #include <iostream>
 #include <iomanip>
@@ -22,6 +24,7 @@
 #include <cerrno>
 
 #include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
 
 #include <cmath>
 
@@ -29,6 +32,64 @@ using namespace std;
 
 namespace {
 const char* const WHITESPACE = " \b\f\n\r\t";
+
+/// @brief Appends a string value in JSON format to a string.
+///
+/// This is the string counterpart of @c StringElement::toJSON and
+/// escapes characters the same way.
+///
+/// @param str the string value.
+/// @param out the string the JSON text is appended to.
+void
+appendJSONString(const std::string& str, std::string& out) {
+    static const char* const HEX_DIGITS = "0123456789abcdef";
+    out += '"';
+    size_t start = 0;
+    for (size_t i = 0; i < str.size(); ++i) {
+        const char c = str[i];
+        const char* escape = 0;
+        switch (c) {
+        case '"':
+            escape = "\\\"";
+            break;
+        case '\\':
+            escape = "\\\\";
+            break;
+        case '\b':
+            escape = "\\b";
+            break;
+        case '\f':
+            escape = "\\f";
+            break;
+        case '\n':
+            escape = "\\n";
+            break;
+        case '\r':
+            escape = "\\r";
+            break;
+        case '\t':
+            escape = "\\t";
+            break;
+        default:
+            if ((c >= 0x20) && (c < 0x7f)) {
+                // Plain characters are copied by runs.
+                continue;
+            }
+        }
+        out.append(str, start, i - start);
+        start = i + 1;
+        if (escape) {
+            out += escape;
+        } else {
+            const unsigned char u = static_cast<unsigned char>(c);
+            out += "\\u00";
+            out += HEX_DIGITS[u >> 4];
+            out += HEX_DIGITS[u & 0xf];
+        }
+    }
+    out.append(str, start, std::string::npos);
+    out += '"';
+}
 } // end anonymous namespace
 
 namespace isc {
@@ -41,6 +102,25 @@ Element::Position::str() const {
     return (ss.str());
 }
 
+const std::string*
+Element::internFileName(const std::string& file) {
+    static const std::string empty;
+    if (file.empty()) {
+        return (&empty);
+    }
+    // Elements are usually created in sequence from the same file so
+    // remember the last name to avoid the lookup.
+    static thread_local const std::string* last = 0;
+    if (last && (*last == file)) {
+        return (last);
+    }
+    static std::mutex mutex;
+    static std::set<std::string> names;
+    std::lock_guard<std::mutex> lk(mutex);
+    last = &*names.insert(file).first;
+    return (last);
+}
+
 std::ostream&
 operator<<(std::ostream& out, const Element::Position& pos) {
     out << pos.str();
@@ -49,21 +129,82 @@ operator<<(std::ostream& out, const Element::Position& pos) {
 
 std::string
 Element::str() const {
-    std::stringstream ss;
-    toJSON(ss);
-    return (ss.str());
+    std::string text;
+    toJSON(text);
+    return (text);
 }
 
 std::string
 Element::toWire() const {
-    std::stringstream ss;
-    toJSON(ss);
-    return (ss.str());
+    std::string text;
+    toJSON(text);
+    return (text);
 }
 
 void
 Element::toWire(std::ostream& ss) const {
-    toJSON(ss);
+    ss << str();
+}
+
+void
+Element::toJSON(std::string& out) const {
+    switch (getType()) {
+    case integer:
+        out += std::to_string(intValue());
+        break;
+    case real: {
+        std::ostringstream ss;
+        toJSON(ss);
+        out += ss.str();
+        break;
+    }
+    case boolean:
+        out += (boolValue() ? "true" : "false");
+        break;
+    case null:
+        out += "null";
+        break;
+    case string:
+        appendJSONString(stringValue(), out);
+        break;
+    case list: {
+        out += "[ ";
+        const std::vector<ElementPtr>& v = listValue();
+        for (auto it = v.begin(); it != v.end(); ++it) {
+            if (it != v.begin()) {
+                out += ", ";
+            }
+            (*it)->toJSON(out);
+        }
+        out += " ]";
+        break;
+    }
+    case map: {
+        out += "{ ";
+        const std::map<std::string, ConstElementPtr>& m = mapValue();
+        for (auto it = m.begin(); it != m.end(); ++it) {
+            if (it != m.begin()) {
+                out += ", ";
+            }
+            out += '"';
+            out += it->first;
+            out += "\": ";
+            if (it->second) {
+                it->second->toJSON(out);
+            } else {
+                out += "None";
+            }
+        }
+        out += " }";
+        break;
+    }
+    default: {
+        // Should not happen but an output is better than nothing.
+        std::ostringstream ss;
+        toJSON(ss);
+        out += ss.str();
+    }
+    }
 }
 
 bool
@@ -239,12 +380,12 @@ operator<(Element const& a, Element const& b) {
 //
 ElementPtr
 Element::create(const Position& pos) {
-    return (ElementPtr(new NullElement(pos)));
+    return (boost::make_shared<NullElement>(pos));
 }
 
 ElementPtr
 Element::create(const long long int i, const Position& pos) {
-    return (ElementPtr(new IntElement(static_cast<int64_t>(i), pos)));
+    return (boost::make_shared<IntElement>(static_cast<int64_t>(i), pos));
 }
 
 ElementPtr
@@ -259,17 +400,22 @@ Element::create(const long int i, const Position& pos) {
 
 ElementPtr
 Element::create(const double d, const Position& pos) {
-    return (ElementPtr(new DoubleElement(d, pos)));
+    return (boost::make_shared<DoubleElement>(d, pos));
 }
 
 ElementPtr
 Element::create(const bool b, const Position& pos) {
-    return (ElementPtr(new BoolElement(b, pos)));
+    return (boost::make_shared<BoolElement>(b, pos));
 }
 
 ElementPtr
 Element::create(const std::string& s, const Position& pos) {
-    return (ElementPtr(new StringElement(s, pos)));
+    return (boost::make_shared<StringElement>(s, pos));
+}
+
+ElementPtr
+Element::create(std::string&& s, const Position& pos) {
+    return (boost::make_shared<StringElement>(std::move(s), pos));
 }
 
 ElementPtr
@@ -279,12 +425,12 @@ Element::create(const char *s, const Position& pos) {
 
 ElementPtr
 Element::createList(const Position& pos) {
-    return (ElementPtr(new ListElement(pos)));
+    return (boost::make_shared<ListElement>(pos));
 }
 
 ElementPtr
 Element::createMap(const Position& pos) {
-    return (ElementPtr(new MapElement(pos)));
+    return (boost::make_shared<MapElement>(pos));
 }
 
 
@@ -612,6 +758,435 @@ fromStringstreamMap(std::istream& in, const std::string& file, int& line,
 }
 } // end anonymous namespace
 
+//
+// fromJSON parser working on a contiguous buffer
+//
+namespace {
+
+/// @brief JSON parser working on a contiguous buffer.
+///
+/// This is the counterpart of the stream helpers above for input which
+/// is already in memory (strings and whole files). Characters are read
+/// with plain pointer arithmetic instead of stream operations, and strings
+/// without escapes are copied from the buffer in one step. The position
+/// tracking and the error messages mirror the stream parser exactly so
+/// both paths accept the same input and report the same errors.
+class BufferParser {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// @param begin pointer to the first character of the input.
+    /// @param end pointer past the last character of the input.
+    /// @param file the input file name (used in positions and errors).
+    BufferParser(const char* begin, const char* end, const std::string& file)
+        : cur_(begin), end_(end), file_(file) {
+    }
+
+    /// @brief Parses an element, same as the stream version of
+    /// @c Element::fromJSON.
+    ///
+    /// @param line the current line.
+    /// @param pos the current position within the current line.
+    /// @return the parsed element.
+    /// @throw JSONError
+    ElementPtr parse(int& line, int& pos) {
+        skipWhitespace(line, pos);
+        int c = get();
+        pos++;
+        switch (c) {
+        case '1':
+        case '2':
+        case '3':
+        case '4':
+        case '5':
+        case '6':
+        case '7':
+        case '8':
+        case '9':
+        case '0':
+        case '-':
+        case '+':
+        case '.':
+            unget();
+            --pos;
+            return (parseNumber(line, pos));
+        case 't':
+        case 'f':
+            unget();
+            --pos;
+            return (parseBool(line, pos));
+        case 'n':
+            unget();
+            --pos;
+            return (parseNull(line, pos));
+        case '"':
+            unget();
+            --pos;
+            return (parseString(line, pos));
+        case '[':
+            return (parseList(line, pos));
+        case '{':
+            return (parseMap(line, pos));
+        case EOF:
+            isc_throw(JSONError, "nothing read");
+        default:
+            throwJSONError(std::string("error: unexpected character ") +
+                           std::string(1, c), file_, line, pos);
+        }
+        return (ElementPtr());
+    }
+
+    /// @brief Skips trailing whitespace and checks the whole input
+    /// was consumed.
+    ///
+    /// @param line the current line.
+    /// @param pos the current position within the current line.
+    /// @throw JSONError when there is extra data.
+    void checkEnd(int& line, int& pos) {
+        skipWhitespace(line, pos);
+        if (peek() != EOF) {
+            throwJSONError("Extra data", file_, line, pos);
+        }
+    }
+
+private:
+
+    /// @brief Returns the next character without consuming it.
+    int peek() const {
+        return (cur_ < end_ ? static_cast<unsigned char>(*cur_) : EOF);
+    }
+
+    /// @brief Returns and consumes the next character.
+    int get() {
+        return (cur_ < end_ ? static_cast<unsigned char>(*cur_++) : EOF);
+    }
+
+    /// @brief Consumes the next character.
+    void ignore() {
+        if (cur_ < end_) {
+            ++cur_;
+        }
+    }
+
+    /// @brief Puts back the last character returned by @c get.
+    void unget() {
+        --cur_;
+    }
+
+    /// @brief Checks whether a character is whitespace.
+    static bool isWhitespace(const int c) {
+        switch (c) {
+        case ' ':
+        case '\b':
+        case '\f':
+        case '\n':
+        case '\r':
+        case '\t':
+            return (true);
+        default:
+            return (false);
+        }
+    }
+
+    /// @brief Buffer version of skipChars with whitespace.
+    void skipWhitespace(int& line, int& pos) {
+        for (; (cur_ < end_) && isWhitespace(*cur_); ++cur_) {
+            if (*cur_ == '\n') {
+                ++line;
+                pos = 1;
+            } else {
+                ++pos;
+            }
+        }
+    }
+
+    /// @brief Buffer version of skipTo with whitespace as may_skip.
+    int skipTo(int& line, int& pos, const char* chars) {
+        int c = get();
+        ++pos;
+        while (c != EOF) {
+            if (c == '\n') {
+                pos = 1;
+                ++line;
+            }
+            if (isWhitespace(c)) {
+                c = get();
+                ++pos;
+            } else if (charIn(c, chars)) {
+                skipWhitespace(line, pos);
+                return (c);
+            } else {
+                throwJSONError(std::string("'") + std::string(1, c) +
+                               "' read, one of \"" + chars + "\" expected",
+                               file_, line, pos);
+            }
+        }
+        throwJSONError(std::string("EOF read, one of \"") + chars +
+                       "\" expected", file_, line, pos);
+        return (c);
+    }
+
+    /// @brief Gets a hexadecimal digit value or -1.
+    static int hexDigit(const int d) {
+        if ((d >= '0') && (d <= '9')) {
+            return (d - '0');
+        } else if ((d >= 'A') && (d <= 'F')) {
+            return (d - 'A' + 10);
+        } else if ((d >= 'a') && (d <= 'f')) {
+            return (d - 'a' + 10);
+        }
+        return (-1);
+    }
+
+    /// @brief Buffer version of strFromStringstream.
+    std::string readString(const int line, int& pos) {
+        int c = get();
+        ++pos;
+        if (c != '"') {
+            throwJSONError("String expected", file_, line, pos);
+        }
+
+        // Fast path: no escape before the closing quote so the value
+        // is taken from the buffer as is.
+        const char* start = cur_;
+        const char* stop = start;
+        while ((stop < end_) && (*stop != '"') && (*stop != '\\')) {
+            ++stop;
+        }
+        if ((stop < end_) && (*stop == '"')) {
+            pos += (stop - start) + 1;
+            cur_ = stop + 1;
+            return (std::string(start, stop));
+        }
+
+        std::string result(start, stop);
+        pos += stop - start;
+        cur_ = stop;
+        c = get();
+        ++pos;
+        while (c != EOF && c != '"') {
+            if (c == '\\') {
+                int d;
+                switch (peek()) {
+                case '"':
+                    c = '"';
+                    break;
+                case '/':
+                    c = '/';
+                    break;
+                case '\\':
+                    c = '\\';
+                    break;
+                case 'b':
+                    c = '\b';
+                    break;
+                case 'f':
+                    c = '\f';
+                    break;
+                case 'n':
+                    c = '\n';
+                    break;
+                case 'r':
+                    c = '\r';
+                    break;
+                case 't':
+                    c = '\t';
+                    break;
+                case 'u':
+                    ignore();
+                    ++pos;
+                    if (peek() != '0') {
+                        throwJSONError("Unsupported unicode escape", file_,
+                                       line, pos);
+                    }
+                    ignore();
+                    ++pos;
+                    if (peek() != '0') {
+                        throwJSONError("Unsupported unicode escape", file_,
+                                       line, pos - 2);
+                    }
+                    ignore();
+                    ++pos;
+                    d = hexDigit(peek());
+                    if (d < 0) {
+                        throwJSONError("Not hexadecimal in unicode escape",
+                                       file_, line, pos - 3);
+                    }
+                    c = d << 4;
+                    ignore();
+                    ++pos;
+                    d = hexDigit(peek());
+                    if (d < 0) {
+                        throwJSONError("Not hexadecimal in unicode escape",
+                                       file_, line, pos - 4);
+                    }
+                    c |= d;
+                    break;
+                default:
+                    throwJSONError("Bad escape", file_, line, pos);
+                }
+                // drop the escaped char
+                ignore();
+                ++pos;
+            }
+            result.push_back(static_cast<char>(c));
+            c = get();
+            ++pos;
+        }
+        if (c == EOF) {
+            throwJSONError("Unterminated string", file_, line, pos);
+        }
+        return (result);
+    }
+
+    /// @brief Buffer version of fromStringstreamNumber.
+    ElementPtr parseNumber(const int line, int& pos) {
+        const uint32_t start_pos = pos;
+        const char* start = cur_;
+        bool is_double = false;
+        for (; cur_ < end_; ++cur_) {
+            const int c = static_cast<unsigned char>(*cur_);
+            if (isdigit(c) || (c == '+') || (c == '-')) {
+                continue;
+            }
+            if ((c == '.') || (c == 'e') || (c == 'E')) {
+                is_double = true;
+                continue;
+            }
+            break;
+        }
+        const size_t len = cur_ - start;
+        pos += len;
+
+        if (is_double) {
+            try {
+                return (Element::create(boost::lexical_cast<double>(start, len),
+                                        Element::Position(file_, line,
+                                                          start_pos)));
+            } catch (const boost::bad_lexical_cast&) {
+                throwJSONError(std::string("Number overflow: ") +
+                               std::string(start, len),
+                               file_, line, start_pos);
+            }
+        } else {
+            try {
+                return (Element::create(boost::lexical_cast<int64_t>(start, len),
+                                        Element::Position(file_, line,
+                                                          start_pos)));
+            } catch (const boost::bad_lexical_cast&) {
+                throwJSONError(std::string("Number overflow: ") +
+                               std::string(start, len),
+                               file_, line, start_pos);
+            }
+        }
+        return (ElementPtr());
+    }
+
+    /// @brief Buffer version of wordFromStringstream.
+    std::string readWord(int& pos) {
+        const char* start = cur_;
+        while ((cur_ < end_) && isalpha(static_cast<unsigned char>(*cur_))) {
+            ++cur_;
+        }
+        pos += cur_ - start;
+        return (std::string(start, cur_));
+    }
+
+    /// @brief Buffer version of fromStringstreamBool.
+    ElementPtr parseBool(const int line, int& pos) {
+        const uint32_t start_pos = pos;
+        const std::string word = readWord(pos);
+        if (word == "true") {
+            return (Element::create(true, Element::Position(file_, line,
+                                                            start_pos)));
+        } else if (word == "false") {
+            return (Element::create(false, Element::Position(file_, line,
+                                                             start_pos)));
+        }
+        throwJSONError(std::string("Bad boolean value: ") + word, file_,
+                       line, start_pos);
+        return (ElementPtr());
+    }
+
+    /// @brief Buffer version of fromStringstreamNull.
+    ElementPtr parseNull(const int line, int& pos) {
+        const uint32_t start_pos = pos;
+        const std::string word = readWord(pos);
+        if (word == "null") {
+            return (Element::create(Element::Position(file_, line, start_pos)));
+        }
+        throwJSONError(std::string("Bad null value: ") + word, file_,
+                       line, start_pos);
+        return (ElementPtr());
+    }
+
+    /// @brief Buffer version of fromStringstreamString.
+    ElementPtr parseString(const int line, int& pos) {
+        const uint32_t start_pos = pos;
+        std::string value = readString(line, pos);
+        return (Element::create(std::move(value),
+                                Element::Position(file_, line, start_pos)));
+    }
+
+    /// @brief Buffer version of fromStringstreamList.
+    ElementPtr parseList(int& line, int& pos) {
+        int c = 0;
+        ElementPtr list = Element::createList(Element::Position(file_, line,
+                                                                pos));
+        skipWhitespace(line, pos);
+        while (c != EOF && c != ']') {
+            if (peek() != ']') {
+                list->add(parse(line, pos));
+                c = skipTo(line, pos, ",]");
+            } else {
+                c = get();
+                ++pos;
+            }
+        }
+        return (list);
+    }
+
+    /// @brief Buffer version of fromStringstreamMap.
+    ElementPtr parseMap(int& line, int& pos) {
+        ElementPtr map = Element::createMap(Element::Position(file_, line,
+                                                              pos));
+        skipWhitespace(line, pos);
+        int c = peek();
+        if (c == EOF) {
+            throwJSONError(std::string("Unterminated map, <string> or } expected"),
+                           file_, line, pos);
+        } else if (c == '}') {
+            // empty map, skip closing curly
+            ignore();
+        } else {
+            while (c != EOF && c != '}') {
+                const std::string key = readString(line, pos);
+
+                skipTo(line, pos, ":");
+                // skip the :
+
+                ConstElementPtr value = parse(line, pos);
+                map->set(key, value);
+
+                c = skipTo(line, pos, ",}");
+            }
+        }
+        return (map);
+    }
+
+    /// @brief The current position in the buffer.
+    const char* cur_;
+
+    /// @brief The end of the buffer.
+    const char* end_;
+
+    /// @brief The input file name.
+    const std::string file_;
+};
+
+} // end anonymous namespace
+
 std::string
 Element::typeToName(Element::types type) {
     switch (type) {
@@ -757,21 +1332,30 @@ Element::fromJSON(std::istream& in, const std::string& file, int& line,
 
 ElementPtr
 Element::fromJSON(const std::string& in, bool preproc) {
-    std::stringstream ss;
-    ss << in;
-
-    int line = 1, pos = 1;
-    stringstream filtered;
     if (preproc) {
+        // The preprocessor consumes the whole input so there is no
+        // extra data to check.
+        std::stringstream ss;
+        ss << in;
+        stringstream filtered;
         preprocess(ss, filtered);
+        const std::string& text = filtered.str();
+        int line = 1, pos = 1;
+        BufferParser parser(text.data(), text.data() + text.size(),
+                            "<string>");
+        return (parser.parse(line, pos));
     }
-    ElementPtr result(fromJSON(preproc ? filtered : ss, "<string>", line, pos));
-    skipChars(ss, WHITESPACE, line, pos);
-    // ss must now be at end
-    if (ss.peek() != EOF) {
-        throwJSONError("Extra data", "<string>", line, pos);
-    }
-    return result;
+    return (fromJSON(in.data(), in.size(), "<string>"));
+}
+
+ElementPtr
+Element::fromJSON(const char* data, size_t length,
+                  const std::string& file_name) {
+    int line = 1, pos = 1;
+    BufferParser parser(data, data + length, file_name);
+    ElementPtr result(parser.parse(line, pos));
+    parser.checkEnd(line, pos);
+    return (result);
 }
 
 ElementPtr
@@ -786,7 +1370,33 @@ Element::fromJSONFile(const std::string& file_name, bool preproc) {
                   << "': " << error);
     }
 
-    return (fromJSON(infile, file_name, preproc));
+    // Load the whole file in memory so it can be parsed from a buffer.
+    std::string text;
+    if (preproc) {
+        stringstream filtered;
+        preprocess(infile, filtered);
+        text = filtered.str();
+    } else {
+        infile.seekg(0, std::ios::end);
+        const std::streamoff size = infile.tellg();
+        infile.seekg(0, std::ios::beg);
+        if (infile && (size > 0)) {
+            text.resize(static_cast<size_t>(size));
+            infile.read(&text[0], size);
+            text.resize(static_cast<size_t>(infile.gcount()));
+        } else {
+            // Not a regular file: read until the end.
+            infile.clear();
+            std::ostringstream content;
+            content << infile.rdbuf();
+            text = content.str();
+        }
+    }
+
+    // As with the stream parser, data after the element is ignored.
+    int line = 1, pos = 1;
+    BufferParser parser(text.data(), text.data() + text.size(), file_name);
+    return (parser.parse(line, pos));
 }
 
 // to JSON format
@@ -957,7 +1567,7 @@ Element::fromWire(std::stringstream& in, int) {
 
 void
 MapElement::set(const std::string& key, ConstElementPtr value) {
-    m[key] = value;
+    m[key] = std::move(value);
 }
 
 bool
@@ -1057,6 +1667,322 @@ ListElement::sort(std::string const& index /* = std::string() */) {
     std::sort(l.begin(), l.end(), comparator);
 }
 
+namespace {
+
+/// @brief The streamed lists whose readers were not released.
+std::set<StreamedListElement*> streamed_lists;
+
+/// @brief Mutex protecting the streamed lists.
+std::mutex streamed_lists_mutex;
+
+}
+
+StreamedListElement::StreamedListElement(const PageReader& reader,
+                                         const Position& pos)
+    : ListElement(pos), reader_(reader), first_page_(),
+      released_(false), reader_mutex_(), materialized_(false) {
+    std::lock_guard<std::mutex> lock(streamed_lists_mutex);
+    streamed_lists.insert(this);
+}
+
+StreamedListElement::StreamedListElement(const PageReader& reader,
+                                         const std::vector<ElementPtr>& first_page,
+                                         const Position& pos)
+    : ListElement(pos), reader_(reader), first_page_(first_page),
+      released_(false), reader_mutex_(), materialized_(false) {
+    std::lock_guard<std::mutex> lock(streamed_lists_mutex);
+    streamed_lists.insert(this);
+}
+
+StreamedListElement::~StreamedListElement() {
+    std::lock_guard<std::mutex> lock(streamed_lists_mutex);
+    streamed_lists.erase(this);
+}
+
+void
+StreamedListElement::releaseReaders() {
+    std::lock_guard<std::mutex> lock(streamed_lists_mutex);
+    for (auto list : streamed_lists) {
+        // Wait for a page being read by another thread.
+        std::lock_guard<std::mutex> reader_lock(list->reader_mutex_);
+        list->reader_ = PageReader();
+        list->released_ = true;
+    }
+    streamed_lists.clear();
+}
+
+void
+StreamedListElement::readPage(const ConstElementPtr& last,
+                              std::vector<ElementPtr>& page) const {
+    std::lock_guard<std::mutex> lock(reader_mutex_);
+    if (!last && !first_page_.empty()) {
+        page.insert(page.end(), first_page_.begin(), first_page_.end());
+        first_page_.clear();
+        first_page_.shrink_to_fit();
+        return;
+    }
+    if (released_) {
+        isc_throw(InvalidOperation, "the items of the list can no longer"
+                  " be read");
+    }
+    if (reader_) {
+        reader_(last, page);
+    }
+}
+
+void
+StreamedListElement::materialize() const {
+    if (materialized_) {
+        return;
+    }
+    std::vector<ElementPtr> items;
+    ConstElementPtr last;
+    for (;;) {
+        std::vector<ElementPtr> page;
+        readPage(last, page);
+        if (page.empty()) {
+            break;
+        }
+        last = page.back();
+        items.insert(items.end(), page.begin(), page.end());
+    }
+    // The items are the value of the list so they are cached in it.
+    const_cast<StreamedListElement*>(this)->ListElement::setValue(items);
+    materialized_ = true;
+}
+
+const std::vector<ElementPtr>&
+StreamedListElement::listValue() const {
+    materialize();
+    return (ListElement::listValue());
+}
+
+bool
+StreamedListElement::getValue(std::vector<ElementPtr>& t) const {
+    materialize();
+    return (ListElement::getValue(t));
+}
+
+bool
+StreamedListElement::setValue(const std::vector<ElementPtr>& v) {
+    materialized_ = true;
+    return (ListElement::setValue(v));
+}
+
+ConstElementPtr
+StreamedListElement::get(int i) const {
+    materialize();
+    return (ListElement::get(i));
+}
+
+ElementPtr
+StreamedListElement::getNonConst(int i) const {
+    materialize();
+    return (ListElement::getNonConst(i));
+}
+
+void
+StreamedListElement::set(size_t i, ElementPtr e) {
+    materialize();
+    ListElement::set(i, e);
+}
+
+void
+StreamedListElement::add(ElementPtr e) {
+    materialize();
+    ListElement::add(e);
+}
+
+void
+StreamedListElement::remove(int i) {
+    materialize();
+    ListElement::remove(i);
+}
+
+size_t
+StreamedListElement::size() const {
+    materialize();
+    return (ListElement::size());
+}
+
+bool
+StreamedListElement::empty() const {
+    if (materialized_) {
+        return (ListElement::empty());
+    }
+    std::vector<ElementPtr> page;
+    readPage(ConstElementPtr(), page);
+    return (page.empty());
+}
+
+void
+StreamedListElement::toJSON(std::ostream& ss) const {
+    if (materialized_) {
+        ListElement::toJSON(ss);
+        return;
+    }
+    ss << "[ ";
+    ConstElementPtr last;
+    for (;;) {
+        std::vector<ElementPtr> page;
+        readPage(last, page);
+        if (page.empty()) {
+            break;
+        }
+        for (auto const& item : page) {
+            if (last) {
+                ss << ", ";
+            }
+            item->toJSON(ss);
+            last = item;
+        }
+    }
+    ss << " ]";
+}
+
+void
+StreamedListElement::toJSON(std::string& out) const {
+    if (materialized_) {
+        ListElement::toJSON(out);
+        return;
+    }
+    out += "[ ";
+    ConstElementPtr last;
+    for (;;) {
+        std::vector<ElementPtr> page;
+        readPage(last, page);
+        if (page.empty()) {
+            break;
+        }
+        for (auto const& item : page) {
+            if (last) {
+                out += ", ";
+            }
+            item->toJSON(out);
+            last = item;
+        }
+    }
+    out += " ]";
+}
+
+JSONStreamWriter::JSONStreamWriter(const ConstElementPtr& element)
+    : element_(element) {
+    if (!element_) {
+        return;
+    }
+    std::string text;
+    split(*element_, text);
+    if (!text.empty()) {
+        segments_.push_back(Segment{text, 0, ConstElementPtr(), false});
+    }
+}
+
+bool
+JSONStreamWriter::isStreamed(const ConstElementPtr& element) {
+    if (!element) {
+        return (false);
+    }
+    auto streamed = dynamic_cast<const StreamedListElement*>(element.get());
+    if (streamed) {
+        return (!streamed->isMaterialized());
+    }
+    if (element->getType() == Element::list) {
+        for (auto const& item : element->listValue()) {
+            if (isStreamed(item)) {
+                return (true);
+            }
+        }
+    } else if (element->getType() == Element::map) {
+        for (auto const& item : element->mapValue()) {
+            if (isStreamed(item.second)) {
+                return (true);
+            }
+        }
+    }
+    return (false);
+}
+
+void
+JSONStreamWriter::split(const Element& element, std::string& text) {
+    const StreamedListElement* streamed =
+        dynamic_cast<const StreamedListElement*>(&element);
+    if (streamed && !streamed->isMaterialized()) {
+        if (!text.empty()) {
+            segments_.push_back(Segment{text, 0, ConstElementPtr(), false});
+            text.clear();
+        }
+        segments_.push_back(Segment{"", streamed, ConstElementPtr(), false});
+        return;
+    }
+    switch (element.getType()) {
+    case Element::list: {
+        text += "[ ";
+        const std::vector<ElementPtr>& v = element.listValue();
+        for (auto it = v.begin(); it != v.end(); ++it) {
+            if (it != v.begin()) {
+                text += ", ";
+            }
+            split(**it, text);
+        }
+        text += " ]";
+        break;
+    }
+    case Element::map: {
+        text += "{ ";
+        const std::map<std::string, ConstElementPtr>& m = element.mapValue();
+        for (auto it = m.begin(); it != m.end(); ++it) {
+            if (it != m.begin()) {
+                text += ", ";
+            }
+            text += '"';
+            text += it->first;
+            text += "\": ";
+            if (it->second) {
+                split(*it->second, text);
+            } else {
+                text += "None";
+            }
+        }
+        text += " }";
+        break;
+    }
+    default:
+        element.toJSON(text);
+    }
+}
+
+bool
+JSONStreamWriter::next(std::string& out) {
+    if (segments_.empty()) {
+        return (false);
+    }
+    Segment& segment = segments_.front();
+    if (!segment.list_) {
+        out += segment.text_;
+        segments_.pop_front();
+        return (true);
+    }
+    if (!segment.started_) {
+        out += "[ ";
+        segment.started_ = true;
+    }
+    std::vector<ElementPtr> page;
+    segment.list_->readPage(segment.last_, page);
+    if (page.empty()) {
+        out += " ]";
+        segments_.pop_front();
+        return (true);
+    }
+    for (auto const& item : page) {
+        if (segment.last_) {
+            out += ", ";
+        }
+        item->toJSON(out);
+        segment.last_ = item;
+    }
+    return (true);
+}
+
 bool
 MapElement::equals(const Element& other) const {
     if (other.getType() == Element::map) {
@@ -1155,17 +2081,17 @@ copy(ConstElementPtr from, int level) {
     }
     int from_type = from->getType();
     if (from_type == Element::integer) {
-        return (ElementPtr(new IntElement(from->intValue())));
+        return (boost::make_shared<IntElement>(from->intValue()));
     } else if (from_type == Element::real) {
-        return (ElementPtr(new DoubleElement(from->doubleValue())));
+        return (boost::make_shared<DoubleElement>(from->doubleValue()));
     } else if (from_type == Element::boolean) {
-        return (ElementPtr(new BoolElement(from->boolValue())));
+        return (boost::make_shared<BoolElement>(from->boolValue()));
     } else if (from_type == Element::null) {
-        return (ElementPtr(new NullElement()));
+        return (boost::make_shared<NullElement>());
     } else if (from_type == Element::string) {
-        return (ElementPtr(new StringElement(from->stringValue())));
+        return (boost::make_shared<StringElement>(from->stringValue()));
     } else if (from_type == Element::list) {
-        ElementPtr result = ElementPtr(new ListElement());
+        ElementPtr result = boost::make_shared<ListElement>();
         for (auto elem : from->listValue()) {
             if (level == 0) {
                 result->add(elem);
@@ -1175,7 +2101,7 @@ copy(ConstElementPtr from, int level) {
         }
         return (result);
     } else if (from_type == Element::map) {
-        ElementPtr result = ElementPtr(new MapElement());
+        ElementPtr result = boost::make_shared<MapElement>();
         for (auto kv : from->mapValue()) {
             auto key = kv.first;
             auto value = kv.second;
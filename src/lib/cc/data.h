@@ -1,4 +1,4 @@
-// Copyright (C) 2010-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2010-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -7,10 +7,14 @@
 #ifndef ISC_DATA_H
 #define ISC_DATA_H 1
 
+#include <functional>
 #include <iostream>
+#include <list>
 #include <map>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <boost/shared_ptr.hpp>
@@ -132,8 +136,26 @@ private:
     // function getType?
     int type_;
 
-    /// @brief Position of the element in the configuration string.
-    Position position_;
+    /// @brief File name of the element position.
+    ///
+    /// File names are interned so elements read from the same file
+    /// share the same string instead of holding a copy each.
+    const std::string* position_file_;
+
+    /// @brief Line number of the element position.
+    uint32_t position_line_;
+
+    /// @brief Position within the line of the element position.
+    uint32_t position_pos_;
+
+    /// @brief Returns the interned copy of a file name.
+    ///
+    /// Interned names are never freed: there are only a few of them
+    /// (configuration files and names like "<string>").
+    ///
+    /// @param file the file name.
+    /// @return pointer to the interned file name.
+    static const std::string* internFileName(const std::string& file);
 
 protected:
 
@@ -144,7 +166,8 @@ protected:
     /// It comprises the line number and the position within this line. The values
     /// held in this structure are used for error logging purposes.
     Element(int t, const Position& pos = ZERO_POSITION())
-        : type_(t), position_(pos) {
+        : type_(t), position_file_(internFileName(pos.file_)),
+          position_line_(pos.line_), position_pos_(pos.pos_) {
     }
 
 
@@ -162,9 +185,11 @@ public:
     /// @brief Returns position where the data element's value starts in a
     /// configuration string.
     ///
-    /// @warning The returned reference is valid as long as the object which
-    /// created it lives.
-    const Position& getPosition() const { return (position_); }
+    /// The position is not stored as is (the file name is interned) so
+    /// it is returned by value.
+    Position getPosition() const {
+        return (Position(*position_file_, position_line_, position_pos_));
+    }
 
     /// Returns a string representing the Element and all its
     /// child elements; note that this is different from stringValue(),
@@ -187,10 +212,10 @@ public:
 #define throwTypeError(error)                   \
     {                                           \
         std::string msg_ = error;               \
-        if ((position_.file_ != "") ||          \
-            (position_.line_ != 0) ||           \
-            (position_.pos_ != 0)) {            \
-            msg_ += " in (" + position_.str() + ")";   \
+        if (!position_file_->empty() ||         \
+            (position_line_ != 0) ||            \
+            (position_pos_ != 0)) {             \
+            msg_ += " in (" + getPosition().str() + ")";   \
         }                                       \
         isc_throw(TypeError, msg_);             \
     }
@@ -204,6 +229,16 @@ public:
     /// the given stringstream.
     virtual void toJSON(std::ostream& ss) const = 0;
 
+    /// @brief Converts the Element to JSON format and appends it to
+    /// the given string.
+    ///
+    /// The output is the same as the stream version but it is written
+    /// directly into the string, which is much faster for large elements.
+    /// It is used by @ref str and @ref toWire.
+    ///
+    /// @param out the string the JSON text is appended to.
+    virtual void toJSON(std::string& out) const;
+
     /// @name Type-specific getters
     ///
     /// @brief These functions only
@@ -386,6 +421,8 @@ public:
                              const Position& pos = ZERO_POSITION());
     static ElementPtr create(const std::string& s,
                              const Position& pos = ZERO_POSITION());
+    static ElementPtr create(std::string&& s,
+                             const Position& pos = ZERO_POSITION());
     // need both std:string and char *, since c++ will match
     // bool before std::string when you pass it a char *
     static ElementPtr create(const char *s,
@@ -461,6 +498,22 @@ public:
     static ElementPtr fromJSON(std::istream& in, const std::string& file,
                                int& line, int &pos);
 
+    /// Creates an Element from the given buffer containing JSON
+    /// formatted data.
+    ///
+    /// The buffer must contain exactly one element, optionally followed
+    /// by whitespace. This is the fast path used by the string and file
+    /// variants: it does not go through a stream.
+    ///
+    /// @param data pointer to the buffer.
+    /// @param length length of the buffer.
+    /// @param file_name specified input file name (used in error reporting)
+    /// @throw JSONError
+    /// @return An ElementPtr that contains the element(s) specified
+    /// in the given buffer.
+    static ElementPtr fromJSON(const char* data, size_t length,
+                               const std::string& file_name);
+
     /// Reads contents of specified file and interprets it as JSON.
     ///
     /// @param file_name name of the file to read
@@ -595,6 +648,7 @@ public:
     bool getValue(int64_t& t) const { t = i; return (true); }
     using Element::setValue;
     bool setValue(long long int v) { i = v; return (true); }
+    using Element::toJSON;
     void toJSON(std::ostream& ss) const;
     bool equals(const Element& other) const;
 };
@@ -610,6 +664,7 @@ public:
     bool getValue(double& t) const { t = d; return (true); }
     using Element::setValue;
     bool setValue(const double v) { d = v; return (true); }
+    using Element::toJSON;
     void toJSON(std::ostream& ss) const;
     bool equals(const Element& other) const;
 };
@@ -625,6 +680,7 @@ public:
     bool getValue(bool& t) const { t = b; return (true); }
     using Element::setValue;
     bool setValue(const bool v) { b = v; return (true); }
+    using Element::toJSON;
     void toJSON(std::ostream& ss) const;
     bool equals(const Element& other) const;
 };
@@ -633,6 +689,7 @@ class NullElement : public Element {
 public:
     NullElement(const Position& pos = ZERO_POSITION())
         : Element(null, pos) {};
+    using Element::toJSON;
     void toJSON(std::ostream& ss) const;
     bool equals(const Element& other) const;
 };
@@ -642,12 +699,13 @@ class StringElement : public Element {
 
 public:
     StringElement(std::string v, const Position& pos = ZERO_POSITION())
-        : Element(string, pos), s(v) {};
+        : Element(string, pos), s(std::move(v)) {};
     std::string stringValue() const { return (s); }
     using Element::getValue;
     bool getValue(std::string& t) const { t = s; return (true); }
     using Element::setValue;
     bool setValue(const std::string& v) { s = v; return (true); }
+    using Element::toJSON;
     void toJSON(std::ostream& ss) const;
     bool equals(const Element& other) const;
 };
@@ -676,9 +734,10 @@ public:
     void set(size_t i, ElementPtr e) {
         l.at(i) = e;
     }
-    void add(ElementPtr e) { l.push_back(e); };
+    void add(ElementPtr e) { l.push_back(std::move(e)); };
     using Element::remove;
     void remove(int i) { l.erase(l.begin() + i); };
+    using Element::toJSON;
     void toJSON(std::ostream& ss) const;
     size_t size() const { return (l.size()); }
     bool empty() const { return (l.empty()); }
@@ -696,6 +755,177 @@ public:
     void sort(std::string const& index = std::string());
 };
 
+/// @brief List element whose items are read page by page on demand.
+///
+/// The items of a very large list, e.g. all leases of a server, can't
+/// be held in memory at once. This list reads them in pages from their
+/// source (typically a database cursor) when it is converted to JSON,
+/// so only one page is held at a time. The @ref JSONStreamWriter
+/// converts a tree holding such lists to JSON text part by part.
+///
+/// The other accessors read all items and keep them (the list is then
+/// materialized) so the element can be used as a regular list.
+class StreamedListElement : public ListElement {
+public:
+    /// @brief Type of the function reading a page of items.
+    ///
+    /// It is passed the last item of the previous page (null for the
+    /// first page) and adds the items of the next page to the vector.
+    /// No item is added when there are no more items.
+    typedef std::function<void(const ConstElementPtr&,
+                               std::vector<ElementPtr>&)> PageReader;
+
+    /// @brief Constructor.
+    ///
+    /// @param reader function reading the pages of items.
+    /// @param pos the position of the element.
+    StreamedListElement(const PageReader& reader,
+                        const Position& pos = ZERO_POSITION());
+
+    /// @brief Constructor with the first page already read.
+    ///
+    /// The caller often reads the first page to decide whether the items
+    /// must be streamed: it is given here so it is not read again.
+    ///
+    /// @param reader function reading the pages of items.
+    /// @param first_page the first page of items.
+    /// @param pos the position of the element.
+    StreamedListElement(const PageReader& reader,
+                        const std::vector<ElementPtr>& first_page,
+                        const Position& pos = ZERO_POSITION());
+
+    /// @brief Destructor.
+    ~StreamedListElement();
+
+    /// @brief Releases the readers of all the streamed lists.
+    ///
+    /// The readers are typically provided by hook libraries: they must
+    /// be released before the library which provided them is unloaded,
+    /// even when a response holding the list is still being sent. Once
+    /// released, the next page of a list can't be read anymore.
+    static void releaseReaders();
+
+    /// @brief Reads a page of items.
+    ///
+    /// The first page given to the constructor is returned once, the next
+    /// reads of the first page use the reader.
+    ///
+    /// @param last the last item of the previous page, null for the first.
+    /// @param page the vector the items are added to.
+    /// @throw InvalidOperation if the reader was released.
+    void readPage(const ConstElementPtr& last,
+                  std::vector<ElementPtr>& page) const;
+
+    /// @brief Checks if all items were read and are held by the list.
+    bool isMaterialized() const {
+        return (materialized_);
+    }
+
+    const std::vector<ElementPtr>& listValue() const override;
+    using ListElement::getValue;
+    bool getValue(std::vector<ElementPtr>& t) const override;
+    using ListElement::setValue;
+    bool setValue(const std::vector<ElementPtr>& v) override;
+    using ListElement::get;
+    ConstElementPtr get(int i) const override;
+    ElementPtr getNonConst(int i) const override;
+    using ListElement::set;
+    void set(size_t i, ElementPtr e) override;
+    void add(ElementPtr e) override;
+    using ListElement::remove;
+    void remove(int i) override;
+    size_t size() const override;
+    bool empty() const override;
+
+    /// @brief Converts the list to JSON reading one page at a time.
+    ///
+    /// The items are not kept unless the list was materialized.
+    void toJSON(std::ostream& ss) const override;
+    void toJSON(std::string& out) const override;
+
+private:
+    /// @brief Reads all items into the list.
+    void materialize() const;
+
+    /// @brief Function reading the pages of items.
+    PageReader reader_;
+
+    /// @brief The first page of items when it was given, until it is read.
+    mutable std::vector<ElementPtr> first_page_;
+
+    /// @brief True when the reader was released.
+    bool released_;
+
+    /// @brief Mutex protecting the reader.
+    ///
+    /// A page can be read by the thread sending a response while the
+    /// readers are released by the main thread.
+    mutable std::mutex reader_mutex_;
+
+    /// @brief True when all items are held by the list.
+    mutable bool materialized_;
+};
+
+/// @brief Converts an element to JSON text part by part.
+///
+/// The text of the @ref StreamedListElement lists of the tree is produced
+/// one page at a time and the rest of the tree in between, so the whole
+/// text is never held in memory. This is used to send very large command
+/// responses. The output is the same as @ref Element::str.
+class JSONStreamWriter {
+public:
+    /// @brief Constructor.
+    ///
+    /// @param element the element to convert. It must not be modified
+    /// while the writer is used.
+    explicit JSONStreamWriter(const ConstElementPtr& element);
+
+    /// @brief Checks if an element holds lists read while they are written.
+    ///
+    /// @param element the element.
+    /// @return true if the element or one of its children is a not
+    /// materialized @ref StreamedListElement.
+    static bool isStreamed(const ConstElementPtr& element);
+
+    /// @brief Appends the next part of the JSON text.
+    ///
+    /// @param out the string the text is appended to.
+    /// @return false if the whole text was already appended, true otherwise.
+    /// @throw any exception thrown when reading a page of a streamed list.
+    bool next(std::string& out);
+
+private:
+    /// @brief Appends the text of an element to the segments.
+    ///
+    /// @param element the element.
+    /// @param text the text of the current segment.
+    void split(const Element& element, std::string& text);
+
+    /// @brief Part of the text: a fixed text or a streamed list.
+    struct Segment {
+        /// @brief Fixed text.
+        std::string text_;
+
+        /// @brief Streamed list or null for a fixed text.
+        const StreamedListElement* list_;
+
+        /// @brief Last item of the list written so far.
+        ConstElementPtr last_;
+
+        /// @brief True if the list was started.
+        bool started_;
+    };
+
+    /// @brief The converted element.
+    ConstElementPtr element_;
+
+    /// @brief Parts of the text still to be appended.
+    std::list<Segment> segments_;
+};
+
+/// @brief Pointer to a @ref JSONStreamWriter.
+typedef boost::shared_ptr<JSONStreamWriter> JSONStreamWriterPtr;
+
 class MapElement : public Element {
     std::map<std::string, ConstElementPtr> m;
 
@@ -751,6 +981,7 @@ public:
     bool contains(const std::string& s) const override {
         return (m.find(s) != m.end());
     }
+    using Element::toJSON;
     void toJSON(std::ostream& ss) const override;
 
     // we should name the two finds better...
@@ -155,7 +155,7 @@ SimpleParser::getDouble(const ConstElementPtr& scope,
 }
 
 
-const data::Element::Position&
+data::Element::Position
 SimpleParser::getPosition(const std::string& name, const data::ConstElementPtr parent) {
     if (!parent) {
         return (data::Element::ZERO_POSITION());
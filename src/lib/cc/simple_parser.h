@@ -144,7 +144,7 @@ public:
     /// @param name position of that element will be returned
     /// @param parent parent element (optional)
     /// @return position of the element specified.
-    static const data::Element::Position&
+    static data::Element::Position
     getPosition(const std::string& name, const data::ConstElementPtr parent);
 
     /// @brief Returns a string parameter from a scope
@@ -1,4 +1,4 @@
-// Copyright (C) 2009-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2009-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -206,6 +206,134 @@ TEST(Element, from_and_to_json) {
 
 }
 
+/// @brief Checks two parsed elements have the same positions.
+///
+/// @param expected the element parsed by the stream parser.
+/// @param el the element parsed by the buffer parser.
+void
+checkSamePositions(ConstElementPtr expected, ConstElementPtr el) {
+    ASSERT_TRUE(expected);
+    ASSERT_TRUE(el);
+    EXPECT_EQ(expected->getPosition().str(), el->getPosition().str());
+    if (expected->getType() == Element::list) {
+        ASSERT_EQ(expected->size(), el->size());
+        for (size_t i = 0; i < expected->size(); ++i) {
+            checkSamePositions(expected->get(i), el->get(i));
+        }
+    } else if (expected->getType() == Element::map) {
+        for (auto const& it : expected->mapValue()) {
+            checkSamePositions(it.second, el->get(it.first));
+        }
+    }
+}
+
+// Checks the buffer parser gives the same results and the same errors
+// as the stream parser.
+TEST(Element, fromJSONBuffer) {
+    std::vector<std::string> sv;
+    // Valid inputs.
+    sv.push_back("12");
+    sv.push_back("  \n -1.5e3\t");
+    sv.push_back("true");
+    sv.push_back("\"asdf\"");
+    sv.push_back("\"a\\tb\\u00fF\\\"c\\/\"");
+    sv.push_back("\"multi\nline\" ");
+    sv.push_back("\"\xc3\xa9\\n\"");
+    sv.push_back("[ 1, 2,\n 3, ]");
+    sv.push_back("[\n]");
+    sv.push_back("{ }");
+    sv.push_back("{\n  \"a\": [ { \"b\": null },\n  \"c\" ],\n"
+                 "  \"d\" :\n {\"e\": false}\n}\n");
+    // Invalid inputs.
+    sv.push_back("");
+    sv.push_back("   ");
+    sv.push_back("{1}");
+    sv.push_back("\n\nTrue");
+    sv.push_back("\n\ntru");
+    sv.push_back("{ \n \"aaa\nbbb\"err:");
+    sv.push_back("{ \t\n \"aaa\nbbb\"\t\n\n:\n true, \"\\\"");
+    sv.push_back("{ \"a\": None}");
+    sv.push_back("{ \"a\": 1 ");
+    sv.push_back("{ \"a\" 1 }");
+    sv.push_back("{");
+    sv.push_back("[ 1, 2");
+    sv.push_back("[ 1 2 ]");
+    sv.push_back("nul");
+    sv.push_back("\"hello");
+    sv.push_back("\"\\x\"");
+    sv.push_back("\"\\u123\"");
+    sv.push_back("\"\\u0123\"");
+    sv.push_back("\"\\u00ag\"");
+    sv.push_back("\"\\u00BH\"");
+    sv.push_back("12345678901234567890");
+    sv.push_back("1e50000");
+    sv.push_back("1-2");
+
+    BOOST_FOREACH(const std::string& s, sv) {
+        SCOPED_TRACE(s);
+        ElementPtr expected;
+        std::string expected_error;
+        try {
+            std::istringstream iss(s);
+            expected = Element::fromJSON(iss, string("kea.conf"));
+        } catch (const JSONError& ex) {
+            expected_error = ex.what();
+        }
+        ElementPtr el;
+        std::string error;
+        try {
+            el = Element::fromJSON(s.data(), s.size(), "kea.conf");
+        } catch (const JSONError& ex) {
+            error = ex.what();
+        }
+        EXPECT_EQ(expected_error, error);
+        if (expected) {
+            ASSERT_TRUE(el);
+            EXPECT_TRUE(expected->equals(*el));
+            checkSamePositions(expected, el);
+        } else {
+            EXPECT_FALSE(el);
+        }
+    }
+
+    // Unlike the stream parser the buffer parser checks there is no
+    // data after the element.
+    std::string extra = "{ }\n  hello";
+    try {
+        Element::fromJSON(extra.data(), extra.size(), "kea.conf");
+        ADD_FAILURE() << "extra data not detected";
+    } catch (const JSONError& ex) {
+        EXPECT_EQ("Extra data in kea.conf:2:3", std::string(ex.what()));
+    }
+}
+
+// Checks the string serializer gives the same output as the stream one.
+TEST(Element, toJSONString) {
+    ElementPtr map = Element::createMap();
+    map->set("int", Element::create(-123));
+    map->set("double", Element::create(1.5e10));
+    map->set("whole", Element::create(2.0));
+    map->set("bool", Element::create(true));
+    map->set("null", Element::create());
+    map->set("none", ConstElementPtr());
+    std::string escaped("a\"b\\c\b\f\n\r\t\x01\x1f\x7f\x80\xff/");
+    escaped.push_back('\0');
+    map->set("string", Element::create(escaped));
+    ElementPtr list = Element::createList();
+    list->add(Element::create("plain"));
+    list->add(Element::createMap());
+    list->add(Element::createList());
+    map->set("list", list);
+
+    std::ostringstream ss;
+    map->toJSON(ss);
+    std::string text = "prefix";
+    map->toJSON(text);
+    EXPECT_EQ("prefix" + ss.str(), text);
+    EXPECT_EQ(ss.str(), map->str());
+    EXPECT_EQ(ss.str(), map->toWire());
+}
+
 template <typename T>
 void
 testGetValueInt() {
@@ -1318,6 +1446,26 @@ TEST(Element, getPosition) {
 }
 
 // Tests whether position is returned properly for a commented input JSON text.
+// Checks element positions keep their file name when the string
+// used to build them is gone.
+TEST(Element, positionFileName) {
+    ElementPtr el1;
+    ElementPtr el2;
+    {
+        std::string file1("/etc/kea/kea-dhcp4-first.conf");
+        std::string file2("/etc/kea/kea-dhcp4-second.conf");
+        el1 = Element::create(1, Element::Position(file1, 2, 3));
+        el2 = Element::create(std::string("foo"),
+                              Element::Position(file2, 4, 5));
+    }
+    ElementPtr el3 = Element::createMap(Element::Position("/etc/kea/kea-dhcp4-first.conf", 6, 7));
+    EXPECT_EQ("/etc/kea/kea-dhcp4-first.conf:2:3", el1->getPosition().str());
+    EXPECT_EQ("/etc/kea/kea-dhcp4-second.conf:4:5", el2->getPosition().str());
+    EXPECT_EQ("/etc/kea/kea-dhcp4-first.conf:6:7", el3->getPosition().str());
+    EXPECT_EQ("foo", el2->stringValue());
+    EXPECT_EQ("", Element::create(true)->getPosition().file_);
+}
+
 TEST(Element, getPositionCommented) {
     std::istringstream ss("{\n"
                           "    \"a\":  2,\n"
@@ -1526,4 +1674,132 @@ TEST(Element, removeEmptyContainersRecursively) {
 )"));
 }
 
+/// @brief Returns a page reader of the integers from 0 to count - 1.
+///
+/// @param count the number of integers.
+/// @param page_size the number of integers in a page.
+/// @param reads incremented each time a page is read.
+StreamedListElement::PageReader
+intPageReader(int count, int page_size, int& reads) {
+    return ([count, page_size, &reads](const ConstElementPtr& last,
+                                       std::vector<ElementPtr>& page) {
+        ++reads;
+        int first = (last ? last->intValue() + 1 : 0);
+        for (int i = first; (i < count) && (i < first + page_size); ++i) {
+            page.push_back(Element::create(i));
+        }
+    });
+}
+
+// Checks that a streamed list is converted to JSON page by page and
+// gives the same text as a regular list.
+TEST(Element, streamedList) {
+    int reads = 0;
+    ElementPtr streamed(new StreamedListElement(intPageReader(5, 2, reads)));
+    ElementPtr regular = Element::fromJSON("[ 0, 1, 2, 3, 4 ]");
+    EXPECT_EQ(regular->str(), streamed->str());
+    // Three pages and the empty one.
+    EXPECT_EQ(4, reads);
+    std::ostringstream ss;
+    streamed->toJSON(ss);
+    EXPECT_EQ(regular->str(), ss.str());
+    auto list = boost::dynamic_pointer_cast<StreamedListElement>(streamed);
+    ASSERT_TRUE(list);
+    EXPECT_FALSE(list->isMaterialized());
+
+    // Accessors read all the items and keep them.
+    reads = 0;
+    EXPECT_EQ(5, streamed->size());
+    EXPECT_TRUE(list->isMaterialized());
+    EXPECT_EQ(4, reads);
+    EXPECT_TRUE(regular->equals(*streamed));
+    streamed->add(Element::create(5));
+    EXPECT_EQ("[ 0, 1, 2, 3, 4, 5 ]", streamed->str());
+    EXPECT_EQ(4, reads);
+
+    // An empty streamed list.
+    ElementPtr empty(new StreamedListElement(intPageReader(0, 2, reads)));
+    EXPECT_TRUE(empty->empty());
+    EXPECT_EQ("[  ]", empty->str());
+    EXPECT_EQ(Element::createList()->str(), empty->str());
+}
+
+// Checks that the first page given to a streamed list is not read again.
+TEST(Element, streamedListFirstPage) {
+    int reads = 0;
+    StreamedListElement::PageReader reader = intPageReader(5, 2, reads);
+    std::vector<ElementPtr> first_page;
+    reader(ConstElementPtr(), first_page);
+    ASSERT_EQ(2, first_page.size());
+    reads = 0;
+
+    ElementPtr streamed(new StreamedListElement(reader, first_page));
+    EXPECT_EQ("[ 0, 1, 2, 3, 4 ]", streamed->str());
+    // Two pages and the empty one.
+    EXPECT_EQ(3, reads);
+
+    // The first page is read again afterwards.
+    reads = 0;
+    EXPECT_EQ("[ 0, 1, 2, 3, 4 ]", streamed->str());
+    EXPECT_EQ(4, reads);
+}
+
+// Checks that a streamed list can't be read once its reader was released.
+TEST(Element, streamedListReleaseReaders) {
+    int reads = 0;
+    ElementPtr streamed(new StreamedListElement(intPageReader(5, 2, reads)));
+    JSONStreamWriter writer(streamed);
+    std::string text;
+    // The first two pages.
+    EXPECT_TRUE(writer.next(text));
+    EXPECT_TRUE(writer.next(text));
+    EXPECT_EQ(2, reads);
+
+    StreamedListElement::releaseReaders();
+    EXPECT_THROW(writer.next(text), isc::InvalidOperation);
+    EXPECT_THROW(streamed->size(), isc::InvalidOperation);
+    EXPECT_EQ(2, reads);
+
+    // The lists created afterwards are not affected.
+    ElementPtr other(new StreamedListElement(intPageReader(5, 2, reads)));
+    EXPECT_EQ("[ 0, 1, 2, 3, 4 ]", other->str());
+}
+
+// Checks that the JSON stream writer gives the same text as str().
+TEST(Element, jsonStreamWriter) {
+    int reads = 0;
+    ElementPtr arguments = Element::createMap();
+    arguments->set("leases",
+                   ElementPtr(new StreamedListElement(intPageReader(5, 2,
+                                                                    reads))));
+    arguments->set("other", Element::fromJSON("[ \"a\", { \"b\": true } ]"));
+    ElementPtr answer = Element::createMap();
+    answer->set("arguments", arguments);
+    answer->set("result", Element::create(0));
+    answer->set("text", Element::create("5 integers found."));
+    std::string expected = answer->str();
+    reads = 0;
+
+    JSONStreamWriter writer(answer);
+    std::string text;
+    size_t parts = 0;
+    while (writer.next(text)) {
+        ++parts;
+    }
+    EXPECT_EQ(expected, text);
+    // The leases list is read one page at a time.
+    EXPECT_EQ(4, reads);
+    // The text before the list, 3 pages, the end of the list and
+    // the text after it.
+    EXPECT_EQ(6, parts);
+    EXPECT_FALSE(writer.next(text));
+
+    // Regular elements are written at once.
+    JSONStreamWriter regular(Element::fromJSON("{ \"a\": [ 1, 2 ] }"));
+    text.clear();
+    EXPECT_TRUE(regular.next(text));
+    EXPECT_EQ("{ \"a\": [ 1, 2 ] }", text);
+    EXPECT_FALSE(regular.next(text));
+}
+
 }  // namespace
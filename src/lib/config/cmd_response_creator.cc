@@ -109,7 +109,14 @@ createDynamicHttpResponse(HttpRequestPtr request) {
     // The response is OK, so let's create new HTTP response with the status OK.
     http_response = boost::dynamic_pointer_cast<
         HttpResponseJson>(createStockHttpResponseInternal(request, HttpStatusCode::OK));
-    http_response->setBodyAsJson(response);
+    // Large responses read while they are sent (e.g. all leases) are sent
+    // with the chunked transfer coding when the client supports it.
+    if ((request->getHttpVersion() == HttpVersion::HTTP_11()) &&
+        JSONStreamWriter::isStreamed(response)) {
+        http_response->setBodyAsStreamedJson(response);
+    } else {
+        http_response->setBodyAsJson(response);
+    }
     http_response->finalize();
 
     return (http_response);
@@ -166,6 +166,20 @@ public:
         }
     }
 
+    /// @brief Appends the next parts of the response to send.
+    ///
+    /// Large responses holding streamed lists are converted to text while
+    /// they are sent so only about BUF_SIZE bytes are held at a time.
+    ///
+    /// @throw any exception thrown when producing the response.
+    void fillResponse() {
+        while (writer_ && (response_.size() < BUF_SIZE)) {
+            if (!writer_->next(response_)) {
+                writer_.reset();
+            }
+        }
+    }
+
     /// @brief Handler invoked when the data is received over the control
     /// socket.
     ///
@@ -216,6 +230,9 @@ private:
     /// @brief Response created by the server.
     std::string response_;
 
+    /// @brief Writer of the rest of the response.
+    JSONStreamWriterPtr writer_;
+
     /// @brief Reference to the pool of connections.
     ConnectionPool& connection_pool_;
 
@@ -378,8 +395,18 @@ Connection::receiveHandler(const boost::system::error_code& ec,
         scheduleTimer();
 
         // Let's convert JSON response to text. Note that at this stage
-        // the rsp pointer is always set.
-        response_ = rsp->str();
+        // the rsp pointer is always set. Only the beginning of the text
+        // is produced here: the rest is produced while it is sent.
+        response_.clear();
+        try {
+            writer_.reset(new JSONStreamWriter(rsp));
+            fillResponse();
+        } catch (const std::exception& ex) {
+            LOG_WARN(command_logger, COMMAND_PROCESS_ERROR1).arg(ex.what());
+            writer_.reset();
+            response_ = createAnswer(CONTROL_RESULT_ERROR,
+                                     std::string(ex.what()))->str();
+        }
 
         doSend();
         return;
@@ -419,6 +446,17 @@ Connection::sendHandler(const boost::system::error_code& ec,
         // attempt.
         response_.erase(0, bytes_transferred);
 
+        // Append the next part of a streamed response. When it fails the
+        // beginning was already sent so the connection can only be closed.
+        try {
+            fillResponse();
+        } catch (const std::exception& ex) {
+            LOG_ERROR(command_logger, COMMAND_RESPONSE_STREAM_FAILED)
+                .arg(socket_->getNative()).arg(ex.what());
+            writer_.reset();
+            response_.clear();
+        }
+
         LOG_DEBUG(command_logger, DBG_COMMAND, COMMAND_SOCKET_WRITE)
             .arg(bytes_transferred).arg(response_.size())
             .arg(socket_->getNative());
@@ -460,6 +498,7 @@ Connection::timeoutHandler() {
     }
 
     ConstElementPtr rsp = createAnswer(CONTROL_RESULT_ERROR, os.str());
+    writer_.reset();
     response_ = rsp->str();
     doSend();
 }
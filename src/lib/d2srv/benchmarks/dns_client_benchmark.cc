@@ -0,0 +1,318 @@
+// Copyright (C) 2022 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <asiolink/asio_wrapper.h>
+#include <asiolink/io_address.h>
+#include <asiolink/io_service.h>
+#include <d2srv/d2_config.h>
+#include <d2srv/d2_update_message.h>
+#include <d2srv/dns_client.h>
+#include <dns/name.h>
+#include <dns/rcode.h>
+#include <dns/rrclass.h>
+
+#include <benchmark/benchmark.h>
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <functional>
+#include <vector>
+
+using namespace isc::asiolink;
+using namespace isc::d2;
+using namespace isc::dns;
+using namespace boost::asio::ip;
+namespace ph = std::placeholders;
+
+namespace {
+
+/// @brief IP address to which the stub DNS server is bound.
+const char* SERVER_ADDRESS = "127.0.0.1";
+
+/// @brief Port number to which the stub DNS server is bound.
+const uint16_t SERVER_PORT = 5381;
+
+/// @brief Number of DNS updates performed by each benchmark iteration.
+const size_t UPDATES_COUNT = 200;
+
+/// @brief DNS update timeout in milliseconds.
+const unsigned int TIMEOUT = 1000;
+
+/// @brief A stub DNS server answering DNS updates over TCP.
+///
+/// The server answers each request at once with a copy of it with the
+/// QR bit set.
+class TCPStubServer {
+public:
+    /// @brief A connection accepted by the server.
+    class Session : public boost::enable_shared_from_this<Session> {
+    public:
+        /// @brief Constructor.
+        ///
+        /// @param service the IO service.
+        Session(IOService& service) : socket_(service.get_io_service()) {
+        }
+
+        /// @brief Reads the next request.
+        void read() {
+            boost::asio::async_read(socket_,
+                                    boost::asio::buffer(length_, 2),
+                                    std::bind(&Session::readLength,
+                                              shared_from_this(), ph::_1));
+        }
+
+        /// @brief Handles the length of a request.
+        ///
+        /// @param ec the error code.
+        void readLength(const boost::system::error_code& ec) {
+            if (ec) {
+                return;
+            }
+
+            request_.resize((length_[0] << 8) | length_[1]);
+            boost::asio::async_read(socket_, boost::asio::buffer(request_),
+                                    std::bind(&Session::readRequest,
+                                              shared_from_this(), ph::_1));
+        }
+
+        /// @brief Answers a request.
+        ///
+        /// @param ec the error code.
+        void readRequest(const boost::system::error_code& ec) {
+            if (ec) {
+                return;
+            }
+
+            std::vector<uint8_t> response(length_, length_ + 2);
+            response.insert(response.end(), request_.begin(), request_.end());
+            // Set the QR bit.
+            response[4] = 0xA8;
+            boost::system::error_code ignored;
+            boost::asio::write(socket_, boost::asio::buffer(response), ignored);
+            read();
+        }
+
+        /// @brief The socket.
+        tcp::socket socket_;
+
+        /// @brief The length of the request being read.
+        uint8_t length_[2];
+
+        /// @brief The request being read.
+        std::vector<uint8_t> request_;
+    };
+
+    /// @brief Constructor.
+    ///
+    /// @param service the IO service.
+    TCPStubServer(IOService& service)
+        : service_(service),
+          acceptor_(service.get_io_service(),
+                    tcp::endpoint(address::from_string(SERVER_ADDRESS),
+                                  SERVER_PORT)),
+          accepted_(0) {
+        accept();
+    }
+
+    /// @brief Destructor.
+    ~TCPStubServer() {
+        boost::system::error_code ec;
+        acceptor_.close(ec);
+        for (auto const& session : sessions_) {
+            session->socket_.close(ec);
+        }
+    }
+
+    /// @brief Accepts the next connection.
+    void accept() {
+        boost::shared_ptr<Session> session(new Session(service_));
+        acceptor_.async_accept(session->socket_,
+                               [this, session]
+                               (const boost::system::error_code& ec) {
+            if (ec) {
+                return;
+            }
+
+            ++accepted_;
+            boost::system::error_code ignored;
+            session->socket_.set_option(tcp::no_delay(true), ignored);
+            sessions_.push_back(session);
+            session->read();
+            accept();
+        });
+    }
+
+    /// @brief The IO service.
+    IOService& service_;
+
+    /// @brief The acceptor.
+    tcp::acceptor acceptor_;
+
+    /// @brief The accepted connections.
+    std::vector<boost::shared_ptr<Session> > sessions_;
+
+    /// @brief The number of accepted connections.
+    size_t accepted_;
+};
+
+/// @brief Performs DNS updates one after the other with its own DNSClient.
+class UpdateSequence : public DNSClient::Callback {
+public:
+    /// @brief Constructor.
+    ///
+    /// @param service the IO service.
+    /// @param first_qid the ID of the first update.
+    /// @param remaining the number of updates of all sequences still to be
+    /// completed: the IO service is stopped when it reaches 0.
+    UpdateSequence(IOService& service, const uint16_t first_qid,
+                   size_t& remaining)
+        : service_(service), response_(), client_(),
+          message_(D2UpdateMessage::OUTBOUND), qid_(first_qid), count_(0),
+          sent_(0), failures_(0), remaining_(remaining) {
+        client_.reset(new DNSClient(response_, this, DNSClient::TCP));
+        message_.setRcode(Rcode(Rcode::NOERROR_CODE));
+        message_.setZone(Name("example.com"), RRClass::IN());
+    }
+
+    /// @brief Starts a sequence of updates.
+    ///
+    /// @param count the number of updates.
+    void start(const size_t count) {
+        count_ = count;
+        sent_ = 0;
+        send();
+    }
+
+    /// @brief Sends the next update.
+    void send() {
+        message_.setId(qid_++);
+        ++sent_;
+        client_->doUpdate(service_, IOAddress(SERVER_ADDRESS), SERVER_PORT,
+                          message_, TIMEOUT);
+    }
+
+    /// @brief Update completion callback.
+    ///
+    /// @param status A status code returned by DNSClient.
+    virtual void operator()(DNSClient::Status status) {
+        if ((status != DNSClient::SUCCESS) ||
+            (response_->getId() != static_cast<uint16_t>(qid_ - 1))) {
+            ++failures_;
+        }
+
+        if (--remaining_ == 0) {
+            service_.stop();
+        }
+
+        if (sent_ < count_) {
+            send();
+        }
+    }
+
+    /// @brief The IO service.
+    IOService& service_;
+
+    /// @brief The response to the last update.
+    D2UpdateMessagePtr response_;
+
+    /// @brief The DNS client.
+    DNSClientPtr client_;
+
+    /// @brief The update.
+    D2UpdateMessage message_;
+
+    /// @brief The ID of the next update.
+    uint16_t qid_;
+
+    /// @brief The number of updates of the current sequence.
+    size_t count_;
+
+    /// @brief The number of sent updates of the current sequence.
+    size_t sent_;
+
+    /// @brief The number of failed updates.
+    size_t failures_;
+
+    /// @brief The number of updates of all sequences still to be completed.
+    size_t& remaining_;
+};
+
+/// @brief Sets the idle timeout and update sequences arguments.
+///
+/// The first argument is the idle timeout of the TCP connections in
+/// milliseconds: 0 opens a connection per update. The second is the
+/// number of update sequences run at the same time, i.e. the number of
+/// updates pipelined on the connection.
+///
+/// @param b the benchmark.
+void dnsClientArguments(benchmark::internal::Benchmark* b) {
+    for (int idle_timeout : { 0, 10000 }) {
+        for (int sequences : { 1, 20 }) {
+            b->Args({idle_timeout, sequences});
+        }
+    }
+}
+
+/// @brief Benchmarks DNS updates over TCP against a local stub server.
+///
+/// This measures the throughput with a connection per update, with a
+/// persistent connection and with pipelining. The client and the server
+/// share the same IO service so the benchmark measures the processing
+/// cost of the updates and of the connection handshakes rather than the
+/// network latency.
+///
+/// @param state the benchmark state.
+void tcpUpdates(benchmark::State& state) {
+    IOService service;
+    TCPStubServer server(service);
+    DNSClient::setTcpConnectionLimits(1, state.range(0));
+
+    const size_t sequences = state.range(1);
+    const size_t count = UPDATES_COUNT / sequences;
+    size_t remaining = 0;
+    std::vector<boost::shared_ptr<UpdateSequence> > updates;
+    for (size_t i = 0; i < sequences; ++i) {
+        updates.push_back(boost::shared_ptr<UpdateSequence>(
+            new UpdateSequence(service, 1 + i * count, remaining)));
+    }
+
+    size_t performed = 0;
+    for (auto _ : state) {
+        remaining = sequences * count;
+        for (auto const& update : updates) {
+            update->start(count);
+        }
+        service.run();
+        service.get_io_service().reset();
+        performed += sequences * count;
+    }
+
+    size_t failures = 0;
+    for (auto const& update : updates) {
+        failures += update->failures_;
+    }
+    updates.clear();
+    service.poll();
+
+    DNSClient::setTcpConnectionLimits(D2Params::DFT_DNS_SERVER_CONNECTIONS,
+                                      D2Params::DFT_DNS_SERVER_IDLE_TIMEOUT);
+
+    state.SetItemsProcessed(performed);
+    state.counters["connections"] = server.accepted_;
+    if (failures > 0) {
+        state.SkipWithError("some updates failed");
+    }
+}
+
+}
+
+BENCHMARK(tcpUpdates)->Apply(dnsClientArguments)->Unit(benchmark::kMillisecond);
@@ -84,6 +84,38 @@ D2CfgContext::toElement() const {
     const dhcp_ddns::NameChangeFormat& ncr_format = d2_params_->getNcrFormat();
     d2->set("ncr-format",
             Element::create(dhcp_ddns::ncrFormatToString(ncr_format)));
+    // Set dns-update-threads (when not the default).
+    size_t dns_update_threads = d2_params_->getDnsUpdateThreads();
+    if (dns_update_threads) {
+        d2->set("dns-update-threads",
+                Element::create(static_cast<int64_t>(dns_update_threads)));
+    }
+    // Set dns-update-batch-size (when not the default).
+    size_t dns_update_batch_size = d2_params_->getDnsUpdateBatchSize();
+    if (dns_update_batch_size) {
+        d2->set("dns-update-batch-size",
+                Element::create(static_cast<int64_t>(dns_update_batch_size)));
+    }
+    // Set dns-server-protocol (when not the default).
+    const dhcp_ddns::NameChangeProtocol& dns_server_protocol =
+        d2_params_->getDnsServerProtocol();
+    if (dns_server_protocol != dhcp_ddns::NCR_UDP) {
+        std::string protocol =
+            dhcp_ddns::ncrProtocolToString(dns_server_protocol);
+        d2->set("dns-server-protocol", Element::create(protocol));
+    }
+    // Set dns-server-connections (when not the default).
+    size_t dns_server_connections = d2_params_->getDnsServerConnections();
+    if (dns_server_connections != D2Params::DFT_DNS_SERVER_CONNECTIONS) {
+        d2->set("dns-server-connections",
+                Element::create(static_cast<int64_t>(dns_server_connections)));
+    }
+    // Set dns-server-idle-timeout (when not the default).
+    size_t dns_server_idle_timeout = d2_params_->getDnsServerIdleTimeout();
+    if (dns_server_idle_timeout != D2Params::DFT_DNS_SERVER_IDLE_TIMEOUT) {
+        d2->set("dns-server-idle-timeout",
+                Element::create(static_cast<int64_t>(dns_server_idle_timeout)));
+    }
     // Set forward-ddns
     ElementPtr forward_ddns = Element::createMap();
     forward_ddns->set("ddns-domains", forward_mgr_->toElement());
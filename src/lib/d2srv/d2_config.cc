@@ -27,16 +27,29 @@ namespace d2 {
 
 // *********************** D2Params  *************************
 
+const size_t D2Params::DFT_DNS_SERVER_CONNECTIONS = 1;
+const size_t D2Params::DFT_DNS_SERVER_IDLE_TIMEOUT = 10000;
+
 D2Params::D2Params(const isc::asiolink::IOAddress& ip_address,
                    const size_t port,
                    const size_t dns_server_timeout,
                    const dhcp_ddns::NameChangeProtocol& ncr_protocol,
-                   const dhcp_ddns::NameChangeFormat& ncr_format)
+                   const dhcp_ddns::NameChangeFormat& ncr_format,
+                   const size_t dns_update_threads,
+                   const size_t dns_update_batch_size,
+                   const dhcp_ddns::NameChangeProtocol& dns_server_protocol,
+                   const size_t dns_server_connections,
+                   const size_t dns_server_idle_timeout)
     : ip_address_(ip_address),
     port_(port),
     dns_server_timeout_(dns_server_timeout),
     ncr_protocol_(ncr_protocol),
-    ncr_format_(ncr_format) {
+    ncr_format_(ncr_format),
+    dns_update_threads_(dns_update_threads),
+    dns_update_batch_size_(dns_update_batch_size),
+    dns_server_protocol_(dns_server_protocol),
+    dns_server_connections_(dns_server_connections),
+    dns_server_idle_timeout_(dns_server_idle_timeout) {
     validateContents();
 }
 
@@ -44,7 +57,10 @@ D2Params::D2Params()
     : ip_address_(isc::asiolink::IOAddress("127.0.0.1")),
      port_(53001), dns_server_timeout_(100),
      ncr_protocol_(dhcp_ddns::NCR_UDP),
-     ncr_format_(dhcp_ddns::FMT_JSON) {
+     ncr_format_(dhcp_ddns::FMT_JSON), dns_update_threads_(0),
+     dns_update_batch_size_(0), dns_server_protocol_(dhcp_ddns::NCR_UDP),
+     dns_server_connections_(DFT_DNS_SERVER_CONNECTIONS),
+     dns_server_idle_timeout_(DFT_DNS_SERVER_IDLE_TIMEOUT) {
     validateContents();
 }
 
@@ -77,6 +93,11 @@ D2Params::validateContents() {
                   << dhcp_ddns::ncrProtocolToString(ncr_protocol_)
                   << " is not yet supported");
     }
+
+    if (dns_server_connections_ == 0) {
+        isc_throw(D2CfgError,
+                  "D2Params: DNS server connections must be larger than 0");
+    }
 }
 
 std::string
@@ -93,7 +114,12 @@ D2Params::operator == (const D2Params& other) const {
             (port_ == other.port_) &&
             (dns_server_timeout_ == other.dns_server_timeout_) &&
             (ncr_protocol_ == other.ncr_protocol_) &&
-            (ncr_format_ == other.ncr_format_));
+            (ncr_format_ == other.ncr_format_) &&
+            (dns_update_threads_ == other.dns_update_threads_) &&
+            (dns_update_batch_size_ == other.dns_update_batch_size_) &&
+            (dns_server_protocol_ == other.dns_server_protocol_) &&
+            (dns_server_connections_ == other.dns_server_connections_) &&
+            (dns_server_idle_timeout_ == other.dns_server_idle_timeout_));
 }
 
 bool
@@ -111,7 +137,13 @@ D2Params::toText() const {
            << ", ncr-protocol: "
            << dhcp_ddns::ncrProtocolToString(ncr_protocol_)
            << ", ncr-format: " << ncr_format_
-           << dhcp_ddns::ncrFormatToString(ncr_format_);
+           << dhcp_ddns::ncrFormatToString(ncr_format_)
+           << ", dns-update-threads: " << dns_update_threads_
+           << ", dns-update-batch-size: " << dns_update_batch_size_
+           << ", dns-server-protocol: "
+           << dhcp_ddns::ncrProtocolToString(dns_server_protocol_)
+           << ", dns-server-connections: " << dns_server_connections_
+           << ", dns-server-idle-timeout: " << dns_server_idle_timeout_;
 
     return (stream.str());
 }
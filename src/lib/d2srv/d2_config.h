@@ -142,6 +142,12 @@ public:
 /// @brief Acts as a storage vault for D2 global scalar parameters
 class D2Params {
 public:
+    /// @brief Default maximum number of TCP connections to a DNS server.
+    static const size_t DFT_DNS_SERVER_CONNECTIONS;
+
+    /// @brief Default TCP connection idle timeout in milliseconds.
+    static const size_t DFT_DNS_SERVER_IDLE_TIMEOUT;
+
     /// @brief Constructor
     ///
     /// @param ip_address IP address at which D2 should listen for NCRs
@@ -150,6 +156,16 @@ public:
     /// wait for a response to a single DNS update request.
     /// @param ncr_protocol socket protocol D2 should use to receive NCRS
     /// @param ncr_format packet format of the inbound NCRs
+    /// @param dns_update_threads number of threads carrying out the DNS
+    /// updates, 0 to carry them out in the main thread
+    /// @param dns_update_batch_size maximum number of forward changes carried
+    /// by a single DNS update, 0 or 1 to disable batching
+    /// @param dns_server_protocol transport protocol D2 should use to send
+    /// the DNS updates
+    /// @param dns_server_connections maximum number of TCP connections to a
+    /// DNS server per thread carrying out the DNS updates
+    /// @param dns_server_idle_timeout time in milliseconds after which an
+    /// idle TCP connection to a DNS server is closed
     ///
     /// @throw D2CfgError if:
     /// -# ip_address is 0.0.0.0 or ::
@@ -157,11 +173,20 @@ public:
     /// -# dns_server_timeout is < 1
     /// -# ncr_protocol is invalid, currently only NCR_UDP is supported
     /// -# ncr_format is invalid, currently only FMT_JSON is supported
+    /// -# dns_server_connections is 0
     D2Params(const isc::asiolink::IOAddress& ip_address,
                    const size_t port,
                    const size_t dns_server_timeout,
                    const dhcp_ddns::NameChangeProtocol& ncr_protocol,
-                   const dhcp_ddns::NameChangeFormat& ncr_format);
+                   const dhcp_ddns::NameChangeFormat& ncr_format,
+                   const size_t dns_update_threads = 0,
+                   const size_t dns_update_batch_size = 0,
+                   const dhcp_ddns::NameChangeProtocol& dns_server_protocol =
+                   dhcp_ddns::NCR_UDP,
+                   const size_t dns_server_connections =
+                   DFT_DNS_SERVER_CONNECTIONS,
+                   const size_t dns_server_idle_timeout =
+                   DFT_DNS_SERVER_IDLE_TIMEOUT);
 
     /// @brief Default constructor
     /// The default constructor creates an instance that has updates disabled.
@@ -195,6 +220,42 @@ public:
         return(ncr_format_);
     }
 
+    /// @brief Return the number of threads carrying out the DNS updates.
+    ///
+    /// @return the number of threads, 0 when the DNS updates are carried
+    /// out in the main thread.
+    size_t getDnsUpdateThreads() const {
+        return(dns_update_threads_);
+    }
+
+    /// @brief Return the maximum number of forward changes per DNS update.
+    ///
+    /// @return the batch size, 0 or 1 when the forward changes are not
+    /// batched.
+    size_t getDnsUpdateBatchSize() const {
+        return(dns_update_batch_size_);
+    }
+
+    /// @brief Return the transport protocol used to send the DNS updates.
+    const dhcp_ddns::NameChangeProtocol& getDnsServerProtocol() const {
+        return(dns_server_protocol_);
+    }
+
+    /// @brief Return the maximum number of TCP connections to a DNS server
+    /// per thread carrying out the DNS updates.
+    size_t getDnsServerConnections() const {
+        return(dns_server_connections_);
+    }
+
+    /// @brief Return the time in milliseconds after which an idle TCP
+    /// connection to a DNS server is closed.
+    ///
+    /// @return the idle timeout, 0 when connections are closed as soon as
+    /// no DNS update is pending.
+    size_t getDnsServerIdleTimeout() const {
+        return(dns_server_idle_timeout_);
+    }
+
     /// @brief Return summary of the configuration used by D2.
     ///
     /// The returned summary of the configuration is meant to be appended to
@@ -223,6 +284,7 @@ protected:
     /// -# dns_server_timeout is 0
     /// -# ncr_protocol is UDP
     /// -# ncr_format is JSON
+    /// -# dns_server_connections is not 0
     ///
     /// @throw D2CfgError if contents are invalid
     virtual void validateContents();
@@ -244,6 +306,21 @@ private:
     /// @brief Format of the inbound requests (NCRs).
     /// Currently only JSON format is supported.
     dhcp_ddns::NameChangeFormat ncr_format_;
+
+    /// @brief Number of threads carrying out the DNS updates.
+    size_t dns_update_threads_;
+
+    /// @brief Maximum number of forward changes carried by a DNS update.
+    size_t dns_update_batch_size_;
+
+    /// @brief Transport protocol used to send the DNS updates.
+    dhcp_ddns::NameChangeProtocol dns_server_protocol_;
+
+    /// @brief Maximum number of TCP connections to a DNS server per thread.
+    size_t dns_server_connections_;
+
+    /// @brief Idle TCP connection timeout in milliseconds.
+    size_t dns_server_idle_timeout_;
 };
 
 /// @brief Dumps the contents of a D2Params as text to an output stream
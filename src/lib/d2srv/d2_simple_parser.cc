@@ -233,6 +233,11 @@ void D2SimpleParser::parse(const D2CfgContextPtr& ctx,
     asiolink::IOAddress ip_address(0);
     uint32_t port = 0;
     uint32_t dns_server_timeout = 0;
+    uint32_t dns_update_threads = 0;
+    uint32_t dns_update_batch_size = 0;
+    dhcp_ddns::NameChangeProtocol dns_server_protocol = dhcp_ddns::NCR_UDP;
+    uint32_t dns_server_connections = D2Params::DFT_DNS_SERVER_CONNECTIONS;
+    uint32_t dns_server_idle_timeout = D2Params::DFT_DNS_SERVER_IDLE_TIMEOUT;
     dhcp_ddns::NameChangeProtocol ncr_protocol = dhcp_ddns::NCR_UDP;
     dhcp_ddns::NameChangeFormat ncr_format = dhcp_ddns::FMT_JSON;
 
@@ -249,6 +254,36 @@ void D2SimpleParser::parse(const D2CfgContextPtr& ctx,
 
     dns_server_timeout = SimpleParser::getUint32(config, "dns-server-timeout");
 
+    if (config->contains("dns-update-threads")) {
+        dns_update_threads = SimpleParser::getUint32(config,
+                                                     "dns-update-threads");
+    }
+
+    if (config->contains("dns-update-batch-size")) {
+        dns_update_batch_size = SimpleParser::getUint32(config,
+                                                        "dns-update-batch-size");
+    }
+
+    if (config->contains("dns-server-protocol")) {
+        dns_server_protocol = getProtocol(config, "dns-server-protocol");
+    }
+
+    if (config->contains("dns-server-connections")) {
+        dns_server_connections =
+            SimpleParser::getUint32(config, "dns-server-connections");
+        if (dns_server_connections == 0) {
+            isc_throw(D2CfgError, "dns-server-connections must be greater"
+                      " than 0 ("
+                      << config->get("dns-server-connections")->getPosition()
+                      << ")");
+        }
+    }
+
+    if (config->contains("dns-server-idle-timeout")) {
+        dns_server_idle_timeout =
+            SimpleParser::getUint32(config, "dns-server-idle-timeout");
+    }
+
     ncr_protocol = getProtocol(config, "ncr-protocol");
     if (ncr_protocol != dhcp_ddns::NCR_UDP) {
         isc_throw(D2CfgError, "ncr-protocol : "
@@ -292,7 +327,12 @@ void D2SimpleParser::parse(const D2CfgContextPtr& ctx,
     // Attempt to create the new client config. This ought to fly as
     // we already validated everything.
     D2ParamsPtr params(new D2Params(ip_address, port, dns_server_timeout,
-                                    ncr_protocol, ncr_format));
+                                    ncr_protocol, ncr_format,
+                                    dns_update_threads,
+                                    dns_update_batch_size,
+                                    dns_server_protocol,
+                                    dns_server_connections,
+                                    dns_server_idle_timeout));
 
     ctx->getD2Params() = params;
 
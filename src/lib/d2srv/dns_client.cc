@@ -8,8 +8,13 @@
 
 #include <d2srv/d2_log.h>
 #include <d2srv/dns_client.h>
+#include <d2srv/dns_client_connection.h>
 #include <dns/messagerenderer.h>
 #include <stats/stats_mgr.h>
+
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/weak_ptr.hpp>
+
 #include <limits>
 
 namespace isc {
@@ -33,10 +38,14 @@ using namespace isc::stats;
 // This class provides the implementation for the DNSClient. This allows for
 // the separation of the DNSClient interface from the implementation details.
 // Currently, implementation uses IOFetch object to handle asynchronous
-// communication with the DNS. This design may be revisited in the future. If
-// implementation is changed, the DNSClient API will remain unchanged thanks
-// to this separation.
-class DNSClientImpl : public asiodns::IOFetch::Callback {
+// communication over UDP and pooled DNSClientConnection objects over TCP.
+// This design may be revisited in the future. If implementation is changed,
+// the DNSClient API will remain unchanged thanks to this separation.
+// The DNS Updates sent over TCP only hold a weak pointer to the
+// implementation: they are completed silently if the DNSClient has been
+// destroyed in the meantime.
+class DNSClientImpl : public asiodns::IOFetch::Callback,
+                      public boost::enable_shared_from_this<DNSClientImpl> {
 public:
     /// @brief A buffer holding response from a DNS.
     util::OutputBufferPtr in_buf_;
@@ -107,6 +116,22 @@ public:
                   const unsigned int wait,
                   const D2TsigKeyPtr& tsig_key);
 
+    /// @brief Sends a rendered DNS Update message over TCP.
+    ///
+    /// Invoked by the IO service so as the callback is never invoked
+    /// before @c doUpdate returns.
+    ///
+    /// @param io_service IO service to be used to run the message exchange.
+    /// @param ns_addr DNS server address.
+    /// @param ns_port DNS server port.
+    /// @param msg_buf The rendered DNS Update message.
+    /// @param wait A timeout (in milliseconds) for the response.
+    void sendTcp(asiolink::IOService& io_service,
+                 const asiolink::IOAddress& ns_addr,
+                 const uint16_t ns_port,
+                 const util::OutputBufferPtr& msg_buf,
+                 const unsigned int wait);
+
     /// @brief This function maps the IO error to the DNSClient error.
     ///
     /// @param result The IOFetch result to be converted to DNSClient status.
@@ -133,17 +158,6 @@ DNSClientImpl::DNSClientImpl(D2UpdateMessagePtr& response_placeholder,
         isc_throw(isc::BadValue, "Response buffer pointer should be null");
     }
 
-    // @todo Currently we only support UDP. The support for TCP is planned for
-    // the future release.
-    if (proto_ == DNSClient::TCP) {
-        isc_throw(isc::NotImplemented, "TCP is currently not supported as a"
-                  << " Transport protocol for DNS Updates; please use UDP");
-    }
-
-    // Given that we already eliminated the possibility that TCP is used, it
-    // would be sufficient  to check that (proto != DNSClient::UDP). But, once
-    // support TCP is added the check above will disappear and the extra check
-    // will be needed here anyway.
     // Note that cascaded check is used here instead of:
     //   if (proto_ != DNSClient::TCP && proto_ != DNSClient::UDP)..
     // because some versions of GCC compiler complain that check above would
@@ -262,20 +276,34 @@ DNSClientImpl::doUpdate(asiolink::IOService& io_service,
     // invalid message object is given.
     update.toWire(renderer, tsig_context_.get());
 
-    // IOFetch has all the mechanisms that we need to perform asynchronous
-    // communication with the DNS server. The last but one argument points to
-    // this object as a completion callback for the message exchange. As a
-    // result operator()(Status) will be called.
-
-    // Timeout value is explicitly cast to the int type to avoid warnings about
-    // overflows when doing implicit cast. It should have been checked by the
-    // caller that the unsigned timeout value will fit into int.
-    IOFetch io_fetch(IOFetch::UDP, io_service, msg_buf, ns_addr, ns_port,
-                     in_buf_, this, static_cast<int>(wait));
-
-    // Post the task to the task queue in the IO service. Caller will actually
-    // run these tasks by executing IOService::run.
-    io_service.post(io_fetch);
+    if (proto_ == DNSClient::TCP) {
+        // The message goes through a pooled connection. The connections of
+        // an IO service must only be used by the thread running it.
+        boost::weak_ptr<DNSClientImpl> weak_impl(shared_from_this());
+        io_service.post([weak_impl, &io_service, ns_addr, ns_port, msg_buf,
+                         wait]() {
+            boost::shared_ptr<DNSClientImpl> impl = weak_impl.lock();
+            if (impl) {
+                impl->sendTcp(io_service, ns_addr, ns_port, msg_buf, wait);
+            }
+        });
+    } else {
+        // IOFetch has all the mechanisms that we need to perform asynchronous
+        // communication with the DNS server. The last but one argument points
+        // to this object as a completion callback for the message exchange.
+        // As a result operator()(Status) will be called.
+
+        // Timeout value is explicitly cast to the int type to avoid warnings
+        // about overflows when doing implicit cast. It should have been
+        // checked by the caller that the unsigned timeout value will fit into
+        // int.
+        IOFetch io_fetch(IOFetch::UDP, io_service, msg_buf, ns_addr, ns_port,
+                         in_buf_, this, static_cast<int>(wait));
+
+        // Post the task to the task queue in the IO service. Caller will
+        // actually run these tasks by executing IOService::run.
+        io_service.post(io_fetch);
+    }
 
     // Update sent statistics.
     incrStats("update-sent");
@@ -286,6 +314,32 @@ DNSClientImpl::doUpdate(asiolink::IOService& io_service,
     }
 }
 
+void
+DNSClientImpl::sendTcp(asiolink::IOService& io_service,
+                       const IOAddress& ns_addr,
+                       const uint16_t ns_port,
+                       const OutputBufferPtr& msg_buf,
+                       const unsigned int wait) {
+    // The connection is chosen by message ID: no connection may carry two
+    // pending messages with the same ID.
+    uint16_t qid = (static_cast<uint16_t>((*msg_buf)[0]) << 8) | (*msg_buf)[1];
+    DNSClientConnectionPtr connection = DNSClientConnectionPool::instance().
+        getConnection(io_service, ns_addr, ns_port, qid);
+
+    boost::weak_ptr<DNSClientImpl> weak_impl(shared_from_this());
+    if (!connection ||
+        !connection->sendRequest(msg_buf, in_buf_,
+                                 [weak_impl](IOFetch::Result result) {
+                                     boost::shared_ptr<DNSClientImpl> impl =
+                                         weak_impl.lock();
+                                     if (impl) {
+                                         (*impl)(result);
+                                     }
+                                 }, wait)) {
+        (*this)(IOFetch::NOTSET);
+    }
+}
+
 void
 DNSClientImpl::incrStats(const std::string& stat, bool update_key) {
     StatsMgr& mgr = StatsMgr::instance();
@@ -310,6 +364,28 @@ DNSClient::getMaxTimeout() {
     return (max_timeout);
 }
 
+void
+DNSClient::setTcpConnectionLimits(const size_t max_connections,
+                                  const unsigned int idle_timeout) {
+    DNSClientConnectionPool::instance().setLimits(max_connections,
+                                                  idle_timeout);
+}
+
+size_t
+DNSClient::getTcpMaxConnections() {
+    return (DNSClientConnectionPool::instance().getMaxConnections());
+}
+
+unsigned int
+DNSClient::getTcpIdleTimeout() {
+    return (DNSClientConnectionPool::instance().getIdleTimeout());
+}
+
+size_t
+DNSClient::getTcpConnectionCount() {
+    return (DNSClientConnectionPool::instance().getConnectionCount());
+}
+
 void
 DNSClient::doUpdate(asiolink::IOService& io_service,
                     const IOAddress& ns_addr,
@@ -37,13 +37,15 @@ class DNSClientImpl;
 /// encapsulate DNS response, through class constructor. An exception will be
 /// thrown if the pointer is not initialized by the caller.
 ///
-/// @todo Ultimately, this class will support both TCP and UDP Transport.
-/// Currently only UDP is supported and can be specified as a preferred
-/// protocol. @c DNSClient constructor will throw an exception if TCP is
-/// specified. Once both protocols are supported, the @c DNSClient logic will
-/// try to obey caller's preference. However, it may use the other protocol if
-/// on its own discretion, when there is a legitimate reason to do so. For
-/// example, if communication with the server using preferred protocol fails.
+/// Both UDP and TCP Transport are supported. Over UDP each DNS Update is
+/// a separate exchange. Over TCP the DNS Updates go through persistent
+/// connections shared by all @c DNSClient instances: the connections to a
+/// DNS server are pooled and carry several DNS Updates at the same time
+/// (see @c DNSClientConnectionPool). The pool limits are set with
+/// @c DNSClient::setTcpConnectionLimits.
+///
+/// @todo The @c DNSClient does not fall back to the other protocol when
+/// communication with the server using the preferred protocol fails.
 class DNSClient {
 public:
 
@@ -118,6 +120,28 @@ public:
     /// @return maximal allowed timeout value accepted by @c DNSClient::doUpdate
     static unsigned int getMaxTimeout();
 
+    /// @brief Sets the limits of the pool of TCP connections.
+    ///
+    /// @param max_connections maximum number of TCP connections to a DNS
+    /// server per IO service.
+    /// @param idle_timeout time (in milliseconds) after which a TCP
+    /// connection on which no DNS Update is pending is closed, 0 to close
+    /// it as soon as no DNS Update is pending.
+    ///
+    /// @throw isc::BadValue if max_connections is 0.
+    static void setTcpConnectionLimits(const size_t max_connections,
+                                       const unsigned int idle_timeout);
+
+    /// @brief Returns the maximum number of TCP connections to a DNS
+    /// server per IO service.
+    static size_t getTcpMaxConnections();
+
+    /// @brief Returns the TCP connection idle timeout in milliseconds.
+    static unsigned int getTcpIdleTimeout();
+
+    /// @brief Returns the number of open TCP connections.
+    static size_t getTcpConnectionCount();
+
     /// @brief Start asynchronous DNS Update with TSIG.
     ///
     /// This function starts asynchronous DNS Update and returns. The DNS Update
@@ -148,7 +172,10 @@ public:
 
 private:
     /// @brief Pointer to DNSClient implementation.
-    std::unique_ptr<DNSClientImpl> impl_;
+    ///
+    /// The implementation is shared so as the pending DNS Updates sent over
+    /// TCP can detect that the @c DNSClient has been destroyed.
+    boost::shared_ptr<DNSClientImpl> impl_;
 };
 
 } // namespace d2
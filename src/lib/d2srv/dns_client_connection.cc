@@ -0,0 +1,429 @@
+// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <d2srv/d2_config.h>
+#include <d2srv/d2_log.h>
+#include <d2srv/dns_client_connection.h>
+
+#include <boost/asio/error.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+#include <sstream>
+
+using namespace isc::asiodns;
+using namespace isc::asiolink;
+using namespace isc::util;
+namespace ph = std::placeholders;
+
+namespace isc {
+namespace d2 {
+
+DNSClientConnection::DNSClientConnection(IOService& io_service,
+                                         const IOAddress& address,
+                                         const uint16_t port,
+                                         const unsigned int idle_timeout)
+    : io_service_(io_service),
+      endpoint_(boost::asio::ip::address::from_string(address.toText()), port),
+      socket_(io_service.get_io_service()),
+      idle_timer_(io_service.get_io_service()), idle_timeout_(idle_timeout),
+      state_(NOT_CONNECTED), pending_(), write_queue_(), write_buffers_(),
+      writing_(false), read_buf_() {
+}
+
+DNSClientConnection::~DNSClientConnection() {
+    boost::system::error_code ec;
+    socket_.close(ec);
+}
+
+std::string
+DNSClientConnection::getServerText() const {
+    std::ostringstream s;
+    s << endpoint_.address().to_string() << " port:" << endpoint_.port();
+    return (s.str());
+}
+
+bool
+DNSClientConnection::sendRequest(const OutputBufferPtr& request,
+                                 const OutputBufferPtr& response,
+                                 const Handler& handler,
+                                 const unsigned int wait) {
+    if ((state_ == CLOSED) || (request->getLength() < 2) ||
+        (request->getLength() > 0xffff)) {
+        return (false);
+    }
+
+    const uint16_t qid = (static_cast<uint16_t>((*request)[0]) << 8) |
+                         (*request)[1];
+    if (hasRequest(qid)) {
+        return (false);
+    }
+
+    // The connection is no longer idle.
+    idle_timer_.cancel();
+
+    Request& pending = pending_[qid];
+    pending.response_ = response;
+    pending.handler_ = handler;
+    pending.timer_.reset(new boost::asio::deadline_timer(io_service_.
+                                                         get_io_service()));
+    pending.timer_->expires_from_now(boost::posix_time::milliseconds(wait));
+    pending.timer_->async_wait(std::bind(&DNSClientConnection::timeoutHandler,
+                                         shared_from_this(), qid,
+                                         pending.timer_, ph::_1));
+
+    // Messages sent over TCP are prefixed with their length.
+    OutputBufferPtr framed(new OutputBuffer(request->getLength() + 2));
+    framed->writeUint16(static_cast<uint16_t>(request->getLength()));
+    framed->writeData(request->getData(), request->getLength());
+    write_queue_.push_back(framed);
+
+    if (state_ == NOT_CONNECTED) {
+        connect();
+    } else if (state_ == CONNECTED) {
+        doWrite();
+    }
+
+    return (true);
+}
+
+void
+DNSClientConnection::close() {
+    state_ = CLOSED;
+    write_queue_.clear();
+    idle_timer_.cancel();
+    boost::system::error_code ec;
+    socket_.close(ec);
+}
+
+void
+DNSClientConnection::connect() {
+    state_ = CONNECTING;
+    socket_.async_connect(endpoint_,
+                          std::bind(&DNSClientConnection::connectHandler,
+                                    shared_from_this(), ph::_1));
+}
+
+void
+DNSClientConnection::connectHandler(const boost::system::error_code& ec) {
+    if (state_ == CLOSED) {
+        return;
+    }
+
+    if (ec) {
+        ioError(ec);
+        return;
+    }
+
+    state_ = CONNECTED;
+    LOG_DEBUG(d2_to_dns_logger, isc::log::DBGLVL_TRACE_DETAIL,
+              DHCP_DDNS_TCP_CONNECTION_OPENED)
+        .arg(getServerText());
+
+    // Disable Nagle's algorithm: requests are small and the server should
+    // get each of them as soon as it is written.
+    boost::system::error_code ignored;
+    socket_.set_option(boost::asio::ip::tcp::no_delay(true), ignored);
+
+    doWrite();
+    doRead();
+}
+
+void
+DNSClientConnection::doWrite() {
+    if (writing_ || write_queue_.empty()) {
+        return;
+    }
+
+    // Write all the queued requests at once: requests given while a write
+    // is in progress are sent together.
+    writing_ = true;
+    write_buffers_.swap(write_queue_);
+    std::vector<boost::asio::const_buffer> buffers;
+    for (auto const& framed : write_buffers_) {
+        buffers.push_back(boost::asio::buffer(framed->getData(),
+                                              framed->getLength()));
+    }
+
+    boost::asio::async_write(socket_, buffers,
+                             std::bind(&DNSClientConnection::writeHandler,
+                                       shared_from_this(), ph::_1));
+}
+
+void
+DNSClientConnection::writeHandler(const boost::system::error_code& ec) {
+    writing_ = false;
+    write_buffers_.clear();
+    if (state_ == CLOSED) {
+        return;
+    }
+
+    if (ec) {
+        ioError(ec);
+        return;
+    }
+
+    doWrite();
+}
+
+void
+DNSClientConnection::doRead() {
+    boost::asio::async_read(socket_,
+                            boost::asio::buffer(length_buf_,
+                                                sizeof(length_buf_)),
+                            std::bind(&DNSClientConnection::readLengthHandler,
+                                      shared_from_this(), ph::_1));
+}
+
+void
+DNSClientConnection::readLengthHandler(const boost::system::error_code& ec) {
+    if (state_ == CLOSED) {
+        return;
+    }
+
+    if (ec) {
+        ioError(ec);
+        return;
+    }
+
+    const size_t length = (static_cast<size_t>(length_buf_[0]) << 8) |
+                          length_buf_[1];
+    if (length < 2) {
+        ioError(boost::asio::error::invalid_argument);
+        return;
+    }
+
+    read_buf_.resize(length);
+    boost::asio::async_read(socket_, boost::asio::buffer(read_buf_),
+                            std::bind(&DNSClientConnection::readMessageHandler,
+                                      shared_from_this(), ph::_1));
+}
+
+void
+DNSClientConnection::readMessageHandler(const boost::system::error_code& ec) {
+    if (state_ == CLOSED) {
+        return;
+    }
+
+    if (ec) {
+        ioError(ec);
+        return;
+    }
+
+    // Responses to requests which timed out are dropped.
+    const uint16_t qid = (static_cast<uint16_t>(read_buf_[0]) << 8) |
+                         read_buf_[1];
+    auto it = pending_.find(qid);
+    if (it != pending_.end()) {
+        Request request = it->second;
+        pending_.erase(it);
+        request.timer_->cancel();
+        request.response_->clear();
+        request.response_->writeData(&read_buf_[0], read_buf_.size());
+        if (pending_.empty()) {
+            startIdleTimer();
+        }
+
+        request.handler_(IOFetch::SUCCESS);
+    }
+
+    if (state_ != CLOSED) {
+        doRead();
+    }
+}
+
+void
+DNSClientConnection::timeoutHandler(const uint16_t qid,
+                                    const TimerPtr& timer,
+                                    const boost::system::error_code& ec) {
+    if (ec == boost::asio::error::operation_aborted) {
+        return;
+    }
+
+    // The request may have completed and its message ID been reused since
+    // the timer expired.
+    auto it = pending_.find(qid);
+    if ((it == pending_.end()) || (it->second.timer_ != timer)) {
+        return;
+    }
+
+    Handler handler = it->second.handler_;
+    pending_.erase(it);
+    if (pending_.empty()) {
+        if (state_ == CONNECTING) {
+            // Do not wait for a server which cannot be reached.
+            close();
+        } else if (state_ == CONNECTED) {
+            startIdleTimer();
+        }
+    }
+
+    handler(IOFetch::TIME_OUT);
+}
+
+void
+DNSClientConnection::startIdleTimer() {
+    if (idle_timeout_ == 0) {
+        close();
+        return;
+    }
+
+    idle_timer_.expires_from_now(boost::posix_time::
+                                 milliseconds(idle_timeout_));
+    idle_timer_.async_wait(std::bind(&DNSClientConnection::idleTimeoutHandler,
+                                     shared_from_this(), ph::_1));
+}
+
+void
+DNSClientConnection::idleTimeoutHandler(const boost::system::error_code& ec) {
+    if ((ec == boost::asio::error::operation_aborted) ||
+        (state_ == CLOSED) || !pending_.empty()) {
+        return;
+    }
+
+    LOG_DEBUG(d2_to_dns_logger, isc::log::DBGLVL_TRACE_DETAIL,
+              DHCP_DDNS_TCP_CONNECTION_IDLE)
+        .arg(getServerText())
+        .arg(idle_timeout_);
+    close();
+}
+
+void
+DNSClientConnection::ioError(const boost::system::error_code& ec) {
+    close();
+    if (pending_.empty() && (ec == boost::asio::error::eof)) {
+        LOG_DEBUG(d2_to_dns_logger, isc::log::DBGLVL_TRACE_DETAIL,
+                  DHCP_DDNS_TCP_CONNECTION_CLOSED)
+            .arg(getServerText());
+        return;
+    }
+
+    LOG_WARN(d2_to_dns_logger, DHCP_DDNS_TCP_CONNECTION_ERROR)
+        .arg(getServerText())
+        .arg(ec.message())
+        .arg(pending_.size());
+
+    // The handlers may send new requests: they will go through another
+    // connection.
+    std::map<uint16_t, Request> pending;
+    pending.swap(pending_);
+    for (auto const& it : pending) {
+        it.second.timer_->cancel();
+    }
+
+    for (auto const& it : pending) {
+        it.second.handler_(IOFetch::NOTSET);
+    }
+}
+
+DNSClientConnectionPool&
+DNSClientConnectionPool::instance() {
+    static DNSClientConnectionPool pool;
+    return (pool);
+}
+
+DNSClientConnectionPool::DNSClientConnectionPool()
+    : connections_(),
+      max_connections_(D2Params::DFT_DNS_SERVER_CONNECTIONS),
+      idle_timeout_(D2Params::DFT_DNS_SERVER_IDLE_TIMEOUT), mutex_() {
+}
+
+void
+DNSClientConnectionPool::setLimits(const size_t max_connections,
+                                   const unsigned int idle_timeout) {
+    if (max_connections == 0) {
+        isc_throw(BadValue, "the maximum number of TCP connections to a"
+                  " DNS server must be greater than 0");
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_connections_ = max_connections;
+    idle_timeout_ = idle_timeout;
+}
+
+size_t
+DNSClientConnectionPool::getMaxConnections() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return (max_connections_);
+}
+
+unsigned int
+DNSClientConnectionPool::getIdleTimeout() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return (idle_timeout_);
+}
+
+DNSClientConnectionPtr
+DNSClientConnectionPool::getConnection(IOService& io_service,
+                                       const IOAddress& address,
+                                       const uint16_t port,
+                                       const uint16_t qid) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Key key(&io_service, address.toText(), port);
+    auto& connections = connections_[key];
+
+    // Pick the open connection with the fewest pending requests.
+    DNSClientConnectionPtr best;
+    for (auto it = connections.begin(); it != connections.end(); ) {
+        DNSClientConnectionPtr connection = it->lock();
+        if (!connection || !connection->isOpen()) {
+            it = connections.erase(it);
+            continue;
+        }
+
+        ++it;
+        if (connection->hasRequest(qid)) {
+            continue;
+        }
+
+        if (!best ||
+            (connection->getRequestCount() < best->getRequestCount())) {
+            best = connection;
+        }
+    }
+
+    // Open a new connection rather than pipelining while the limit allows.
+    if ((!best || (best->getRequestCount() > 0)) &&
+        (connections.size() < max_connections_)) {
+        best.reset(new DNSClientConnection(io_service, address, port,
+                                           idle_timeout_));
+        connections.push_back(best);
+    }
+
+    return (best);
+}
+
+size_t
+DNSClientConnectionPool::getConnectionCount() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = 0;
+    for (auto it = connections_.begin(); it != connections_.end(); ) {
+        auto& connections = it->second;
+        for (auto conn = connections.begin(); conn != connections.end(); ) {
+            DNSClientConnectionPtr connection = conn->lock();
+            if (connection && connection->isOpen()) {
+                ++count;
+                ++conn;
+            } else {
+                conn = connections.erase(conn);
+            }
+        }
+
+        // Forget the servers which have no connection left.
+        if (connections.empty()) {
+            it = connections_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    return (count);
+}
+
+} // namespace d2
+} // namespace isc
@@ -0,0 +1,317 @@
+// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef DNS_CLIENT_CONNECTION_H
+#define DNS_CLIENT_CONNECTION_H
+
+#include <asiodns/io_fetch.h>
+#include <asiolink/io_address.h>
+#include <asiolink/io_service.h>
+#include <util/buffer.h>
+
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace isc {
+namespace d2 {
+
+class DNSClientConnection;
+
+/// @brief Defines a pointer to a DNSClientConnection.
+typedef boost::shared_ptr<DNSClientConnection> DNSClientConnectionPtr;
+
+/// @brief A persistent TCP connection to a DNS server.
+///
+/// DNS messages are sent over TCP prefixed with their length (RFC 1035,
+/// section 4.2.2). The connection carries any number of requests at the
+/// same time: requests are written as soon as they are given, those given
+/// while a write is in progress being written together, and responses
+/// are matched to the requests by their message ID, in whatever order the
+/// server sends them (RFC 7766, section 6.2.1.1).
+///
+/// The connection is opened when the first request is given to it. Once
+/// no request is pending it is closed after the idle timeout, or right
+/// away if the idle timeout is 0. A connection closed by the server or
+/// broken by an IO error is not reopened: pending requests complete with
+/// an error and the next requests go through a new connection.
+///
+/// All operations of a connection must be invoked by the thread running
+/// its IO service. The connection is kept alive by its pending IO
+/// operations, so it lives as long as it is open or the IO service exists.
+class DNSClientConnection :
+        public boost::enable_shared_from_this<DNSClientConnection>,
+        public boost::noncopyable {
+public:
+    /// @brief Handler invoked when a request completes.
+    ///
+    /// The result is IOFetch::SUCCESS when the response was received,
+    /// IOFetch::TIME_OUT when it was not received in time and
+    /// IOFetch::NOTSET when the connection failed.
+    typedef std::function<void(asiodns::IOFetch::Result)> Handler;
+
+    /// @brief Constructor.
+    ///
+    /// @param io_service IO service used by the connection.
+    /// @param address DNS server address.
+    /// @param port DNS server port.
+    /// @param idle_timeout time (in milliseconds) after which the connection
+    /// is closed when no request is pending.
+    DNSClientConnection(asiolink::IOService& io_service,
+                        const asiolink::IOAddress& address,
+                        const uint16_t port,
+                        const unsigned int idle_timeout);
+
+    /// @brief Destructor.
+    ~DNSClientConnection();
+
+    /// @brief Sends a request.
+    ///
+    /// @param request the request in wire format.
+    /// @param response the buffer the response is written to.
+    /// @param handler the handler invoked when the request completes.
+    /// @param wait the timeout (in milliseconds) for the response.
+    ///
+    /// @return false if the connection is closed or if a request with the
+    /// same message ID is pending, true otherwise.
+    bool sendRequest(const util::OutputBufferPtr& request,
+                     const util::OutputBufferPtr& response,
+                     const Handler& handler,
+                     const unsigned int wait);
+
+    /// @brief Checks if a request with the given message ID is pending.
+    ///
+    /// @param qid the message ID.
+    bool hasRequest(const uint16_t qid) const {
+        return (pending_.count(qid) > 0);
+    }
+
+    /// @brief Returns the number of pending requests.
+    size_t getRequestCount() const {
+        return (pending_.size());
+    }
+
+    /// @brief Checks if the connection can carry requests.
+    bool isOpen() const {
+        return (state_ != CLOSED);
+    }
+
+    /// @brief Returns a textual description of the DNS server.
+    std::string getServerText() const;
+
+    /// @brief Closes the connection.
+    ///
+    /// Pending requests do not complete.
+    void close();
+
+private:
+    /// @brief Connection states.
+    enum State {
+        NOT_CONNECTED,
+        CONNECTING,
+        CONNECTED,
+        CLOSED
+    };
+
+    /// @brief Defines a pointer to a timer.
+    typedef boost::shared_ptr<boost::asio::deadline_timer> TimerPtr;
+
+    /// @brief A pending request.
+    struct Request {
+        /// @brief The buffer the response is written to.
+        util::OutputBufferPtr response_;
+
+        /// @brief The handler invoked when the request completes.
+        Handler handler_;
+
+        /// @brief The response timer.
+        TimerPtr timer_;
+    };
+
+    /// @brief Starts connecting to the server.
+    void connect();
+
+    /// @brief Handles the completion of the connect.
+    ///
+    /// @param ec the error code.
+    void connectHandler(const boost::system::error_code& ec);
+
+    /// @brief Writes the next queued request.
+    void doWrite();
+
+    /// @brief Handles the completion of a write.
+    ///
+    /// @param ec the error code.
+    void writeHandler(const boost::system::error_code& ec);
+
+    /// @brief Starts reading the next response.
+    void doRead();
+
+    /// @brief Handles the completion of the read of a response length.
+    ///
+    /// @param ec the error code.
+    void readLengthHandler(const boost::system::error_code& ec);
+
+    /// @brief Handles the completion of the read of a response.
+    ///
+    /// @param ec the error code.
+    void readMessageHandler(const boost::system::error_code& ec);
+
+    /// @brief Handles the expiration of a request timer.
+    ///
+    /// @param qid the message ID of the request.
+    /// @param timer the timer of the request.
+    /// @param ec the error code.
+    void timeoutHandler(const uint16_t qid, const TimerPtr& timer,
+                        const boost::system::error_code& ec);
+
+    /// @brief Starts the idle timer, or closes the connection when the
+    /// idle timeout is 0.
+    void startIdleTimer();
+
+    /// @brief Handles the expiration of the idle timer.
+    ///
+    /// @param ec the error code.
+    void idleTimeoutHandler(const boost::system::error_code& ec);
+
+    /// @brief Handles an IO error.
+    ///
+    /// Closes the connection and completes the pending requests with an
+    /// error. The end of the stream is not an error when no request is
+    /// pending: servers close idle connections.
+    ///
+    /// @param ec the error code.
+    void ioError(const boost::system::error_code& ec);
+
+    /// @brief The IO service used by the connection.
+    asiolink::IOService& io_service_;
+
+    /// @brief The DNS server endpoint.
+    boost::asio::ip::tcp::endpoint endpoint_;
+
+    /// @brief The socket.
+    boost::asio::ip::tcp::socket socket_;
+
+    /// @brief The idle timer.
+    boost::asio::deadline_timer idle_timer_;
+
+    /// @brief The idle timeout in milliseconds.
+    unsigned int idle_timeout_;
+
+    /// @brief The connection state.
+    State state_;
+
+    /// @brief The pending requests by message ID.
+    std::map<uint16_t, Request> pending_;
+
+    /// @brief The requests waiting to be written, with their length prefix.
+    std::deque<util::OutputBufferPtr> write_queue_;
+
+    /// @brief The requests being written.
+    std::deque<util::OutputBufferPtr> write_buffers_;
+
+    /// @brief Indicates that a write is in progress.
+    bool writing_;
+
+    /// @brief The length of the response being read.
+    uint8_t length_buf_[2];
+
+    /// @brief The response being read.
+    std::vector<uint8_t> read_buf_;
+};
+
+/// @brief Pool of persistent TCP connections to DNS servers.
+///
+/// Connections are pooled per IO service and DNS server: the connections
+/// of an IO service are only used by the thread running it. A request is
+/// given to an idle connection when there is one. Otherwise a new
+/// connection is opened, up to the maximum number of connections, and once
+/// the maximum is reached the request is pipelined on the connection with
+/// the fewest pending requests.
+///
+/// The pool only holds weak pointers to the connections: a connection is
+/// dropped from the pool when it is closed or when its IO service is
+/// destroyed.
+class DNSClientConnectionPool : public boost::noncopyable {
+public:
+    /// @brief Returns the single instance of the pool.
+    static DNSClientConnectionPool& instance();
+
+    /// @brief Sets the limits of the pool.
+    ///
+    /// The limits apply to the connections opened afterwards.
+    ///
+    /// @param max_connections maximum number of connections per IO service
+    /// and DNS server.
+    /// @param idle_timeout time (in milliseconds) after which a connection
+    /// is closed when no request is pending.
+    ///
+    /// @throw BadValue if max_connections is 0.
+    void setLimits(const size_t max_connections,
+                   const unsigned int idle_timeout);
+
+    /// @brief Returns the maximum number of connections per IO service and
+    /// DNS server.
+    size_t getMaxConnections() const;
+
+    /// @brief Returns the idle timeout in milliseconds.
+    unsigned int getIdleTimeout() const;
+
+    /// @brief Returns a connection for a request.
+    ///
+    /// Must be invoked by the thread running the IO service.
+    ///
+    /// @param io_service the IO service of the connection.
+    /// @param address DNS server address.
+    /// @param port DNS server port.
+    /// @param qid the message ID of the request.
+    ///
+    /// @return the connection or null when all connections have a pending
+    /// request with the same message ID.
+    DNSClientConnectionPtr getConnection(asiolink::IOService& io_service,
+                                         const asiolink::IOAddress& address,
+                                         const uint16_t port,
+                                         const uint16_t qid);
+
+    /// @brief Returns the number of open connections.
+    size_t getConnectionCount();
+
+private:
+    /// @brief Constructor.
+    DNSClientConnectionPool();
+
+    /// @brief Connections are indexed by IO service, address and port.
+    typedef std::tuple<const asiolink::IOService*, std::string, uint16_t> Key;
+
+    /// @brief The connections.
+    std::map<Key, std::vector<boost::weak_ptr<DNSClientConnection> > >
+        connections_;
+
+    /// @brief Maximum number of connections per IO service and DNS server.
+    size_t max_connections_;
+
+    /// @brief The idle timeout in milliseconds.
+    unsigned int idle_timeout_;
+
+    /// @brief The mutex protecting the pool.
+    mutable std::mutex mutex_;
+};
+
+} // namespace d2
+} // namespace isc
+
+#endif // DNS_CLIENT_CONNECTION_H
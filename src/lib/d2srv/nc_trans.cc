@@ -75,7 +75,8 @@ NameChangeTransaction(asiolink::IOServicePtr& io_service,
      dns_update_status_(DNSClient::OTHER), dns_update_response_(),
      forward_change_completed_(false), reverse_change_completed_(false),
      current_server_list_(), current_server_(), next_server_pos_(0),
-     update_attempts_(0), cfg_mgr_(cfg_mgr), tsig_key_() {
+     update_attempts_(0), cfg_mgr_(cfg_mgr), tsig_key_(),
+     completion_handler_() {
     /// @todo if io_service is NULL we are multi-threading and should
     /// instantiate our own
     if (!io_service_) {
@@ -114,6 +115,15 @@ NameChangeTransaction::startTransaction() {
 
     setNcrStatus(dhcp_ddns::ST_PENDING);
     startModel(READY_ST);
+
+    if (completion_handler_ && isModelDone()) {
+        completion_handler_();
+    }
+}
+
+D2UpdateMessagePtr
+NameChangeTransaction::buildBatchedFwdRequest() {
+    return (D2UpdateMessagePtr());
 }
 
 void
@@ -130,6 +140,10 @@ NameChangeTransaction::operator()(DNSClient::Status status) {
               .arg(responseString());
 
     runModel(IO_COMPLETED_EVT);
+
+    if (completion_handler_ && isModelDone()) {
+        completion_handler_();
+    }
 }
 
 std::string
@@ -478,12 +492,17 @@ NameChangeTransaction::selectNextServer() {
                 continue;
             }
 
-            // @todo Protocol is set on DNSClient constructor. We need
-            // to propagate a configuration value downward, probably starting
-            // at global, then domain, finishing by server.
-            // Once that is supported we need to add it here.
+            // @todo Protocol is set on DNSClient constructor from the global
+            // configuration value. It could also be set per domain or
+            // server.
+            D2ParamsPtr d2_params = cfg_mgr_->getD2Params();
+            DNSClient::Protocol proto = DNSClient::UDP;
+            if (d2_params->getDnsServerProtocol() == dhcp_ddns::NCR_TCP) {
+                proto = DNSClient::TCP;
+            }
+
             dns_client_.reset(new DNSClient(dns_update_response_, this,
-                                            DNSClient::UDP));
+                                            proto));
             ++next_server_pos_;
             return (true);
         }
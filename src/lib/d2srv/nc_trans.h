@@ -18,6 +18,7 @@
 #include <util/state_model.h>
 
 #include <boost/shared_ptr.hpp>
+#include <functional>
 #include <map>
 
 namespace isc {
@@ -153,6 +154,9 @@ public:
     /// @brief Maximum times to attempt a single update on a given server.
     static const unsigned int MAX_UPDATE_TRIES_PER_SERVER = 3;
 
+    /// @brief Type of the handler invoked when the transaction is done.
+    typedef std::function<void()> CompletionHandler;
+
     /// @brief Constructor
     ///
     /// Instantiates a transaction that is ready to be started.
@@ -194,6 +198,39 @@ public:
     /// This method is exception safe.
     virtual void operator()(DNSClient::Status status);
 
+    /// @brief Sets the handler invoked when the transaction is done.
+    ///
+    /// The handler is invoked by the thread running the transaction IO
+    /// service when the state model ends. It is used to notify the
+    /// update manager when transactions run in other threads.
+    ///
+    /// @param handler the completion handler.
+    void setCompletionHandler(const CompletionHandler& handler) {
+        completion_handler_ = handler;
+    }
+
+    /// @brief Builds the forward update request for inclusion in a batch.
+    ///
+    /// A batch carries the forward changes of several transactions for the
+    /// same domain in a single DNS update.  Only a forward change made of a
+    /// single update can be batched: the request returned contains the
+    /// prerequisites and updates of that change.  The transaction must not
+    /// have been started.
+    ///
+    /// The default implementation returns an empty pointer.
+    ///
+    /// @return the forward update request, or an empty pointer if the
+    /// forward change of the transaction cannot be batched.
+    virtual D2UpdateMessagePtr buildBatchedFwdRequest();
+
+    /// @brief Records that the forward change was done by a batched update.
+    ///
+    /// It must be called before the transaction is started, which then only
+    /// carries out the reverse change, if any.
+    void setForwardChangeBatched() {
+        setForwardChangeCompleted(true);
+    }
+
 protected:
     /// @brief Send the update request to the current server.
     ///
@@ -592,6 +629,9 @@ private:
 
     /// @brief Pointer to the TSIG key which should be used (if any).
     D2TsigKeyPtr tsig_key_;
+
+    /// @brief Handler invoked when the transaction is done.
+    CompletionHandler completion_handler_;
 };
 
 /// @brief Defines a pointer to a NameChangeTransaction.
@@ -6,6 +6,7 @@
 
 #include <config.h>
 
+#include <d2srv/d2_config.h>
 #include <d2srv/dns_client.h>
 #include <dns/opcode.h>
 #include <asiodns/io_fetch.h>
@@ -15,10 +16,15 @@
 #include <d2srv/testutils/stats_test_utils.h>
 #include <dns/messagerenderer.h>
 
+#include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/ip/udp.hpp>
+#include <boost/asio/read.hpp>
 #include <boost/asio/socket_base.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/enable_shared_from_this.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <functional>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -42,6 +48,226 @@ const char* TEST_ADDRESS = "127.0.0.1";
 const uint16_t TEST_PORT = 5381;
 const size_t MAX_SIZE = 1024;
 const long TEST_TIMEOUT = 5 * 1000;
+
+/// @brief A stub DNS server answering DNS updates over TCP.
+///
+/// The server answers each request with a copy of it with the QR bit set.
+/// It may hold the requests received on a connection and answer them all
+/// at once, in the reverse order, to check that the responses are matched
+/// to the requests by their ID.
+class TCPStubServer {
+public:
+    /// @brief A connection accepted by the server.
+    class Session : public boost::enable_shared_from_this<Session> {
+    public:
+        /// @brief Constructor.
+        ///
+        /// @param server the server.
+        Session(TCPStubServer& server)
+            : server_(server), socket_(server.service_.get_io_service()) {
+        }
+
+        /// @brief Reads the next request.
+        void read() {
+            boost::asio::async_read(socket_,
+                                    boost::asio::buffer(length_, 2),
+                                    std::bind(&Session::readLength,
+                                              shared_from_this(), ph::_1));
+        }
+
+        /// @brief Handles the length of a request.
+        ///
+        /// @param ec the error code.
+        void readLength(const boost::system::error_code& ec) {
+            if (ec) {
+                return;
+            }
+
+            request_.resize((length_[0] << 8) | length_[1]);
+            boost::asio::async_read(socket_, boost::asio::buffer(request_),
+                                    std::bind(&Session::readRequest,
+                                              shared_from_this(), ph::_1));
+        }
+
+        /// @brief Handles a request.
+        ///
+        /// @param ec the error code.
+        void readRequest(const boost::system::error_code& ec) {
+            if (ec) {
+                return;
+            }
+
+            ++server_.received_;
+            std::vector<uint8_t> response(length_, length_ + 2);
+            response.insert(response.end(), request_.begin(), request_.end());
+            // Set the QR bit, see udpReceiveHandler.
+            response[4] = 0xA8;
+            held_.push_back(response);
+            if (server_.hold_ && (held_.size() >= server_.hold_)) {
+                for (auto it = held_.rbegin(); it != held_.rend(); ++it) {
+                    boost::asio::write(socket_, boost::asio::buffer(*it));
+                }
+
+                held_.clear();
+            }
+
+            read();
+        }
+
+        /// @brief The server.
+        TCPStubServer& server_;
+
+        /// @brief The socket.
+        tcp::socket socket_;
+
+        /// @brief The length of the request being read.
+        uint8_t length_[2];
+
+        /// @brief The request being read.
+        std::vector<uint8_t> request_;
+
+        /// @brief The responses not sent yet.
+        std::vector<std::vector<uint8_t> > held_;
+    };
+
+    /// @brief Constructor.
+    ///
+    /// @param service the IO service.
+    /// @param hold the number of requests a connection holds before
+    /// answering them, 0 to never answer.
+    TCPStubServer(IOService& service, const size_t hold = 1)
+        : service_(service),
+          acceptor_(service.get_io_service(),
+                    tcp::endpoint(address::from_string(TEST_ADDRESS),
+                                  TEST_PORT)),
+          hold_(hold), accepted_(0), received_(0) {
+        accept();
+    }
+
+    /// @brief Destructor.
+    ~TCPStubServer() {
+        acceptor_.close();
+        for (auto const& session : sessions_) {
+            boost::system::error_code ec;
+            session->socket_.close(ec);
+        }
+    }
+
+    /// @brief Accepts the next connection.
+    void accept() {
+        boost::shared_ptr<Session> session(new Session(*this));
+        acceptor_.async_accept(session->socket_,
+                               [this, session]
+                               (const boost::system::error_code& ec) {
+            if (ec) {
+                return;
+            }
+
+            ++accepted_;
+            boost::system::error_code ignored;
+            session->socket_.set_option(tcp::no_delay(true), ignored);
+            sessions_.push_back(session);
+            session->read();
+            accept();
+        });
+    }
+
+    /// @brief The IO service.
+    IOService& service_;
+
+    /// @brief The acceptor.
+    tcp::acceptor acceptor_;
+
+    /// @brief The accepted connections.
+    std::vector<boost::shared_ptr<Session> > sessions_;
+
+    /// @brief The number of requests held by a connection.
+    size_t hold_;
+
+    /// @brief The number of accepted connections.
+    size_t accepted_;
+
+    /// @brief The number of received requests.
+    size_t received_;
+};
+
+/// @brief Performs DNS updates one after the other with its own DNSClient.
+class UpdateSequence : public DNSClient::Callback {
+public:
+    /// @brief Constructor.
+    ///
+    /// @param service the IO service.
+    /// @param proto the transport protocol.
+    /// @param first_qid the ID of the first update.
+    /// @param count the number of updates.
+    /// @param remaining the number of updates of all sequences still to be
+    /// completed: the IO service is stopped when it reaches 0.
+    UpdateSequence(IOService& service, const DNSClient::Protocol proto,
+                   const uint16_t first_qid, const size_t count,
+                   size_t& remaining)
+        : service_(service), response_(), client_(),
+          message_(D2UpdateMessage::OUTBOUND), qid_(first_qid),
+          count_(count), sent_(0), successes_(0), remaining_(remaining) {
+        client_.reset(new DNSClient(response_, this, proto));
+        message_.setRcode(Rcode(Rcode::NOERROR_CODE));
+        message_.setZone(Name("example.com"), RRClass::IN());
+    }
+
+    /// @brief Sends the next update.
+    void send() {
+        message_.setId(qid_++);
+        ++sent_;
+        client_->doUpdate(service_, IOAddress(TEST_ADDRESS), TEST_PORT,
+                          message_, 1000);
+    }
+
+    /// @brief Update completion callback.
+    ///
+    /// @param status A status code returned by DNSClient.
+    virtual void operator()(DNSClient::Status status) {
+        if ((status == DNSClient::SUCCESS) &&
+            (response_->getQRFlag() == D2UpdateMessage::RESPONSE) &&
+            (response_->getId() == static_cast<uint16_t>(qid_ - 1))) {
+            ++successes_;
+        }
+
+        if (--remaining_ == 0) {
+            service_.stop();
+        }
+
+        if (sent_ < count_) {
+            send();
+        }
+    }
+
+    /// @brief The IO service.
+    IOService& service_;
+
+    /// @brief The response to the last update.
+    D2UpdateMessagePtr response_;
+
+    /// @brief The DNS client.
+    DNSClientPtr client_;
+
+    /// @brief The update.
+    D2UpdateMessage message_;
+
+    /// @brief The ID of the next update.
+    uint16_t qid_;
+
+    /// @brief The number of updates.
+    size_t count_;
+
+    /// @brief The number of sent updates.
+    size_t sent_;
+
+    /// @brief The number of successful updates.
+    size_t successes_;
+
+    /// @brief The number of updates of all sequences still to be completed.
+    size_t& remaining_;
+};
+
 /// @brief Test Fixture class
 //
 // This test fixture class implements DNSClient::Callback so as it can be
@@ -122,9 +348,13 @@ public:
 
     /// @brief Destructor
     ///
-    /// Sets the asiodns logging level back to DEBUG.
+    /// Sets the asiodns logging level back to DEBUG and the TCP connection
+    /// limits back to their defaults.
     virtual ~DNSClientTest() {
         asiodns::logger.setSeverity(isc::log::DEBUG);
+        DNSClient::
+            setTcpConnectionLimits(D2Params::DFT_DNS_SERVER_CONNECTIONS,
+                                   D2Params::DFT_DNS_SERVER_IDLE_TIMEOUT);
     };
 
     /// @brief Exchange completion callback
@@ -300,11 +530,11 @@ public:
     /// callback object is NULL.
     void runConstructorTest() {
         EXPECT_NO_THROW(DNSClient(response_, NULL, DNSClient::UDP));
+        EXPECT_NO_THROW(DNSClient(response_, NULL, DNSClient::TCP));
 
-        // The TCP Transport is not supported right now. So, we return exception
-        // if caller specified TCP as a preferred protocol. This test will be
-        // removed once TCP is supported.
-        EXPECT_THROW(DNSClient(response_, NULL, DNSClient::TCP),
+        // Other protocols are not supported.
+        EXPECT_THROW(DNSClient(response_, NULL,
+                               static_cast<DNSClient::Protocol>(2)),
                      isc::NotImplemented);
     }
 
@@ -448,6 +678,99 @@ public:
         service_.get_io_service().reset();
     }
 
+    /// @brief Sends DNS updates over TCP to the stub server.
+    ///
+    /// @param count the number of updates.
+    /// @param id the ID of the first update.
+    /// @param timeout the timeout of the updates.
+    void runTCPSendReceiveTest(const size_t count, const uint16_t id = 1,
+                               const int timeout = 500) {
+        dns_client_.reset(new DNSClient(response_, this, DNSClient::TCP));
+
+        D2UpdateMessage message(D2UpdateMessage::OUTBOUND);
+        ASSERT_NO_THROW(message.setRcode(Rcode(Rcode::NOERROR_CODE)));
+        ASSERT_NO_THROW(message.setZone(Name("example.com"), RRClass::IN()));
+
+        // The updates are sent one after the other.
+        for (size_t i = 0; i < count; ++i) {
+            message.setId(id + i);
+            expected_ = received_ + 1;
+            dns_client_->doUpdate(service_, IOAddress(TEST_ADDRESS), TEST_PORT,
+                                  message, timeout);
+            service_.run();
+            service_.get_io_service().reset();
+        }
+    }
+
+    /// @brief Destroys the DNSClient while DNS Updates sent over TCP are
+    /// pending and checks that the completion callback is not invoked.
+    ///
+    /// The server must not answer.
+    void runTCPClientDestroyedTest() {
+        // The completion callback must not be invoked.
+        expected_ = 1;
+
+        D2UpdateMessage message(D2UpdateMessage::OUTBOUND);
+        ASSERT_NO_THROW(message.setRcode(Rcode(Rcode::NOERROR_CODE)));
+        ASSERT_NO_THROW(message.setZone(Name("example.com"), RRClass::IN()));
+
+        // The client is destroyed before the update is sent.
+        message.setId(1);
+        dns_client_.reset(new DNSClient(response_, this, DNSClient::TCP));
+        dns_client_->doUpdate(service_, IOAddress(TEST_ADDRESS), TEST_PORT,
+                              message, 100);
+        dns_client_.reset();
+        runFor(50);
+
+        // The client is destroyed before the update times out.
+        message.setId(2);
+        dns_client_.reset(new DNSClient(response_, this, DNSClient::TCP));
+        dns_client_->doUpdate(service_, IOAddress(TEST_ADDRESS), TEST_PORT,
+                              message, 100);
+        runFor(50);
+        dns_client_.reset();
+        runFor(200);
+        EXPECT_EQ(0, received_);
+    }
+
+    /// @brief Runs update sequences over TCP.
+    ///
+    /// @param sequences the number of sequences run at the same time.
+    /// @param count the number of updates of each sequence.
+    void runTCPSequences(const size_t sequences, const size_t count) {
+        size_t remaining = sequences * count;
+        std::vector<boost::shared_ptr<UpdateSequence> > updates;
+        for (size_t i = 0; i < sequences; ++i) {
+            updates.push_back(boost::shared_ptr<UpdateSequence>(
+                new UpdateSequence(service_, DNSClient::TCP, 1 + i * count,
+                                   count, remaining)));
+        }
+
+        for (auto const& update : updates) {
+            update->send();
+        }
+
+        service_.run();
+        service_.get_io_service().reset();
+
+        for (auto const& update : updates) {
+            EXPECT_EQ(count, update->successes_);
+        }
+
+        EXPECT_EQ(0, remaining);
+    }
+
+    /// @brief Runs the IO service for the given time.
+    ///
+    /// @param ms the time in milliseconds.
+    void runFor(const long ms) {
+        IntervalTimer timer(service_);
+        timer.setup([this]() { service_.stop(); }, ms,
+                    IntervalTimer::ONE_SHOT);
+        service_.run();
+        service_.get_io_service().reset();
+    }
+
     /// @brief Performs a single request-response exchange with or without TSIG.
     ///
     /// @param client_key TSIG passed to dns_client and also used by the
@@ -675,4 +998,117 @@ TEST_F(DNSClientTest, concurrentSendReceive) {
     checkStats(stats_upd);
 }
 
+// Verify that the DNSClient sends a DNS Update over TCP and receives the
+// response.
+TEST_F(DNSClientTest, tcpSendReceive) {
+    TCPStubServer server(service_);
+    runTCPSendReceiveTest(1);
+    EXPECT_EQ(1, received_);
+    EXPECT_EQ(1, server.accepted_);
+    EXPECT_EQ(1, server.received_);
+    StatMap stats_upd = {
+        { "update-sent", 1},
+        { "update-signed", 0},
+        { "update-unsigned", 1},
+        { "update-success", 1},
+        { "update-timeout", 0},
+        { "update-error", 0}
+    };
+    checkStats(stats_upd);
+}
+
+// Verify that DNS Updates sent over TCP one after the other go through
+// the same connection.
+TEST_F(DNSClientTest, tcpPersistentConnection) {
+    TCPStubServer server(service_);
+    runTCPSendReceiveTest(3);
+    EXPECT_EQ(3, received_);
+    EXPECT_EQ(1, server.accepted_);
+    EXPECT_EQ(3, server.received_);
+    EXPECT_EQ(1, DNSClient::getTcpConnectionCount());
+}
+
+// Verify that a connection without pending DNS Updates is closed after
+// the idle timeout, or right away when the idle timeout is 0.
+TEST_F(DNSClientTest, tcpIdleTimeout) {
+    TCPStubServer server(service_);
+    DNSClient::setTcpConnectionLimits(1, 100);
+    runTCPSendReceiveTest(1);
+    EXPECT_EQ(1, DNSClient::getTcpConnectionCount());
+    runFor(300);
+    EXPECT_EQ(0, DNSClient::getTcpConnectionCount());
+
+    // The next update opens a new connection.
+    DNSClient::setTcpConnectionLimits(1, 0);
+    runTCPSendReceiveTest(2, 10);
+    EXPECT_EQ(3, received_);
+    EXPECT_EQ(3, server.accepted_);
+    EXPECT_EQ(0, DNSClient::getTcpConnectionCount());
+}
+
+// Verify that DNS Updates are pipelined over a connection and that the
+// responses are matched to the updates by their ID.
+TEST_F(DNSClientTest, tcpPipelining) {
+    // The server answers once it holds all the updates, in reverse order.
+    TCPStubServer server(service_, 10);
+    runTCPSequences(10, 1);
+    EXPECT_EQ(1, server.accepted_);
+    EXPECT_EQ(10, server.received_);
+}
+
+// Verify that busy connections are added to the pool up to the limit.
+TEST_F(DNSClientTest, tcpConnectionPool) {
+    TCPStubServer server(service_);
+    DNSClient::setTcpConnectionLimits(4, 10000);
+    EXPECT_EQ(4, DNSClient::getTcpMaxConnections());
+    EXPECT_EQ(10000, DNSClient::getTcpIdleTimeout());
+    EXPECT_THROW(DNSClient::setTcpConnectionLimits(0, 10000), BadValue);
+
+    runTCPSequences(20, 5);
+    EXPECT_EQ(4, server.accepted_);
+    EXPECT_EQ(100, server.received_);
+    EXPECT_EQ(4, DNSClient::getTcpConnectionCount());
+}
+
+// Verify that a timeout is reported when the server does not answer over
+// TCP, and an error when it cannot be reached.
+TEST_F(DNSClientTest, tcpTimeoutAndError) {
+    expect_response_ = false;
+    {
+        // The server never answers.
+        TCPStubServer server(service_, 0);
+        runTCPSendReceiveTest(1, 1, 100);
+        EXPECT_EQ(DNSClient::TIMEOUT, status_);
+        EXPECT_EQ(1, server.received_);
+    }
+
+    // There is no server anymore.
+    size_t remaining = 1;
+    UpdateSequence update(service_, DNSClient::TCP, 2, 1, remaining);
+    update.send();
+    service_.run();
+    service_.get_io_service().reset();
+    EXPECT_EQ(0, remaining);
+    EXPECT_EQ(0, update.successes_);
+    EXPECT_EQ(0, DNSClient::getTcpConnectionCount());
+    StatMap stats_upd = {
+        { "update-sent", 2},
+        { "update-signed", 0},
+        { "update-unsigned", 2},
+        { "update-success", 0},
+        { "update-timeout", 1},
+        { "update-error", 1}
+    };
+    checkStats(stats_upd);
+}
+
+// Verify that DNS Updates pending over TCP complete silently when their
+// DNSClient is destroyed.
+TEST_F(DNSClientTest, tcpClientDestroyed) {
+    // The server never answers.
+    TCPStubServer server(service_, 0);
+    runTCPClientDestroyedTest();
+    EXPECT_EQ(1, server.received_);
+}
+
 } // End of anonymous namespace
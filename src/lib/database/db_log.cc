@@ -26,6 +26,7 @@ const DbLogger::MessageMap db_message_map = {
 
     { PGSQL_DEALLOC_ERROR,      DATABASE_PGSQL_DEALLOC_ERROR },
     { PGSQL_FATAL_ERROR,        DATABASE_PGSQL_FATAL_ERROR },
+    { PGSQL_PIPELINE_FAILED,    DATABASE_PGSQL_PIPELINE_FAILED },
     { PGSQL_START_TRANSACTION,  DATABASE_PGSQL_START_TRANSACTION },
     { PGSQL_COMMIT,             DATABASE_PGSQL_COMMIT },
     { PGSQL_ROLLBACK,           DATABASE_PGSQL_ROLLBACK },
@@ -53,6 +53,7 @@ enum DbMessageID {
 
     PGSQL_DEALLOC_ERROR,
     PGSQL_FATAL_ERROR,
+    PGSQL_PIPELINE_FAILED,
     PGSQL_START_TRANSACTION,
     PGSQL_COMMIT,
     PGSQL_ROLLBACK,
@@ -1,4 +1,4 @@
-// Copyright (C) 2011-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2011-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -187,7 +187,8 @@ IfaceMgr::IfaceMgr()
     : packet_filter_(new PktFilterInet()),
       packet_filter6_(new PktFilterInet6()),
       test_mode_(false),
-      allow_loopback_(false) {
+      allow_loopback_(false),
+      receiver_cpu_(-1) {
 
     // Ensure that PQMs have been created to guarantee we have
     // default packet queues in place.
@@ -301,6 +302,7 @@ void IfaceMgr::stopDHCPReceiver() {
     }
 
     dhcp_receiver_.reset();
+    receiver_cpu_ = -1;
 
     if (getPacketQueue4()) {
         getPacketQueue4()->clear();
@@ -1648,6 +1650,10 @@ IfaceMgr::receiveDHCP4Packets() {
     fd_set sockets;
     int maxfd = 0;
 
+    // Pin the thread before it allocates packet buffers.
+    pinThread(receiver_cpu_set_);
+    receiver_cpu_ = getCurrentCpu();
+
     FD_ZERO(&sockets);
 
     // Add terminate watch socket.
@@ -1706,6 +1712,7 @@ IfaceMgr::receiveDHCP4Packets() {
             for (SocketInfo s : iface->getSockets()) {
                 if (FD_ISSET(s.sockfd_, &sockets)) {
                     receiveDHCP4Packet(*iface, s);
+                    receiver_cpu_.store(getCurrentCpu(), std::memory_order_relaxed);
                     // Can take time so check one more time the watch socket.
                     if (dhcp_receiver_->shouldTerminate()) {
                         return;
@@ -1722,6 +1729,10 @@ IfaceMgr::receiveDHCP6Packets() {
     fd_set sockets;
     int maxfd = 0;
 
+    // Pin the thread before it allocates packet buffers.
+    pinThread(receiver_cpu_set_);
+    receiver_cpu_ = getCurrentCpu();
+
     FD_ZERO(&sockets);
 
     // Add terminate watch socket.
@@ -1779,6 +1790,7 @@ IfaceMgr::receiveDHCP6Packets() {
             for (SocketInfo s : iface->getSockets()) {
                 if (FD_ISSET(s.sockfd_, &sockets)) {
                     receiveDHCP6Packet(s);
+                    receiver_cpu_.store(getCurrentCpu(), std::memory_order_relaxed);
                     // Can take time so check one more time the watch socket.
                     if (dhcp_receiver_->shouldTerminate()) {
                         return;
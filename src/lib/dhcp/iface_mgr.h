@@ -1,4 +1,4 @@
-// Copyright (C) 2011-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2011-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -16,6 +16,7 @@
 #include <dhcp/packet_queue_mgr6.h>
 #include <dhcp/pkt_filter.h>
 #include <dhcp/pkt_filter6.h>
+#include <util/cpu_affinity.h>
 #include <util/optional.h>
 #include <util/watch_socket.h>
 #include <util/watched_thread.h>
@@ -28,6 +29,7 @@
 #include <boost/scoped_array.hpp>
 #include <boost/shared_ptr.hpp>
 
+#include <atomic>
 #include <functional>
 #include <list>
 #include <vector>
@@ -1252,6 +1254,37 @@ public:
         return (dhcp_receiver_ != 0 && dhcp_receiver_->isRunning());
     }
 
+    /// @brief Sets the CPUs the DHCP packet receiver thread is pinned on.
+    ///
+    /// The receiver thread pins itself when it starts so the new set
+    /// is used by the next call to @ref startDHCPReceiver. The packet
+    /// buffers the receiver allocates are then local to the NUMA node
+    /// of the CPU set. When it can't be pinned the receiver thread keeps
+    /// running unpinned, see @ref isc::util::pinThread.
+    ///
+    /// @param cpus the CPU set, empty to not pin the receiver thread.
+    void setReceiverCpuSet(const isc::util::CpuSet& cpus) {
+        receiver_cpu_set_ = cpus;
+    }
+
+    /// @brief Returns the CPUs the DHCP packet receiver thread is pinned on.
+    ///
+    /// @return the CPU set, empty when the receiver thread is not pinned.
+    const isc::util::CpuSet& getReceiverCpuSet() const {
+        return (receiver_cpu_set_);
+    }
+
+    /// @brief Returns the CPU the DHCP packet receiver thread last ran on.
+    ///
+    /// The receiver thread records its CPU when it starts and after each
+    /// received packet.
+    ///
+    /// @return the CPU or -1 if it is not known (e.g. the receiver thread
+    /// is not running).
+    int getReceiverCpu() const {
+        return (receiver_cpu_.load(std::memory_order_relaxed));
+    }
+
     /// @brief Configures DHCP packet queue
     ///
     /// If the given configuration enables packet queueing, then the
@@ -1561,6 +1594,12 @@ private:
 
     /// DHCP packet receiver.
     isc::util::WatchedThreadPtr dhcp_receiver_;
+
+    /// @brief CPUs the DHCP packet receiver thread is pinned on.
+    isc::util::CpuSet receiver_cpu_set_;
+
+    /// @brief CPU the DHCP packet receiver thread last ran on.
+    std::atomic<int> receiver_cpu_;
 };
 
 }; // namespace isc::dhcp
@@ -1,4 +1,4 @@
-// Copyright (C) 2011-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2011-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -72,6 +72,12 @@ OptionDefContainers LibDHCP::option_defs_;
 // Static container with option definitions created in runtime.
 StagedValue<OptionDefSpaceContainer> LibDHCP::runtime_option_defs_;
 
+// Thread staging runtime option definitions.
+std::atomic<std::thread::id> LibDHCP::runtime_option_defs_thread_;
+
+// Thread the calling thread works for.
+thread_local std::thread::id LibDHCP::runtime_option_defs_parent_;
+
 // Null container.
 const OptionDefContainerPtr null_option_def_container_(new OptionDefContainer());
 
@@ -183,7 +189,7 @@ LibDHCP::getVendorOptionDef(const Option::Universe u, const uint32_t vendor_id,
 
 OptionDefinitionPtr
 LibDHCP::getRuntimeOptionDef(const std::string& space, const uint16_t code) {
-    OptionDefContainerPtr container = runtime_option_defs_.getValue().getItems(space);
+    OptionDefContainerPtr container = getVisibleRuntimeOptionDefs().getItems(space);
     const OptionDefContainerTypeIndex& index = container->get<1>();
     const OptionDefContainerTypeRange& range = index.equal_range(code);
     if (range.first != range.second) {
@@ -195,7 +201,7 @@ LibDHCP::getRuntimeOptionDef(const std::string& space, const uint16_t code) {
 
 OptionDefinitionPtr
 LibDHCP::getRuntimeOptionDef(const std::string& space, const std::string& name) {
-    OptionDefContainerPtr container = runtime_option_defs_.getValue().getItems(space);
+    OptionDefContainerPtr container = getVisibleRuntimeOptionDefs().getItems(space);
     const OptionDefContainerNameIndex& index = container->get<2>();
     const OptionDefContainerNameRange& range = index.equal_range(name);
     if (range.first != range.second) {
@@ -207,7 +213,7 @@ LibDHCP::getRuntimeOptionDef(const std::string& space, const std::string& name)
 
 OptionDefContainerPtr
 LibDHCP::getRuntimeOptionDefs(const std::string& space) {
-    return (runtime_option_defs_.getValue().getItems(space));
+    return (getVisibleRuntimeOptionDefs().getItems(space));
 }
 
 void
@@ -241,6 +247,26 @@ LibDHCP::commitRuntimeOptionDefs() {
     runtime_option_defs_.commit();
 }
 
+void
+LibDHCP::setRuntimeOptionDefsStagingThread(const std::thread::id& id) {
+    runtime_option_defs_thread_ = id;
+}
+
+void
+LibDHCP::setRuntimeOptionDefsParentThread(const std::thread::id& id) {
+    runtime_option_defs_parent_ = id;
+}
+
+const OptionDefSpaceContainer&
+LibDHCP::getVisibleRuntimeOptionDefs() {
+    std::thread::id id = runtime_option_defs_thread_;
+    if ((id == std::thread::id()) || (id == std::this_thread::get_id()) ||
+        (id == runtime_option_defs_parent_)) {
+        return (runtime_option_defs_.getValue());
+    }
+    return (runtime_option_defs_.getCommittedValue());
+}
+
 OptionDefinitionPtr
 LibDHCP::getLastResortOptionDef(const std::string& space, const uint16_t code) {
     OptionDefContainerPtr container = getLastResortOptionDefs(space);
@@ -1,4 +1,4 @@
-// Copyright (C) 2011-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2011-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -15,9 +15,11 @@
 #include <util/buffer.h>
 #include <util/staged_value.h>
 
+#include <atomic>
 #include <iostream>
 #include <stdint.h>
 #include <string>
+#include <thread>
 
 namespace isc {
 namespace dhcp {
@@ -351,6 +353,31 @@ public:
     /// @brief Commits runtime option definitions.
     static void commitRuntimeOptionDefs();
 
+    /// @brief Sets the thread staging runtime option definitions.
+    ///
+    /// By default uncommitted runtime option definitions are returned to
+    /// all threads. When a staging thread is set only this thread gets
+    /// them: other threads, e.g. packet processing threads, keep getting
+    /// the committed definitions. This allows to parse a new configuration
+    /// while packets are processed using the current configuration.
+    ///
+    /// @note The commit must be done when no other thread accesses the
+    /// runtime option definitions.
+    ///
+    /// @param id Identifier of the staging thread, an empty identifier
+    /// restores the default.
+    static void setRuntimeOptionDefsStagingThread(const std::thread::id& id);
+
+    /// @brief Sets the thread the calling thread works for.
+    ///
+    /// A thread working for the staging thread, e.g. a thread parsing
+    /// a part of the new configuration, gets the same runtime option
+    /// definitions as the staging thread.
+    ///
+    /// @param id Identifier of the thread the calling thread works for,
+    /// an empty identifier when it works for itself.
+    static void setRuntimeOptionDefsParentThread(const std::thread::id& id);
+
     /// @brief Converts option space name to vendor id.
     ///
     /// If the option space name is specified in the following format:
@@ -389,8 +416,20 @@ private:
     /// Container that holds option definitions for various option spaces.
     static OptionDefContainers option_defs_;
 
+    /// @brief Returns runtime option definitions visible by the caller.
+    ///
+    /// @return Committed or staged runtime option definitions depending
+    /// on the staging thread.
+    static const OptionDefSpaceContainer& getVisibleRuntimeOptionDefs();
+
     /// Container for additional option definitions created in runtime.
     static util::StagedValue<OptionDefSpaceContainer> runtime_option_defs_;
+
+    /// Thread staging runtime option definitions, empty for all threads.
+    static std::atomic<std::thread::id> runtime_option_defs_thread_;
+
+    /// Thread the calling thread works for, empty when none.
+    static thread_local std::thread::id runtime_option_defs_parent_;
 };
 
 }
@@ -404,6 +404,60 @@ public:
         timestamp_ = timestamp;
     }
 
+    /// @brief Packet processing stages timed by the server.
+    ///
+    /// The time spent in each stage is accumulated in the packet and
+    /// reported in latency statistics when the response is sent.
+    enum ProcessingStage {
+        STAGE_QUEUE_WAIT,       ///< from reception to processing start
+        STAGE_CLASSIFICATION,   ///< client classification
+        STAGE_HOST_LOOKUP,      ///< host reservation lookup
+        STAGE_LEASE_ALLOCATION, ///< lease allocation, renewal or release
+        STAGE_HOOKS,            ///< callouts at the server hook points
+        STAGE_PACK_SEND,        ///< response packing and sending
+        STAGE_COUNT             ///< number of stages (not a stage)
+    };
+
+    /// @brief Adds time spent in a processing stage.
+    ///
+    /// @param stage processing stage.
+    /// @param duration time spent in the stage.
+    void addStageDuration(ProcessingStage stage,
+                          const boost::posix_time::time_duration& duration) {
+        stage_durations_[stage] += duration;
+    }
+
+    /// @brief Returns the time spent in a processing stage.
+    ///
+    /// @param stage processing stage.
+    /// @return accumulated time spent in the stage.
+    const boost::posix_time::time_duration&
+    getStageDuration(ProcessingStage stage) const {
+        return (stage_durations_[stage]);
+    }
+
+    /// @brief Copies processing stage durations from a query.
+    ///
+    /// This is called on a response to take over the timing of the query
+    /// it answers. The query timestamp is copied too so the response
+    /// knows when the query was received.
+    ///
+    /// @param query query packet.
+    void copyStageDurations(const Pkt& query) {
+        for (size_t i = 0; i < STAGE_COUNT; ++i) {
+            stage_durations_[i] = query.stage_durations_[i];
+        }
+        query_timestamp_ = query.timestamp_;
+    }
+
+    /// @brief Returns the reception timestamp of the query.
+    ///
+    /// @return the timestamp copied by @ref copyStageDurations or
+    /// not_a_date_time.
+    const boost::posix_time::ptime& getQueryTimestamp() const {
+        return (query_timestamp_);
+    }
+
     /// @brief Copies content of input buffer to output buffer.
     ///
     /// This is mostly a diagnostic function. It is being used for sending
@@ -772,6 +826,12 @@ protected:
     /// packet timestamp
     boost::posix_time::ptime timestamp_;
 
+    /// query timestamp (set in responses by @ref copyStageDurations)
+    boost::posix_time::ptime query_timestamp_;
+
+    /// time spent in each processing stage
+    boost::posix_time::time_duration stage_durations_[STAGE_COUNT];
+
     // remote HW address (src if receiving packet, dst if sending packet)
     HWAddrPtr remote_hwaddr_;
 
@@ -796,6 +856,46 @@ private:
 /// @brief A pointer to either Pkt4 or Pkt6 packet
 typedef boost::shared_ptr<isc::dhcp::Pkt> PktPtr;
 
+/// @brief RAII object timing a packet processing stage.
+///
+/// The time elapsed between the construction and the destruction of
+/// this object is added to the given stage of the packet.
+class ScopedPktStageTimer {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// Starts the timer.
+    ///
+    /// @param pkt packet (may be null in which case nothing is timed).
+    /// @param stage processing stage.
+    ScopedPktStageTimer(const PktPtr& pkt, Pkt::ProcessingStage stage)
+        : pkt_(pkt), stage_(stage),
+          start_(boost::posix_time::microsec_clock::universal_time()) {
+    }
+
+    /// @brief Destructor.
+    ///
+    /// Adds the elapsed time to the packet stage.
+    ~ScopedPktStageTimer() {
+        if (pkt_) {
+            pkt_->addStageDuration(stage_,
+                boost::posix_time::microsec_clock::universal_time() - start_);
+        }
+    }
+
+private:
+
+    /// @brief Timed packet.
+    PktPtr pkt_;
+
+    /// @brief Timed stage.
+    Pkt::ProcessingStage stage_;
+
+    /// @brief Start time.
+    boost::posix_time::ptime start_;
+};
+
 }; // namespace isc::dhcp
 }; // namespace isc
 
@@ -1566,6 +1566,46 @@ TEST_F(IfaceMgrTest, sendReceive4) {
     sendReceive4Test(queue_control, true);
 }
 
+// Verifies that the DHCPv4 packet receiver thread is pinned on its
+// CPU set and records the CPU it runs on.
+TEST_F(IfaceMgrTest, receiverCpuSet4) {
+    scoped_ptr<NakedIfaceMgr> ifacemgr(new NakedIfaceMgr());
+    EXPECT_TRUE(ifacemgr->getReceiverCpuSet().empty());
+    EXPECT_EQ(-1, ifacemgr->getReceiverCpu());
+
+    // CPU 0 is always available.
+    ifacemgr->setReceiverCpuSet(isc::util::CpuSet(1, 0));
+    EXPECT_EQ(isc::util::CpuSet(1, 0), ifacemgr->getReceiverCpuSet());
+
+    int socket1 = -1;
+    ASSERT_NO_THROW(socket1 = ifacemgr->openSocket(LOOPBACK_NAME,
+                                                   IOAddress("127.0.0.1"),
+                                                   DHCP4_SERVER_PORT + 10000));
+    ASSERT_GE(socket1, 0);
+    data::ConstElementPtr queue_control =
+        makeQueueConfig(PacketQueueMgr4::DEFAULT_QUEUE_TYPE4, 500, true);
+    ASSERT_TRUE(ifacemgr->configureDHCPPacketQueue(AF_INET, queue_control));
+    ASSERT_NO_THROW(ifacemgr->startDHCPReceiver(AF_INET));
+    ASSERT_TRUE(ifacemgr->isDHCPReceiverRunning());
+
+    // The receiver thread records its CPU when it starts.
+    int cpu = -1;
+    for (int i = 0; i < 1000; ++i) {
+        cpu = ifacemgr->getReceiverCpu();
+        if (cpu != -1) {
+            break;
+        }
+        usleep(1000);
+    }
+#if defined(OS_LINUX)
+    EXPECT_EQ(0, cpu);
+#endif
+
+    ifacemgr->stopDHCPReceiver();
+    EXPECT_EQ(-1, ifacemgr->getReceiverCpu());
+    ifacemgr->closeSockets();
+}
+
 // Verifies that it is possible to set custom packet filter object
 // to handle sockets opening and send/receive operation.
 TEST_F(IfaceMgrTest, setPacketFilter) {
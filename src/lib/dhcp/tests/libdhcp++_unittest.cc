@@ -36,6 +36,7 @@
 
 #include <iostream>
 #include <sstream>
+#include <thread>
 #include <typeinfo>
 
 #include <arpa/inet.h>
@@ -2314,6 +2315,39 @@ TEST_F(LibDhcpTest, setRuntimeOptionDefs) {
     testRuntimeOptionDefs(5, 100, false);
 }
 
+// This test verifies that runtime option definitions staged by a staging
+// thread are not visible by other threads until they are committed.
+TEST_F(LibDhcpTest, runtimeOptionDefsStagingThread) {
+    // Commit option definitions in 2 namespaces.
+    OptionDefSpaceContainer defs;
+    createRuntimeOptionDefs(2, 10, defs);
+    ASSERT_NO_THROW(LibDHCP::setRuntimeOptionDefs(defs));
+    ASSERT_NO_THROW(LibDHCP::commitRuntimeOptionDefs());
+
+    // Stage option definitions in 5 namespaces from another thread.
+    std::thread staging([]() {
+        LibDHCP::setRuntimeOptionDefsStagingThread(std::this_thread::get_id());
+        OptionDefSpaceContainer defs;
+        createRuntimeOptionDefs(5, 10, defs);
+        LibDHCP::setRuntimeOptionDefs(defs);
+        testRuntimeOptionDefs(5, 10, true);
+    });
+    staging.join();
+
+    // This thread still gets the committed definitions.
+    testRuntimeOptionDefs(2, 10, true);
+    EXPECT_FALSE(LibDHCP::getRuntimeOptionDef("option-space-4", 1));
+
+    // Until the default visibility is restored.
+    LibDHCP::setRuntimeOptionDefsStagingThread(std::thread::id());
+    testRuntimeOptionDefs(5, 10, true);
+
+    // Reverting the staged definitions gives back the committed ones.
+    LibDHCP::revertRuntimeOptionDefs();
+    testRuntimeOptionDefs(2, 10, true);
+    EXPECT_FALSE(LibDHCP::getRuntimeOptionDef("option-space-4", 1));
+}
+
 // This test verifies the processing of option 43
 TEST_F(LibDhcpTest, option43) {
     // Check shouldDeferOptionUnpack()
@@ -837,6 +837,41 @@ TEST_F(Pkt4Test, Timestamp) {
     EXPECT_TRUE(ts_period.length().total_microseconds() >= 0);
 }
 
+// Checks that processing stage durations are accumulated, timed by
+// the scoped timer and copied from a query to its response.
+TEST_F(Pkt4Test, stageDurations) {
+    Pkt4Ptr query(new Pkt4(DHCPDISCOVER, 1234));
+    for (size_t i = 0; i < Pkt::STAGE_COUNT; ++i) {
+        EXPECT_EQ(0, query->getStageDuration(static_cast<Pkt::ProcessingStage>(i)).
+                  total_microseconds());
+    }
+
+    query->addStageDuration(Pkt::STAGE_HOOKS,
+                            boost::posix_time::microseconds(10));
+    query->addStageDuration(Pkt::STAGE_HOOKS,
+                            boost::posix_time::microseconds(5));
+    EXPECT_EQ(15, query->getStageDuration(Pkt::STAGE_HOOKS).total_microseconds());
+
+    {
+        ScopedPktStageTimer timer(query, Pkt::STAGE_LEASE_ALLOCATION);
+        usleep(1000);
+    }
+    EXPECT_LE(1000, query->getStageDuration(Pkt::STAGE_LEASE_ALLOCATION).
+              total_microseconds());
+
+    // A null packet is accepted by the timer.
+    EXPECT_NO_THROW(ScopedPktStageTimer(PktPtr(), Pkt::STAGE_HOOKS));
+
+    query->updateTimestamp();
+    Pkt4Ptr rsp(new Pkt4(DHCPOFFER, 1234));
+    ASSERT_TRUE(rsp->getQueryTimestamp().is_not_a_date_time());
+    rsp->copyStageDurations(*query);
+    EXPECT_EQ(query->getTimestamp(), rsp->getQueryTimestamp());
+    EXPECT_EQ(15, rsp->getStageDuration(Pkt::STAGE_HOOKS).total_microseconds());
+    EXPECT_EQ(query->getStageDuration(Pkt::STAGE_LEASE_ALLOCATION),
+              rsp->getStageDuration(Pkt::STAGE_LEASE_ALLOCATION));
+}
+
 TEST_F(Pkt4Test, hwaddr) {
     scoped_ptr<Pkt4> pkt(new Pkt4(DHCPOFFER, 1234));
     const uint8_t hw[] = { 2, 4, 6, 8, 10, 12 }; // MAC
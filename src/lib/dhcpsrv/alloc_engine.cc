@@ -1,4 +1,4 @@
-// Copyright (C) 2012-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2012-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -36,6 +36,7 @@
 #include <algorithm>
 #include <cstring>
 #include <limits>
+#include <set>
 #include <sstream>
 #include <stdint.h>
 #include <string.h>
@@ -395,7 +396,7 @@ getIPv6Resrv(const SubnetID& subnet_id, const IOAddress& address) {
     // are unique, we should call get6 (supported by all backends). If we're in
     // the mode in which non-unique reservations are allowed the backends which
     // don't support it are not used and we can safely call getAll6.
-    if (CfgMgr::instance().getCurrentCfg()->getCfgDbAccess()->getIPReservationsUnique()) {
+    if (CfgMgr::instance().getCurrentCfgSnapshot()->getCfgDbAccess()->getIPReservationsUnique()) {
         auto host = HostMgr::instance().get6(subnet_id, address);
         if (host) {
             reserved.push_back(host);
@@ -587,7 +588,7 @@ AllocEngine::ClientContext6::getDdnsParams() {
 
     // Doesn't exist yet or is stale, (re)create it.
     if (subnet_) {
-        ddns_params_ = CfgMgr::instance().getCurrentCfg()->getDdnsParams(subnet_);
+        ddns_params_ = CfgMgr::instance().getCurrentCfgSnapshot()->getDdnsParams(subnet_);
         return (ddns_params_);
     }
 
@@ -1024,7 +1025,7 @@ AllocEngine::allocateUnreservedLeases6(ClientContext6& ctx) {
     // If multi-threading is disabled, honor the configured order for host
     // reservations lookup.
     if (!check_reservation_first) {
-        check_reservation_first = CfgMgr::instance().getCurrentCfg()->getReservationsLookupFirst();
+        check_reservation_first = CfgMgr::instance().getCurrentCfgSnapshot()->getReservationsLookupFirst();
     }
 
     uint64_t total_attempts = 0;
@@ -1957,7 +1958,7 @@ AllocEngine::getLifetimes6(ClientContext6& ctx, uint32_t& preferred, uint32_t& v
     if (!classes.empty()) {
         // Let's get class definitions
         const ClientClassDictionaryPtr& dict =
-            CfgMgr::instance().getCurrentCfg()->getClientClassDictionary();
+            CfgMgr::instance().getCurrentCfgSnapshot()->getClientClassDictionary();
 
         // Iterate over the assigned class defintions.
         int have_both = 0;
@@ -2506,6 +2507,88 @@ AllocEngine::updateLeaseData(ClientContext6& ctx, const Lease6Collection& leases
     return (updated_leases);
 }
 
+namespace {
+
+/// @brief Number of reclaimed leases written to the lease database at once.
+const size_t RECLAIM_BATCH_SIZE = 100;
+
+/// @brief Updates the statistics of a reclaimed IPv6 lease.
+///
+/// @param lease Pointer to the reclaimed lease.
+void
+updateReclaimedStats(const Lease6Ptr& lease) {
+    // Decrease number of assigned leases.
+    if (lease->type_ == Lease::TYPE_NA) {
+        // IA_NA
+        StatsMgr::instance().addValue(StatsMgr::generateName("subnet",
+                                                             lease->subnet_id_,
+                                                             "assigned-nas"),
+                                      int64_t(-1));
+
+    } else if (lease->type_ == Lease::TYPE_PD) {
+        // IA_PD
+        StatsMgr::instance().addValue(StatsMgr::generateName("subnet",
+                                                             lease->subnet_id_,
+                                                             "assigned-pds"),
+                                      int64_t(-1));
+
+    }
+
+    // Increase total number of reclaimed leases.
+    StatsMgr::instance().addValue("reclaimed-leases", int64_t(1));
+
+    // Increase number of reclaimed leases for a subnet.
+    StatsMgr::instance().addValue(StatsMgr::generateName("subnet",
+                                                         lease->subnet_id_,
+                                                         "reclaimed-leases"),
+                                  int64_t(1));
+}
+
+/// @brief Updates the statistics of a reclaimed IPv4 lease.
+///
+/// @param lease Pointer to the reclaimed lease.
+void
+updateReclaimedStats(const Lease4Ptr& lease) {
+    // Decrease number of assigned addresses.
+    StatsMgr::instance().addValue(StatsMgr::generateName("subnet",
+                                                         lease->subnet_id_,
+                                                         "assigned-addresses"),
+                                  int64_t(-1));
+
+    // Increase total number of reclaimed leases.
+    StatsMgr::instance().addValue("reclaimed-leases", int64_t(1));
+
+    // Increase number of reclaimed leases for a subnet.
+    StatsMgr::instance().addValue(StatsMgr::generateName("subnet",
+                                                         lease->subnet_id_,
+                                                         "reclaimed-leases"),
+                                  int64_t(1));
+}
+
+/// @brief Logs the failure to reclaim an IPv6 lease.
+///
+/// @param lease Pointer to the lease.
+/// @param error The error message.
+void
+logReclamationFailure(const Lease6Ptr& lease, const std::string& error) {
+    LOG_ERROR(alloc_engine_logger, ALLOC_ENGINE_V6_LEASE_RECLAMATION_FAILED)
+        .arg(lease->addr_.toText())
+        .arg(error);
+}
+
+/// @brief Logs the failure to reclaim an IPv4 lease.
+///
+/// @param lease Pointer to the lease.
+/// @param error The error message.
+void
+logReclamationFailure(const Lease4Ptr& lease, const std::string& error) {
+    LOG_ERROR(alloc_engine_logger, ALLOC_ENGINE_V4_LEASE_RECLAMATION_FAILED)
+        .arg(lease->addr_.toText())
+        .arg(error);
+}
+
+}  // namespace
+
 void
 AllocEngine::reclaimExpiredLeases6(const size_t max_leases, const uint16_t timeout,
                                    const bool remove_lease,
@@ -2556,46 +2639,65 @@ AllocEngine::reclaimExpiredLeases6(const size_t max_leases, const uint16_t timeo
         callout_handle = HooksManager::createCalloutHandle();
     }
 
-    size_t leases_processed = 0;
-    BOOST_FOREACH(Lease6Ptr lease, leases) {
-
-        try {
-            // Reclaim the lease.
-            if (MultiThreadingMgr::instance().getMode()) {
-                // The reclamation is exclusive of packet processing.
-                WriteLockGuard exclusive(rw_mutex_);
-
-                reclaimExpiredLease(lease, remove_lease, callout_handle);
-                ++leases_processed;
-            } else {
-                reclaimExpiredLease(lease, remove_lease, callout_handle);
-                ++leases_processed;
+    // The reclaimed leases are written to the lease database in batches.
+    ReclaimBatch<Lease6Collection> batch;
+    const DbReclaimMode reclaim_mode = (remove_lease ? DB_RECLAIM_REMOVE :
+                                        DB_RECLAIM_UPDATE);
+    std::function<Lease6Collection (const Lease6Collection&)> leases_update_fun =
+        std::bind(&LeaseMgr::updateLeases6, &lease_mgr, ph::_1);
+    bool timed_out = false;
+    auto lease_it = leases.begin();
+
+    // Reclaim the leases of a batch and write them.
+    auto reclaim_batch = [&]() {
+        for (size_t count = 0; (count < RECLAIM_BATCH_SIZE) &&
+                 (lease_it != leases.end()); ++count) {
+            Lease6Ptr lease = *lease_it++;
+            try {
+                reclaimExpiredLease(lease, reclaim_mode, callout_handle, &batch);
+
+            } catch (const std::exception& ex) {
+                LOG_ERROR(alloc_engine_logger, ALLOC_ENGINE_V6_LEASE_RECLAMATION_FAILED)
+                    .arg(lease->addr_.toText())
+                    .arg(ex.what());
             }
 
-        } catch (const std::exception& ex) {
-            LOG_ERROR(alloc_engine_logger, ALLOC_ENGINE_V6_LEASE_RECLAMATION_FAILED)
-                .arg(lease->addr_.toText())
-                .arg(ex.what());
-        }
-
-        // Check if we have hit the timeout for running reclamation routine and
-        // return if we have. We're checking it here, because we always want to
-        // allow reclaiming at least one lease.
-        if ((timeout > 0) && (stopwatch.getTotalMilliseconds() >= timeout)) {
-            // Timeout. This will likely mean that we haven't been able to process
-            // all leases we wanted to process. The reclamation pass will be
-            // probably marked as incomplete.
-            if (!incomplete_reclamation) {
-                if (leases_processed < leases.size()) {
-                    incomplete_reclamation = true;
-                }
+            // Check if we have hit the timeout for running reclamation
+            // routine and return if we have. We're checking it here,
+            // because we always want to allow reclaiming at least one lease.
+            if ((timeout > 0) && (stopwatch.getTotalMilliseconds() >= timeout)) {
+                timed_out = true;
+                break;
             }
+        }
+        reclaimLeasesInDatabase(batch, leases_update_fun);
+    };
 
-            LOG_DEBUG(alloc_engine_logger, ALLOC_ENGINE_DBG_TRACE,
-                      ALLOC_ENGINE_V6_LEASES_RECLAMATION_TIMEOUT)
-                .arg(timeout);
-            break;
+    while (!timed_out && (lease_it != leases.end())) {
+        if (MultiThreadingMgr::instance().getMode()) {
+            // The reclamation is exclusive of packet processing.
+            WriteLockGuard exclusive(rw_mutex_);
+
+            reclaim_batch();
+        } else {
+            reclaim_batch();
+        }
+    }
+
+    size_t leases_processed = batch.processed_;
+    if (timed_out) {
+        // Timeout. This will likely mean that we haven't been able to process
+        // all leases we wanted to process. The reclamation pass will be
+        // probably marked as incomplete.
+        if (!incomplete_reclamation) {
+            if (leases_processed < leases.size()) {
+                incomplete_reclamation = true;
+            }
         }
+
+        LOG_DEBUG(alloc_engine_logger, ALLOC_ENGINE_DBG_TRACE,
+                  ALLOC_ENGINE_V6_LEASES_RECLAMATION_TIMEOUT)
+            .arg(timeout);
     }
 
     // Stop measuring the time.
@@ -2702,46 +2804,65 @@ AllocEngine::reclaimExpiredLeases4(const size_t max_leases, const uint16_t timeo
         callout_handle = HooksManager::createCalloutHandle();
     }
 
-    size_t leases_processed = 0;
-    BOOST_FOREACH(Lease4Ptr lease, leases) {
-
-        try {
-            // Reclaim the lease.
-            if (MultiThreadingMgr::instance().getMode()) {
-                // The reclamation is exclusive of packet processing.
-                WriteLockGuard exclusive(rw_mutex_);
-
-                reclaimExpiredLease(lease, remove_lease, callout_handle);
-                ++leases_processed;
-            } else {
-                reclaimExpiredLease(lease, remove_lease, callout_handle);
-                ++leases_processed;
+    // The reclaimed leases are written to the lease database in batches.
+    ReclaimBatch<Lease4Collection> batch;
+    const DbReclaimMode reclaim_mode = (remove_lease ? DB_RECLAIM_REMOVE :
+                                        DB_RECLAIM_UPDATE);
+    std::function<Lease4Collection (const Lease4Collection&)> leases_update_fun =
+        std::bind(&LeaseMgr::updateLeases4, &lease_mgr, ph::_1);
+    bool timed_out = false;
+    auto lease_it = leases.begin();
+
+    // Reclaim the leases of a batch and write them.
+    auto reclaim_batch = [&]() {
+        for (size_t count = 0; (count < RECLAIM_BATCH_SIZE) &&
+                 (lease_it != leases.end()); ++count) {
+            Lease4Ptr lease = *lease_it++;
+            try {
+                reclaimExpiredLease(lease, reclaim_mode, callout_handle, &batch);
+
+            } catch (const std::exception& ex) {
+                LOG_ERROR(alloc_engine_logger, ALLOC_ENGINE_V4_LEASE_RECLAMATION_FAILED)
+                    .arg(lease->addr_.toText())
+                    .arg(ex.what());
             }
 
-        } catch (const std::exception& ex) {
-            LOG_ERROR(alloc_engine_logger, ALLOC_ENGINE_V4_LEASE_RECLAMATION_FAILED)
-                .arg(lease->addr_.toText())
-                .arg(ex.what());
-        }
-
-        // Check if we have hit the timeout for running reclamation routine and
-        // return if we have. We're checking it here, because we always want to
-        // allow reclaiming at least one lease.
-        if ((timeout > 0) && (stopwatch.getTotalMilliseconds() >= timeout)) {
-            // Timeout. This will likely mean that we haven't been able to process
-            // all leases we wanted to process. The reclamation pass will be
-            // probably marked as incomplete.
-            if (!incomplete_reclamation) {
-                if (leases_processed < leases.size()) {
-                    incomplete_reclamation = true;
-                }
+            // Check if we have hit the timeout for running reclamation
+            // routine and return if we have. We're checking it here,
+            // because we always want to allow reclaiming at least one lease.
+            if ((timeout > 0) && (stopwatch.getTotalMilliseconds() >= timeout)) {
+                timed_out = true;
+                break;
             }
+        }
+        reclaimLeasesInDatabase(batch, leases_update_fun);
+    };
 
-            LOG_DEBUG(alloc_engine_logger, ALLOC_ENGINE_DBG_TRACE,
-                      ALLOC_ENGINE_V4_LEASES_RECLAMATION_TIMEOUT)
-                .arg(timeout);
-            break;
+    while (!timed_out && (lease_it != leases.end())) {
+        if (MultiThreadingMgr::instance().getMode()) {
+            // The reclamation is exclusive of packet processing.
+            WriteLockGuard exclusive(rw_mutex_);
+
+            reclaim_batch();
+        } else {
+            reclaim_batch();
+        }
+    }
+
+    size_t leases_processed = batch.processed_;
+    if (timed_out) {
+        // Timeout. This will likely mean that we haven't been able to process
+        // all leases we wanted to process. The reclamation pass will be
+        // probably marked as incomplete.
+        if (!incomplete_reclamation) {
+            if (leases_processed < leases.size()) {
+                incomplete_reclamation = true;
+            }
         }
+
+        LOG_DEBUG(alloc_engine_logger, ALLOC_ENGINE_DBG_TRACE,
+                  ALLOC_ENGINE_V4_LEASES_RECLAMATION_TIMEOUT)
+            .arg(timeout);
     }
 
     // Stop measuring the time.
@@ -2799,7 +2920,8 @@ AllocEngine::reclaimExpiredLease(const LeasePtrType& lease,
 void
 AllocEngine::reclaimExpiredLease(const Lease6Ptr& lease,
                                  const DbReclaimMode& reclaim_mode,
-                                 const CalloutHandlePtr& callout_handle) {
+                                 const CalloutHandlePtr& callout_handle,
+                                 ReclaimBatch<Lease6Collection>* batch) {
 
     LOG_DEBUG(alloc_engine_logger, ALLOC_ENGINE_DBG_TRACE,
               ALLOC_ENGINE_V6_LEASE_RECLAIM)
@@ -2855,7 +2977,17 @@ AllocEngine::reclaimExpiredLease(const Lease6Ptr& lease,
             remove_lease = reclaimDeclined(lease);
         }
 
-        if (reclaim_mode != DB_RECLAIM_LEAVE_UNCHANGED) {
+        if ((reclaim_mode != DB_RECLAIM_LEAVE_UNCHANGED) && batch) {
+            // The lease is written with the other leases of the batch
+            // which also updates the statistics.
+            if (remove_lease) {
+                batch->remove_.push_back(lease);
+            } else {
+                batch->update_.push_back(lease);
+            }
+            return;
+
+        } else if (reclaim_mode != DB_RECLAIM_LEAVE_UNCHANGED) {
             // Reclaim the lease - depending on the configuration, set the
             // expired-reclaimed state or simply remove it.
             LeaseMgr& lease_mgr = LeaseMgrFactory::instance();
@@ -2866,38 +2998,18 @@ AllocEngine::reclaimExpiredLease(const Lease6Ptr& lease,
     }
 
     // Update statistics.
+    updateReclaimedStats(lease);
 
-    // Decrease number of assigned leases.
-    if (lease->type_ == Lease::TYPE_NA) {
-        // IA_NA
-        StatsMgr::instance().addValue(StatsMgr::generateName("subnet",
-                                                             lease->subnet_id_,
-                                                             "assigned-nas"),
-                                      int64_t(-1));
-
-    } else if (lease->type_ == Lease::TYPE_PD) {
-        // IA_PD
-        StatsMgr::instance().addValue(StatsMgr::generateName("subnet",
-                                                             lease->subnet_id_,
-                                                             "assigned-pds"),
-                                      int64_t(-1));
-
+    if (batch) {
+        ++batch->processed_;
     }
-
-    // Increase total number of reclaimed leases.
-    StatsMgr::instance().addValue("reclaimed-leases", int64_t(1));
-
-    // Increase number of reclaimed leases for a subnet.
-    StatsMgr::instance().addValue(StatsMgr::generateName("subnet",
-                                                         lease->subnet_id_,
-                                                         "reclaimed-leases"),
-                                  int64_t(1));
 }
 
 void
 AllocEngine::reclaimExpiredLease(const Lease4Ptr& lease,
                                  const DbReclaimMode& reclaim_mode,
-                                 const CalloutHandlePtr& callout_handle) {
+                                 const CalloutHandlePtr& callout_handle,
+                                 ReclaimBatch<Lease4Collection>* batch) {
 
     LOG_DEBUG(alloc_engine_logger, ALLOC_ENGINE_DBG_TRACE,
               ALLOC_ENGINE_V4_LEASE_RECLAIM)
@@ -2955,7 +3067,17 @@ AllocEngine::reclaimExpiredLease(const Lease4Ptr& lease,
             remove_lease = reclaimDeclined(lease);
         }
 
-        if (reclaim_mode != DB_RECLAIM_LEAVE_UNCHANGED) {
+        if ((reclaim_mode != DB_RECLAIM_LEAVE_UNCHANGED) && batch) {
+            // The lease is written with the other leases of the batch
+            // which also updates the statistics.
+            if (remove_lease) {
+                batch->remove_.push_back(lease);
+            } else {
+                batch->update_.push_back(lease);
+            }
+            return;
+
+        } else if (reclaim_mode != DB_RECLAIM_LEAVE_UNCHANGED) {
             // Reclaim the lease - depending on the configuration, set the
             // expired-reclaimed state or simply remove it.
             LeaseMgr& lease_mgr = LeaseMgrFactory::instance();
@@ -2966,21 +3088,11 @@ AllocEngine::reclaimExpiredLease(const Lease4Ptr& lease,
     }
 
     // Update statistics.
+    updateReclaimedStats(lease);
 
-    // Decrease number of assigned addresses.
-    StatsMgr::instance().addValue(StatsMgr::generateName("subnet",
-                                                         lease->subnet_id_,
-                                                         "assigned-addresses"),
-                                  int64_t(-1));
-
-    // Increase total number of reclaimed leases.
-    StatsMgr::instance().addValue("reclaimed-leases", int64_t(1));
-
-    // Increase number of reclaimed leases for a subnet.
-    StatsMgr::instance().addValue(StatsMgr::generateName("subnet",
-                                                         lease->subnet_id_,
-                                                         "reclaimed-leases"),
-                                  int64_t(1));
+    if (batch) {
+        ++batch->processed_;
+    }
 }
 
 void
@@ -3146,6 +3258,101 @@ void AllocEngine::reclaimLeaseInDatabase(const LeasePtrType& lease,
         .arg(lease->addr_.toText());
 }
 
+template<typename LeaseCollectionType>
+void
+AllocEngine::reclaimLeasesInDatabase(ReclaimBatch<LeaseCollectionType>& batch,
+                                     const std::function<LeaseCollectionType
+                                     (const LeaseCollectionType&)>&
+                                     leases_update_fun) const {
+    typedef typename LeaseCollectionType::value_type LeasePtrType;
+
+    LeaseMgr& lease_mgr = LeaseMgrFactory::instance();
+
+    // Account a written lease.
+    auto reclaimed = [&batch](const LeasePtrType& lease) {
+        updateReclaimedStats(lease);
+        ++batch.processed_;
+
+        LOG_DEBUG(alloc_engine_logger, ALLOC_ENGINE_DBG_TRACE,
+                  ALLOC_ENGINE_LEASE_RECLAIMED)
+            .arg(lease->addr_.toText());
+    };
+
+    if (!batch.update_.empty()) {
+        for (auto const& lease : batch.update_) {
+            // Clear FQDN information as we have already sent the
+            // name change request to remove the DNS record.
+            lease->reuseable_valid_lft_ = 0;
+            lease->hostname_.clear();
+            lease->fqdn_fwd_ = false;
+            lease->fqdn_rev_ = false;
+            lease->state_ = Lease::STATE_EXPIRED_RECLAIMED;
+        }
+
+        size_t processed = batch.update_.size();
+        std::set<LeasePtr> missing;
+        std::string error;
+        try {
+            LeaseCollectionType not_updated = leases_update_fun(batch.update_);
+            missing.insert(not_updated.begin(), not_updated.end());
+
+        } catch (const LeaseBatchError& ex) {
+            // Only the first leases of the batch were handled.
+            processed = ex.getProcessed();
+            missing.insert(ex.getRejected().begin(), ex.getRejected().end());
+            error = ex.what();
+
+        } catch (const std::exception& ex) {
+            processed = 0;
+            error = ex.what();
+        }
+
+        for (auto const& lease : batch.update_) {
+            if (processed == 0) {
+                logReclamationFailure(lease, error);
+                continue;
+            }
+            --processed;
+            if (missing.count(lease)) {
+                logReclamationFailure(lease, "unable to update lease for "
+                                      "address " + lease->addr_.toText() +
+                                      " as it does not exist");
+            } else {
+                reclaimed(lease);
+            }
+        }
+        batch.update_.clear();
+    }
+
+    if (!batch.remove_.empty()) {
+        // The leases which no longer exist are reclaimed too.
+        size_t processed = batch.remove_.size();
+        std::string error;
+        try {
+            static_cast<void>(lease_mgr.deleteLeases(batch.remove_));
+
+        } catch (const LeaseBatchError& ex) {
+            // Only the first leases of the batch were handled.
+            processed = ex.getProcessed();
+            error = ex.what();
+
+        } catch (const std::exception& ex) {
+            processed = 0;
+            error = ex.what();
+        }
+
+        for (auto const& lease : batch.remove_) {
+            if (processed == 0) {
+                logReclamationFailure(lease, error);
+            } else {
+                --processed;
+                reclaimed(lease);
+            }
+        }
+        batch.remove_.clear();
+    }
+}
+
 }  // namespace dhcp
 }  // namespace isc
 
@@ -3190,7 +3397,7 @@ addressReserved(const IOAddress& address, const AllocEngine::ClientContext4& ctx
         // the mode in which non-unique reservations are allowed the backends which
         // don't support it are not used and we can safely call getAll4.
         ConstHostCollection hosts;
-        if (CfgMgr::instance().getCurrentCfg()->getCfgDbAccess()->getIPReservationsUnique()) {
+        if (CfgMgr::instance().getCurrentCfgSnapshot()->getCfgDbAccess()->getIPReservationsUnique()) {
             // Reservations are unique. It is safe to call get4 to get the unique host.
             ConstHostPtr host = HostMgr::instance().get4(ctx.subnet_->getID(), address);
             if (host) {
@@ -3478,7 +3685,7 @@ AllocEngine::ClientContext4::getDdnsParams() {
 
     // Doesn't exist yet or is stale, (re)create it.
     if (subnet_) {
-        ddns_params_ = CfgMgr::instance().getCurrentCfg()->getDdnsParams(subnet_);
+        ddns_params_ = CfgMgr::instance().getCurrentCfgSnapshot()->getDdnsParams(subnet_);
         return (ddns_params_);
     }
 
@@ -3959,7 +4166,7 @@ AllocEngine::getValidLft(const ClientContext4& ctx) {
     if (!classes.empty()) {
         // Let's get class definitions
         const ClientClassDictionaryPtr& dict =
-            CfgMgr::instance().getCurrentCfg()->getClientClassDictionary();
+            CfgMgr::instance().getCurrentCfgSnapshot()->getClientClassDictionary();
 
         // Iterate over the assigned class defintions.
         for (ClientClasses::const_iterator name = classes.cbegin();
@@ -1,4 +1,4 @@
-// Copyright (C) 2012-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2012-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -1243,6 +1243,31 @@ private:
         DB_RECLAIM_LEAVE_UNCHANGED
     };
 
+    /// @brief Reclaimed leases waiting to be written to the lease database.
+    ///
+    /// The leases reclamation routines write the reclaimed leases to the
+    /// lease database in batches, using the batch methods of the lease
+    /// manager.
+    ///
+    /// @tparam LeaseCollectionType One of the @c Lease4Collection or
+    /// @c Lease6Collection.
+    template<typename LeaseCollectionType>
+    struct ReclaimBatch {
+        /// @brief Leases to be set to the "expired-reclaimed" state.
+        LeaseCollectionType update_;
+
+        /// @brief Leases to be removed.
+        LeaseCollectionType remove_;
+
+        /// @brief Number of leases reclaimed so far.
+        size_t processed_ = 0;
+
+        /// @brief Returns the number of leases waiting to be written.
+        size_t size() const {
+            return (update_.size() + remove_.size());
+        }
+    };
+
     /// @brief Reclaim DHCPv4 or DHCPv6 lease with updating lease database.
     ///
     /// This method is called by the lease reclamation routine to reclaim the
@@ -1283,9 +1308,13 @@ private:
     /// @param reclaim_mode Indicates what the method should do with the reclaimed
     /// lease in the lease database.
     /// @param callout_handle Pointer to the callout handle.
+    /// @param batch When not null the lease database update is deferred:
+    /// the lease is added to this batch and the statistics are updated when
+    /// the batch is written by @c reclaimLeasesInDatabase.
     void reclaimExpiredLease(const Lease6Ptr& lease,
                              const DbReclaimMode& reclaim_mode,
-                             const hooks::CalloutHandlePtr& callout_handle);
+                             const hooks::CalloutHandlePtr& callout_handle,
+                             ReclaimBatch<Lease6Collection>* batch = 0);
 
     /// @brief Reclaim DHCPv4 lease.
     ///
@@ -1297,9 +1326,13 @@ private:
     /// @param reclaim_mode Indicates what the method should do with the reclaimed
     /// lease in the lease database.
     /// @param callout_handle Pointer to the callout handle.
+    /// @param batch When not null the lease database update is deferred:
+    /// the lease is added to this batch and the statistics are updated when
+    /// the batch is written by @c reclaimLeasesInDatabase.
     void reclaimExpiredLease(const Lease4Ptr& lease,
                              const DbReclaimMode& reclaim_mode,
-                             const hooks::CalloutHandlePtr& callout_handle);
+                             const hooks::CalloutHandlePtr& callout_handle,
+                             ReclaimBatch<Lease4Collection>* batch = 0);
 
     /// @brief Marks lease as reclaimed in the database.
     ///
@@ -1325,6 +1358,27 @@ private:
                                 const std::function<void (const LeasePtrType&)>&
                                 lease_update_fun) const;
 
+    /// @brief Marks a batch of leases as reclaimed in the database.
+    ///
+    /// This method is called internally by the leases reclamation routines
+    /// to write a batch of reclaimed leases at once. The leases which were
+    /// written are counted as processed and the statistics are updated
+    /// for them, including when the lease manager failed part way through
+    /// the batch (see @c LeaseBatchError). The errors are logged for each
+    /// lease of the batch. The batch is empty on return.
+    ///
+    /// @param batch The batch of reclaimed leases.
+    /// @param leases_update_fun Pointer to the function in the @c LeaseMgr
+    /// to be used to update the leases which are not removed.
+    ///
+    /// @tparam LeaseCollectionType One of the @c Lease6Collection or
+    /// @c Lease4Collection.
+    template<typename LeaseCollectionType>
+    void reclaimLeasesInDatabase(ReclaimBatch<LeaseCollectionType>& batch,
+                                 const std::function<LeaseCollectionType
+                                 (const LeaseCollectionType&)>&
+                                 leases_update_fun) const;
+
     /// @anchor reclaimDeclinedLease4
     /// @brief Conducts steps necessary for reclaiming declined IPv4 lease.
     ///
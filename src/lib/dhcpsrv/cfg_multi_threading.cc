@@ -1,4 +1,4 @@
-// Copyright (C) 2020-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2020-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -9,8 +9,11 @@
 #include <cc/data.h>
 #include <cc/simple_parser.h>
 #include <cfg_multi_threading.h>
+#include <dhcpsrv/dhcpsrv_log.h>
 #include <util/multi_threading_mgr.h>
 
+#include <cstring>
+
 using namespace isc::data;
 using namespace isc::util;
 
@@ -23,6 +26,12 @@ CfgMultiThreading::apply(ConstElementPtr value) {
     uint32_t thread_count = 0;
     uint32_t queue_size = 0;
     CfgMultiThreading::extract(value, enabled, thread_count, queue_size);
+    bool work_stealing = false;
+    if (value && value->get("work-stealing")) {
+        work_stealing = SimpleParser::getBoolean(value, "work-stealing");
+    }
+    MultiThreadingMgr::instance().setWorkStealing(work_stealing);
+    MultiThreadingMgr::instance().setCpuSet(extractCpuSet(value, "worker-cpu-set"));
     MultiThreadingMgr::instance().apply(enabled, thread_count, queue_size);
 }
 
@@ -47,5 +56,20 @@ CfgMultiThreading::extract(ConstElementPtr value, bool& enabled,
     }
 }
 
+CpuSet
+CfgMultiThreading::extractCpuSet(ConstElementPtr value, const std::string& name) {
+    if (!value || !value->get(name)) {
+        return (CpuSet());
+    }
+    return (parseCpuSet(SimpleParser::getString(value, name)));
+}
+
+void
+CfgMultiThreading::threadAffinityErrorHandler(const CpuSet& cpus, int error) {
+    LOG_WARN(dhcpsrv_logger, DHCPSRV_THREAD_AFFINITY_FAILED)
+        .arg(cpuSetToText(cpus))
+        .arg(strerror(error));
+}
+
 }  // namespace dhcp
 }  // namespace isc
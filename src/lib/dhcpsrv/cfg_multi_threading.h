@@ -1,4 +1,4 @@
-// Copyright (C) 2020 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2020-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -8,6 +8,9 @@
 #define CFG_MULTI_THREADING_H
 
 #include <cc/data.h>
+#include <util/cpu_affinity.h>
+
+#include <string>
 
 namespace isc {
 namespace dhcp {
@@ -29,6 +32,28 @@ public:
     /// @param[out] queue_size The queue size
     static void extract(data::ConstElementPtr value, bool& enabled,
                         uint32_t& thread_count, uint32_t& queue_size);
+
+    /// @brief extract a CPU set parameter
+    ///
+    /// @param value The multi-threading configuration
+    /// @param name The name of the parameter ("worker-cpu-set" or
+    /// "receiver-cpu-set")
+    /// @return The CPU set, empty when the parameter is not configured
+    /// @throw BadValue if the parameter is not a valid CPU list
+    static util::CpuSet extractCpuSet(data::ConstElementPtr value,
+                                      const std::string& name);
+
+    /// @brief Logs a thread pinning failure.
+    ///
+    /// Installed by the servers with
+    /// @ref isc::util::setThreadAffinityErrorHandler so the worker and
+    /// receiver threads which can't be pinned report it and keep running
+    /// unpinned.
+    ///
+    /// @param cpus The CPU set the thread failed to be pinned on.
+    /// @param error The errno value.
+    static void threadAffinityErrorHandler(const util::CpuSet& cpus,
+                                           int error);
 };
 
 }  // namespace dhcp
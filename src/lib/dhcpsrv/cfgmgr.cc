@@ -1,4 +1,4 @@
-// Copyright (C) 2012-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2012-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -19,6 +19,37 @@ using namespace isc::util;
 namespace isc {
 namespace dhcp {
 
+namespace {
+
+/// @brief Last allocated epoch.
+///
+/// Epochs are unique in the process so a snapshot can't be mistaken for
+/// the snapshot of another configuration manager instance.
+std::atomic<uint64_t> last_epoch(0);
+
+/// @brief Returns a new epoch.
+uint64_t
+nextEpoch() {
+    return (++last_epoch);
+}
+
+/// @brief Thread snapshot of the current configuration.
+struct CfgSnapshot {
+    /// @brief Epoch the snapshot was taken at.
+    uint64_t epoch_;
+
+    /// @brief The current configuration at this epoch.
+    SrvConfigPtr config_;
+
+    /// @brief Number of pins: the snapshot is not refreshed when not 0.
+    unsigned pins_;
+};
+
+/// @brief The snapshot of the calling thread.
+thread_local CfgSnapshot cfg_snapshot = { 0, SrvConfigPtr(), 0 };
+
+} // end of anonymous namespace
+
 const size_t CfgMgr::CONFIG_LIST_SIZE = 10;
 
 CfgMgr&
@@ -70,11 +101,18 @@ CfgMgr::getD2ClientMgr() {
 void
 CfgMgr::ensureCurrentAllocated() {
     if (!configuration_ || configs_.empty()) {
-        configuration_.reset(new SrvConfig());
+        setCurrentCfg(SrvConfigPtr(new SrvConfig()));
         configs_.push_back(configuration_);
     }
 }
 
+void
+CfgMgr::setCurrentCfg(const SrvConfigPtr& config) {
+    std::lock_guard<std::mutex> lock(current_mutex_);
+    configuration_ = config;
+    epoch_.store(nextEpoch(), std::memory_order_release);
+}
+
 void
 CfgMgr::clear() {
     if (configuration_) {
@@ -82,6 +120,9 @@ CfgMgr::clear() {
     }
     configs_.clear();
     external_configs_.clear();
+    // A new default configuration becomes current right away as the
+    // snapshots never allocate it.
+    ensureCurrentAllocated();
     D2ClientConfigPtr d2_default_conf(new D2ClientConfig());
     setD2ClientConfig(d2_default_conf);
 }
@@ -96,7 +137,7 @@ CfgMgr::commit() {
     configuration_->removeStatistics();
 
     if (!configs_.back()->sequenceEquals(*configuration_)) {
-        configuration_ = configs_.back();
+        setCurrentCfg(configs_.back());
         // Keep track of the maximum size of the configs history. Before adding
         // new element, we have to remove the oldest one.
         if (configs_.size() > CONFIG_LIST_SIZE) {
@@ -163,6 +204,18 @@ CfgMgr::getCurrentCfg() {
     return (configuration_);
 }
 
+const SrvConfigPtr&
+CfgMgr::getCurrentCfgSnapshot() {
+    CfgSnapshot& snapshot = cfg_snapshot;
+    if ((snapshot.pins_ == 0) &&
+        (snapshot.epoch_ != epoch_.load(std::memory_order_acquire))) {
+        std::lock_guard<std::mutex> lock(current_mutex_);
+        snapshot.epoch_ = epoch_.load(std::memory_order_relaxed);
+        snapshot.config_ = configuration_;
+    }
+    return (snapshot.config_);
+}
+
 SrvConfigPtr
 CfgMgr::getStagingCfg() {
     ensureCurrentAllocated();
@@ -220,14 +273,31 @@ CfgMgr::mergeIntoCfg(const SrvConfigPtr& target_config, const uint32_t seq) {
 }
 
 CfgMgr::CfgMgr()
-    : datadir_(DHCP_DATA_DIR, true), d2_client_mgr_(), family_(AF_INET) {
+    : datadir_(DHCP_DATA_DIR, true), d2_client_mgr_(), family_(AF_INET),
+      epoch_(nextEpoch()) {
     // DHCP_DATA_DIR must be set set with -DDHCP_DATA_DIR="..." in Makefile.am
     // Note: the definition of DHCP_DATA_DIR needs to include quotation marks
     // See AM_CPPFLAGS definition in Makefile.am
+
+    // The current configuration always exists so the snapshots can be
+    // taken by any thread.
+    ensureCurrentAllocated();
 }
 
 CfgMgr::~CfgMgr() {
 }
 
+CfgSnapshotPin::CfgSnapshotPin() {
+    CfgSnapshot& snapshot = cfg_snapshot;
+    if (snapshot.pins_ == 0) {
+        CfgMgr::instance().getCurrentCfgSnapshot();
+    }
+    ++snapshot.pins_;
+}
+
+CfgSnapshotPin::~CfgSnapshotPin() {
+    --cfg_snapshot.pins_;
+}
+
 } // end of isc::dhcp namespace
 } // end of isc namespace
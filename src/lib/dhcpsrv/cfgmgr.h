@@ -1,4 +1,4 @@
-// Copyright (C) 2012-2019 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2012-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -20,7 +20,9 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/noncopyable.hpp>
 
+#include <atomic>
 #include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <list>
@@ -219,6 +221,37 @@ public:
     /// @return Non-null pointer to the current configuration.
     SrvConfigPtr getCurrentCfg();
 
+    /// @brief Returns the calling thread snapshot of the current configuration.
+    ///
+    /// Each thread keeps a pointer to the current configuration with the
+    /// epoch it was taken at. The epoch changes each time another
+    /// configuration becomes current (commit, revert or clear). As long as
+    /// the epoch did not change this function only reads the epoch and
+    /// returns the thread pointer: unlike @ref getCurrentCfg it does not
+    /// copy the shared pointer so it does not increment the shared reference
+    /// counter which all worker threads would compete for. The snapshot is
+    /// refreshed under a mutex when the epoch changed, and this function
+    /// never allocates or modifies the configuration manager state. This is
+    /// meant for the packet processing code which uses the configuration
+    /// many times per packet.
+    ///
+    /// While a @ref CfgSnapshotPin exists in the calling thread the snapshot
+    /// is not refreshed, so all the processing of a packet uses the same
+    /// configuration.
+    ///
+    /// A configuration which is no longer current is destroyed when all
+    /// threads moved to a newer epoch (i.e. called this function again) or
+    /// exited, e.g. when the thread pool is stopped during a reconfiguration.
+    ///
+    /// @note The returned reference refers to the thread snapshot. It stays
+    /// valid while a @ref CfgSnapshotPin exists in the calling thread. It
+    /// must not be kept across a change of the current configuration when
+    /// the snapshot is not pinned: the next call after the change updates
+    /// the snapshot.
+    ///
+    /// @return Non-null pointer to the current configuration.
+    const SrvConfigPtr& getCurrentCfgSnapshot();
+
     /// @brief Returns a pointer to the staging configuration.
     ///
     /// The staging configuration is used by the configuration parsers to
@@ -305,6 +338,14 @@ private:
     /// default current configuration.
     void ensureCurrentAllocated();
 
+    /// @brief Makes a configuration the current one.
+    ///
+    /// It sets the current configuration and changes the epoch so
+    /// the thread snapshots are updated.
+    ///
+    /// @param config The new current configuration.
+    void setCurrentCfg(const SrvConfigPtr& config);
+
 
     /// @brief Merges external configuration with the given sequence number
     /// into the specified configuration.
@@ -349,6 +390,33 @@ private:
 
     /// @brief Address family.
     uint16_t family_;
+
+    /// @brief Epoch of the current configuration.
+    std::atomic<uint64_t> epoch_;
+
+    /// @brief Mutex protecting the current configuration pointer against
+    /// concurrent snapshot updates.
+    std::mutex current_mutex_;
+};
+
+/// @brief Pins the current configuration snapshot of the calling thread.
+///
+/// The outermost instance refreshes the snapshot of the calling thread
+/// which is then returned by @ref CfgMgr::getCurrentCfgSnapshot until the
+/// instance is destroyed, even if another configuration becomes current
+/// meanwhile. The packet processing creates one for each packet. Instances
+/// can be nested.
+class CfgSnapshotPin : public boost::noncopyable {
+public:
+    /// @brief Constructor.
+    ///
+    /// Refreshes and pins the snapshot unless it is already pinned.
+    CfgSnapshotPin();
+
+    /// @brief Destructor.
+    ///
+    /// Unpins the snapshot when this is the outermost instance.
+    ~CfgSnapshotPin();
 };
 
 } // namespace isc::dhcp
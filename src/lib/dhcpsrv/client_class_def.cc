@@ -12,6 +12,7 @@
 #include <dhcpsrv/parsers/client_class_def_parser.h>
 #include <boost/foreach.hpp>
 
+#include <chrono>
 #include <queue>
 
 using namespace isc::data;
@@ -21,11 +22,14 @@ namespace dhcp {
 
 //********** ClientClassDef ******************//
 
+std::atomic<bool> ClientClassDef::eval_stats_enabled_(false);
+
 ClientClassDef::ClientClassDef(const std::string& name,
                                const ExpressionPtr& match_expr,
                                const CfgOptionPtr& cfg_option)
     : UserContext(), CfgToElement(), StampedElement(), name_(name),
-      match_expr_(match_expr), required_(false), depend_on_known_(false),
+      match_expr_(match_expr), evaluations_(0), matches_(0), skipped_(0),
+      errors_(0), evaluation_time_(0), required_(false), depend_on_known_(false),
       cfg_option_(cfg_option), next_server_(asiolink::IOAddress::IPV4_ZERO_ADDRESS()),
       valid_(), preferred_() {
 
@@ -40,11 +44,16 @@ ClientClassDef::ClientClassDef(const std::string& name,
     if (!cfg_option_) {
         cfg_option_.reset(new CfgOption());
     }
+
+    if (match_expr_) {
+        compiled_match_expr_.reset(new CompiledExpression(*match_expr_));
+    }
 }
 
 ClientClassDef::ClientClassDef(const ClientClassDef& rhs)
     : UserContext(rhs), CfgToElement(rhs), StampedElement(rhs), name_(rhs.name_),
-      match_expr_(ExpressionPtr()), test_(rhs.test_), required_(rhs.required_),
+      match_expr_(ExpressionPtr()), evaluations_(0), matches_(0), skipped_(0),
+      errors_(0), evaluation_time_(0), test_(rhs.test_), required_(rhs.required_),
       depend_on_known_(rhs.depend_on_known_), cfg_option_(new CfgOption()),
       next_server_(rhs.next_server_), sname_(rhs.sname_),
       filename_(rhs.filename_), valid_(rhs.valid_), preferred_(rhs.preferred_) {
@@ -52,6 +61,7 @@ ClientClassDef::ClientClassDef(const ClientClassDef& rhs)
     if (rhs.match_expr_) {
         match_expr_.reset(new Expression());
         *match_expr_ = *(rhs.match_expr_);
+        compiled_match_expr_.reset(new CompiledExpression(*match_expr_));
     }
 
     if (rhs.cfg_option_def_) {
@@ -85,6 +95,71 @@ ClientClassDef::getMatchExpr() const {
 void
 ClientClassDef::setMatchExpr(const ExpressionPtr& match_expr) {
     match_expr_ = match_expr;
+    if (match_expr_) {
+        compiled_match_expr_.reset(new CompiledExpression(*match_expr_));
+    } else {
+        compiled_match_expr_.reset();
+    }
+}
+
+bool
+ClientClassDef::evaluateMatchExpr(Pkt& pkt) {
+    if (!compiled_match_expr_) {
+        return (false);
+    }
+    if (!eval_stats_enabled_.load(std::memory_order_relaxed)) {
+        return (compiled_match_expr_->canMatch(pkt) &&
+                compiled_match_expr_->evaluateBool(pkt));
+    }
+    if (!compiled_match_expr_->canMatch(pkt)) {
+        ++skipped_;
+        return (false);
+    }
+    ++evaluations_;
+    auto start = std::chrono::steady_clock::now();
+    bool status = false;
+    try {
+        status = compiled_match_expr_->evaluateBool(pkt);
+    } catch (...) {
+        ++errors_;
+        evaluation_time_ += std::chrono::duration_cast<std::chrono::nanoseconds>
+            (std::chrono::steady_clock::now() - start).count();
+        throw;
+    }
+    evaluation_time_ += std::chrono::duration_cast<std::chrono::nanoseconds>
+        (std::chrono::steady_clock::now() - start).count();
+    if (status) {
+        ++matches_;
+    }
+    return (status);
+}
+
+void
+ClientClassDef::setEvalStatsEnabled(bool enabled) {
+    eval_stats_enabled_ = enabled;
+}
+
+bool
+ClientClassDef::getEvalStatsEnabled() {
+    return (eval_stats_enabled_);
+}
+
+ElementPtr
+ClientClassDef::getEvalStats() const {
+    ElementPtr result = Element::createMap();
+    result->set("name", Element::create(name_));
+    result->set("evaluations",
+                Element::create(static_cast<int64_t>(evaluations_.load())));
+    result->set("matches",
+                Element::create(static_cast<int64_t>(matches_.load())));
+    result->set("skipped",
+                Element::create(static_cast<int64_t>(skipped_.load())));
+    result->set("errors",
+                Element::create(static_cast<int64_t>(errors_.load())));
+    // The evaluation time is in microseconds.
+    int64_t evaluation_time = evaluation_time_.load() / 1000;
+    result->set("evaluation-time", Element::create(evaluation_time));
+    return (result);
 }
 
 std::string
@@ -457,6 +532,17 @@ ClientClassDictionary::toElement() const {
     return (result);
 }
 
+ElementPtr
+ClientClassDictionary::getEvalStats() const {
+    ElementPtr result = Element::createList();
+    for (auto const& cclass : *list_) {
+        if (cclass->getMatchExpr()) {
+            result->add(cclass->getEvalStats());
+        }
+    }
+    return (result);
+}
+
 ClientClassDictionary&
 ClientClassDictionary::operator=(const ClientClassDictionary& rhs) {
     if (this != &rhs) {
@@ -13,9 +13,11 @@
 #include <dhcpsrv/cfg_option.h>
 #include <dhcpsrv/cfg_option_def.h>
 #include <util/triplet.h>
+#include <eval/compiled_expression.h>
 #include <eval/token.h>
 #include <exceptions/exceptions.h>
 
+#include <atomic>
 #include <string>
 #include <unordered_map>
 #include <list>
@@ -77,9 +79,56 @@ public:
 
     /// @brief Sets the class's match expression
     ///
+    /// The expression is compiled too.
+    ///
     /// @param match_expr the expression to assign the class
     void setMatchExpr(const ExpressionPtr& match_expr);
 
+    /// @brief Fetches the class's compiled match expression
+    ///
+    /// @return the compiled match expression or null when the class
+    /// has no match expression.
+    const CompiledExpressionPtr& getCompiledMatchExpr() const {
+        return (compiled_match_expr_);
+    }
+
+    /// @brief Evaluates the class's match expression on a packet.
+    ///
+    /// The compiled match expression is evaluated only when the packet
+    /// carries the options the expression requires (see
+    /// @ref CompiledExpression::canMatch), otherwise the packet does not
+    /// match. The evaluation counters and time are updated only when the
+    /// collection of the evaluation statistics is enabled.
+    ///
+    /// @param pkt the packet.
+    /// @return true if the packet matches, false if it does not or if the
+    /// class has no match expression.
+    /// @throw EvalTypeError or EvalBadStack on evaluation error.
+    bool evaluateMatchExpr(Pkt& pkt);
+
+    /// @brief Returns the match expression evaluation statistics.
+    ///
+    /// @return a map with the class name, the numbers of evaluations,
+    /// matches, skipped evaluations (required option missing) and errors,
+    /// and the total evaluation time in microseconds.
+    isc::data::ElementPtr getEvalStats() const;
+
+    /// @brief Enables or disables the collection of the match expression
+    /// evaluation statistics of all classes.
+    ///
+    /// The collection is disabled by default: it updates counters shared
+    /// by all packet processing threads and reads the clock twice for each
+    /// evaluation of each class.
+    ///
+    /// @param enabled true to enable the collection, false to disable it.
+    static void setEvalStatsEnabled(bool enabled);
+
+    /// @brief Checks if the collection of the match expression evaluation
+    /// statistics is enabled.
+    ///
+    /// @return true if the collection is enabled, false otherwise.
+    static bool getEvalStatsEnabled();
+
     /// @brief Fetches the class's original match expression
     std::string getTest() const;
 
@@ -235,6 +284,27 @@ private:
     /// this class.
     ExpressionPtr match_expr_;
 
+    /// @brief The compiled match expression used for evaluation.
+    CompiledExpressionPtr compiled_match_expr_;
+
+    /// @brief Number of match expression evaluations.
+    std::atomic<uint64_t> evaluations_;
+
+    /// @brief Number of evaluations which matched.
+    std::atomic<uint64_t> matches_;
+
+    /// @brief Number of evaluations skipped by the prefilter.
+    std::atomic<uint64_t> skipped_;
+
+    /// @brief Number of evaluations which raised an error.
+    std::atomic<uint64_t> errors_;
+
+    /// @brief Total evaluation time in nanoseconds.
+    std::atomic<uint64_t> evaluation_time_;
+
+    /// @brief Enables the collection of the evaluation statistics.
+    static std::atomic<bool> eval_stats_enabled_;
+
     /// @brief The original expression which determines membership in
     /// this class.
     std::string test_;
@@ -438,6 +508,12 @@ public:
     /// @return a pointer to unparsed configuration
     virtual isc::data::ElementPtr toElement() const;
 
+    /// @brief Returns the match expression evaluation statistics.
+    ///
+    /// @return a list with the statistics of classes having a match
+    /// expression, see @ref ClientClassDef::getEvalStats.
+    isc::data::ElementPtr getEvalStats() const;
+
 private:
 
     /// @brief Map of the class definitions
@@ -20,7 +20,7 @@ namespace {
 ///
 /// @return A pointer to the const hosts reservation configuration.
 isc::dhcp::ConstCfgHostsPtr getCfgHosts() {
-    return (isc::dhcp::CfgMgr::instance().getCurrentCfg()->getCfgHosts());
+    return (isc::dhcp::CfgMgr::instance().getCurrentCfgSnapshot()->getCfgHosts());
 }
 
 } // end of anonymous namespace
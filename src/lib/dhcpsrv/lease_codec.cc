@@ -0,0 +1,514 @@
+// Copyright (C) 2022 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <cc/data.h>
+#include <dhcpsrv/lease_codec.h>
+#include <exceptions/exceptions.h>
+#include <util/encode/base64.h>
+
+#include <boost/algorithm/string.hpp>
+
+#include <algorithm>
+
+using namespace isc::asiolink;
+using namespace isc::data;
+using namespace isc::util::encode;
+
+namespace {
+
+/// @brief Lease family in the header of IPv4 leases.
+const uint8_t FAMILY_V4 = 4;
+
+/// @brief Lease family in the header of IPv6 leases.
+const uint8_t FAMILY_V6 = 6;
+
+/// @brief Flags of an encoded lease.
+const uint8_t FLAG_FQDN_FWD = 0x01;
+const uint8_t FLAG_FQDN_REV = 0x02;
+const uint8_t FLAG_HWADDR = 0x04;
+const uint8_t FLAG_CLIENT_ID = 0x08;
+const uint8_t FLAG_CONTEXT = 0x10;
+
+/// @brief Appends the encoded values to a buffer.
+class Writer {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// @param out Buffer receiving the encoded values.
+    explicit Writer(std::vector<uint8_t>& out) : out_(out) {
+    }
+
+    /// @brief Appends a byte.
+    ///
+    /// @param value Byte value.
+    void putByte(uint8_t value) {
+        out_.push_back(value);
+    }
+
+    /// @brief Appends an unsigned integer as a variable length quantity.
+    ///
+    /// @param value Integer value.
+    void putUint(uint64_t value) {
+        while (value >= 0x80) {
+            out_.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out_.push_back(static_cast<uint8_t>(value));
+    }
+
+    /// @brief Appends a signed integer.
+    ///
+    /// The sign is moved to the least significant bit so small negative
+    /// values are short too.
+    ///
+    /// @param value Integer value.
+    void putSint(int64_t value) {
+        putUint((static_cast<uint64_t>(value) << 1) ^
+                static_cast<uint64_t>(value >> 63));
+    }
+
+    /// @brief Appends raw data.
+    ///
+    /// @param data Pointer to the data.
+    /// @param len Length of the data.
+    void putRaw(const uint8_t* data, size_t len) {
+        out_.insert(out_.end(), data, data + len);
+    }
+
+    /// @brief Appends a byte string preceded by its length.
+    ///
+    /// @param data Byte string.
+    void putBytes(const std::vector<uint8_t>& data) {
+        putUint(data.size());
+        if (!data.empty()) {
+            putRaw(&data[0], data.size());
+        }
+    }
+
+    /// @brief Appends a string preceded by its length.
+    ///
+    /// @param data String.
+    void putString(const std::string& data) {
+        putUint(data.size());
+        putRaw(reinterpret_cast<const uint8_t*>(data.c_str()), data.size());
+    }
+
+private:
+
+    /// @brief Buffer receiving the encoded values.
+    std::vector<uint8_t>& out_;
+};
+
+/// @brief Reads the encoded values from a buffer.
+class Reader {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// @param data Encoded values.
+    explicit Reader(const std::vector<uint8_t>& data) : data_(data), pos_(0) {
+    }
+
+    /// @brief Checks if all the data has been read.
+    bool done() const {
+        return (pos_ == data_.size());
+    }
+
+    /// @brief Returns the number of bytes left.
+    size_t left() const {
+        return (data_.size() - pos_);
+    }
+
+    /// @brief Reads a byte.
+    uint8_t getByte() {
+        need(1);
+        return (data_[pos_++]);
+    }
+
+    /// @brief Reads an unsigned integer.
+    uint64_t getUint() {
+        uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            uint8_t b = getByte();
+            value |= static_cast<uint64_t>(b & 0x7f) << shift;
+            if (!(b & 0x80)) {
+                return (value);
+            }
+        }
+        isc_throw(isc::BadValue, "invalid integer in the encoded leases");
+    }
+
+    /// @brief Reads an unsigned integer which must fit into 32 bits.
+    uint32_t getUint32() {
+        uint64_t value = getUint();
+        if (value > 0xffffffff) {
+            isc_throw(isc::BadValue, "integer " << value
+                      << " out of range in the encoded leases");
+        }
+        return (static_cast<uint32_t>(value));
+    }
+
+    /// @brief Reads a signed integer.
+    int64_t getSint() {
+        uint64_t value = getUint();
+        return (static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1));
+    }
+
+    /// @brief Reads raw data.
+    ///
+    /// @param len Length of the data.
+    /// @return Pointer to the data.
+    const uint8_t* getRaw(size_t len) {
+        need(len);
+        const uint8_t* data = &data_[pos_];
+        pos_ += len;
+        return (data);
+    }
+
+    /// @brief Reads a byte string preceded by its length.
+    std::vector<uint8_t> getBytes() {
+        size_t len = getUint();
+        if (len == 0) {
+            return (std::vector<uint8_t>());
+        }
+        const uint8_t* data = getRaw(len);
+        return (std::vector<uint8_t>(data, data + len));
+    }
+
+    /// @brief Reads a string preceded by its length.
+    std::string getString() {
+        size_t len = getUint();
+        if (len == 0) {
+            return (std::string());
+        }
+        const uint8_t* data = getRaw(len);
+        return (std::string(reinterpret_cast<const char*>(data), len));
+    }
+
+private:
+
+    /// @brief Checks that enough data is left.
+    ///
+    /// @param len Length of the data to read.
+    /// @throw BadValue if the data is truncated.
+    void need(size_t len) const {
+        if (len > left()) {
+            isc_throw(isc::BadValue, "truncated encoded leases");
+        }
+    }
+
+    /// @brief Encoded values.
+    const std::vector<uint8_t>& data_;
+
+    /// @brief Read position.
+    size_t pos_;
+};
+
+/// @brief Encodes the header of a lease collection.
+///
+/// @param writer Writer of the encoded leases.
+/// @param family Lease family.
+/// @param count Number of leases.
+void
+encodeHeader(Writer& writer, uint8_t family, size_t count) {
+    writer.putByte(isc::dhcp::LeaseCodec::ENCODING_VERSION);
+    writer.putByte(family);
+    writer.putUint(count);
+}
+
+/// @brief Decodes the header of a lease collection.
+///
+/// @param reader Reader of the encoded leases.
+/// @param family Expected lease family.
+/// @return Number of leases.
+size_t
+decodeHeader(Reader& reader, uint8_t family) {
+    uint8_t version = reader.getByte();
+    if (version != isc::dhcp::LeaseCodec::ENCODING_VERSION) {
+        isc_throw(isc::BadValue, "unsupported version "
+                  << static_cast<unsigned>(version) << " of the encoded leases");
+    }
+    if (reader.getByte() != family) {
+        isc_throw(isc::BadValue, "the encoded leases are not IPv"
+                  << static_cast<unsigned>(family) << " leases");
+    }
+    return (reader.getUint());
+}
+
+/// @brief Encodes the properties common to IPv4 and IPv6 leases.
+///
+/// @param writer Writer of the encoded leases.
+/// @param lease Lease.
+/// @param flags Flags of the lease specific to its family.
+/// @param [in,out] cltt Client last transmission time of the previous
+/// lease, set to the one of this lease.
+void
+encodeCommon(Writer& writer, const isc::dhcp::Lease& lease, uint8_t flags,
+             int64_t& cltt) {
+    if (lease.fqdn_fwd_) {
+        flags |= FLAG_FQDN_FWD;
+    }
+    if (lease.fqdn_rev_) {
+        flags |= FLAG_FQDN_REV;
+    }
+    if (lease.hwaddr_) {
+        flags |= FLAG_HWADDR;
+    }
+    ConstElementPtr ctx = lease.getContext();
+    if (ctx) {
+        flags |= FLAG_CONTEXT;
+    }
+    writer.putByte(flags);
+    writer.putUint(lease.subnet_id_);
+    writer.putSint(static_cast<int64_t>(lease.cltt_) - cltt);
+    cltt = lease.cltt_;
+    writer.putUint(lease.valid_lft_);
+    writer.putUint(lease.state_);
+    writer.putString(lease.hostname_);
+    if (lease.hwaddr_) {
+        writer.putUint(lease.hwaddr_->htype_);
+        writer.putBytes(lease.hwaddr_->hwaddr_);
+    }
+    if (ctx) {
+        writer.putString(ctx->str());
+    }
+}
+
+/// @brief Decodes the properties common to IPv4 and IPv6 leases.
+///
+/// @param reader Reader of the encoded leases.
+/// @param [out] lease Lease.
+/// @param [in,out] cltt Client last transmission time of the previous
+/// lease, set to the one of this lease.
+/// @return Flags of the lease.
+uint8_t
+decodeCommon(Reader& reader, isc::dhcp::Lease& lease, int64_t& cltt) {
+    uint8_t flags = reader.getByte();
+    lease.fqdn_fwd_ = ((flags & FLAG_FQDN_FWD) != 0);
+    lease.fqdn_rev_ = ((flags & FLAG_FQDN_REV) != 0);
+
+    lease.subnet_id_ = reader.getUint32();
+    if (lease.subnet_id_ == 0) {
+        isc_throw(isc::BadValue, "subnet-id 0 is not a positive integer");
+    }
+
+    cltt += reader.getSint();
+    if (cltt <= 0) {
+        isc_throw(isc::BadValue, "cltt " << cltt << " is not a"
+                  " positive integer in the encoded lease");
+    }
+    lease.cltt_ = static_cast<time_t>(cltt);
+
+    lease.valid_lft_ = reader.getUint32();
+
+    lease.state_ = reader.getUint32();
+    if (lease.state_ > isc::dhcp::Lease::STATE_EXPIRED_RECLAIMED) {
+        isc_throw(isc::BadValue, "state " << lease.state_
+                  << " must be in range [0.."
+                  << isc::dhcp::Lease::STATE_EXPIRED_RECLAIMED << "]");
+    }
+
+    lease.hostname_ = reader.getString();
+    boost::algorithm::to_lower(lease.hostname_);
+
+    if (flags & FLAG_HWADDR) {
+        uint16_t htype = static_cast<uint16_t>(reader.getUint32());
+        std::vector<uint8_t> hwaddr = reader.getBytes();
+        if (hwaddr.size() > isc::dhcp::HWAddr::MAX_HWADDR_LEN) {
+            isc_throw(isc::BadValue, "hardware address of " << hwaddr.size()
+                      << " bytes is too long in the encoded lease");
+        }
+        lease.hwaddr_.reset(new isc::dhcp::HWAddr(hwaddr, htype));
+    }
+
+    if (flags & FLAG_CONTEXT) {
+        ConstElementPtr ctx;
+        try {
+            ctx = Element::fromJSON(reader.getString());
+        } catch (const std::exception& ex) {
+            isc_throw(isc::BadValue, "invalid user context in the encoded"
+                      " lease: " << ex.what());
+        }
+        if (!ctx || (ctx->getType() != Element::map)) {
+            isc_throw(isc::BadValue, "user context is not a map");
+        }
+        lease.setContext(ctx);
+    }
+
+    lease.updateCurrentExpirationTime();
+    return (flags);
+}
+
+/// @brief Decodes a base64 text.
+///
+/// @param text Base64 text.
+/// @return Decoded data.
+/// @throw BadValue if the text is not valid base64.
+std::vector<uint8_t>
+decodeText(const std::string& text) {
+    std::vector<uint8_t> data;
+    try {
+        decodeBase64(text, data);
+    } catch (const std::exception& ex) {
+        isc_throw(isc::BadValue, "invalid encoded leases: " << ex.what());
+    }
+    return (data);
+}
+
+} // end of anonymous namespace
+
+namespace isc {
+namespace dhcp {
+
+const uint8_t LeaseCodec::ENCODING_VERSION = 1;
+
+const std::string LeaseCodec::NAME = "binary";
+
+std::vector<uint8_t>
+LeaseCodec::encode(const Lease4Collection& leases) {
+    std::vector<uint8_t> data;
+    // Most of the leases take about 30 bytes.
+    data.reserve(16 + 32 * leases.size());
+    Writer writer(data);
+    encodeHeader(writer, FAMILY_V4, leases.size());
+
+    int64_t addr = 0;
+    int64_t cltt = 0;
+    for (auto const& lease : leases) {
+        int64_t lease_addr = lease->addr_.toUint32();
+        writer.putSint(lease_addr - addr);
+        addr = lease_addr;
+        encodeCommon(writer, *lease, (lease->client_id_ ? FLAG_CLIENT_ID : 0),
+                     cltt);
+        if (lease->client_id_) {
+            writer.putBytes(lease->client_id_->getClientId());
+        }
+    }
+    return (data);
+}
+
+std::vector<uint8_t>
+LeaseCodec::encode(const Lease6Collection& leases) {
+    std::vector<uint8_t> data;
+    data.reserve(16 + 64 * leases.size());
+    Writer writer(data);
+    encodeHeader(writer, FAMILY_V6, leases.size());
+
+    int64_t cltt = 0;
+    for (auto const& lease : leases) {
+        writer.putByte(static_cast<uint8_t>(lease->type_));
+        writer.putRaw(&lease->addr_.toBytes()[0], V6ADDRESS_LEN);
+        if (lease->type_ == Lease::TYPE_PD) {
+            writer.putByte(lease->prefixlen_);
+        }
+        writer.putUint(lease->iaid_);
+        writer.putUint(lease->preferred_lft_);
+        writer.putBytes(lease->duid_ ? lease->duid_->getDuid() : std::vector<uint8_t>());
+        encodeCommon(writer, *lease, 0, cltt);
+    }
+    return (data);
+}
+
+Lease4Collection
+LeaseCodec::decode4(const std::vector<uint8_t>& data) {
+    Reader reader(data);
+    size_t count = decodeHeader(reader, FAMILY_V4);
+
+    Lease4Collection leases;
+    // Do not trust the count for the allocation.
+    leases.reserve(std::min(count, reader.left()));
+    int64_t addr = 0;
+    int64_t cltt = 0;
+    for (size_t i = 0; i < count; ++i) {
+        Lease4Ptr lease(new Lease4());
+        addr += reader.getSint();
+        if ((addr < 0) || (addr > 0xffffffff)) {
+            isc_throw(BadValue, "invalid IPv4 address in the encoded lease");
+        }
+        lease->addr_ = IOAddress(static_cast<uint32_t>(addr));
+
+        uint8_t flags = decodeCommon(reader, *lease, cltt);
+        if (!lease->hwaddr_) {
+            isc_throw(BadValue, "hw-address not present in the encoded lease "
+                      << lease->addr_);
+        }
+        if (flags & FLAG_CLIENT_ID) {
+            lease->client_id_.reset(new ClientId(reader.getBytes()));
+        }
+        leases.push_back(lease);
+    }
+
+    if (!reader.done()) {
+        isc_throw(BadValue, "unexpected data after the encoded leases");
+    }
+    return (leases);
+}
+
+Lease6Collection
+LeaseCodec::decode6(const std::vector<uint8_t>& data) {
+    Reader reader(data);
+    size_t count = decodeHeader(reader, FAMILY_V6);
+
+    Lease6Collection leases;
+    leases.reserve(std::min(count, reader.left()));
+    int64_t cltt = 0;
+    for (size_t i = 0; i < count; ++i) {
+        Lease6Ptr lease(new Lease6());
+        uint8_t type = reader.getByte();
+        if (type > Lease::TYPE_PD) {
+            isc_throw(BadValue, "invalid lease type "
+                      << static_cast<unsigned>(type) << " in the encoded lease");
+        }
+        lease->type_ = static_cast<Lease::Type>(type);
+        lease->addr_ = IOAddress::fromBytes(AF_INET6, reader.getRaw(V6ADDRESS_LEN));
+        if (lease->type_ == Lease::TYPE_PD) {
+            lease->prefixlen_ = reader.getByte();
+            if ((lease->prefixlen_ < 1) || (lease->prefixlen_ > 128)) {
+                isc_throw(BadValue, "prefix-len "
+                          << static_cast<unsigned>(lease->prefixlen_)
+                          << " must be in range of [1..128]");
+            }
+        } else {
+            lease->prefixlen_ = 128;
+        }
+        lease->iaid_ = reader.getUint32();
+        lease->preferred_lft_ = reader.getUint32();
+        lease->duid_.reset(new DUID(reader.getBytes()));
+        decodeCommon(reader, *lease, cltt);
+        leases.push_back(lease);
+    }
+
+    if (!reader.done()) {
+        isc_throw(BadValue, "unexpected data after the encoded leases");
+    }
+    return (leases);
+}
+
+std::string
+LeaseCodec::encodeText(const Lease4Collection& leases) {
+    return (encodeBase64(encode(leases)));
+}
+
+std::string
+LeaseCodec::encodeText(const Lease6Collection& leases) {
+    return (encodeBase64(encode(leases)));
+}
+
+Lease4Collection
+LeaseCodec::decodeText4(const std::string& text) {
+    return (decode4(decodeText(text)));
+}
+
+Lease6Collection
+LeaseCodec::decodeText6(const std::string& text) {
+    return (decode6(decodeText(text)));
+}
+
+} // end of namespace isc::dhcp
+} // end of namespace isc
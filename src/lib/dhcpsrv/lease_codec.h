@@ -0,0 +1,104 @@
+// Copyright (C) 2022 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef LEASE_CODEC_H
+#define LEASE_CODEC_H
+
+#include <dhcpsrv/lease.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Compact binary encoding of lease collections.
+///
+/// The JSON representation of a lease (see @c Lease4::toElement) is a map
+/// of about 250 bytes which must be parsed and converted back into a lease
+/// by the receiver. When many leases are exchanged, e.g. between the High
+/// Availability peers synchronizing their lease databases, most of the
+/// time is spent in the conversions from and to JSON. This class encodes
+/// a collection of leases into a compact binary format carried as base64
+/// text in the commands, e.g. in the "leases-binary" argument of the
+/// lease4-get-page response.
+///
+/// The encoded collection starts with a header holding the format version,
+/// the lease family and the number of leases. The integers are encoded as
+/// variable length quantities (7 bits per byte, least significant group
+/// first). The IPv4 addresses and the client last transmission times are
+/// encoded as differences with the previous lease, which makes them one or
+/// two bytes long for the sorted pages of leases.
+///
+/// The decoded leases are checked as by @c Lease4::fromElement and
+/// @c Lease6::fromElement.
+class LeaseCodec {
+public:
+
+    /// @brief Version of the encoding.
+    static const uint8_t ENCODING_VERSION;
+
+    /// @brief Name of the encoding in the commands.
+    static const std::string NAME;
+
+    /// @brief Encodes IPv4 leases.
+    ///
+    /// @param leases Collection of leases.
+    /// @return Encoded leases.
+    static std::vector<uint8_t> encode(const Lease4Collection& leases);
+
+    /// @brief Encodes IPv6 leases.
+    ///
+    /// @param leases Collection of leases.
+    /// @return Encoded leases.
+    static std::vector<uint8_t> encode(const Lease6Collection& leases);
+
+    /// @brief Decodes IPv4 leases.
+    ///
+    /// @param data Encoded leases.
+    /// @return Collection of leases.
+    /// @throw BadValue if the data is not a valid encoding of IPv4 leases.
+    static Lease4Collection decode4(const std::vector<uint8_t>& data);
+
+    /// @brief Decodes IPv6 leases.
+    ///
+    /// @param data Encoded leases.
+    /// @return Collection of leases.
+    /// @throw BadValue if the data is not a valid encoding of IPv6 leases.
+    static Lease6Collection decode6(const std::vector<uint8_t>& data);
+
+    /// @brief Encodes IPv4 leases into base64 text.
+    ///
+    /// @param leases Collection of leases.
+    /// @return Encoded leases as base64 text.
+    static std::string encodeText(const Lease4Collection& leases);
+
+    /// @brief Encodes IPv6 leases into base64 text.
+    ///
+    /// @param leases Collection of leases.
+    /// @return Encoded leases as base64 text.
+    static std::string encodeText(const Lease6Collection& leases);
+
+    /// @brief Decodes IPv4 leases from base64 text.
+    ///
+    /// @param text Encoded leases as base64 text.
+    /// @return Collection of leases.
+    /// @throw BadValue if the text is not a valid encoding of IPv4 leases.
+    static Lease4Collection decodeText4(const std::string& text);
+
+    /// @brief Decodes IPv6 leases from base64 text.
+    ///
+    /// @param text Encoded leases as base64 text.
+    /// @return Collection of leases.
+    /// @throw BadValue if the text is not a valid encoding of IPv6 leases.
+    static Lease6Collection decodeText6(const std::string& text);
+};
+
+} // end of namespace isc::dhcp
+} // end of namespace isc
+
+#endif // LEASE_CODEC_H
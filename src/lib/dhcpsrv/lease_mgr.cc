@@ -1,4 +1,4 @@
-// Copyright (C) 2012-2020 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2012-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -7,6 +7,7 @@
 #include <config.h>
 
 #include <dhcpsrv/cfgmgr.h>
+#include <dhcpsrv/dhcpsrv_exceptions.h>
 #include <dhcpsrv/dhcpsrv_log.h>
 #include <dhcpsrv/lease_mgr.h>
 #include <exceptions/exceptions.h>
@@ -16,6 +17,7 @@
 #include <boost/algorithm/string.hpp>
 
 #include <algorithm>
+#include <functional>
 #include <iostream>
 #include <iterator>
 #include <map>
@@ -190,6 +192,101 @@ LeaseStatsQuery::LeaseStatsQuery(const SubnetID& first_subnet_id,
     }
 }
 
+namespace {
+
+/// @brief Writes a batch of leases one by one.
+///
+/// @tparam LeaseCollectionType One of the @c Lease4Collection or
+/// @c Lease6Collection.
+/// @param leases The leases to be written.
+/// @param write_fun The function writing a lease, returning false when
+/// the lease is rejected.
+/// @return The rejected leases.
+/// @throw LeaseBatchError when the write of a lease fails.
+template<typename LeaseCollectionType>
+LeaseCollectionType
+writeLeasesOneByOne(const LeaseCollectionType& leases,
+                    const std::function<bool (const typename
+                                              LeaseCollectionType::value_type&)>&
+                    write_fun) {
+    LeaseCollectionType rejected;
+    size_t processed = 0;
+    try {
+        for (auto const& lease : leases) {
+            if (!write_fun(lease)) {
+                rejected.push_back(lease);
+            }
+            ++processed;
+        }
+    } catch (const std::exception& ex) {
+        // The leases already written can't be rolled back so the caller
+        // is told which ones were.
+        isc_throw_2(LeaseBatchError, ex.what(), processed,
+                    std::vector<LeasePtr>(rejected.begin(), rejected.end()));
+    }
+    return (rejected);
+}
+
+} // end of anonymous namespace
+
+Lease4Collection
+LeaseMgr::addLeases(const Lease4Collection& leases) {
+    return (writeLeasesOneByOne<Lease4Collection>(leases,
+        [this](const Lease4Ptr& lease) {
+            return (addLease(lease));
+        }));
+}
+
+Lease6Collection
+LeaseMgr::addLeases(const Lease6Collection& leases) {
+    return (writeLeasesOneByOne<Lease6Collection>(leases,
+        [this](const Lease6Ptr& lease) {
+            return (addLease(lease));
+        }));
+}
+
+Lease4Collection
+LeaseMgr::updateLeases4(const Lease4Collection& leases) {
+    return (writeLeasesOneByOne<Lease4Collection>(leases,
+        [this](const Lease4Ptr& lease) {
+            try {
+                updateLease4(lease);
+            } catch (const NoSuchLease&) {
+                return (false);
+            }
+            return (true);
+        }));
+}
+
+Lease6Collection
+LeaseMgr::updateLeases6(const Lease6Collection& leases) {
+    return (writeLeasesOneByOne<Lease6Collection>(leases,
+        [this](const Lease6Ptr& lease) {
+            try {
+                updateLease6(lease);
+            } catch (const NoSuchLease&) {
+                return (false);
+            }
+            return (true);
+        }));
+}
+
+Lease4Collection
+LeaseMgr::deleteLeases(const Lease4Collection& leases) {
+    return (writeLeasesOneByOne<Lease4Collection>(leases,
+        [this](const Lease4Ptr& lease) {
+            return (deleteLease(lease));
+        }));
+}
+
+Lease6Collection
+LeaseMgr::deleteLeases(const Lease6Collection& leases) {
+    return (writeLeasesOneByOne<Lease6Collection>(leases,
+        [this](const Lease6Ptr& lease) {
+            return (deleteLease(lease));
+        }));
+}
+
 LeaseStatsQueryPtr
 LeaseMgr::startLeaseStatsQuery4() {
     return(LeaseStatsQueryPtr());
@@ -1,4 +1,4 @@
-// Copyright (C) 2012-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2012-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -209,6 +209,48 @@ typedef boost::shared_ptr<LeaseStatsQuery> LeaseStatsQueryPtr;
 /// @brief Defines a pointer to a LeaseStatsRow.
 typedef boost::shared_ptr<LeaseStatsRow> LeaseStatsRowPtr;
 
+/// @brief Exception thrown when a batch of lease writes fails part way.
+///
+/// The leases of a batch are written in order: the leases preceding the
+/// failed one were processed, i.e. they were written unless they were
+/// rejected (already existing for an add, not found for an update or a
+/// delete), and the failed lease and the following ones were not written.
+class LeaseBatchError : public Exception {
+public:
+    /// @brief Constructor.
+    ///
+    /// @param file name of the file where the exception was thrown.
+    /// @param line line where the exception was thrown.
+    /// @param what description of the error.
+    /// @param processed number of leases at the beginning of the batch
+    /// which were processed.
+    /// @param rejected processed leases which were not written.
+    LeaseBatchError(const char* file, size_t line, const char* what,
+                    const size_t processed,
+                    const std::vector<LeasePtr>& rejected)
+        : isc::Exception(file, line, what), processed_(processed),
+          rejected_(rejected) {
+    }
+
+    /// @brief Returns the number of leases at the beginning of the batch
+    /// which were processed.
+    size_t getProcessed() const {
+        return (processed_);
+    }
+
+    /// @brief Returns the processed leases which were not written.
+    const std::vector<LeasePtr>& getRejected() const {
+        return (rejected_);
+    }
+
+private:
+    /// @brief Number of processed leases.
+    size_t processed_;
+
+    /// @brief Processed leases which were not written.
+    std::vector<LeasePtr> rejected_;
+};
+
 /// @brief Abstract Lease Manager
 ///
 /// This is an abstract API for lease database backends. It provides unified
@@ -549,6 +591,103 @@ public:
     ///        failed.
     virtual bool deleteLease(const Lease6Ptr& lease) = 0;
 
+    /// @brief Adds a batch of IPv4 leases.
+    ///
+    /// The SQL backends add the whole batch in a single transaction on
+    /// one connection. The default implementation adds the leases one by
+    /// one with @c addLease.
+    ///
+    /// @param leases The leases to be added.
+    ///
+    /// @return The leases which were not added because they already exist.
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed. The SQL backends have then not added any lease.
+    /// @throw LeaseBatchError An operation failed part way through the
+    ///        batch in the default implementation: the exception tells
+    ///        which leases were written.
+    virtual Lease4Collection addLeases(const Lease4Collection& leases);
+
+    /// @brief Adds a batch of IPv6 leases.
+    ///
+    /// See the IPv4 variant.
+    ///
+    /// @param leases The leases to be added.
+    ///
+    /// @return The leases which were not added because they already exist.
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed.
+    /// @throw LeaseBatchError An operation failed part way through the
+    ///        batch in the default implementation.
+    virtual Lease6Collection addLeases(const Lease6Collection& leases);
+
+    /// @brief Updates a batch of IPv4 leases.
+    ///
+    /// The SQL backends update the whole batch in a single transaction on
+    /// one connection. The default implementation updates the leases one
+    /// by one with @c updateLease4.
+    ///
+    /// @param leases The leases to be updated.
+    ///
+    /// @return The leases which were not updated because they do not exist
+    /// (or were changed in the database).
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed. The SQL backends have then not updated any lease.
+    /// @throw LeaseBatchError An operation failed part way through the
+    ///        batch in the default implementation: the exception tells
+    ///        which leases were written.
+    virtual Lease4Collection updateLeases4(const Lease4Collection& leases);
+
+    /// @brief Updates a batch of IPv6 leases.
+    ///
+    /// See the IPv4 variant.
+    ///
+    /// @param leases The leases to be updated.
+    ///
+    /// @return The leases which were not updated because they do not exist
+    /// (or were changed in the database).
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed.
+    /// @throw LeaseBatchError An operation failed part way through the
+    ///        batch in the default implementation.
+    virtual Lease6Collection updateLeases6(const Lease6Collection& leases);
+
+    /// @brief Deletes a batch of IPv4 leases.
+    ///
+    /// The SQL backends delete the whole batch in a single transaction on
+    /// one connection. The default implementation deletes the leases one
+    /// by one with @c deleteLease.
+    ///
+    /// @param leases The leases to be deleted.
+    ///
+    /// @return The leases which were not deleted because they do not exist
+    /// (or were changed in the database).
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed. The SQL backends have then not deleted any lease.
+    /// @throw LeaseBatchError An operation failed part way through the
+    ///        batch in the default implementation: the exception tells
+    ///        which leases were written.
+    virtual Lease4Collection deleteLeases(const Lease4Collection& leases);
+
+    /// @brief Deletes a batch of IPv6 leases.
+    ///
+    /// See the IPv4 variant.
+    ///
+    /// @param leases The leases to be deleted.
+    ///
+    /// @return The leases which were not deleted because they do not exist
+    /// (or were changed in the database).
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed.
+    /// @throw LeaseBatchError An operation failed part way through the
+    ///        batch in the default implementation.
+    virtual Lease6Collection deleteLeases(const Lease6Collection& leases);
+
     /// @brief Deletes all expired and reclaimed DHCPv4 leases.
     ///
     /// @param secs Number of seconds since expiration of leases before
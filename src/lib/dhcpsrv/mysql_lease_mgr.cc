@@ -26,6 +26,7 @@
 #include <iostream>
 #include <iomanip>
 #include <limits>
+#include <set>
 #include <sstream>
 #include <string>
 #include <time.h>
@@ -1956,6 +1957,16 @@ MySqlLeaseMgr::addLeaseCommon(MySqlLeaseContextPtr& ctx,
     return (true);
 }
 
+bool
+MySqlLeaseMgr::addLeaseInternal(MySqlLeaseContextPtr& ctx,
+                                const Lease4Ptr& lease) {
+    // Create the MYSQL_BIND array for the lease
+    std::vector<MYSQL_BIND> bind = ctx->exchange4_->createBindForSend(lease);
+
+    // ... and drop to common code.
+    return (addLeaseCommon(ctx, INSERT_LEASE4, bind));
+}
+
 bool
 MySqlLeaseMgr::addLease(const Lease4Ptr& lease) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_ADD_ADDR4)
@@ -1965,11 +1976,7 @@ MySqlLeaseMgr::addLease(const Lease4Ptr& lease) {
     MySqlLeaseContextAlloc get_context(*this);
     MySqlLeaseContextPtr ctx = get_context.ctx_;
 
-    // Create the MYSQL_BIND array for the lease
-    std::vector<MYSQL_BIND> bind = ctx->exchange4_->createBindForSend(lease);
-
-    // ... and drop to common code.
-    auto result = addLeaseCommon(ctx, INSERT_LEASE4, bind);
+    auto result = addLeaseInternal(ctx, lease);
 
     // Update lease current expiration time (allows update between the creation
     // of the Lease up to the point of insertion in the database).
@@ -1978,6 +1985,16 @@ MySqlLeaseMgr::addLease(const Lease4Ptr& lease) {
     return (result);
 }
 
+bool
+MySqlLeaseMgr::addLeaseInternal(MySqlLeaseContextPtr& ctx,
+                                const Lease6Ptr& lease) {
+    // Create the MYSQL_BIND array for the lease
+    std::vector<MYSQL_BIND> bind = ctx->exchange6_->createBindForSend(lease);
+
+    // ... and drop to common code.
+    return (addLeaseCommon(ctx, INSERT_LEASE6, bind));
+}
+
 bool
 MySqlLeaseMgr::addLease(const Lease6Ptr& lease) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_ADD_ADDR6)
@@ -1988,11 +2005,7 @@ MySqlLeaseMgr::addLease(const Lease6Ptr& lease) {
     MySqlLeaseContextAlloc get_context(*this);
     MySqlLeaseContextPtr ctx = get_context.ctx_;
 
-    // Create the MYSQL_BIND array for the lease
-    std::vector<MYSQL_BIND> bind = ctx->exchange6_->createBindForSend(lease);
-
-    // ... and drop to common code.
-    auto result = addLeaseCommon(ctx, INSERT_LEASE6, bind);
+    auto result = addLeaseInternal(ctx, lease);
 
     // Update lease current expiration time (allows update between the creation
     // of the Lease up to the point of insertion in the database).
@@ -2825,16 +2838,10 @@ MySqlLeaseMgr::updateLeaseCommon(MySqlLeaseContextPtr& ctx,
 }
 
 void
-MySqlLeaseMgr::updateLease4(const Lease4Ptr& lease) {
+MySqlLeaseMgr::updateLeaseInternal(MySqlLeaseContextPtr& ctx,
+                                   const Lease4Ptr& lease) {
     const StatementIndex stindex = UPDATE_LEASE4;
 
-    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_UPDATE_ADDR4)
-        .arg(lease->addr_.toText());
-
-    // Get a context
-    MySqlLeaseContextAlloc get_context(*this);
-    MySqlLeaseContextPtr ctx = get_context.ctx_;
-
     // Create the MYSQL_BIND array for the data being updated
     std::vector<MYSQL_BIND> bind = ctx->exchange4_->createBindForSend(lease);
 
@@ -2866,23 +2873,28 @@ MySqlLeaseMgr::updateLease4(const Lease4Ptr& lease) {
 
     // Drop to common update code
     updateLeaseCommon(ctx, stindex, &bind[0], lease);
-
-    // Update lease current expiration time.
-    lease->updateCurrentExpirationTime();
 }
 
 void
-MySqlLeaseMgr::updateLease6(const Lease6Ptr& lease) {
-    const StatementIndex stindex = UPDATE_LEASE6;
-
-    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_UPDATE_ADDR6)
-        .arg(lease->addr_.toText())
-        .arg(lease->type_);
+MySqlLeaseMgr::updateLease4(const Lease4Ptr& lease) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_UPDATE_ADDR4)
+        .arg(lease->addr_.toText());
 
     // Get a context
     MySqlLeaseContextAlloc get_context(*this);
     MySqlLeaseContextPtr ctx = get_context.ctx_;
 
+    updateLeaseInternal(ctx, lease);
+
+    // Update lease current expiration time.
+    lease->updateCurrentExpirationTime();
+}
+
+void
+MySqlLeaseMgr::updateLeaseInternal(MySqlLeaseContextPtr& ctx,
+                                   const Lease6Ptr& lease) {
+    const StatementIndex stindex = UPDATE_LEASE6;
+
     // Create the MYSQL_BIND array for the data being updated
     std::vector<MYSQL_BIND> bind = ctx->exchange6_->createBindForSend(lease);
 
@@ -2919,6 +2931,19 @@ MySqlLeaseMgr::updateLease6(const Lease6Ptr& lease) {
 
     // Drop to common update code
     updateLeaseCommon(ctx, stindex, &bind[0], lease);
+}
+
+void
+MySqlLeaseMgr::updateLease6(const Lease6Ptr& lease) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_UPDATE_ADDR6)
+        .arg(lease->addr_.toText())
+        .arg(lease->type_);
+
+    // Get a context
+    MySqlLeaseContextAlloc get_context(*this);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
+    updateLeaseInternal(ctx, lease);
 
     // Update lease current expiration time.
     lease->updateCurrentExpirationTime();
@@ -2930,13 +2955,9 @@ MySqlLeaseMgr::updateLease6(const Lease6Ptr& lease) {
 // handles the common processing.
 
 uint64_t
-MySqlLeaseMgr::deleteLeaseCommon(StatementIndex stindex,
+MySqlLeaseMgr::deleteLeaseCommon(MySqlLeaseContextPtr& ctx,
+                                 StatementIndex stindex,
                                  MYSQL_BIND* bind) {
-
-    // Get a context
-    MySqlLeaseContextAlloc get_context(*this);
-    MySqlLeaseContextPtr ctx = get_context.ctx_;
-
     // Bind the input parameters to the statement
     int status = mysql_stmt_bind_param(ctx->conn_.statements_[stindex], bind);
     checkError(ctx, status, stindex, "unable to bind WHERE clause parameter");
@@ -2951,10 +2972,9 @@ MySqlLeaseMgr::deleteLeaseCommon(StatementIndex stindex,
 }
 
 bool
-MySqlLeaseMgr::deleteLease(const Lease4Ptr& lease) {
+MySqlLeaseMgr::deleteLeaseInternal(MySqlLeaseContextPtr& ctx,
+                                   const Lease4Ptr& lease) {
     const IOAddress& addr = lease->addr_;
-    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_DELETE_ADDR)
-        .arg(addr.toText());
 
     // Set up the WHERE clause value
     MYSQL_BIND inbind[2];
@@ -2979,7 +2999,7 @@ MySqlLeaseMgr::deleteLease(const Lease4Ptr& lease) {
     inbind[1].buffer = reinterpret_cast<char*>(&expire);
     inbind[1].buffer_length = sizeof(expire);
 
-    auto affected_rows = deleteLeaseCommon(DELETE_LEASE4, inbind);
+    auto affected_rows = deleteLeaseCommon(ctx, DELETE_LEASE4, inbind);
 
     // Check success case first as it is the most likely outcome.
     if (affected_rows == 1) {
@@ -2998,11 +3018,21 @@ MySqlLeaseMgr::deleteLease(const Lease4Ptr& lease) {
 }
 
 bool
-MySqlLeaseMgr::deleteLease(const Lease6Ptr& lease) {
+MySqlLeaseMgr::deleteLease(const Lease4Ptr& lease) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_DELETE_ADDR)
+        .arg(lease->addr_.toText());
+
+    // Get a context
+    MySqlLeaseContextAlloc get_context(*this);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
+    return (deleteLeaseInternal(ctx, lease));
+}
+
+bool
+MySqlLeaseMgr::deleteLeaseInternal(MySqlLeaseContextPtr& ctx,
+                                   const Lease6Ptr& lease) {
     const IOAddress& addr = lease->addr_;
-    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
-              DHCPSRV_MYSQL_DELETE_ADDR)
-        .arg(addr.toText());
 
     // Set up the WHERE clause value
     MYSQL_BIND inbind[2];
@@ -3031,7 +3061,7 @@ MySqlLeaseMgr::deleteLease(const Lease6Ptr& lease) {
     inbind[1].buffer = reinterpret_cast<char*>(&expire);
     inbind[1].buffer_length = sizeof(expire);
 
-    auto affected_rows = deleteLeaseCommon(DELETE_LEASE6, inbind);
+    auto affected_rows = deleteLeaseCommon(ctx, DELETE_LEASE6, inbind);
 
     // Check success case first as it is the most likely outcome.
     if (affected_rows == 1) {
@@ -3049,6 +3079,169 @@ MySqlLeaseMgr::deleteLease(const Lease6Ptr& lease) {
               "that had the address " << lease->addr_.toText());
 }
 
+bool
+MySqlLeaseMgr::deleteLease(const Lease6Ptr& lease) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+              DHCPSRV_MYSQL_DELETE_ADDR)
+        .arg(lease->addr_.toText());
+
+    // Get a context
+    MySqlLeaseContextAlloc get_context(*this);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
+    return (deleteLeaseInternal(ctx, lease));
+}
+
+// Batch methods. The leases are written by the single lease code in one
+// transaction using the same context, i.e. the same connection.
+
+template <typename LeaseCollection, typename WriteFunction>
+LeaseCollection
+MySqlLeaseMgr::writeLeasesCommon(const LeaseCollection& leases,
+                                 WriteFunction write) {
+    LeaseCollection not_written;
+    if (leases.empty()) {
+        return (not_written);
+    }
+
+    // Get a context
+    MySqlLeaseContextAlloc get_context(*this);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
+    ctx->conn_.startTransaction();
+    try {
+        for (auto const& lease : leases) {
+            if (!write(ctx, lease)) {
+                not_written.push_back(lease);
+            }
+        }
+        ctx->conn_.commit();
+
+    } catch (...) {
+        // The connection can be unusable: the rollback errors are ignored
+        // in favor of the original error.
+        try {
+            ctx->conn_.rollback();
+        } catch (...) {
+        }
+        throw;
+    }
+
+    return (not_written);
+}
+
+Lease4Collection
+MySqlLeaseMgr::addLeases(const Lease4Collection& leases) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_ADD_LEASES)
+        .arg(leases.size());
+
+    auto existing = writeLeasesCommon(leases,
+        [this](MySqlLeaseContextPtr& ctx, const Lease4Ptr& lease) {
+            return (addLeaseInternal(ctx, lease));
+        });
+
+    // Update leases current expiration time.
+    for (auto const& lease : leases) {
+        lease->updateCurrentExpirationTime();
+    }
+
+    return (existing);
+}
+
+Lease6Collection
+MySqlLeaseMgr::addLeases(const Lease6Collection& leases) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_ADD_LEASES)
+        .arg(leases.size());
+
+    auto existing = writeLeasesCommon(leases,
+        [this](MySqlLeaseContextPtr& ctx, const Lease6Ptr& lease) {
+            return (addLeaseInternal(ctx, lease));
+        });
+
+    // Update leases current expiration time.
+    for (auto const& lease : leases) {
+        lease->updateCurrentExpirationTime();
+    }
+
+    return (existing);
+}
+
+Lease4Collection
+MySqlLeaseMgr::updateLeases4(const Lease4Collection& leases) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_UPDATE_LEASES)
+        .arg(leases.size());
+
+    std::set<Lease4Ptr> missing;
+    auto missing_list = writeLeasesCommon(leases,
+        [this, &missing](MySqlLeaseContextPtr& ctx, const Lease4Ptr& lease) {
+            try {
+                updateLeaseInternal(ctx, lease);
+            } catch (const NoSuchLease&) {
+                missing.insert(lease);
+                return (false);
+            }
+            return (true);
+        });
+
+    // Update current expiration time of updated leases.
+    for (auto const& lease : leases) {
+        if (!missing.count(lease)) {
+            lease->updateCurrentExpirationTime();
+        }
+    }
+
+    return (missing_list);
+}
+
+Lease6Collection
+MySqlLeaseMgr::updateLeases6(const Lease6Collection& leases) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_UPDATE_LEASES)
+        .arg(leases.size());
+
+    std::set<Lease6Ptr> missing;
+    auto missing_list = writeLeasesCommon(leases,
+        [this, &missing](MySqlLeaseContextPtr& ctx, const Lease6Ptr& lease) {
+            try {
+                updateLeaseInternal(ctx, lease);
+            } catch (const NoSuchLease&) {
+                missing.insert(lease);
+                return (false);
+            }
+            return (true);
+        });
+
+    // Update current expiration time of updated leases.
+    for (auto const& lease : leases) {
+        if (!missing.count(lease)) {
+            lease->updateCurrentExpirationTime();
+        }
+    }
+
+    return (missing_list);
+}
+
+Lease4Collection
+MySqlLeaseMgr::deleteLeases(const Lease4Collection& leases) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_DELETE_LEASES)
+        .arg(leases.size());
+
+    return (writeLeasesCommon(leases,
+        [this](MySqlLeaseContextPtr& ctx, const Lease4Ptr& lease) {
+            return (deleteLeaseInternal(ctx, lease));
+        }));
+}
+
+Lease6Collection
+MySqlLeaseMgr::deleteLeases(const Lease6Collection& leases) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_DELETE_LEASES)
+        .arg(leases.size());
+
+    return (writeLeasesCommon(leases,
+        [this](MySqlLeaseContextPtr& ctx, const Lease6Ptr& lease) {
+            return (deleteLeaseInternal(ctx, lease));
+        }));
+}
+
 uint64_t
 MySqlLeaseMgr::deleteExpiredReclaimedLeases4(const uint32_t secs) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_DELETE_EXPIRED_RECLAIMED4)
@@ -3083,8 +3276,12 @@ MySqlLeaseMgr::deleteExpiredReclaimedLeasesCommon(const uint32_t secs,
     inbind[1].buffer = reinterpret_cast<char*>(&expire_time);
     inbind[1].buffer_length = sizeof(expire_time);
 
+    // Get a context
+    MySqlLeaseContextAlloc get_context(*this);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
     // Get the number of deleted leases and log it.
-    uint64_t deleted_leases = deleteLeaseCommon(statement_index, inbind);
+    uint64_t deleted_leases = deleteLeaseCommon(ctx, statement_index, inbind);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_DELETED_EXPIRED_RECLAIMED)
         .arg(deleted_leases);
 
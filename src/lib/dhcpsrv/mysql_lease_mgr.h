@@ -1,4 +1,4 @@
-// Copyright (C) 2012-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2012-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -534,6 +534,82 @@ public:
     /// different expiration time.
     virtual bool deleteLease(const Lease6Ptr& lease);
 
+    /// @brief Adds a batch of IPv4 leases.
+    ///
+    /// The leases are added in a single transaction.
+    ///
+    /// @param leases The leases to be added.
+    ///
+    /// @return The leases which were not added because they already exist.
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed: no lease was added.
+    virtual Lease4Collection addLeases(const Lease4Collection& leases);
+
+    /// @brief Adds a batch of IPv6 leases.
+    ///
+    /// The leases are added in a single transaction.
+    ///
+    /// @param leases The leases to be added.
+    ///
+    /// @return The leases which were not added because they already exist.
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed: no lease was added.
+    virtual Lease6Collection addLeases(const Lease6Collection& leases);
+
+    /// @brief Updates a batch of IPv4 leases.
+    ///
+    /// The leases are updated in a single transaction.
+    ///
+    /// @param leases The leases to be updated.
+    ///
+    /// @return The leases which were not updated because they do not exist
+    /// or their expiration time was changed in the database.
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed: no lease was updated.
+    virtual Lease4Collection updateLeases4(const Lease4Collection& leases);
+
+    /// @brief Updates a batch of IPv6 leases.
+    ///
+    /// The leases are updated in a single transaction.
+    ///
+    /// @param leases The leases to be updated.
+    ///
+    /// @return The leases which were not updated because they do not exist
+    /// or their expiration time was changed in the database.
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed: no lease was updated.
+    virtual Lease6Collection updateLeases6(const Lease6Collection& leases);
+
+    /// @brief Deletes a batch of IPv4 leases.
+    ///
+    /// The leases are deleted in a single transaction.
+    ///
+    /// @param leases The leases to be deleted.
+    ///
+    /// @return The leases which were not deleted because they do not exist
+    /// or their expiration time was changed in the database.
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed: no lease was deleted.
+    virtual Lease4Collection deleteLeases(const Lease4Collection& leases);
+
+    /// @brief Deletes a batch of IPv6 leases.
+    ///
+    /// The leases are deleted in a single transaction.
+    ///
+    /// @param leases The leases to be deleted.
+    ///
+    /// @return The leases which were not deleted because they do not exist
+    /// or their expiration time was changed in the database.
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed: no lease was deleted.
+    virtual Lease6Collection deleteLeases(const Lease6Collection& leases);
+
     /// @brief Deletes all expired-reclaimed DHCPv4 leases.
     ///
     /// @param secs Number of seconds since expiration of leases before
@@ -901,6 +977,7 @@ private:
     /// to the prepared statement, executes the statement and checks to
     /// see how many rows were deleted.
     ///
+    /// @param ctx Context
     /// @param stindex Index of prepared statement to be executed
     /// @param bind Array of MYSQL_BIND objects representing the parameters.
     ///        (Note that the number is determined by the number of parameters
@@ -910,9 +987,100 @@ private:
     ///
     /// @throw isc::db::DbOperationError An operation on the open database has
     ///        failed.
-    uint64_t deleteLeaseCommon(StatementIndex stindex,
+    uint64_t deleteLeaseCommon(MySqlLeaseContextPtr& ctx,
+                               StatementIndex stindex,
                                MYSQL_BIND* bind);
 
+    /// @brief Adds an IPv4 lease using a given context.
+    ///
+    /// @param ctx Context
+    /// @param lease The lease to be added.
+    ///
+    /// @return true if the lease was added, false if it already exists.
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed.
+    bool addLeaseInternal(MySqlLeaseContextPtr& ctx, const Lease4Ptr& lease);
+
+    /// @brief Adds an IPv6 lease using a given context.
+    ///
+    /// @param ctx Context
+    /// @param lease The lease to be added.
+    ///
+    /// @return true if the lease was added, false if it already exists.
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed.
+    bool addLeaseInternal(MySqlLeaseContextPtr& ctx, const Lease6Ptr& lease);
+
+    /// @brief Updates an IPv4 lease using a given context.
+    ///
+    /// The current expiration time of the lease is not updated.
+    ///
+    /// @param ctx Context
+    /// @param lease The lease to be updated.
+    ///
+    /// @throw NoSuchLease Could not update a lease because no lease matches
+    ///        the address and expiration time given.
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed.
+    void updateLeaseInternal(MySqlLeaseContextPtr& ctx, const Lease4Ptr& lease);
+
+    /// @brief Updates an IPv6 lease using a given context.
+    ///
+    /// The current expiration time of the lease is not updated.
+    ///
+    /// @param ctx Context
+    /// @param lease The lease to be updated.
+    ///
+    /// @throw NoSuchLease Could not update a lease because no lease matches
+    ///        the address and expiration time given.
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed.
+    void updateLeaseInternal(MySqlLeaseContextPtr& ctx, const Lease6Ptr& lease);
+
+    /// @brief Deletes an IPv4 lease using a given context.
+    ///
+    /// @param ctx Context
+    /// @param lease The lease to be deleted.
+    ///
+    /// @return true if the lease was deleted, false if no such lease exists.
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed.
+    bool deleteLeaseInternal(MySqlLeaseContextPtr& ctx, const Lease4Ptr& lease);
+
+    /// @brief Deletes an IPv6 lease using a given context.
+    ///
+    /// @param ctx Context
+    /// @param lease The lease to be deleted.
+    ///
+    /// @return true if the lease was deleted, false if no such lease exists.
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed.
+    bool deleteLeaseInternal(MySqlLeaseContextPtr& ctx, const Lease6Ptr& lease);
+
+    /// @brief Batch of lease writes common code
+    ///
+    /// Writes the leases of a batch in a single transaction on one
+    /// context. The transaction is rolled back on error.
+    ///
+    /// @tparam LeaseCollection One of the @c Lease4Collection or
+    ///         @c Lease6Collection.
+    /// @tparam WriteFunction Type of the function writing a lease.
+    /// @param leases The leases to be written.
+    /// @param write Function writing a lease using a context: it returns
+    ///        false when the lease was not written.
+    ///
+    /// @return The leases which were not written.
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed.
+    template <typename LeaseCollection, typename WriteFunction>
+    LeaseCollection writeLeasesCommon(const LeaseCollection& leases,
+                                      WriteFunction write);
+
     /// @brief Delete expired-reclaimed leases.
     ///
     /// @param secs Number of seconds since expiration of leases before
@@ -94,7 +94,7 @@ void queueNCR(const NameChangeType& chg_type, const Lease4Ptr& lease) {
         // Figure out from the lease's subnet if we should use conflict resolution.
         // If there's no subnet, something hinky is going on so we'll set it true.
         bool use_cr = true;
-        Subnet4Ptr subnet = CfgMgr::instance().getCurrentCfg()
+        Subnet4Ptr subnet = CfgMgr::instance().getCurrentCfgSnapshot()
                             ->getCfgSubnets4()->getSubnet(lease->subnet_id_);
         if (subnet) {
             // We should always have subnet.
@@ -121,7 +121,7 @@ void queueNCR(const NameChangeType& chg_type, const Lease6Ptr& lease) {
         // Figure out from the lease's subnet if we should use conflict resolution.
         // If there's no subnet, something hinky is going on so we'll set it true.
         bool use_cr = true;
-        Subnet6Ptr subnet = CfgMgr::instance().getCurrentCfg()
+        Subnet6Ptr subnet = CfgMgr::instance().getCurrentCfgSnapshot()
                             ->getCfgSubnets6()->getSubnet(lease->subnet_id_);
         if (subnet) {
             // We should always have subnet.
@@ -6,6 +6,7 @@
 
 #include <config.h>
 #include <util/triplet.h>
+#include <dhcp/iface_mgr.h>
 #include <dhcpsrv/parsers/base_network_parser.h>
 #include <util/optional.h>
 #include <util/strutil.h>
@@ -16,6 +17,60 @@ using namespace isc::util;
 namespace isc {
 namespace dhcp {
 
+bool
+BaseNetworkParser::isReusable(const ConstElementPtr& network_data,
+                              const ConstElementPtr& previous_data,
+                              bool check_iface) {
+    if (!network_data || !previous_data ||
+        (network_data->getType() != Element::map) ||
+        (previous_data->getType() != Element::map)) {
+        return (false);
+    }
+
+    for (auto const& param : previous_data->mapValue()) {
+        if ((param.first != "reservations") &&
+            !network_data->contains(param.first)) {
+            return (false);
+        }
+    }
+
+    for (auto const& param : network_data->mapValue()) {
+        if (param.first == "reservations") {
+            continue;
+        }
+        ConstElementPtr previous = previous_data->get(param.first);
+        if (!previous) {
+            return (false);
+        }
+        if ((param.first == "subnet4") || (param.first == "subnet6")) {
+            const std::vector<ElementPtr>& subnets = param.second->listValue();
+            const std::vector<ElementPtr>& previous_subnets = previous->listValue();
+            if (subnets.size() != previous_subnets.size()) {
+                return (false);
+            }
+            // A subnet without an explicit identifier gets a new one.
+            for (size_t i = 0; i < subnets.size(); ++i) {
+                ConstElementPtr id = subnets[i]->get("id");
+                if (!id || (id->getType() != Element::integer) ||
+                    (id->intValue() <= 0) ||
+                    !isReusable(subnets[i], previous_subnets[i], check_iface)) {
+                    return (false);
+                }
+            }
+            continue;
+        }
+        if (!param.second->equals(*previous)) {
+            return (false);
+        }
+        if (check_iface && (param.first == "interface") &&
+            !param.second->stringValue().empty() &&
+            !IfaceMgr::instance().getIface(param.second->stringValue())) {
+            return (false);
+        }
+    }
+    return (true);
+}
+
 void
 BaseNetworkParser::moveReservationMode(ElementPtr config) {
     if (!config->contains("reservation-mode")) {
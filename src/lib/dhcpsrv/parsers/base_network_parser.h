@@ -36,6 +36,26 @@ public:
     /// and a flag are specified.
     static void moveReservationMode(CfgGlobalsPtr config);
 
+    /// @brief Checks if a network from the previous configuration can be
+    /// reused instead of parsing its new configuration.
+    ///
+    /// The configurations of the network, and of its subnets for a shared
+    /// network, must be equal except for the host reservations which are
+    /// parsed again. The subnets must have an explicit identifier. When
+    /// the interfaces are checked, a network using an interface which is
+    /// not present in the system is not reusable so the parser reports it.
+    ///
+    /// @param network_data Data element holding the new network
+    /// configuration.
+    /// @param previous_data Data element holding the previous network
+    /// configuration.
+    /// @param check_iface Check if the specified interfaces exist in
+    /// the system.
+    /// @return true if the previous network can be reused.
+    static bool isReusable(const data::ConstElementPtr& network_data,
+                           const data::ConstElementPtr& previous_data,
+                           bool check_iface);
+
 protected:
 
     /// @brief Parses common parameters
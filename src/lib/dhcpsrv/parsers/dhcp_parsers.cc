@@ -27,6 +27,7 @@
 #include <boost/make_shared.hpp>
 #include <boost/scoped_ptr.hpp>
 
+#include <limits>
 #include <map>
 #include <string>
 #include <vector>
@@ -40,6 +41,118 @@ using namespace isc::util;
 namespace isc {
 namespace dhcp {
 
+namespace {
+
+/// @brief Returns the explicit identifier of a subnet.
+///
+/// @param subnet_data Data element holding the subnet configuration.
+/// @return the subnet identifier or 0 when it is not specified.
+SubnetID
+getExplicitSubnetId(const ConstElementPtr& subnet_data) {
+    ConstElementPtr id = subnet_data->get("id");
+    if (!id || (id->getType() != Element::integer) || (id->intValue() <= 0) ||
+        (id->intValue() > std::numeric_limits<SubnetID>::max())) {
+        return (0);
+    }
+    return (static_cast<SubnetID>(id->intValue()));
+}
+
+/// @brief Indexes a list of subnet configurations by subnet identifier.
+///
+/// @param subnets_list List element holding the subnet configurations.
+/// @return the subnet configurations with an explicit identifier.
+std::map<SubnetID, ConstElementPtr>
+indexSubnetsById(const ConstElementPtr& subnets_list) {
+    std::map<SubnetID, ConstElementPtr> subnets;
+    if (subnets_list && (subnets_list->getType() == Element::list)) {
+        for (auto const& subnet_data : subnets_list->listValue()) {
+            SubnetID id = getExplicitSubnetId(subnet_data);
+            if (id != 0) {
+                subnets[id] = subnet_data;
+            }
+        }
+    }
+    return (subnets);
+}
+
+/// @brief Host reservations of the subnets of a list.
+///
+/// The subnets of a list are parsed first, then the host reservations of
+/// all of them are parsed together in parallel and finally added to the
+/// configuration in the subnet order. Errors are reported as if each
+/// subnet was parsed with its reservations before the next one.
+///
+/// @tparam SubnetPtrType Type of pointers to subnets.
+/// @tparam SubnetParserType Type of the subnet parser.
+/// @tparam HostParserType Type of the host reservation parser.
+template<typename SubnetPtrType, typename SubnetParserType,
+         typename HostParserType>
+class SubnetsReservations {
+public:
+
+    /// @brief Records the host reservations of a subnet.
+    ///
+    /// @param parser The parser of the subnet.
+    /// @param subnet The subnet.
+    /// @param subnet_data Data element holding the subnet configuration.
+    void add(const boost::shared_ptr<SubnetParserType>& parser,
+             const SubnetPtrType& subnet, const ConstElementPtr& subnet_data) {
+        ConstElementPtr reservations = subnet_data->get("reservations");
+        if (subnet && reservations) {
+            parsers_.push_back(parser);
+            subnets_.push_back(subnet);
+            subnet_ids_.push_back(subnet->getID());
+            lists_.push_back(reservations);
+        }
+    }
+
+    /// @brief Parses and adds the recorded host reservations.
+    ///
+    /// @param error The error which stopped the parsing of the subnets
+    /// after the recorded ones, null when all subnets were parsed.
+    /// @throw DhcpConfigError or the given error.
+    void apply(std::exception_ptr error = std::exception_ptr()) {
+        std::vector<HostCollection> hosts;
+        std::exception_ptr parse_error;
+        HostReservationsListParser<HostParserType> parser;
+        const size_t failed = parser.parse(subnet_ids_, lists_, hosts,
+                                           parse_error);
+        for (size_t i = 0; i < subnets_.size(); ++i) {
+            if (i == failed) {
+                std::rethrow_exception(parse_error);
+            }
+            parsers_[i]->addReservations(subnets_[i], hosts[i]);
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+
+    /// @brief The parsers of the subnets.
+    std::vector<boost::shared_ptr<SubnetParserType> > parsers_;
+
+    /// @brief The subnets.
+    std::vector<SubnetPtrType> subnets_;
+
+    /// @brief The subnet identifiers.
+    std::vector<SubnetID> subnet_ids_;
+
+    /// @brief The lists of host reservations.
+    std::vector<ConstElementPtr> lists_;
+};
+
+/// @brief Host reservations of a list of IPv4 subnets.
+typedef SubnetsReservations<Subnet4Ptr, Subnet4ConfigParser,
+                            HostReservationParser4> Subnets4Reservations;
+
+/// @brief Host reservations of a list of IPv6 subnets.
+typedef SubnetsReservations<Subnet6Ptr, Subnet6ConfigParser,
+                            HostReservationParser6> Subnets6Reservations;
+
+} // end of anonymous namespace
+
 // ******************** MACSourcesListConfigParser *************************
 
 void
@@ -673,7 +786,7 @@ Subnet4ConfigParser::Subnet4ConfigParser(bool check_iface)
 }
 
 Subnet4Ptr
-Subnet4ConfigParser::parse(ConstElementPtr subnet) {
+Subnet4ConfigParser::parse(ConstElementPtr subnet, bool with_reservations) {
     // Check parameters.
     checkKeywords(SimpleParser4::SUBNET4_PARAMETERS, subnet);
 
@@ -706,18 +819,32 @@ Subnet4ConfigParser::parse(ConstElementPtr subnet) {
     }
 
     // Parse Host Reservations for this subnet if any.
-    ConstElementPtr reservations = subnet->get("reservations");
+    if (with_reservations) {
+        parseReservations(sn4ptr, subnet);
+    }
+
+    return (sn4ptr);
+}
+
+void
+Subnet4ConfigParser::parseReservations(const Subnet4Ptr& subnet,
+                                        ConstElementPtr subnet_data) {
+    ConstElementPtr reservations = subnet_data->get("reservations");
     if (reservations) {
         HostCollection hosts;
         HostReservationsListParser<HostReservationParser4> parser;
-        parser.parse(subnet_->getID(), reservations, hosts);
-        for (auto h = hosts.begin(); h != hosts.end(); ++h) {
-            validateResv(sn4ptr, *h);
-            CfgMgr::instance().getStagingCfg()->getCfgHosts()->add(*h);
-        }
+        parser.parse(subnet->getID(), reservations, hosts);
+        addReservations(subnet, hosts);
     }
+}
 
-    return (sn4ptr);
+void
+Subnet4ConfigParser::addReservations(const Subnet4Ptr& subnet,
+                                      const HostCollection& hosts) {
+    for (auto h = hosts.begin(); h != hosts.end(); ++h) {
+        validateResv(subnet, *h);
+        CfgMgr::instance().getStagingCfg()->getCfgHosts()->add(*h);
+    }
 }
 
 void
@@ -966,51 +1093,93 @@ Subnets4ListConfigParser::Subnets4ListConfigParser(bool check_iface)
 
 size_t
 Subnets4ListConfigParser::parse(SrvConfigPtr cfg,
-                                ConstElementPtr subnets_list) {
-    size_t cnt = 0;
-    BOOST_FOREACH(ConstElementPtr subnet_json, subnets_list->listValue()) {
+                                ConstElementPtr subnets_list,
+                                ConstElementPtr previous_list,
+                                ConstCfgSubnets4Ptr previous_subnets) {
+    std::map<SubnetID, ConstElementPtr> previous_data;
+    if (previous_subnets) {
+        previous_data = indexSubnetsById(previous_list);
+    }
 
-        auto parser = createSubnetConfigParser();
-        Subnet4Ptr subnet = parser->parse(subnet_json);
-        if (subnet) {
+    // The host reservations are parsed after the subnets.
+    Subnets4Reservations reservations;
+    size_t cnt = 0;
+    try {
+        BOOST_FOREACH(ConstElementPtr subnet_json, subnets_list->listValue()) {
+
+            auto parser = createSubnetConfigParser();
+            Subnet4Ptr subnet;
+
+            // Reuse an unchanged subnet with its allocation state: only its
+            // host reservations are parsed.
+            auto previous =
+                previous_data.find(getExplicitSubnetId(subnet_json));
+            if ((previous != previous_data.end()) &&
+                BaseNetworkParser::isReusable(subnet_json, previous->second,
+                                              check_iface_)) {
+                subnet = previous_subnets->getSubnet(previous->first);
+                if (subnet && !subnet->getSharedNetworkName().empty()) {
+                    subnet.reset();
+                }
+            }
 
-            // Adding a subnet to the Configuration Manager may fail if the
-            // subnet id is invalid (duplicate). Thus, we catch exceptions
-            // here to append a position in the configuration string.
-            try {
-                cfg->getCfgSubnets4()->add(subnet);
-                cnt++;
-            } catch (const std::exception& ex) {
-                isc_throw(DhcpConfigError, ex.what() << " ("
-                          << subnet_json->getPosition() << ")");
+            if (!subnet) {
+                subnet = parser->parse(subnet_json, false);
+            }
+            reservations.add(parser, subnet, subnet_json);
+            if (subnet) {
+
+                // Adding a subnet to the Configuration Manager may fail if the
+                // subnet id is invalid (duplicate). Thus, we catch exceptions
+                // here to append a position in the configuration string.
+                try {
+                    cfg->getCfgSubnets4()->add(subnet);
+                    cnt++;
+                } catch (const std::exception& ex) {
+                    isc_throw(DhcpConfigError, ex.what() << " ("
+                              << subnet_json->getPosition() << ")");
+                }
             }
         }
+    } catch (...) {
+        // Report the errors of the host reservations of the previous
+        // subnets first.
+        reservations.apply(std::current_exception());
     }
+    reservations.apply();
     return (cnt);
 }
 
 size_t
 Subnets4ListConfigParser::parse(Subnet4Collection& subnets,
                                 data::ConstElementPtr subnets_list) {
+    // The host reservations are parsed after the subnets.
+    Subnets4Reservations reservations;
     size_t cnt = 0;
-    BOOST_FOREACH(ConstElementPtr subnet_json, subnets_list->listValue()) {
-
-        auto parser = createSubnetConfigParser();
-        Subnet4Ptr subnet = parser->parse(subnet_json);
-        if (subnet) {
-            try {
-                auto ret = subnets.insert(subnet);
-                if (!ret.second) {
-                    isc_throw(Unexpected,
-                              "can't store subnet because of conflict");
+    try {
+        BOOST_FOREACH(ConstElementPtr subnet_json, subnets_list->listValue()) {
+
+            auto parser = createSubnetConfigParser();
+            Subnet4Ptr subnet = parser->parse(subnet_json, false);
+            reservations.add(parser, subnet, subnet_json);
+            if (subnet) {
+                try {
+                    auto ret = subnets.insert(subnet);
+                    if (!ret.second) {
+                        isc_throw(Unexpected,
+                                  "can't store subnet because of conflict");
+                    }
+                    ++cnt;
+                } catch (const std::exception& ex) {
+                    isc_throw(DhcpConfigError, ex.what() << " ("
+                              << subnet_json->getPosition() << ")");
                 }
-                ++cnt;
-            } catch (const std::exception& ex) {
-                isc_throw(DhcpConfigError, ex.what() << " ("
-                          << subnet_json->getPosition() << ")");
             }
         }
+    } catch (...) {
+        reservations.apply(std::current_exception());
     }
+    reservations.apply();
     return (cnt);
 }
 
@@ -1173,7 +1342,7 @@ Subnet6ConfigParser::Subnet6ConfigParser(bool check_iface)
 }
 
 Subnet6Ptr
-Subnet6ConfigParser::parse(ConstElementPtr subnet) {
+Subnet6ConfigParser::parse(ConstElementPtr subnet, bool with_reservations) {
     // Check parameters.
     checkKeywords(SimpleParser6::SUBNET6_PARAMETERS, subnet);
 
@@ -1211,18 +1380,32 @@ Subnet6ConfigParser::parse(ConstElementPtr subnet) {
     }
 
     // Parse Host Reservations for this subnet if any.
-    ConstElementPtr reservations = subnet->get("reservations");
+    if (with_reservations) {
+        parseReservations(sn6ptr, subnet);
+    }
+
+    return (sn6ptr);
+}
+
+void
+Subnet6ConfigParser::parseReservations(const Subnet6Ptr& subnet,
+                                        ConstElementPtr subnet_data) {
+    ConstElementPtr reservations = subnet_data->get("reservations");
     if (reservations) {
         HostCollection hosts;
         HostReservationsListParser<HostReservationParser6> parser;
-        parser.parse(subnet_->getID(), reservations, hosts);
-        for (auto h = hosts.begin(); h != hosts.end(); ++h) {
-            validateResvs(sn6ptr, *h);
-            CfgMgr::instance().getStagingCfg()->getCfgHosts()->add(*h);
-        }
+        parser.parse(subnet->getID(), reservations, hosts);
+        addReservations(subnet, hosts);
     }
+}
 
-    return (sn6ptr);
+void
+Subnet6ConfigParser::addReservations(const Subnet6Ptr& subnet,
+                                      const HostCollection& hosts) {
+    for (auto h = hosts.begin(); h != hosts.end(); ++h) {
+        validateResvs(subnet, *h);
+        CfgMgr::instance().getStagingCfg()->getCfgHosts()->add(*h);
+    }
 }
 
 // Unused?
@@ -1432,49 +1615,91 @@ Subnets6ListConfigParser::Subnets6ListConfigParser(bool check_iface)
 
 size_t
 Subnets6ListConfigParser::parse(SrvConfigPtr cfg,
-                                ConstElementPtr subnets_list) {
+                                ConstElementPtr subnets_list,
+                                ConstElementPtr previous_list,
+                                ConstCfgSubnets6Ptr previous_subnets) {
+    std::map<SubnetID, ConstElementPtr> previous_data;
+    if (previous_subnets) {
+        previous_data = indexSubnetsById(previous_list);
+    }
+
+    // The host reservations are parsed after the subnets.
+    Subnets6Reservations reservations;
     size_t cnt = 0;
-    BOOST_FOREACH(ConstElementPtr subnet_json, subnets_list->listValue()) {
+    try {
+        BOOST_FOREACH(ConstElementPtr subnet_json, subnets_list->listValue()) {
+
+            auto parser = createSubnetConfigParser();
+            Subnet6Ptr subnet;
+
+            // Reuse an unchanged subnet with its allocation state: only its
+            // host reservations are parsed.
+            auto previous =
+                previous_data.find(getExplicitSubnetId(subnet_json));
+            if ((previous != previous_data.end()) &&
+                BaseNetworkParser::isReusable(subnet_json, previous->second,
+                                              check_iface_)) {
+                subnet = previous_subnets->getSubnet(previous->first);
+                if (subnet && !subnet->getSharedNetworkName().empty()) {
+                    subnet.reset();
+                }
+            }
 
-        auto parser = createSubnetConfigParser();
-        Subnet6Ptr subnet = parser->parse(subnet_json);
+            if (!subnet) {
+                subnet = parser->parse(subnet_json, false);
+            }
+            reservations.add(parser, subnet, subnet_json);
 
-        // Adding a subnet to the Configuration Manager may fail if the
-        // subnet id is invalid (duplicate). Thus, we catch exceptions
-        // here to append a position in the configuration string.
-        try {
-            cfg->getCfgSubnets6()->add(subnet);
-            cnt++;
-        } catch (const std::exception& ex) {
-            isc_throw(DhcpConfigError, ex.what() << " ("
-                      << subnet_json->getPosition() << ")");
+            // Adding a subnet to the Configuration Manager may fail if the
+            // subnet id is invalid (duplicate). Thus, we catch exceptions
+            // here to append a position in the configuration string.
+            try {
+                cfg->getCfgSubnets6()->add(subnet);
+                cnt++;
+            } catch (const std::exception& ex) {
+                isc_throw(DhcpConfigError, ex.what() << " ("
+                          << subnet_json->getPosition() << ")");
+            }
         }
+    } catch (...) {
+        // Report the errors of the host reservations of the previous
+        // subnets first.
+        reservations.apply(std::current_exception());
     }
+    reservations.apply();
     return (cnt);
 }
 
 size_t
 Subnets6ListConfigParser::parse(Subnet6Collection& subnets,
                                 ConstElementPtr subnets_list) {
+    // The host reservations are parsed after the subnets.
+    Subnets6Reservations reservations;
     size_t cnt = 0;
-    BOOST_FOREACH(ConstElementPtr subnet_json, subnets_list->listValue()) {
-
-        auto parser = createSubnetConfigParser();
-        Subnet6Ptr subnet = parser->parse(subnet_json);
-        if (subnet) {
-            try {
-                auto ret = subnets.insert(subnet);
-                if (!ret.second) {
-                    isc_throw(Unexpected,
-                              "can't store subnet because of conflict");
+    try {
+        BOOST_FOREACH(ConstElementPtr subnet_json, subnets_list->listValue()) {
+
+            auto parser = createSubnetConfigParser();
+            Subnet6Ptr subnet = parser->parse(subnet_json, false);
+            reservations.add(parser, subnet, subnet_json);
+            if (subnet) {
+                try {
+                    auto ret = subnets.insert(subnet);
+                    if (!ret.second) {
+                        isc_throw(Unexpected,
+                                  "can't store subnet because of conflict");
+                    }
+                    ++cnt;
+                } catch (const std::exception& ex) {
+                    isc_throw(DhcpConfigError, ex.what() << " ("
+                              << subnet_json->getPosition() << ")");
                 }
-                ++cnt;
-            } catch (const std::exception& ex) {
-                isc_throw(DhcpConfigError, ex.what() << " ("
-                          << subnet_json->getPosition() << ")");
             }
         }
+    } catch (...) {
+        reservations.apply(std::current_exception());
     }
+    reservations.apply();
     return (cnt);
 }
 
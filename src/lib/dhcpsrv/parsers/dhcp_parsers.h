@@ -1,4 +1,4 @@
-// Copyright (C) 2013-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2013-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -18,6 +18,7 @@
 #include <dhcpsrv/subnet.h>
 #include <dhcpsrv/cfg_option_def.h>
 #include <dhcpsrv/cfg_mac_source.h>
+#include <dhcpsrv/host.h>
 #include <dhcpsrv/srv_config.h>
 #include <dhcpsrv/parsers/base_network_parser.h>
 #include <dhcpsrv/parsers/option_data_parser.h>
@@ -105,7 +106,7 @@ public:
     /// @return Position of the data element or the position holding empty
     /// file name and two zeros if the position hasn't been specified for the
     /// particular value.
-    const data::Element::Position&
+    data::Element::Position
     getPosition(const std::string& name, const data::ConstElementPtr parent =
                 data::ConstElementPtr()) const {
         typename std::map<std::string, data::Element::Position>::const_iterator
@@ -601,8 +602,35 @@ public:
     /// Configuration Manager.
     ///
     /// @param subnet A new subnet being configured.
+    /// @param with_reservations When false the host reservations are
+    /// not parsed: they are parsed later with the ones of the other
+    /// subnets of the list.
     /// @return a pointer to created Subnet4 object
-    Subnet4Ptr parse(data::ConstElementPtr subnet);
+    Subnet4Ptr parse(data::ConstElementPtr subnet,
+                     bool with_reservations = true);
+
+    /// @brief Parses the host reservations of a subnet.
+    ///
+    /// The host reservations are verified and added to the staging
+    /// configuration. This is also used for a subnet which is reused
+    /// from the previous configuration.
+    ///
+    /// @param subnet pointer to the subnet.
+    /// @param subnet_data data element holding the subnet configuration.
+    /// @throw DhcpConfigError when a host reservation is invalid.
+    void parseReservations(const Subnet4Ptr& subnet,
+                           data::ConstElementPtr subnet_data);
+
+    /// @brief Adds parsed host reservations of a subnet.
+    ///
+    /// The host reservations are verified and added to the staging
+    /// configuration.
+    ///
+    /// @param subnet pointer to the subnet.
+    /// @param hosts the host reservations of the subnet.
+    /// @throw DhcpConfigError when a host reservation is invalid.
+    void addReservations(const Subnet4Ptr& subnet,
+                         const HostCollection& hosts);
 
 protected:
 
@@ -657,10 +685,20 @@ public:
     /// (by instantiating Subnet6ConfigParser) and adds to specified
     /// configuration.
     ///
+    /// When the previous subnets are given, a subnet with an explicit
+    /// identifier which configuration is unchanged, except for its host
+    /// reservations, is not parsed again: the previous subnet with its
+    /// allocation state is added to the configuration instead.
+    ///
     /// @param cfg Pointer to server configuration.
     /// @param subnets_list pointer to a list of IPv4 subnets
+    /// @param previous_list pointer to the previous list of IPv4 subnets
+    /// (with default and derived values).
+    /// @param previous_subnets pointer to the previous subnets.
     /// @return number of subnets created
-    size_t parse(SrvConfigPtr cfg, data::ConstElementPtr subnets_list);
+    size_t parse(SrvConfigPtr cfg, data::ConstElementPtr subnets_list,
+                 data::ConstElementPtr previous_list = data::ConstElementPtr(),
+                 ConstCfgSubnets4Ptr previous_subnets = ConstCfgSubnets4Ptr());
 
     /// @brief Parses contents of the subnet4 list.
     ///
@@ -869,8 +907,35 @@ public:
     /// Configuration Manager.
     ///
     /// @param subnet A new subnet being configured.
+    /// @param with_reservations When false the host reservations are
+    /// not parsed: they are parsed later with the ones of the other
+    /// subnets of the list.
     /// @return a pointer to created Subnet6 object
-    Subnet6Ptr parse(data::ConstElementPtr subnet);
+    Subnet6Ptr parse(data::ConstElementPtr subnet,
+                     bool with_reservations = true);
+
+    /// @brief Parses the host reservations of a subnet.
+    ///
+    /// The host reservations are verified and added to the staging
+    /// configuration. This is also used for a subnet which is reused
+    /// from the previous configuration.
+    ///
+    /// @param subnet pointer to the subnet.
+    /// @param subnet_data data element holding the subnet configuration.
+    /// @throw DhcpConfigError when a host reservation is invalid.
+    void parseReservations(const Subnet6Ptr& subnet,
+                           data::ConstElementPtr subnet_data);
+
+    /// @brief Adds parsed host reservations of a subnet.
+    ///
+    /// The host reservations are verified and added to the staging
+    /// configuration.
+    ///
+    /// @param subnet pointer to the subnet.
+    /// @param hosts the host reservations of the subnet.
+    /// @throw DhcpConfigError when a host reservation is invalid.
+    void addReservations(const Subnet6Ptr& subnet,
+                         const HostCollection& hosts);
 
 protected:
     /// @brief Issues a DHCP6 server specific warning regarding duplicate subnet
@@ -945,10 +1010,20 @@ public:
     /// (by instantiating Subnet6ConfigParser) and adds to specified
     /// configuration.
     ///
+    /// When the previous subnets are given, a subnet with an explicit
+    /// identifier which configuration is unchanged, except for its host
+    /// reservations, is not parsed again: the previous subnet with its
+    /// allocation state is added to the configuration instead.
+    ///
     /// @param cfg configuration (parsed subnets will be stored here)
     /// @param subnets_list pointer to a list of IPv6 subnets
+    /// @param previous_list pointer to the previous list of IPv6 subnets
+    /// (with default and derived values).
+    /// @param previous_subnets pointer to the previous subnets.
     /// @throw DhcpConfigError if CfgMgr rejects the subnet (e.g. subnet-id is a duplicate)
-    size_t parse(SrvConfigPtr cfg, data::ConstElementPtr subnets_list);
+    size_t parse(SrvConfigPtr cfg, data::ConstElementPtr subnets_list,
+                 data::ConstElementPtr previous_list = data::ConstElementPtr(),
+                 ConstCfgSubnets6Ptr previous_subnets = ConstCfgSubnets6Ptr());
 
     /// @brief Parses contents of the subnet6 list.
     ///
@@ -1,4 +1,4 @@
-// Copyright (C) 2014-2018 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2014-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -31,31 +31,18 @@ namespace {
 /// parameters (if false).
 const std::set<std::string>&
 getSupportedParams4(const bool identifiers_only = false) {
-    // Holds set of host identifiers.
-    static std::set<std::string> identifiers_set;
+    // Holds set of host identifiers. The sets are initialized once
+    // in a thread safe way as reservations can be parsed in parallel.
+    static const std::set<std::string> identifiers_set = {
+        "hw-address", "duid", "circuit-id", "client-id", "flex-id"
+    };
     // Holds set of all supported parameters, including identifiers.
-    static std::set<std::string> params_set;
-    // If this is first execution of this function, we need
-    // to initialize the set.
-    if (identifiers_set.empty()) {
-        identifiers_set.insert("hw-address");
-        identifiers_set.insert("duid");
-        identifiers_set.insert("circuit-id");
-        identifiers_set.insert("client-id");
-        identifiers_set.insert("flex-id");
-    }
-    // Copy identifiers and add all other parameters.
-    if (params_set.empty()) {
-        params_set = identifiers_set;
-        params_set.insert("hostname");
-        params_set.insert("ip-address");
-        params_set.insert("option-data");
-        params_set.insert("next-server");
-        params_set.insert("server-hostname");
-        params_set.insert("boot-file-name");
-        params_set.insert("client-classes");
-        params_set.insert("user-context");
-    }
+    static const std::set<std::string> params_set = {
+        "hw-address", "duid", "circuit-id", "client-id", "flex-id",
+        "hostname", "ip-address", "option-data", "next-server",
+        "server-hostname", "boot-file-name", "client-classes",
+        "user-context"
+    };
     return (identifiers_only ? identifiers_set : params_set);
 }
 
@@ -69,30 +56,19 @@ getSupportedParams4(const bool identifiers_only = false) {
 /// parameters (if false).
 const std::set<std::string>&
 getSupportedParams6(const bool identifiers_only = false) {
-    // Holds set of host identifiers.
-    static std::set<std::string> identifiers_set;
+    // Holds set of host identifiers. The sets are initialized once
+    // in a thread safe way as reservations can be parsed in parallel.
+    static const std::set<std::string> identifiers_set = {
+        "hw-address", "duid", "flex-id"
+    };
     // Holds set of all supported parameters, including identifiers.
-    static std::set<std::string> params_set;
-    // If this is first execution of this function, we need
-    // to initialize the set.
-    if (identifiers_set.empty()) {
-        identifiers_set.insert("hw-address");
-        identifiers_set.insert("duid");
-        identifiers_set.insert("flex-id");
-    }
-    // Copy identifiers and add all other parameters.
-    if (params_set.empty()) {
-        params_set = identifiers_set;
-        params_set.insert("hostname");
-        params_set.insert("ip-addresses");
-        params_set.insert("prefixes");
-        params_set.insert("option-data");
-        params_set.insert("client-classes");
-        params_set.insert("user-context");
-    }
+    static const std::set<std::string> params_set = {
+        "hw-address", "duid", "flex-id",
+        "hostname", "ip-addresses", "prefixes", "option-data",
+        "client-classes", "user-context"
+    };
     return (identifiers_only ? identifiers_set : params_set);
 }
-
 }
 
 namespace isc {
@@ -1,4 +1,4 @@
-// Copyright (C) 2014-2017 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2014-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -11,7 +11,11 @@
 #include <cc/simple_parser.h>
 #include <dhcpsrv/host.h>
 #include <dhcpsrv/subnet_id.h>
+#include <dhcpsrv/parsers/parallel_parser.h>
 #include <boost/foreach.hpp>
+#include <algorithm>
+#include <exception>
+#include <vector>
 
 namespace isc {
 namespace dhcp {
@@ -27,6 +31,8 @@ public:
 
     /// @brief Parses a list of host reservation entries for a subnet.
     ///
+    /// Long lists are parsed in parallel (see @c ParallelParser).
+    ///
     /// @param subnet_id Identifier of the subnet to which the reservations
     /// belong.
     /// @param hr_list Data element holding a list of host reservations.
@@ -38,13 +44,57 @@ public:
     /// is invalid.
     void parse(const SubnetID& subnet_id, isc::data::ConstElementPtr hr_list,
                HostCollection& hosts_list) {
-        HostCollection hosts;
-        BOOST_FOREACH(data::ConstElementPtr reservation, hr_list->listValue()) {
+        const std::vector<data::ElementPtr>& entries = hr_list->listValue();
+        HostCollection hosts(entries.size());
+        ParallelParser::parse(entries.size(), [&](size_t i) {
             HostReservationParserType parser;
-            hosts.push_back(parser.parse(subnet_id, reservation));
-        }
+            hosts[i] = parser.parse(subnet_id, entries[i]);
+        });
         hosts_list.swap(hosts);
     }
+
+    /// @brief Parses lists of host reservation entries for several subnets.
+    ///
+    /// The entries of all lists are parsed together in parallel so many
+    /// short lists benefit from it too.
+    ///
+    /// @param subnet_ids Identifiers of the subnets.
+    /// @param hr_lists Data elements holding the lists of host reservations
+    /// of the subnets, in the same order.
+    /// @param [out] hosts_lists Hosts representing parsed reservations of
+    /// each subnet.
+    /// @param [out] error The error raised by the first invalid reservation.
+    /// @return The index of the list holding the first invalid reservation
+    /// or the number of lists when all reservations are valid.
+    size_t parse(const std::vector<SubnetID>& subnet_ids,
+                 const std::vector<isc::data::ConstElementPtr>& hr_lists,
+                 std::vector<HostCollection>& hosts_lists,
+                 std::exception_ptr& error) {
+        // Index the entries of all lists.
+        std::vector<size_t> offsets;
+        size_t count = 0;
+        hosts_lists.clear();
+        hosts_lists.resize(hr_lists.size());
+        for (size_t list = 0; list < hr_lists.size(); ++list) {
+            offsets.push_back(count);
+            count += hr_lists[list]->size();
+            hosts_lists[list].resize(hr_lists[list]->size());
+        }
+        size_t failed = ParallelParser::parse(count, [&](size_t i) {
+            const size_t list =
+                std::upper_bound(offsets.begin(), offsets.end(), i) -
+                offsets.begin() - 1;
+            const size_t entry = i - offsets[list];
+            HostReservationParserType parser;
+            hosts_lists[list][entry] =
+                parser.parse(subnet_ids[list], hr_lists[list]->get(entry));
+        }, error);
+        if (failed == count) {
+            return (hr_lists.size());
+        }
+        return (std::upper_bound(offsets.begin(), offsets.end(), failed) -
+                offsets.begin() - 1);
+    }
 };
 
 }
@@ -1,4 +1,4 @@
-// Copyright (C) 2020 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2020-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -9,6 +9,7 @@
 #include <cc/data.h>
 #include <dhcpsrv/srv_config.h>
 #include <dhcpsrv/parsers/multi_threading_config_parser.h>
+#include <util/cpu_affinity.h>
 #include <util/multi_threading_mgr.h>
 
 using namespace isc::data;
@@ -64,8 +65,37 @@ MultiThreadingConfigParser::parse(SrvConfig& srv_cfg,
         }
     }
 
+    // work-stealing is not mandatory
+    if (value->get("work-stealing")) {
+        getBoolean(value, "work-stealing");
+    }
+
+    // worker-cpu-set and receiver-cpu-set are not mandatory
+    for (auto const& name : { "worker-cpu-set", "receiver-cpu-set" }) {
+        if (value->get(name)) {
+            auto cpus = getString(value, name);
+            CpuSet cpu_set;
+            try {
+                cpu_set = parseCpuSet(cpus);
+            } catch (const std::exception& ex) {
+                isc_throw(DhcpConfigError, "invalid " << name << " '"
+                          << cpus << "': " << ex.what() << " ("
+                          << getPosition(name, value) << ")");
+            }
+            if (!cpu_set.empty() && !isThreadAffinitySupported()) {
+                isc_throw(DhcpConfigError, name << " is not supported"
+                          " on this system (" << getPosition(name, value)
+                          << ")");
+            }
+        }
+    }
+
     srv_cfg.setDHCPMultiThreading(value);
-    MultiThreadingMgr::instance().setMode(enabled);
+    // Leave the mode alone when it does not change: the configuration
+    // can be parsed while packets are processed.
+    if (MultiThreadingMgr::instance().getMode() != enabled) {
+        MultiThreadingMgr::instance().setMode(enabled);
+    }
 }
 
 }  // namespace dhcp
@@ -0,0 +1,129 @@
+// Copyright (C) 2022 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <dhcp/libdhcp++.h>
+#include <dhcpsrv/parsers/parallel_parser.h>
+#include <util/multi_threading_mgr.h>
+#include <util/thread_pool.h>
+
+#include <boost/make_shared.hpp>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using namespace isc::util;
+
+namespace {
+
+/// @brief Number of chunks per thread (more chunks balance the load).
+const size_t CHUNKS_PER_THREAD = 4;
+
+/// @brief Minimum number of items in a chunk.
+const size_t MIN_CHUNK_SIZE = 64;
+
+}
+
+namespace isc {
+namespace dhcp {
+
+const size_t ParallelParser::MIN_PARALLEL_ITEMS = 256;
+
+std::atomic<size_t> ParallelParser::thread_count_(0);
+
+void
+ParallelParser::setThreadCount(size_t count) {
+    thread_count_ = count;
+}
+
+size_t
+ParallelParser::getThreadCount() {
+    return (thread_count_);
+}
+
+size_t
+ParallelParser::parse(size_t count, const ParseFunction& parse_item,
+                      std::exception_ptr& error) {
+    error = std::exception_ptr();
+    size_t threads = thread_count_;
+    if (!threads) {
+        threads = MultiThreadingMgr::detectThreadCount();
+    }
+
+    if ((threads < 2) || (count < MIN_PARALLEL_ITEMS)) {
+        for (size_t i = 0; i < count; ++i) {
+            try {
+                parse_item(i);
+            } catch (...) {
+                error = std::current_exception();
+                return (i);
+            }
+        }
+        return (count);
+    }
+
+    const size_t chunk_size = std::max(count / (threads * CHUNKS_PER_THREAD),
+                                       MIN_CHUNK_SIZE);
+    const size_t chunks = (count + chunk_size - 1) / chunk_size;
+    threads = std::min(threads, chunks);
+
+    // Each chunk records its first invalid item. Items after an already
+    // known invalid item are skipped as their errors will not be reported.
+    std::vector<size_t> failed(chunks, count);
+    std::vector<std::exception_ptr> errors(chunks);
+    std::atomic<size_t> first_failed(count);
+    const std::thread::id parent = std::this_thread::get_id();
+
+    ThreadPool<std::function<void()>> pool;
+    pool.start(threads);
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+        pool.add(boost::make_shared<std::function<void()>>([&, chunk]() {
+            LibDHCP::setRuntimeOptionDefsParentThread(parent);
+            const size_t end = std::min((chunk + 1) * chunk_size, count);
+            for (size_t i = chunk * chunk_size; i < end; ++i) {
+                if (i > first_failed) {
+                    break;
+                }
+                try {
+                    parse_item(i);
+                } catch (...) {
+                    failed[chunk] = i;
+                    errors[chunk] = std::current_exception();
+                    size_t current = first_failed;
+                    while ((i < current) &&
+                           !first_failed.compare_exchange_weak(current, i)) {
+                    }
+                    break;
+                }
+            }
+            LibDHCP::setRuntimeOptionDefsParentThread(std::thread::id());
+        }));
+    }
+    pool.wait();
+    pool.stop();
+
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+        if (failed[chunk] < count) {
+            error = errors[chunk];
+            return (failed[chunk]);
+        }
+    }
+    return (count);
+}
+
+void
+ParallelParser::parse(size_t count, const ParseFunction& parse_item) {
+    std::exception_ptr error;
+    parse(count, parse_item, error);
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // end of namespace isc::dhcp
+} // end of namespace isc
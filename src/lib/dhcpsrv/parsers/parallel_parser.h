@@ -0,0 +1,81 @@
+// Copyright (C) 2022 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef PARALLEL_PARSER_H
+#define PARALLEL_PARSER_H
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Parses the items of a list on a thread pool.
+///
+/// The items of large lists, e.g. host reservations, are independent:
+/// each of them can be parsed in isolation and only the checks involving
+/// several items (identifiers, uniqueness) need the whole list. This
+/// class parses the items in chunks on a pool of threads. The parse
+/// function must store its result in a slot owned by the caller, which
+/// merges the results and performs the remaining checks in a single pass
+/// afterwards.
+///
+/// The errors are reported as by a sequential parsing: the error of the
+/// first invalid item is returned even when items after it were parsed
+/// (and failed) earlier.
+///
+/// Items parsed by the threads see the same runtime option definitions
+/// as the calling thread.
+class ParallelParser {
+public:
+
+    /// @brief Type of the function parsing an item given its index.
+    typedef std::function<void(size_t)> ParseFunction;
+
+    /// @brief Minimum number of items for a parallel parsing.
+    ///
+    /// Shorter lists are parsed by the calling thread.
+    static const size_t MIN_PARALLEL_ITEMS;
+
+    /// @brief Sets the number of parsing threads.
+    ///
+    /// @param count The number of threads: 0 uses the number of cores,
+    /// 1 disables parallel parsing.
+    static void setThreadCount(size_t count);
+
+    /// @brief Returns the number of parsing threads.
+    ///
+    /// @return The number of threads, 0 meaning the number of cores.
+    static size_t getThreadCount();
+
+    /// @brief Parses items.
+    ///
+    /// @param count The number of items.
+    /// @param parse_item The function parsing an item.
+    /// @param [out] error The exception raised by the first invalid item.
+    /// @return The index of the first invalid item or @c count when all
+    /// items are valid.
+    static size_t parse(size_t count, const ParseFunction& parse_item,
+                        std::exception_ptr& error);
+
+    /// @brief Parses items, throwing the error of the first invalid item.
+    ///
+    /// @param count The number of items.
+    /// @param parse_item The function parsing an item.
+    static void parse(size_t count, const ParseFunction& parse_item);
+
+private:
+
+    /// @brief The number of parsing threads, 0 for the number of cores.
+    static std::atomic<size_t> thread_count_;
+};
+
+} // end of namespace isc::dhcp
+} // end of namespace isc
+
+#endif // PARALLEL_PARSER_H
@@ -215,6 +215,24 @@ SharedNetwork4Parser::parse(const data::ConstElementPtr& shared_network_data) {
     return (shared_network);
 }
 
+void
+SharedNetwork4Parser::parseReservations(const SharedNetwork4Ptr& shared_network,
+                                        const data::ConstElementPtr& shared_network_data) {
+    ConstElementPtr subnets = shared_network_data->get("subnet4");
+    if (!subnets) {
+        return;
+    }
+
+    Subnet4ConfigParser parser(check_iface_);
+    for (auto const& subnet_data : subnets->listValue()) {
+        Subnet4Ptr subnet =
+            shared_network->getSubnet(static_cast<SubnetID>(getInteger(subnet_data, "id")));
+        if (subnet) {
+            parser.parseReservations(subnet, subnet_data);
+        }
+    }
+}
+
 boost::shared_ptr<OptionDataListParser>
 SharedNetwork4Parser::createOptionDataListParser() const {
     auto parser = boost::make_shared<OptionDataListParser>(AF_INET);
@@ -392,6 +410,24 @@ SharedNetwork6Parser::parse(const data::ConstElementPtr& shared_network_data) {
     return (shared_network);
 }
 
+void
+SharedNetwork6Parser::parseReservations(const SharedNetwork6Ptr& shared_network,
+                                        const data::ConstElementPtr& shared_network_data) {
+    ConstElementPtr subnets = shared_network_data->get("subnet6");
+    if (!subnets) {
+        return;
+    }
+
+    Subnet6ConfigParser parser(check_iface_);
+    for (auto const& subnet_data : subnets->listValue()) {
+        Subnet6Ptr subnet =
+            shared_network->getSubnet(static_cast<SubnetID>(getInteger(subnet_data, "id")));
+        if (subnet) {
+            parser.parseReservations(subnet, subnet_data);
+        }
+    }
+}
+
 boost::shared_ptr<OptionDataListParser>
 SharedNetwork6Parser::createOptionDataListParser() const {
     auto parser = boost::make_shared<OptionDataListParser>(AF_INET6);
@@ -1,4 +1,4 @@
-// Copyright (C) 2017-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2017-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -43,6 +43,18 @@ public:
     SharedNetwork4Ptr
     parse(const data::ConstElementPtr& shared_network_data);
 
+    /// @brief Parses the host reservations of the subnets of a shared network.
+    ///
+    /// This is used for a shared network which is reused from the previous
+    /// configuration with its subnets.
+    ///
+    /// @param shared_network Pointer to the shared network.
+    /// @param shared_network_data Data element holding shared network
+    /// configuration.
+    /// @throw DhcpConfigError when a host reservation is invalid.
+    void parseReservations(const SharedNetwork4Ptr& shared_network,
+                           const data::ConstElementPtr& shared_network_data);
+
 protected:
 
     /// @brief Returns an instance of the @c OptionDataListParser to
@@ -90,6 +102,18 @@ public:
     SharedNetwork6Ptr
     parse(const data::ConstElementPtr& shared_network_data);
 
+    /// @brief Parses the host reservations of the subnets of a shared network.
+    ///
+    /// This is used for a shared network which is reused from the previous
+    /// configuration with its subnets.
+    ///
+    /// @param shared_network Pointer to the shared network.
+    /// @param shared_network_data Data element holding shared network
+    /// configuration.
+    /// @throw DhcpConfigError when a host reservation is invalid.
+    void parseReservations(const SharedNetwork6Ptr& shared_network,
+                           const data::ConstElementPtr& shared_network_data);
+
 protected:
 
     /// @brief Returns an instance of the @c OptionDataListParser to
@@ -1,4 +1,4 @@
-// Copyright (C) 2017-2019 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2017-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -12,7 +12,10 @@
 #include <cc/simple_parser.h>
 #include <exceptions/exceptions.h>
 #include <dhcpsrv/subnet.h>
+#include <dhcpsrv/parsers/base_network_parser.h>
 #include <dhcpsrv/parsers/shared_network_parser.h>
+#include <map>
+#include <string>
 #include <vector>
 
 namespace isc {
@@ -46,13 +49,33 @@ public:
     /// the data should be parsed.
     /// @param shared_networks_list_data List element holding a list of
     /// shared networks.
+    /// @param previous_list_data List element holding the previous list
+    /// of shared networks (with default and derived values).
+    /// @param previous_cfg Previous shared networks configuration
+    /// structure. When it is given, a shared network which configuration
+    /// is unchanged, except for the host reservations of its subnets, is
+    /// not parsed again: the previous shared network with its subnets is
+    /// added to the configuration instead.
     ///
     /// @throw DhcpConfigError when error has occurred, e.g. when networks
     /// with duplicated names have been specified.
     template<typename CfgSharedNetworksTypePtr>
     void parse(CfgSharedNetworksTypePtr& cfg,
-               const data::ConstElementPtr& shared_networks_list_data) {
+               const data::ConstElementPtr& shared_networks_list_data,
+               const data::ConstElementPtr& previous_list_data = data::ConstElementPtr(),
+               const CfgSharedNetworksTypePtr& previous_cfg = CfgSharedNetworksTypePtr()) {
         try {
+            // Index the previous networks by name.
+            std::map<std::string, data::ConstElementPtr> previous_data;
+            if (previous_cfg && previous_list_data) {
+                for (auto const& previous : previous_list_data->listValue()) {
+                    data::ConstElementPtr name = previous->get("name");
+                    if (name && (name->getType() == data::Element::string)) {
+                        previous_data[name->stringValue()] = previous;
+                    }
+                }
+            }
+
             // Get the C++ vector holding networks.
             const std::vector<data::ElementPtr>& networks_list =
                 shared_networks_list_data->listValue();
@@ -60,6 +83,26 @@ public:
             for (auto network_element = networks_list.cbegin();
                  network_element != networks_list.cend(); ++network_element) {
                 SharedNetworkParserType parser(check_iface_);
+
+                // Reuse an unchanged network with its subnets: only the
+                // host reservations of the subnets are parsed.
+                data::ConstElementPtr name = (*network_element)->get("name");
+                auto previous = previous_data.end();
+                if (name && (name->getType() == data::Element::string)) {
+                    previous = previous_data.find(name->stringValue());
+                }
+                if ((previous != previous_data.end()) &&
+                    BaseNetworkParser::isReusable(*network_element,
+                                                  previous->second,
+                                                  check_iface_)) {
+                    auto network = previous_cfg->getByName(previous->first);
+                    if (network) {
+                        parser.parseReservations(network, *network_element);
+                        cfg->add(network);
+                        continue;
+                    }
+                }
+
                 auto network = parser.parse(*network_element);
                 cfg->add(network);
             }
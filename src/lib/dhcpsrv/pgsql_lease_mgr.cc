@@ -23,6 +23,7 @@
 
 #include <iomanip>
 #include <limits>
+#include <set>
 #include <sstream>
 #include <string>
 #include <time.h>
@@ -291,6 +292,29 @@ PgSqlTaggedStatement tagged_statements[] = {
         "state, user_context) "
       "VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11, $12, $13, $14, $15, $16, $17)"},
 
+    // INSERT_LEASE4_BATCH
+    { 11, { OID_INT8, OID_BYTEA, OID_BYTEA, OID_INT8, OID_TIMESTAMP, OID_INT8,
+            OID_BOOL, OID_BOOL, OID_VARCHAR, OID_INT8, OID_TEXT },
+      "insert_lease4_batch",
+      "INSERT INTO lease4(address, hwaddr, client_id, "
+        "valid_lifetime, expire, subnet_id, fqdn_fwd, fqdn_rev, hostname, "
+        "state, user_context) "
+      "VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11) "
+      "ON CONFLICT DO NOTHING"},
+
+    // INSERT_LEASE6_BATCH
+    { 17, { OID_VARCHAR, OID_BYTEA, OID_INT8, OID_TIMESTAMP, OID_INT8,
+            OID_INT8, OID_INT2, OID_INT8, OID_INT2, OID_BOOL, OID_BOOL,
+            OID_VARCHAR, OID_BYTEA, OID_INT2, OID_INT2, OID_INT8, OID_TEXT },
+      "insert_lease6_batch",
+      "INSERT INTO lease6(address, duid, valid_lifetime, "
+        "expire, subnet_id, pref_lifetime, "
+        "lease_type, iaid, prefix_len, fqdn_fwd, fqdn_rev, hostname, "
+        "hwaddr, hwtype, hwaddr_source, "
+        "state, user_context) "
+      "VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11, $12, $13, $14, $15, $16, $17) "
+      "ON CONFLICT DO NOTHING"},
+
     // UPDATE_LEASE4
     { 13, { OID_INT8, OID_BYTEA, OID_BYTEA, OID_INT8, OID_TIMESTAMP, OID_INT8,
             OID_BOOL, OID_BOOL, OID_VARCHAR, OID_INT8, OID_TEXT, OID_INT8, OID_TIMESTAMP },
@@ -1408,6 +1432,14 @@ PgSqlLeaseMgr::addLeaseCommon(PgSqlLeaseContextPtr& ctx,
     return (true);
 }
 
+bool
+PgSqlLeaseMgr::addLeaseInternal(PgSqlLeaseContextPtr& ctx,
+                                const Lease4Ptr& lease) {
+    PsqlBindArray bind_array;
+    ctx->exchange4_->createBindForSend(lease, bind_array);
+    return (addLeaseCommon(ctx, INSERT_LEASE4, bind_array));
+}
+
 bool
 PgSqlLeaseMgr::addLease(const Lease4Ptr& lease) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_PGSQL_ADD_ADDR4)
@@ -1417,9 +1449,7 @@ PgSqlLeaseMgr::addLease(const Lease4Ptr& lease) {
     PgSqlLeaseContextAlloc get_context(*this);
     PgSqlLeaseContextPtr ctx = get_context.ctx_;
 
-    PsqlBindArray bind_array;
-    ctx->exchange4_->createBindForSend(lease, bind_array);
-    auto result = addLeaseCommon(ctx, INSERT_LEASE4, bind_array);
+    auto result = addLeaseInternal(ctx, lease);
 
     // Update lease current expiration time (allows update between the creation
     // of the Lease up to the point of insertion in the database).
@@ -1428,6 +1458,14 @@ PgSqlLeaseMgr::addLease(const Lease4Ptr& lease) {
     return (result);
 }
 
+bool
+PgSqlLeaseMgr::addLeaseInternal(PgSqlLeaseContextPtr& ctx,
+                                const Lease6Ptr& lease) {
+    PsqlBindArray bind_array;
+    ctx->exchange6_->createBindForSend(lease, bind_array);
+    return (addLeaseCommon(ctx, INSERT_LEASE6, bind_array));
+}
+
 bool
 PgSqlLeaseMgr::addLease(const Lease6Ptr& lease) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_PGSQL_ADD_ADDR6)
@@ -1438,10 +1476,7 @@ PgSqlLeaseMgr::addLease(const Lease6Ptr& lease) {
     PgSqlLeaseContextAlloc get_context(*this);
     PgSqlLeaseContextPtr ctx = get_context.ctx_;
 
-    PsqlBindArray bind_array;
-    ctx->exchange6_->createBindForSend(lease, bind_array);
-
-    auto result = addLeaseCommon(ctx, INSERT_LEASE6, bind_array);
+    auto result = addLeaseInternal(ctx, lease);
 
     // Update lease current expiration time (allows update between the creation
     // of the Lease up to the point of insertion in the database).
@@ -2071,16 +2106,10 @@ PgSqlLeaseMgr::updateLeaseCommon(PgSqlLeaseContextPtr& ctx,
 }
 
 void
-PgSqlLeaseMgr::updateLease4(const Lease4Ptr& lease) {
+PgSqlLeaseMgr::updateLeaseInternal(PgSqlLeaseContextPtr& ctx,
+                                   const Lease4Ptr& lease) {
     const StatementIndex stindex = UPDATE_LEASE4;
 
-    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_PGSQL_UPDATE_ADDR4)
-        .arg(lease->addr_.toText());
-
-    // Get a context
-    PgSqlLeaseContextAlloc get_context(*this);
-    PgSqlLeaseContextPtr ctx = get_context.ctx_;
-
     // Create the BIND array for the data being updated
     PsqlBindArray bind_array;
     ctx->exchange4_->createBindForSend(lease, bind_array);
@@ -2101,23 +2130,28 @@ PgSqlLeaseMgr::updateLease4(const Lease4Ptr& lease) {
 
     // Drop to common update code
     updateLeaseCommon(ctx, stindex, bind_array, lease);
-
-    // Update lease current expiration time.
-    lease->updateCurrentExpirationTime();
 }
 
 void
-PgSqlLeaseMgr::updateLease6(const Lease6Ptr& lease) {
-    const StatementIndex stindex = UPDATE_LEASE6;
-
-    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_PGSQL_UPDATE_ADDR6)
-        .arg(lease->addr_.toText())
-        .arg(lease->type_);
+PgSqlLeaseMgr::updateLease4(const Lease4Ptr& lease) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_PGSQL_UPDATE_ADDR4)
+        .arg(lease->addr_.toText());
 
     // Get a context
     PgSqlLeaseContextAlloc get_context(*this);
     PgSqlLeaseContextPtr ctx = get_context.ctx_;
 
+    updateLeaseInternal(ctx, lease);
+
+    // Update lease current expiration time.
+    lease->updateCurrentExpirationTime();
+}
+
+void
+PgSqlLeaseMgr::updateLeaseInternal(PgSqlLeaseContextPtr& ctx,
+                                   const Lease6Ptr& lease) {
+    const StatementIndex stindex = UPDATE_LEASE6;
+
     // Create the BIND array for the data being updated
     PsqlBindArray bind_array;
     ctx->exchange6_->createBindForSend(lease, bind_array);
@@ -2138,18 +2172,28 @@ PgSqlLeaseMgr::updateLease6(const Lease6Ptr& lease) {
 
     // Drop to common update code
     updateLeaseCommon(ctx, stindex, bind_array, lease);
+}
+
+void
+PgSqlLeaseMgr::updateLease6(const Lease6Ptr& lease) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_PGSQL_UPDATE_ADDR6)
+        .arg(lease->addr_.toText())
+        .arg(lease->type_);
+
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(*this);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
+    updateLeaseInternal(ctx, lease);
 
     // Update lease current expiration time.
     lease->updateCurrentExpirationTime();
 }
 
 uint64_t
-PgSqlLeaseMgr::deleteLeaseCommon(StatementIndex stindex,
+PgSqlLeaseMgr::deleteLeaseCommon(PgSqlLeaseContextPtr& ctx,
+                                 StatementIndex stindex,
                                  PsqlBindArray& bind_array) {
-    // Get a context
-    PgSqlLeaseContextAlloc get_context(*this);
-    PgSqlLeaseContextPtr ctx = get_context.ctx_;
-
     PgSqlResult r(PQexecPrepared(ctx->conn_, tagged_statements[stindex].name,
                                  tagged_statements[stindex].nbparams,
                                  &bind_array.values_[0],
@@ -2163,10 +2207,9 @@ PgSqlLeaseMgr::deleteLeaseCommon(StatementIndex stindex,
 }
 
 bool
-PgSqlLeaseMgr::deleteLease(const Lease4Ptr& lease) {
+PgSqlLeaseMgr::deleteLeaseInternal(PgSqlLeaseContextPtr& ctx,
+                                   const Lease4Ptr& lease) {
     const IOAddress& addr = lease->addr_;
-    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_PGSQL_DELETE_ADDR)
-        .arg(addr.toText());
 
     // Set up the WHERE clause value
     PsqlBindArray bind_array;
@@ -2184,7 +2227,7 @@ PgSqlLeaseMgr::deleteLease(const Lease4Ptr& lease) {
     }
     bind_array.add(expire_str);
 
-    auto affected_rows = deleteLeaseCommon(DELETE_LEASE4, bind_array);
+    auto affected_rows = deleteLeaseCommon(ctx, DELETE_LEASE4, bind_array);
 
     // Check success case first as it is the most likely outcome.
     if (affected_rows == 1) {
@@ -2203,11 +2246,21 @@ PgSqlLeaseMgr::deleteLease(const Lease4Ptr& lease) {
 }
 
 bool
-PgSqlLeaseMgr::deleteLease(const Lease6Ptr& lease) {
+PgSqlLeaseMgr::deleteLease(const Lease4Ptr& lease) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_PGSQL_DELETE_ADDR)
+        .arg(lease->addr_.toText());
+
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(*this);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
+    return (deleteLeaseInternal(ctx, lease));
+}
+
+bool
+PgSqlLeaseMgr::deleteLeaseInternal(PgSqlLeaseContextPtr& ctx,
+                                   const Lease6Ptr& lease) {
     const IOAddress& addr = lease->addr_;
-    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
-              DHCPSRV_PGSQL_DELETE_ADDR)
-        .arg(addr.toText());
 
     // Set up the WHERE clause value
     PsqlBindArray bind_array;
@@ -2225,7 +2278,7 @@ PgSqlLeaseMgr::deleteLease(const Lease6Ptr& lease) {
     }
     bind_array.add(expire_str);
 
-    auto affected_rows = deleteLeaseCommon(DELETE_LEASE6, bind_array);
+    auto affected_rows = deleteLeaseCommon(ctx, DELETE_LEASE6, bind_array);
 
     // Check success case first as it is the most likely outcome.
     if (affected_rows == 1) {
@@ -2243,6 +2296,218 @@ PgSqlLeaseMgr::deleteLease(const Lease6Ptr& lease) {
               "that had the address " << lease->addr_.toText());
 }
 
+bool
+PgSqlLeaseMgr::deleteLease(const Lease6Ptr& lease) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+              DHCPSRV_PGSQL_DELETE_ADDR)
+        .arg(lease->addr_.toText());
+
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(*this);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
+    return (deleteLeaseInternal(ctx, lease));
+}
+
+// Batch methods. The statements are sent together in the pipeline mode
+// of the connection: they are executed in one round trip and in one
+// implicit transaction.
+
+namespace {
+
+/// @brief Appends the key (address and expiration time) of a lease.
+///
+/// The values are copied into the bind array so it can outlive the lease.
+///
+/// @param lease Pointer to the IPv4 lease.
+/// @param bind_array The bind array to append to.
+void
+bindLeaseKey(const Lease4Ptr& lease, PsqlBindArray& bind_array) {
+    bind_array.add(lease->addr_.toUint32());
+
+    // Avoid overflow (see createBindForSend)
+    if (lease->current_valid_lft_ == Lease::INFINITY_LFT) {
+        bind_array.addTempString(PgSqlLeaseExchange::convertToDatabaseTime(lease->current_cltt_, 0));
+    } else {
+        bind_array.addTempString(PgSqlLeaseExchange::convertToDatabaseTime(lease->current_cltt_,
+                                                                           lease->current_valid_lft_));
+    }
+}
+
+/// @brief Appends the key (address and expiration time) of a lease.
+///
+/// The values are copied into the bind array so it can outlive the lease.
+///
+/// @param lease Pointer to the IPv6 lease.
+/// @param bind_array The bind array to append to.
+void
+bindLeaseKey(const Lease6Ptr& lease, PsqlBindArray& bind_array) {
+    bind_array.addTempString(lease->addr_.toText());
+
+    // Avoid overflow (see createBindForSend)
+    if (lease->current_valid_lft_ == Lease::INFINITY_LFT) {
+        bind_array.addTempString(PgSqlLeaseExchange::convertToDatabaseTime(lease->current_cltt_, 0));
+    } else {
+        bind_array.addTempString(PgSqlLeaseExchange::convertToDatabaseTime(lease->current_cltt_,
+                                                                           lease->current_valid_lft_));
+    }
+}
+
+}  // namespace
+
+template <typename LeaseCollection, typename BindFunction>
+LeaseCollection
+PgSqlLeaseMgr::writeLeasesCommon(const LeaseCollection& leases,
+                                 StatementIndex stindex,
+                                 BindFunction bind) {
+    LeaseCollection not_written;
+    if (leases.empty()) {
+        return (not_written);
+    }
+
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(*this);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
+    // The pipeline copies the parameters so the exchange can be reused
+    // for the next lease.
+    PgSqlPipeline pipeline(ctx->conn_);
+    for (auto const& lease : leases) {
+        PsqlBindArray bind_array;
+        bind(ctx, lease, bind_array);
+        pipeline.add(tagged_statements[stindex], bind_array);
+    }
+
+    // Throws on the first failed statement: nothing was written then.
+    auto results = pipeline.execute();
+
+    auto lease = leases.begin();
+    for (auto const& r : results) {
+        int affected_rows = boost::lexical_cast<int>(PQcmdTuples(*r));
+        if (affected_rows == 0) {
+            not_written.push_back(*lease);
+        } else if (affected_rows > 1) {
+            // Should not happen - primary key constraint should only have
+            // selected one row.
+            isc_throw(DbOperationError, "apparently wrote more than one lease "
+                      "that had the address " << (*lease)->addr_.toText());
+        }
+        ++lease;
+    }
+
+    return (not_written);
+}
+
+Lease4Collection
+PgSqlLeaseMgr::addLeases(const Lease4Collection& leases) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_PGSQL_ADD_LEASES)
+        .arg(leases.size());
+
+    // The batch statement skips the existing leases instead of failing.
+    auto existing = writeLeasesCommon(leases, INSERT_LEASE4_BATCH,
+        [](PgSqlLeaseContextPtr& ctx, const Lease4Ptr& lease,
+           PsqlBindArray& bind_array) {
+            ctx->exchange4_->createBindForSend(lease, bind_array);
+        });
+
+    // Update leases current expiration time.
+    for (auto const& lease : leases) {
+        lease->updateCurrentExpirationTime();
+    }
+
+    return (existing);
+}
+
+Lease6Collection
+PgSqlLeaseMgr::addLeases(const Lease6Collection& leases) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_PGSQL_ADD_LEASES)
+        .arg(leases.size());
+
+    // The batch statement skips the existing leases instead of failing.
+    auto existing = writeLeasesCommon(leases, INSERT_LEASE6_BATCH,
+        [](PgSqlLeaseContextPtr& ctx, const Lease6Ptr& lease,
+           PsqlBindArray& bind_array) {
+            ctx->exchange6_->createBindForSend(lease, bind_array);
+        });
+
+    // Update leases current expiration time.
+    for (auto const& lease : leases) {
+        lease->updateCurrentExpirationTime();
+    }
+
+    return (existing);
+}
+
+Lease4Collection
+PgSqlLeaseMgr::updateLeases4(const Lease4Collection& leases) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_PGSQL_UPDATE_LEASES)
+        .arg(leases.size());
+
+    auto missing_list = writeLeasesCommon(leases, UPDATE_LEASE4,
+        [](PgSqlLeaseContextPtr& ctx, const Lease4Ptr& lease,
+           PsqlBindArray& bind_array) {
+            ctx->exchange4_->createBindForSend(lease, bind_array);
+            bindLeaseKey(lease, bind_array);
+        });
+
+    // Update current expiration time of updated leases.
+    std::set<Lease4Ptr> missing(missing_list.begin(), missing_list.end());
+    for (auto const& lease : leases) {
+        if (!missing.count(lease)) {
+            lease->updateCurrentExpirationTime();
+        }
+    }
+
+    return (missing_list);
+}
+
+Lease6Collection
+PgSqlLeaseMgr::updateLeases6(const Lease6Collection& leases) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_PGSQL_UPDATE_LEASES)
+        .arg(leases.size());
+
+    auto missing_list = writeLeasesCommon(leases, UPDATE_LEASE6,
+        [](PgSqlLeaseContextPtr& ctx, const Lease6Ptr& lease,
+           PsqlBindArray& bind_array) {
+            ctx->exchange6_->createBindForSend(lease, bind_array);
+            bindLeaseKey(lease, bind_array);
+        });
+
+    // Update current expiration time of updated leases.
+    std::set<Lease6Ptr> missing(missing_list.begin(), missing_list.end());
+    for (auto const& lease : leases) {
+        if (!missing.count(lease)) {
+            lease->updateCurrentExpirationTime();
+        }
+    }
+
+    return (missing_list);
+}
+
+Lease4Collection
+PgSqlLeaseMgr::deleteLeases(const Lease4Collection& leases) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_PGSQL_DELETE_LEASES)
+        .arg(leases.size());
+
+    return (writeLeasesCommon(leases, DELETE_LEASE4,
+        [](PgSqlLeaseContextPtr&, const Lease4Ptr& lease,
+           PsqlBindArray& bind_array) {
+            bindLeaseKey(lease, bind_array);
+        }));
+}
+
+Lease6Collection
+PgSqlLeaseMgr::deleteLeases(const Lease6Collection& leases) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_PGSQL_DELETE_LEASES)
+        .arg(leases.size());
+
+    return (writeLeasesCommon(leases, DELETE_LEASE6,
+        [](PgSqlLeaseContextPtr&, const Lease6Ptr& lease,
+           PsqlBindArray& bind_array) {
+            bindLeaseKey(lease, bind_array);
+        }));
+}
+
 uint64_t
 PgSqlLeaseMgr::deleteExpiredReclaimedLeases4(const uint32_t secs) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_PGSQL_DELETE_EXPIRED_RECLAIMED4)
@@ -2271,8 +2536,12 @@ PgSqlLeaseMgr::deleteExpiredReclaimedLeasesCommon(const uint32_t secs,
         static_cast<time_t>(secs));
     bind_array.add(expiration_str);
 
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(*this);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
     // Delete leases.
-    return (deleteLeaseCommon(statement_index, bind_array));
+    return (deleteLeaseCommon(ctx, statement_index, bind_array));
 }
 
 LeaseStatsQueryPtr
@@ -1,4 +1,4 @@
-// Copyright (C) 2013-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2013-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -509,6 +509,82 @@ public:
     /// different expiration time.
     virtual bool deleteLease(const Lease6Ptr& lease);
 
+    /// @brief Adds a batch of IPv4 leases.
+    ///
+    /// The leases are added in a single transaction.
+    ///
+    /// @param leases The leases to be added.
+    ///
+    /// @return The leases which were not added because they already exist.
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed: no lease was added.
+    virtual Lease4Collection addLeases(const Lease4Collection& leases);
+
+    /// @brief Adds a batch of IPv6 leases.
+    ///
+    /// The leases are added in a single transaction.
+    ///
+    /// @param leases The leases to be added.
+    ///
+    /// @return The leases which were not added because they already exist.
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed: no lease was added.
+    virtual Lease6Collection addLeases(const Lease6Collection& leases);
+
+    /// @brief Updates a batch of IPv4 leases.
+    ///
+    /// The leases are updated in a single transaction.
+    ///
+    /// @param leases The leases to be updated.
+    ///
+    /// @return The leases which were not updated because they do not exist
+    /// or their expiration time was changed in the database.
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed: no lease was updated.
+    virtual Lease4Collection updateLeases4(const Lease4Collection& leases);
+
+    /// @brief Updates a batch of IPv6 leases.
+    ///
+    /// The leases are updated in a single transaction.
+    ///
+    /// @param leases The leases to be updated.
+    ///
+    /// @return The leases which were not updated because they do not exist
+    /// or their expiration time was changed in the database.
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed: no lease was updated.
+    virtual Lease6Collection updateLeases6(const Lease6Collection& leases);
+
+    /// @brief Deletes a batch of IPv4 leases.
+    ///
+    /// The leases are deleted in a single transaction.
+    ///
+    /// @param leases The leases to be deleted.
+    ///
+    /// @return The leases which were not deleted because they do not exist
+    /// or their expiration time was changed in the database.
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed: no lease was deleted.
+    virtual Lease4Collection deleteLeases(const Lease4Collection& leases);
+
+    /// @brief Deletes a batch of IPv6 leases.
+    ///
+    /// The leases are deleted in a single transaction.
+    ///
+    /// @param leases The leases to be deleted.
+    ///
+    /// @return The leases which were not deleted because they do not exist
+    /// or their expiration time was changed in the database.
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed: no lease was deleted.
+    virtual Lease6Collection deleteLeases(const Lease6Collection& leases);
+
     /// @brief Deletes all expired-reclaimed DHCPv4 leases.
     ///
     /// @param secs Number of seconds since expiration of leases before
@@ -691,6 +767,8 @@ public:
         GET_LEASE6_EXPIRE,           // Get lease6 by expiration.
         INSERT_LEASE4,               // Add entry to lease4 table
         INSERT_LEASE6,               // Add entry to lease6 table
+        INSERT_LEASE4_BATCH,         // Add entry to lease4 table if absent
+        INSERT_LEASE6_BATCH,         // Add entry to lease6 table if absent
         UPDATE_LEASE4,               // Update a Lease4 entry
         UPDATE_LEASE6,               // Update a Lease6 entry
         ALL_LEASE4_STATS,            // Fetches IPv4 lease statistics
@@ -876,6 +954,7 @@ private:
     /// to the prepared statement, executes the statement and checks to
     /// see how many rows were deleted.
     ///
+    /// @param ctx Context
     /// @param stindex Index of prepared statement to be executed
     /// @param bind_array Array containing lease values and where clause
     /// parameters for the delete
@@ -884,9 +963,104 @@ private:
     ///
     /// @throw isc::db::DbOperationError An operation on the open database has
     ///        failed.
-    uint64_t deleteLeaseCommon(StatementIndex stindex,
+    uint64_t deleteLeaseCommon(PgSqlLeaseContextPtr& ctx,
+                               StatementIndex stindex,
                                db::PsqlBindArray& bind_array);
 
+    /// @brief Adds an IPv4 lease using a given context.
+    ///
+    /// @param ctx Context
+    /// @param lease The lease to be added.
+    ///
+    /// @return true if the lease was added, false if it already exists.
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed.
+    bool addLeaseInternal(PgSqlLeaseContextPtr& ctx, const Lease4Ptr& lease);
+
+    /// @brief Adds an IPv6 lease using a given context.
+    ///
+    /// @param ctx Context
+    /// @param lease The lease to be added.
+    ///
+    /// @return true if the lease was added, false if it already exists.
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed.
+    bool addLeaseInternal(PgSqlLeaseContextPtr& ctx, const Lease6Ptr& lease);
+
+    /// @brief Updates an IPv4 lease using a given context.
+    ///
+    /// The current expiration time of the lease is not updated.
+    ///
+    /// @param ctx Context
+    /// @param lease The lease to be updated.
+    ///
+    /// @throw NoSuchLease Could not update a lease because no lease matches
+    ///        the address and expiration time given.
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed.
+    void updateLeaseInternal(PgSqlLeaseContextPtr& ctx, const Lease4Ptr& lease);
+
+    /// @brief Updates an IPv6 lease using a given context.
+    ///
+    /// The current expiration time of the lease is not updated.
+    ///
+    /// @param ctx Context
+    /// @param lease The lease to be updated.
+    ///
+    /// @throw NoSuchLease Could not update a lease because no lease matches
+    ///        the address and expiration time given.
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed.
+    void updateLeaseInternal(PgSqlLeaseContextPtr& ctx, const Lease6Ptr& lease);
+
+    /// @brief Deletes an IPv4 lease using a given context.
+    ///
+    /// @param ctx Context
+    /// @param lease The lease to be deleted.
+    ///
+    /// @return true if the lease was deleted, false if no such lease exists.
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed.
+    bool deleteLeaseInternal(PgSqlLeaseContextPtr& ctx, const Lease4Ptr& lease);
+
+    /// @brief Deletes an IPv6 lease using a given context.
+    ///
+    /// @param ctx Context
+    /// @param lease The lease to be deleted.
+    ///
+    /// @return true if the lease was deleted, false if no such lease exists.
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed.
+    bool deleteLeaseInternal(PgSqlLeaseContextPtr& ctx, const Lease6Ptr& lease);
+
+    /// @brief Batch of lease writes common code
+    ///
+    /// Executes a statement per lease of a batch on one connection in
+    /// pipeline mode (see @c isc::db::PgSqlPipeline): the statements are
+    /// sent in a single round trip and executed in an implicit transaction,
+    /// so nothing is written when one of them fails.
+    ///
+    /// @tparam LeaseCollection One of the @c Lease4Collection or
+    ///         @c Lease6Collection.
+    /// @tparam BindFunction Type of the function binding a lease.
+    /// @param leases The leases to be written.
+    /// @param stindex Index of the statement executed for each lease.
+    /// @param bind Function filling the bind array of a lease using a
+    ///        context.
+    ///
+    /// @return The leases for which the statement affected no row.
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed.
+    template <typename LeaseCollection, typename BindFunction>
+    LeaseCollection writeLeasesCommon(const LeaseCollection& leases,
+                                      StatementIndex stindex,
+                                      BindFunction bind);
+
     /// @brief Delete expired-reclaimed leases.
     ///
     /// @param secs Number of seconds since expiration of leases before
@@ -964,6 +964,27 @@ public:
         return (reservations_lookup_first_);
     }
 
+    /// @brief Sets the configuration from which this configuration was
+    /// parsed.
+    ///
+    /// This is the configuration with default and derived values. It is
+    /// used by the next reconfiguration to find the unchanged subnets,
+    /// shared networks and client classes, which are reused instead of
+    /// being parsed again.
+    ///
+    /// @param parsed_config the parsed configuration.
+    void setParsedConfig(const isc::data::ConstElementPtr& parsed_config) {
+        parsed_config_ = parsed_config;
+    }
+
+    /// @brief Returns the configuration from which this configuration
+    /// was parsed.
+    ///
+    /// @return the parsed configuration or null.
+    isc::data::ConstElementPtr getParsedConfig() const {
+        return (parsed_config_);
+    }
+
     /// @brief Unparse a configuration object
     ///
     /// @return a pointer to unparsed configuration
@@ -1156,6 +1177,9 @@ private:
     /// reservations lookup is always performed first.
     /// It default to false when multi-threading is disabled.
     bool reservations_lookup_first_;
+
+    /// @brief The configuration from which this configuration was parsed.
+    isc::data::ConstElementPtr parsed_config_;
 };
 
 /// @name Pointers to the @c SrvConfig object.
@@ -1,4 +1,4 @@
-// Copyright (C) 2020-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2020-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -112,6 +112,64 @@ TEST_F(CfgMultiThreadingTest, apply) {
     EXPECT_EQ(MultiThreadingMgr::instance().getThreadPoolSize(), 4);
     EXPECT_EQ(MultiThreadingMgr::instance().getPacketQueueSize(), 64);
     EXPECT_EQ(MultiThreadingMgr::instance().getThreadPool().getMaxQueueSize(), 64);
+    EXPECT_FALSE(MultiThreadingMgr::instance().getWorkStealing());
+    EXPECT_FALSE(MultiThreadingMgr::instance().getThreadPool().getWorkStealing());
+}
+
+/// @brief Verifies that applying the work stealing setting works
+TEST_F(CfgMultiThreadingTest, applyWorkStealing) {
+    std::string content_json =
+        "{"
+        "    \"enable-multi-threading\": true,\n"
+        "    \"thread-pool-size\": 4,\n"
+        "    \"work-stealing\": true\n"
+        "}";
+    ConstElementPtr param;
+    ASSERT_NO_THROW(param = Element::fromJSON(content_json))
+                            << "invalid context_json, test is broken";
+    CfgMultiThreading::apply(param);
+    EXPECT_TRUE(MultiThreadingMgr::instance().getMode());
+    EXPECT_TRUE(MultiThreadingMgr::instance().getWorkStealing());
+    EXPECT_TRUE(MultiThreadingMgr::instance().getThreadPool().getWorkStealing());
+    EXPECT_EQ(MultiThreadingMgr::instance().getThreadPool().size(), 4);
+
+    // The default is one queue.
+    content_json = "{ \"enable-multi-threading\": true, \"thread-pool-size\": 4 }";
+    ASSERT_NO_THROW(param = Element::fromJSON(content_json))
+                            << "invalid context_json, test is broken";
+    CfgMultiThreading::apply(param);
+    EXPECT_FALSE(MultiThreadingMgr::instance().getWorkStealing());
+    EXPECT_FALSE(MultiThreadingMgr::instance().getThreadPool().getWorkStealing());
+}
+
+/// @brief Verifies that the worker CPU set is applied.
+TEST_F(CfgMultiThreadingTest, applyCpuSet) {
+    std::string content_json =
+        "{"
+        "    \"enable-multi-threading\": true,\n"
+        "    \"thread-pool-size\": 2,\n"
+        "    \"worker-cpu-set\": \"0\",\n"
+        "    \"receiver-cpu-set\": \"0-1\"\n"
+        "}";
+    ConstElementPtr param;
+    ASSERT_NO_THROW(param = Element::fromJSON(content_json))
+                            << "invalid context_json, test is broken";
+    CfgMultiThreading::apply(param);
+    EXPECT_TRUE(MultiThreadingMgr::instance().getMode());
+    EXPECT_EQ(CpuSet({ 0 }), MultiThreadingMgr::instance().getCpuSet());
+    EXPECT_EQ(CpuSet({ 0 }), MultiThreadingMgr::instance().getThreadPool().getCpuSet());
+    EXPECT_EQ(MultiThreadingMgr::instance().getThreadPool().size(), 2);
+    EXPECT_EQ(CpuSet({ 0, 1 }),
+              CfgMultiThreading::extractCpuSet(param, "receiver-cpu-set"));
+
+    // The default is to not pin the threads.
+    content_json = "{ \"enable-multi-threading\": true, \"thread-pool-size\": 2 }";
+    ASSERT_NO_THROW(param = Element::fromJSON(content_json))
+                            << "invalid context_json, test is broken";
+    CfgMultiThreading::apply(param);
+    EXPECT_TRUE(MultiThreadingMgr::instance().getCpuSet().empty());
+    EXPECT_TRUE(MultiThreadingMgr::instance().getThreadPool().getCpuSet().empty());
+    EXPECT_TRUE(CfgMultiThreading::extractCpuSet(param, "receiver-cpu-set").empty());
 }
 
 }  // namespace
@@ -568,6 +568,100 @@ TEST_F(CfgMgrTest, revert) {
     EXPECT_EQ(12, cfg_mgr.getCurrentCfg()->getLoggingInfo()[0].debuglevel_);
 }
 
+// This test verifies that the thread snapshots of the current configuration
+// follow commit, revert and clear.
+TEST_F(CfgMgrTest, currentCfgSnapshot) {
+    CfgMgr& cfg_mgr = CfgMgr::instance();
+    // The snapshot is the current configuration.
+    SrvConfigPtr current = cfg_mgr.getCurrentCfg();
+    ASSERT_TRUE(current);
+    EXPECT_EQ(current, cfg_mgr.getCurrentCfgSnapshot());
+    // The snapshot does not copy the shared pointer.
+    long use_count = current.use_count();
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_EQ(current, cfg_mgr.getCurrentCfgSnapshot());
+    }
+    EXPECT_EQ(use_count, current.use_count());
+
+    // The snapshot follows the commit.
+    SrvConfigPtr staging = cfg_mgr.getStagingCfg();
+    EXPECT_EQ(current, cfg_mgr.getCurrentCfgSnapshot());
+    cfg_mgr.commit();
+    EXPECT_EQ(staging, cfg_mgr.getCurrentCfg());
+    EXPECT_EQ(staging, cfg_mgr.getCurrentCfgSnapshot());
+
+    // The snapshot follows the revert.
+    ASSERT_NO_THROW(cfg_mgr.revert(1));
+    EXPECT_EQ(cfg_mgr.getCurrentCfg(), cfg_mgr.getCurrentCfgSnapshot());
+    EXPECT_NE(staging, cfg_mgr.getCurrentCfgSnapshot());
+
+    // The snapshot follows the clear: a new default configuration
+    // is created by the clear.
+    SrvConfigPtr old = cfg_mgr.getCurrentCfgSnapshot();
+    cfg_mgr.clear();
+    SrvConfigPtr cleared = cfg_mgr.getCurrentCfgSnapshot();
+    ASSERT_TRUE(cleared);
+    EXPECT_NE(old, cleared);
+    EXPECT_EQ(0, cleared->getSequence());
+    EXPECT_EQ(cfg_mgr.getCurrentCfg(), cleared);
+
+    // Other threads have their own snapshot which is released when they exit.
+    SrvConfigPtr other;
+    std::thread thread([&cfg_mgr, &other]() {
+        other = cfg_mgr.getCurrentCfgSnapshot();
+    });
+    thread.join();
+    EXPECT_EQ(cleared, other);
+    other.reset();
+    staging = cfg_mgr.getStagingCfg();
+    cfg_mgr.commit();
+    // The old configuration is held by the history, by this test and
+    // by the snapshot of this thread until it is updated.
+    EXPECT_EQ(3, cleared.use_count());
+    EXPECT_EQ(staging, cfg_mgr.getCurrentCfgSnapshot());
+    EXPECT_EQ(2, cleared.use_count());
+}
+
+// This test verifies that a pinned snapshot does not follow the changes
+// of the current configuration.
+TEST_F(CfgMgrTest, currentCfgSnapshotPin) {
+    CfgMgr& cfg_mgr = CfgMgr::instance();
+    SrvConfigPtr current = cfg_mgr.getCurrentCfg();
+    SrvConfigPtr staging;
+    {
+        CfgSnapshotPin pin;
+        const SrvConfigPtr& pinned = cfg_mgr.getCurrentCfgSnapshot();
+        EXPECT_EQ(current, pinned);
+
+        // The pinned snapshot is kept after the commit and the reference
+        // to it remains valid.
+        staging = cfg_mgr.getStagingCfg();
+        cfg_mgr.commit();
+        EXPECT_EQ(staging, cfg_mgr.getCurrentCfg());
+        EXPECT_EQ(current, cfg_mgr.getCurrentCfgSnapshot());
+        EXPECT_EQ(&pinned, &cfg_mgr.getCurrentCfgSnapshot());
+        EXPECT_EQ(current, pinned);
+
+        // Including by nested pins.
+        {
+            CfgSnapshotPin nested;
+            EXPECT_EQ(current, cfg_mgr.getCurrentCfgSnapshot());
+        }
+        EXPECT_EQ(current, cfg_mgr.getCurrentCfgSnapshot());
+
+        // Other threads see the new configuration.
+        SrvConfigPtr other;
+        std::thread thread([&cfg_mgr, &other]() {
+            other = cfg_mgr.getCurrentCfgSnapshot();
+        });
+        thread.join();
+        EXPECT_EQ(staging, other);
+    }
+
+    // The snapshot is refreshed once unpinned.
+    EXPECT_EQ(staging, cfg_mgr.getCurrentCfgSnapshot());
+}
+
 // This test verifies that the address family can be set and obtained
 // from the configuration manager.
 TEST_F(CfgMgrTest, family) {
@@ -8,8 +8,10 @@
 #include <cc/data.h>
 #include <dhcpsrv/client_class_def.h>
 #include <dhcpsrv/cfgmgr.h>
+#include <dhcp/dhcp4.h>
 #include <dhcp/libdhcp++.h>
 #include <dhcp/option_space.h>
+#include <dhcp/pkt4.h>
 #include <testutils/test_to_element.h>
 #include <exceptions/exceptions.h>
 #include <boost/scoped_ptr.hpp>
@@ -97,6 +99,9 @@ TEST(ClientClassDef, copyConstruction) {
     EXPECT_EQ("my-context", cclass_copy->getContext()->stringValue());
     ASSERT_TRUE(cclass->getMatchExpr());
     EXPECT_NE(cclass_copy->getMatchExpr(), cclass->getMatchExpr());
+    ASSERT_TRUE(cclass_copy->getCompiledMatchExpr());
+    EXPECT_NE(cclass_copy->getCompiledMatchExpr(),
+              cclass->getCompiledMatchExpr());
     EXPECT_EQ(cclass->getTest(), cclass_copy->getTest());
     EXPECT_EQ(cclass->getRequired(), cclass_copy->getRequired());
     EXPECT_EQ(cclass->getDependOnKnown(), cclass_copy->getDependOnKnown());
@@ -309,6 +314,77 @@ TEST(ClientClassDef, dependency) {
 }
 
 
+// Tests the evaluation of the match expression and its statistics.
+TEST(ClientClassDef, evaluateMatchExpr) {
+    // option[60].exists
+    ExpressionPtr expr(new Expression());
+    expr->push_back(TokenPtr(new TokenOption(60, TokenOption::EXISTS)));
+    ClientClassDef cclass("class", expr);
+    ASSERT_TRUE(cclass.getCompiledMatchExpr());
+
+    // The statistics are collected only when enabled.
+    EXPECT_FALSE(ClientClassDef::getEvalStatsEnabled());
+    ClientClassDef::setEvalStatsEnabled(true);
+
+    // Option 60 is not in the packet: the evaluation is skipped.
+    Pkt4 pkt(DHCPDISCOVER, 1234);
+    EXPECT_FALSE(cclass.evaluateMatchExpr(pkt));
+
+    OptionPtr opt(new Option(Option::V4, 60, OptionBuffer(1, 0x41)));
+    pkt.addOption(opt);
+    EXPECT_TRUE(cclass.evaluateMatchExpr(pkt));
+
+    // An expression which does not return a boolean.
+    ExpressionPtr bad_expr(new Expression());
+    bad_expr->push_back(TokenPtr(new TokenString("foo")));
+    ClientClassDef bad_class("bad", bad_expr);
+    EXPECT_THROW(bad_class.evaluateMatchExpr(pkt), EvalTypeError);
+
+    ElementPtr stats = cclass.getEvalStats();
+    ASSERT_TRUE(stats);
+    EXPECT_EQ("class", stats->get("name")->stringValue());
+    EXPECT_EQ(1, stats->get("evaluations")->intValue());
+    EXPECT_EQ(1, stats->get("matches")->intValue());
+    EXPECT_EQ(1, stats->get("skipped")->intValue());
+    EXPECT_EQ(0, stats->get("errors")->intValue());
+    EXPECT_LE(0, stats->get("evaluation-time")->intValue());
+
+    stats = bad_class.getEvalStats();
+    EXPECT_EQ(1, stats->get("evaluations")->intValue());
+    EXPECT_EQ(0, stats->get("matches")->intValue());
+    EXPECT_EQ(1, stats->get("errors")->intValue());
+
+    // Nothing is counted once the collection is disabled.
+    ClientClassDef::setEvalStatsEnabled(false);
+    EXPECT_TRUE(cclass.evaluateMatchExpr(pkt));
+    pkt.delOption(60);
+    EXPECT_FALSE(cclass.evaluateMatchExpr(pkt));
+    stats = cclass.getEvalStats();
+    EXPECT_EQ(1, stats->get("evaluations")->intValue());
+    EXPECT_EQ(1, stats->get("matches")->intValue());
+    EXPECT_EQ(1, stats->get("skipped")->intValue());
+
+    // Counters are not copied.
+    ClientClassDef copy(cclass);
+    EXPECT_EQ(0, copy.getEvalStats()->get("evaluations")->intValue());
+
+    // Classes without match expression never match.
+    ClientClassDef no_expr("none", ExpressionPtr());
+    EXPECT_FALSE(no_expr.getCompiledMatchExpr());
+    EXPECT_FALSE(no_expr.evaluateMatchExpr(pkt));
+
+    // The dictionary returns the statistics of classes with an expression.
+    ClientClassDictionary dictionary;
+    ClientClassDefPtr class_copy(new ClientClassDef(cclass));
+    dictionary.addClass(class_copy);
+    ClientClassDefPtr no_expr_copy(new ClientClassDef(no_expr));
+    dictionary.addClass(no_expr_copy);
+    ElementPtr all_stats = dictionary.getEvalStats();
+    ASSERT_TRUE(all_stats);
+    ASSERT_EQ(1, all_stats->size());
+    EXPECT_EQ("class", all_stats->get(0)->get("name")->stringValue());
+}
+
 // Tests the basic operation of ClientClassDictionary
 // This includes adding, finding, and removing classes
 TEST(ClientClassDictionary, basics) {
@@ -570,6 +646,15 @@ TEST(ClientClassDictionary, initMatchExpr) {
 
     EXPECT_TRUE(classes[2]->getMatchExpr());
     EXPECT_EQ(6, classes[2]->getMatchExpr()->size());
+
+    // Ensure that the expressions were compiled.
+    for (auto c : classes) {
+        ASSERT_TRUE(c->getCompiledMatchExpr());
+        EXPECT_EQ(c->getMatchExpr()->size(),
+                  c->getCompiledMatchExpr()->getExpression().size());
+    }
+    EXPECT_TRUE(classes[1]->getCompiledMatchExpr()->isCompiled());
+    EXPECT_TRUE(classes[2]->getCompiledMatchExpr()->isCompiled());
 }
 
 // Tests that an error is returned when any of the test expressions is
@@ -595,6 +680,7 @@ TEST(ClientClassDictionary, initMatchExprError) {
     // Ensure that no classes have their match expressions modified.
     for (auto c : (*dictionary->getClasses())) {
         EXPECT_FALSE(c->getMatchExpr());
+        EXPECT_FALSE(c->getCompiledMatchExpr());
     }
 }
 
@@ -3069,6 +3069,95 @@ TEST_F(ParseConfigTest, defaultSharedNetwork6) {
     EXPECT_FALSE(network->getDdnsUseConflictResolution().get());
 }
 
+// This test verifies that the subnets list parser reuses the unchanged
+// subnets of the previous configuration and parses their host reservations.
+TEST_F(ParseConfigTest, reuseSubnets4) {
+    ConstElementPtr previous_list = Element::fromJSON(
+        "[ { \"subnet\": \"192.0.2.0/24\", \"id\": 10 },"
+        "  { \"subnet\": \"192.0.3.0/24\", \"id\": 20 },"
+        "  { \"subnet\": \"192.0.4.0/24\", \"id\": 0 } ]");
+    SrvConfigPtr previous_cfg(new SrvConfig());
+    Subnets4ListConfigParser parser;
+    ASSERT_NO_THROW(parser.parse(previous_cfg, previous_list));
+    CfgSubnets4Ptr previous = previous_cfg->getCfgSubnets4();
+    ASSERT_EQ(3, previous->getAll()->size());
+
+    // The first subnet only gets a host reservation, the second one is
+    // changed and the third one has no explicit identifier.
+    ConstElementPtr subnets_list = Element::fromJSON(
+        "[ { \"subnet\": \"192.0.2.0/24\", \"id\": 10,"
+        "    \"reservations\": [ { \"hw-address\": \"aa:bb:cc:dd:ee:ff\","
+        "                          \"ip-address\": \"192.0.2.10\" } ] },"
+        "  { \"subnet\": \"192.0.3.0/24\", \"id\": 20,"
+        "    \"valid-lifetime\": 100 },"
+        "  { \"subnet\": \"192.0.4.0/24\", \"id\": 0 } ]");
+    Subnet::resetSubnetID();
+    SrvConfigPtr cfg(new SrvConfig());
+    ASSERT_NO_THROW(parser.parse(cfg, subnets_list, previous_list, previous));
+    CfgSubnets4Ptr subnets = cfg->getCfgSubnets4();
+    ASSERT_EQ(3, subnets->getAll()->size());
+
+    EXPECT_EQ(previous->getSubnet(10), subnets->getSubnet(10));
+    EXPECT_EQ(1, CfgMgr::instance().getStagingCfg()->getCfgHosts()->
+              getAll4(SubnetID(10)).size());
+
+    ASSERT_TRUE(subnets->getSubnet(20));
+    EXPECT_NE(previous->getSubnet(20), subnets->getSubnet(20));
+    EXPECT_EQ(100, subnets->getSubnet(20)->getValid().get());
+
+    ASSERT_TRUE(subnets->getByPrefix("192.0.4.0/24"));
+    EXPECT_NE(previous->getByPrefix("192.0.4.0/24"),
+              subnets->getByPrefix("192.0.4.0/24"));
+
+    // The host reservations of a reused subnet are still verified.
+    subnets_list = Element::fromJSON(
+        "[ { \"subnet\": \"192.0.2.0/24\", \"id\": 10,"
+        "    \"reservations\": [ { \"hw-address\": \"aa:bb:cc:dd:ee:01\","
+        "                          \"ip-address\": \"192.0.5.10\" } ] } ]");
+    cfg.reset(new SrvConfig());
+    EXPECT_THROW(parser.parse(cfg, subnets_list, previous_list, previous),
+                 DhcpConfigError);
+}
+
+// This test verifies that the shared networks list parser reuses the
+// unchanged shared networks with their subnets.
+TEST_F(ParseConfigTest, reuseSharedNetworks6) {
+    ConstElementPtr previous_list = Element::fromJSON(
+        "[ { \"name\": \"bird\","
+        "    \"subnet6\": [ { \"subnet\": \"2001:db8:1::/64\", \"id\": 1 } ] },"
+        "  { \"name\": \"monkey\" },"
+        "  { \"name\": \"frog\","
+        "    \"subnet6\": [ { \"subnet\": \"2001:db8:2::/64\", \"id\": 0 } ] } ]");
+    CfgSharedNetworks6Ptr previous(new CfgSharedNetworks6());
+    SharedNetworks6ListParser parser;
+    ASSERT_NO_THROW(parser.parse(previous, previous_list));
+
+    // The first network only gets a host reservation, the second one
+    // is changed and the third one has a subnet without identifier.
+    ConstElementPtr networks_list = Element::fromJSON(
+        "[ { \"name\": \"bird\","
+        "    \"subnet6\": [ { \"subnet\": \"2001:db8:1::/64\", \"id\": 1,"
+        "                     \"reservations\": [ { \"duid\": \"01:02:03:04\","
+        "                                           \"ip-addresses\": [ \"2001:db8:1::10\" ] } ] } ] },"
+        "  { \"name\": \"monkey\", \"valid-lifetime\": 100 },"
+        "  { \"name\": \"frog\","
+        "    \"subnet6\": [ { \"subnet\": \"2001:db8:2::/64\", \"id\": 0 } ] } ]");
+    Subnet::resetSubnetID();
+    CfgSharedNetworks6Ptr cfg(new CfgSharedNetworks6());
+    ASSERT_NO_THROW(parser.parse(cfg, networks_list, previous_list, previous));
+
+    ASSERT_TRUE(cfg->getByName("bird"));
+    EXPECT_EQ(previous->getByName("bird"), cfg->getByName("bird"));
+    EXPECT_EQ(1, CfgMgr::instance().getStagingCfg()->getCfgHosts()->
+              getAll6(SubnetID(1)).size());
+
+    ASSERT_TRUE(cfg->getByName("monkey"));
+    EXPECT_NE(previous->getByName("monkey"), cfg->getByName("monkey"));
+
+    ASSERT_TRUE(cfg->getByName("frog"));
+    EXPECT_NE(previous->getByName("frog"), cfg->getByName("frog"));
+}
+
 // There's no test for ControlSocketParser, as it is tested in the DHCPv4 code
 // (see CtrlDhcpv4SrvTest.commandSocketBasic in
 // src/bin/dhcp4/tests/ctrl_dhcp4_srv_unittest.cc).
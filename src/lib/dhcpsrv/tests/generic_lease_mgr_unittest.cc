@@ -1,4 +1,4 @@
-// Copyright (C) 2014-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2014-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -1844,6 +1844,106 @@ GenericLeaseMgrTest::testUpdateLease4() {
     EXPECT_THROW(lmptr_->updateLease4(leases[2]), isc::dhcp::NoSuchLease);
 }
 
+void
+GenericLeaseMgrTest::testBatchLeases4() {
+    vector<Lease4Ptr> leases = createLeases4();
+
+    // Empty batches do nothing.
+    EXPECT_TRUE(lmptr_->addLeases(Lease4Collection()).empty());
+    EXPECT_TRUE(lmptr_->updateLeases4(Lease4Collection()).empty());
+    EXPECT_TRUE(lmptr_->deleteLeases(Lease4Collection()).empty());
+
+    // Add a lease and then a batch including it: it is reported as
+    // already existing and the others are added.
+    EXPECT_TRUE(lmptr_->addLease(leases[1]));
+    Lease4Collection batch(leases.begin(), leases.begin() + 4);
+    Lease4Collection not_written;
+    ASSERT_NO_THROW(not_written = lmptr_->addLeases(batch));
+    ASSERT_EQ(1, not_written.size());
+    EXPECT_EQ(leases[1], not_written[0]);
+    for (size_t i = 0; i < 4; ++i) {
+        Lease4Ptr l_returned = lmptr_->getLease4(ioaddress4_[i]);
+        ASSERT_TRUE(l_returned) << "lease " << i;
+        detailCompareLease(leases[i], l_returned);
+    }
+
+    // Modify the leases and update them with a lease which is not in the
+    // database: this lease is reported as missing.
+    for (auto const& lease : batch) {
+        ++lease->subnet_id_;
+        lease->hostname_ = "modified.hostname.";
+    }
+    batch.push_back(leases[5]);
+    ASSERT_NO_THROW(not_written = lmptr_->updateLeases4(batch));
+    ASSERT_EQ(1, not_written.size());
+    EXPECT_EQ(leases[5], not_written[0]);
+    for (size_t i = 0; i < 4; ++i) {
+        Lease4Ptr l_returned = lmptr_->getLease4(ioaddress4_[i]);
+        ASSERT_TRUE(l_returned) << "lease " << i;
+        detailCompareLease(leases[i], l_returned);
+    }
+    EXPECT_FALSE(lmptr_->getLease4(ioaddress4_[5]));
+
+    // Delete the leases: the lease which is not in the database is
+    // reported as missing.
+    ASSERT_NO_THROW(not_written = lmptr_->deleteLeases(batch));
+    ASSERT_EQ(1, not_written.size());
+    EXPECT_EQ(leases[5], not_written[0]);
+    for (size_t i = 0; i < 4; ++i) {
+        EXPECT_FALSE(lmptr_->getLease4(ioaddress4_[i])) << "lease " << i;
+    }
+}
+
+void
+GenericLeaseMgrTest::testBatchLeases6() {
+    vector<Lease6Ptr> leases = createLeases6();
+
+    // Empty batches do nothing.
+    EXPECT_TRUE(lmptr_->addLeases(Lease6Collection()).empty());
+    EXPECT_TRUE(lmptr_->updateLeases6(Lease6Collection()).empty());
+    EXPECT_TRUE(lmptr_->deleteLeases(Lease6Collection()).empty());
+
+    // Add a lease and then a batch including it: it is reported as
+    // already existing and the others are added.
+    EXPECT_TRUE(lmptr_->addLease(leases[1]));
+    Lease6Collection batch(leases.begin(), leases.begin() + 4);
+    Lease6Collection not_written;
+    ASSERT_NO_THROW(not_written = lmptr_->addLeases(batch));
+    ASSERT_EQ(1, not_written.size());
+    EXPECT_EQ(leases[1], not_written[0]);
+    for (size_t i = 0; i < 4; ++i) {
+        Lease6Ptr l_returned = lmptr_->getLease6(leasetype6_[i], ioaddress6_[i]);
+        ASSERT_TRUE(l_returned) << "lease " << i;
+        detailCompareLease(leases[i], l_returned);
+    }
+
+    // Modify the leases and update them with a lease which is not in the
+    // database: this lease is reported as missing.
+    for (auto const& lease : batch) {
+        ++lease->subnet_id_;
+        lease->hostname_ = "modified.hostname.";
+    }
+    batch.push_back(leases[5]);
+    ASSERT_NO_THROW(not_written = lmptr_->updateLeases6(batch));
+    ASSERT_EQ(1, not_written.size());
+    EXPECT_EQ(leases[5], not_written[0]);
+    for (size_t i = 0; i < 4; ++i) {
+        Lease6Ptr l_returned = lmptr_->getLease6(leasetype6_[i], ioaddress6_[i]);
+        ASSERT_TRUE(l_returned) << "lease " << i;
+        detailCompareLease(leases[i], l_returned);
+    }
+    EXPECT_FALSE(lmptr_->getLease6(leasetype6_[5], ioaddress6_[5]));
+
+    // Delete the leases: the lease which is not in the database is
+    // reported as missing.
+    ASSERT_NO_THROW(not_written = lmptr_->deleteLeases(batch));
+    ASSERT_EQ(1, not_written.size());
+    EXPECT_EQ(leases[5], not_written[0]);
+    for (size_t i = 0; i < 4; ++i) {
+        EXPECT_FALSE(lmptr_->getLease6(leasetype6_[i], ioaddress6_[i])) << "lease " << i;
+    }
+}
+
 void
 GenericLeaseMgrTest::testConcurrentUpdateLease4() {
     // Get the leases to be used for the test and add them to the database.
@@ -1,4 +1,4 @@
-// Copyright (C) 2014-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2014-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -339,6 +339,18 @@ public:
     /// the database.
     void testConcurrentUpdateLease6();
 
+    /// @brief IPv4 lease batch test
+    ///
+    /// Checks that the code is able to add, update and delete batches of
+    /// IPv4 leases and reports the leases which were not written.
+    void testBatchLeases4();
+
+    /// @brief IPv6 lease batch test
+    ///
+    /// Checks that the code is able to add, update and delete batches of
+    /// IPv6 leases and reports the leases which were not written.
+    void testBatchLeases6();
+
     /// @brief Check that the IPv6 lease can be added, removed and recreated.
     ///
     /// This test creates a lease, removes it and then recreates it with some
@@ -1,4 +1,4 @@
-// Copyright (C) 2014-2018,2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2014-2018,2021-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -17,9 +17,11 @@
 #include <dhcpsrv/parsers/dhcp_parsers.h>
 #include <dhcpsrv/parsers/host_reservation_parser.h>
 #include <dhcpsrv/parsers/host_reservations_list_parser.h>
+#include <dhcpsrv/parsers/parallel_parser.h>
 #include <testutils/test_to_element.h>
 #include <boost/algorithm/string.hpp>
 #include <gtest/gtest.h>
+#include <iomanip>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -75,6 +77,31 @@ HostReservationsListParserTest::SetUp() {
 void
 HostReservationsListParserTest::TearDown() {
     CfgMgr::instance().clear();
+    ParallelParser::setThreadCount(0);
+}
+
+/// @brief Returns a list of IPv4 host reservations.
+///
+/// @param count the number of reservations.
+/// @param first the index of the first reservation.
+/// @return the list in JSON format.
+std::string
+makeReservations4(size_t count, size_t first = 0) {
+    std::ostringstream config;
+    config << "[ ";
+    for (size_t i = first; i < first + count; ++i) {
+        if (i > first) {
+            config << ", ";
+        }
+        config << "{ \"hw-address\": \"01:02:03:04:"
+               << std::hex << std::setfill('0') << std::setw(2)
+               << ((i >> 8) & 0xff) << ":" << std::setw(2) << (i & 0xff)
+               << std::dec << "\", \"ip-address\": \"192.0."
+               << ((i >> 8) & 0xff) << "." << (i & 0xff)
+               << "\", \"hostname\": \"host" << i << ".example.com\" }";
+    }
+    config << " ]";
+    return (config.str());
 }
 
 /// @brief class of subnet_id reservations
@@ -385,4 +412,83 @@ TEST_F(HostReservationsListParserTest, duplicatedIdentifierValue6) {
     }
 }
 
+// This test verifies that a long list of host reservations is parsed
+// in parallel keeping the order of the reservations.
+TEST_F(HostReservationsListParserTest, longList4) {
+    CfgMgr::instance().setFamily(AF_INET);
+    ParallelParser::setThreadCount(4);
+    const size_t count = 4 * ParallelParser::MIN_PARALLEL_ITEMS;
+    ElementPtr config_element = Element::fromJSON(makeReservations4(count));
+
+    HostCollection hosts;
+    HostReservationsListParser<HostReservationParser4> parser;
+    ASSERT_NO_THROW(parser.parse(SubnetID(1), config_element, hosts));
+    ASSERT_EQ(count, hosts.size());
+    for (size_t i = 0; i < count; ++i) {
+        ASSERT_TRUE(hosts[i]);
+        std::ostringstream hostname;
+        hostname << "host" << i << ".example.com";
+        EXPECT_EQ(hostname.str(), hosts[i]->getHostname());
+        EXPECT_EQ(1, hosts[i]->getIPv4SubnetID());
+    }
+}
+
+// This test verifies that the error of the first invalid reservation of
+// a long list is reported.
+TEST_F(HostReservationsListParserTest, longListError4) {
+    CfgMgr::instance().setFamily(AF_INET);
+    ParallelParser::setThreadCount(4);
+    const size_t count = 4 * ParallelParser::MIN_PARALLEL_ITEMS;
+    ElementPtr config_element = Element::fromJSON(makeReservations4(count));
+    config_element->getNonConst(count / 2)->set("foo", Element::create(1));
+    config_element->getNonConst(count - 1)->set("bar", Element::create(1));
+
+    HostCollection hosts;
+    HostReservationsListParser<HostReservationParser4> parser;
+    try {
+        parser.parse(SubnetID(1), config_element, hosts);
+        ADD_FAILURE() << "parse did not throw";
+    } catch (const DhcpConfigError& ex) {
+        EXPECT_NE(std::string::npos,
+                  std::string(ex.what()).find("parameter 'foo'"))
+            << ex.what();
+    }
+}
+
+// This test verifies that the lists of several subnets are parsed
+// together and that the list with the first invalid reservation is
+// reported.
+TEST_F(HostReservationsListParserTest, severalLists4) {
+    CfgMgr::instance().setFamily(AF_INET);
+    ParallelParser::setThreadCount(4);
+    std::vector<SubnetID> subnet_ids;
+    std::vector<ConstElementPtr> lists;
+    for (size_t i = 0; i < 8; ++i) {
+        subnet_ids.push_back(SubnetID(i + 1));
+        lists.push_back(Element::fromJSON(makeReservations4(i * 100, i * 100)));
+    }
+
+    std::vector<HostCollection> hosts;
+    std::exception_ptr error;
+    HostReservationsListParser<HostReservationParser4> parser;
+    ASSERT_EQ(lists.size(), parser.parse(subnet_ids, lists, hosts, error));
+    EXPECT_FALSE(error);
+    ASSERT_EQ(lists.size(), hosts.size());
+    for (size_t i = 0; i < lists.size(); ++i) {
+        ASSERT_EQ(i * 100, hosts[i].size());
+        for (size_t j = 0; j < hosts[i].size(); ++j) {
+            EXPECT_EQ(i + 1, hosts[i][j]->getIPv4SubnetID());
+        }
+    }
+
+    // Break reservations of the 3rd and 6th lists.
+    ElementPtr list = boost::const_pointer_cast<Element>(lists[5]);
+    list->getNonConst(10)->set("bar", Element::create(1));
+    list = boost::const_pointer_cast<Element>(lists[2]);
+    list->getNonConst(150)->set("foo", Element::create(1));
+    EXPECT_EQ(2, parser.parse(subnet_ids, lists, hosts, error));
+    ASSERT_TRUE(error);
+    EXPECT_THROW(std::rethrow_exception(error), DhcpConfigError);
+}
+
 } // end of anonymous namespace
@@ -0,0 +1,169 @@
+// Copyright (C) 2022 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+#include <asiolink/io_address.h>
+#include <cc/data.h>
+#include <dhcp/duid.h>
+#include <dhcpsrv/lease_codec.h>
+#include <exceptions/exceptions.h>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <vector>
+
+using namespace isc;
+using namespace isc::asiolink;
+using namespace isc::data;
+using namespace isc::dhcp;
+
+namespace {
+
+/// @brief Creates an IPv4 lease.
+///
+/// @param address Lease address.
+/// @param index Index used to generate the lease properties.
+/// @return The lease.
+Lease4Ptr
+createLease4(const std::string& address, uint8_t index) {
+    HWAddrPtr hwaddr(new HWAddr(std::vector<uint8_t>(6, index), HTYPE_ETHER));
+    Lease4Ptr lease(new Lease4(IOAddress(address), hwaddr,
+                               ClientIdPtr(), 3600, 1650000000 + index,
+                               1 + index % 3));
+    lease->hostname_ = "host.example.org.";
+    lease->fqdn_fwd_ = (index % 2);
+    lease->state_ = index % 3;
+    if (index % 2) {
+        lease->client_id_.reset(new ClientId(std::vector<uint8_t>(7, index)));
+    }
+    return (lease);
+}
+
+/// @brief Creates an IPv6 lease.
+///
+/// @param type Lease type.
+/// @param address Lease address or prefix.
+/// @param index Index used to generate the lease properties.
+/// @return The lease.
+Lease6Ptr
+createLease6(Lease::Type type, const std::string& address, uint8_t index) {
+    DuidPtr duid(new DUID(std::vector<uint8_t>(10, index)));
+    Lease6Ptr lease(new Lease6(type, IOAddress(address), duid, 100 + index,
+                               1800, 3600, 1 + index % 3, HWAddrPtr(),
+                               (type == Lease::TYPE_PD ? 56 : 128)));
+    lease->cltt_ = 1650000000 - index;
+    lease->updateCurrentExpirationTime();
+    lease->fqdn_rev_ = true;
+    if (index % 2) {
+        lease->hwaddr_.reset(new HWAddr(std::vector<uint8_t>(6, index), HTYPE_ETHER));
+    }
+    return (lease);
+}
+
+/// @brief Checks that decoded leases are equal to the original ones.
+///
+/// @tparam LeaseCollection Type of the lease collection.
+/// @param expected Original leases.
+/// @param decoded Decoded leases.
+template<typename LeaseCollection>
+void
+checkLeases(const LeaseCollection& expected, const LeaseCollection& decoded) {
+    ASSERT_EQ(expected.size(), decoded.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        SCOPED_TRACE(expected[i]->addr_.toText());
+        EXPECT_TRUE(*expected[i] == *decoded[i]);
+        EXPECT_TRUE(isEquivalent(expected[i]->toElement(), decoded[i]->toElement()));
+        EXPECT_EQ(decoded[i]->cltt_, decoded[i]->current_cltt_);
+        EXPECT_EQ(decoded[i]->valid_lft_, decoded[i]->current_valid_lft_);
+    }
+}
+
+// Verifies that IPv4 leases are encoded and decoded.
+TEST(LeaseCodecTest, leases4) {
+    Lease4Collection leases;
+    leases.push_back(createLease4("192.0.2.1", 1));
+    leases.push_back(createLease4("192.0.2.2", 2));
+    leases.push_back(createLease4("10.0.0.1", 3));
+    leases.back()->setContext(Element::fromJSON("{ \"foo\": [ 1, 2 ] }"));
+    leases.push_back(createLease4("255.255.255.255", 4));
+
+    std::vector<uint8_t> data = LeaseCodec::encode(leases);
+    checkLeases(leases, LeaseCodec::decode4(data));
+    checkLeases(leases, LeaseCodec::decodeText4(LeaseCodec::encodeText(leases)));
+
+    // An empty collection.
+    EXPECT_TRUE(LeaseCodec::decode4(LeaseCodec::encode(Lease4Collection())).empty());
+}
+
+// Verifies that IPv6 leases are encoded and decoded.
+TEST(LeaseCodecTest, leases6) {
+    Lease6Collection leases;
+    leases.push_back(createLease6(Lease::TYPE_NA, "2001:db8:1::1", 1));
+    leases.push_back(createLease6(Lease::TYPE_TA, "2001:db8:1::2", 2));
+    leases.push_back(createLease6(Lease::TYPE_PD, "3000::", 3));
+    leases.back()->setContext(Element::fromJSON("{ \"bar\": true }"));
+
+    std::vector<uint8_t> data = LeaseCodec::encode(leases);
+    checkLeases(leases, LeaseCodec::decode6(data));
+    checkLeases(leases, LeaseCodec::decodeText6(LeaseCodec::encodeText(leases)));
+}
+
+// Verifies that the encoded leases are much smaller than in JSON.
+TEST(LeaseCodecTest, size) {
+    Lease4Collection leases;
+    std::ostringstream json;
+    for (unsigned i = 1; i <= 200; ++i) {
+        std::ostringstream address;
+        address << "10.0.0." << i;
+        leases.push_back(createLease4(address.str(), i));
+        json << leases.back()->toElement()->str();
+    }
+    EXPECT_GT(json.str().size(), 4 * LeaseCodec::encodeText(leases).size());
+}
+
+// Verifies that invalid encodings are rejected.
+TEST(LeaseCodecTest, invalid) {
+    Lease4Collection leases;
+    leases.push_back(createLease4("192.0.2.1", 1));
+    std::vector<uint8_t> data = LeaseCodec::encode(leases);
+
+    // IPv4 leases are not IPv6 leases.
+    EXPECT_THROW(LeaseCodec::decode6(data), BadValue);
+
+    // Unsupported version.
+    std::vector<uint8_t> bad = data;
+    bad[0] = LeaseCodec::ENCODING_VERSION + 1;
+    EXPECT_THROW(LeaseCodec::decode4(bad), BadValue);
+
+    // Truncated data.
+    for (size_t len = 0; len < data.size(); ++len) {
+        bad.assign(data.begin(), data.begin() + len);
+        EXPECT_THROW(LeaseCodec::decode4(bad), BadValue) << "length " << len;
+    }
+
+    // Trailing data.
+    bad = data;
+    bad.push_back(0);
+    EXPECT_THROW(LeaseCodec::decode4(bad), BadValue);
+
+    // Too many leases.
+    bad = data;
+    bad[2] = 2;
+    EXPECT_THROW(LeaseCodec::decode4(bad), BadValue);
+
+    // Not base64.
+    EXPECT_THROW(LeaseCodec::decodeText4("not base64!"), BadValue);
+
+    // A lease without a subnet identifier.
+    leases[0]->subnet_id_ = 0;
+    EXPECT_THROW(LeaseCodec::decode4(LeaseCodec::encode(leases)), BadValue);
+
+    // An IPv4 lease without hardware address.
+    leases[0]->subnet_id_ = 1;
+    leases[0]->hwaddr_.reset();
+    EXPECT_THROW(LeaseCodec::decode4(LeaseCodec::encode(leases)), BadValue);
+}
+
+} // end of anonymous namespace
@@ -47,7 +47,11 @@ public:
     /// @brief Adds an IPv4 lease.
     ///
     /// @param lease lease to be added
-    virtual bool addLease(const Lease4Ptr&) {
+    /// @throw DbOperationError if the lease is the failing lease.
+    virtual bool addLease(const Lease4Ptr& lease) {
+        if (lease && (lease == failing_lease4_)) {
+            isc_throw(DbOperationError, "unable to add lease");
+        }
         return (false);
     }
 
@@ -406,6 +410,8 @@ public:
     using LeaseMgr::getLease6;
 
     Lease6Collection leases6_; ///< getLease6 methods return this as is
+
+    Lease4Ptr failing_lease4_; ///< addLease fails for this lease
 };
 
 class LeaseMgrTest : public GenericLeaseMgrTest {
@@ -462,6 +468,33 @@ TEST_F(LeaseMgrTest, getLease6) {
                  MultipleRecords);
 }
 
+// Checks that the default batch implementation tells which leases were
+// handled when it fails part way through a batch.
+TEST_F(LeaseMgrTest, addLeasesPartialFailure) {
+    DatabaseConnection::ParameterMap pmap;
+    boost::scoped_ptr<ConcreteLeaseMgr> mgr(new ConcreteLeaseMgr(pmap));
+
+    vector<Lease4Ptr> leases = createLeases4();
+    Lease4Collection batch = { leases[1], leases[2], leases[3] };
+
+    // The concrete lease manager rejects all leases.
+    Lease4Collection rejected;
+    ASSERT_NO_THROW(rejected = mgr->addLeases(batch));
+    EXPECT_EQ(3, rejected.size());
+
+    // The second lease fails: the first one was handled.
+    mgr->failing_lease4_ = leases[2];
+    try {
+        static_cast<void>(mgr->addLeases(batch));
+        ADD_FAILURE() << "addLeases did not throw";
+    } catch (const LeaseBatchError& ex) {
+        EXPECT_EQ(1, ex.getProcessed());
+        ASSERT_EQ(1, ex.getRejected().size());
+        EXPECT_TRUE(ex.getRejected()[0] == leases[1]);
+        EXPECT_EQ("unable to add lease", std::string(ex.what()));
+    }
+}
+
 // Verify LeaseStatsQuery default construction
 TEST (LeaseStatsQueryTest, defaultCtor) {
     LeaseStatsQueryPtr qry;
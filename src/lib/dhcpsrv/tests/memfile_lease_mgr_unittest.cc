@@ -1288,6 +1288,21 @@ TEST_F(MemfileLeaseMgrTest, getLease6DuidIaidSubnetIdSizeMultiThread) {
     testGetLease6DuidIaidSubnetIdSize();
 }
 
+/// @brief Lease4 batch tests
+///
+/// Checks that we are able to write batches of leases in the database.
+TEST_F(MemfileLeaseMgrTest, batchLeases4) {
+    startBackend(V4);
+    testBatchLeases4();
+}
+
+/// @brief Lease4 batch tests
+TEST_F(MemfileLeaseMgrTest, batchLeases4MultiThread) {
+    startBackend(V4);
+    MultiThreadingMgr::instance().setMode(true);
+    testBatchLeases4();
+}
+
 /// @brief Lease4 update tests
 ///
 /// Checks that we are able to update a lease in the database.
@@ -1306,6 +1321,21 @@ TEST_F(MemfileLeaseMgrTest, DISABLED_updateLease4MultiThread) {
     testUpdateLease4();
 }
 
+/// @brief Lease6 batch tests
+///
+/// Checks that we are able to write batches of leases in the database.
+TEST_F(MemfileLeaseMgrTest, batchLeases6) {
+    startBackend(V6);
+    testBatchLeases6();
+}
+
+/// @brief Lease6 batch tests
+TEST_F(MemfileLeaseMgrTest, batchLeases6MultiThread) {
+    startBackend(V6);
+    MultiThreadingMgr::instance().setMode(true);
+    testBatchLeases6();
+}
+
 /// @brief Lease6 update tests
 ///
 /// Checks that we are able to update a lease in the database.
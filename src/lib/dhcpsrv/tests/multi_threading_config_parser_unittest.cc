@@ -1,4 +1,4 @@
-// Copyright (C) 2020-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2020-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -9,6 +9,7 @@
 #include <cc/data.h>
 #include <dhcpsrv/parsers/multi_threading_config_parser.h>
 #include <dhcpsrv/cfg_multi_threading.h>
+#include <util/cpu_affinity.h>
 #include <util/multi_threading_mgr.h>
 #include <testutils/test_to_element.h>
 
@@ -78,9 +79,36 @@ TEST_F(MultiThreadingConfigParserTest, validContent) {
         "   \"thread-pool-size\": 4, \n"
         "   \"packet-queue-size\": 64 \n"
         "} \n"
+        },
+        {
+        "enable-multi-threading, with work-stealing",
+        "{ \n"
+        "   \"enable-multi-threading\": true, \n"
+        "   \"work-stealing\": true \n"
+        "} \n"
+        },
+        {
+        "enable-multi-threading, with empty CPU sets",
+        "{ \n"
+        "   \"enable-multi-threading\": true, \n"
+        "   \"worker-cpu-set\": \"\", \n"
+        "   \"receiver-cpu-set\": \"\" \n"
+        "} \n"
         }
     };
 
+    // CPU sets are rejected where the CPU affinity can't be set.
+    if (isThreadAffinitySupported()) {
+        scenarios.push_back({
+        "enable-multi-threading, with CPU sets",
+        "{ \n"
+        "   \"enable-multi-threading\": true, \n"
+        "   \"worker-cpu-set\": \"1-3,5\", \n"
+        "   \"receiver-cpu-set\": \"0\" \n"
+        "} \n"
+        });
+    }
+
     // Iterate over the valid scenarios and verify they succeed.
     ConstElementPtr config_elems;
     ConstElementPtr multi_threading_config;
@@ -168,9 +196,48 @@ TEST_F(MultiThreadingConfigParserTest, invalidContent) {
         "{ \n"
         "   \"packet-queue-size\": 200000 \n"
         "} \n"
+        },
+        {
+        "work-stealing not boolean",
+        "{ \n"
+        "   \"enable-multi-threading\": true, \n"
+        "   \"work-stealing\": 1 \n"
+        "} \n"
+        },
+        {
+        "worker-cpu-set not string",
+        "{ \n"
+        "   \"enable-multi-threading\": true, \n"
+        "   \"worker-cpu-set\": 1 \n"
+        "} \n"
+        },
+        {
+        "invalid worker-cpu-set",
+        "{ \n"
+        "   \"enable-multi-threading\": true, \n"
+        "   \"worker-cpu-set\": \"3-1\" \n"
+        "} \n"
+        },
+        {
+        "invalid receiver-cpu-set",
+        "{ \n"
+        "   \"enable-multi-threading\": true, \n"
+        "   \"receiver-cpu-set\": \"cpu0\" \n"
+        "} \n"
         }
     };
 
+    // CPU sets are rejected where the CPU affinity can't be set.
+    if (!isThreadAffinitySupported()) {
+        scenarios.push_back({
+        "receiver-cpu-set not supported",
+        "{ \n"
+        "   \"enable-multi-threading\": true, \n"
+        "   \"receiver-cpu-set\": \"0\" \n"
+        "} \n"
+        });
+    }
+
     // Iterate over the valid scenarios and verify they succeed.
     ConstElementPtr config_elems;
     ConstElementPtr queue_control;
@@ -1,4 +1,4 @@
-// Copyright (C) 2012-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2012-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -327,6 +327,19 @@ TEST_F(MySqlLeaseMgrTest, infiniteLifeTime4) {
     testInfiniteLifeTime4();
 }
 
+/// @brief Lease4 batch tests
+///
+/// Checks that we are able to write batches of leases in the database.
+TEST_F(MySqlLeaseMgrTest, batchLeases4) {
+    testBatchLeases4();
+}
+
+/// @brief Lease4 batch tests
+TEST_F(MySqlLeaseMgrTest, batchLeases4MultiThreading) {
+    MultiThreadingTest mt(true);
+    testBatchLeases4();
+}
+
 /// @brief Lease4 update tests
 ///
 /// Checks that we are able to update a lease in the database.
@@ -777,6 +790,19 @@ TEST_F(MySqlLeaseMgrTest, getLeases6DuidMultiThreading) {
     testGetLeases6Duid();
 }
 
+/// @brief Lease6 batch tests
+///
+/// Checks that we are able to write batches of leases in the database.
+TEST_F(MySqlLeaseMgrTest, batchLeases6) {
+    testBatchLeases6();
+}
+
+/// @brief Lease6 batch tests
+TEST_F(MySqlLeaseMgrTest, batchLeases6MultiThreading) {
+    MultiThreadingTest mt(true);
+    testBatchLeases6();
+}
+
 /// @brief Lease6 update tests
 ///
 /// Checks that we are able to update a lease in the database.
@@ -0,0 +1,143 @@
+// Copyright (C) 2022 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <dhcpsrv/parsers/parallel_parser.h>
+#include <exceptions/exceptions.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace isc;
+using namespace isc::dhcp;
+
+namespace {
+
+/// @brief Test fixture class for @c ParallelParser.
+class ParallelParserTest : public ::testing::Test {
+public:
+
+    /// @brief Constructor.
+    ParallelParserTest() = default;
+
+    /// @brief Destructor.
+    ///
+    /// Restores the default number of threads.
+    virtual ~ParallelParserTest() {
+        ParallelParser::setThreadCount(0);
+    }
+
+    /// @brief Checks that all items are parsed once.
+    ///
+    /// @param count the number of items.
+    void checkAllItems(size_t count) {
+        std::vector<std::atomic<size_t>> parsed(count);
+        for (auto& p : parsed) {
+            p = 0;
+        }
+        std::exception_ptr error;
+        EXPECT_EQ(count, ParallelParser::parse(count, [&](size_t i) {
+            ++parsed[i];
+        }, error));
+        EXPECT_FALSE(error);
+        for (size_t i = 0; i < count; ++i) {
+            EXPECT_EQ(1, parsed[i]) << "item " << i;
+        }
+    }
+};
+
+// Verifies the thread count accessors.
+TEST_F(ParallelParserTest, threadCount) {
+    EXPECT_EQ(0, ParallelParser::getThreadCount());
+    ParallelParser::setThreadCount(4);
+    EXPECT_EQ(4, ParallelParser::getThreadCount());
+}
+
+// Verifies that all items of short and long lists are parsed.
+TEST_F(ParallelParserTest, allItems) {
+    ParallelParser::setThreadCount(4);
+    checkAllItems(0);
+    checkAllItems(1);
+    checkAllItems(ParallelParser::MIN_PARALLEL_ITEMS - 1);
+    checkAllItems(ParallelParser::MIN_PARALLEL_ITEMS);
+    checkAllItems(10 * ParallelParser::MIN_PARALLEL_ITEMS + 7);
+}
+
+// Verifies that short lists and a single thread parse in the calling thread.
+TEST_F(ParallelParserTest, sequential) {
+    const std::thread::id self = std::this_thread::get_id();
+    size_t other = 0;
+    ParallelParser::setThreadCount(4);
+    ParallelParser::parse(ParallelParser::MIN_PARALLEL_ITEMS - 1,
+                          [&](size_t) {
+        if (std::this_thread::get_id() != self) {
+            ++other;
+        }
+    });
+    EXPECT_EQ(0, other);
+
+    ParallelParser::setThreadCount(1);
+    ParallelParser::parse(10 * ParallelParser::MIN_PARALLEL_ITEMS,
+                          [&](size_t) {
+        if (std::this_thread::get_id() != self) {
+            ++other;
+        }
+    });
+    EXPECT_EQ(0, other);
+}
+
+// Verifies that long lists are parsed by several threads.
+TEST_F(ParallelParserTest, parallel) {
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    ParallelParser::setThreadCount(4);
+    ParallelParser::parse(100 * ParallelParser::MIN_PARALLEL_ITEMS,
+                          [&](size_t) {
+        std::lock_guard<std::mutex> lock(mutex);
+        threads.insert(std::this_thread::get_id());
+    });
+    EXPECT_LE(1, threads.size());
+    EXPECT_GE(4, threads.size());
+    EXPECT_EQ(0, threads.count(std::this_thread::get_id()));
+}
+
+// Verifies that the error of the first invalid item is reported.
+TEST_F(ParallelParserTest, firstError) {
+    const size_t count = 10 * ParallelParser::MIN_PARALLEL_ITEMS;
+    for (size_t threads : { 1, 4 }) {
+        ParallelParser::setThreadCount(threads);
+        std::exception_ptr error;
+        size_t failed = ParallelParser::parse(count, [&](size_t i) {
+            if ((i == count / 3) || (i == count - 1)) {
+                isc_throw(BadValue, "item " << i);
+            }
+        }, error);
+        EXPECT_EQ(count / 3, failed);
+        ASSERT_TRUE(error);
+        try {
+            std::rethrow_exception(error);
+        } catch (const BadValue& ex) {
+            std::ostringstream expected;
+            expected << "item " << count / 3;
+            EXPECT_EQ(expected.str(), std::string(ex.what()));
+        }
+
+        EXPECT_THROW(ParallelParser::parse(count, [&](size_t i) {
+            if (i == count - 1) {
+                isc_throw(BadValue, "last");
+            }
+        }), BadValue);
+    }
+}
+
+} // end of anonymous namespace
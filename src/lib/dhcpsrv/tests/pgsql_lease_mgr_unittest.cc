@@ -295,6 +295,19 @@ TEST_F(PgSqlLeaseMgrTest, infiniteLifeTime4) {
     testInfiniteLifeTime4();
 }
 
+/// @brief Lease4 batch tests
+///
+/// Checks that we are able to write batches of leases in the database.
+TEST_F(PgSqlLeaseMgrTest, batchLeases4) {
+    testBatchLeases4();
+}
+
+/// @brief Lease4 batch tests
+TEST_F(PgSqlLeaseMgrTest, batchLeases4MultiThreading) {
+    MultiThreadingTest mt(true);
+    testBatchLeases4();
+}
+
 /// @brief Lease4 update tests
 ///
 /// Checks that we are able to update a lease in the database.
@@ -745,6 +758,19 @@ TEST_F(PgSqlLeaseMgrTest, getLeases6DuidMultiThreading) {
     testGetLeases6Duid();
 }
 
+/// @brief Lease6 batch tests
+///
+/// Checks that we are able to write batches of leases in the database.
+TEST_F(PgSqlLeaseMgrTest, batchLeases6) {
+    testBatchLeases6();
+}
+
+/// @brief Lease6 batch tests
+TEST_F(PgSqlLeaseMgrTest, batchLeases6MultiThreading) {
+    MultiThreadingTest mt(true);
+    testBatchLeases6();
+}
+
 /// @brief Lease6 update tests
 ///
 /// Checks that we are able to update a lease in the database.
@@ -0,0 +1,675 @@
+// Copyright (C) 2022 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <eval/compiled_expression.h>
+#include <eval/eval_log.h>
+#include <dhcp/dhcp4.h>
+#include <dhcp/dhcp6.h>
+#include <dhcp/pkt4.h>
+#include <boost/lexical_cast.hpp>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <typeinfo>
+
+using namespace std;
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Compiles expressions into @ref CompiledExpression nodes.
+///
+/// The compiler first rebuilds the expression tree from the reverse
+/// Polish notation: as each token consumes a known number of operands
+/// each sub-expression is a contiguous range of tokens. Sub-expressions
+/// made of tokens which do not depend on the packet are folded into
+/// constants by interpreting them once. The tree is then lowered into
+/// boolean and string nodes.
+class ExpressionCompiler {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// @param compiled the compiled expression to build.
+    explicit ExpressionCompiler(CompiledExpression& compiled)
+        : compiled_(compiled), expr_(compiled.expr_), tree_() {
+    }
+
+    /// @brief Compiles the expression.
+    ///
+    /// @return false if the expression can not be compiled.
+    bool compile();
+
+private:
+
+    /// @brief A node of the expression tree.
+    struct TreeNode {
+        /// @brief Index of the token.
+        size_t token_;
+
+        /// @brief Indexes of operand tree nodes.
+        vector<size_t> operands_;
+
+        /// @brief First token of the sub-expression.
+        size_t first_;
+
+        /// @brief True if the sub-expression was folded.
+        bool constant_;
+
+        /// @brief Value of the folded sub-expression.
+        string value_;
+    };
+
+    /// @brief Returns the number of operands of a token.
+    ///
+    /// @param token the token.
+    /// @return the number of operands or -1 for unknown tokens.
+    static int arity(const Token& token);
+
+    /// @brief Checks if a token depends only on its operands.
+    ///
+    /// @param token the token.
+    /// @return true if the token does not depend on the packet.
+    static bool isPure(const Token& token);
+
+    /// @brief Returns the option token if the token is an option token
+    /// which value can be retrieved using @c TokenOption::getOption.
+    ///
+    /// @param token the token.
+    /// @return the option token or null.
+    boost::shared_ptr<TokenOption> getOptionToken(const TokenPtr& token) const;
+
+    /// @brief Option codes.
+    typedef vector<uint16_t> Codes;
+
+    /// @brief Returns the top level option needed by a token.
+    ///
+    /// @param token the token.
+    /// @return the code of the top level option without which the token
+    /// gives an empty string or false, or -1.
+    static int getRequiredOption(const Token& token);
+
+    /// @brief Returns the options without which a boolean node is false.
+    ///
+    /// @param index the compiled node index.
+    /// @return sorted option codes.
+    Codes falseIfMissing(size_t index) const;
+
+    /// @brief Returns the options without which a string node is empty.
+    ///
+    /// @param index the compiled node index.
+    /// @return sorted option codes.
+    Codes emptyIfMissing(size_t index) const;
+
+    /// @brief Lowers a tree node into a boolean node.
+    ///
+    /// @param index the tree node index.
+    /// @return the compiled node index.
+    size_t lowerBool(size_t index);
+
+    /// @brief Lowers a tree node into a string node.
+    ///
+    /// @param index the tree node index.
+    /// @return the compiled node index.
+    size_t lowerString(size_t index);
+
+    /// @brief Adds a node which interprets the tokens of a tree node.
+    ///
+    /// @param index the tree node index.
+    /// @param kind the node kind.
+    /// @return the compiled node index.
+    size_t addInterpreted(size_t index, CompiledExpression::NodeKind kind);
+
+    /// @brief Adds a compiled node.
+    ///
+    /// @param node the compiled node.
+    /// @return the compiled node index.
+    size_t addNode(const CompiledExpression::Node& node) {
+        compiled_.nodes_.push_back(node);
+        return (compiled_.nodes_.size() - 1);
+    }
+
+    /// @brief The compiled expression.
+    CompiledExpression& compiled_;
+
+    /// @brief The expression.
+    const Expression& expr_;
+
+    /// @brief The expression tree.
+    vector<TreeNode> tree_;
+};
+
+int
+ExpressionCompiler::arity(const Token& token) {
+    if (dynamic_cast<const TokenString*>(&token) ||
+        dynamic_cast<const TokenHexString*>(&token) ||
+        dynamic_cast<const TokenIpAddress*>(&token) ||
+        dynamic_cast<const TokenOption*>(&token) ||
+        dynamic_cast<const TokenPkt*>(&token) ||
+        dynamic_cast<const TokenPkt4*>(&token) ||
+        dynamic_cast<const TokenPkt6*>(&token) ||
+        dynamic_cast<const TokenRelay6Field*>(&token) ||
+        dynamic_cast<const TokenMember*>(&token)) {
+        return (0);
+    }
+    if (dynamic_cast<const TokenIpAddressToText*>(&token) ||
+        dynamic_cast<const TokenInt8ToText*>(&token) ||
+        dynamic_cast<const TokenInt16ToText*>(&token) ||
+        dynamic_cast<const TokenInt32ToText*>(&token) ||
+        dynamic_cast<const TokenUInt8ToText*>(&token) ||
+        dynamic_cast<const TokenUInt16ToText*>(&token) ||
+        dynamic_cast<const TokenUInt32ToText*>(&token) ||
+        dynamic_cast<const TokenNot*>(&token)) {
+        return (1);
+    }
+    if (dynamic_cast<const TokenEqual*>(&token) ||
+        dynamic_cast<const TokenConcat*>(&token) ||
+        dynamic_cast<const TokenToHexString*>(&token) ||
+        dynamic_cast<const TokenAnd*>(&token) ||
+        dynamic_cast<const TokenOr*>(&token)) {
+        return (2);
+    }
+    if (dynamic_cast<const TokenSubstring*>(&token) ||
+        dynamic_cast<const TokenIfElse*>(&token)) {
+        return (3);
+    }
+    return (-1);
+}
+
+bool
+ExpressionCompiler::isPure(const Token& token) {
+    // Option, packet and membership tokens depend on the packet.
+    return (!dynamic_cast<const TokenOption*>(&token) &&
+            !dynamic_cast<const TokenPkt*>(&token) &&
+            !dynamic_cast<const TokenPkt4*>(&token) &&
+            !dynamic_cast<const TokenPkt6*>(&token) &&
+            !dynamic_cast<const TokenRelay6Field*>(&token) &&
+            !dynamic_cast<const TokenMember*>(&token));
+}
+
+boost::shared_ptr<TokenOption>
+ExpressionCompiler::getOptionToken(const TokenPtr& token) const {
+    // Vendor and sub-option tokens have their own evaluation.
+    const Token& ref = *token;
+    if ((typeid(ref) == typeid(TokenOption)) ||
+        (typeid(ref) == typeid(TokenRelay4Option)) ||
+        (typeid(ref) == typeid(TokenRelay6Option))) {
+        return (boost::dynamic_pointer_cast<TokenOption>(token));
+    }
+    return (boost::shared_ptr<TokenOption>());
+}
+
+int
+ExpressionCompiler::getRequiredOption(const Token& token) {
+    // Sub-option tokens look for the sub-option in the top level option.
+    if ((typeid(token) == typeid(TokenOption)) ||
+        (typeid(token) == typeid(TokenSubOption))) {
+        return (static_cast<const TokenOption&>(token).getCode());
+    }
+    if (typeid(token) == typeid(TokenRelay4Option)) {
+        return (DHO_DHCP_AGENT_OPTIONS);
+    }
+    const TokenVendor* vendor = dynamic_cast<const TokenVendor*>(&token);
+    if (vendor) {
+        bool v4 = (vendor->getUniverse() == Option::V4);
+        if (dynamic_cast<const TokenVendorClass*>(&token)) {
+            return (v4 ? DHO_VIVCO_SUBOPTIONS : D6O_VENDOR_CLASS);
+        }
+        return (v4 ? DHO_VIVSO_SUBOPTIONS : D6O_VENDOR_OPTS);
+    }
+    return (-1);
+}
+
+ExpressionCompiler::Codes
+ExpressionCompiler::falseIfMissing(size_t index) const {
+    const CompiledExpression::Node& node = compiled_.nodes_[index];
+    Codes codes;
+    switch (node.kind_) {
+    case CompiledExpression::BOOL_OPTION_EXISTS: {
+        int code = getRequiredOption(*node.option_);
+        if (code >= 0) {
+            codes.push_back(code);
+        }
+        break;
+    }
+
+    case CompiledExpression::BOOL_AND: {
+        // False when either operand is false.
+        Codes left = falseIfMissing(node.left_);
+        Codes right = falseIfMissing(node.right_);
+        set_union(left.begin(), left.end(), right.begin(), right.end(),
+                  back_inserter(codes));
+        break;
+    }
+
+    case CompiledExpression::BOOL_OR: {
+        // False when both operands are false.
+        Codes left = falseIfMissing(node.left_);
+        Codes right = falseIfMissing(node.right_);
+        set_intersection(left.begin(), left.end(), right.begin(), right.end(),
+                         back_inserter(codes));
+        break;
+    }
+
+    case CompiledExpression::BOOL_EQUAL: {
+        // False when one side is empty and the other a non empty constant.
+        const CompiledExpression::Node& left = compiled_.nodes_[node.left_];
+        const CompiledExpression::Node& right = compiled_.nodes_[node.right_];
+        if ((left.kind_ == CompiledExpression::STRING_CONST) &&
+            !left.value_.empty()) {
+            codes = emptyIfMissing(node.right_);
+        } else if ((right.kind_ == CompiledExpression::STRING_CONST) &&
+                   !right.value_.empty()) {
+            codes = emptyIfMissing(node.left_);
+        }
+        break;
+    }
+
+    case CompiledExpression::BOOL_INTERPRETED: {
+        // e.g. option[82].option[1].exists or vendor[4491].exists
+        if (node.last_ != node.first_ + 1) {
+            break;
+        }
+        const TokenOption* option =
+            dynamic_cast<const TokenOption*>(expr_[node.first_].get());
+        if (option && (option->getRepresentation() == TokenOption::EXISTS)) {
+            int code = getRequiredOption(*option);
+            if (code >= 0) {
+                codes.push_back(code);
+            }
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+    return (codes);
+}
+
+ExpressionCompiler::Codes
+ExpressionCompiler::emptyIfMissing(size_t index) const {
+    const CompiledExpression::Node& node = compiled_.nodes_[index];
+    Codes codes;
+    switch (node.kind_) {
+    case CompiledExpression::STRING_OPTION: {
+        int code = getRequiredOption(*node.option_);
+        if (code >= 0) {
+            codes.push_back(code);
+        }
+        break;
+    }
+
+    case CompiledExpression::STRING_SUBSTRING:
+        // The substring of an empty string is empty.
+        codes = emptyIfMissing(node.left_);
+        break;
+
+    case CompiledExpression::STRING_INTERPRETED: {
+        // e.g. option[82].option[1].hex or vendor-class[4491].data
+        if (node.last_ != node.first_ + 1) {
+            break;
+        }
+        const TokenOption* option =
+            dynamic_cast<const TokenOption*>(expr_[node.first_].get());
+        if (option && (option->getRepresentation() != TokenOption::EXISTS)) {
+            int code = getRequiredOption(*option);
+            if (code >= 0) {
+                codes.push_back(code);
+            }
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+    return (codes);
+}
+
+bool
+ExpressionCompiler::compile() {
+    // Constant sub-expressions are evaluated on a dummy packet.
+    Pkt4 dummy(DHCPDISCOVER, 0);
+    vector<size_t> stack;
+    for (size_t i = 0; i < expr_.size(); ++i) {
+        if (!expr_[i]) {
+            return (false);
+        }
+        int count = arity(*expr_[i]);
+        if ((count < 0) || (stack.size() < static_cast<size_t>(count))) {
+            return (false);
+        }
+        TreeNode node;
+        node.token_ = i;
+        node.operands_.assign(stack.end() - count, stack.end());
+        stack.resize(stack.size() - count);
+        node.first_ = (count > 0 ? tree_[node.operands_[0]].first_ : i);
+        node.constant_ = isPure(*expr_[i]);
+        for (auto const& operand : node.operands_) {
+            if (!tree_[operand].constant_) {
+                node.constant_ = false;
+            }
+        }
+        if (node.constant_) {
+            try {
+                node.value_ = compiled_.interpret(node.first_, i + 1, dummy);
+            } catch (...) {
+                // Let the error happen at evaluation time.
+                node.constant_ = false;
+            }
+        }
+        tree_.push_back(node);
+        stack.push_back(tree_.size() - 1);
+    }
+    if (stack.size() != 1) {
+        return (false);
+    }
+    const Token& root = *expr_.back();
+    compiled_.boolean_ = (dynamic_cast<const TokenEqual*>(&root) ||
+                          dynamic_cast<const TokenNot*>(&root) ||
+                          dynamic_cast<const TokenAnd*>(&root) ||
+                          dynamic_cast<const TokenOr*>(&root) ||
+                          dynamic_cast<const TokenMember*>(&root) ||
+                          (dynamic_cast<const TokenOption*>(&root) &&
+                           (dynamic_cast<const TokenOption*>(&root)->getRepresentation() ==
+                            TokenOption::EXISTS)));
+    compiled_.bool_root_ = lowerBool(stack.back());
+    compiled_.string_root_ = lowerString(stack.back());
+    if (compiled_.boolean_) {
+        compiled_.required_options_ = falseIfMissing(compiled_.bool_root_);
+    }
+    return (true);
+}
+
+size_t
+ExpressionCompiler::addInterpreted(size_t index,
+                                   CompiledExpression::NodeKind kind) {
+    CompiledExpression::Node node(kind);
+    node.first_ = tree_[index].first_;
+    node.last_ = tree_[index].token_ + 1;
+    return (addNode(node));
+}
+
+size_t
+ExpressionCompiler::lowerBool(size_t index) {
+    const TreeNode& tree_node = tree_[index];
+    if (tree_node.constant_) {
+        if ((tree_node.value_ != "true") && (tree_node.value_ != "false")) {
+            // Not a boolean: the interpreter raises the error.
+            return (addInterpreted(index, CompiledExpression::BOOL_INTERPRETED));
+        }
+        CompiledExpression::Node node(CompiledExpression::BOOL_CONST);
+        node.bool_value_ = (tree_node.value_ == "true");
+        return (addNode(node));
+    }
+
+    const TokenPtr& token = expr_[tree_node.token_];
+    if (dynamic_cast<const TokenNot*>(token.get())) {
+        CompiledExpression::Node node(CompiledExpression::BOOL_NOT);
+        node.left_ = lowerBool(tree_node.operands_[0]);
+        return (addNode(node));
+    }
+    if (dynamic_cast<const TokenAnd*>(token.get()) ||
+        dynamic_cast<const TokenOr*>(token.get())) {
+        CompiledExpression::Node node(dynamic_cast<const TokenAnd*>(token.get()) ?
+                                      CompiledExpression::BOOL_AND :
+                                      CompiledExpression::BOOL_OR);
+        node.left_ = lowerBool(tree_node.operands_[0]);
+        node.right_ = lowerBool(tree_node.operands_[1]);
+        return (addNode(node));
+    }
+    const TokenMember* member = dynamic_cast<const TokenMember*>(token.get());
+    if (member) {
+        CompiledExpression::Node node(CompiledExpression::BOOL_MEMBER);
+        node.value_ = member->getClientClass();
+        return (addNode(node));
+    }
+    boost::shared_ptr<TokenOption> option = getOptionToken(token);
+    if (option && (option->getRepresentation() == TokenOption::EXISTS)) {
+        CompiledExpression::Node node(CompiledExpression::BOOL_OPTION_EXISTS);
+        node.option_ = option;
+        return (addNode(node));
+    }
+    if (dynamic_cast<const TokenEqual*>(token.get())) {
+        CompiledExpression::Node node(CompiledExpression::BOOL_EQUAL);
+        node.left_ = lowerString(tree_node.operands_[0]);
+        node.right_ = lowerString(tree_node.operands_[1]);
+        return (addNode(node));
+    }
+    return (addInterpreted(index, CompiledExpression::BOOL_INTERPRETED));
+}
+
+size_t
+ExpressionCompiler::lowerString(size_t index) {
+    const TreeNode& tree_node = tree_[index];
+    if (tree_node.constant_) {
+        CompiledExpression::Node node(CompiledExpression::STRING_CONST);
+        node.value_ = tree_node.value_;
+        return (addNode(node));
+    }
+
+    const TokenPtr& token = expr_[tree_node.token_];
+    boost::shared_ptr<TokenOption> option = getOptionToken(token);
+    if (option && (option->getRepresentation() != TokenOption::EXISTS)) {
+        CompiledExpression::Node node(CompiledExpression::STRING_OPTION);
+        node.option_ = option;
+        node.hex_ = (option->getRepresentation() == TokenOption::HEXADECIMAL);
+        return (addNode(node));
+    }
+    if (dynamic_cast<const TokenSubstring*>(token.get())) {
+        const TreeNode& start = tree_[tree_node.operands_[1]];
+        const TreeNode& length = tree_[tree_node.operands_[2]];
+        if (start.constant_ && length.constant_) {
+            CompiledExpression::Node node(CompiledExpression::STRING_SUBSTRING);
+            try {
+                node.start_ = boost::lexical_cast<int>(start.value_);
+                if (length.value_ == "all") {
+                    node.all_ = true;
+                } else {
+                    node.length_ = boost::lexical_cast<int>(length.value_);
+                }
+                node.left_ = lowerString(tree_node.operands_[0]);
+                return (addNode(node));
+            } catch (const boost::bad_lexical_cast&) {
+                // Let the interpreter raise the error.
+            }
+        }
+    }
+    return (addInterpreted(index, CompiledExpression::STRING_INTERPRETED));
+}
+
+CompiledExpression::CompiledExpression(const Expression& expr)
+    : expr_(expr), nodes_(), bool_root_(0), string_root_(0), boolean_(false),
+      required_options_() {
+    ExpressionCompiler compiler(*this);
+    if (!compiler.compile()) {
+        nodes_.clear();
+    }
+}
+
+string
+CompiledExpression::interpret(size_t first, size_t last, Pkt& pkt) const {
+    ValueStack values;
+    for (size_t i = first; i < last; ++i) {
+        expr_[i]->evaluate(pkt, values);
+    }
+    if (values.size() != 1) {
+        isc_throw(EvalBadStack, "Incorrect stack order. Expected exactly "
+                  "1 value at the end of evaluation, got " << values.size());
+    }
+    return (values.top());
+}
+
+bool
+CompiledExpression::evaluateBool(Pkt& pkt) const {
+    if (nodes_.empty() || eval_logger.isDebugEnabled(EVAL_DBG_STACK)) {
+        return (Token::toBool(interpret(0, expr_.size(), pkt)));
+    }
+    return (evalBool(bool_root_, pkt));
+}
+
+string
+CompiledExpression::evaluateString(Pkt& pkt) const {
+    if (nodes_.empty() || eval_logger.isDebugEnabled(EVAL_DBG_STACK)) {
+        return (interpret(0, expr_.size(), pkt));
+    }
+    string storage;
+    View value = evalString(string_root_, pkt, storage);
+    return (string(value.data_, value.size_));
+}
+
+bool
+CompiledExpression::evalBool(size_t index, Pkt& pkt) const {
+    const Node& node = nodes_[index];
+    switch (node.kind_) {
+    case BOOL_CONST:
+        return (node.bool_value_);
+
+    case BOOL_NOT:
+        return (!evalBool(node.left_, pkt));
+
+    case BOOL_AND:
+        return (evalBool(node.left_, pkt) && evalBool(node.right_, pkt));
+
+    case BOOL_OR:
+        return (evalBool(node.left_, pkt) || evalBool(node.right_, pkt));
+
+    case BOOL_MEMBER:
+        return (pkt.inClass(node.value_));
+
+    case BOOL_OPTION_EXISTS:
+        return (static_cast<bool>(node.option_->getOption(pkt)));
+
+    case BOOL_EQUAL: {
+        string left_storage;
+        string right_storage;
+        View left = evalString(node.left_, pkt, left_storage);
+        View right = evalString(node.right_, pkt, right_storage);
+        return ((left.size_ == right.size_) &&
+                ((left.size_ == 0) ||
+                 (memcmp(left.data_, right.data_, left.size_) == 0)));
+    }
+
+    default:
+        return (Token::toBool(interpret(node.first_, node.last_, pkt)));
+    }
+}
+
+CompiledExpression::View
+CompiledExpression::evalString(size_t index, Pkt& pkt, string& storage) const {
+    const Node& node = nodes_[index];
+    switch (node.kind_) {
+    case STRING_CONST:
+        return (View(node.value_.data(), node.value_.size()));
+
+    case STRING_OPTION: {
+        // The option is owned by the packet so views on its data
+        // remain valid during the evaluation.
+        OptionPtr opt = node.option_->getOption(pkt);
+        if (!opt) {
+            return (View());
+        }
+        if (!node.hex_) {
+            storage = opt->toString();
+            return (View(storage.data(), storage.size()));
+        }
+        // Options without a specific class keep their data in a buffer
+        // which is the hexadecimal representation when there is no
+        // sub-option.
+        const Option& ref = *opt;
+        if ((typeid(ref) == typeid(Option)) && opt->getOptions().empty()) {
+            const OptionBuffer& data = opt->getData();
+            if (data.empty()) {
+                return (View());
+            }
+            return (View(reinterpret_cast<const char*>(&data[0]), data.size()));
+        }
+        vector<uint8_t> binary = opt->toBinary();
+        storage.assign(binary.begin(), binary.end());
+        return (View(storage.data(), storage.size()));
+    }
+
+    case STRING_SUBSTRING: {
+        // Same semantic as TokenSubstring::evaluate.
+        View value = evalString(node.left_, pkt, storage);
+        const int string_length = value.size_;
+        int start_pos = node.start_;
+        int length = (node.all_ ? string_length : node.length_);
+        if ((string_length == 0) ||
+            (start_pos < -string_length) || (start_pos >= string_length)) {
+            return (View());
+        }
+        if (start_pos < 0) {
+            start_pos = string_length + start_pos;
+        }
+        if (length < 0) {
+            length = -length;
+            if (length <= start_pos) {
+                start_pos -= length;
+            } else {
+                length = start_pos;
+                start_pos = 0;
+            }
+        }
+        if (length > string_length - start_pos) {
+            length = string_length - start_pos;
+        }
+        return (View(value.data_ + start_pos, length));
+    }
+
+    default:
+        storage = interpret(node.first_, node.last_, pkt);
+        return (View(storage.data(), storage.size()));
+    }
+}
+
+bool
+CompiledExpression::canMatch(const Pkt& pkt) const {
+    for (auto const& code : required_options_) {
+        if (pkt.options_.find(code) == pkt.options_.end()) {
+            return (false);
+        }
+    }
+    return (true);
+}
+
+bool
+CompiledExpression::isConstant() const {
+    return (!nodes_.empty() && (nodes_[bool_root_].kind_ == BOOL_CONST));
+}
+
+size_t
+CompiledExpression::countInterpreted(size_t index) const {
+    const Node& node = nodes_[index];
+    switch (node.kind_) {
+    case BOOL_INTERPRETED:
+    case STRING_INTERPRETED:
+        return (1);
+    case BOOL_NOT:
+    case STRING_SUBSTRING:
+        return (countInterpreted(node.left_));
+    case BOOL_AND:
+    case BOOL_OR:
+    case BOOL_EQUAL:
+        return (countInterpreted(node.left_) + countInterpreted(node.right_));
+    default:
+        return (0);
+    }
+}
+
+size_t
+CompiledExpression::getInterpretedCount() const {
+    if (nodes_.empty()) {
+        return (0);
+    }
+    return (countInterpreted(boolean_ ? bool_root_ : string_root_));
+}
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
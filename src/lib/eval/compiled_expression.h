@@ -0,0 +1,264 @@
+// Copyright (C) 2022 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef COMPILED_EXPRESSION_H
+#define COMPILED_EXPRESSION_H
+
+#include <eval/token.h>
+#include <boost/shared_ptr.hpp>
+#include <string>
+#include <vector>
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Expression compiled for fast evaluation.
+///
+/// The @ref evaluateBool and @ref evaluateString functions interpret an
+/// expression, i.e. a vector of tokens in reverse Polish notation, using
+/// a stack of strings: each literal, option value and intermediate result
+/// is copied in a new string and each token is a virtual call.
+///
+/// This class compiles an expression once (e.g. when the client class
+/// is configured) into a tree of typed nodes:
+/// - sub-expressions which do not depend on the packet are folded into
+///   constants, e.g. substring('foobar', 0, 3) becomes 'foo',
+/// - boolean operators become native nodes and the right operand of
+///   'and' and 'or' is not evaluated when the left operand decides,
+/// - 'member', 'option[X].exists', '==' and substring with constant
+///   position and length become specialized nodes,
+/// - option[X].hex and option[X].text values are compared in place:
+///   string results are handled as (pointer, length) views so for
+///   instance option[X].hex == 0x0102 compares the option data with
+///   the constant without any copy.
+///
+/// Other sub-expressions (e.g. concat or pkt4.mac) are evaluated by the
+/// token interpreter, which gives the same results and errors as before.
+/// When the evaluation debug logging is enabled the whole expression is
+/// interpreted so the evaluation of each token is still logged.
+///
+/// Compiled expressions are immutable so they can be shared between
+/// threads.
+class CompiledExpression {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// Compiles the expression. If the expression can not be compiled
+    /// (e.g. it contains a token which is not known by the compiler) it
+    /// will be interpreted.
+    ///
+    /// @param expr the expression to compile.
+    explicit CompiledExpression(const Expression& expr);
+
+    /// @brief Evaluates the expression as a boolean.
+    ///
+    /// Same as @ref isc::dhcp::evaluateBool on the expression.
+    ///
+    /// @param pkt the packet to evaluate the expression on.
+    /// @return the result of the evaluation.
+    /// @throw EvalTypeError or EvalBadStack on evaluation error.
+    bool evaluateBool(Pkt& pkt) const;
+
+    /// @brief Evaluates the expression as a string.
+    ///
+    /// Same as @ref isc::dhcp::evaluateString on the expression.
+    ///
+    /// @param pkt the packet to evaluate the expression on.
+    /// @return the result of the evaluation.
+    /// @throw EvalTypeError or EvalBadStack on evaluation error.
+    std::string evaluateString(Pkt& pkt) const;
+
+    /// @brief Checks if the expression can match a packet.
+    ///
+    /// The compiler collects the top level options without which a
+    /// boolean expression is false, e.g. option 60 for
+    /// substring(option[60].hex, 0, 4) == 'MSFT' or option 82 for
+    /// relay4[1].exists or option[82].option[2].hex == 'foo'. This
+    /// function only looks for these options so it can be used as a
+    /// cheap prefilter before @ref evaluateBool.
+    ///
+    /// @param pkt the packet.
+    /// @return false if the expression is false for the packet, true if
+    /// it must be evaluated.
+    bool canMatch(const Pkt& pkt) const;
+
+    /// @brief Returns the codes of options required for a match.
+    ///
+    /// @return sorted codes of the top level options without which the
+    /// boolean expression is false.
+    const std::vector<uint16_t>& getRequiredOptions() const {
+        return (required_options_);
+    }
+
+    /// @brief Returns the compiled expression.
+    const Expression& getExpression() const {
+        return (expr_);
+    }
+
+    /// @brief Checks if the expression was compiled.
+    ///
+    /// @return false if the expression is always interpreted.
+    bool isCompiled() const {
+        return (!nodes_.empty());
+    }
+
+    /// @brief Checks if the boolean value of the expression is constant.
+    ///
+    /// @return true if the expression was folded into a boolean constant.
+    bool isConstant() const;
+
+    /// @brief Returns the number of nodes evaluated by the interpreter.
+    ///
+    /// This is mainly used in tests to check the specializations.
+    ///
+    /// @return the number of interpreted nodes reachable from the boolean
+    /// root for boolean expressions or from the string root otherwise.
+    size_t getInterpretedCount() const;
+
+private:
+
+    /// @brief A view on a string value, i.e. a pointer and a length.
+    struct View {
+        /// @brief Constructor.
+        ///
+        /// @param data pointer to the first character.
+        /// @param size length.
+        View(const char* data = 0, size_t size = 0)
+            : data_(data), size_(size) {
+        }
+
+        /// @brief Pointer to the first character.
+        const char* data_;
+
+        /// @brief Length.
+        size_t size_;
+    };
+
+    /// @brief Node kinds.
+    enum NodeKind {
+        BOOL_CONST,         ///< boolean constant.
+        BOOL_NOT,           ///< not.
+        BOOL_AND,           ///< and (short-circuit).
+        BOOL_OR,            ///< or (short-circuit).
+        BOOL_MEMBER,        ///< member('class').
+        BOOL_OPTION_EXISTS, ///< option[X].exists and relay variants.
+        BOOL_EQUAL,         ///< == on two string nodes.
+        BOOL_INTERPRETED,   ///< tokens evaluated by the interpreter.
+        STRING_CONST,       ///< string constant.
+        STRING_OPTION,      ///< option[X].hex or .text and relay variants.
+        STRING_SUBSTRING,   ///< substring with constant position and length.
+        STRING_INTERPRETED  ///< tokens evaluated by the interpreter.
+    };
+
+    /// @brief A node of the compiled expression.
+    struct Node {
+        /// @brief Constructor.
+        ///
+        /// @param kind the node kind.
+        explicit Node(NodeKind kind)
+            : kind_(kind), left_(0), right_(0), value_(), bool_value_(false),
+              option_(), hex_(false), start_(0), length_(0), all_(false),
+              first_(0), last_(0) {
+        }
+
+        /// @brief The node kind.
+        NodeKind kind_;
+
+        /// @brief Index of the first operand node.
+        size_t left_;
+
+        /// @brief Index of the second operand node.
+        size_t right_;
+
+        /// @brief Constant string value or client class name.
+        std::string value_;
+
+        /// @brief Constant boolean value.
+        bool bool_value_;
+
+        /// @brief Option token.
+        boost::shared_ptr<TokenOption> option_;
+
+        /// @brief True for the hexadecimal representation of an option.
+        bool hex_;
+
+        /// @brief Substring start position.
+        int start_;
+
+        /// @brief Substring length.
+        int length_;
+
+        /// @brief True when the substring length is 'all'.
+        bool all_;
+
+        /// @brief First token of interpreted nodes.
+        size_t first_;
+
+        /// @brief Past the last token of interpreted nodes.
+        size_t last_;
+    };
+
+    /// @brief Interprets a range of tokens.
+    ///
+    /// @param first first token.
+    /// @param last past the last token.
+    /// @param pkt the packet.
+    /// @return the value left on the stack.
+    /// @throw EvalBadStack if not exactly one value is left on the stack.
+    std::string interpret(size_t first, size_t last, Pkt& pkt) const;
+
+    /// @brief Evaluates a boolean node.
+    ///
+    /// @param index the node index.
+    /// @param pkt the packet.
+    /// @return the boolean value.
+    bool evalBool(size_t index, Pkt& pkt) const;
+
+    /// @brief Evaluates a string node.
+    ///
+    /// @param index the node index.
+    /// @param pkt the packet.
+    /// @param storage storage for values which are not available in the
+    /// node or in the packet.
+    /// @return a view on the value.
+    View evalString(size_t index, Pkt& pkt, std::string& storage) const;
+
+    /// @brief Counts interpreted nodes reachable from a node.
+    ///
+    /// @param index the node index.
+    /// @return the number of interpreted nodes.
+    size_t countInterpreted(size_t index) const;
+
+    /// @brief The expression.
+    Expression expr_;
+
+    /// @brief Nodes (empty when the expression is interpreted).
+    std::vector<Node> nodes_;
+
+    /// @brief Index of the root node for boolean evaluation.
+    size_t bool_root_;
+
+    /// @brief Index of the root node for string evaluation.
+    size_t string_root_;
+
+    /// @brief True when the last token returns a boolean.
+    bool boolean_;
+
+    /// @brief Codes of options required for a match.
+    std::vector<uint16_t> required_options_;
+
+    /// @brief Allows the compiler to build nodes.
+    friend class ExpressionCompiler;
+};
+
+/// @brief Pointer to a compiled expression.
+typedef boost::shared_ptr<CompiledExpression> CompiledExpressionPtr;
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
+
+#endif // COMPILED_EXPRESSION_H
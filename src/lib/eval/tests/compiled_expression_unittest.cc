@@ -0,0 +1,347 @@
+// Copyright (C) 2022 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+#include <eval/compiled_expression.h>
+#include <eval/eval_context.h>
+#include <eval/evaluate.h>
+#include <dhcp/dhcp4.h>
+#include <dhcp/dhcp6.h>
+#include <dhcp/option_string.h>
+#include <dhcp/pkt4.h>
+#include <dhcp/pkt6.h>
+
+#include <gtest/gtest.h>
+
+using namespace std;
+using namespace isc::dhcp;
+
+namespace {
+
+/// @brief Token counting its evaluations.
+class CountingToken : public TokenPkt4 {
+public:
+
+    /// @brief Constructor.
+    CountingToken() : TokenPkt4(TokenPkt4::CHADDR), count_(0) {
+    }
+
+    /// @brief Evaluates the token and counts the evaluation.
+    ///
+    /// @param pkt the packet.
+    /// @param values the value stack.
+    void evaluate(Pkt& pkt, ValueStack& values) {
+        ++count_;
+        TokenPkt4::evaluate(pkt, values);
+    }
+
+    /// @brief The number of evaluations.
+    size_t count_;
+};
+
+/// @brief Test fixture for testing compiled expressions.
+class CompiledExpressionTest : public ::testing::Test {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// Creates packets with options and classes.
+    CompiledExpressionTest() {
+        pkt4_.reset(new Pkt4(DHCPDISCOVER, 12345));
+        pkt4_->addOption(OptionPtr(new OptionString(Option::V4, 100,
+                                                    "hundred4")));
+        pkt4_->addOption(OptionPtr(new Option(Option::V4, 101,
+                                              OptionBuffer(2, 1))));
+        OptionPtr rai(new Option(Option::V4, DHO_DHCP_AGENT_OPTIONS));
+        rai->addOption(OptionPtr(new Option(Option::V4, 1,
+                                            OptionBuffer(3, 0x41))));
+        pkt4_->addOption(rai);
+        pkt4_->addClass("foo");
+
+        pkt6_.reset(new Pkt6(DHCPV6_SOLICIT, 12345));
+        pkt6_->addOption(OptionPtr(new OptionString(Option::V6, 100,
+                                                    "hundred6")));
+        pkt6_->addClass("foo");
+    }
+
+    /// @brief Parses an expression.
+    ///
+    /// @param universe the option universe.
+    /// @param text the expression.
+    /// @param type the expression type.
+    /// @return the expression.
+    Expression parse(Option::Universe universe, const string& text,
+                     EvalContext::ParserType type = EvalContext::PARSER_BOOL) {
+        EvalContext eval(universe);
+        EXPECT_NO_THROW(eval.parseString(text, type)) << text;
+        return (eval.expression);
+    }
+
+    /// @brief Checks that the compiled expression gives the same result
+    /// as the interpreter.
+    ///
+    /// @param pkt the packet.
+    /// @param expr the expression.
+    /// @param text the expression text for error messages.
+    /// @param as_bool true to evaluate as a boolean.
+    void checkSame(Pkt& pkt, const Expression& expr, const string& text,
+                   bool as_bool) {
+        CompiledExpression compiled(expr);
+        if (as_bool) {
+            bool expected = false;
+            bool failed = false;
+            try {
+                expected = evaluateBool(expr, pkt);
+            } catch (const std::exception&) {
+                failed = true;
+            }
+            if (failed) {
+                EXPECT_ANY_THROW(compiled.evaluateBool(pkt)) << text;
+            } else {
+                bool result = !expected;
+                EXPECT_NO_THROW(result = compiled.evaluateBool(pkt)) << text;
+                EXPECT_EQ(expected, result) << text;
+            }
+        } else {
+            string expected = evaluateString(expr, pkt);
+            EXPECT_EQ(expected, compiled.evaluateString(pkt)) << text;
+        }
+    }
+
+    /// @brief DHCPv4 packet.
+    Pkt4Ptr pkt4_;
+
+    /// @brief DHCPv6 packet.
+    Pkt6Ptr pkt6_;
+};
+
+// Checks that compiled boolean expressions give the interpreter results.
+TEST_F(CompiledExpressionTest, boolean4) {
+    const char* exprs[] = {
+        "option[100].text == 'hundred4'",
+        "option[100].hex == 'hundred4'",
+        "option[100].hex == 'hundred'",
+        "option[101].hex == 0x0101",
+        "option[101].text == 0x0101",
+        "option[123].hex == ''",
+        "option[100].exists",
+        "option[123].exists",
+        "not option[100].exists",
+        "option[82].exists and option[82].option[1].hex == 'AAA'",
+        "relay4[1].hex == 'AAA'",
+        "relay4[2].exists",
+        "substring(option[100].text, 0, 3) == 'hun'",
+        "substring(option[100].text, -3, all) == 'ed4'",
+        "substring(option[100].text, 5, -2) == 're'",
+        "substring(option[100].text, 2, -5) == 'hu'",
+        "substring(option[100].text, 7, 10) == '4'",
+        "substring(option[100].text, 8, 1) == ''",
+        "substring(option[100].text, -9, 1) == ''",
+        "substring(option[123].hex, 0, 1) == ''",
+        "member('foo')",
+        "member('bar')",
+        "option[100].exists and member('foo')",
+        "option[123].exists or member('bar')",
+        "not (member('bar') or not member('foo'))",
+        "concat('hun', 'dred4') == option[100].text",
+        "substring('foobar', 0, 3) == 'foo'",
+        "'true' == 'true'",
+        "ifelse(option[100].exists, 'a', 'b') == 'a'",
+        "hexstring(option[101].hex, ':') == '01:01'",
+        "pkt4.msgtype == 1",
+        "pkt4.mac == 0x010203",
+        "uint8totext(0x01) == '1'",
+        "addrtotext(10.0.0.1) == '10.0.0.1'",
+        "vendor[4491].exists",
+        "pkt.iface == 'eth0' or option[100].exists"
+    };
+    for (auto const& text : exprs) {
+        Expression expr = parse(Option::V4, text);
+        checkSame(*pkt4_, expr, text, true);
+    }
+}
+
+// Checks that compiled boolean expressions give the interpreter results
+// with DHCPv6 packets.
+TEST_F(CompiledExpressionTest, boolean6) {
+    const char* exprs[] = {
+        "option[100].text == 'hundred6'",
+        "substring(option[100].hex, 0, 7) == 'hundred'",
+        "option[100].exists and not option[101].exists",
+        "relay6[0].option[100].exists",
+        "member('foo') and pkt6.msgtype == 1"
+    };
+    for (auto const& text : exprs) {
+        Expression expr = parse(Option::V6, text);
+        checkSame(*pkt6_, expr, text, true);
+    }
+}
+
+// Checks that compiled string expressions give the interpreter results.
+TEST_F(CompiledExpressionTest, string4) {
+    const char* exprs[] = {
+        "option[100].text",
+        "option[101].hex",
+        "option[123].hex",
+        "substring(option[100].hex, 1, 4)",
+        "substring(option[100].hex, -4, -2)",
+        "concat(option[100].text, 'x')",
+        "ifelse(member('foo'), 'yes', 'no')",
+        "'constant'",
+        "relay4[1].hex"
+    };
+    for (auto const& text : exprs) {
+        Expression expr = parse(Option::V4, text, EvalContext::PARSER_STRING);
+        checkSame(*pkt4_, expr, text, false);
+    }
+}
+
+// Checks that constant expressions are folded.
+TEST_F(CompiledExpressionTest, constant) {
+    CompiledExpression folded(parse(Option::V4,
+                                    "substring('foobar', 0, 3) == 'foo'"));
+    EXPECT_TRUE(folded.isCompiled());
+    EXPECT_TRUE(folded.isConstant());
+    EXPECT_TRUE(folded.evaluateBool(*pkt4_));
+
+    CompiledExpression not_folded(parse(Option::V4, "member('foo')"));
+    EXPECT_TRUE(not_folded.isCompiled());
+    EXPECT_FALSE(not_folded.isConstant());
+
+    // Folded sub-expressions.
+    CompiledExpression partial(parse(Option::V4, "option[100].text == "
+                                     "concat('hun', 'dred4')"));
+    EXPECT_FALSE(partial.isConstant());
+    EXPECT_EQ(0, partial.getInterpretedCount());
+    EXPECT_TRUE(partial.evaluateBool(*pkt4_));
+}
+
+// Checks that common expressions do not use the interpreter.
+TEST_F(CompiledExpressionTest, specialized) {
+    const char* exprs[] = {
+        "option[100].hex == 'hundred4'",
+        "option[100].text == 'hundred4'",
+        "relay4[1].hex == 'AAA'",
+        "substring(option[100].hex, 0, 3) == 'hun'",
+        "substring(option[100].hex, -1, all) == '4'",
+        "option[100].exists and not member('bar')"
+    };
+    for (auto const& text : exprs) {
+        CompiledExpression compiled(parse(Option::V4, text));
+        EXPECT_TRUE(compiled.isCompiled()) << text;
+        EXPECT_EQ(0, compiled.getInterpretedCount()) << text;
+    }
+
+    // Concat uses the interpreter.
+    CompiledExpression compiled(parse(Option::V4, "concat(option[100].hex, "
+                                      "'x') == 'hundred4x'"));
+    EXPECT_TRUE(compiled.isCompiled());
+    EXPECT_NE(0, compiled.getInterpretedCount());
+    EXPECT_TRUE(compiled.evaluateBool(*pkt4_));
+}
+
+// Checks that the right operand of 'and' and 'or' is evaluated only
+// when it decides.
+TEST_F(CompiledExpressionTest, shortCircuit) {
+    boost::shared_ptr<CountingToken> counting(new CountingToken());
+    Expression expr;
+    expr.push_back(TokenPtr(new TokenOption(123, TokenOption::EXISTS)));
+    expr.push_back(counting);
+    expr.push_back(TokenPtr(new TokenHexString("0x01")));
+    expr.push_back(TokenPtr(new TokenEqual()));
+    expr.push_back(TokenPtr(new TokenAnd()));
+
+    CompiledExpression compiled_and(expr);
+    ASSERT_TRUE(compiled_and.isCompiled());
+    EXPECT_FALSE(compiled_and.evaluateBool(*pkt4_));
+    EXPECT_EQ(0, counting->count_);
+
+    // The interpreter evaluates both operands.
+    EXPECT_FALSE(evaluateBool(expr, *pkt4_));
+    EXPECT_EQ(1, counting->count_);
+
+    expr[0].reset(new TokenOption(100, TokenOption::EXISTS));
+    expr[4].reset(new TokenOr());
+    CompiledExpression compiled_or(expr);
+    EXPECT_TRUE(compiled_or.evaluateBool(*pkt4_));
+    EXPECT_EQ(1, counting->count_);
+
+    expr[0].reset(new TokenOption(123, TokenOption::EXISTS));
+    CompiledExpression compiled_or2(expr);
+    EXPECT_FALSE(compiled_or2.evaluateBool(*pkt4_));
+    EXPECT_EQ(2, counting->count_);
+}
+
+// Checks that invalid expressions are interpreted.
+TEST_F(CompiledExpressionTest, invalid) {
+    Expression empty;
+    CompiledExpression compiled_empty(empty);
+    EXPECT_FALSE(compiled_empty.isCompiled());
+    EXPECT_THROW(compiled_empty.evaluateBool(*pkt4_), EvalBadStack);
+
+    // Missing operand.
+    Expression expr;
+    expr.push_back(TokenPtr(new TokenString("foo")));
+    expr.push_back(TokenPtr(new TokenEqual()));
+    CompiledExpression compiled(expr);
+    EXPECT_FALSE(compiled.isCompiled());
+    EXPECT_THROW(compiled.evaluateBool(*pkt4_), EvalBadStack);
+
+    // Not a boolean.
+    expr.clear();
+    expr.push_back(TokenPtr(new TokenString("foo")));
+    CompiledExpression not_bool(expr);
+    EXPECT_TRUE(not_bool.isCompiled());
+    EXPECT_THROW(not_bool.evaluateBool(*pkt4_), EvalTypeError);
+    EXPECT_EQ("foo", not_bool.evaluateString(*pkt4_));
+}
+
+
+// Checks the options required for a match.
+TEST_F(CompiledExpressionTest, requiredOptions) {
+    struct {
+        const char* text;
+        vector<uint16_t> codes;
+    } tests[] = {
+        { "option[100].exists", { 100 } },
+        { "option[100].hex == 'hundred4'", { 100 } },
+        { "'hundred4' == option[100].text", { 100 } },
+        { "option[100].hex == ''", { } },
+        { "substring(option[60].hex, 0, 4) == 'MSFT'", { 60 } },
+        { "option[82].option[1].hex == 'AAA'", { 82 } },
+        { "option[82].option[1].exists", { 82 } },
+        { "relay4[1].hex == 'AAA'", { 82 } },
+        { "vendor[4491].exists", { 125 } },
+        { "vendor-class[4491].exists", { 124 } },
+        { "option[60].exists and option[100].exists", { 60, 100 } },
+        { "option[60].exists or option[100].exists", { } },
+        { "(option[60].exists and option[100].exists) or "
+          "(option[100].exists and member('foo'))", { 100 } },
+        { "not option[100].exists", { } },
+        { "member('foo')", { } },
+        { "concat(option[100].text, 'x') == 'x'", { } }
+    };
+    for (auto const& test : tests) {
+        CompiledExpression compiled(parse(Option::V4, test.text));
+        EXPECT_EQ(test.codes, compiled.getRequiredOptions()) << test.text;
+    }
+
+    CompiledExpression compiled(parse(Option::V4, "option[82].exists and "
+                                      "option[100].exists"));
+    EXPECT_TRUE(compiled.canMatch(*pkt4_));
+    pkt4_->delOption(DHO_DHCP_AGENT_OPTIONS);
+    EXPECT_FALSE(compiled.canMatch(*pkt4_));
+    EXPECT_FALSE(compiled.evaluateBool(*pkt4_));
+
+    // DHCPv6 vendor options.
+    CompiledExpression compiled6(parse(Option::V6, "vendor[4491].option[1].hex "
+                                       "== 0x0102"));
+    EXPECT_EQ(vector<uint16_t>(1, D6O_VENDOR_OPTS),
+              compiled6.getRequiredOptions());
+    EXPECT_FALSE(compiled6.canMatch(*pkt6_));
+}
+
+}
@@ -1,4 +1,4 @@
-// Copyright (C) 2015-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2015-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -398,6 +398,9 @@ public:
     }
 
 protected:
+    /// @brief Compiled expressions retrieve options directly.
+    friend class CompiledExpression;
+
     /// @brief Attempts to retrieve an option
     ///
     /// For this class it simply attempts to retrieve the option from the packet,
@@ -1059,6 +1062,13 @@ public:
     /// @return field type.
     FieldType getField() const;
 
+    /// @brief Returns the universe.
+    ///
+    /// @return universe (V4 or V6).
+    Option::Universe getUniverse() const {
+        return (universe_);
+    }
+
     /// @brief This is a method for evaluating a packet.
     ///
     /// Depending on the value of vendor_id, field type, representation and
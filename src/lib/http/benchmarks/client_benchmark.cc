@@ -0,0 +1,182 @@
+// Copyright (C) 2022 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <asiolink/asio_wrapper.h>
+#include <asiolink/io_address.h>
+#include <asiolink/io_service.h>
+#include <cc/data.h>
+#include <http/client.h>
+#include <http/listener.h>
+#include <http/post_request_json.h>
+#include <http/response_creator.h>
+#include <http/response_creator_factory.h>
+#include <http/response_json.h>
+#include <http/url.h>
+
+#include <benchmark/benchmark.h>
+
+#include <boost/pointer_cast.hpp>
+
+using namespace isc::asiolink;
+using namespace isc::data;
+using namespace isc::http;
+
+namespace {
+
+/// @brief IP address to which the HTTP listener is bound.
+const char* SERVER_ADDRESS = "127.0.0.1";
+
+/// @brief Port number to which the HTTP listener is bound.
+const unsigned short SERVER_PORT = 18123;
+
+/// @brief Number of requests sent by each benchmark iteration.
+const size_t REQUESTS_COUNT = 1000;
+
+/// @brief Request and idle timeouts in milliseconds.
+const long TIMEOUT = 10000;
+
+/// @brief Response creator echoing the JSON body of the requests.
+class EchoResponseCreator : public HttpResponseCreator {
+public:
+
+    /// @brief Create a new request.
+    ///
+    /// @return Pointer to the new instance of the @ref HttpRequest.
+    virtual HttpRequestPtr
+    createNewHttpRequest() const {
+        return (HttpRequestPtr(new PostHttpRequestJson()));
+    }
+
+private:
+
+    /// @brief Creates HTTP response.
+    ///
+    /// @param request Pointer to the HTTP request.
+    /// @param status_code Status code of the response.
+    /// @return Pointer to the generated HTTP response.
+    virtual HttpResponsePtr
+    createStockHttpResponse(const HttpRequestPtr& request,
+                            const HttpStatusCode& status_code) const {
+        HttpVersion http_version(request->context()->http_version_major_,
+                                 request->context()->http_version_minor_);
+        HttpResponsePtr response(new HttpResponseJson(http_version, status_code));
+        response->finalize();
+        return (response);
+    }
+
+    /// @brief Creates HTTP response with the JSON body of the request.
+    ///
+    /// @param request Pointer to the HTTP request.
+    /// @return Pointer to the generated HTTP OK response.
+    virtual HttpResponsePtr
+    createDynamicHttpResponse(HttpRequestPtr request) {
+        HttpResponseJsonPtr response(new HttpResponseJson(request->getHttpVersion(),
+                                                          HttpStatusCode::OK));
+        PostHttpRequestJsonPtr request_json =
+            boost::dynamic_pointer_cast<PostHttpRequestJson>(request);
+        if (request_json && request_json->getBodyAsJson()) {
+            response->setBodyAsJson(request_json->getBodyAsJson());
+        }
+        response->finalize();
+        return (response);
+    }
+};
+
+/// @brief Factory of @ref EchoResponseCreator instances.
+class EchoResponseCreatorFactory : public HttpResponseCreatorFactory {
+public:
+
+    /// @brief Creates a new response creator.
+    ///
+    /// @return Pointer to the new response creator.
+    virtual HttpResponseCreatorPtr create() const {
+        return (HttpResponseCreatorPtr(new EchoResponseCreator()));
+    }
+};
+
+/// @brief Sets the connection limit and pipelining depth arguments.
+///
+/// The first argument is the maximum number of connections (1 to 4), the
+/// second is the maximum number of pipelined requests (1 to 64).
+///
+/// @param b the benchmark.
+void clientArguments(benchmark::internal::Benchmark* b) {
+    for (int connections = 1; connections <= 4; connections *= 2) {
+        for (int pipelined = 1; pipelined <= 64; pipelined *= 4) {
+            b->Args({connections, pipelined});
+        }
+    }
+}
+
+/// @brief Benchmarks requests sent at once to a local HTTP listener.
+///
+/// This is the lease update case of the High Availability: many small
+/// requests are sent to the same destination. The client and the listener
+/// share the same IO service so the benchmark measures the processing
+/// cost of the requests rather than the network latency, which pipelining
+/// hides as well.
+///
+/// @param state the benchmark state.
+void sendRequests(benchmark::State& state) {
+    IOService io_service;
+    HttpResponseCreatorFactoryPtr factory(new EchoResponseCreatorFactory());
+    HttpListener listener(io_service, IOAddress(SERVER_ADDRESS), SERVER_PORT,
+                          TlsContextPtr(), factory,
+                          HttpListener::RequestTimeout(TIMEOUT),
+                          HttpListener::IdleTimeout(TIMEOUT));
+    listener.start();
+
+    HttpClient client(io_service);
+    client.setMaxUrlConnections(state.range(0));
+    client.setMaxPipelinedRequests(state.range(1));
+    Url url("http://127.0.0.1:18123");
+
+    // All iterations send the same request.
+    PostHttpRequestJsonPtr request(new PostHttpRequestJson(HttpRequest::Method::HTTP_POST,
+                                                           "/", HttpVersion::HTTP_11()));
+    ElementPtr body = Element::createMap();
+    body->set("command", Element::create("lease4-update"));
+    request->setBodyAsJson(body);
+    request->finalize();
+
+    size_t sent = 0;
+    size_t failed = 0;
+    for (auto _ : state) {
+        size_t received = 0;
+        for (size_t i = 0; i < REQUESTS_COUNT; ++i) {
+            HttpResponseJsonPtr response(new HttpResponseJson());
+            client.asyncSendRequest(url, TlsContextPtr(), request, response,
+                [&io_service, &received, &failed](const boost::system::error_code& ec,
+                                                  const HttpResponsePtr& response,
+                                                  const std::string& error) {
+                if (ec || !response || !error.empty()) {
+                    ++failed;
+                }
+                if (++received == REQUESTS_COUNT) {
+                    io_service.stop();
+                }
+            });
+        }
+        io_service.run();
+        io_service.get_io_service().reset();
+        sent += REQUESTS_COUNT;
+    }
+
+    client.stop();
+    listener.stop();
+    io_service.poll();
+
+    state.SetItemsProcessed(sent);
+    if (failed > 0) {
+        state.SkipWithError("some requests failed");
+    }
+}
+
+}
+
+BENCHMARK(sendRequests)->Apply(clientArguments)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,24 @@
+// Copyright (C) 2022 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <log/logger_support.h>
+
+#include <benchmark/benchmark.h>
+
+int
+main(int argc, char* argv[]) {
+    // The HTTP client and listener log their activity.
+    isc::log::initLogger();
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return (1);
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    return (0);
+}
@@ -1,4 +1,4 @@
-// Copyright (C) 2018-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2018-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -23,11 +23,12 @@
 
 #include <atomic>
 #include <array>
+#include <chrono>
+#include <deque>
 #include <functional>
 #include <iostream>
 #include <map>
 #include <mutex>
-#include <queue>
 #include <thread>
 
 
@@ -87,11 +88,89 @@ private:
 
 };
 
+/// @brief Checks if the server keeps the connection open after a response.
+///
+/// @param response The received response.
+/// @return true if the response is persistent, i.e. it is an HTTP/1.1
+/// response without the "Connection: close" header or an HTTP/1.0
+/// response with the "Connection: keep-alive" header.
+bool
+isPersistentResponse(const HttpResponse& response) {
+    try {
+        std::string conn_value;
+        try {
+            conn_value = response.getHeader("Connection")->getLowerCaseValue();
+        } catch (...) {
+            // The header was not found.
+        }
+        HttpVersion ver = response.getHttpVersion();
+        return (((ver == HttpVersion::HTTP_10()) && (conn_value == "keep-alive")) ||
+                ((HttpVersion::HTTP_10() < ver) && (conn_value != "close")));
+    } catch (...) {
+        return (false);
+    }
+}
+
 class ConnectionPool;
 
 /// @brief Shared pointer to a connection pool.
 typedef boost::shared_ptr<ConnectionPool> ConnectionPoolPtr;
 
+/// @brief Request descriptor holds parameters associated with the
+/// particular request.
+struct RequestDescriptor {
+    /// @brief Constructor.
+    ///
+    /// @param request Pointer to the request to be sent.
+    /// @param response Pointer to the object into which the response will
+    /// be stored.
+    /// @param request_timeout Requested timeout for the transaction.
+    /// @param callback Pointer to the user callback.
+    /// @param connect_callback pointer to the user callback to be invoked
+    /// when the client connects to the server.
+    /// @param handshake_callback Optional callback invoked when the client
+    /// performs the TLS handshake with the server.
+    /// @param close_callback pointer to the user callback to be invoked
+    /// when the client closes the connection to the server.
+    RequestDescriptor(const HttpRequestPtr& request,
+                      const HttpResponsePtr& response,
+                      const long& request_timeout,
+                      const HttpClient::RequestHandler& callback,
+                      const HttpClient::ConnectHandler& connect_callback,
+                      const HttpClient::HandshakeHandler& handshake_callback,
+                      const HttpClient::CloseHandler& close_callback)
+        : request_(request), response_(response),
+          request_timeout_(request_timeout), callback_(callback),
+          connect_callback_(connect_callback),
+          handshake_callback_(handshake_callback),
+          close_callback_(close_callback) {
+    }
+
+    /// @brief Holds pointer to the request.
+    HttpRequestPtr request_;
+
+    /// @brief Holds pointer to the response.
+    HttpResponsePtr response_;
+
+    /// @brief Holds requested timeout value.
+    long request_timeout_;
+
+    /// @brief Holds pointer to the user callback.
+    HttpClient::RequestHandler callback_;
+
+    /// @brief Holds pointer to the user callback for connect.
+    HttpClient::ConnectHandler connect_callback_;
+
+    /// @brief Holds pointer to the user callback for handshake.
+    HttpClient::HandshakeHandler handshake_callback_;
+
+    /// @brief Holds pointer to the user callback for close.
+    HttpClient::CloseHandler close_callback_;
+};
+
+/// @brief Collection of request descriptors.
+typedef std::deque<RequestDescriptor> RequestDescriptors;
+
 /// @brief Client side HTTP connection to the server.
 ///
 /// Each connection is established with a unique destination identified by the
@@ -104,6 +183,13 @@ typedef boost::shared_ptr<ConnectionPool> ConnectionPoolPtr;
 /// the new request is stored in the FIFO queue. The queued requests to the
 /// particular URL are sent to the server when the current transaction ends.
 ///
+/// A transaction over a persistent connection may also carry several queued
+/// requests pipelined after the first one, as described in section 6.3.2 of
+/// RFC 7230. The requests are sent without waiting for the responses and the
+/// responses are received in the order of the requests. The callback of each
+/// request is invoked when its response has been received. The transaction
+/// ends when the response to the last pipelined request has been received.
+///
 /// The communication over the transport socket is asynchronous. The caller is
 /// notified about the completion of the transaction via a callback that the
 /// caller supplies when initiating the transaction.
@@ -143,13 +229,18 @@ public:
     /// performs the TLS handshake with the server.
     /// @param close_callback Pointer to the callback function to be invoked
     /// when the client closes the socket to the server.
+    /// @param pipelined Requests to be pipelined after the request. Only
+    /// the request and response pointers, the timeouts and the callbacks
+    /// invoked when the transactions complete are used: the connection
+    /// related callbacks are those of the first request.
     void doTransaction(const HttpRequestPtr& request,
                        const HttpResponsePtr& response,
                        const long request_timeout,
                        const HttpClient::RequestHandler& callback,
                        const HttpClient::ConnectHandler& connect_callback,
                        const HttpClient::HandshakeHandler& handshake_callback,
-                       const HttpClient::CloseHandler& close_callback);
+                       const HttpClient::CloseHandler& close_callback,
+                       const RequestDescriptors& pipelined = RequestDescriptors());
 
     /// @brief Closes the socket and cancels the request timer.
     void close();
@@ -220,13 +311,15 @@ private:
     /// performs the TLS handshake with the server.
     /// @param close_callback Pointer to the callback function to be invoked
     /// when the client closes the socket to the server.
+    /// @param pipelined Requests to be pipelined after the request.
     void doTransactionInternal(const HttpRequestPtr& request,
                                const HttpResponsePtr& response,
                                const long request_timeout,
                                const HttpClient::RequestHandler& callback,
                                const HttpClient::ConnectHandler& connect_callback,
                                const HttpClient::HandshakeHandler& handshake_callback,
-                               const HttpClient::CloseHandler& close_callback);
+                               const HttpClient::CloseHandler& close_callback,
+                               const RequestDescriptors& pipelined);
 
     /// @brief Closes the socket and cancels the request timer.
     ///
@@ -312,6 +405,26 @@ private:
     /// @return true if more data is needed, false otherwise.
     bool runParserInternal(const boost::system::error_code& ec, size_t length);
 
+    /// @brief Completes the current request and moves to the next
+    /// pipelined request.
+    ///
+    /// Should be called in a thread safe context.
+    ///
+    /// Invokes the callback of the current request with the received
+    /// response. The data received after this response are supplied to the
+    /// parser of the response to the next pipelined request.
+    ///
+    /// If the server closes the connection after this response, the
+    /// callbacks of the pipelined requests are invoked with an error and
+    /// the pipelining with this server is disabled. The requests are not
+    /// sent again because they have already been written.
+    ///
+    /// @param ec Error code received as a result of the IO operation.
+    ///
+    /// @return true if the transaction continues with the next pipelined
+    /// request, false if it has ended.
+    bool nextPipelinedRequestInternal(const boost::system::error_code& ec);
+
     /// @brief This method schedules timer or reschedules existing timer.
     ///
     /// @param request_timeout New timer interval in milliseconds.
@@ -434,6 +547,13 @@ private:
     /// @brief User supplied callback.
     HttpClient::RequestHandler current_callback_;
 
+    /// @brief Pipelined requests waiting for their responses.
+    RequestDescriptors pipelined_;
+
+    /// @brief Number of responses to the pipelined requests received in
+    /// the current transaction.
+    size_t pipelined_responses_;
+
     /// @brief Output buffer.
     std::string buf_;
 
@@ -455,6 +575,9 @@ private:
     /// @brief Flag to indicate that the TLS handshake has to be performed.
     std::atomic<bool> need_handshake_;
 
+    /// @brief Time the last TLS handshake was started.
+    std::chrono::steady_clock::time_point handshake_start_;
+
     /// @brief Flag to indicate that the socket was closed.
     std::atomic<bool> closed_;
 
@@ -483,7 +606,8 @@ public:
     /// connections allowed per URL.
     explicit ConnectionPool(IOService& io_service, size_t max_url_connections)
         : io_service_(io_service), destinations_(), pool_mutex_(),
-          max_url_connections_(max_url_connections) {
+          max_url_connections_(max_url_connections),
+          max_pipelined_requests_(1), handshake_stats_handler_() {
     }
 
     /// @brief Destructor.
@@ -518,6 +642,130 @@ public:
                                    shared_from_this(), url, tls_context));
     }
 
+    /// @brief Disables pipelining for the given URL and TLS context.
+    ///
+    /// @param url URL for which pipelining should be disabled.
+    /// @param tls_context TLS context for which pipelining should be
+    /// disabled.
+    /// @param reason Reason for disabling pipelining, used in logging.
+    void disablePipelining(const Url& url, const TlsContextPtr& tls_context,
+                           const std::string& reason) {
+        if (MultiThreadingMgr::instance().getMode()) {
+            std::lock_guard<std::mutex> lk(pool_mutex_);
+            disablePipeliningInternal(url, tls_context, reason);
+        } else {
+            disablePipeliningInternal(url, tls_context, reason);
+        }
+    }
+
+    /// @brief Schedule disabling pipelining for the given URL and TLS
+    /// context.
+    ///
+    /// The connections use this method instead of @ref disablePipelining
+    /// because they must not take the pool lock while holding their own
+    /// lock.
+    ///
+    /// @param url URL for which pipelining should be disabled.
+    /// @param tls_context TLS context for which pipelining should be
+    /// disabled.
+    /// @param reason Reason for disabling pipelining, used in logging.
+    void postDisablePipelining(const Url& url, const TlsContextPtr& tls_context,
+                               const std::string& reason) {
+        io_service_.post(std::bind(&ConnectionPool::disablePipelining,
+                                   shared_from_this(), url, tls_context,
+                                   reason));
+    }
+
+    /// @brief Sets the maximum number of concurrent connections per URL.
+    ///
+    /// The new limit also applies to the known destinations. When it is
+    /// lowered the connections in excess are not closed but no new
+    /// connections are opened until their number falls below the limit.
+    ///
+    /// @param max_url_connections New maximum number of connections.
+    /// @throw BadValue if the value is 0.
+    void setMaxUrlConnections(size_t max_url_connections) {
+        if (max_url_connections == 0) {
+            isc_throw(BadValue, "maximum number of connections per URL"
+                      " must be greater than 0");
+        }
+        if (MultiThreadingMgr::instance().getMode()) {
+            std::lock_guard<std::mutex> lk(pool_mutex_);
+            setMaxUrlConnectionsInternal(max_url_connections);
+        } else {
+            setMaxUrlConnectionsInternal(max_url_connections);
+        }
+    }
+
+    /// @brief Fetches the maximum number of concurrent connections per URL.
+    ///
+    /// @return The maximum number of connections.
+    size_t getMaxUrlConnections() {
+        if (MultiThreadingMgr::instance().getMode()) {
+            std::lock_guard<std::mutex> lk(pool_mutex_);
+            return (max_url_connections_);
+        } else {
+            return (max_url_connections_);
+        }
+    }
+
+    /// @brief Sets the maximum number of requests sent over a connection
+    /// without waiting for the responses.
+    ///
+    /// @param max_pipelined_requests New maximum number of requests. The
+    /// value of 1 disables pipelining.
+    /// @throw BadValue if the value is 0.
+    void setMaxPipelinedRequests(size_t max_pipelined_requests) {
+        if (max_pipelined_requests == 0) {
+            isc_throw(BadValue, "maximum number of pipelined requests"
+                      " must be greater than 0");
+        }
+        if (MultiThreadingMgr::instance().getMode()) {
+            std::lock_guard<std::mutex> lk(pool_mutex_);
+            setMaxPipelinedRequestsInternal(max_pipelined_requests);
+        } else {
+            setMaxPipelinedRequestsInternal(max_pipelined_requests);
+        }
+    }
+
+    /// @brief Fetches the maximum number of pipelined requests.
+    ///
+    /// @return The maximum number of requests sent over a connection
+    /// without waiting for the responses.
+    size_t getMaxPipelinedRequests() {
+        if (MultiThreadingMgr::instance().getMode()) {
+            std::lock_guard<std::mutex> lk(pool_mutex_);
+            return (max_pipelined_requests_);
+        } else {
+            return (max_pipelined_requests_);
+        }
+    }
+
+    /// @brief Sets the handler invoked after each TLS handshake.
+    ///
+    /// @param handshake_stats_handler The new handler.
+    void setHandshakeStatsHandler(const HttpClient::HandshakeStatsHandler&
+                                  handshake_stats_handler) {
+        if (MultiThreadingMgr::instance().getMode()) {
+            std::lock_guard<std::mutex> lk(pool_mutex_);
+            handshake_stats_handler_ = handshake_stats_handler;
+        } else {
+            handshake_stats_handler_ = handshake_stats_handler;
+        }
+    }
+
+    /// @brief Fetches the handler invoked after each TLS handshake.
+    ///
+    /// @return The handler, possibly empty.
+    HttpClient::HandshakeStatsHandler getHandshakeStatsHandler() {
+        if (MultiThreadingMgr::instance().getMode()) {
+            std::lock_guard<std::mutex> lk(pool_mutex_);
+            return (handshake_stats_handler_);
+        } else {
+            return (handshake_stats_handler_);
+        }
+    }
+
     /// @brief Queue next request for sending to the server.
     ///
     /// A new transaction is started immediately, if there is no other request
@@ -627,13 +875,16 @@ private:
                 }
 
                 // Dequeue the oldest request and start a transaction for it using
-                // the idle connection.
+                // the idle connection. The next queued requests may be
+                // pipelined with it.
                 RequestDescriptor desc = destination->popNextRequest();
+                RequestDescriptors pipelined = destination->popPipelinedRequests(desc);
                 connection->doTransaction(desc.request_, desc.response_,
                                           desc.request_timeout_, desc.callback_,
                                           desc.connect_callback_,
                                           desc.handshake_callback_,
-                                          desc.close_callback_);
+                                          desc.close_callback_,
+                                          pipelined);
             }
         }
     }
@@ -705,6 +956,53 @@ private:
                                   connect_callback, handshake_callback, close_callback);
     }
 
+    /// @brief Disables pipelining for the given URL and TLS context.
+    ///
+    /// This method should be called in a thread safe context.
+    ///
+    /// @param url URL for which pipelining should be disabled.
+    /// @param tls_context TLS context for which pipelining should be
+    /// disabled.
+    /// @param reason Reason for disabling pipelining, used in logging.
+    void disablePipeliningInternal(const Url& url,
+                                   const TlsContextPtr& tls_context,
+                                   const std::string& reason) {
+        DestinationPtr destination = findDestination(url, tls_context);
+        if (!destination) {
+            return;
+        }
+
+        if (destination->disablePipelining()) {
+            LOG_WARN(http_logger, HTTP_CLIENT_PIPELINING_DISABLED)
+                .arg(url.toText())
+                .arg(reason);
+        }
+    }
+
+    /// @brief Sets the maximum number of concurrent connections per URL.
+    ///
+    /// This method should be called in a thread safe context.
+    ///
+    /// @param max_url_connections New maximum number of connections.
+    void setMaxUrlConnectionsInternal(size_t max_url_connections) {
+        max_url_connections_ = max_url_connections;
+        for (auto const& destination : destinations_) {
+            destination.second->setMaxConnections(max_url_connections);
+        }
+    }
+
+    /// @brief Sets the maximum number of pipelined requests.
+    ///
+    /// This method should be called in a thread safe context.
+    ///
+    /// @param max_pipelined_requests New maximum number of requests.
+    void setMaxPipelinedRequestsInternal(size_t max_pipelined_requests) {
+        max_pipelined_requests_ = max_pipelined_requests;
+        for (auto const& destination : destinations_) {
+            destination.second->setMaxPipelinedRequests(max_pipelined_requests);
+        }
+    }
+
     /// @brief Closes all connections for all URLs and removes associated
     /// information from the connection pool.
     ///
@@ -750,58 +1048,6 @@ private:
         }
     }
 
-    /// @brief Request descriptor holds parameters associated with the
-    /// particular request.
-    struct RequestDescriptor {
-        /// @brief Constructor.
-        ///
-        /// @param request Pointer to the request to be sent.
-        /// @param response Pointer to the object into which the response will
-        /// be stored.
-        /// @param request_timeout Requested timeout for the transaction.
-        /// @param callback Pointer to the user callback.
-        /// @param connect_callback pointer to the user callback to be invoked
-        /// when the client connects to the server.
-        /// @param handshake_callback Optional callback invoked when the client
-        /// performs the TLS handshake with the server.
-        /// @param close_callback pointer to the user callback to be invoked
-        /// when the client closes the connection to the server.
-        RequestDescriptor(const HttpRequestPtr& request,
-                          const HttpResponsePtr& response,
-                          const long& request_timeout,
-                          const HttpClient::RequestHandler& callback,
-                          const HttpClient::ConnectHandler& connect_callback,
-                          const HttpClient::HandshakeHandler& handshake_callback,
-                          const HttpClient::CloseHandler& close_callback)
-            : request_(request), response_(response),
-              request_timeout_(request_timeout), callback_(callback),
-              connect_callback_(connect_callback),
-              handshake_callback_(handshake_callback),
-              close_callback_(close_callback) {
-        }
-
-        /// @brief Holds pointer to the request.
-        HttpRequestPtr request_;
-
-        /// @brief Holds pointer to the response.
-        HttpResponsePtr response_;
-
-        /// @brief Holds requested timeout value.
-        long request_timeout_;
-
-        /// @brief Holds pointer to the user callback.
-        HttpClient::RequestHandler callback_;
-
-        /// @brief Holds pointer to the user callback for connect.
-        HttpClient::ConnectHandler connect_callback_;
-
-        /// @brief Holds pointer to the user callback for handshake.
-        HttpClient::HandshakeHandler handshake_callback_;
-
-        /// @brief Holds pointer to the user callback for close.
-        HttpClient::CloseHandler close_callback_;
-    };
-
     /// @brief Type of URL and TLS context pairs.
     typedef std::pair<Url, TlsContextPtr> DestinationDescriptor;
 
@@ -819,9 +1065,14 @@ private:
         /// @param tls_context server TLS context of this destination
         /// @param max_connections maximum number of concurrent connections
         /// allowed for in the list URL
-        Destination(Url url, TlsContextPtr tls_context, size_t max_connections)
+        /// @param max_pipelined_requests maximum number of requests sent
+        /// over a connection without waiting for the responses
+        Destination(Url url, TlsContextPtr tls_context, size_t max_connections,
+                    size_t max_pipelined_requests = 1)
             : url_(url), tls_context_(tls_context),
-              max_connections_(max_connections), connections_(), queue_(),
+              max_connections_(max_connections),
+              max_pipelined_requests_(max_pipelined_requests),
+              pipelining_disabled_(false), connections_(), queue_(),
               last_queue_warn_time_(min_date_time), last_queue_size_(0) {
         }
 
@@ -865,9 +1116,7 @@ private:
         /// @note This should be called in a thread safe context.
         void closeAllConnections() {
             // Flush the queue.
-            while (!queue_.empty()) {
-                queue_.pop();
-            }
+            queue_.clear();
 
             for (auto const& connection : connections_) {
                 connection->close();
@@ -976,6 +1225,33 @@ private:
             return (max_connections_);
         }
 
+        /// @brief Sets the maximum number of connections.
+        ///
+        /// @param max_connections the maximum number of connections.
+        void setMaxConnections(size_t max_connections) {
+            max_connections_ = max_connections;
+        }
+
+        /// @brief Sets the maximum number of pipelined requests.
+        ///
+        /// @param max_pipelined_requests the maximum number of requests
+        /// sent over a connection without waiting for the responses.
+        void setMaxPipelinedRequests(size_t max_pipelined_requests) {
+            max_pipelined_requests_ = max_pipelined_requests;
+        }
+
+        /// @brief Disables pipelining for this destination.
+        ///
+        /// Pipelining remains disabled until the destination is removed,
+        /// i.e. until the client is stopped.
+        ///
+        /// @return true if pipelining was enabled.
+        bool disablePipelining() {
+            bool enabled = ((max_pipelined_requests_ > 1) && !pipelining_disabled_);
+            pipelining_disabled_ = true;
+            return (enabled);
+        }
+
         /// @brief Indicates if request queue is empty.
         ///
         /// @return true if there are no requests queued.
@@ -990,7 +1266,7 @@ private:
         ///
         /// @param desc RequestDescriptor to queue.
         void pushRequest(RequestDescriptor desc) {
-            queue_.push(desc);
+            queue_.push_back(desc);
             size_t size = queue_.size();
             // If the queue size is larger than the threshold and growing, issue a
             // periodic warning.
@@ -1018,10 +1294,34 @@ private:
             }
 
             RequestDescriptor desc = queue_.front();
-            queue_.pop();
+            queue_.pop_front();
             return (desc);
         }
 
+        /// @brief Removes the requests to be pipelined with a request
+        /// from the front of the request queue.
+        ///
+        /// Only the requests asking for a persistent connection are
+        /// pipelined after a request asking for a persistent connection.
+        ///
+        /// @param first the request starting the transaction.
+        /// @return the requests to be sent after the first one, possibly
+        /// none.
+        RequestDescriptors popPipelinedRequests(const RequestDescriptor& first) {
+            RequestDescriptors pipelined;
+            if (pipelining_disabled_ || !first.request_->isPersistent()) {
+                return (pipelined);
+            }
+
+            while (!queue_.empty() &&
+                   (pipelined.size() + 1 < max_pipelined_requests_) &&
+                   queue_.front().request_->isPersistent()) {
+                pipelined.push_back(queue_.front());
+                queue_.pop_front();
+            }
+            return (pipelined);
+        }
+
     private:
         /// @brief URL supported by this destination.
         Url url_;
@@ -1032,11 +1332,19 @@ private:
         /// @brief Maximum number of concurrent connections for this destination.
         size_t max_connections_;
 
+        /// @brief Maximum number of requests sent over a connection without
+        /// waiting for the responses.
+        size_t max_pipelined_requests_;
+
+        /// @brief Boolean flag indicating if pipelining was disabled after
+        /// an error.
+        bool pipelining_disabled_;
+
         /// @brief List of concurrent connections.
         std::list<ConnectionPtr> connections_;
 
         /// @brief Holds the queue of request for this destination.
-        std::queue<RequestDescriptor> queue_;
+        RequestDescriptors queue_;
 
         /// @brief Time the last queue size warning was issued.
         ptime last_queue_warn_time_;
@@ -1059,7 +1367,8 @@ private:
                                   const TlsContextPtr& tls_context) {
         const DestinationDescriptor& desc = std::make_pair(url, tls_context);
         DestinationPtr destination(new Destination(url, tls_context,
-                                                   max_url_connections_));
+                                                   max_url_connections_,
+                                                   max_pipelined_requests_));
         destinations_[desc] = destination;
         return (destination);
     }
@@ -1115,6 +1424,12 @@ private:
 
     /// @brief Maximum number of connections per URL and TLS context.
     size_t max_url_connections_;
+
+    /// @brief Maximum number of pipelined requests per connection.
+    size_t max_pipelined_requests_;
+
+    /// @brief Handler invoked after each TLS handshake.
+    HttpClient::HandshakeStatsHandler handshake_stats_handler_;
 };
 
 Connection::Connection(IOService& io_service,
@@ -1124,9 +1439,10 @@ Connection::Connection(IOService& io_service,
     : conn_pool_(conn_pool), url_(url), tls_context_(tls_context),
       tcp_socket_(), tls_socket_(), timer_(io_service),
       current_request_(), current_response_(), parser_(),
-      current_callback_(), buf_(), input_buf_(), current_transid_(0),
+      current_callback_(), pipelined_(), pipelined_responses_(0), buf_(),
+      input_buf_(), current_transid_(0),
       close_callback_(), started_(false), need_handshake_(false),
-      closed_(false) {
+      handshake_start_(), closed_(false) {
     if (!tls_context) {
         tcp_socket_.reset(new asiolink::TCPSocket<SocketCallback>(io_service));
     } else {
@@ -1147,6 +1463,8 @@ Connection::resetState() {
     current_response_.reset();
     parser_.reset();
     current_callback_ = HttpClient::RequestHandler();
+    pipelined_.clear();
+    pipelined_responses_ = 0;
 }
 
 void
@@ -1221,16 +1539,17 @@ Connection::doTransaction(const HttpRequestPtr& request,
                           const HttpClient::RequestHandler& callback,
                           const HttpClient::ConnectHandler& connect_callback,
                           const HttpClient::HandshakeHandler& handshake_callback,
-                          const HttpClient::CloseHandler& close_callback) {
+                          const HttpClient::CloseHandler& close_callback,
+                          const RequestDescriptors& pipelined) {
     if (MultiThreadingMgr::instance().getMode()) {
         std::lock_guard<std::mutex> lk(mutex_);
         doTransactionInternal(request, response, request_timeout,
                               callback, connect_callback, handshake_callback,
-                              close_callback);
+                              close_callback, pipelined);
     } else {
         doTransactionInternal(request, response, request_timeout,
                               callback, connect_callback, handshake_callback,
-                              close_callback);
+                              close_callback, pipelined);
     }
 }
 
@@ -1241,7 +1560,8 @@ Connection::doTransactionInternal(const HttpRequestPtr& request,
                                   const HttpClient::RequestHandler& callback,
                                   const HttpClient::ConnectHandler& connect_callback,
                                   const HttpClient::HandshakeHandler& handshake_callback,
-                                  const HttpClient::CloseHandler& close_callback) {
+                                  const HttpClient::CloseHandler& close_callback,
+                                  const RequestDescriptors& pipelined) {
     try {
         started_ = true;
         current_request_ = request;
@@ -1268,6 +1588,25 @@ Connection::doTransactionInternal(const HttpRequestPtr& request,
             .arg(HttpMessageParserBase::logFormatHttpMessage(request->toString(),
                                                              MAX_LOGGED_MESSAGE_SIZE));
 
+        // The pipelined requests are sent right after the first one.
+        pipelined_ = pipelined;
+        pipelined_responses_ = 0;
+        for (auto const& desc : pipelined_) {
+            std::string pipelined_request = desc.request_->toString();
+            buf_ += pipelined_request;
+
+            LOG_DEBUG(http_logger, isc::log::DBGLVL_TRACE_DETAIL,
+                      HTTP_CLIENT_REQUEST_SEND)
+                .arg(desc.request_->toBriefString())
+                .arg(url_.toText());
+
+            LOG_DEBUG(http_logger, isc::log::DBGLVL_TRACE_DETAIL_DATA,
+                      HTTP_CLIENT_REQUEST_SEND_DETAILS)
+                .arg(url_.toText())
+                .arg(HttpMessageParserBase::logFormatHttpMessage(pipelined_request,
+                                                                 MAX_LOGGED_MESSAGE_SIZE));
+        }
+
         // Setup request timer.
         scheduleTimer(request_timeout);
 
@@ -1426,6 +1765,20 @@ Connection::terminateInternal(const boost::system::error_code& ec,
             }
         }
 
+        // The requests pipelined after the failed one won't get their
+        // responses. If some responses to the pipelined requests have
+        // been received, the server probably doesn't support pipelining.
+        RequestDescriptors unanswered;
+        unanswered.swap(pipelined_);
+        if (!response && (pipelined_responses_ > 0)) {
+            ConnectionPoolPtr conn_pool = conn_pool_.lock();
+            if (conn_pool) {
+                conn_pool->postDisablePipelining(url_, tls_context_,
+                                                 parsing_error.empty() ?
+                                                 ec.message() : parsing_error);
+            }
+        }
+
         try {
             // The callback should take care of its own exceptions but one
             // never knows.
@@ -1438,11 +1791,28 @@ Connection::terminateInternal(const boost::system::error_code& ec,
         } catch (...) {
         }
 
+        for (auto const& desc : unanswered) {
+            try {
+                if (MultiThreadingMgr::instance().getMode()) {
+                    UnlockGuard<std::mutex> lock(mutex_);
+                    desc.callback_(ec, HttpResponsePtr(), parsing_error);
+                } else {
+                    desc.callback_(ec, HttpResponsePtr(), parsing_error);
+                }
+            } catch (...) {
+            }
+        }
+
         // If we're not requesting connection persistence or the
-        // connection has timed out, we should close the socket.
+        // connection has timed out, we should close the socket. The
+        // socket is also closed when the server doesn't keep it open
+        // or when the responses to the pipelined requests may still
+        // be received.
         if (!closed_ &&
             (!current_request_->isPersistent() ||
-             (ec == boost::asio::error::timed_out))) {
+             (ec == boost::asio::error::timed_out) ||
+             (response && !isPersistentResponse(*response)) ||
+             !unanswered.empty())) {
             closeInternal();
         }
 
@@ -1479,6 +1849,7 @@ Connection::doHandshake(const uint64_t transid) {
                                        transid,
                                        ph::_1));
     try {
+       handshake_start_ = std::chrono::steady_clock::now();
        tls_socket_->handshake(socket_cb);
 
     } catch (...) {
@@ -1597,6 +1968,24 @@ Connection::handshakeCallback(HttpClient::ConnectHandler handshake_callback,
         return;
     }
 
+    // Report the outcome of the handshake unless it was aborted.
+    if (!ec || (ec.value() != boost::asio::error::operation_aborted)) {
+        ConnectionPoolPtr conn_pool = conn_pool_.lock();
+        HttpClient::HandshakeStatsHandler handshake_stats_handler;
+        if (conn_pool) {
+            handshake_stats_handler = conn_pool->getHandshakeStatsHandler();
+        }
+        if (handshake_stats_handler && tls_socket_) {
+            bool resumed = (!ec && tls_socket_->getTlsStream().isSessionReused());
+            try {
+                handshake_stats_handler(url_, ec, resumed,
+                                        std::chrono::steady_clock::now() -
+                                        handshake_start_);
+            } catch (...) {
+            }
+        }
+    }
+
     // Run user defined handshake callback if specified.
     if (handshake_callback) {
         // If the user defined callback indicates that the connection
@@ -1719,29 +2108,123 @@ Connection::runParserInternal(const boost::system::error_code& ec,
         parser_->poll();
     }
 
-    // If the parser still needs data, let's schedule another receive.
-    if (parser_->needData()) {
-        return (true);
+    // The received data may hold the responses to several pipelined
+    // requests.
+    for (;;) {
+        // If the parser still needs data, let's schedule another receive.
+        if (parser_->needData()) {
+            return (true);
 
-    } else if (parser_->httpParseOk()) {
-        // No more data needed and parsing has been successful so far. Let's
-        // try to finalize the response parsing.
-        try {
-            current_response_->finalize();
-            terminateInternal(ec);
+        } else if (parser_->httpParseOk()) {
+            // No more data needed and parsing has been successful so far. Let's
+            // try to finalize the response parsing.
+            try {
+                current_response_->finalize();
 
-        } catch (const std::exception& ex) {
-            // If there is an error here, we need to return the error message.
-            terminateInternal(ec, ex.what());
+            } catch (const std::exception& ex) {
+                // If there is an error here, we need to return the error message.
+                terminateInternal(ec, ex.what());
+                return (false);
+            }
+
+            if (pipelined_.empty()) {
+                terminateInternal(ec);
+                return (false);
+            }
+
+            // Continue with the response to the next pipelined request.
+            if (!nextPipelinedRequestInternal(ec)) {
+                return (false);
+            }
+
+        } else {
+            // Parsing was unsuccessful. Let's pass the error message held in the
+            // parser.
+            terminateInternal(ec, parser_->getErrorMessage());
+            return (false);
         }
+    }
+}
 
-    } else {
-        // Parsing was unsuccessful. Let's pass the error message held in the
-        // parser.
-        terminateInternal(ec, parser_->getErrorMessage());
+bool
+Connection::nextPipelinedRequestInternal(const boost::system::error_code& ec) {
+    // The server closes the connection after this response so the
+    // pipelined requests won't get their responses. They were all written
+    // before the responses were read so the server may have processed
+    // some of them: they are not sent again, as for a request which fails
+    // without pipelining. End the transaction and fail them.
+    if (!isPersistentResponse(*current_response_)) {
+        RequestDescriptors unanswered;
+        unanswered.swap(pipelined_);
+        ConnectionPoolPtr conn_pool = conn_pool_.lock();
+        if (conn_pool) {
+            conn_pool->postDisablePipelining(url_, tls_context_,
+                                             "the server closes the connection");
+        }
+        terminateInternal(ec);
+
+        for (auto const& desc : unanswered) {
+            try {
+                if (MultiThreadingMgr::instance().getMode()) {
+                    UnlockGuard<std::mutex> lock(mutex_);
+                    desc.callback_(ec, HttpResponsePtr(),
+                                   "the server closed the connection");
+                } else {
+                    desc.callback_(ec, HttpResponsePtr(),
+                                   "the server closed the connection");
+                }
+            } catch (...) {
+            }
+        }
+        return (false);
     }
 
-    return (false);
+    LOG_DEBUG(http_logger, isc::log::DBGLVL_TRACE_BASIC,
+              HTTP_SERVER_RESPONSE_RECEIVED)
+        .arg(url_.toText());
+
+    LOG_DEBUG(http_logger, isc::log::DBGLVL_TRACE_BASIC_DATA,
+              HTTP_SERVER_RESPONSE_RECEIVED_DETAILS)
+        .arg(url_.toText())
+        .arg(parser_->getBufferAsString(MAX_LOGGED_MESSAGE_SIZE));
+
+    HttpResponsePtr response = current_response_;
+    HttpClient::RequestHandler callback = current_callback_;
+    std::string unparsed_data = parser_->getUnparsedData();
+
+    // Move to the next pipelined request. The data received after the
+    // current response belong to the next response.
+    RequestDescriptor next = pipelined_.front();
+    pipelined_.pop_front();
+    ++pipelined_responses_;
+    current_request_ = next.request_;
+    current_response_ = next.response_;
+    current_callback_ = next.callback_;
+    parser_.reset(new HttpResponseParser(*current_response_));
+    parser_->initModel();
+    if (!unparsed_data.empty()) {
+        parser_->postBuffer(static_cast<const void*>(unparsed_data.data()),
+                            unparsed_data.size());
+        parser_->poll();
+    }
+    scheduleTimer(next.request_timeout_);
+
+    uint64_t transid = current_transid_;
+    try {
+        // The callback should take care of its own exceptions but one
+        // never knows.
+        if (MultiThreadingMgr::instance().getMode()) {
+            UnlockGuard<std::mutex> lock(mutex_);
+            callback(ec, response, "");
+        } else {
+            callback(ec, response, "");
+        }
+    } catch (...) {
+    }
+
+    // The transaction may have been terminated, e.g. by closing the
+    // connection, while the callback was running.
+    return (isTransactionOngoing() && (transid == current_transid_));
 }
 
 void
@@ -1998,6 +2481,31 @@ HttpClient::asyncSendRequest(const Url& url,
                                     handshake_callback, close_callback);
 }
 
+void
+HttpClient::setMaxUrlConnections(size_t max_url_connections) {
+    impl_->conn_pool_->setMaxUrlConnections(max_url_connections);
+}
+
+size_t
+HttpClient::getMaxUrlConnections() const {
+    return (impl_->conn_pool_->getMaxUrlConnections());
+}
+
+void
+HttpClient::setMaxPipelinedRequests(size_t max_pipelined_requests) {
+    impl_->conn_pool_->setMaxPipelinedRequests(max_pipelined_requests);
+}
+
+size_t
+HttpClient::getMaxPipelinedRequests() const {
+    return (impl_->conn_pool_->getMaxPipelinedRequests());
+}
+
+void
+HttpClient::setHandshakeStatsHandler(const HandshakeStatsHandler& handshake_stats_handler) {
+    impl_->conn_pool_->setHandshakeStatsHandler(handshake_stats_handler);
+}
+
 void
 HttpClient::closeIfOutOfBand(int socket_fd)  {
     return (impl_->conn_pool_->closeIfOutOfBand(socket_fd));
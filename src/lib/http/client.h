@@ -1,4 +1,4 @@
-// Copyright (C) 2018-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2018-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -15,6 +15,7 @@
 #include <http/response.h>
 #include <http/http_thread_pool.h>
 #include <boost/shared_ptr.hpp>
+#include <chrono>
 #include <functional>
 #include <string>
 #include <thread>
@@ -61,14 +62,39 @@ class HttpClientImpl;
 ///
 /// Furthermore, the class supports two modes of operation: single-threaded
 /// and multi-threaded mode. In single-threaded mode, all IO is driven by
-/// an external IOService passed into the class constructor, and ultimately
+/// an external IOService passed into the class constructor, and by default
 /// only a single connection per URL can be open at any given time.
 ///
 /// In multi-threaded mode an internal thread pool driven by a private
 /// IOService instance is used to support multiple concurrent connections
-/// per URL. Currently, the number of connections per URL is set to the
+/// per URL. By default, the number of connections per URL is set to the
 /// number of threads in the thread pool.
 ///
+/// The maximum number of connections per URL can be changed with
+/// @ref HttpClient::setMaxUrlConnections. The connections are opened on
+/// demand, when a request is sent and all open connections are busy, until
+/// the limit is reached. Next requests are queued.
+///
+/// The client may also send the queued requests over a persistent connection
+/// without waiting for the responses to the previous requests (HTTP/1.1
+/// pipelining, RFC 7230 section 6.3.2), up to the number set with
+/// @ref HttpClient::setMaxPipelinedRequests. The responses are matched to
+/// the requests in order. Pipelining is disabled by default because some
+/// servers don't support it and because the requests following a failed
+/// request are not retried. When the server closes the connection before
+/// responding to all the pipelined requests, the callbacks of the
+/// unanswered requests are invoked with an error, as they may have been
+/// processed, and pipelining is disabled for the destination. When any
+/// other error occurs after some responses to the pipelined requests have
+/// been received, the callbacks of the unanswered requests are invoked with
+/// the error and pipelining is disabled for the destination as well.
+///
+/// TLS connections to a server established with the same TLS context
+/// resume the TLS session of the previous connections when the server
+/// allows it, which avoids the cost of a full handshake. The outcome and
+/// the duration of the handshakes can be observed with
+/// @ref HttpClient::setHandshakeStatsHandler.
+///
 /// The client tests the persistent connection for usability before sending
 /// a request by trying to read from the socket (with message peeking). If
 /// the socket is usable the client uses it to transmit the request.
@@ -132,6 +158,21 @@ public:
     /// It is passed the native socket handler of the connection's TCP socket.
     typedef std::function<void(const int)> CloseHandler;
 
+    /// @brief Optional handler invoked after each TLS handshake performed
+    /// by the client.
+    ///
+    /// It is passed the URL of the server, the IO error code of the
+    /// handshake, a flag indicating if a previous TLS session was resumed
+    /// and the duration of the handshake. It is used to gather handshake
+    /// statistics and is invoked before the @ref HandshakeHandler of the
+    /// request. In multi-threaded mode it is invoked from the client
+    /// threads.
+    typedef std::function<void(const Url&,
+                               const boost::system::error_code&,
+                               const bool,
+                               const std::chrono::steady_clock::duration&)>
+        HandshakeStatsHandler;
+
     /// @brief Constructor.
     ///
     /// @param io_service IO service to be used by the HTTP client.
@@ -292,6 +333,40 @@ public:
     /// @param socket_fd socket descriptor to check
     void closeIfOutOfBand(int socket_fd);
 
+    /// @brief Sets the maximum number of concurrent connections per URL.
+    ///
+    /// @param max_url_connections maximum number of connections.
+    /// @throw BadValue if the value is 0.
+    void setMaxUrlConnections(size_t max_url_connections);
+
+    /// @brief Fetches the maximum number of concurrent connections per URL.
+    ///
+    /// @return maximum number of connections.
+    size_t getMaxUrlConnections() const;
+
+    /// @brief Sets the maximum number of requests sent over a connection
+    /// without waiting for the responses.
+    ///
+    /// The connect, handshake and close callbacks of the first request
+    /// are used for the requests pipelined with it.
+    ///
+    /// @param max_pipelined_requests maximum number of pipelined requests.
+    /// The value of 1 (the default) disables pipelining.
+    /// @throw BadValue if the value is 0.
+    void setMaxPipelinedRequests(size_t max_pipelined_requests);
+
+    /// @brief Fetches the maximum number of pipelined requests.
+    ///
+    /// @return maximum number of requests sent over a connection without
+    /// waiting for the responses.
+    size_t getMaxPipelinedRequests() const;
+
+    /// @brief Sets the handler invoked after each TLS handshake.
+    ///
+    /// @param handshake_stats_handler Handler receiving the outcome and the
+    /// duration of the handshakes. An empty handler removes the handler.
+    void setHandshakeStatsHandler(const HandshakeStatsHandler& handshake_stats_handler);
+
     /// @brief Fetches a pointer to the internal IOService used to
     /// drive the thread-pool in multi-threaded mode.
     ///
@@ -1,4 +1,4 @@
-// Copyright (C) 2017-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2017-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -34,10 +34,32 @@ HttpConnection::Transaction::Transaction(const HttpResponseCreatorPtr& response_
     : request_(request ? request : response_creator->createNewHttpRequest()),
       parser_(new HttpRequestParser(*request_)),
       input_buf_(),
-      output_buf_() {
+      output_buf_(),
+      body_producer_() {
     parser_->initModel();
 }
 
+bool
+HttpConnection::Transaction::produceOutputBuf() {
+    if (!body_producer_) {
+        return (false);
+    }
+    // Skip empty parts: an empty chunk would end the body.
+    std::string data;
+    bool more = true;
+    while (more && data.empty()) {
+        more = body_producer_(data);
+    }
+    if (!data.empty()) {
+        output_buf_ += HttpResponse::toChunk(data);
+    }
+    if (!more) {
+        output_buf_ += HttpResponse::toChunk(std::string());
+        body_producer_ = HttpResponse::BodyProducer();
+    }
+    return (true);
+}
+
 HttpConnection::TransactionPtr
 HttpConnection::Transaction::create(const HttpResponseCreatorPtr& response_creator) {
     return (boost::make_shared<Transaction>(response_creator));
@@ -245,6 +267,11 @@ HttpConnection::doRead(TransactionPtr transaction) {
 void
 HttpConnection::doWrite(HttpConnection::TransactionPtr transaction) {
     try {
+        // The body of a chunked response is produced when the previous
+        // chunk was sent.
+        if (!transaction->outputDataAvail()) {
+            transaction->produceOutputBuf();
+        }
         if (transaction->outputDataAvail()) {
             // Create instance of the callback. It is safe to pass the local instance
             // of the callback, because the underlying std functions make copies
@@ -277,10 +304,17 @@ HttpConnection::doWrite(HttpConnection::TransactionPtr transaction) {
 
             } else {
                 // The connection is persistent and we are done sending
-                // the previous response. Start listening for the next
-                // requests.
-                setupIdleTimer();
-                doRead();
+                // the previous response. If the client has pipelined the
+                // next request, process the data already received with
+                // the previous one. Otherwise, start listening for the
+                // next requests.
+                std::string pipelined_data = transaction->getParser()->getUnparsedData();
+                if (!pipelined_data.empty()) {
+                    doPipelinedRead(pipelined_data);
+                } else {
+                    setupIdleTimer();
+                    doRead();
+                }
             }
         }
     } catch (...) {
@@ -292,6 +326,7 @@ void
 HttpConnection::asyncSendResponse(const ConstHttpResponsePtr& response,
                                   TransactionPtr transaction) {
     transaction->setOutputBuf(response->toString());
+    transaction->setBodyProducer(response->getBodyProducer());
     doWrite(transaction);
 }
 
@@ -380,6 +415,36 @@ HttpConnection::socketReadCallback(HttpConnection::TransactionPtr transaction,
         transaction->getParser()->poll();
     }
 
+    processReceivedData(transaction);
+}
+
+void
+HttpConnection::doPipelinedRead(const std::string& data) {
+    LOG_DEBUG(http_logger, isc::log::DBGLVL_TRACE_DETAIL_DATA,
+              HTTP_PIPELINED_DATA_RECEIVED)
+        .arg(data.size())
+        .arg(getRemoteEndpointAddressAsText());
+
+    // The responses to the pipelined requests are small writes following
+    // each other: don't make them wait for the acknowledgment of the
+    // previous response (Nagle's algorithm).
+    boost::system::error_code ec;
+    if (tcp_socket_) {
+        tcp_socket_->getASIOSocket().set_option(boost::asio::ip::tcp::no_delay(true), ec);
+    } else if (tls_socket_) {
+        tls_socket_->getASIOSocket().set_option(boost::asio::ip::tcp::no_delay(true), ec);
+    }
+
+    TransactionPtr transaction = Transaction::create(response_creator_);
+    setupRequestTimer(transaction);
+    transaction->getParser()->postBuffer(static_cast<const void*>(data.data()),
+                                         data.size());
+    transaction->getParser()->poll();
+    processReceivedData(transaction);
+}
+
+void
+HttpConnection::processReceivedData(TransactionPtr transaction) {
     if (transaction->getParser()->needData()) {
         // The parser indicates that the some part of the message being
         // received is still missing, so continue to read.
@@ -1,4 +1,4 @@
-// Copyright (C) 2017-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2017-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -210,6 +210,24 @@ protected:
             output_buf_.erase(0, length);
         }
 
+        /// @brief Sets the function producing the rest of a chunked response.
+        ///
+        /// @param producer Function producing the body or an empty function
+        /// when the whole response is in the output buffer.
+        void setBodyProducer(const HttpResponse::BodyProducer& producer) {
+            body_producer_ = producer;
+        }
+
+        /// @brief Appends the next chunk of the response body to the output
+        /// buffer.
+        ///
+        /// The last chunk ends the body and is appended when the producer
+        /// has produced the whole body.
+        ///
+        /// @return false if there is no body producer, true otherwise.
+        /// @throw any exception thrown by the body producer.
+        bool produceOutputBuf();
+
     private:
 
         /// @brief Pointer to the request received over this connection.
@@ -223,6 +241,9 @@ protected:
 
         /// @brief Buffer used for outbound data.
         std::string output_buf_;
+
+        /// @brief Function producing the rest of a chunked response.
+        HttpResponse::BodyProducer body_producer_;
     };
 
 public:
@@ -341,6 +362,26 @@ protected:
                             boost::system::error_code ec,
                             size_t length);
 
+    /// @brief Processes the data supplied to the HTTP parser.
+    ///
+    /// If the parser needs more data the asynchronous read is continued.
+    /// Otherwise, the server prepares a response to the received request
+    /// and starts asynchronous send over the socket.
+    ///
+    /// @param transaction Pointer to the transaction for which the data
+    /// were supplied to the parser.
+    void processReceivedData(TransactionPtr transaction);
+
+    /// @brief Starts processing the next pipelined request.
+    ///
+    /// A client pipelining HTTP/1.1 requests sends them without waiting
+    /// for the responses. The beginning of the next request may have been
+    /// received with the previous one. The requests are processed one after
+    /// another and the responses are sent in the order of the requests.
+    ///
+    /// @param data Data received after the end of the previous request.
+    void doPipelinedRead(const std::string& data);
+
     /// @brief Callback invoked when data is sent over the socket.
     ///
     /// @param transaction Pointer to the transaction for which the callback
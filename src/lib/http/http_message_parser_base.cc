@@ -1,4 +1,4 @@
-// Copyright (C) 2017-2020 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2017-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -72,6 +72,14 @@ HttpMessageParserBase::postBuffer(const void* buf, const size_t buf_size) {
     }
 }
 
+std::string
+HttpMessageParserBase::getUnparsedData() const {
+    if (!httpParseOk() || (buffer_pos_ >= buffer_.size())) {
+        return ("");
+    }
+    return (buffer_.substr(buffer_pos_));
+}
+
 std::string
 HttpMessageParserBase::getBufferAsString(const size_t limit) const {
     std::string message(buffer_.begin(), buffer_.end());
@@ -260,6 +268,11 @@ HttpMessageParserBase::popNextFromBuffer(std::string& next, const size_t limit)
     return (false);
 }
 
+void
+HttpMessageParserBase::unpopFromBuffer(const size_t length) {
+    buffer_pos_ = (length < buffer_pos_ ? buffer_pos_ - length : 0);
+}
+
 bool
 HttpMessageParserBase::isChar(const char c) const {
     // was (c >= 0) && (c <= 127)
@@ -1,4 +1,4 @@
-// Copyright (C) 2017-2020 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2017-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -141,6 +141,19 @@ public:
     /// @param buf_size Size of the data within the buffer.
     void postBuffer(const void* buf, const size_t buf_size);
 
+    /// @brief Returns the data following the parsed message.
+    ///
+    /// A client pipelining HTTP/1.1 requests sends the next requests before
+    /// receiving the response to the first one, so the data read from the
+    /// socket may hold the beginning of the next message after the end of
+    /// the parsed one. These data are left in the buffer by the parser and
+    /// should be provided to the parser of the next message.
+    ///
+    /// @return The data following the end of the message, or an empty
+    /// string if there are none or if the message has not been parsed
+    /// successfully.
+    std::string getUnparsedData() const;
+
     /// @brief Returns parser's input buffer as string.
     ///
     /// @param limit Maximum length of the buffer to be output. If the limit is 0,
@@ -282,6 +295,15 @@ protected:
     /// @return true if data was successfully read, false otherwise.
     bool popNextFromBuffer(std::string& next, const size_t limit = 1);
 
+    /// @brief Returns the last read bytes to the buffer.
+    ///
+    /// This method is used when more data than the remaining part of the
+    /// message have been read from the buffer, e.g. the body and the
+    /// beginning of the next pipelined message.
+    ///
+    /// @param length Number of bytes to be returned to the buffer.
+    void unpopFromBuffer(const size_t length);
+
     /// @brief Checks if specified value is a character.
     ///
     /// @return true, if specified value is a character.
@@ -1,4 +1,4 @@
-// Copyright (C) 2016-2020 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2016-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -445,8 +445,10 @@ HttpRequestParser::bodyHandler() {
             transition(HTTP_BODY_ST, DATA_READ_OK_EVT);
 
         } else {
-            // If there was some extraneous data, ignore it.
+            // If there was some extraneous data, e.g. the beginning of
+            // the next pipelined message, leave it in the buffer.
             if (context_->body_.length() > content_length) {
+                unpopFromBuffer(context_->body_.length() - content_length);
                 context_->body_.resize(content_length);
             }
             transition(HTTP_PARSE_OK_ST, HTTP_PARSE_OK_EVT);
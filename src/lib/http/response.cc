@@ -87,7 +87,21 @@ HttpResponse::create() {
             headers_[hdr->getLowerCaseName()] = hdr;
         }
 
-        if (getDirection() == HttpMessage::OUTBOUND) {
+        if ((getDirection() == HttpMessage::OUTBOUND) && body_producer_) {
+            // The chunked transfer coding was introduced in HTTP/1.1.
+            if (http_version_ < HttpVersion::HTTP_11()) {
+                isc_throw(BadValue, "chunked transfer coding not allowed with"
+                          " HTTP version " << http_version_.major_ << "."
+                          << http_version_.minor_);
+            }
+            HttpHeaderPtr encoding_header(new HttpHeader("Transfer-Encoding",
+                                                         "chunked"));
+            headers_["transfer-encoding"] = encoding_header;
+
+            HttpHeaderPtr date_header(new HttpHeader("Date", getDateHeaderValue()));
+            headers_["date"] = date_header;
+
+        } else if (getDirection() == HttpMessage::OUTBOUND) {
             HttpHeaderPtr length_header(new HttpHeader("Content-Length", boost::lexical_cast<std::string>
                                                        (context_->body_.length())));
             headers_["content-length"] = length_header;
@@ -196,6 +210,13 @@ HttpResponse::getDateHeaderValue() const {
     return (date_time.rfc1123Format());
 }
 
+std::string
+HttpResponse::toChunk(const std::string& data) {
+    std::ostringstream s;
+    s << std::hex << data.size() << crlf << data << crlf;
+    return (s.str());
+}
+
 std::string
 HttpResponse::toBriefString() const {
     checkFinalized();
@@ -223,8 +244,10 @@ HttpResponse::toString() const {
 
     s << crlf;
 
-    // Include message body.
-    s << getBody();
+    // Include message body. The chunked body is sent later.
+    if (!isChunked()) {
+        s << getBody();
+    }
 
     return (s.str());
 }
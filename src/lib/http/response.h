@@ -13,6 +13,7 @@
 #include <http/response_context.h>
 #include <boost/lexical_cast.hpp>
 #include <boost/shared_ptr.hpp>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -98,6 +99,12 @@ typedef boost::shared_ptr<const HttpResponse> ConstHttpResponsePtr;
 class HttpResponse : public HttpMessage {
 public:
 
+    /// @brief Type of the function producing a response body in parts.
+    ///
+    /// It appends the next part of the body to the string and returns
+    /// false when the whole body was already produced.
+    typedef std::function<bool(std::string&)> BodyProducer;
+
     /// @brief Constructor for the inbound HTTP response.
     explicit HttpResponse();
 
@@ -136,7 +143,8 @@ public:
     /// context and validates their values. For the outbound messages, it
     /// automatically appends Content-Length and Date headers to the response.
     /// The Content-Length is set to the body size. The Date is set to the
-    /// current date and time.
+    /// current date and time. When a body producer is set, the response
+    /// uses the chunked transfer coding instead of the Content-Length.
     virtual void create();
 
     /// @brief Completes creation of the HTTP response.
@@ -158,6 +166,37 @@ public:
     /// @brief Returns HTTP response body as string.
     virtual std::string getBody() const;
 
+    /// @brief Sets the function producing the body while it is sent.
+    ///
+    /// This is used for very large bodies which are not held in memory:
+    /// the body is sent with the chunked transfer coding, which requires
+    /// HTTP/1.1, and each part returned by the producer is sent as a chunk.
+    /// It must be called before the response is created.
+    ///
+    /// @param producer function producing the body.
+    void setBodyProducer(const BodyProducer& producer) {
+        body_producer_ = producer;
+    }
+
+    /// @brief Returns the function producing the body.
+    ///
+    /// @return the function or an empty function when the body is
+    /// not produced while it is sent.
+    const BodyProducer& getBodyProducer() const {
+        return (body_producer_);
+    }
+
+    /// @brief Checks if the body is sent with the chunked transfer coding.
+    bool isChunked() const {
+        return (static_cast<bool>(body_producer_));
+    }
+
+    /// @brief Encodes a chunk of a body sent with the chunked transfer coding.
+    ///
+    /// @param data the data of the chunk. An empty chunk ends the body.
+    /// @return the chunk size in hexadecimal, the data and the delimiters.
+    static std::string toChunk(const std::string& data);
+
     /// @brief Retrieves a single JSON element.
     ///
     /// The element must be at top level of the JSON structure.
@@ -193,7 +232,9 @@ public:
     /// @brief Returns HTTP response as string.
     ///
     /// This method is called to generate the outbound HTTP response. Make
-    /// sure to call @c finalize prior to calling this method.
+    /// sure to call @c finalize prior to calling this method. For chunked
+    /// responses only the status line and the headers are returned: the
+    /// body is sent in chunks produced by the body producer.
     virtual std::string toString() const;
 
 protected:
@@ -241,6 +282,9 @@ protected:
     /// @brief Pointer to the @ref HttpResponseContext holding parsed
     /// data.
     HttpResponseContextPtr context_;
+
+    /// @brief Function producing the body while it is sent.
+    BodyProducer body_producer_;
 };
 
 } // namespace http
@@ -86,6 +86,16 @@ HttpResponseJson::setBodyAsJson(const ConstElementPtr& json_body) {
     json_ = json_body;
 }
 
+void
+HttpResponseJson::setBodyAsStreamedJson(const ConstElementPtr& json_body) {
+    context()->body_.clear();
+    JSONStreamWriterPtr writer(new JSONStreamWriter(json_body));
+    setBodyProducer([writer](std::string& out) {
+        return (writer->next(out));
+    });
+    json_ = json_body;
+}
+
 ConstElementPtr
 HttpResponseJson::getJsonElement(const std::string& element_name) const {
     try {
@@ -74,6 +74,15 @@ public:
     /// @param json_body A data structure representing JSON content.
     void setBodyAsJson(const data::ConstElementPtr& json_body);
 
+    /// @brief Sets JSON content converted to text while it is sent.
+    ///
+    /// The content is sent with the chunked transfer coding so very large
+    /// contents, e.g. holding @ref data::StreamedListElement lists, are never
+    /// held in memory as text. It requires HTTP/1.1.
+    ///
+    /// @param json_body A data structure representing JSON content.
+    void setBodyAsStreamedJson(const data::ConstElementPtr& json_body);
+
     /// @brief Retrieves a single JSON element.
     ///
     /// The element must be at top level of the JSON structure.
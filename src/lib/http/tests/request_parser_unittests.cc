@@ -1,4 +1,4 @@
-// Copyright (C) 2016-2019 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2016-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -169,6 +169,11 @@ TEST_F(HttpRequestParserTest, extraneousDataInRequest) {
     EXPECT_FALSE(parser.needData());
     EXPECT_TRUE(parser.httpParseOk());
     EXPECT_TRUE(parser.getErrorMessage().empty());
+
+    // The garbage is left unparsed, e.g. for the parser of the next
+    // pipelined request.
+    EXPECT_EQ("some stuff which, if parsed, will cause errors",
+              parser.getUnparsedData());
 }
 
 
@@ -122,6 +122,64 @@ TEST_F(HttpResponseJsonTest, responseWithContent) {
     EXPECT_EQ(response_string.str(), response.toString());
 }
 
+// Test that the response with streamed JSON content uses the chunked
+// transfer coding and produces the same content.
+TEST_F(HttpResponseJsonTest, responseWithStreamedContent) {
+    // A streamed list returning the items of json_ one per page.
+    auto items = json_->listValue();
+    ElementPtr streamed(new StreamedListElement(
+        [items](const ConstElementPtr& last, std::vector<ElementPtr>& page) {
+            size_t next = 0;
+            if (last) {
+                while (items[next] != last) {
+                    ++next;
+                }
+                ++next;
+            }
+            if (next < items.size()) {
+                page.push_back(items[next]);
+            }
+        }));
+
+    TestHttpResponseJson response(HttpVersion(1, 1), HttpStatusCode::OK);
+    ASSERT_NO_THROW(response.setBodyAsStreamedJson(streamed));
+    ASSERT_NO_THROW(response.finalize());
+    EXPECT_TRUE(response.isChunked());
+
+    std::ostringstream response_string;
+    response_string <<
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: application/json\r\n"
+        "Date: " << response.getDateHeaderValue() << "\r\n"
+        "Transfer-Encoding: chunked\r\n\r\n";
+    EXPECT_EQ(response_string.str(), response.toString());
+
+    // Collect the body produced in parts.
+    HttpResponse::BodyProducer producer = response.getBodyProducer();
+    ASSERT_TRUE(producer);
+    std::string body;
+    size_t parts = 0;
+    while (producer(body)) {
+        ++parts;
+    }
+    EXPECT_EQ(json_string_from_json_, body);
+    // Both pages and the end of the list.
+    EXPECT_EQ(3, parts);
+
+    // The chunked transfer coding requires HTTP/1.1.
+    TestHttpResponseJson response10(HttpVersion(1, 0), HttpStatusCode::OK);
+    ASSERT_NO_THROW(response10.setBodyAsStreamedJson(streamed));
+    EXPECT_THROW(response10.finalize(), HttpResponseError);
+}
+
+// Test the encoding of the chunks.
+TEST_F(HttpResponseJsonTest, toChunk) {
+    EXPECT_EQ("5\r\nhello\r\n", HttpResponse::toChunk("hello"));
+    EXPECT_EQ("1a\r\nabcdefghijklmnopqrstuvwxyz\r\n",
+              HttpResponse::toChunk("abcdefghijklmnopqrstuvwxyz"));
+    EXPECT_EQ("0\r\n\r\n", HttpResponse::toChunk(""));
+}
+
 // Test that generic responses are created properly.
 TEST_F(HttpResponseJsonTest, genericResponse) {
     testGenericResponse(HttpStatusCode::OK, "OK");
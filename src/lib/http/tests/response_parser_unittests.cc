@@ -1,4 +1,4 @@
-// Copyright (C) 2017-2019 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2017-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -186,6 +186,49 @@ TEST_F(HttpResponseParserTest, extraneousDataInResponse) {
     EXPECT_FALSE(parser.needData());
     EXPECT_TRUE(parser.httpParseOk());
     EXPECT_TRUE(parser.getErrorMessage().empty());
+
+    // The garbage is left unparsed, e.g. for the parser of the next
+    // pipelined response.
+    EXPECT_EQ("some stuff which, if parsed, will cause errors",
+              parser.getUnparsedData());
+}
+
+// This test verifies that the responses to pipelined requests received
+// at once can be parsed one after the other.
+TEST_F(HttpResponseParserTest, pipelinedResponses) {
+    std::string preamble = "HTTP/1.1 200 OK\r\n"
+        "Content-Type: application/json\r\n";
+    std::string json1 = "{ \"result\": 0, \"text\": \"first\" }";
+    std::string json2 = "{ \"result\": 0, \"text\": \"second\" }";
+    std::string http_resp = createResponseString(preamble, json1) +
+        createResponseString(preamble, json2);
+
+    // Parse the first response.
+    HttpResponseJson response1;
+    HttpResponseParser parser1(response1);
+    ASSERT_NO_THROW(parser1.initModel());
+    parser1.postBuffer(&http_resp[0], http_resp.size());
+    ASSERT_NO_THROW(parser1.poll());
+    ASSERT_FALSE(parser1.needData());
+    ASSERT_TRUE(parser1.httpParseOk());
+    ASSERT_NO_THROW(response1.finalize());
+    EXPECT_EQ("first", response1.getJsonElement("text")->stringValue());
+
+    // The second response is left unparsed.
+    std::string unparsed = parser1.getUnparsedData();
+    EXPECT_EQ(createResponseString(preamble, json2), unparsed);
+
+    // Parse it with another parser.
+    HttpResponseJson response2;
+    HttpResponseParser parser2(response2);
+    ASSERT_NO_THROW(parser2.initModel());
+    parser2.postBuffer(&unparsed[0], unparsed.size());
+    ASSERT_NO_THROW(parser2.poll());
+    ASSERT_FALSE(parser2.needData());
+    ASSERT_TRUE(parser2.httpParseOk());
+    ASSERT_NO_THROW(response2.finalize());
+    EXPECT_EQ("second", response2.getJsonElement("text")->stringValue());
+    EXPECT_TRUE(parser2.getUnparsedData().empty());
 }
 
 // This test verifies that LWS is parsed correctly. The LWS (linear white
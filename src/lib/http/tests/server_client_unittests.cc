@@ -1,4 +1,4 @@
-// Copyright (C) 2017-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2017-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -29,8 +29,10 @@
 
 #include <functional>
 #include <list>
+#include <set>
 #include <sstream>
 #include <string>
+#include <vector>
 
 using namespace boost::asio::ip;
 using namespace isc::asiolink;
@@ -119,7 +121,8 @@ private:
     /// The first one is useful to test situations when received response can't
     /// be parsed because of the content type mismatch. The second one is useful
     /// to test request timeouts. The third type is used by most of the unit tests
-    /// to test successful transactions.
+    /// to test successful transactions. It carries the "Connection: close"
+    /// header when the request body includes close-connection.
     ///
     /// @param request Pointer to the HTTP request.
     /// @return Pointer to the generated HTTP OK response with no content.
@@ -177,6 +180,10 @@ private:
         // If body was included in the request. Let's copy it.
         if (body) {
             response->setBodyAsJson(body);
+            if (body->get("close-connection")) {
+                response->context()->headers_.push_back(HttpHeaderContext("Connection",
+                                                                          "close"));
+            }
         }
 
         response->finalize();
@@ -698,6 +705,47 @@ TEST_F(HttpListenerTest, persistentConnection) {
     io_service_.poll();
 }
 
+// This test verifies that the server responds in order to the requests
+// pipelined over a persistent connection.
+TEST_F(HttpListenerTest, pipelinedRequests) {
+    // Both requests are sent at once, without waiting for the first response.
+    std::string request = "POST /foo/bar HTTP/1.1\r\n"
+        "Content-Type: application/json\r\n"
+        "Content-Length: 3\r\n\r\n"
+        "{ }";
+    request += request;
+
+    HttpListener listener(io_service_, IOAddress(SERVER_ADDRESS), SERVER_PORT,
+                          TlsContextPtr(), factory_,
+                          HttpListener::RequestTimeout(REQUEST_TIMEOUT),
+                          HttpListener::IdleTimeout(IDLE_TIMEOUT));
+
+    ASSERT_NO_THROW(listener.start());
+
+    ASSERT_NO_THROW(startRequest(request));
+    ASSERT_NO_THROW(runIOService());
+    ASSERT_EQ(1, clients_.size());
+    TestHttpClientPtr client = *clients_.begin();
+    ASSERT_TRUE(client);
+
+    // The client stops after each part of the response, so keep receiving
+    // until both responses are there.
+    std::string expected = httpOk(HttpVersion::HTTP_11()) +
+        httpOk(HttpVersion::HTTP_11());
+    for (unsigned i = 0; (i < 10) && (client->getResponse().size() < expected.size());
+         ++i) {
+        ASSERT_NO_THROW(client->receivePartialResponse());
+        ASSERT_NO_THROW(runIOService());
+    }
+    EXPECT_EQ(expected, client->getResponse());
+
+    // The connection is still persistent.
+    EXPECT_TRUE(client->isConnectionAlive());
+
+    listener.stop();
+    io_service_.poll();
+}
+
 // This test verifies that "keep-alive" connection is closed by the server after
 // an idle time.
 TEST_F(HttpListenerTest, keepAliveTimeout) {
@@ -1797,6 +1845,158 @@ public:
         EXPECT_EQ(-1, monitor.registered_fd_);
     }
 
+    /// @brief Test that the queued requests are pipelined and that the
+    /// responses are matched to the requests in order.
+    void testPipelinedRequests() {
+        // Start the server.
+        ASSERT_NO_THROW(listener_.start());
+
+        // Create a client sending up to 3 requests at once.
+        HttpClient client(io_service_);
+        ASSERT_NO_THROW(client.setMaxPipelinedRequests(3));
+        EXPECT_EQ(3, client.getMaxPipelinedRequests());
+        Url url("http://127.0.0.1:18123");
+
+        // The first request opens the connection, the next ones are queued
+        // and sent together when it completes.
+        std::vector<HttpResponseJsonPtr> responses;
+        std::vector<int> sequences;
+        std::set<int> sockets;
+        const int count = 4;
+        for (int i = 0; i < count; ++i) {
+            PostHttpRequestJsonPtr request = createRequest("sequence", i);
+            HttpResponseJsonPtr response(new HttpResponseJson());
+            responses.push_back(response);
+            ASSERT_NO_THROW(client.asyncSendRequest(url, TlsContextPtr(),
+                                                    request, response,
+                [this, &sequences, count](const boost::system::error_code& ec,
+                                          const HttpResponsePtr& response,
+                                          const std::string& error) {
+                EXPECT_FALSE(ec);
+                EXPECT_TRUE(error.empty()) << error;
+                HttpResponseJsonPtr response_json =
+                    boost::dynamic_pointer_cast<HttpResponseJson>(response);
+                if (response_json) {
+                    ConstElementPtr sequence = response_json->getJsonElement("sequence");
+                    sequences.push_back(sequence ? sequence->intValue() : -1);
+                } else {
+                    sequences.push_back(-1);
+                }
+                if (sequences.size() == count) {
+                    io_service_.stop();
+                }
+            },
+            HttpClient::RequestTimeout(10000),
+            [&sockets](const boost::system::error_code&, const int fd) {
+                sockets.insert(fd);
+                return (true);
+            }));
+        }
+
+        ASSERT_NO_THROW(runIOService());
+
+        // All requests got their responses in order, over one connection.
+        ASSERT_EQ(count, sequences.size());
+        for (int i = 0; i < count; ++i) {
+            EXPECT_EQ(i, sequences[i]);
+        }
+        EXPECT_EQ(1, sockets.size());
+    }
+
+    /// @brief Test that the pipelined requests which don't get their
+    /// responses because the server closes the connection are failed
+    /// rather than sent again.
+    void testPipelinedRequestsServerClose() {
+        // Start the server.
+        ASSERT_NO_THROW(listener_.start());
+
+        // Create a client sending up to 3 requests at once.
+        HttpClient client(io_service_);
+        ASSERT_NO_THROW(client.setMaxPipelinedRequests(3));
+        Url url("http://127.0.0.1:18123");
+
+        // The first request opens the connection, the next three are
+        // pipelined. The server closes the connection after the response
+        // to the second request.
+        std::vector<bool> answered;
+        std::vector<std::string> errors;
+        const int count = 4;
+        for (int i = 0; i < count; ++i) {
+            PostHttpRequestJsonPtr request = (i == 1 ?
+                                              createRequest("close-connection", true) :
+                                              createRequest("sequence", i));
+            HttpResponseJsonPtr response(new HttpResponseJson());
+            ASSERT_NO_THROW(client.asyncSendRequest(url, TlsContextPtr(),
+                                                    request, response,
+                [this, &answered, &errors, count](const boost::system::error_code& ec,
+                                                  const HttpResponsePtr& response,
+                                                  const std::string& error) {
+                EXPECT_FALSE(ec);
+                answered.push_back(static_cast<bool>(response));
+                errors.push_back(error);
+                if (answered.size() == count) {
+                    io_service_.stop();
+                }
+            }));
+        }
+
+        ASSERT_NO_THROW(runIOService());
+
+        // The first two requests got their responses, the last two failed.
+        ASSERT_EQ(count, answered.size());
+        EXPECT_TRUE(answered[0]);
+        EXPECT_TRUE(errors[0].empty()) << errors[0];
+        EXPECT_TRUE(answered[1]);
+        EXPECT_TRUE(errors[1].empty()) << errors[1];
+        for (int i = 2; i < count; ++i) {
+            EXPECT_FALSE(answered[i]);
+            EXPECT_EQ("the server closed the connection", errors[i]);
+        }
+    }
+
+    /// @brief Test that the client opens up to the configured number of
+    /// connections to a destination.
+    void testMaxUrlConnections() {
+        // Start the server.
+        ASSERT_NO_THROW(listener_.start());
+
+        // Create a client allowing 2 connections per URL.
+        HttpClient client(io_service_);
+        EXPECT_EQ(1, client.getMaxUrlConnections());
+        ASSERT_NO_THROW(client.setMaxUrlConnections(2));
+        EXPECT_EQ(2, client.getMaxUrlConnections());
+        Url url("http://127.0.0.1:18123");
+
+        // Send 3 requests at once.
+        std::set<int> sockets;
+        unsigned resp_num = 0;
+        for (int i = 0; i < 3; ++i) {
+            PostHttpRequestJsonPtr request = createRequest("sequence", i);
+            HttpResponseJsonPtr response(new HttpResponseJson());
+            ASSERT_NO_THROW(client.asyncSendRequest(url, TlsContextPtr(),
+                                                    request, response,
+                [this, &resp_num](const boost::system::error_code& ec,
+                                  const HttpResponsePtr&,
+                                  const std::string&) {
+                EXPECT_FALSE(ec);
+                if (++resp_num == 3) {
+                    io_service_.stop();
+                }
+            },
+            HttpClient::RequestTimeout(10000),
+            [&sockets](const boost::system::error_code&, const int fd) {
+                sockets.insert(fd);
+                return (true);
+            }));
+        }
+
+        ASSERT_NO_THROW(runIOService());
+
+        // Two connections were opened, the third request reused one of them.
+        EXPECT_EQ(3, resp_num);
+        EXPECT_EQ(2, sockets.size());
+    }
+
     /// @brief Simulates external registery of Connection TCP sockets
     ///
     /// Provides methods compatible with Connection callbacks for connnect
@@ -2038,4 +2238,48 @@ TEST_F(HttpClientTest, closeIfOutOfBandMultiThreading) {
     ASSERT_NO_FATAL_FAILURE(testCloseIfOutOfBand(HttpVersion(1, 1)));
 }
 
+/// Tests that the queued requests are pipelined.
+TEST_F(HttpClientTest, pipelinedRequests) {
+    ASSERT_NO_FATAL_FAILURE(testPipelinedRequests());
+}
+
+/// Tests that the queued requests are pipelined.
+TEST_F(HttpClientTest, pipelinedRequestsMultiThreading) {
+    MultiThreadingMgr::instance().setMode(true);
+    ASSERT_NO_FATAL_FAILURE(testPipelinedRequests());
+}
+
+/// Tests that the pipelined requests are not sent again when the server
+/// closes the connection.
+TEST_F(HttpClientTest, pipelinedRequestsServerClose) {
+    ASSERT_NO_FATAL_FAILURE(testPipelinedRequestsServerClose());
+}
+
+/// Tests that the pipelined requests are not sent again when the server
+/// closes the connection.
+TEST_F(HttpClientTest, pipelinedRequestsServerCloseMultiThreading) {
+    MultiThreadingMgr::instance().setMode(true);
+    ASSERT_NO_FATAL_FAILURE(testPipelinedRequestsServerClose());
+}
+
+/// Tests that the maximum number of connections per URL is configurable.
+TEST_F(HttpClientTest, maxUrlConnections) {
+    ASSERT_NO_FATAL_FAILURE(testMaxUrlConnections());
+}
+
+/// Tests that the maximum number of connections per URL is configurable.
+TEST_F(HttpClientTest, maxUrlConnectionsMultiThreading) {
+    MultiThreadingMgr::instance().setMode(true);
+    ASSERT_NO_FATAL_FAILURE(testMaxUrlConnections());
+}
+
+/// Tests that the connection limits can't be set to 0.
+TEST_F(HttpClientTest, invalidLimits) {
+    HttpClient client(io_service_);
+    EXPECT_THROW(client.setMaxUrlConnections(0), isc::BadValue);
+    EXPECT_THROW(client.setMaxPipelinedRequests(0), isc::BadValue);
+    EXPECT_EQ(1, client.getMaxUrlConnections());
+    EXPECT_EQ(1, client.getMaxPipelinedRequests());
+}
+
 }
@@ -1,4 +1,4 @@
-// Copyright (C) 2017-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2017-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -27,10 +27,12 @@
 #include <boost/pointer_cast.hpp>
 #include <gtest/gtest.h>
 
+#include <chrono>
 #include <functional>
 #include <list>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #ifdef WITH_BOTAN
 #define DISABLE_SOME_TESTS
@@ -402,6 +404,60 @@ public:
         EXPECT_NE(sequence1->intValue(), sequence2->intValue());
     }
 
+    /// @brief Test that the handshake statistics handler is invoked and
+    /// that the second connection resumes the TLS session of the first.
+    void testSessionResumption() {
+        // Start the server.
+        ASSERT_NO_THROW(listener_->start());
+
+        // Create a client gathering the handshake statistics.
+        HttpClient client(io_service_);
+        Url url("http://127.0.0.1:18123");
+        std::vector<bool> resumed;
+        unsigned failures = 0;
+        client.setHandshakeStatsHandler([&resumed, &failures]
+            (const Url&, const boost::system::error_code& ec,
+             const bool session_resumed,
+             const std::chrono::steady_clock::duration& duration) {
+            if (ec) {
+                ++failures;
+            } else {
+                resumed.push_back(session_resumed);
+            }
+            EXPECT_LE(0, duration.count());
+        });
+
+        // HTTP/1.0 connections are closed after each response so each
+        // request requires a new connection and a new handshake.
+        unsigned resp_num = 0;
+        for (int i = 0; i < 2; ++i) {
+            PostHttpRequestJsonPtr request =
+                createRequest("sequence", i, HttpVersion(1, 0));
+            HttpResponseJsonPtr response(new HttpResponseJson());
+            ASSERT_NO_THROW(client.asyncSendRequest(url, client_context_,
+                                                    request, response,
+                [this, &resp_num](const boost::system::error_code& ec,
+                                  const HttpResponsePtr&,
+                                  const std::string&) {
+                if (++resp_num > 1) {
+                    io_service_.stop();
+                }
+                if (ec) {
+                    ADD_FAILURE() << "asyncSendRequest failed: " << ec.message();
+                }
+            }));
+        }
+        ASSERT_NO_THROW(runIOService());
+
+        EXPECT_EQ(0, failures);
+        ASSERT_EQ(2, resumed.size());
+        EXPECT_FALSE(resumed[0]);
+#ifdef WITH_OPENSSL
+        // Botan doesn't report resumed sessions.
+        EXPECT_TRUE(resumed[1]);
+#endif
+    }
+
     /// @brief Test that the client can communicate with two different
     /// destinations simultaneously.
     void testMultipleDestinations() {
@@ -1236,6 +1292,19 @@ TEST_F(HttpsClientTest, closeBetweenRequestsMultiThreading) {
     ASSERT_NO_FATAL_FAILURE(testConsecutiveRequests(HttpVersion(1, 0)));
 }
 
+// Test that the handshakes are reported and that the TLS sessions are
+// resumed.
+TEST_F(HttpsClientTest, sessionResumption) {
+    ASSERT_NO_FATAL_FAILURE(testSessionResumption());
+}
+
+// Test that the handshakes are reported and that the TLS sessions are
+// resumed.
+TEST_F(HttpsClientTest, sessionResumptionMultiThreading) {
+    MultiThreadingMgr::instance().setMode(true);
+    ASSERT_NO_FATAL_FAILURE(testSessionResumption());
+}
+
 // Test that the client can communicate with two different destinations
 // simultaneously.
 TEST_F(HttpsClientTest, multipleDestinations) {
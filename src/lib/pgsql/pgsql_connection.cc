@@ -26,6 +26,7 @@
 #define PGSQL_STATECODE_LEN 5
 #include <utils/errcodes.h>
 
+#include <poll.h>
 #include <sstream>
 
 using namespace std;
@@ -328,6 +329,15 @@ PgSqlConnection::checkStatementError(const PgSqlResult& r,
         // error class. Note, there is a severity field, but it can be
         // misleadingly returned as fatal. However, a loss of connectivity
         // can lead to a NULL sqlstate with a status of PGRES_FATAL_ERROR.
+#ifdef LIBPQ_HAS_PIPELINING
+        // The statement follows a failed statement in a pipeline: the
+        // error is reported by the failed statement.
+        if (s == PGRES_PIPELINE_ABORTED) {
+            isc_throw(DbOperationError, "statement: " << statement.name
+                      << ", reason: not executed after an error in the pipeline");
+        }
+
+#endif
         const char* sqlstate = PQresultErrorField(r, PG_DIAG_SQLSTATE);
         if ((sqlstate == NULL) ||
             ((memcmp(sqlstate, "08", 2) == 0) ||  // Connection Exception
@@ -533,5 +543,311 @@ PgSqlConnection::updateDeleteQuery(PgSqlTaggedStatement& statement,
     return (boost::lexical_cast<int>(PQcmdTuples(*result_set)));
 }
 
+PgSqlPipeline::PgSqlPipeline(PgSqlConnection& conn)
+    : conn_(conn), statements_() {
+}
+
+bool
+PgSqlPipeline::isSupported() {
+#ifdef LIBPQ_HAS_PIPELINING
+    return (true);
+#else
+    return (false);
+#endif
+}
+
+void
+PgSqlPipeline::add(PgSqlTaggedStatement& statement,
+                   const PsqlBindArray& in_bindings) {
+    if (statement.nbparams != in_bindings.size()) {
+        isc_throw (InvalidOperation, "PgSqlPipeline::add:"
+                   << " expected: " << statement.nbparams
+                   << " parameters, given: " << in_bindings.size()
+                   << ", statement: " << statement.name
+                   << ", SQL: " << statement.text);
+    }
+
+    PendingStatement pending;
+    pending.statement_ = &statement;
+    pending.lengths_ = in_bindings.lengths_;
+    pending.formats_ = in_bindings.formats_;
+    for (size_t i = 0; i < in_bindings.size(); ++i) {
+        const char* value = in_bindings.values_[i];
+        pending.nulls_.push_back(value == 0);
+        if (!value) {
+            pending.values_.push_back(std::string());
+        } else if (in_bindings.formats_[i] == PsqlBindArray::BINARY_FMT) {
+            pending.values_.push_back(std::string(value, in_bindings.lengths_[i]));
+        } else {
+            pending.values_.push_back(std::string(value));
+        }
+    }
+    statements_.push_back(pending);
+}
+
+std::vector<PgSqlResultPtr>
+PgSqlPipeline::execute() {
+    std::vector<PgSqlResultPtr> results;
+    if (statements_.empty()) {
+        return (results);
+    }
+
+    conn_.checkUnusable();
+    try {
+        if (isSupported()) {
+            executePipelined(results);
+        } else {
+            executeSequentially(results);
+        }
+
+    } catch (...) {
+        statements_.clear();
+        throw;
+    }
+
+    std::vector<PendingStatement> statements;
+    statements.swap(statements_);
+
+    // Check the results in order: the first error is reported.
+    for (size_t i = 0; i < results.size(); ++i) {
+        conn_.checkStatementError(*results[i], *statements[i].statement_);
+    }
+
+    return (results);
+}
+
+PGresult*
+PgSqlPipeline::send(const PendingStatement& pending, bool pipelined) {
+    std::vector<const char*> values;
+    for (size_t i = 0; i < pending.values_.size(); ++i) {
+        values.push_back(pending.nulls_[i] ? 0 : pending.values_[i].c_str());
+    }
+
+    const char* const* values_ptr = 0;
+    const int* lengths = 0;
+    const int* formats = 0;
+    if (!values.empty()) {
+        values_ptr = &values[0];
+        lengths = &pending.lengths_[0];
+        formats = &pending.formats_[0];
+    }
+
+    if (!pipelined) {
+        return (PQexecPrepared(conn_.conn_, pending.statement_->name,
+                               pending.statement_->nbparams,
+                               values_ptr, lengths, formats, 0));
+    }
+
+    // The parameters are copied into the output buffer of the connection.
+    if (!PQsendQueryPrepared(conn_.conn_, pending.statement_->name,
+                             pending.statement_->nbparams,
+                             values_ptr, lengths, formats, 0)) {
+        isc_throw(DbOperationError, "unable to send statement: "
+                  << pending.statement_->name << ", reason: "
+                  << PQerrorMessage(conn_.conn_));
+    }
+    return (0);
+}
+
+void
+PgSqlPipeline::executeSequentially(std::vector<PgSqlResultPtr>& results) {
+    // Execute the statements in a transaction unless one is in progress.
+    bool own_transaction = !conn_.isTransactionStarted();
+    if (own_transaction) {
+        conn_.startTransaction();
+    }
+
+    try {
+        bool failed = false;
+        for (auto const& pending : statements_) {
+            PgSqlResultPtr result(new PgSqlResult(send(pending, false)));
+            results.push_back(result);
+            int s = PQresultStatus(*result);
+            if ((s != PGRES_COMMAND_OK) && (s != PGRES_TUPLES_OK)) {
+                // The error is thrown by the results check.
+                failed = true;
+                break;
+            }
+        }
+
+        if (own_transaction) {
+            if (!failed) {
+                conn_.commit();
+            } else {
+                conn_.rollback();
+            }
+        }
+
+    } catch (...) {
+        if (own_transaction) {
+            try {
+                conn_.rollback();
+            } catch (...) {
+            }
+        }
+        throw;
+    }
+}
+
+#ifdef LIBPQ_HAS_PIPELINING
+
+void
+PgSqlPipeline::executePipelined(std::vector<PgSqlResultPtr>& results) {
+    PGconn* pgconn = conn_.conn_;
+    if (!PQenterPipelineMode(pgconn)) {
+        isc_throw(DbOperationError, "unable to enter the pipeline mode: "
+                  << PQerrorMessage(pgconn));
+    }
+
+    bool synced = false;
+    try {
+        if (PQsetnonblocking(pgconn, 1) != 0) {
+            isc_throw(DbOperationError, "unable to enter the non-blocking mode: "
+                      << PQerrorMessage(pgconn));
+        }
+
+        for (auto const& pending : statements_) {
+            send(pending, true);
+            // Read the available results so the server is not blocked.
+            int flushed = PQflush(pgconn);
+            if ((flushed < 0) || ((flushed > 0) && !PQconsumeInput(pgconn))) {
+                isc_throw(DbOperationError, "unable to send statement: "
+                          << pending.statement_->name << ", reason: "
+                          << PQerrorMessage(pgconn));
+            }
+        }
+
+        // Mark the end of the implicit transaction and send everything.
+        if (!PQpipelineSync(pgconn)) {
+            isc_throw(DbOperationError, "unable to send the pipeline "
+                      "synchronization point: " << PQerrorMessage(pgconn));
+        }
+        synced = true;
+        flush();
+
+        // Each statement has a result followed by a null. A null result
+        // instead of the statement result means the connection is lost.
+        for (size_t i = 0; i < statements_.size(); ++i) {
+            PGresult* result = getResult();
+            results.push_back(PgSqlResultPtr(new PgSqlResult(result)));
+            if (!result) {
+                break;
+            }
+            while ((result = getResult()) != 0) {
+                PQclear(result);
+            }
+        }
+
+    } catch (...) {
+        leavePipelineMode(synced);
+        throw;
+    }
+
+    // Read the synchronization point and the results which were not read.
+    leavePipelineMode(synced);
+
+    // The statements which have not been answered are reported as failed.
+    while (results.size() < statements_.size()) {
+        results.push_back(PgSqlResultPtr(new PgSqlResult(0)));
+    }
+}
+
+void
+PgSqlPipeline::leavePipelineMode(bool synced) {
+    PGconn* pgconn = conn_.conn_;
+    try {
+        // The server sends the results which were not read only when
+        // the pipeline is synchronized.
+        if (!synced) {
+            if (!PQpipelineSync(pgconn)) {
+                isc_throw(DbOperationError, "unable to send the pipeline "
+                          "synchronization point: " << PQerrorMessage(pgconn));
+            }
+            flush();
+        }
+
+        // The pipeline mode can't be left while results are pending: they
+        // are discarded up to the synchronization point.
+        while (!PQexitPipelineMode(pgconn)) {
+            PGresult* result = getResult();
+            if (result) {
+                PQclear(result);
+            } else if (PQstatus(pgconn) == CONNECTION_BAD) {
+                isc_throw(DbOperationError, "connection lost: "
+                          << PQerrorMessage(pgconn));
+            }
+        }
+
+        if (PQsetnonblocking(pgconn, 0) != 0) {
+            isc_throw(DbOperationError, "unable to leave the non-blocking "
+                      "mode: " << PQerrorMessage(pgconn));
+        }
+
+    } catch (const std::exception& ex) {
+        // The connection is in an unknown state: it is no longer used
+        // until it is reopened.
+        DB_LOG_ERROR(PGSQL_PIPELINE_FAILED)
+            .arg(ex.what());
+        conn_.markUnusable();
+        conn_.startRecoverDbConnection();
+        isc_throw(DbConnectionUnusable, "unable to leave the pipeline mode: "
+                  << ex.what());
+    }
+}
+
+void
+PgSqlPipeline::flush() {
+    PGconn* pgconn = conn_.conn_;
+    int flushed;
+    while ((flushed = PQflush(pgconn)) > 0) {
+        if (wait(true) && !PQconsumeInput(pgconn)) {
+            flushed = -1;
+            break;
+        }
+    }
+    if (flushed < 0) {
+        isc_throw(DbOperationError, "unable to send statements: "
+                  << PQerrorMessage(pgconn));
+    }
+}
+
+#else
+
+void
+PgSqlPipeline::executePipelined(std::vector<PgSqlResultPtr>& results) {
+    executeSequentially(results);
+}
+
+#endif
+
+bool
+PgSqlPipeline::wait(bool write) {
+    struct pollfd fd;
+    fd.fd = PQsocket(conn_.conn_);
+    fd.events = POLLIN | (write ? POLLOUT : 0);
+    fd.revents = 0;
+    if (fd.fd < 0) {
+        isc_throw(DbOperationError, "no connection to the database");
+    }
+    while (poll(&fd, 1, -1) < 0) {
+        if (errno != EINTR) {
+            isc_throw(DbOperationError, "unable to wait for the database: "
+                      << strerror(errno));
+        }
+    }
+    return ((fd.revents & (POLLIN | POLLERR | POLLHUP)) != 0);
+}
+
+PGresult*
+PgSqlPipeline::getResult() {
+    while (PQisBusy(conn_.conn_)) {
+        wait(false);
+        if (!PQconsumeInput(conn_.conn_)) {
+            break;
+        }
+    }
+    return (PQgetResult(conn_.conn_));
+}
+
 } // end of isc::db namespace
 } // end of isc namespace
@@ -197,6 +197,9 @@ private:
 /// that use instances of PgSqlConnection.
 class PgSqlConnection : public db::DatabaseConnection {
 public:
+    /// @brief The pipeline marks the connection unusable on failure.
+    friend class PgSqlPipeline;
+
     /// @brief Define the PgSql error state for a duplicate key error.
     static const char DUPLICATE_KEY[];
     /// @brief Define the PgSql error state for a null foreign key error.
@@ -524,6 +527,132 @@ public:
 /// @brief Defines a pointer to a PgSqlConnection
 typedef boost::shared_ptr<PgSqlConnection> PgSqlConnectionPtr;
 
+/// @brief Executes prepared statements in the pipeline mode.
+///
+/// The statements added to the pipeline are sent to the database at once
+/// when the pipeline is executed and their results are read afterwards,
+/// so a whole pipeline costs one round trip instead of one per statement.
+/// The connection is in the libpq pipeline and non-blocking modes during
+/// the execution: the results are read while the statements are sent,
+/// which prevents a deadlock when the server output buffer is full.
+///
+/// The statements are executed in a transaction: the transaction of the
+/// connection if one was started or an implicit transaction otherwise.
+/// If a statement fails, the statements which follow it are not executed
+/// and the implicit transaction is rolled back.
+///
+/// When libpq does not support the pipeline mode (before PostgreSQL 14)
+/// the statements are executed one after another in a transaction.
+///
+/// The input parameters are copied when the statement is added, so the
+/// bind arrays can refer to the buffers of an exchange which is reused
+/// for the next statement.
+class PgSqlPipeline : public boost::noncopyable {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// @param conn The connection used to execute the statements.
+    explicit PgSqlPipeline(PgSqlConnection& conn);
+
+    /// @brief Adds a prepared statement to the pipeline.
+    ///
+    /// @param statement The prepared statement.
+    /// @param in_bindings The input parameter bindings.
+    /// @throw InvalidOperation if the number of parameters expected by
+    /// the statement does not match the size of the input bind array.
+    void add(PgSqlTaggedStatement& statement, const PsqlBindArray& in_bindings);
+
+    /// @brief Returns the number of statements in the pipeline.
+    size_t size() const {
+        return (statements_.size());
+    }
+
+    /// @brief Executes the statements of the pipeline.
+    ///
+    /// The pipeline is empty on return. The results are checked by
+    /// @c PgSqlConnection::checkStatementError: the error of the first
+    /// failed statement is thrown.
+    ///
+    /// @return The result sets in the order of the statements.
+    std::vector<PgSqlResultPtr> execute();
+
+    /// @brief Checks if the libpq supports the pipeline mode.
+    ///
+    /// @return true if the statements are pipelined.
+    static bool isSupported();
+
+private:
+
+    /// @brief A statement waiting in the pipeline with a copy of its input
+    /// parameters.
+    struct PendingStatement {
+        /// @brief The prepared statement.
+        PgSqlTaggedStatement* statement_;
+
+        /// @brief The values of the parameters.
+        std::vector<std::string> values_;
+
+        /// @brief The null parameters.
+        std::vector<bool> nulls_;
+
+        /// @brief The lengths of the parameters.
+        std::vector<int> lengths_;
+
+        /// @brief The formats of the parameters.
+        std::vector<int> formats_;
+    };
+
+    /// @brief Sends a statement.
+    ///
+    /// @param pending The statement.
+    /// @param pipelined true to send the statement without waiting for its
+    /// result, false to execute it.
+    /// @return The result of an executed statement, null otherwise.
+    PGresult* send(const PendingStatement& pending, bool pipelined);
+
+    /// @brief Executes the statements in the pipeline mode.
+    ///
+    /// @param [out] results The result sets.
+    void executePipelined(std::vector<PgSqlResultPtr>& results);
+
+    /// @brief Leaves the pipeline and non-blocking modes.
+    ///
+    /// The results which were not read are discarded. When the connection
+    /// can't be restored it is marked unusable and its recovery is started.
+    ///
+    /// @param synced true if the pipeline synchronization point was sent.
+    /// @throw DbConnectionUnusable if the connection can't be restored.
+    void leavePipelineMode(bool synced);
+
+    /// @brief Sends the data buffered by the connection.
+    ///
+    /// @throw DbOperationError if the data can't be sent.
+    void flush();
+
+    /// @brief Executes the statements one after another.
+    ///
+    /// @param [out] results The result sets.
+    void executeSequentially(std::vector<PgSqlResultPtr>& results);
+
+    /// @brief Waits until the connection socket is ready.
+    ///
+    /// @param write true to also wait for the socket to be writable.
+    /// @return true if the socket is readable.
+    bool wait(bool write);
+
+    /// @brief Returns the next result, waiting for it.
+    ///
+    /// @return The result or null when there is no more result.
+    PGresult* getResult();
+
+    /// @brief The connection.
+    PgSqlConnection& conn_;
+
+    /// @brief The statements waiting in the pipeline.
+    std::vector<PendingStatement> statements_;
+};
+
 } // end of isc::db namespace
 } // end of isc namespace
 
@@ -562,4 +562,69 @@ TEST_F(PgSqlConnectionTest, savepoints) {
     TestRowSet three_rows{{1, "one"}, {2, "two"}, {3, "three"}};
     ASSERT_NO_THROW_LOG(testSelect(three_rows, 0, 10));
 }
+
+// Verifies that the statements of a pipeline are executed in order and
+// in a transaction which is rolled back on error.
+TEST_F(PgSqlConnectionTest, pipeline) {
+    // We want to trigger an error so let's add a unique constraint
+    // to the table.
+    ASSERT_NO_THROW(conn_->executeSQL("ALTER TABLE basics ADD CONSTRAINT"
+                                      " unique_int_col UNIQUE (int_col);"));
+
+    // An empty pipeline does nothing.
+    PgSqlPipeline empty(*conn_);
+    EXPECT_EQ(0, empty.size());
+    EXPECT_TRUE(empty.execute().empty());
+
+    // Insert, update and select in one pipeline. The bindings are
+    // copied so they can go out of scope before the execution.
+    TestRowSet rows = {{1, "one"}, {2, "two"}, {3, "three"}};
+    PgSqlPipeline pipeline(*conn_);
+    for (auto const& row : rows) {
+        PsqlBindArray in_bindings;
+        in_bindings.add(row.int_col);
+        in_bindings.addTempString(row.text_col);
+        pipeline.add(tagged_statements[INSERT_VALUE], in_bindings);
+    }
+    PsqlBindArray update_bindings;
+    update_bindings.add(2);
+    update_bindings.addTempString("deux");
+    pipeline.add(tagged_statements[UPDATE_BY_INT_VALUE], update_bindings);
+    PsqlBindArray select_bindings;
+    select_bindings.add(0);
+    select_bindings.add(10);
+    pipeline.add(tagged_statements[GET_BY_INT_RANGE], select_bindings);
+    EXPECT_EQ(5, pipeline.size());
+
+    // Bindings which do not match the statement are rejected.
+    PsqlBindArray bad_bindings;
+    EXPECT_THROW(pipeline.add(tagged_statements[INSERT_VALUE], bad_bindings),
+                 InvalidOperation);
+
+    std::vector<PgSqlResultPtr> results;
+    ASSERT_NO_THROW_LOG(results = pipeline.execute());
+    EXPECT_EQ(0, pipeline.size());
+    ASSERT_EQ(5, results.size());
+    EXPECT_EQ("1", std::string(PQcmdTuples(*results[3])));
+    EXPECT_EQ(3, results[4]->getRows());
+    EXPECT_FALSE(conn_->isTransactionStarted());
+    rows[1].text_col = "deux";
+    ASSERT_NO_THROW_LOG(testSelect(rows, 0, 10));
+
+    // A duplicate makes the whole pipeline fail: the valid insert
+    // before it is rolled back.
+    PsqlBindArray four;
+    four.add(4);
+    four.addTempString("four");
+    pipeline.add(tagged_statements[INSERT_VALUE], four);
+    PsqlBindArray duplicate;
+    duplicate.add(1);
+    duplicate.addTempString("un");
+    pipeline.add(tagged_statements[INSERT_VALUE], duplicate);
+    EXPECT_THROW(pipeline.execute(), DbOperationError);
+    EXPECT_EQ(0, pipeline.size());
+    EXPECT_FALSE(conn_->isTransactionStarted());
+    ASSERT_NO_THROW_LOG(testSelect(rows, 0, 10));
+}
+
 }; // namespace
@@ -9,6 +9,7 @@
 
 #include <stats/observation.h>
 #include <boost/shared_ptr.hpp>
+#include <map>
 #include <mutex>
 #include <string>
 
@@ -75,6 +76,13 @@ public:
     /// @return map with all observations
     isc::data::ConstElementPtr getAll() const;
 
+    /// @brief Returns all observations
+    ///
+    /// @return map of observations indexed by name
+    const std::map<std::string, ObservationPtr>& getObservations() const {
+        return (stats_);
+    }
+
 private:
 
     /// @brief Statistics container
@@ -0,0 +1,179 @@
+// Copyright (C) 2022 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <stats/histogram.h>
+#include <exceptions/exceptions.h>
+#include <limits>
+
+using namespace isc::data;
+
+namespace isc {
+namespace stats {
+
+Histogram::Histogram()
+    : buckets_(), count_(0), sum_(0),
+      min_(std::numeric_limits<uint64_t>::max()), max_(0) {
+}
+
+size_t
+Histogram::bucketIndex(uint64_t value) {
+    if (value < SUB_BUCKETS) {
+        return (value);
+    }
+    // Position of the most significant bit (at least SUB_BUCKET_BITS).
+    size_t msb = 63 - __builtin_clzll(value);
+    size_t shift = msb - SUB_BUCKET_BITS;
+    return ((shift + 1) * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS));
+}
+
+uint64_t
+Histogram::bucketLowerBound(size_t index) {
+    if (index < SUB_BUCKETS) {
+        return (index);
+    }
+    size_t shift = index / SUB_BUCKETS - 1;
+    uint64_t mantissa = (index % SUB_BUCKETS) + SUB_BUCKETS;
+    return (mantissa << shift);
+}
+
+uint64_t
+Histogram::bucketUpperBound(size_t index) {
+    if (index < SUB_BUCKETS) {
+        return (index);
+    }
+    size_t shift = index / SUB_BUCKETS - 1;
+    return (bucketLowerBound(index) + ((static_cast<uint64_t>(1) << shift) - 1));
+}
+
+void
+Histogram::record(uint64_t value, uint64_t count) {
+    if (count == 0) {
+        return;
+    }
+    size_t index = bucketIndex(value);
+    if (index >= buckets_.size()) {
+        buckets_.resize(index + 1, 0);
+    }
+    buckets_[index] += count;
+    count_ += count;
+    sum_ += value * count;
+    if (value < min_) {
+        min_ = value;
+    }
+    if (value > max_) {
+        max_ = value;
+    }
+}
+
+void
+Histogram::merge(const Histogram& other) {
+    if (other.count_ == 0) {
+        return;
+    }
+    if (other.buckets_.size() > buckets_.size()) {
+        buckets_.resize(other.buckets_.size(), 0);
+    }
+    for (size_t i = 0; i < other.buckets_.size(); ++i) {
+        buckets_[i] += other.buckets_[i];
+    }
+    count_ += other.count_;
+    sum_ += other.sum_;
+    if (other.min_ < min_) {
+        min_ = other.min_;
+    }
+    if (other.max_ > max_) {
+        max_ = other.max_;
+    }
+}
+
+void
+Histogram::reset() {
+    buckets_.clear();
+    count_ = 0;
+    sum_ = 0;
+    min_ = std::numeric_limits<uint64_t>::max();
+    max_ = 0;
+}
+
+double
+Histogram::getMean() const {
+    if (count_ == 0) {
+        return (0.0);
+    }
+    return (static_cast<double>(sum_) / count_);
+}
+
+uint64_t
+Histogram::getPercentile(double percentile) const {
+    if ((percentile < 0.0) || (percentile > 100.0)) {
+        isc_throw(OutOfRange, "percentile " << percentile
+                  << " is out of range [0.0, 100.0]");
+    }
+    if (count_ == 0) {
+        return (0);
+    }
+    // Rank (starting at 1) of the value which is searched.
+    uint64_t rank = static_cast<uint64_t>(percentile * count_ / 100.0 + 0.5);
+    if (rank == 0) {
+        rank = 1;
+    } else if (rank > count_) {
+        rank = count_;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets_.size(); ++i) {
+        seen += buckets_[i];
+        if (seen >= rank) {
+            uint64_t value = bucketUpperBound(i);
+            if (value > max_) {
+                value = max_;
+            }
+            if (value < min_) {
+                value = min_;
+            }
+            return (value);
+        }
+    }
+    return (max_);
+}
+
+bool
+Histogram::operator==(const Histogram& other) const {
+    return ((count_ == other.count_) && (sum_ == other.sum_) &&
+            (getMin() == other.getMin()) && (max_ == other.max_) &&
+            (buckets_ == other.buckets_));
+}
+
+ElementPtr
+Histogram::toElement() const {
+    ElementPtr map = Element::createMap();
+    map->set("count", Element::create(static_cast<int64_t>(count_)));
+    map->set("sum", Element::create(static_cast<int64_t>(sum_)));
+    map->set("min", Element::create(static_cast<int64_t>(getMin())));
+    map->set("max", Element::create(static_cast<int64_t>(max_)));
+    map->set("mean", Element::create(getMean()));
+    map->set("p50", Element::create(static_cast<int64_t>(getPercentile(50.0))));
+    map->set("p90", Element::create(static_cast<int64_t>(getPercentile(90.0))));
+    map->set("p99", Element::create(static_cast<int64_t>(getPercentile(99.0))));
+    map->set("p999", Element::create(static_cast<int64_t>(getPercentile(99.9))));
+    ElementPtr buckets = Element::createList();
+    for (size_t i = 0; i < buckets_.size(); ++i) {
+        if (buckets_[i] == 0) {
+            continue;
+        }
+        ElementPtr bucket = Element::createList();
+        bucket->add(Element::create(static_cast<int64_t>(bucketLowerBound(i))));
+        bucket->add(Element::create(static_cast<int64_t>(bucketUpperBound(i))));
+        bucket->add(Element::create(static_cast<int64_t>(buckets_[i])));
+        buckets->add(bucket);
+    }
+    map->set("buckets", buckets);
+    return (map);
+}
+
+} // end of namespace stats
+} // end of namespace isc
@@ -0,0 +1,156 @@
+// Copyright (C) 2022 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <cc/data.h>
+#include <stdint.h>
+#include <vector>
+
+namespace isc {
+namespace stats {
+
+/// @brief Log-linear histogram of non-negative integer values.
+///
+/// The value range is split in powers of two and each range
+/// [2^k, 2^(k+1)) is further split in @c SUB_BUCKETS linear buckets
+/// of equal width. Values below @c SUB_BUCKETS get one bucket each.
+/// This gives a bounded relative error (1/SUB_BUCKETS, i.e. 12.5%)
+/// for any value while keeping the number of buckets small: the whole
+/// 64-bit range is covered by less than 500 buckets, and the bucket
+/// vector only grows up to the bucket of the largest recorded value.
+///
+/// Histograms share the same bucket layout so they can be merged
+/// by adding bucket counters. This allows, for instance, threads to
+/// accumulate values in private histograms and to merge them later.
+///
+/// The class is not thread safe: concurrent accesses must be protected
+/// by the caller (e.g. by the @c StatsMgr mutex).
+class Histogram {
+public:
+
+    /// @brief Number of bits of the value used to select a linear bucket.
+    static const size_t SUB_BUCKET_BITS = 3;
+
+    /// @brief Number of linear buckets per power of two range.
+    static const size_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+
+    /// @brief Constructor.
+    ///
+    /// Creates an empty histogram.
+    Histogram();
+
+    /// @brief Records a value.
+    ///
+    /// @param value value to be recorded.
+    /// @param count number of occurrences of the value.
+    void record(uint64_t value, uint64_t count = 1);
+
+    /// @brief Merges another histogram into this one.
+    ///
+    /// @param other histogram which values are added to this one.
+    void merge(const Histogram& other);
+
+    /// @brief Removes all recorded values.
+    void reset();
+
+    /// @brief Returns the number of recorded values.
+    uint64_t getCount() const {
+        return (count_);
+    }
+
+    /// @brief Returns the sum of recorded values.
+    uint64_t getSum() const {
+        return (sum_);
+    }
+
+    /// @brief Returns the smallest recorded value (0 when empty).
+    uint64_t getMin() const {
+        return (count_ ? min_ : 0);
+    }
+
+    /// @brief Returns the largest recorded value (0 when empty).
+    uint64_t getMax() const {
+        return (max_);
+    }
+
+    /// @brief Returns the mean of recorded values (0.0 when empty).
+    double getMean() const;
+
+    /// @brief Returns an estimation of a percentile.
+    ///
+    /// The estimation is the upper bound of the bucket holding the value
+    /// of the requested rank, clamped to the recorded minimum and maximum.
+    ///
+    /// @param percentile percentile between 0.0 and 100.0 (e.g. 99.9).
+    /// @return the estimated value (0 when empty).
+    /// @throw isc::OutOfRange if the percentile is not in [0.0, 100.0].
+    uint64_t getPercentile(double percentile) const;
+
+    /// @brief Returns the bucket counters.
+    ///
+    /// The vector is indexed by bucket index: it has no trailing
+    /// entries after the bucket of the largest recorded value.
+    const std::vector<uint64_t>& getBuckets() const {
+        return (buckets_);
+    }
+
+    /// @brief Returns the index of the bucket holding a value.
+    ///
+    /// @param value value.
+    /// @return the bucket index.
+    static size_t bucketIndex(uint64_t value);
+
+    /// @brief Returns the smallest value held by a bucket.
+    ///
+    /// @param index bucket index.
+    /// @return the lower bound (inclusive) of the bucket.
+    static uint64_t bucketLowerBound(size_t index);
+
+    /// @brief Returns the largest value held by a bucket.
+    ///
+    /// @param index bucket index.
+    /// @return the upper bound (inclusive) of the bucket.
+    static uint64_t bucketUpperBound(size_t index);
+
+    /// @brief Equality operator.
+    ///
+    /// @param other histogram to compare to.
+    /// @return true if both histograms recorded the same values.
+    bool operator==(const Histogram& other) const;
+
+    /// @brief Returns the histogram as a JSON map.
+    ///
+    /// The map contains the count, sum, min, max, mean and the 50th,
+    /// 90th, 99th and 99.9th percentiles, and the list of not empty
+    /// buckets given as [ lower-bound, upper-bound, count ] lists.
+    ///
+    /// @return a map element.
+    isc::data::ElementPtr toElement() const;
+
+private:
+
+    /// @brief Bucket counters.
+    std::vector<uint64_t> buckets_;
+
+    /// @brief Number of recorded values.
+    uint64_t count_;
+
+    /// @brief Sum of recorded values.
+    uint64_t sum_;
+
+    /// @brief Smallest recorded value.
+    uint64_t min_;
+
+    /// @brief Largest recorded value.
+    uint64_t max_;
+};
+
+} // end of namespace stats
+} // end of namespace isc
+
+#endif // HISTOGRAM_H
@@ -54,6 +54,13 @@ Observation::Observation(const std::string& name, const std::string& value) :
     setValue(value);
 }
 
+Observation::Observation(const std::string& name, const Histogram& value) :
+    name_(name), type_(STAT_HISTOGRAM),
+    max_sample_count_(default_max_sample_count_),
+    max_sample_age_(default_max_sample_age_) {
+    setValue(value);
+}
+
 void Observation::setMaxSampleAge(const StatsDuration& duration) {
     switch(type_) {
     case STAT_INTEGER: {
@@ -72,6 +79,10 @@ void Observation::setMaxSampleAge(const StatsDuration& duration) {
         setMaxSampleAgeInternal(string_samples_, duration, STAT_STRING);
         return;
     }
+    case STAT_HISTOGRAM: {
+        setMaxSampleAgeInternal(histogram_samples_, duration, STAT_HISTOGRAM);
+        return;
+    }
     default:
         isc_throw(InvalidStatType, "Unknown statistic type: "
                   << typeToText(type_));
@@ -96,6 +107,13 @@ void Observation::setMaxSampleCount(uint32_t max_samples) {
         setMaxSampleCountInternal(string_samples_, max_samples, STAT_STRING);
         return;
     }
+    case STAT_HISTOGRAM: {
+        // The limit is recorded but a histogram keeps its only sample.
+        max_sample_count_.first = true;
+        max_sample_count_.second = max_samples;
+        max_sample_age_.first = false;
+        return;
+    }
     default:
         isc_throw(InvalidStatType, "Unknown statistic type: "
                   << typeToText(type_));
@@ -122,6 +140,35 @@ void Observation::addValue(const std::string& value) {
     setValue(current.first + value);
 }
 
+void Observation::addValue(const Histogram& value) {
+    if (type_ != STAT_HISTOGRAM) {
+        isc_throw(InvalidStatType, "Invalid statistic type requested: "
+                  << typeToText(STAT_HISTOGRAM) << ", but the actual type is "
+                  << typeToText(type_));
+    }
+    // Histograms are merged in place: copying the whole histogram to
+    // keep the previous sample would be too expensive.
+    HistogramSample& current = histogram_samples_.front();
+    current.first.merge(value);
+    current.second = SampleClock::now();
+}
+
+void Observation::recordValue(const uint64_t value) {
+    if (type_ != STAT_HISTOGRAM) {
+        isc_throw(InvalidStatType, "Invalid statistic type requested: "
+                  << typeToText(STAT_HISTOGRAM) << ", but the actual type is "
+                  << typeToText(type_));
+    }
+    HistogramSample& current = histogram_samples_.front();
+    current.first.record(value);
+    current.second = SampleClock::now();
+}
+
+void Observation::recordValue(const StatsDuration& value) {
+    int64_t us = duration_cast<microseconds>(value).count();
+    recordValue(static_cast<uint64_t>(us > 0 ? us : 0));
+}
+
 void Observation::setValue(const int64_t value) {
     setValueInternal(value, integer_samples_, STAT_INTEGER);
 }
@@ -138,6 +185,17 @@ void Observation::setValue(const std::string& value) {
     setValueInternal(value, string_samples_, STAT_STRING);
 }
 
+void Observation::setValue(const Histogram& value) {
+    if (type_ != STAT_HISTOGRAM) {
+        isc_throw(InvalidStatType, "Invalid statistic type requested: "
+                  << typeToText(STAT_HISTOGRAM) << ", but the actual type is "
+                  << typeToText(type_));
+    }
+    // Only the current histogram is kept.
+    histogram_samples_.clear();
+    histogram_samples_.push_back(make_pair(value, SampleClock::now()));
+}
+
 size_t Observation::getSize() const {
     size_t size = 0;
     switch(type_) {
@@ -157,6 +215,10 @@ size_t Observation::getSize() const {
         size = getSizeInternal(string_samples_, STAT_STRING);
         return (size);
     }
+    case STAT_HISTOGRAM: {
+        size = getSizeInternal(histogram_samples_, STAT_HISTOGRAM);
+        return (size);
+    }
     default:
         isc_throw(InvalidStatType, "Unknown statistic type: "
                   << typeToText(type_));
@@ -235,6 +297,10 @@ StringSample Observation::getString() const {
     return (getValueInternal<StringSample>(string_samples_, STAT_STRING));
 }
 
+HistogramSample Observation::getHistogram() const {
+    return (getValueInternal<HistogramSample>(histogram_samples_, STAT_HISTOGRAM));
+}
+
 template<typename SampleType, typename Storage>
 SampleType Observation::getValueInternal(Storage& storage, Type exp_type) const {
     if (type_ != exp_type) {
@@ -379,6 +445,9 @@ std::string Observation::typeToText(Type type) {
     case STAT_STRING:
         tmp << "string";
         break;
+    case STAT_HISTOGRAM:
+        tmp << "histogram";
+        break;
     default:
         tmp << "unknown";
         break;
@@ -466,6 +535,20 @@ Observation::getJSON() const {
         }
         break;
     }
+    case STAT_HISTOGRAM: {
+        HistogramSample s = getHistogram();
+
+        // There is only one sample.
+        entry = isc::data::Element::createList();
+        value = s.first.toElement();
+        timestamp = isc::data::Element::create(isc::util::clockToText(s.second));
+
+        entry->add(value);
+        entry->add(timestamp);
+
+        list->add(entry);
+        break;
+    }
     default:
         isc_throw(InvalidStatType, "Unknown statistic type: "
                   << typeToText(type_));
@@ -496,6 +579,10 @@ void Observation::reset() {
         setValue(string(""));
         return;
     }
+    case STAT_HISTOGRAM: {
+        setValue(Histogram());
+        return;
+    }
     default:
         isc_throw(InvalidStatType, "Unknown statistic type: "
                   << typeToText(type_));
@@ -9,6 +9,7 @@
 
 #include <cc/data.h>
 #include <exceptions/exceptions.h>
+#include <stats/histogram.h>
 #include <boost/shared_ptr.hpp>
 #include <chrono>
 #include <list>
@@ -64,14 +65,18 @@ typedef std::pair<StatsDuration, SampleClock::time_point> DurationSample;
 /// @brief String
 typedef std::pair<std::string, SampleClock::time_point> StringSample;
 
+/// @brief Histogram
+typedef std::pair<Histogram, SampleClock::time_point> HistogramSample;
+
 /// @}
 
 /// @brief Represents a single observable characteristic (a 'statistic')
 ///
-/// Currently it supports one of four types: integer (implemented as signed 64
+/// Currently it supports one of five types: integer (implemented as signed 64
 /// bit integer), float (implemented as double), time duration (implemented with
-/// millisecond precision) and string. Absolute (setValue) and
-/// incremental (addValue) modes are supported. Statistic type is determined
+/// millisecond precision), string and histogram. Absolute (setValue) and
+/// incremental (addValue) modes are supported. Histograms also support
+/// recording single values (recordValue). Statistic type is determined
 /// during its first use. Once type is set, any additional observations recorded
 /// must be of the same type. Attempting to set or extract information about
 /// other types will result in InvalidStateType exception.
@@ -79,8 +84,11 @@ typedef std::pair<std::string, SampleClock::time_point> StringSample;
 /// Observation can be retrieved in one of @ref getInteger, @ref getFloat,
 /// @ref getDuration, @ref getString (appropriate type must be used) or
 /// @ref getJSON, which is generic and can be used for all types.
+/// Histograms are retrieved using @ref getHistogram.
 ///
 /// Since Kea 1.6 multiple samples are stored for the same observation.
+/// Histograms are the exception: as they aggregate all recorded values
+/// only the current histogram is kept.
 class Observation {
 public:
 
@@ -96,7 +104,8 @@ public:
         STAT_INTEGER, ///< this statistic is unsigned 64-bit integer value
         STAT_FLOAT,   ///< this statistic is a floating point value
         STAT_DURATION,///< this statistic represents time duration
-        STAT_STRING   ///< this statistic represents a string
+        STAT_STRING,  ///< this statistic represents a string
+        STAT_HISTOGRAM///< this statistic represents a value distribution
     };
 
     /// @brief Constructor for integer observations
@@ -123,6 +132,12 @@ public:
     /// @param value string observed.
     Observation(const std::string& name, const std::string& value);
 
+    /// @brief Constructor for histogram observations
+    ///
+    /// @param name observation name
+    /// @param value histogram observed.
+    Observation(const std::string& name, const Histogram& value);
+
     /// @brief Determines maximum age of samples.
     ///
     /// Specifies that statistic name should be stored not as a single value,
@@ -202,6 +217,12 @@ public:
     /// @throw InvalidStatType if statistic is not a string
     void setValue(const std::string& value);
 
+    /// @brief Records absolute histogram observation
+    ///
+    /// @param value histogram observed
+    /// @throw InvalidStatType if statistic is not a histogram
+    void setValue(const Histogram& value);
+
     /// @brief Records incremental integer observation
     ///
     /// @param value integer value observed
@@ -226,6 +247,28 @@ public:
     /// @throw InvalidStatType if statistic is not a string
     void addValue(const std::string& value);
 
+    /// @brief Records incremental histogram observation.
+    ///
+    /// The histogram is merged into the observed histogram.
+    ///
+    /// @param value histogram observed
+    /// @throw InvalidStatType if statistic is not a histogram
+    void addValue(const Histogram& value);
+
+    /// @brief Records a value in a histogram observation.
+    ///
+    /// @param value value observed
+    /// @throw InvalidStatType if statistic is not a histogram
+    void recordValue(const uint64_t value);
+
+    /// @brief Records a duration in a histogram observation.
+    ///
+    /// The duration is recorded in microseconds.
+    ///
+    /// @param value duration observed
+    /// @throw InvalidStatType if statistic is not a histogram
+    void recordValue(const StatsDuration& value);
+
     /// @brief Returns size of observed storage
     ///
     /// @return size of storage
@@ -273,6 +316,11 @@ public:
     /// @throw InvalidStatType if statistic is not a string
     StringSample getString() const;
 
+    /// @brief Returns observed histogram sample
+    /// @return observed sample (value + timestamp)
+    /// @throw InvalidStatType if statistic is not a histogram
+    HistogramSample getHistogram() const;
+
     /// @brief Returns observed integer samples
     /// @return list of observed samples (value + timestamp)
     /// @throw InvalidStatType if statistic is not integer
@@ -433,6 +481,11 @@ private:
 
     /// @brief Storage for string samples
     std::list<StringSample> string_samples_;
+
+    /// @brief Storage for histogram samples
+    ///
+    /// It always contains exactly one element.
+    std::list<HistogramSample> histogram_samples_;
     /// @}
 };
 
@@ -12,7 +12,10 @@
 #include <cc/command_interpreter.h>
 #include <util/multi_threading_mgr.h>
 #include <boost/make_shared.hpp>
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <ostream>
 
 using namespace std;
 using namespace std::chrono;
@@ -20,6 +23,158 @@ using namespace isc::data;
 using namespace isc::config;
 using namespace isc::util;
 
+namespace {
+
+/// @brief A statistic to be written in the OpenMetrics text format.
+struct OpenMetric {
+    /// @brief Metric family name.
+    string family_;
+
+    /// @brief Labels (without braces).
+    string labels_;
+
+    /// @brief The statistic.
+    isc::stats::ObservationPtr obs_;
+};
+
+/// @brief Appends a name to a metric family or label name.
+///
+/// Characters which are not allowed in OpenMetrics names are replaced
+/// by underscores.
+///
+/// @param output the name to append to.
+/// @param name the name to append.
+void
+appendOpenMetricsName(string& output, const string& name) {
+    for (char c : name) {
+        if (((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z')) ||
+            ((c >= '0') && (c <= '9')) || (c == '_')) {
+            output.push_back(c);
+        } else {
+            output.push_back('_');
+        }
+    }
+}
+
+/// @brief Appends a label value escaping backslashes, quotes and newlines.
+///
+/// @param output the string to append to.
+/// @param value the label value.
+void
+appendOpenMetricsValue(string& output, const string& value) {
+    for (char c : value) {
+        if (c == '\\') {
+            output += "\\\\";
+        } else if (c == '"') {
+            output += "\\\"";
+        } else if (c == '\n') {
+            output += "\\n";
+        } else {
+            output.push_back(c);
+        }
+    }
+}
+
+/// @brief Converts a statistic name to a metric family name and labels.
+///
+/// The name is split in dot separated components: each component is
+/// appended to the family name and components with an index in square
+/// brackets give a label with the index as value,
+/// e.g. "subnet[1].pool[0].assigned-addresses" gives the
+/// "subnet_pool_assigned_addresses" family name with the
+/// subnet="1",pool="0" labels.
+///
+/// @param prefix family name prefix.
+/// @param name statistic name.
+/// @param metric [out] metric where to set the family name and labels.
+void
+parseOpenMetricsName(const string& prefix, const string& name,
+                     OpenMetric& metric) {
+    string& family = metric.family_;
+    string& labels = metric.labels_;
+    appendOpenMetricsName(family, prefix);
+    size_t pos = 0;
+    while (pos < name.size()) {
+        size_t end = name.find('.', pos);
+        size_t bracket = name.find('[', pos);
+        if ((bracket != string::npos) && ((end == string::npos) || (bracket < end))) {
+            // Indexes can contain dots so look for the end after them.
+            size_t close = name.find(']', bracket);
+            end = (close == string::npos ? string::npos : name.find('.', close));
+        }
+        string component = name.substr(pos, end == string::npos ?
+                                       string::npos : end - pos);
+        string index;
+        bool indexed = false;
+        bracket = component.find('[');
+        if (bracket != string::npos) {
+            size_t close = component.find(']', bracket);
+            index = component.substr(bracket + 1, close == string::npos ?
+                                     string::npos : close - bracket - 1);
+            component = component.substr(0, bracket);
+            indexed = true;
+        }
+        if (!family.empty()) {
+            family.push_back('_');
+        }
+        appendOpenMetricsName(family, component);
+        if (indexed) {
+            if (!labels.empty()) {
+                labels.push_back(',');
+            }
+            appendOpenMetricsName(labels, component);
+            labels += "=\"";
+            appendOpenMetricsValue(labels, index);
+            labels.push_back('"');
+        }
+        if (end == string::npos) {
+            break;
+        }
+        pos = end + 1;
+    }
+    // A metric name can't begin with a digit.
+    if (family.empty() || ((family[0] >= '0') && (family[0] <= '9'))) {
+        family.insert(family.begin(), '_');
+    }
+}
+
+/// @brief Writes a sample name with its labels.
+///
+/// @param os output stream.
+/// @param name sample name.
+/// @param labels labels.
+/// @param extra additional label (can be empty).
+void
+writeOpenMetricsSample(ostream& os, const string& name, const string& labels,
+                       const string& extra = string()) {
+    os << name;
+    if (!labels.empty() || !extra.empty()) {
+        os << '{' << labels;
+        if (!labels.empty() && !extra.empty()) {
+            os << ',';
+        }
+        os << extra << '}';
+    }
+    os << ' ';
+}
+
+/// @brief Writes a floating point value.
+///
+/// @param os output stream.
+/// @param value the value.
+void
+writeOpenMetricsDouble(ostream& os, double value) {
+    if (std::isnan(value)) {
+        os << "NaN";
+    } else if (std::isinf(value)) {
+        os << (value > 0 ? "+Inf" : "-Inf");
+    } else {
+        os << value;
+    }
+}
+
+} // end of anonymous namespace
+
 namespace isc {
 namespace stats {
 
@@ -30,7 +185,8 @@ StatsMgr::instance() {
 }
 
 StatsMgr::StatsMgr() :
-    global_(boost::make_shared<StatContext>()), mutex_(new mutex) {
+    global_(boost::make_shared<StatContext>()), mutex_(new mutex),
+    thread_histograms_(), thread_mutex_(new mutex) {
 }
 
 void
@@ -73,6 +229,16 @@ StatsMgr::setValue(const string& name, const string& value) {
     }
 }
 
+void
+StatsMgr::setValue(const string& name, const Histogram& value) {
+    if (MultiThreadingMgr::instance().getMode()) {
+        lock_guard<mutex> lock(*mutex_);
+        setValueInternal(name, value);
+    } else {
+        setValueInternal(name, value);
+    }
+}
+
 void
 StatsMgr::addValue(const string& name, const int64_t value) {
     if (MultiThreadingMgr::instance().getMode()) {
@@ -113,12 +279,102 @@ StatsMgr::addValue(const string& name, const string& value) {
     }
 }
 
+void
+StatsMgr::addValue(const string& name, const Histogram& value) {
+    if (MultiThreadingMgr::instance().getMode()) {
+        lock_guard<mutex> lock(*mutex_);
+        addValueInternal(name, value);
+    } else {
+        addValueInternal(name, value);
+    }
+}
+
+void
+StatsMgr::recordValue(const string& name, const uint64_t value) {
+    if (MultiThreadingMgr::instance().getMode()) {
+        lock_guard<mutex> lock(*mutex_);
+        recordValueInternal(name, value);
+    } else {
+        recordValueInternal(name, value);
+    }
+}
+
+void
+StatsMgr::recordValue(const string& name, const StatsDuration& value) {
+    if (MultiThreadingMgr::instance().getMode()) {
+        lock_guard<mutex> lock(*mutex_);
+        recordValueInternal(name, value);
+    } else {
+        recordValueInternal(name, value);
+    }
+}
+
+void
+StatsMgr::recordThreadValue(const string& name, const uint64_t value) {
+    ThreadHistogramsPtr local = getThreadHistograms();
+    lock_guard<mutex> lock(local->mutex_);
+    local->histograms_[name].record(value);
+}
+
+void
+StatsMgr::recordThreadValue(const string& name, const StatsDuration& value) {
+    int64_t us = duration_cast<microseconds>(value).count();
+    recordThreadValue(name, static_cast<uint64_t>(us > 0 ? us : 0));
+}
+
+StatsMgr::ThreadHistogramsPtr
+StatsMgr::getThreadHistograms() {
+    // There is only one statistics manager so the histograms of a thread
+    // can be kept in a function static.
+    static thread_local ThreadHistogramsPtr local;
+    if (!local) {
+        local = boost::make_shared<ThreadHistograms>();
+        lock_guard<mutex> lock(*thread_mutex_);
+        thread_histograms_.push_back(local);
+    }
+    return (local);
+}
+
+void
+StatsMgr::mergeThreadHistogramsInternal() const {
+    lock_guard<mutex> lock(*thread_mutex_);
+    for (auto it = thread_histograms_.begin(); it != thread_histograms_.end(); ) {
+        ThreadHistogramsPtr local = *it;
+        {
+            lock_guard<mutex> local_lock(local->mutex_);
+            for (auto& histogram : local->histograms_) {
+                if (histogram.second.getCount() == 0) {
+                    continue;
+                }
+                ObservationPtr obs = getObservationInternal(histogram.first);
+                if (!obs) {
+                    global_->add(boost::make_shared<Observation>(histogram.first,
+                                                                 histogram.second));
+                } else if (obs->getType() == Observation::STAT_HISTOGRAM) {
+                    obs->addValue(histogram.second);
+                }
+                histogram.second.reset();
+            }
+        }
+
+        // The list and the local variable hold the only references to the
+        // histograms of a thread which exited.
+        if (local.use_count() == 2) {
+            it = thread_histograms_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
 ObservationPtr
 StatsMgr::getObservation(const string& name) const {
     if (MultiThreadingMgr::instance().getMode()) {
         lock_guard<mutex> lock(*mutex_);
+        mergeThreadHistogramsInternal();
         return (getObservationInternal(name));
     } else {
+        mergeThreadHistogramsInternal();
         return (getObservationInternal(name));
     }
 }
@@ -308,6 +564,7 @@ StatsMgr::reset(const string& name) {
 
 bool
 StatsMgr::resetInternal(const string& name) {
+    mergeThreadHistogramsInternal();
     ObservationPtr obs = getObservationInternal(name);
     if (obs) {
         obs->reset();
@@ -328,6 +585,7 @@ StatsMgr::del(const string& name) {
 
 bool
 StatsMgr::delInternal(const string& name) {
+    mergeThreadHistogramsInternal();
     return (global_->del(name));
 }
 
@@ -343,6 +601,7 @@ StatsMgr::removeAll() {
 
 void
 StatsMgr::removeAllInternal() {
+    mergeThreadHistogramsInternal();
     global_->clear();
 }
 
@@ -358,6 +617,7 @@ StatsMgr::get(const string& name) const {
 
 ConstElementPtr
 StatsMgr::getInternal(const string& name) const {
+    mergeThreadHistogramsInternal();
     ElementPtr map = Element::createMap(); // a map
     ObservationPtr obs = getObservationInternal(name);
     if (obs) {
@@ -378,9 +638,122 @@ StatsMgr::getAll() const {
 
 ConstElementPtr
 StatsMgr::getAllInternal() const {
+    mergeThreadHistogramsInternal();
     return (global_->getAll());
 }
 
+void
+StatsMgr::writeOpenMetrics(ostream& os, const string& prefix) const {
+    if (MultiThreadingMgr::instance().getMode()) {
+        lock_guard<mutex> lock(*mutex_);
+        writeOpenMetricsInternal(os, prefix);
+    } else {
+        writeOpenMetricsInternal(os, prefix);
+    }
+}
+
+void
+StatsMgr::writeOpenMetricsInternal(ostream& os, const string& prefix) const {
+    mergeThreadHistogramsInternal();
+    // Samples of a metric family must be contiguous so statistics are
+    // grouped by family, e.g. all the subnet[X].assigned-addresses.
+    vector<OpenMetric> metrics;
+    const map<string, ObservationPtr>& stats = global_->getObservations();
+    metrics.reserve(stats.size());
+    for (auto const& stat : stats) {
+        OpenMetric metric;
+        metric.obs_ = stat.second;
+        parseOpenMetricsName(prefix, stat.first, metric);
+        if (metric.obs_->getType() == Observation::STAT_DURATION) {
+            metric.family_ += "_seconds";
+        }
+        metrics.push_back(metric);
+    }
+    stable_sort(metrics.begin(), metrics.end(),
+                [](const OpenMetric& a, const OpenMetric& b) {
+                    return (a.family_ < b.family_);
+                });
+
+    streamsize precision = os.precision(15);
+    const string* family = 0;
+    for (auto const& metric : metrics) {
+        Observation::Type type = metric.obs_->getType();
+        if (!family || (*family != metric.family_)) {
+            family = &metric.family_;
+            os << "# TYPE " << metric.family_ << ' ';
+            switch (type) {
+            case Observation::STAT_STRING:
+                os << "info\n";
+                break;
+            case Observation::STAT_HISTOGRAM:
+                os << "histogram\n";
+                break;
+            case Observation::STAT_DURATION:
+                os << "gauge\n# UNIT " << metric.family_ << " seconds\n";
+                break;
+            default:
+                os << "gauge\n";
+            }
+        }
+        switch (type) {
+        case Observation::STAT_INTEGER:
+            writeOpenMetricsSample(os, metric.family_, metric.labels_);
+            os << metric.obs_->getInteger().first << '\n';
+            break;
+        case Observation::STAT_FLOAT:
+            writeOpenMetricsSample(os, metric.family_, metric.labels_);
+            writeOpenMetricsDouble(os, metric.obs_->getFloat().first);
+            os << '\n';
+            break;
+        case Observation::STAT_DURATION: {
+            writeOpenMetricsSample(os, metric.family_, metric.labels_);
+            StatsDuration value = metric.obs_->getDuration().first;
+            os << duration_cast<duration<double>>(value).count() << '\n';
+            break;
+        }
+        case Observation::STAT_STRING: {
+            string extra = "value=\"";
+            appendOpenMetricsValue(extra, metric.obs_->getString().first);
+            extra.push_back('"');
+            writeOpenMetricsSample(os, metric.family_ + "_info",
+                                   metric.labels_, extra);
+            os << "1\n";
+            break;
+        }
+        case Observation::STAT_HISTOGRAM: {
+            HistogramSample sample = metric.obs_->getHistogram();
+            const Histogram& histogram = sample.first;
+            const vector<uint64_t>& buckets = histogram.getBuckets();
+            string bucket_name = metric.family_ + "_bucket";
+            uint64_t cumulative = 0;
+            for (size_t i = 0; i < buckets.size(); ++i) {
+                if (buckets[i] == 0) {
+                    continue;
+                }
+                cumulative += buckets[i];
+                ostringstream le;
+                le << "le=\"" << Histogram::bucketUpperBound(i) << '"';
+                writeOpenMetricsSample(os, bucket_name, metric.labels_,
+                                       le.str());
+                os << cumulative << '\n';
+            }
+            writeOpenMetricsSample(os, bucket_name, metric.labels_,
+                                   "le=\"+Inf\"");
+            os << histogram.getCount() << '\n';
+            writeOpenMetricsSample(os, metric.family_ + "_count",
+                                   metric.labels_);
+            os << histogram.getCount() << '\n';
+            writeOpenMetricsSample(os, metric.family_ + "_sum",
+                                   metric.labels_);
+            os << histogram.getSum() << '\n';
+            break;
+        }
+        }
+    }
+    os << "# EOF\n";
+    os.precision(precision);
+}
+
 void
 StatsMgr::resetAll() {
     if (MultiThreadingMgr::instance().getMode()) {
@@ -393,6 +766,7 @@ StatsMgr::resetAll() {
 
 void
 StatsMgr::resetAllInternal() {
+    mergeThreadHistogramsInternal();
     global_->resetAll();
 }
 
@@ -408,6 +782,7 @@ StatsMgr::getSize(const string& name) const {
 
 size_t
 StatsMgr::getSizeInternal(const string& name) const {
+    mergeThreadHistogramsInternal();
     ObservationPtr obs = getObservationInternal(name);
     if (obs) {
         return (obs->getSize());
@@ -427,6 +802,7 @@ StatsMgr::count() const {
 
 size_t
 StatsMgr::countInternal() const {
+    mergeThreadHistogramsInternal();
     return (global_->size());
 }
 
@@ -11,7 +11,9 @@
 #include <stats/context.h>
 #include <boost/noncopyable.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
 
+#include <list>
 #include <map>
 #include <mutex>
 #include <string>
@@ -100,6 +102,13 @@ public:
     /// @throw InvalidStatType if statistic is not a string
     void setValue(const std::string& name, const std::string& value);
 
+    /// @brief Records absolute histogram observation.
+    ///
+    /// @param name name of the observation
+    /// @param value histogram observed
+    /// @throw InvalidStatType if statistic is not a histogram
+    void setValue(const std::string& name, const Histogram& value);
+
     /// @brief Records incremental integer observation.
     ///
     /// @param name name of the observation
@@ -128,6 +137,57 @@ public:
     /// @throw InvalidStatType if statistic is not a string
     void addValue(const std::string& name, const std::string& value);
 
+    /// @brief Records incremental histogram observation.
+    ///
+    /// The histogram is merged into the observed histogram. This allows
+    /// threads to accumulate values in private histograms and to publish
+    /// them in one call.
+    ///
+    /// @param name name of the observation
+    /// @param value histogram observed
+    /// @throw InvalidStatType if statistic is not a histogram
+    void addValue(const std::string& name, const Histogram& value);
+
+    /// @brief Records a value in a histogram observation.
+    ///
+    /// The histogram is created when it does not exist.
+    ///
+    /// @param name name of the observation
+    /// @param value value observed
+    /// @throw InvalidStatType if statistic is not a histogram
+    void recordValue(const std::string& name, const uint64_t value);
+
+    /// @brief Records a duration in a histogram observation.
+    ///
+    /// The duration is recorded in microseconds. The histogram is created
+    /// when it does not exist.
+    ///
+    /// @param name name of the observation
+    /// @param value duration observed
+    /// @throw InvalidStatType if statistic is not a histogram
+    void recordValue(const std::string& name, const StatsDuration& value);
+
+    /// @brief Records a value in a histogram private to the calling thread.
+    ///
+    /// Contrary to @ref recordValue the statistics manager mutex is not
+    /// taken: the value is recorded in a per-thread histogram which is
+    /// merged into the observation when statistics are read (and before
+    /// they are reset or removed). This is intended for values recorded
+    /// for each packet by the packet processing threads.
+    ///
+    /// @param name name of the observation
+    /// @param value value observed
+    void recordThreadValue(const std::string& name, const uint64_t value);
+
+    /// @brief Records a duration in a histogram private to the calling thread.
+    ///
+    /// The duration is recorded in microseconds.
+    ///
+    /// @param name name of the observation
+    /// @param value duration observed
+    void recordThreadValue(const std::string& name,
+                           const StatsDuration& value);
+
     /// @brief Determines maximum age of samples.
     ///
     /// Specifies that statistic name should be stored not as a single value,
@@ -243,6 +303,32 @@ public:
     /// @return JSON structures representing all statistics
     isc::data::ConstElementPtr getAll() const;
 
+    /// @brief Writes all statistics in the OpenMetrics text format.
+    ///
+    /// This is the exposition format scraped by Prometheus and compatible
+    /// monitoring systems. Contrary to @ref getAll the statistics are
+    /// written directly to the stream without building an intermediate
+    /// JSON structure, which makes it much cheaper when there are many
+    /// statistics (e.g. per subnet and per pool statistics).
+    ///
+    /// Statistic names are converted to metric family names: the prefix
+    /// is prepended, indexes in square brackets become labels and all
+    /// characters not allowed in a metric name are replaced by
+    /// underscores. For instance "subnet[1].pool[0].assigned-addresses"
+    /// with the "kea" prefix becomes:
+    /// @code
+    /// kea_subnet_pool_assigned_addresses{subnet="1",pool="0"}
+    /// @endcode
+    /// Integer and floating point statistics are exported as gauges
+    /// (Kea statistics can be reset or decreased), durations as gauges
+    /// in seconds, strings as info metrics and histograms as histograms.
+    /// Only the most recent sample of each statistic is exported.
+    ///
+    /// @param os stream where to write the statistics.
+    /// @param prefix prefix of metric family names (can be empty).
+    void writeOpenMetrics(std::ostream& os,
+                          const std::string& prefix = "kea") const;
+
     /// @}
 
     /// @brief Returns an observation.
@@ -483,7 +569,7 @@ private:
     /// specified by value. This internal method is used by public @ref setValue
     /// methods.
     ///
-    /// @tparam DataType one of int64_t, double, StatsDuration or string
+    /// @tparam DataType one of int64_t, double, StatsDuration, string or Histogram
     /// @param name name of the statistic
     /// @param value specified statistic will be set to this value
     /// @throw InvalidStatType is statistic exists and has a different type.
@@ -507,7 +593,7 @@ private:
     /// by name to a value). This internal method is used by public @ref setValue
     /// methods.
     ///
-    /// @tparam DataType one of int64_t, double, StatsDuration or string
+    /// @tparam DataType one of int64_t, double, StatsDuration, string or Histogram
     /// @param name name of the statistic
     /// @param value specified statistic will be set to this value
     /// @throw InvalidStatType is statistic exists and has a different type.
@@ -530,6 +616,28 @@ private:
 
     /// @public
 
+    /// @brief Records a value in a given histogram (internal version).
+    ///
+    /// This template method records a value in a histogram statistic
+    /// (identified by name). This internal method is used by public
+    /// @ref recordValue methods.
+    ///
+    /// @tparam DataType one of uint64_t or StatsDuration
+    /// @param name name of the statistic
+    /// @param value value to be recorded
+    /// @throw InvalidStatType is statistic exists and has a different type.
+    template<typename DataType>
+    void recordValueInternal(const std::string& name, DataType value) {
+        ObservationPtr existing = getObservationInternal(name);
+        if (!existing) {
+            existing.reset(new Observation(name, Histogram()));
+            addObservationInternal(existing);
+        }
+        existing->recordValue(value);
+    }
+
+    /// @public
+
     /// @brief Adds a new observation.
     ///
     /// That's an utility method used by public @ref setValue() and
@@ -717,6 +825,17 @@ private:
 
     /// @private
 
+    /// @brief Writes all statistics in the OpenMetrics text format.
+    ///
+    /// Should be called in a thread safe context.
+    ///
+    /// @param os stream where to write the statistics.
+    /// @param prefix prefix of metric family names (can be empty).
+    void writeOpenMetricsInternal(std::ostream& os,
+                                  const std::string& prefix) const;
+
+    /// @private
+
     /// @brief Utility method that attempts to extract statistic name
     ///
     /// This method attempts to extract statistic name from the params
@@ -776,11 +895,50 @@ private:
                                   uint32_t& max_samples,
                                   std::string& reason);
 
+    /// @brief Histograms recorded by a thread and not yet merged.
+    struct ThreadHistograms {
+        /// @brief The mutex protecting the histograms.
+        ///
+        /// It is only contended when the histograms are merged.
+        std::mutex mutex_;
+
+        /// @brief The histograms by statistic name.
+        std::map<std::string, Histogram> histograms_;
+    };
+
+    /// @brief Pointer to the histograms of a thread.
+    typedef boost::shared_ptr<ThreadHistograms> ThreadHistogramsPtr;
+
+    /// @private
+
+    /// @brief Returns the histograms of the calling thread.
+    ///
+    /// They are registered on first use by the thread.
+    ///
+    /// @return the histograms of the calling thread.
+    ThreadHistogramsPtr getThreadHistograms();
+
+    /// @private
+
+    /// @brief Merges the per-thread histograms into the observations.
+    ///
+    /// The per-thread histograms are emptied and the ones of the threads
+    /// which exited are unregistered. Histograms which can't be merged
+    /// because the statistic has another type are dropped.
+    /// Should be called in a thread safe context.
+    void mergeThreadHistogramsInternal() const;
+
     /// @brief This is a global context. All statistics will initially be stored here.
     StatContextPtr global_;
 
     /// @brief The mutex used to protect internal state.
     const boost::scoped_ptr<std::mutex> mutex_;
+
+    /// @brief The histograms of the threads.
+    mutable std::list<ThreadHistogramsPtr> thread_histograms_;
+
+    /// @brief The mutex protecting the list of per-thread histograms.
+    const boost::scoped_ptr<std::mutex> thread_mutex_;
 };
 
 }  // namespace stats
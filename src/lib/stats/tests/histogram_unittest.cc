@@ -0,0 +1,143 @@
+// Copyright (C) 2022 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <stats/histogram.h>
+#include <exceptions/exceptions.h>
+#include <gtest/gtest.h>
+
+#include <limits>
+
+using namespace isc;
+using namespace isc::data;
+using namespace isc::stats;
+
+namespace {
+
+// Checks the bucket layout: small values have their own bucket and
+// larger values are split into linear sub-buckets of powers of two.
+TEST(HistogramTest, buckets) {
+    for (uint64_t v = 0; v < 2 * Histogram::SUB_BUCKETS; ++v) {
+        EXPECT_EQ(v, Histogram::bucketIndex(v));
+        EXPECT_EQ(v, Histogram::bucketLowerBound(v));
+        EXPECT_EQ(v, Histogram::bucketUpperBound(v));
+    }
+    EXPECT_EQ(16, Histogram::bucketIndex(16));
+    EXPECT_EQ(16, Histogram::bucketIndex(17));
+    EXPECT_EQ(17, Histogram::bucketIndex(18));
+    EXPECT_EQ(23, Histogram::bucketIndex(31));
+    EXPECT_EQ(24, Histogram::bucketIndex(32));
+    EXPECT_EQ(16, Histogram::bucketLowerBound(16));
+    EXPECT_EQ(17, Histogram::bucketUpperBound(16));
+
+    // Buckets are contiguous and each value is in its bucket bounds.
+    for (size_t i = 1; i < 400; ++i) {
+        EXPECT_EQ(Histogram::bucketUpperBound(i - 1) + 1,
+                  Histogram::bucketLowerBound(i));
+        EXPECT_EQ(i, Histogram::bucketIndex(Histogram::bucketLowerBound(i)));
+        EXPECT_EQ(i, Histogram::bucketIndex(Histogram::bucketUpperBound(i)));
+    }
+
+    // The largest value has a bucket too.
+    uint64_t max = std::numeric_limits<uint64_t>::max();
+    size_t last = Histogram::bucketIndex(max);
+    EXPECT_EQ(max, Histogram::bucketUpperBound(last));
+    EXPECT_GT(500, last);
+}
+
+// Checks that an empty histogram returns neutral values.
+TEST(HistogramTest, empty) {
+    Histogram h;
+    EXPECT_EQ(0, h.getCount());
+    EXPECT_EQ(0, h.getSum());
+    EXPECT_EQ(0, h.getMin());
+    EXPECT_EQ(0, h.getMax());
+    EXPECT_EQ(0.0, h.getMean());
+    EXPECT_EQ(0, h.getPercentile(50.0));
+    EXPECT_TRUE(h.getBuckets().empty());
+}
+
+// Checks recording values and percentile estimations.
+TEST(HistogramTest, record) {
+    Histogram h;
+    for (uint64_t v = 1; v <= 1000; ++v) {
+        h.record(v);
+    }
+    EXPECT_EQ(1000, h.getCount());
+    EXPECT_EQ(500500, h.getSum());
+    EXPECT_EQ(1, h.getMin());
+    EXPECT_EQ(1000, h.getMax());
+    EXPECT_DOUBLE_EQ(500.5, h.getMean());
+
+    // Estimations are upper bounds within the relative error.
+    uint64_t p50 = h.getPercentile(50.0);
+    EXPECT_LE(500, p50);
+    EXPECT_GE(500 + 500 / Histogram::SUB_BUCKETS, p50);
+    uint64_t p99 = h.getPercentile(99.0);
+    EXPECT_LE(990, p99);
+    EXPECT_GE(990 + 990 / Histogram::SUB_BUCKETS, p99);
+
+    // Extreme percentiles are clamped to min and max.
+    EXPECT_EQ(1, h.getPercentile(0.0));
+    EXPECT_EQ(1000, h.getPercentile(100.0));
+
+    EXPECT_THROW(h.getPercentile(-1.0), OutOfRange);
+    EXPECT_THROW(h.getPercentile(100.1), OutOfRange);
+
+    // Multiple occurrences at once.
+    Histogram h2;
+    h2.record(7, 3);
+    EXPECT_EQ(3, h2.getCount());
+    EXPECT_EQ(21, h2.getSum());
+    EXPECT_EQ(3, h2.getBuckets()[7]);
+
+    h.reset();
+    EXPECT_EQ(0, h.getCount());
+    EXPECT_TRUE(h.getBuckets().empty());
+}
+
+// Checks that merging histograms gives the same result as recording
+// all values in one histogram.
+TEST(HistogramTest, merge) {
+    Histogram all;
+    Histogram h1;
+    Histogram h2;
+    for (uint64_t v = 0; v < 100; ++v) {
+        all.record(v * v);
+        if (v % 2) {
+            h1.record(v * v);
+        } else {
+            h2.record(v * v);
+        }
+    }
+    EXPECT_FALSE(all == h1);
+    h1.merge(h2);
+    EXPECT_TRUE(all == h1);
+
+    // Merging an empty histogram does nothing.
+    h1.merge(Histogram());
+    EXPECT_TRUE(all == h1);
+
+    // Merging into an empty histogram copies.
+    Histogram h3;
+    h3.merge(all);
+    EXPECT_TRUE(all == h3);
+}
+
+// Checks the JSON representation.
+TEST(HistogramTest, toElement) {
+    Histogram h;
+    h.record(2);
+    h.record(2);
+    h.record(17);
+    std::string expected = "{ \"buckets\": [ [ 2, 2, 2 ], [ 16, 17, 1 ] ], "
+        "\"count\": 3, \"max\": 17, \"mean\": 7.0, \"min\": 2, "
+        "\"p50\": 2, \"p90\": 17, \"p99\": 17, \"p999\": 17, \"sum\": 21 }";
+    EXPECT_EQ(expected, h.toElement()->str());
+}
+
+}
@@ -585,6 +585,54 @@ TEST_F(ObservationTest, stringToJSON) {
     EXPECT_EQ(exp, d.getJSON()->str());
 }
 
+// Checks whether a histogram statistic records values, keeps only one
+// sample and can generate proper JSON structures.
+TEST_F(ObservationTest, histogram) {
+    Observation h("epsilon", Histogram());
+    EXPECT_EQ(Observation::STAT_HISTOGRAM, h.getType());
+    EXPECT_EQ(0, h.getHistogram().first.getCount());
+
+    EXPECT_NO_THROW(h.recordValue(static_cast<uint64_t>(10)));
+    EXPECT_NO_THROW(h.recordValue(microseconds(20)));
+    EXPECT_NO_THROW(h.recordValue(milliseconds(3)));
+    EXPECT_EQ(3, h.getHistogram().first.getCount());
+    EXPECT_EQ(3030, h.getHistogram().first.getSum());
+    EXPECT_EQ(1, h.getSize());
+
+    // Merge another histogram.
+    Histogram other;
+    other.record(5);
+    EXPECT_NO_THROW(h.addValue(other));
+    EXPECT_EQ(4, h.getHistogram().first.getCount());
+    EXPECT_EQ(5, h.getHistogram().first.getMin());
+    EXPECT_EQ(1, h.getSize());
+
+    // Sample limits are accepted but the histogram is kept.
+    EXPECT_NO_THROW(h.setMaxSampleCount(0));
+    EXPECT_NO_THROW(h.setMaxSampleAge(StatsDuration::zero()));
+    EXPECT_EQ(1, h.getSize());
+    EXPECT_EQ(4, h.getHistogram().first.getCount());
+
+    // Absolute value replaces the histogram.
+    EXPECT_NO_THROW(h.setValue(other));
+    EXPECT_EQ(1, h.getHistogram().first.getCount());
+
+    std::string exp = "[ [ " + other.toElement()->str() + ", \"" +
+        isc::util::clockToText(h.getHistogram().second) + "\" ] ]";
+    EXPECT_EQ(exp, h.getJSON()->str());
+
+    // Other types are not histograms.
+    EXPECT_THROW(a.recordValue(static_cast<uint64_t>(1)), InvalidStatType);
+    EXPECT_THROW(a.addValue(other), InvalidStatType);
+    EXPECT_THROW(a.getHistogram(), InvalidStatType);
+    EXPECT_THROW(h.getInteger(), InvalidStatType);
+    EXPECT_THROW(h.addValue(static_cast<int64_t>(1)), InvalidStatType);
+
+    h.reset();
+    EXPECT_EQ(0, h.getHistogram().first.getCount());
+    EXPECT_EQ(1, h.getSize());
+}
+
 // Checks whether reset() resets the statistics properly.
 TEST_F(ObservationTest, reset) {
     EXPECT_NO_THROW(a.addValue(static_cast<int64_t>(5678)));
@@ -16,6 +16,8 @@
 
 #include <iostream>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 using namespace isc;
 using namespace isc::data;
@@ -124,6 +126,141 @@ TEST_F(StatsMgrTest, stringStat) {
     EXPECT_EQ(exp, StatsMgr::instance().get("delta")->str());
 }
 
+// Test checks whether it's possible to record values in a histogram
+// statistic and to merge histograms into it.
+TEST_F(StatsMgrTest, histogramStat) {
+    // Recording a value creates the histogram.
+    EXPECT_NO_THROW(StatsMgr::instance().recordValue("epsilon",
+                                                     milliseconds(2)));
+    EXPECT_NO_THROW(StatsMgr::instance().recordValue("epsilon",
+                                                     static_cast<uint64_t>(4)));
+
+    Histogram local;
+    local.record(1000);
+    EXPECT_NO_THROW(StatsMgr::instance().addValue("epsilon", local));
+
+    ObservationPtr epsilon;
+    EXPECT_NO_THROW(epsilon = StatsMgr::instance().getObservation("epsilon"));
+    ASSERT_TRUE(epsilon);
+    ASSERT_EQ(Observation::STAT_HISTOGRAM, epsilon->getType());
+    Histogram h = epsilon->getHistogram().first;
+    EXPECT_EQ(3, h.getCount());
+    EXPECT_EQ(3004, h.getSum());
+    EXPECT_EQ(4, h.getMin());
+    EXPECT_EQ(2000, h.getMax());
+
+    std::string exp = "{ \"epsilon\": [ [ " + h.toElement()->str() + ", \"" +
+        isc::util::clockToText(epsilon->getHistogram().second) + "\" ] ] }";
+    EXPECT_EQ(exp, StatsMgr::instance().get("epsilon")->str());
+
+    // Recording a value in a statistic of another type fails.
+    StatsMgr::instance().setValue("alpha", static_cast<int64_t>(1234));
+    EXPECT_THROW(StatsMgr::instance().recordValue("alpha", milliseconds(2)),
+                 InvalidStatType);
+
+    // Reset empties the histogram.
+    EXPECT_TRUE(StatsMgr::instance().reset("epsilon"));
+    EXPECT_EQ(0, epsilon->getHistogram().first.getCount());
+}
+
+// Checks that values recorded in per-thread histograms are merged when
+// statistics are read.
+TEST_F(StatsMgrTest, histogramThreadStat) {
+    StatsMgr::instance().recordThreadValue("epsilon", milliseconds(2));
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.push_back(std::thread([]() {
+            for (uint64_t value = 1; value <= 100; ++value) {
+                StatsMgr::instance().recordThreadValue("epsilon", value);
+            }
+        }));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ObservationPtr epsilon;
+    EXPECT_NO_THROW(epsilon = StatsMgr::instance().getObservation("epsilon"));
+    ASSERT_TRUE(epsilon);
+    ASSERT_EQ(Observation::STAT_HISTOGRAM, epsilon->getType());
+    Histogram h = epsilon->getHistogram().first;
+    EXPECT_EQ(401, h.getCount());
+    EXPECT_EQ(4 * 5050 + 2000, h.getSum());
+    EXPECT_EQ(1, h.getMin());
+    EXPECT_EQ(2000, h.getMax());
+
+    // Merged values are not merged again.
+    EXPECT_EQ(1, StatsMgr::instance().count());
+    EXPECT_EQ(401, epsilon->getHistogram().first.getCount());
+
+    // Pending values are merged before a reset so they are dropped too.
+    StatsMgr::instance().recordThreadValue("epsilon", milliseconds(1));
+    EXPECT_TRUE(StatsMgr::instance().reset("epsilon"));
+    EXPECT_EQ(0, epsilon->getHistogram().first.getCount());
+    EXPECT_NO_THROW(StatsMgr::instance().get("epsilon"));
+    EXPECT_EQ(0, epsilon->getHistogram().first.getCount());
+
+    // Values recorded in a statistic of another type are dropped.
+    StatsMgr::instance().setValue("alpha", static_cast<int64_t>(1234));
+    EXPECT_NO_THROW(StatsMgr::instance().recordThreadValue("alpha",
+                                                           milliseconds(2)));
+    EXPECT_EQ("{ \"alpha\": [ [ 1234, \"" +
+              isc::util::clockToText(StatsMgr::instance().getObservation("alpha")->
+                                     getInteger().second) + "\" ] ] }",
+              StatsMgr::instance().get("alpha")->str());
+}
+
+// Checks that statistics are exported in the OpenMetrics text format.
+TEST_F(StatsMgrTest, openMetrics) {
+    StatsMgr::instance().setValue("pkt4-received", static_cast<int64_t>(10));
+    StatsMgr::instance().setValue("subnet[2].assigned-addresses",
+                                  static_cast<int64_t>(20));
+    StatsMgr::instance().setValue("subnet[10].assigned-addresses",
+                                  static_cast<int64_t>(100));
+    StatsMgr::instance().setValue("subnet[2].pool[0].total-addresses",
+                                  static_cast<int64_t>(256));
+    StatsMgr::instance().setValue("ratio", 0.5);
+    StatsMgr::instance().setValue("uptime", milliseconds(1500));
+    StatsMgr::instance().setValue("version", "1.2 \"beta\"");
+    StatsMgr::instance().recordValue("pkt4-latency", static_cast<uint64_t>(3));
+    StatsMgr::instance().recordValue("pkt4-latency", static_cast<uint64_t>(17));
+    StatsMgr::instance().recordValue("pkt4-latency", static_cast<uint64_t>(17));
+
+    std::ostringstream os;
+    StatsMgr::instance().writeOpenMetrics(os);
+    std::string expected =
+        "# TYPE kea_pkt4_latency histogram\n"
+        "kea_pkt4_latency_bucket{le=\"3\"} 1\n"
+        "kea_pkt4_latency_bucket{le=\"17\"} 3\n"
+        "kea_pkt4_latency_bucket{le=\"+Inf\"} 3\n"
+        "kea_pkt4_latency_count 3\n"
+        "kea_pkt4_latency_sum 37\n"
+        "# TYPE kea_pkt4_received gauge\n"
+        "kea_pkt4_received 10\n"
+        "# TYPE kea_ratio gauge\n"
+        "kea_ratio 0.5\n"
+        "# TYPE kea_subnet_assigned_addresses gauge\n"
+        "kea_subnet_assigned_addresses{subnet=\"10\"} 100\n"
+        "kea_subnet_assigned_addresses{subnet=\"2\"} 20\n"
+        "# TYPE kea_subnet_pool_total_addresses gauge\n"
+        "kea_subnet_pool_total_addresses{subnet=\"2\",pool=\"0\"} 256\n"
+        "# TYPE kea_uptime_seconds gauge\n"
+        "# UNIT kea_uptime_seconds seconds\n"
+        "kea_uptime_seconds 1.5\n"
+        "# TYPE kea_version info\n"
+        "kea_version_info{value=\"1.2 \\\"beta\\\"\"} 1\n"
+        "# EOF\n";
+    EXPECT_EQ(expected, os.str());
+
+    // Check without prefix.
+    StatsMgr::instance().removeAll();
+    StatsMgr::instance().setValue("2nd", static_cast<int64_t>(2));
+    os.str("");
+    StatsMgr::instance().writeOpenMetrics(os, "");
+    EXPECT_EQ("# TYPE _2nd gauge\n_2nd 2\n# EOF\n", os.str());
+}
+
 // Basic test of getSize function.
 TEST_F(StatsMgrTest, getSize) {
     StatsMgr::instance().setValue("alpha", static_cast<int64_t>(1234));
@@ -0,0 +1,100 @@
+// Copyright (C) 2022 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <benchmark/benchmark.h>
+#include <util/thread_pool.h>
+
+#include <atomic>
+#include <functional>
+
+using namespace isc::util;
+
+namespace {
+
+/// @brief Type of the thread pool used by the servers.
+typedef ThreadPool<std::function<void()>> CallBackThreadPool;
+
+/// @brief Number of work items processed by each benchmark iteration.
+const size_t ITEMS_COUNT = 100000;
+
+/// @brief Number of work items added by each work item in the fan-out
+/// benchmark.
+const size_t FAN_OUT = 16;
+
+/// @brief Sets the thread count and scheduler arguments.
+///
+/// The first argument is the number of threads (4 to 64), the second
+/// is 1 when work stealing is enabled, 0 otherwise.
+///
+/// @param b the benchmark.
+void threadPoolArguments(benchmark::internal::Benchmark* b) {
+    for (int threads = 4; threads <= 64; threads *= 2) {
+        for (int work_stealing = 0; work_stealing <= 1; ++work_stealing) {
+            b->Args({threads, work_stealing});
+        }
+    }
+}
+
+/// @brief Benchmarks work items added by the main thread.
+///
+/// This is the packet processing case: the main thread receives packets
+/// and adds a work item for each of them.
+///
+/// @param state the benchmark state.
+void enqueueDequeue(benchmark::State& state) {
+    CallBackThreadPool thread_pool;
+    thread_pool.setWorkStealing(state.range(1) != 0);
+    thread_pool.start(state.range(0));
+    std::atomic<size_t> processed(0);
+    auto item = boost::make_shared<std::function<void()>>([&processed]() {
+        ++processed;
+    });
+    for (auto _ : state) {
+        for (size_t i = 0; i < ITEMS_COUNT; ++i) {
+            thread_pool.add(item);
+        }
+        thread_pool.wait();
+    }
+    thread_pool.reset();
+    state.SetItemsProcessed(processed);
+}
+
+/// @brief Benchmarks work items added by the threads of the pool.
+///
+/// This is the continuation case: work items are added from the threads
+/// of the pool.
+///
+/// @param state the benchmark state.
+void fanOut(benchmark::State& state) {
+    CallBackThreadPool thread_pool;
+    thread_pool.setWorkStealing(state.range(1) != 0);
+    thread_pool.start(state.range(0));
+    std::atomic<size_t> processed(0);
+    auto child = boost::make_shared<std::function<void()>>([&processed]() {
+        ++processed;
+    });
+    auto parent = boost::make_shared<std::function<void()>>([&]() {
+        for (size_t i = 0; i < FAN_OUT; ++i) {
+            thread_pool.add(child);
+        }
+        ++processed;
+    });
+    for (auto _ : state) {
+        for (size_t i = 0; i < ITEMS_COUNT / (FAN_OUT + 1); ++i) {
+            thread_pool.add(parent);
+        }
+        thread_pool.wait();
+    }
+    thread_pool.reset();
+    state.SetItemsProcessed(processed);
+}
+
+}  // namespace
+
+BENCHMARK(enqueueDequeue)->Apply(threadPoolArguments)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(fanOut)->Apply(threadPoolArguments)->UseRealTime()->Unit(benchmark::kMillisecond);
@@ -0,0 +1,192 @@
+// Copyright (C) 2022 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <exceptions/exceptions.h>
+#include <util/cpu_affinity.h>
+#include <util/strutil.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <mutex>
+#include <sstream>
+
+#if defined(OS_LINUX)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+/// @brief Largest accepted CPU number.
+const uint32_t MAX_CPU = 65535;
+
+/// @brief Parses a CPU number.
+///
+/// @param text the CPU number.
+/// @return the CPU number.
+/// @throw BadValue if the text is not a number or the number is too large.
+uint32_t
+parseCpu(const std::string& text) {
+    if (text.empty() || (text.size() > 5) ||
+        !std::all_of(text.begin(), text.end(),
+                     [](char c) { return (std::isdigit(c)); })) {
+        isc_throw(isc::BadValue, "invalid CPU number '" << text << "'");
+    }
+    uint32_t cpu = std::stoul(text);
+    if (cpu > MAX_CPU) {
+        isc_throw(isc::BadValue, "CPU number " << cpu << " is too large");
+    }
+    return (cpu);
+}
+
+/// @brief Returns the handler invoked when a thread can't be pinned.
+isc::util::ThreadAffinityErrorHandler&
+errorHandler() {
+    static isc::util::ThreadAffinityErrorHandler handler;
+    return (handler);
+}
+
+/// @brief Mutex protecting the error handler.
+std::mutex&
+errorHandlerMutex() {
+    static std::mutex mutex;
+    return (mutex);
+}
+
+} // end of anonymous namespace
+
+namespace isc {
+namespace util {
+
+CpuSet
+parseCpuSet(const std::string& text) {
+    CpuSet cpus;
+    std::string trimmed = str::trim(text);
+    if (trimmed.empty()) {
+        return (cpus);
+    }
+    std::istringstream items(trimmed);
+    std::string item;
+    while (std::getline(items, item, ',')) {
+        std::string range = str::trim(item);
+        size_t dash = range.find('-');
+        if (dash == std::string::npos) {
+            cpus.push_back(parseCpu(range));
+            continue;
+        }
+        uint32_t first = parseCpu(str::trim(range.substr(0, dash)));
+        uint32_t last = parseCpu(str::trim(range.substr(dash + 1)));
+        if (first > last) {
+            isc_throw(BadValue, "invalid CPU range '" << range << "'");
+        }
+        for (uint32_t cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    if (trimmed.back() == ',') {
+        isc_throw(BadValue, "invalid CPU list '" << text << "'");
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return (cpus);
+}
+
+std::string
+cpuSetToText(const CpuSet& cpus) {
+    std::ostringstream s;
+    for (size_t i = 0; i < cpus.size(); ) {
+        size_t j = i;
+        while ((j + 1 < cpus.size()) && (cpus[j + 1] == cpus[j] + 1)) {
+            ++j;
+        }
+        if (i) {
+            s << ",";
+        }
+        s << cpus[i];
+        if (j > i) {
+            s << "-" << cpus[j];
+        }
+        i = j + 1;
+    }
+    return (s.str());
+}
+
+bool
+isThreadAffinitySupported() {
+#if defined(OS_LINUX)
+    return (true);
+#else
+    return (false);
+#endif
+}
+
+bool
+setThreadAffinity(const CpuSet& cpus) {
+    if (cpus.empty()) {
+        return (true);
+    }
+#if defined(OS_LINUX)
+    size_t count = *std::max_element(cpus.begin(), cpus.end()) + 1;
+    cpu_set_t* set = CPU_ALLOC(count);
+    if (!set) {
+        errno = ENOMEM;
+        return (false);
+    }
+    size_t size = CPU_ALLOC_SIZE(count);
+    CPU_ZERO_S(size, set);
+    for (auto cpu : cpus) {
+        CPU_SET_S(cpu, size, set);
+    }
+    // This function returns the error instead of setting errno.
+    int ret = pthread_setaffinity_np(pthread_self(), size, set);
+    CPU_FREE(set);
+    if (ret != 0) {
+        errno = ret;
+        return (false);
+    }
+    return (true);
+#else
+    errno = ENOSYS;
+    return (false);
+#endif
+}
+
+void
+setThreadAffinityErrorHandler(const ThreadAffinityErrorHandler& handler) {
+    std::lock_guard<std::mutex> lock(errorHandlerMutex());
+    errorHandler() = handler;
+}
+
+void
+pinThread(const CpuSet& cpus) {
+    if (setThreadAffinity(cpus)) {
+        return;
+    }
+    int error = errno;
+    ThreadAffinityErrorHandler handler;
+    {
+        std::lock_guard<std::mutex> lock(errorHandlerMutex());
+        handler = errorHandler();
+    }
+    if (handler) {
+        handler(cpus, error);
+    }
+}
+
+int
+getCurrentCpu() {
+#if defined(OS_LINUX)
+    return (sched_getcpu());
+#else
+    return (-1);
+#endif
+}
+
+} // namespace util
+} // namespace isc
@@ -0,0 +1,86 @@
+// Copyright (C) 2022 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef CPU_AFFINITY_H
+#define CPU_AFFINITY_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace isc {
+namespace util {
+
+/// @brief Type of CPU sets, i.e. sorted lists of CPU numbers.
+typedef std::vector<uint32_t> CpuSet;
+
+/// @brief Parses a CPU list.
+///
+/// The syntax is the one of the Linux cpuset "cpus" files and of the
+/// taskset -c command: a comma separated list of CPU numbers and ranges,
+/// e.g. "0-3,8,10-11". An empty string gives an empty set.
+///
+/// @param text the CPU list.
+/// @return the sorted set of CPU numbers without duplicates.
+/// @throw BadValue if the text is not a valid CPU list.
+CpuSet parseCpuSet(const std::string& text);
+
+/// @brief Returns the textual representation of a CPU set.
+///
+/// Consecutive CPUs are displayed as ranges so the output can be parsed
+/// by @ref parseCpuSet.
+///
+/// @param cpus the CPU set.
+/// @return the CPU list, e.g. "0-3,8".
+std::string cpuSetToText(const CpuSet& cpus);
+
+/// @brief Checks if the CPU affinity of threads can be set.
+///
+/// @return true on Linux, false on other systems.
+bool isThreadAffinitySupported();
+
+/// @brief Pins the calling thread on a CPU set.
+///
+/// Memory pages are allocated on the NUMA node of the CPU which first
+/// touches them so buffers allocated by the thread after this call are
+/// local to the CPU set.
+///
+/// @param cpus the CPU set. An empty set does nothing.
+/// @return true on success, false if the CPU affinity can not be set
+/// (e.g. a CPU is not available or the system is not Linux): errno is
+/// then set to the reason.
+bool setThreadAffinity(const CpuSet& cpus);
+
+/// @brief Type of the handler invoked when a thread can't be pinned.
+///
+/// It is passed the CPU set and the errno value.
+typedef std::function<void(const CpuSet&, int)> ThreadAffinityErrorHandler;
+
+/// @brief Sets the handler invoked when a thread can't be pinned.
+///
+/// The handler is invoked by the thread which failed to pin itself.
+///
+/// @param handler the handler, an empty function to remove it.
+void setThreadAffinityErrorHandler(const ThreadAffinityErrorHandler& handler);
+
+/// @brief Pins the calling thread on a CPU set if possible.
+///
+/// The thread keeps running unpinned when the CPU affinity can not be set:
+/// the error handler is then invoked.
+///
+/// @param cpus the CPU set. An empty set does nothing.
+void pinThread(const CpuSet& cpus);
+
+/// @brief Returns the CPU the calling thread runs on.
+///
+/// @return the CPU number or -1 if it is not available.
+int getCurrentCpu();
+
+} // namespace util
+} // namespace isc
+
+#endif // CPU_AFFINITY_H
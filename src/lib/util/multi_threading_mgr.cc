@@ -1,4 +1,4 @@
-// Copyright (C) 2019-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2019-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -12,7 +12,8 @@ namespace isc {
 namespace util {
 
 MultiThreadingMgr::MultiThreadingMgr()
-    : enabled_(false), critical_section_count_(0), thread_pool_size_(0) {
+    : enabled_(false), critical_section_count_(0), thread_pool_size_(0),
+      work_stealing_(false) {
 }
 
 MultiThreadingMgr::~MultiThreadingMgr() {
@@ -104,6 +105,26 @@ MultiThreadingMgr::setPacketQueueSize(uint32_t size) {
     thread_pool_.setMaxQueueSize(size);
 }
 
+bool
+MultiThreadingMgr::getWorkStealing() const {
+    return (work_stealing_);
+}
+
+void
+MultiThreadingMgr::setWorkStealing(bool work_stealing) {
+    work_stealing_ = work_stealing;
+}
+
+const CpuSet&
+MultiThreadingMgr::getCpuSet() const {
+    return (cpu_set_);
+}
+
+void
+MultiThreadingMgr::setCpuSet(const CpuSet& cpus) {
+    cpu_set_ = cpus;
+}
+
 uint32_t
 MultiThreadingMgr::detectThreadCount() {
     return (std::thread::hardware_concurrency());
@@ -114,6 +135,10 @@ MultiThreadingMgr::apply(bool enabled, uint32_t thread_count, uint32_t queue_siz
     // check the enabled flag
     if (enabled) {
         // check for auto scaling (enabled flag true but thread_count 0)
+        if (!thread_count) {
+            // use one thread per configured CPU if any
+            thread_count = cpu_set_.size();
+        }
         if (!thread_count) {
             // might also return 0
             thread_count = MultiThreadingMgr::detectThreadCount();
@@ -128,6 +153,8 @@ MultiThreadingMgr::apply(bool enabled, uint32_t thread_count, uint32_t queue_siz
         if (thread_pool_.size()) {
             thread_pool_.stop();
         }
+        thread_pool_.setWorkStealing(work_stealing_);
+        thread_pool_.setCpuSet(cpu_set_);
         setThreadPoolSize(thread_count);
         setPacketQueueSize(queue_size);
         setMode(true);
@@ -137,6 +164,8 @@ MultiThreadingMgr::apply(bool enabled, uint32_t thread_count, uint32_t queue_siz
     } else {
         removeAllCriticalSectionCallbacks();
         thread_pool_.reset();
+        thread_pool_.setWorkStealing(work_stealing_);
+        thread_pool_.setCpuSet(cpu_set_);
         setMode(false);
         setThreadPoolSize(thread_count);
         setPacketQueueSize(queue_size);
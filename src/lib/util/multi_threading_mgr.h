@@ -1,4 +1,4 @@
-// Copyright (C) 2019-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2019-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -211,6 +211,33 @@ public:
     /// @param size The dhcp packet queue size.
     void setPacketQueueSize(uint32_t size);
 
+    /// @brief Get the configured dhcp thread pool scheduler.
+    ///
+    /// @return true if the dhcp thread pool uses work stealing, false if
+    /// it uses one queue.
+    bool getWorkStealing() const;
+
+    /// @brief Set the configured dhcp thread pool scheduler.
+    ///
+    /// The scheduler is changed by the next call to @ref apply.
+    ///
+    /// @param work_stealing true to use per thread queues with work
+    /// stealing, false to use one queue.
+    void setWorkStealing(bool work_stealing);
+
+    /// @brief Get the configured CPUs of the dhcp thread pool.
+    ///
+    /// @return The CPU set, empty when the threads are not pinned.
+    const CpuSet& getCpuSet() const;
+
+    /// @brief Set the configured CPUs of the dhcp thread pool.
+    ///
+    /// The threads are pinned by the next call to @ref apply: each thread
+    /// is pinned on one CPU of the set, see @ref ThreadPool::setCpuSet.
+    ///
+    /// @param cpus The CPU set, empty to not pin the threads.
+    void setCpuSet(const CpuSet& cpus);
+
     /// @brief The system current detected hardware concurrency thread count.
     ///
     /// This function will return 0 if the value can not be determined.
@@ -227,7 +254,8 @@ public:
     /// @param enabled The enabled flag: true if multi-threading is enabled,
     /// false otherwise.
     /// @param thread_count The desired number of threads: non 0 if explicitly
-    /// configured, 0 if auto scaling is desired
+    /// configured, 0 if auto scaling is desired (one thread per CPU of the
+    /// configured CPU set or per detected hardware thread)
     /// @param queue_size The desired thread queue size: non 0 if explicitly
     /// configured, 0 for unlimited size
     void apply(bool enabled, uint32_t thread_count, uint32_t queue_size);
@@ -318,6 +346,12 @@ private:
     /// @brief The configured size of the dhcp thread pool.
     uint32_t thread_pool_size_;
 
+    /// @brief The configured scheduler of the dhcp thread pool.
+    bool work_stealing_;
+
+    /// @brief The configured CPUs of the dhcp thread pool.
+    CpuSet cpu_set_;
+
     /// @brief Packet processing thread pool.
     ThreadPool<std::function<void()>> thread_pool_;
 
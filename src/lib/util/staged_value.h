@@ -1,4 +1,4 @@
-// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2015-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -49,6 +49,14 @@ public:
         return (modified_ ? *staging_ : *current_);
     }
 
+    /// @brief Retrieves the committed value.
+    ///
+    /// Unlike @c getValue this ignores the modifications which have not
+    /// been committed yet.
+    const ValueType& getCommittedValue() const {
+        return (*current_);
+    }
+
     /// @brief Sets new value.
     ///
     /// @param new_value New value to be assigned.
@@ -0,0 +1,105 @@
+// Copyright (C) 2022 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <exceptions/exceptions.h>
+#include <util/cpu_affinity.h>
+
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <thread>
+
+using namespace isc;
+using namespace isc::util;
+
+namespace {
+
+// Checks the parsing of CPU lists.
+TEST(CpuAffinityTest, parseCpuSet) {
+    EXPECT_TRUE(parseCpuSet("").empty());
+    EXPECT_TRUE(parseCpuSet("  ").empty());
+    EXPECT_EQ(CpuSet({ 3 }), parseCpuSet("3"));
+    EXPECT_EQ(CpuSet({ 0, 1, 2, 3, 8 }), parseCpuSet("0-3,8"));
+    EXPECT_EQ(CpuSet({ 1, 2, 5 }), parseCpuSet(" 5 , 1 - 2, 2"));
+    EXPECT_EQ(CpuSet({ 65535 }), parseCpuSet("65535"));
+
+    EXPECT_THROW(parseCpuSet("a"), BadValue);
+    EXPECT_THROW(parseCpuSet("-1"), BadValue);
+    EXPECT_THROW(parseCpuSet("1,"), BadValue);
+    EXPECT_THROW(parseCpuSet(",1"), BadValue);
+    EXPECT_THROW(parseCpuSet("1,,2"), BadValue);
+    EXPECT_THROW(parseCpuSet("3-1"), BadValue);
+    EXPECT_THROW(parseCpuSet("1-2-3"), BadValue);
+    EXPECT_THROW(parseCpuSet("65536"), BadValue);
+}
+
+// Checks the textual representation of CPU sets.
+TEST(CpuAffinityTest, cpuSetToText) {
+    EXPECT_EQ("", cpuSetToText(CpuSet()));
+    EXPECT_EQ("3", cpuSetToText(CpuSet({ 3 })));
+    EXPECT_EQ("0-3,8", cpuSetToText(CpuSet({ 0, 1, 2, 3, 8 })));
+    EXPECT_EQ("1,3,5-6", cpuSetToText(CpuSet({ 1, 3, 5, 6 })));
+    EXPECT_EQ("0-3,8", cpuSetToText(parseCpuSet("8,0-3")));
+}
+
+// Checks that a thread can be pinned.
+TEST(CpuAffinityTest, setThreadAffinity) {
+    // An empty set does nothing.
+    EXPECT_TRUE(setThreadAffinity(CpuSet()));
+
+#if defined(OS_LINUX)
+    // Pin a thread on the CPU it runs on: it is available.
+    std::thread thread([]() {
+        int cpu = getCurrentCpu();
+        ASSERT_LE(0, cpu);
+        EXPECT_TRUE(setThreadAffinity(CpuSet(1, cpu)));
+        EXPECT_EQ(cpu, getCurrentCpu());
+        // The last CPU number is not available.
+        errno = 0;
+        EXPECT_FALSE(setThreadAffinity(CpuSet(1, 65535)));
+        EXPECT_NE(0, errno);
+    });
+    thread.join();
+#else
+    EXPECT_EQ(-1, getCurrentCpu());
+    errno = 0;
+    EXPECT_FALSE(setThreadAffinity(CpuSet(1, 0)));
+    EXPECT_EQ(ENOSYS, errno);
+#endif
+}
+
+// Checks that a thread which can't be pinned invokes the error handler.
+TEST(CpuAffinityTest, pinThread) {
+    CpuSet failed;
+    int error = 0;
+    setThreadAffinityErrorHandler([&failed, &error](const CpuSet& cpus,
+                                                    int err) {
+        failed = cpus;
+        error = err;
+    });
+
+    // An empty set does nothing.
+    pinThread(CpuSet());
+    EXPECT_TRUE(failed.empty());
+
+    // The last CPU number is not available: the thread keeps running.
+    std::thread thread([]() {
+        pinThread(CpuSet(1, 65535));
+    });
+    thread.join();
+    EXPECT_EQ(CpuSet(1, 65535), failed);
+    EXPECT_NE(0, error);
+
+    // Without handler the failure is silent.
+    setThreadAffinityErrorHandler(ThreadAffinityErrorHandler());
+    failed.clear();
+    EXPECT_NO_THROW(pinThread(CpuSet(1, 65535)));
+    EXPECT_TRUE(failed.empty());
+}
+
+}
@@ -1,4 +1,4 @@
-// Copyright (C) 2019-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2019-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -124,6 +124,57 @@ TEST(MultiThreadingMgrTest, applyConfig) {
     EXPECT_EQ(thread_pool.size(), 0);
 }
 
+/// @brief Verifies that the thread pool scheduler is applied.
+TEST(MultiThreadingMgrTest, workStealing) {
+    // get the thread pool
+    auto& thread_pool = MultiThreadingMgr::instance().getThreadPool();
+    // work stealing is disabled by default
+    EXPECT_FALSE(MultiThreadingMgr::instance().getWorkStealing());
+    EXPECT_FALSE(thread_pool.getWorkStealing());
+    // the setter only records the scheduler
+    EXPECT_NO_THROW(MultiThreadingMgr::instance().setWorkStealing(true));
+    EXPECT_TRUE(MultiThreadingMgr::instance().getWorkStealing());
+    EXPECT_FALSE(thread_pool.getWorkStealing());
+    // enable MT with 16 threads and queue size 256
+    EXPECT_NO_THROW(MultiThreadingMgr::instance().apply(true, 16, 256));
+    EXPECT_TRUE(thread_pool.getWorkStealing());
+    EXPECT_EQ(thread_pool.size(), 16);
+    EXPECT_EQ(MultiThreadingMgr::instance().getPacketQueueSize(), 256);
+    // change the scheduler of the running thread pool
+    EXPECT_NO_THROW(MultiThreadingMgr::instance().setWorkStealing(false));
+    EXPECT_NO_THROW(MultiThreadingMgr::instance().apply(true, 16, 256));
+    EXPECT_FALSE(thread_pool.getWorkStealing());
+    EXPECT_EQ(thread_pool.size(), 16);
+    // disable MT
+    EXPECT_NO_THROW(MultiThreadingMgr::instance().apply(false, 0, 0));
+    EXPECT_EQ(thread_pool.size(), 0);
+}
+
+/// @brief Verifies that the CPU set is applied to the thread pool.
+TEST(MultiThreadingMgrTest, cpuSet) {
+    // get the thread pool
+    auto& thread_pool = MultiThreadingMgr::instance().getThreadPool();
+    // threads are not pinned by default
+    EXPECT_TRUE(MultiThreadingMgr::instance().getCpuSet().empty());
+    // the setter only records the CPU set
+    CpuSet cpus = { 0 };
+    EXPECT_NO_THROW(MultiThreadingMgr::instance().setCpuSet(cpus));
+    EXPECT_EQ(cpus, MultiThreadingMgr::instance().getCpuSet());
+    EXPECT_TRUE(thread_pool.getCpuSet().empty());
+    // enable MT with auto scaling: one thread per CPU of the set
+    EXPECT_NO_THROW(MultiThreadingMgr::instance().apply(true, 0, 16));
+    EXPECT_EQ(cpus, thread_pool.getCpuSet());
+    EXPECT_EQ(thread_pool.size(), 1);
+    // an explicit thread count has precedence
+    EXPECT_NO_THROW(MultiThreadingMgr::instance().apply(true, 4, 16));
+    EXPECT_EQ(thread_pool.size(), 4);
+    // disable MT
+    EXPECT_NO_THROW(MultiThreadingMgr::instance().setCpuSet(CpuSet()));
+    EXPECT_NO_THROW(MultiThreadingMgr::instance().apply(false, 0, 0));
+    EXPECT_EQ(thread_pool.size(), 0);
+    EXPECT_TRUE(thread_pool.getCpuSet().empty());
+}
+
 /// @brief Verifies that the critical section flag works.
 TEST(MultiThreadingMgrTest, criticalSectionFlag) {
     // get the thread pool
@@ -1,4 +1,4 @@
-// Copyright (C) 2015-2017 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2015-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -88,6 +88,20 @@ TEST(StagedValueTest, commit) {
     EXPECT_EQ(123, value.getValue());
 }
 
+// This test checks that the committed value ignores uncommitted changes.
+TEST(StagedValueTest, getCommittedValue) {
+    StagedValue<int> value;
+    value.setValue(123);
+    value.commit();
+
+    value.setValue(456);
+    EXPECT_EQ(456, value.getValue());
+    EXPECT_EQ(123, value.getCommittedValue());
+
+    value.commit();
+    EXPECT_EQ(456, value.getCommittedValue());
+}
+
 // This test checks that type conversion operator works correctly.
 TEST(StagedValueTest, conversionOperator) {
     StagedValue<int> value;
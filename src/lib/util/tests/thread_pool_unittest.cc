@@ -1,4 +1,4 @@
-// Copyright (C) 2018-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2018-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -11,6 +11,9 @@
 #include <exceptions/exceptions.h>
 #include <util/thread_pool.h>
 
+#include <algorithm>
+#include <atomic>
+
 #include <signal.h>
 
 using namespace isc;
@@ -658,4 +661,189 @@ TEST_F(ThreadPoolTest, getQueueStat) {
     EXPECT_NO_THROW(thread_pool.getQueueStat(1000));
 }
 
+
+/// @brief test ThreadPool with work stealing
+TEST_F(ThreadPoolTest, workStealing) {
+    uint32_t items_count;
+    uint32_t thread_count;
+    CallBack call_back;
+    ThreadPool<CallBack> thread_pool;
+    // work stealing is disabled by default
+    EXPECT_FALSE(thread_pool.getWorkStealing());
+
+    items_count = 16;
+    thread_count = 16;
+    // prepare setup
+    reset(thread_count);
+
+    // create tasks which block thread pool threads until signaled by main
+    // thread to force all threads of the thread pool to run exactly one task
+    call_back = std::bind(&ThreadPoolTest::runAndWait, this);
+
+    // add items to stopped thread pool
+    for (uint32_t i = 0; i < items_count; ++i) {
+        bool ret = true;
+        EXPECT_NO_THROW(ret = thread_pool.add(boost::make_shared<CallBack>(call_back)));
+        EXPECT_TRUE(ret);
+    }
+
+    // enabling work stealing should keep the queued items
+    EXPECT_NO_THROW(thread_pool.setWorkStealing(true));
+    EXPECT_TRUE(thread_pool.getWorkStealing());
+    ASSERT_EQ(thread_pool.count(), items_count);
+
+    // calling start should create the threads and should keep the queued items
+    EXPECT_NO_THROW(thread_pool.start(thread_count));
+    ASSERT_EQ(thread_pool.size(), thread_count);
+
+    // the scheduler can't be changed when the thread pool is started
+    EXPECT_THROW(thread_pool.setWorkStealing(false), InvalidOperation);
+
+    // wait for all items to be processed
+    waitTasks(thread_count, items_count);
+    // the item count should be 0
+    ASSERT_EQ(thread_pool.count(), 0);
+    // as each thread pool thread is still waiting on main to unblock, each
+    // thread should have been registered in ids list
+    checkIds(items_count);
+    // check that the number of processed tasks matches the number of items
+    checkRunHistory(items_count);
+
+    // check that waiting on tasks does timeout
+    ASSERT_FALSE(thread_pool.wait(1));
+
+    // signal thread pool tasks to continue
+    signalThreads();
+
+    // all tasks are finished
+    EXPECT_TRUE(thread_pool.wait(1));
+
+    // calling stop should clear all threads
+    EXPECT_NO_THROW(thread_pool.stop());
+    ASSERT_EQ(thread_pool.count(), 0);
+    ASSERT_EQ(thread_pool.size(), 0);
+
+    items_count = 64;
+    thread_count = 4;
+    // prepare setup
+    reset(thread_count);
+
+    // create tasks which add other tasks from the thread pool threads: the
+    // added tasks go to the queue of the thread and are stolen by the other
+    // threads
+    std::atomic<uint32_t> processed(0);
+    CallBack child = [&processed]() {
+        ++processed;
+    };
+    call_back = [&]() {
+        for (uint32_t i = 0; i < 3; ++i) {
+            EXPECT_TRUE(thread_pool.add(boost::make_shared<CallBack>(child)));
+        }
+        EXPECT_TRUE(thread_pool.addFront(boost::make_shared<CallBack>(child)));
+        ++processed;
+    };
+
+    for (uint32_t i = 0; i < items_count; ++i) {
+        EXPECT_TRUE(thread_pool.add(boost::make_shared<CallBack>(call_back)));
+    }
+    EXPECT_NO_THROW(thread_pool.start(thread_count));
+
+    // wait for all items to be processed including the added ones
+    thread_pool.wait();
+    EXPECT_EQ(5 * items_count, processed);
+    ASSERT_EQ(thread_pool.count(), 0);
+
+    // disabling work stealing requires a stopped thread pool
+    EXPECT_NO_THROW(thread_pool.stop());
+    EXPECT_NO_THROW(thread_pool.setWorkStealing(false));
+    EXPECT_FALSE(thread_pool.getWorkStealing());
+}
+
+/// @brief test ThreadPool max queue size and add front with work stealing
+TEST_F(ThreadPoolTest, workStealingMaxQueueSize) {
+    uint32_t items_count;
+    CallBack call_back;
+    ThreadPool<CallBack> thread_pool;
+    thread_pool.setWorkStealing(true);
+
+    items_count = 20;
+
+    call_back = std::bind(&ThreadPoolTest::run, this);
+
+    // add items to stopped thread pool
+    bool ret = true;
+    for (uint32_t i = 0; i < items_count; ++i) {
+        EXPECT_NO_THROW(ret = thread_pool.add(boost::make_shared<CallBack>(call_back)));
+        EXPECT_TRUE(ret);
+    }
+
+    // the item count should match
+    ASSERT_EQ(thread_pool.count(), items_count);
+
+    // change the max count
+    ASSERT_EQ(thread_pool.getMaxQueueSize(), 0);
+    size_t max_queue_size = 10;
+    thread_pool.setMaxQueueSize(max_queue_size);
+    EXPECT_EQ(thread_pool.getMaxQueueSize(), max_queue_size);
+
+    // adding an item at front should change nothing queue
+    EXPECT_NO_THROW(ret = thread_pool.addFront(boost::make_shared<CallBack>(call_back)));
+    EXPECT_FALSE(ret);
+    EXPECT_EQ(thread_pool.count(), items_count);
+
+    // adding an item should squeeze the queue
+    EXPECT_NO_THROW(ret = thread_pool.add(boost::make_shared<CallBack>(call_back)));
+    EXPECT_FALSE(ret);
+    EXPECT_EQ(thread_pool.count(), max_queue_size);
+
+    // statistics are available
+    EXPECT_NO_THROW(thread_pool.getQueueStat(10));
+    EXPECT_THROW(thread_pool.getQueueStat(1), InvalidParameter);
+
+    // calling reset should remove all queued items
+    EXPECT_NO_THROW(thread_pool.reset());
+    EXPECT_EQ(thread_pool.count(), 0);
+    EXPECT_TRUE(thread_pool.wait(0));
+}
+
+/// @brief test ThreadPool CPU set
+TEST_F(ThreadPoolTest, cpuSet) {
+    ThreadPool<CallBack> thread_pool;
+    EXPECT_TRUE(thread_pool.getCpuSet().empty());
+    EXPECT_TRUE(thread_pool.getThreadCpus().empty());
+
+    // pin all the threads on CPU 0 which is always available
+    CpuSet cpus(1, 0);
+    EXPECT_NO_THROW(thread_pool.setCpuSet(cpus));
+    EXPECT_EQ(cpus, thread_pool.getCpuSet());
+
+    for (auto work_stealing : { false, true }) {
+        thread_pool.setWorkStealing(work_stealing);
+        uint32_t thread_count = 3;
+        ASSERT_NO_THROW(thread_pool.start(thread_count));
+        EXPECT_THROW(thread_pool.setCpuSet(CpuSet()), InvalidOperation);
+
+        // each thread records its CPU when it is placed
+        for (uint32_t i = 0; i < thread_count; ++i) {
+            thread_pool.add(boost::make_shared<CallBack>([]() {}));
+        }
+        ASSERT_TRUE(thread_pool.wait(10));
+        std::vector<int> thread_cpus;
+        for (int retry = 0; retry < 1000; ++retry) {
+            thread_cpus = thread_pool.getThreadCpus();
+            if (std::count(thread_cpus.begin(), thread_cpus.end(), -1) == 0) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ASSERT_EQ(thread_count, thread_cpus.size());
+#if defined(OS_LINUX)
+        for (auto cpu : thread_cpus) {
+            EXPECT_EQ(0, cpu);
+        }
+#endif
+        ASSERT_NO_THROW(thread_pool.stop());
+    }
+}
+
 }  // namespace
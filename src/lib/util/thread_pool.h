@@ -1,4 +1,4 @@
-// Copyright (C) 2018-2021 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2018-2022 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -8,17 +8,22 @@
 #define THREAD_POOL_H
 
 #include <exceptions/exceptions.h>
+#include <util/cpu_affinity.h>
 #include <boost/make_shared.hpp>
 #include <boost/shared_ptr.hpp>
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <cmath>
 #include <condition_variable>
+#include <deque>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <thread>
+#include <vector>
 
 #include <signal.h>
 
@@ -28,6 +33,18 @@ namespace util {
 /// @brief Defines a thread pool which uses a thread pool queue for managing
 /// work items. Each work item is a 'functor' object.
 ///
+/// By default all work items are stored in one queue protected by a mutex.
+/// When work stealing is enabled (see @ref setWorkStealing) each thread
+/// has its own queue: work items added by a thread of the pool go to the
+/// queue of this thread, other work items go to a global injection queue,
+/// and idle threads take work items from their queue, then from the
+/// injection queue and then from the queues of other threads before
+/// parking.
+///
+/// When a CPU set is configured (see @ref setCpuSet) each thread pins
+/// itself on one CPU of the set before processing work items. A thread
+/// which can't be pinned keeps running unpinned, see @ref pinThread.
+///
 /// @tparam WorkItem a functor
 /// @tparam Container a 'queue like' container
 template <typename WorkItem, typename Container = std::deque<boost::shared_ptr<WorkItem>>>
@@ -44,8 +61,12 @@ struct ThreadPool {
     /// @brief Type of shared pointers to work items.
     typedef typename boost::shared_ptr<WorkItem> WorkItemPtr;
 
+    /// @brief Number of rounds an idle thread looks for work before parking
+    /// when work stealing is enabled.
+    static const size_t STEALING_SPIN_COUNT = 64;
+
     /// @brief Constructor
-    ThreadPool() {
+    ThreadPool() : work_stealing_(false) {
     }
 
     /// @brief Destructor
@@ -60,6 +81,7 @@ struct ThreadPool {
     void reset() {
         stopInternal();
         queue_.clear();
+        stealing_queue_.clear();
     }
 
     /// @brief start all the threads
@@ -73,7 +95,7 @@ struct ThreadPool {
         if (!thread_count) {
             isc_throw(InvalidParameter, "thread count is 0");
         }
-        if (queue_.enabled()) {
+        if (enabled()) {
             isc_throw(InvalidOperation, "thread pool already started");
         }
         startInternal(thread_count);
@@ -83,18 +105,54 @@ struct ThreadPool {
     ///
     /// @throw InvalidOperation if thread pool already stopped
     void stop() {
-        if (!queue_.enabled()) {
+        if (!enabled()) {
             isc_throw(InvalidOperation, "thread pool already stopped");
         }
         stopInternal();
     }
 
+    /// @brief enable or disable work stealing
+    ///
+    /// Work items queued while the thread pool is stopped are kept.
+    ///
+    /// @param work_stealing true to use per thread queues with work
+    /// stealing, false to use one queue.
+    /// @throw InvalidOperation if thread pool is started
+    void setWorkStealing(bool work_stealing) {
+        if (enabled()) {
+            isc_throw(InvalidOperation, "thread pool already started");
+        }
+        if (work_stealing == work_stealing_) {
+            return;
+        }
+        if (work_stealing) {
+            for (auto const& item : queue_.drain()) {
+                stealing_queue_.pushBack(item);
+            }
+        } else {
+            for (auto const& item : stealing_queue_.drain()) {
+                queue_.pushBack(item);
+            }
+        }
+        work_stealing_ = work_stealing;
+    }
+
+    /// @brief get work stealing flag
+    ///
+    /// @return true if work stealing is enabled, false otherwise
+    bool getWorkStealing() const {
+        return (work_stealing_);
+    }
+
     /// @brief add a work item to the thread pool
     ///
     /// @param item the 'functor' object to be added to the queue
     /// @return false if the queue was full and oldest item(s) was dropped,
     /// true otherwise.
     bool add(const WorkItemPtr& item) {
+        if (work_stealing_) {
+            return (stealing_queue_.pushBack(item));
+        }
         return (queue_.pushBack(item));
     }
 
@@ -103,6 +161,9 @@ struct ThreadPool {
     /// @param item the 'functor' object to be added to the queue
     /// @return false if the queue was full, true otherwise.
     bool addFront(const WorkItemPtr& item) {
+        if (work_stealing_) {
+            return (stealing_queue_.pushFront(item));
+        }
         return (queue_.pushFront(item));
     }
 
@@ -110,6 +171,9 @@ struct ThreadPool {
     ///
     /// @return the number of work items in the queue
     size_t count() {
+        if (work_stealing_) {
+            return (stealing_queue_.count());
+        }
         return (queue_.count());
     }
 
@@ -122,6 +186,10 @@ struct ThreadPool {
         if (checkThreadId(id)) {
             isc_throw(MultiThreadingInvalidOperation, "thread pool wait called by worker thread");
         }
+        if (work_stealing_) {
+            stealing_queue_.wait();
+            return;
+        }
         queue_.wait();
     }
 
@@ -137,6 +205,9 @@ struct ThreadPool {
         if (checkThreadId(id)) {
             isc_throw(MultiThreadingInvalidOperation, "thread pool wait with timeout called by worker thread");
         }
+        if (work_stealing_) {
+            return (stealing_queue_.wait(seconds));
+        }
         return (queue_.wait(seconds));
     }
 
@@ -145,6 +216,7 @@ struct ThreadPool {
     /// @param max_queue_size the maximum size (0 means unlimited)
     void setMaxQueueSize(size_t max_queue_size) {
         queue_.setMaxQueueSize(max_queue_size);
+        stealing_queue_.setMaxQueueSize(max_queue_size);
     }
 
     /// @brief get maximum number of work items in the queue
@@ -154,6 +226,42 @@ struct ThreadPool {
         return (queue_.getMaxQueueSize());
     }
 
+    /// @brief set the CPUs the threads are pinned on
+    ///
+    /// The thread with index i is pinned on the CPU i modulo the size of
+    /// the set, so threads are spread over all CPUs of the set. Buffers
+    /// the threads allocate are then local to their NUMA node. An empty
+    /// set leaves the placement to the system.
+    ///
+    /// @param cpus the CPU set.
+    /// @throw InvalidOperation if thread pool is started
+    void setCpuSet(const CpuSet& cpus) {
+        if (enabled()) {
+            isc_throw(InvalidOperation, "thread pool already started");
+        }
+        cpu_set_ = cpus;
+    }
+
+    /// @brief get the CPUs the threads are pinned on
+    ///
+    /// @return the CPU set
+    const CpuSet& getCpuSet() const {
+        return (cpu_set_);
+    }
+
+    /// @brief get the CPU each thread last ran on
+    ///
+    /// Each thread records its CPU when it starts and after each work item.
+    ///
+    /// @return the CPU of each thread, -1 when it is not known
+    std::vector<int> getThreadCpus() {
+        std::vector<int> cpus;
+        for (size_t i = 0; i < threads_.size(); ++i) {
+            cpus.push_back(thread_cpus_[i].load(std::memory_order_relaxed));
+        }
+        return (cpus);
+    }
+
     /// @brief size number of thread pool threads
     ///
     /// @return the number of threads
@@ -167,10 +275,20 @@ struct ThreadPool {
     /// @return the queue length statistic
     /// @throw InvalidParameter if which is not 10 and 100 and 1000.
     double getQueueStat(size_t which) {
+        if (work_stealing_) {
+            return (stealing_queue_.getQueueStat(which));
+        }
         return (queue_.getQueueStat(which));
     }
 
 private:
+    /// @brief return the state of the thread pool
+    ///
+    /// @return true if the thread pool is started
+    bool enabled() {
+        return (queue_.enabled() || stealing_queue_.enabled());
+    }
+
     /// @brief start all the threads
     ///
     /// @param thread_count specifies the number of threads to be created and
@@ -185,10 +303,22 @@ private:
         sigaddset(&sset, SIGHUP);
         sigaddset(&sset, SIGTERM);
         pthread_sigmask(SIG_BLOCK, &sset, &osset);
-        queue_.enable(thread_count);
+        thread_cpus_.reset(new std::atomic<int>[thread_count]);
+        for (uint32_t i = 0; i < thread_count; ++i) {
+            thread_cpus_[i] = -1;
+        }
+        if (work_stealing_) {
+            stealing_queue_.enable(thread_count);
+        } else {
+            queue_.enable(thread_count);
+        }
         try {
             for (uint32_t i = 0; i < thread_count; ++i) {
-                threads_.push_back(boost::make_shared<std::thread>(&ThreadPool::run, this));
+                if (work_stealing_) {
+                    threads_.push_back(boost::make_shared<std::thread>(&ThreadPool::runStealing, this, i));
+                } else {
+                    threads_.push_back(boost::make_shared<std::thread>(&ThreadPool::run, this, i));
+                }
             }
         } catch (...) {
             // Restore signal mask.
@@ -206,6 +336,7 @@ private:
             isc_throw(MultiThreadingInvalidOperation, "thread pool stop called by worker thread");
         }
         queue_.disable();
+        stealing_queue_.disable();
         for (auto thread : threads_) {
             thread->join();
         }
@@ -421,6 +552,19 @@ private:
             wait_cv_.notify_all();
         }
 
+        /// @brief remove and return all work items
+        ///
+        /// @return the removed work items in queue order
+        std::list<Item> drain() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::list<Item> items;
+            while (!queue_.empty()) {
+                items.push_back(queue_.front());
+                queue_.pop_front();
+            }
+            return (items);
+        }
+
         /// @brief enable the queue
         ///
         /// Sets the queue state to 'enabled'
@@ -488,8 +632,468 @@ private:
         double stat1000;
     };
 
+    /// @brief Defines a thread pool queue with work stealing.
+    ///
+    /// Each thread of the pool has its own queue. Work items added by a
+    /// thread of the pool are put in its queue, other work items are put
+    /// in a global injection queue. An idle thread takes work items from
+    /// the front of its queue, then from the front of the injection queue
+    /// and then from the back of the queues of the other threads. When
+    /// there is no work item it retries @ref STEALING_SPIN_COUNT times,
+    /// yielding the processor between rounds, before parking on a
+    /// condition variable. Threads are woken only when some are parked
+    /// so the common path does not take a global mutex.
+    ///
+    /// The maximum size and the queue length statistics apply to the sum
+    /// of the sizes of all queues: as the queues are not locked together
+    /// they are approximate while threads are running.
+    ///
+    /// @tparam Item a 'smart pointer' to a functor
+    template <typename Item>
+    struct ThreadPoolStealingQueue {
+        /// @brief Constructor
+        ///
+        /// Creates the thread pool queue in 'disabled' state
+        ThreadPoolStealingQueue()
+            : enabled_(false), max_queue_size_(0), size_(0), pending_(0),
+              parked_(0), stat10(0.), stat100(0.), stat1000(0.) {
+        }
+
+        /// @brief Destructor
+        ///
+        /// Destroys the thread pool queue
+        ~ThreadPoolStealingQueue() {
+            disable();
+            clear();
+        }
+
+        /// @brief set maximum number of work items in the queue
+        ///
+        /// @return the maximum size (0 means unlimited)
+        void setMaxQueueSize(size_t max_queue_size) {
+            max_queue_size_ = max_queue_size;
+        }
+
+        /// @brief get maximum number of work items in the queue
+        ///
+        /// @return the maximum size (0 means unlimited)
+        size_t getMaxQueueSize() {
+            return (max_queue_size_);
+        }
+
+        /// @brief push work item to the queue
+        ///
+        /// Used to add work items to the queue of the calling thread or
+        /// to the injection queue.
+        /// When the queue is full oldest items of the injection queue are
+        /// removed and false is returned.
+        ///
+        /// @param item the new item to be added to the queue
+        /// @return false if the queue was full and oldest item(s) dropped,
+        /// true otherwise
+        bool pushBack(const Item& item) {
+            bool ret = true;
+            if (!item) {
+                return (ret);
+            }
+            // Account the item before it becomes visible to the threads.
+            ++pending_;
+            ++size_;
+            Worker* worker = getWorker();
+            size_t max_queue_size = max_queue_size_;
+            if (worker && ((max_queue_size == 0) || (size_ <= max_queue_size))) {
+                std::lock_guard<std::mutex> lock(worker->mutex_);
+                worker->queue_.push_back(item);
+            } else {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (max_queue_size != 0) {
+                    while ((size_ > max_queue_size) && !queue_.empty()) {
+                        queue_.pop_front();
+                        --size_;
+                        --pending_;
+                        ret = false;
+                    }
+                }
+                queue_.push_back(item);
+            }
+            notify();
+            return (ret);
+        }
+
+        /// @brief push work item to the queue at front.
+        ///
+        /// Used to add work items at front of the queue of the calling
+        /// thread or of the injection queue.
+        /// When the queue is full the item is not added.
+        ///
+        /// @param item the new item to be added to the queue
+        /// @return false if the queue was full, true otherwise
+        bool pushFront(const Item& item) {
+            if (!item) {
+                return (true);
+            }
+            size_t max_queue_size = max_queue_size_;
+            if ((max_queue_size != 0) && (size_ >= max_queue_size)) {
+                return (false);
+            }
+            ++pending_;
+            ++size_;
+            Worker* worker = getWorker();
+            if (worker) {
+                std::lock_guard<std::mutex> lock(worker->mutex_);
+                worker->queue_.push_front(item);
+            } else {
+                std::lock_guard<std::mutex> lock(mutex_);
+                queue_.push_front(item);
+            }
+            notify();
+            return (true);
+        }
+
+        /// @brief pop work item from the queues or block waiting
+        ///
+        /// Used by a thread of the pool to retrieve and remove a work item.
+        /// If the queue is 'disabled', this function returns immediately an
+        /// empty element.
+        /// Before a work item is returned statistics are updated.
+        ///
+        /// @param index the index of the calling thread
+        /// @return a work item or an empty element.
+        Item pop(size_t index) {
+            Worker& worker = *workers_[index];
+            size_t spin = 0;
+            for (;;) {
+                if (!enabled_) {
+                    return (Item());
+                }
+                Item item;
+                if (popLocal(worker, item) || popInjected(item) ||
+                    steal(index, item)) {
+                    double length = size_--;
+                    stat10 = stat10 * CEXP10 + (1 - CEXP10) * length;
+                    stat100 = stat100 * CEXP100 + (1 - CEXP100) * length;
+                    stat1000 = stat1000 * CEXP1000 + (1 - CEXP1000) * length;
+                    return (item);
+                }
+                if (++spin < STEALING_SPIN_COUNT) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                spin = 0;
+                park();
+            }
+        }
+
+        /// @brief signal the end of the processing of a work item
+        ///
+        /// Wakes up threads waiting for all items to be processed.
+        void done() {
+            if (--pending_ == 0) {
+                std::lock_guard<std::mutex> lock(wait_mutex_);
+                wait_cv_.notify_all();
+            }
+        }
+
+        /// @brief count number of work items in the queue
+        ///
+        /// Returns the number of work items in the queue
+        ///
+        /// @return the number of work items
+        size_t count() {
+            return (size_);
+        }
+
+        /// @brief wait for current items to be processed
+        ///
+        /// Used to block the calling thread until all items in the queue have
+        /// been processed
+        void wait() {
+            std::unique_lock<std::mutex> lock(wait_mutex_);
+            wait_cv_.wait(lock, [&]() {return (pending_ == 0);});
+        }
+
+        /// @brief wait for items to be processed or return after timeout
+        ///
+        /// Used to block the calling thread until all items in the queue have
+        /// been processed or return after timeout
+        ///
+        /// @param seconds the time in seconds to wait for tasks to finish
+        /// @return true if all tasks finished, false on timeout
+        bool wait(uint32_t seconds) {
+            std::unique_lock<std::mutex> lock(wait_mutex_);
+            return (wait_cv_.wait_for(lock, std::chrono::seconds(seconds),
+                                      [&]() {return (pending_ == 0);}));
+        }
+
+        /// @brief get queue length statistic
+        ///
+        /// @param which select the statistic (10, 100 or 1000)
+        /// @return the queue length statistic
+        /// @throw InvalidParameter if which is not 10 and 100 and 1000.
+        double getQueueStat(size_t which) {
+            switch (which) {
+            case 10:
+                return (stat10);
+            case 100:
+                return (stat100);
+            case 1000:
+                return (stat1000);
+            default:
+                isc_throw(InvalidParameter, "supported statistic for "
+                          << "10/100/1000 only, not " << which);
+            }
+        }
+
+        /// @brief clear remove all work items
+        ///
+        /// Removes all queued work items. Must not be called when threads
+        /// are running.
+        void clear() {
+            drain();
+            pending_ = 0;
+            std::lock_guard<std::mutex> lock(wait_mutex_);
+            wait_cv_.notify_all();
+        }
+
+        /// @brief remove and return all work items
+        ///
+        /// Must not be called when threads are running.
+        ///
+        /// @return the removed work items, injected items first
+        std::list<Item> drain() {
+            std::list<Item> items;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                items.insert(items.end(), queue_.begin(), queue_.end());
+                queue_.clear();
+            }
+            for (auto const& worker : workers_) {
+                std::lock_guard<std::mutex> lock(worker->mutex_);
+                items.insert(items.end(), worker->queue_.begin(),
+                             worker->queue_.end());
+                worker->queue_.clear();
+            }
+            size_ = 0;
+            pending_ -= std::min(pending_.load(), items.size());
+            return (items);
+        }
+
+        /// @brief enable the queue
+        ///
+        /// Sets the queue state to 'enabled' and creates the per thread
+        /// queues. Items queued by threads which were stopped are moved
+        /// to the injection queue.
+        ///
+        /// @param thread_count number of working threads
+        void enable(uint32_t thread_count) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto const& worker : workers_) {
+                queue_.insert(queue_.end(), worker->queue_.begin(),
+                              worker->queue_.end());
+            }
+            workers_.clear();
+            for (uint32_t i = 0; i < thread_count; ++i) {
+                workers_.push_back(boost::make_shared<Worker>());
+            }
+            enabled_ = true;
+        }
+
+        /// @brief disable the queue
+        ///
+        /// Sets the queue state to 'disabled'
+        void disable() {
+            enabled_ = false;
+            // Notify parked threads so that they can exit.
+            std::lock_guard<std::mutex> lock(park_mutex_);
+            park_cv_.notify_all();
+        }
+
+        /// @brief return the state of the queue
+        ///
+        /// Returns the state of the queue
+        ///
+        /// @return the state
+        bool enabled() {
+            return (enabled_);
+        }
+
+        /// @brief register the calling thread as a thread of the pool
+        ///
+        /// @param index the index of the calling thread
+        void setWorker(size_t index) {
+            WorkerSlot& slot = getWorkerSlot();
+            slot.owner_ = this;
+            slot.worker_ = workers_[index].get();
+        }
+
+    private:
+        /// @brief The queue of a thread of the pool
+        struct Worker {
+            /// @brief mutex used for critical sections
+            std::mutex mutex_;
+
+            /// @brief underlying queue container
+            std::deque<Item> queue_;
+        };
+
+        /// @brief Thread local registration of a thread of the pool
+        struct WorkerSlot {
+            /// @brief the queue owning the thread
+            const ThreadPoolStealingQueue* owner_;
+
+            /// @brief the queue of the thread
+            Worker* worker_;
+        };
+
+        /// @brief return the thread local registration
+        ///
+        /// @return the registration of the calling thread
+        static WorkerSlot& getWorkerSlot() {
+            static thread_local WorkerSlot slot = { 0, 0 };
+            return (slot);
+        }
+
+        /// @brief return the queue of the calling thread
+        ///
+        /// @return the queue of the calling thread or null when the calling
+        /// thread is not a thread of the pool
+        Worker* getWorker() {
+            WorkerSlot& slot = getWorkerSlot();
+            if (slot.owner_ != this) {
+                return (0);
+            }
+            return (slot.worker_);
+        }
+
+        /// @brief pop a work item from the front of the thread queue
+        ///
+        /// @param worker the queue of the calling thread
+        /// @param item the work item
+        /// @return true if a work item was found, false otherwise
+        bool popLocal(Worker& worker, Item& item) {
+            std::lock_guard<std::mutex> lock(worker.mutex_);
+            if (worker.queue_.empty()) {
+                return (false);
+            }
+            item = worker.queue_.front();
+            worker.queue_.pop_front();
+            return (true);
+        }
+
+        /// @brief pop a work item from the front of the injection queue
+        ///
+        /// @param item the work item
+        /// @return true if a work item was found, false otherwise
+        bool popInjected(Item& item) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (queue_.empty()) {
+                return (false);
+            }
+            item = queue_.front();
+            queue_.pop_front();
+            return (true);
+        }
+
+        /// @brief steal a work item from the back of the other threads
+        ///
+        /// @param index the index of the calling thread
+        /// @param item the work item
+        /// @return true if a work item was found, false otherwise
+        bool steal(size_t index, Item& item) {
+            size_t count = workers_.size();
+            for (size_t i = 1; i < count; ++i) {
+                Worker& victim = *workers_[(index + i) % count];
+                std::lock_guard<std::mutex> lock(victim.mutex_);
+                if (!victim.queue_.empty()) {
+                    item = victim.queue_.back();
+                    victim.queue_.pop_back();
+                    return (true);
+                }
+            }
+            return (false);
+        }
+
+        /// @brief park the calling thread until a work item is added
+        void park() {
+            std::unique_lock<std::mutex> lock(park_mutex_);
+            ++parked_;
+            park_cv_.wait(lock, [&]() {return (!enabled_ || size_ > 0);});
+            --parked_;
+        }
+
+        /// @brief wake up a parked thread if any
+        ///
+        /// The size was incremented before so either a parking thread sees
+        /// the new size or the parked count is not zero.
+        void notify() {
+            if (parked_ > 0) {
+                std::lock_guard<std::mutex> lock(park_mutex_);
+                park_cv_.notify_one();
+            }
+        }
+
+        /// @brief global injection queue
+        std::deque<Item> queue_;
+
+        /// @brief mutex used for the injection queue
+        std::mutex mutex_;
+
+        /// @brief queues of the threads of the pool
+        std::vector<boost::shared_ptr<Worker>> workers_;
+
+        /// @brief mutex used to park threads
+        std::mutex park_mutex_;
+
+        /// @brief condition variable used to wake up parked threads
+        std::condition_variable park_cv_;
+
+        /// @brief mutex used to wait for all items to be processed
+        std::mutex wait_mutex_;
+
+        /// @brief condition variable used to wait for all items to be processed
+        std::condition_variable wait_cv_;
+
+        /// @brief the sate of the queue
+        std::atomic<bool> enabled_;
+
+        /// @brief maximum number of work items in the queue
+        /// (0 means unlimited)
+        std::atomic<size_t> max_queue_size_;
+
+        /// @brief number of work items in the queues
+        std::atomic<size_t> size_;
+
+        /// @brief number of work items in the queues or being processed
+        std::atomic<size_t> pending_;
+
+        /// @brief number of parked threads
+        std::atomic<uint32_t> parked_;
+
+        /// @brief queue length statistic for 10 packets
+        std::atomic<double> stat10;
+
+        /// @brief queue length statistic for 100 packets
+        std::atomic<double> stat100;
+
+        /// @brief queue length statistic for 1000 packets
+        std::atomic<double> stat1000;
+    };
+
+    /// @brief pin the calling thread according to the CPU set
+    ///
+    /// @param index the index of the thread
+    void place(size_t index) {
+        if (!cpu_set_.empty()) {
+            pinThread(CpuSet(1, cpu_set_[index % cpu_set_.size()]));
+        }
+        thread_cpus_[index].store(getCurrentCpu(), std::memory_order_relaxed);
+    }
+
     /// @brief run function of each thread
-    void run() {
+    ///
+    /// @param index the index of the thread
+    void run(size_t index) {
+        place(index);
         while (queue_.enabled()) {
             WorkItemPtr item = queue_.pop();
             if (item) {
@@ -498,6 +1102,27 @@ private:
                 } catch (...) {
                     // catch all exceptions
                 }
+                thread_cpus_[index].store(getCurrentCpu(), std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// @brief run function of each thread when work stealing is enabled
+    ///
+    /// @param index the index of the thread
+    void runStealing(size_t index) {
+        place(index);
+        stealing_queue_.setWorker(index);
+        while (stealing_queue_.enabled()) {
+            WorkItemPtr item = stealing_queue_.pop(index);
+            if (item) {
+                try {
+                    (*item)();
+                } catch (...) {
+                    // catch all exceptions
+                }
+                stealing_queue_.done();
+                thread_cpus_[index].store(getCurrentCpu(), std::memory_order_relaxed);
             }
         }
     }
@@ -507,6 +1132,18 @@ private:
 
     /// @brief underlying work items queue
     ThreadPoolQueue<WorkItemPtr, Container> queue_;
+
+    /// @brief underlying work items queue when work stealing is enabled
+    ThreadPoolStealingQueue<WorkItemPtr> stealing_queue_;
+
+    /// @brief work stealing flag
+    bool work_stealing_;
+
+    /// @brief CPUs the threads are pinned on
+    CpuSet cpu_set_;
+
+    /// @brief CPU each thread last ran on
+    std::unique_ptr<std::atomic<int>[]> thread_cpus_;
 };
 
 /// Initialize the 10 packet rounding to exp(-.1)
@@ -521,6 +1158,10 @@ const double ThreadPool<W, C>::CEXP100 = std::exp(-.01);
 template <typename W, typename C>
 const double ThreadPool<W, C>::CEXP1000 = std::exp(-.001);
 
+/// Definition of the number of rounds before parking
+template <typename W, typename C>
+const size_t ThreadPool<W, C>::STEALING_SPIN_COUNT;
+
 }  // namespace util
 }  // namespace isc
 
@@ -12,6 +12,8 @@ api_files += $(top_srcdir)/src/share/api/class-add.json
 api_files += $(top_srcdir)/src/share/api/class-del.json
 api_files += $(top_srcdir)/src/share/api/class-get.json
 api_files += $(top_srcdir)/src/share/api/class-list.json
+api_files += $(top_srcdir)/src/share/api/class-stats-get.json
+api_files += $(top_srcdir)/src/share/api/class-stats-set.json
 api_files += $(top_srcdir)/src/share/api/class-update.json
 api_files += $(top_srcdir)/src/share/api/config-backend-pull.json
 api_files += $(top_srcdir)/src/share/api/config-get.json